@@ -0,0 +1,132 @@
+#include "GraphEvaluator.hpp"
+#include "GraphTopology.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+
+namespace exc {
+
+
+GraphEvaluator::GraphEvaluator(const std::vector<NodeBase*>& nodes) {
+	Compile(nodes);
+}
+
+
+GraphEvaluator::~GraphEvaluator() {
+	Clear();
+}
+
+
+void GraphEvaluator::Compile(const std::vector<NodeBase*>& nodes) {
+	Clear();
+
+	m_order = GraphTopology::Build(nodes).order;
+
+	// observe the inputs in place of the nodes
+	m_markers.resize(m_order.size());
+	m_observedPortsBegin.reserve(m_order.size() + 1);
+	for (uint32_t rank = 0; rank < m_order.size(); ++rank) {
+		NodeBase* node = m_order[rank];
+		m_ranks.insert({ node, rank });
+		m_markers[rank].evaluator = this;
+		m_markers[rank].rank = rank;
+		m_observedPortsBegin.push_back((uint32_t)m_observedPorts.size());
+		for (size_t port = 0; port < node->GetNumInputs(); ++port) {
+			InputPortBase* input = node->GetInput(port);
+			if (input->HasObserver(node)) {
+				input->RemoveObserver(node);
+				m_observedPorts.push_back(input);
+			}
+			input->AddObserver(&m_markers[rank]);
+		}
+	}
+	m_observedPortsBegin.push_back((uint32_t)m_observedPorts.size());
+
+	MarkAllDirty();
+}
+
+
+void GraphEvaluator::Clear() {
+	for (uint32_t rank = 0; rank < m_order.size(); ++rank) {
+		NodeBase* node = m_order[rank];
+		for (size_t port = 0; port < node->GetNumInputs(); ++port) {
+			node->GetInput(port)->RemoveObserver(&m_markers[rank]);
+		}
+		for (uint32_t i = m_observedPortsBegin[rank]; i < m_observedPortsBegin[rank + 1]; ++i) {
+			m_observedPorts[i]->AddObserver(node);
+		}
+	}
+
+	m_order.clear();
+	m_ranks.clear();
+	m_markers.clear();
+	m_observedPorts.clear();
+	m_observedPortsBegin.clear();
+	m_isDirty.clear();
+	m_dirtyHeap.clear();
+}
+
+
+void GraphEvaluator::MarkDirty(const NodeBase* node) {
+	auto it = m_ranks.find(node);
+	if (it == m_ranks.end()) {
+		throw std::invalid_argument("Node is not part of the graph.");
+	}
+	MarkDirty(it->second);
+}
+
+
+void GraphEvaluator::MarkAllDirty() {
+	m_isDirty.assign(m_order.size(), true);
+	// ascending ranks already make a min-heap
+	m_dirtyHeap.resize(m_order.size());
+	for (uint32_t rank = 0; rank < m_order.size(); ++rank) {
+		m_dirtyHeap[rank] = rank;
+	}
+}
+
+
+bool GraphEvaluator::IsDirty(const NodeBase* node) const {
+	auto it = m_ranks.find(node);
+	return it != m_ranks.end() && m_isDirty[it->second];
+}
+
+
+size_t GraphEvaluator::GetNumDirty() const {
+	return m_dirtyHeap.size();
+}
+
+
+size_t GraphEvaluator::Evaluate() {
+	size_t numUpdated = 0;
+	while (!m_dirtyHeap.empty()) {
+		std::pop_heap(m_dirtyHeap.begin(), m_dirtyHeap.end(), std::greater<uint32_t>());
+		uint32_t rank = m_dirtyHeap.back();
+		m_dirtyHeap.pop_back();
+		m_isDirty[rank] = false;
+
+		// outputs set here mark the consumers dirty, they all come later in the order
+		m_order[rank]->Update();
+		++numUpdated;
+	}
+	return numUpdated;
+}
+
+
+const std::vector<NodeBase*>& GraphEvaluator::GetOrder() const {
+	return m_order;
+}
+
+
+void GraphEvaluator::MarkDirty(uint32_t rank) {
+	if (!m_isDirty[rank]) {
+		m_isDirty[rank] = true;
+		m_dirtyHeap.push_back(rank);
+		std::push_heap(m_dirtyHeap.begin(), m_dirtyHeap.end(), std::greater<uint32_t>());
+	}
+}
+
+
+} // namespace exc
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Node.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+namespace exc {
+
+
+/// <summary>
+/// <para> Evaluates a graph of nodes incrementally, updating only the nodes whose inputs changed. </para>
+/// <para>
+/// The nodes are sorted topologically once, when the graph is compiled. From then on, the evaluator
+/// observes the nodes' input ports in place of the nodes: setting an input, either by hand or by
+/// a linked output, marks the node dirty instead of notifying it. Evaluate updates the dirty nodes in
+/// topological order, and the outputs they set mark their consumers dirty in turn. Thus each
+/// evaluation costs in proportion to the part of the graph that changed, not to the size of the graph.
+/// </para>
+/// </summary>
+/// <remarks>
+/// The graph must be compiled again after links between its nodes change.
+/// Nodes that produce new data without their inputs changing must be marked dirty by hand.
+/// </remarks>
+class GraphEvaluator {
+public:
+	GraphEvaluator() = default;
+	/// <exception cref="std::invalid_argument"> If the nodes' links form a cycle. </exception>
+	explicit GraphEvaluator(const std::vector<NodeBase*>& nodes);
+	GraphEvaluator(const GraphEvaluator&) = delete;
+	GraphEvaluator& operator=(const GraphEvaluator&) = delete;
+	~GraphEvaluator();
+
+	/// <summary> Sorts the nodes and observes their inputs. Every node starts out dirty. </summary>
+	/// <exception cref="std::invalid_argument"> If the nodes' links form a cycle. </exception>
+	void Compile(const std::vector<NodeBase*>& nodes);
+	/// <summary> Gives the nodes back their input notifications and forgets them. </summary>
+	void Clear();
+
+	/// <exception cref="std::invalid_argument"> If the node is not part of the graph. </exception>
+	void MarkDirty(const NodeBase* node);
+	void MarkAllDirty();
+	bool IsDirty(const NodeBase* node) const;
+	size_t GetNumDirty() const;
+
+	/// <summary> Updates the dirty nodes in topological order. </summary>
+	/// <returns> The number of nodes updated. </returns>
+	size_t Evaluate();
+
+	/// <summary> The nodes in the order they are evaluated. </summary>
+	const std::vector<NodeBase*>& GetOrder() const;
+
+private:
+	/// <summary> Stands in for a node among the observers of its input ports. </summary>
+	class DirtyMarker : public NodeBase {
+	public:
+		GraphEvaluator* evaluator = nullptr;
+		uint32_t rank = 0;
+
+		size_t GetNumInputs() const override { return 0; }
+		size_t GetNumOutputs() const override { return 0; }
+		InputPortBase* GetInput(size_t) override { return nullptr; }
+		OutputPortBase* GetOutput(size_t) override { return nullptr; }
+		const InputPortBase* GetInput(size_t) const override { return nullptr; }
+		const OutputPortBase* GetOutput(size_t) const override { return nullptr; }
+		void Update() override {}
+		void Notify(InputPortBase*) override { evaluator->MarkDirty(rank); }
+	};
+
+	void MarkDirty(uint32_t rank);
+
+	std::vector<NodeBase*> m_order;
+	std::unordered_map<const NodeBase*, uint32_t> m_ranks;
+	std::vector<DirtyMarker> m_markers; // by rank, never reallocated once observing
+	std::vector<InputPortBase*> m_observedPorts; // ports the nodes observed themselves, by node in CSR
+	std::vector<uint32_t> m_observedPortsBegin;
+
+	std::vector<bool> m_isDirty;
+	std::vector<uint32_t> m_dirtyHeap; // min-heap of the ranks of dirty nodes
+};
+
+
+} // namespace exc
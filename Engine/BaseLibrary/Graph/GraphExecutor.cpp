@@ -0,0 +1,228 @@
+#include "GraphExecutor.hpp"
+#include "GraphTopology.hpp"
+
+#include "../ThreadName.hpp"
+
+#include <stdexcept>
+
+
+namespace exc {
+
+
+GraphExecutor::GraphExecutor(unsigned numWorkers) {
+	m_workers.reserve(numWorkers);
+	for (unsigned i = 0; i < numWorkers; ++i) {
+		m_workers.push_back(std::thread(&GraphExecutor::WorkerThreadFunc, this));
+	}
+}
+
+
+GraphExecutor::~GraphExecutor() {
+	{
+		std::lock_guard<std::mutex> lkg(m_mutex);
+		m_runWorkers = false;
+	}
+	m_workerCv.notify_all();
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+	Clear();
+}
+
+
+void GraphExecutor::Compile(const std::vector<NodeBase*>& nodes) {
+	Clear();
+
+	GraphTopology topology = GraphTopology::Build(nodes);
+	m_order = std::move(topology.order);
+	m_consumersBegin = std::move(topology.consumersBegin);
+	m_consumers = std::move(topology.consumers);
+	m_numProducers = std::move(topology.numProducers);
+	m_affinities.assign(m_order.size(), eNodeAffinity::ANY_THREAD);
+
+	// the nodes are updated by the executor, not when their inputs are set
+	m_observedPortsBegin.reserve(m_order.size() + 1);
+	for (uint32_t rank = 0; rank < m_order.size(); ++rank) {
+		NodeBase* node = m_order[rank];
+		m_ranks.insert({ node, rank });
+		m_observedPortsBegin.push_back((uint32_t)m_observedPorts.size());
+		for (size_t port = 0; port < node->GetNumInputs(); ++port) {
+			InputPortBase* input = node->GetInput(port);
+			if (input->HasObserver(node)) {
+				input->RemoveObserver(node);
+				m_observedPorts.push_back(input);
+			}
+		}
+	}
+	m_observedPortsBegin.push_back((uint32_t)m_observedPorts.size());
+}
+
+
+void GraphExecutor::Clear() {
+	for (uint32_t rank = 0; rank < m_order.size(); ++rank) {
+		for (uint32_t i = m_observedPortsBegin[rank]; i < m_observedPortsBegin[rank + 1]; ++i) {
+			m_observedPorts[i]->AddObserver(m_order[rank]);
+		}
+	}
+
+	m_order.clear();
+	m_ranks.clear();
+	m_consumersBegin.clear();
+	m_consumers.clear();
+	m_numProducers.clear();
+	m_affinities.clear();
+	m_observedPorts.clear();
+	m_observedPortsBegin.clear();
+}
+
+
+void GraphExecutor::SetAffinity(const NodeBase* node, eNodeAffinity affinity) {
+	m_affinities[FindRank(node)] = affinity;
+}
+
+
+eNodeAffinity GraphExecutor::GetAffinity(const NodeBase* node) const {
+	return m_affinities[FindRank(node)];
+}
+
+
+void GraphExecutor::Execute() {
+	if (m_order.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lkg(m_mutex);
+		m_numPending = m_numProducers;
+		m_isSkipped.assign(m_order.size(), false);
+		m_numRemaining = m_order.size();
+		m_exception = nullptr;
+		for (uint32_t rank = 0; rank < m_order.size(); ++rank) {
+			if (m_numProducers[rank] == 0) {
+				(m_affinities[rank] == eNodeAffinity::CALLING_THREAD ? m_readyPinned : m_ready).push_back(rank);
+			}
+		}
+	}
+	m_workerCv.notify_all();
+
+	Help();
+
+	if (m_exception) {
+		std::exception_ptr exception = m_exception;
+		m_exception = nullptr;
+		std::rethrow_exception(exception);
+	}
+}
+
+
+const std::vector<NodeBase*>& GraphExecutor::GetOrder() const {
+	return m_order;
+}
+
+
+unsigned GraphExecutor::GetNumWorkers() const {
+	return (unsigned)m_workers.size();
+}
+
+
+unsigned GraphExecutor::DefaultNumWorkers() {
+	unsigned numHardwareThreads = std::thread::hardware_concurrency();
+	return numHardwareThreads > 1 ? numHardwareThreads - 1 : 0;
+}
+
+
+void GraphExecutor::WorkerThreadFunc() {
+	SetCurrentThreadName("Graph Executor Worker");
+
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true) {
+		m_workerCv.wait(lk, [this] { return !m_runWorkers || !m_ready.empty(); });
+		if (!m_runWorkers) {
+			return;
+		}
+		uint32_t rank = m_ready.front();
+		m_ready.pop_front();
+		Run(rank, lk);
+	}
+}
+
+
+void GraphExecutor::Help() {
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (m_numRemaining > 0) {
+		// pinned nodes first, nobody else can run them
+		std::deque<uint32_t>& queue = !m_readyPinned.empty() ? m_readyPinned : m_ready;
+		if (queue.empty()) {
+			m_callerCv.wait(lk, [this] { return m_numRemaining == 0 || !m_readyPinned.empty() || !m_ready.empty(); });
+			continue;
+		}
+		uint32_t rank = queue.front();
+		queue.pop_front();
+		Run(rank, lk);
+	}
+}
+
+
+void GraphExecutor::Run(uint32_t rank, std::unique_lock<std::mutex>& lk) {
+	NodeBase* node = m_order[rank];
+	bool isSkipped = m_isSkipped[rank];
+
+	lk.unlock();
+	std::exception_ptr exception;
+	if (!isSkipped) {
+		try {
+			node->Update();
+		}
+		catch (...) {
+			exception = std::current_exception();
+		}
+	}
+	lk.lock();
+
+	// keep the earliest exception in the order, so the same one is thrown however the nodes were scheduled
+	if (exception && (!m_exception || rank < m_exceptionRank)) {
+		m_exception = exception;
+		m_exceptionRank = rank;
+	}
+
+	// release the consumers, skipped ones are released too so that the rest of the graph can finish
+	bool isFailed = isSkipped || exception;
+	size_t numReleased = 0;
+	bool isPinnedReleased = false;
+	for (uint32_t i = m_consumersBegin[rank]; i < m_consumersBegin[rank + 1]; ++i) {
+		uint32_t consumer = m_consumers[i];
+		if (isFailed) {
+			m_isSkipped[consumer] = true;
+		}
+		if (--m_numPending[consumer] == 0) {
+			if (m_affinities[consumer] == eNodeAffinity::CALLING_THREAD && !m_isSkipped[consumer]) {
+				m_readyPinned.push_back(consumer);
+				isPinnedReleased = true;
+			}
+			else {
+				m_ready.push_back(consumer);
+				++numReleased;
+			}
+		}
+	}
+	--m_numRemaining;
+
+	for (size_t i = 0; i < numReleased; ++i) {
+		m_workerCv.notify_one();
+	}
+	if (numReleased > 0 || isPinnedReleased || m_numRemaining == 0) {
+		m_callerCv.notify_one();
+	}
+}
+
+
+uint32_t GraphExecutor::FindRank(const NodeBase* node) const {
+	auto it = m_ranks.find(node);
+	if (it == m_ranks.end()) {
+		throw std::invalid_argument("Node is not part of the graph.");
+	}
+	return it->second;
+}
+
+
+} // namespace exc
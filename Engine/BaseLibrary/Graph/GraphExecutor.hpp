@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Node.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace exc {
+
+
+/// <summary> Where a node may be updated by a <see cref="GraphExecutor"/>. </summary>
+enum class eNodeAffinity {
+	/// <summary> On any thread, concurrently with unrelated nodes. </summary>
+	ANY_THREAD,
+	/// <summary> Only on the thread that calls Execute, one such node at a time. For nodes that are not thread-safe. </summary>
+	CALLING_THREAD,
+};
+
+
+/// <summary>
+/// <para> Updates every node of a graph once, running nodes that do not depend on each other in parallel. </para>
+/// <para>
+/// The links between the nodes form a task graph when compiled: a node is updated only after all
+/// nodes linked to its inputs have been updated, so each node sees the same inputs as in a sequential
+/// evaluation and the results do not depend on how the nodes were scheduled. Nodes whose producers
+/// are done are picked up by a pool of worker threads, while the calling thread helps out and alone
+/// runs the nodes pinned to it.
+/// </para>
+/// </summary>
+/// <remarks>
+/// While compiled, the nodes are not notified of their inputs, the executor updates them instead.
+/// Nodes must only touch their own ports and the inputs linked to their outputs while updating.
+/// The graph must be compiled again after links between its nodes change.
+/// </remarks>
+class GraphExecutor {
+public:
+	/// <param name="numWorkers"> The number of threads besides the calling one. With zero, nodes are run on the calling thread one by one. </param>
+	explicit GraphExecutor(unsigned numWorkers = DefaultNumWorkers());
+	GraphExecutor(const GraphExecutor&) = delete;
+	GraphExecutor& operator=(const GraphExecutor&) = delete;
+	~GraphExecutor();
+
+	/// <summary> Sorts the nodes and takes over their input notifications. Every node may run on any thread. </summary>
+	/// <exception cref="std::invalid_argument"> If the nodes' links form a cycle. </exception>
+	void Compile(const std::vector<NodeBase*>& nodes);
+	/// <summary> Gives the nodes back their input notifications and forgets them. </summary>
+	void Clear();
+
+	/// <exception cref="std::invalid_argument"> If the node is not part of the graph. </exception>
+	void SetAffinity(const NodeBase* node, eNodeAffinity affinity);
+	/// <exception cref="std::invalid_argument"> If the node is not part of the graph. </exception>
+	eNodeAffinity GetAffinity(const NodeBase* node) const;
+
+	/// <summary> Updates every node once, each after the nodes it depends on. Blocks until all are done. </summary>
+	/// <remarks> Nodes depending on a node that threw are skipped, other nodes still run. </remarks>
+	/// <exception> Rethrows the exception of the earliest node in the order that threw. </exception>
+	void Execute();
+
+	/// <summary> A topological order of the nodes. Updating them one by one in this order gives the same results. </summary>
+	const std::vector<NodeBase*>& GetOrder() const;
+	unsigned GetNumWorkers() const;
+
+	/// <summary> One worker for each hardware thread besides the calling one. </summary>
+	static unsigned DefaultNumWorkers();
+
+private:
+	void WorkerThreadFunc();
+	/// <summary> Runs ready nodes until the graph is done. </summary>
+	void Help();
+	/// <summary> Updates the node, then releases its consumers. </summary>
+	void Run(uint32_t rank, std::unique_lock<std::mutex>& lk);
+	uint32_t FindRank(const NodeBase* node) const;
+
+private:
+	// Graph
+	std::vector<NodeBase*> m_order;
+	std::unordered_map<const NodeBase*, uint32_t> m_ranks;
+	std::vector<uint32_t> m_consumersBegin; // by rank, consumer ranks in CSR
+	std::vector<uint32_t> m_consumers;
+	std::vector<uint32_t> m_numProducers; // by rank
+	std::vector<eNodeAffinity> m_affinities; // by rank
+	std::vector<InputPortBase*> m_observedPorts; // ports the nodes observed themselves, by node in CSR
+	std::vector<uint32_t> m_observedPortsBegin;
+
+	// Execution, guarded by the mutex
+	std::vector<uint32_t> m_numPending; // by rank, producers not done yet
+	std::vector<bool> m_isSkipped; // by rank, a producer threw or was skipped
+	std::deque<uint32_t> m_ready; // nodes any thread can run
+	std::deque<uint32_t> m_readyPinned; // nodes for the calling thread
+	size_t m_numRemaining = 0;
+	std::exception_ptr m_exception;
+	uint32_t m_exceptionRank = 0;
+
+	// Workers
+	std::vector<std::thread> m_workers;
+	bool m_runWorkers = true;
+	std::mutex m_mutex;
+	std::condition_variable m_workerCv;
+	std::condition_variable m_callerCv;
+};
+
+
+} // namespace exc
@@ -0,0 +1,82 @@
+#include "GraphTopology.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+
+
+namespace exc {
+
+
+GraphTopology GraphTopology::Build(const std::vector<NodeBase*>& nodes) {
+	// find which node each input port belongs to
+	std::unordered_map<const NodeBase*, uint32_t> indices;
+	std::unordered_map<const InputPortBase*, uint32_t> portOwners;
+	for (uint32_t i = 0; i < nodes.size(); ++i) {
+		if (!indices.insert({ nodes[i], i }).second) {
+			throw std::invalid_argument("Node is given more than once.");
+		}
+		for (size_t port = 0; port < nodes[i]->GetNumInputs(); ++port) {
+			portOwners.insert({ nodes[i]->GetInput(port), i });
+		}
+	}
+
+	// collect the links between the nodes, links to other nodes are ignored
+	std::vector<std::vector<uint32_t>> consumers(nodes.size());
+	std::vector<uint32_t> numProducers(nodes.size(), 0);
+	for (uint32_t i = 0; i < nodes.size(); ++i) {
+		for (size_t port = 0; port < nodes[i]->GetNumOutputs(); ++port) {
+			const OutputPortBase* output = nodes[i]->GetOutput(port);
+			for (auto it = output->begin(); it != output->end(); ++it) {
+				auto owner = portOwners.find(*it);
+				if (owner != portOwners.end()) {
+					consumers[i].push_back(owner->second);
+					++numProducers[owner->second];
+				}
+			}
+		}
+	}
+
+	// sort topologically
+	GraphTopology topology;
+	std::vector<uint32_t> remainingProducers = numProducers;
+	std::vector<uint32_t> sorted;
+	sorted.reserve(nodes.size());
+	for (uint32_t i = 0; i < nodes.size(); ++i) {
+		if (remainingProducers[i] == 0) {
+			sorted.push_back(i);
+		}
+	}
+	for (size_t next = 0; next < sorted.size(); ++next) {
+		for (uint32_t consumer : consumers[sorted[next]]) {
+			if (--remainingProducers[consumer] == 0) {
+				sorted.push_back(consumer);
+			}
+		}
+	}
+	if (sorted.size() != nodes.size()) {
+		throw std::invalid_argument("Nodes are linked in a cycle.");
+	}
+
+	// refer to nodes by rank
+	std::vector<uint32_t> ranks(nodes.size());
+	for (uint32_t rank = 0; rank < sorted.size(); ++rank) {
+		ranks[sorted[rank]] = rank;
+	}
+	topology.order.reserve(nodes.size());
+	topology.consumersBegin.reserve(nodes.size() + 1);
+	topology.numProducers.reserve(nodes.size());
+	for (uint32_t index : sorted) {
+		topology.order.push_back(nodes[index]);
+		topology.consumersBegin.push_back((uint32_t)topology.consumers.size());
+		for (uint32_t consumer : consumers[index]) {
+			topology.consumers.push_back(ranks[consumer]);
+		}
+		topology.numProducers.push_back(numProducers[index]);
+	}
+	topology.consumersBegin.push_back((uint32_t)topology.consumers.size());
+
+	return topology;
+}
+
+
+} // namespace exc
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Node.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace exc {
+
+
+/// <summary>
+/// The links between a set of nodes, with the nodes sorted topologically.
+/// Nodes are referred to by their rank, that is, their index in the order.
+/// Links to nodes outside the set are left out.
+/// </summary>
+struct GraphTopology {
+	/// <summary> Every node comes after the nodes linked to its inputs. </summary>
+	std::vector<NodeBase*> order;
+	/// <summary> The consumers of the node of rank r are consumers[consumersBegin[r]] to consumers[consumersBegin[r + 1] - 1].
+	///		A consumer is listed once for each link to it. </summary>
+	std::vector<uint32_t> consumersBegin;
+	std::vector<uint32_t> consumers;
+	/// <summary> The number of links to the inputs of the node from other nodes of the set, by rank. </summary>
+	std::vector<uint32_t> numProducers;
+
+	/// <exception cref="std::invalid_argument"> If a node is given more than once or the links form a cycle. </exception>
+	static GraphTopology Build(const std::vector<NodeBase*>& nodes);
+};
+
+
+} // namespace exc
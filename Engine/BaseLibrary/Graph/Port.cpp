@@ -57,6 +57,10 @@ void InputPortBase::RemoveObserver(NodeBase* observer) {
 	observers.erase(observer);
 }
 
+bool InputPortBase::HasObserver(NodeBase* observer) const {
+	return observers.count(observer) > 0;
+}
+
 
 void InputPortBase::NotifyAll() {
 	for (auto v : observers) {
@@ -90,6 +94,7 @@ bool OutputPortBase::Link(InputPortBase* destination) {
 	if (destination->IsCompatible(GetType()) || GetType() == typeid(Any)) {
 		links.insert(destination);
 		destination->SetLinkState(this);
+		destination->ResolveConverter(GetType());
 		return true;
 	}
 
@@ -8,6 +8,7 @@
 #include <iterator>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include "../Any.hpp"
 
 
@@ -136,6 +137,8 @@ public:
 	virtual void AddObserver(NodeBase* observer) final;
 	/// <summary> Remove observer. </summary>
 	virtual void RemoveObserver(NodeBase* observer) final;
+	/// <summary> Get whether the node is notified when new data is set. </summary>
+	bool HasObserver(NodeBase* observer) const;
 
 	/// <summary> Get which output port it is linked to. </summary>
 	/// <returns> The other end. Null if not linked. </returns>
@@ -148,6 +151,8 @@ protected:
 	OutputPortBase* link;
 	void NotifyAll();
 	virtual void SetConvert(const void* object, std::type_index type) = 0;
+	/// <summary> Called when linked to an output of the given type, so that the conversion can be looked up once. </summary>
+	virtual void ResolveConverter(std::type_index sourceType) {}
 private:
 	// should only be called by an output port when it's ready with building up the linkage
 	// this function only sets internal state of the inputport to represent the link set up by outputport
@@ -230,6 +235,13 @@ public:
 		NotifyAll();
 	}
 
+	/// <summary> Set an object as input to this port without copying it. </summary>
+	void Set(T&& data) {
+		this->data = std::move(data);
+		isSet = true;
+		NotifyAll();
+	}
+
 	/// <summary> 
 	/// Get the data that was previously set.
 	/// If no data is set, the behaviour is undefined.
@@ -248,6 +260,16 @@ public:
 		return data;
 	}
 
+	/// <summary>
+	/// Move the data out of the port, leaving it cleared.
+	/// Lets the node keep large data without copying it, if no one else reads the port.
+	/// </summary>
+	T Take() {
+		T result = std::move(data);
+		Clear();
+		return result;
+	}
+
 	/// <summary> Clear any data currently set on this port. </summary>
 	void Clear() override {
 		isSet = false;
@@ -267,10 +289,19 @@ public:
 	virtual bool IsCompatible(std::type_index type) const override;
 protected:
 	virtual void SetConvert(const void* object, std::type_index type) override;
+	virtual void ResolveConverter(std::type_index sourceType) override;
 private:
+	// converters are stateless, all ports of a type share one
+	static const ConverterT& GetConverter() {
+		static const ConverterT converter{};
+		return converter;
+	}
+
 	bool isSet;
 	T data;
-	ConverterT converter;
+	// the conversion from the linked output's type, looked up when linked
+	std::function<void(const void*, void*)> linkConverter;
+	std::type_index linkSourceType = typeid(void);
 };
 
 
@@ -279,8 +310,26 @@ void InputPort<T, ConverterT>::SetConvert(const void* object, std::type_index ty
 	if (type == typeid(T)) {
 		data = *reinterpret_cast<const T*>(object);
 	}
+	else if (linkConverter && type == linkSourceType) {
+		linkConverter(object, &data);
+	}
+	else {
+		GetConverter()[type](object, &data);
+	}
+	isSet = true;
+	NotifyAll();
+}
+
+
+template <class T, class ConverterT>
+void InputPort<T, ConverterT>::ResolveConverter(std::type_index sourceType) {
+	if (sourceType != typeid(T) && GetConverter().CanConvert(sourceType)) {
+		linkConverter = GetConverter()[sourceType];
+		linkSourceType = sourceType;
+	}
 	else {
-		converter[type](object, &data);
+		linkConverter = nullptr;
+		linkSourceType = typeid(void);
 	}
 }
 
@@ -291,7 +340,7 @@ bool InputPort<T, ConverterT>::IsCompatible(std::type_index type) const {
 		return true;
 	}
 	else {
-		return converter.CanConvert(type);
+		return GetConverter().CanConvert(type);
 	}
 }
 
@@ -319,10 +368,16 @@ public:
 	/// This data is forwarded to each input port linked to this one. </summary>
 	void Set(const T& data);
 
+	/// <summary> Set data on this port.
+	/// The data is moved to one of the linked input ports of the same type, the others get a copy. </summary>
+	void Set(T&& data);
+
 	/// <summary> Get type of underlying data. </summary>
 	std::type_index GetType() const override {
 		return typeid(T);
 	}
+private:
+	void Forward(InputPortBase* destination, const T& data);
 };
 
 
@@ -508,17 +563,42 @@ private:
 
 template <class T>
 void OutputPort<T>::Set(const T& data) {
+	for (auto v : links) {
+		Forward(v, data);
+	}
+}
+
+
+template <class T>
+void OutputPort<T>::Set(T&& data) {
+	InputPortBase* moveDestination = nullptr;
 	for (auto v : links) {
 		if (v->GetType() == GetType()) {
-			static_cast<InputPort<T>*>(v)->Set(data);
-		}
-		else if (v->GetType() == typeid(Any)) {
-			static_cast<InputPort<Any>*>(v)->Set(data);
+			moveDestination = v;
 		}
-		else {
-			v->SetConvert(data);
+	}
+	for (auto v : links) {
+		if (v != moveDestination) {
+			Forward(v, data);
 		}
 	}
+	if (moveDestination != nullptr) {
+		static_cast<InputPort<T>*>(moveDestination)->Set(std::move(data));
+	}
+}
+
+
+template <class T>
+void OutputPort<T>::Forward(InputPortBase* destination, const T& data) {
+	if (destination->GetType() == GetType()) {
+		static_cast<InputPort<T>*>(destination)->Set(data);
+	}
+	else if (destination->GetType() == typeid(Any)) {
+		static_cast<InputPort<Any>*>(destination)->Set(data);
+	}
+	else {
+		destination->SetConvert(data);
+	}
 }
 
 
@@ -1,4 +1,6 @@
 #include "Graph/Node.hpp"
+#include "Graph/GraphEvaluator.hpp"
+#include "Graph/GraphExecutor.hpp"
 
 #include "Graph/Node_Arithmetic.hpp"
 #include "Graph/Node_Comparison.hpp"
@@ -59,9 +59,15 @@ size_t SlabAllocatorEngine::Allocate() {
 		int index = CountTrailingZeros(mask);
 
 		if (index >= 0) {
-			bool correct = !BitTestAndSet(m_first->slotOccupancy, index);
+			Block* block = m_first;
+			bool correct = !BitTestAndSet(block->slotOccupancy, index);
 			assert(correct);
-			return IndexOf(m_first) * SlotsPerBlock + index;
+
+			// full blocks leave the free list right away, deallocation relies on it when putting them back
+			if (block->slotOccupancy == ~size_t(0)) {
+				m_first = block->nextBlockIndex < m_blocks.size() ? &m_blocks[block->nextBlockIndex] : nullptr;
+			}
+			return IndexOf(block) * SlotsPerBlock + index;
 		}
 		else {
 			m_first = m_first->nextBlockIndex < m_blocks.size() ? &m_blocks[m_first->nextBlockIndex] : nullptr;
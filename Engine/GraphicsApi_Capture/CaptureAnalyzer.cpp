@@ -0,0 +1,290 @@
+#include "CaptureAnalyzer.hpp"
+#include "CaptureFormat.hpp"
+
+#include "../GraphicsApi_LL/Common.hpp"
+#include "../GraphicsApi_LL/Exception.hpp"
+
+#include <map>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <iterator>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+FrameStatistics& FrameStatistics::operator+=(const FrameStatistics& rhs) {
+	executeCalls += rhs.executeCalls;
+	commandLists += rhs.commandLists;
+	bundles += rhs.bundles;
+	draws += rhs.draws;
+	indexedDraws += rhs.indexedDraws;
+	instances += rhs.instances;
+	dispatches += rhs.dispatches;
+	copies += rhs.copies;
+	clears += rhs.clears;
+	barrierCalls += rhs.barrierCalls;
+	barriers += rhs.barriers;
+	redundantBarriers += rhs.redundantBarriers;
+	pipelineStateBinds += rhs.pipelineStateBinds;
+	redundantPipelineStateBinds += rhs.redundantPipelineStateBinds;
+	rootSignatureBinds += rhs.rootSignatureBinds;
+	redundantRootSignatureBinds += rhs.redundantRootSignatureBinds;
+	descriptorHeapBinds += rhs.descriptorHeapBinds;
+	redundantDescriptorHeapBinds += rhs.redundantDescriptorHeapBinds;
+	descriptorTableBinds += rhs.descriptorTableBinds;
+	redundantDescriptorTableBinds += rhs.redundantDescriptorTableBinds;
+	rootViewBinds += rhs.rootViewBinds;
+	redundantRootViewBinds += rhs.redundantRootViewBinds;
+	rootConstantBinds += rhs.rootConstantBinds;
+	descriptorCopyCalls += rhs.descriptorCopyCalls;
+	descriptorsCopied += rhs.descriptorsCopied;
+	return *this;
+}
+
+
+// Binding state of a command list while it is being replayed.
+// D3D12 command lists do not inherit state, so this is reset for every list.
+struct ReplayState {
+	static constexpr uint32_t Unbound = ~uint32_t(0);
+
+	uint32_t pipelineState = Unbound;
+	uint32_t rootSignature[2] = { Unbound, Unbound }; // graphics, compute
+	std::vector<uint32_t> descriptorHeaps;
+	bool hasDescriptorHeaps = false;
+	// {isCompute, parameterIndex} -> address
+	std::map<std::pair<uint8_t, uint32_t>, uint64_t> descriptorTables;
+	std::map<std::pair<uint8_t, uint32_t>, uint64_t> rootViews;
+
+	void ClearRootArguments(uint8_t isCompute) {
+		auto Clear = [isCompute](auto& arguments) {
+			for (auto it = arguments.begin(); it != arguments.end();) {
+				it = it->first.first == isCompute ? arguments.erase(it) : std::next(it);
+			}
+		};
+		Clear(descriptorTables);
+		Clear(rootViews);
+	}
+};
+
+
+static unsigned HistogramBucket(uint64_t size) {
+	unsigned bucket = 0;
+	while (size > 1 && bucket + 1 < CaptureStatistics::HistogramSize) {
+		size >>= 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+
+CaptureStatistics AnalyzeCapture(const void* data, size_t size) {
+	CaptureReader reader(static_cast<const uint8_t*>(data), size);
+	CaptureStatistics result;
+
+	try {
+		if (reader.Read<uint32_t>() != CaptureMagic) {
+			throw gxapi::InvalidArgument("Data is not a capture.", "data");
+		}
+		if (reader.Read<uint32_t>() != CaptureVersion) {
+			throw gxapi::InvalidArgument("Capture version is not supported.", "data");
+		}
+
+		FrameStatistics frame;
+		bool isFrameEmpty = true;
+		ReplayState state;
+
+		while (!reader.IsEnd()) {
+			eCaptureCommand command = reader.Read<eCaptureCommand>();
+			isFrameEmpty = isFrameEmpty && command == eCaptureCommand::FRAME_END;
+
+			switch (command) {
+				case eCaptureCommand::FRAME_END:
+					result.frames.push_back(frame);
+					frame = FrameStatistics{};
+					isFrameEmpty = true;
+					break;
+				case eCaptureCommand::EXECUTE_COMMAND_LISTS:
+					reader.Read<uint32_t>(); // queue
+					reader.Read<uint32_t>(); // number of lists, each is enclosed in begin/end
+					++frame.executeCalls;
+					break;
+				case eCaptureCommand::COMMAND_LIST_BEGIN:
+					reader.Read<uint32_t>(); // list id
+					reader.Read<uint8_t>(); // list type
+					state = ReplayState{};
+					++frame.commandLists;
+					break;
+				case eCaptureCommand::COMMAND_LIST_END:
+					break;
+				case eCaptureCommand::SET_PIPELINE_STATE: {
+					uint32_t id = reader.Read<uint32_t>();
+					++frame.pipelineStateBinds;
+					frame.redundantPipelineStateBinds += id == state.pipelineState;
+					state.pipelineState = id;
+					break;
+				}
+				case eCaptureCommand::SET_ROOT_SIGNATURE: {
+					uint8_t isCompute = reader.Read<uint8_t>() != 0;
+					uint32_t id = reader.Read<uint32_t>();
+					++frame.rootSignatureBinds;
+					if (id == state.rootSignature[isCompute]) {
+						++frame.redundantRootSignatureBinds;
+					}
+					else {
+						state.ClearRootArguments(isCompute);
+					}
+					state.rootSignature[isCompute] = id;
+					break;
+				}
+				case eCaptureCommand::SET_DESCRIPTOR_HEAPS: {
+					uint32_t count = reader.ReadCount(sizeof(uint32_t));
+					std::vector<uint32_t> heaps(count);
+					for (auto& heap : heaps) {
+						heap = reader.Read<uint32_t>();
+					}
+					++frame.descriptorHeapBinds;
+					frame.redundantDescriptorHeapBinds += state.hasDescriptorHeaps && heaps == state.descriptorHeaps;
+					state.descriptorHeaps = std::move(heaps);
+					state.hasDescriptorHeaps = true;
+					break;
+				}
+				case eCaptureCommand::SET_DESCRIPTOR_TABLE: {
+					uint8_t isCompute = reader.Read<uint8_t>() != 0;
+					uint32_t parameter = reader.Read<uint32_t>();
+					uint64_t handle = reader.Read<uint64_t>();
+					auto[it, isNew] = state.descriptorTables.insert({ { isCompute, parameter }, handle });
+					++frame.descriptorTableBinds;
+					frame.redundantDescriptorTableBinds += !isNew && it->second == handle;
+					it->second = handle;
+					break;
+				}
+				case eCaptureCommand::SET_ROOT_CONSTANTS:
+					reader.Read<uint8_t>();
+					reader.Read<uint32_t>();
+					reader.Read<uint32_t>();
+					++frame.rootConstantBinds;
+					break;
+				case eCaptureCommand::SET_ROOT_VIEW: {
+					uint8_t isCompute = reader.Read<uint8_t>() != 0;
+					uint32_t parameter = reader.Read<uint32_t>();
+					uint64_t address = reader.Read<uint64_t>();
+					auto[it, isNew] = state.rootViews.insert({ { isCompute, parameter }, address });
+					++frame.rootViewBinds;
+					frame.redundantRootViewBinds += !isNew && it->second == address;
+					it->second = address;
+					break;
+				}
+				case eCaptureCommand::COPY_DESCRIPTORS:
+					++frame.descriptorCopyCalls;
+					frame.descriptorsCopied += reader.Read<uint32_t>();
+					break;
+				case eCaptureCommand::RESOURCE_BARRIER: {
+					uint32_t count = reader.ReadCount(sizeof(CaptureBarrier));
+					++frame.barrierCalls;
+					frame.barriers += count;
+					for (uint32_t i = 0; i < count; ++i) {
+						CaptureBarrier barrier = reader.Read<CaptureBarrier>();
+						frame.redundantBarriers += barrier.type == (uint8_t)gxapi::eResourceBarrierType::TRANSITION
+							&& barrier.stateBefore == barrier.stateAfter;
+					}
+					break;
+				}
+				case eCaptureCommand::DRAW:
+				case eCaptureCommand::DRAW_INDEXED: {
+					uint64_t numElements = reader.Read<uint32_t>();
+					uint64_t numInstances = reader.Read<uint32_t>();
+					++frame.draws;
+					frame.indexedDraws += command == eCaptureCommand::DRAW_INDEXED;
+					frame.instances += numInstances;
+					++result.drawSizeHistogram[HistogramBucket(numElements * numInstances)];
+					break;
+				}
+				case eCaptureCommand::DISPATCH:
+					reader.Read<uint32_t>();
+					reader.Read<uint32_t>();
+					reader.Read<uint32_t>();
+					++frame.dispatches;
+					break;
+				case eCaptureCommand::EXECUTE_BUNDLE:
+					reader.Read<uint32_t>();
+					++frame.bundles;
+					break;
+				case eCaptureCommand::COPY:
+					++frame.copies;
+					break;
+				case eCaptureCommand::CLEAR:
+					++frame.clears;
+					break;
+				default:
+					throw gxapi::InvalidArgument("Capture contains an unknown command.", "data");
+			}
+		}
+
+		// capture was stopped mid-frame
+		if (!isFrameEmpty) {
+			result.frames.push_back(frame);
+		}
+	}
+	catch (std::out_of_range&) {
+		throw gxapi::InvalidArgument("Capture is truncated.", "data");
+	}
+
+	for (const auto& frame : result.frames) {
+		result.total += frame;
+	}
+
+	return result;
+}
+
+
+void PrintCaptureReport(std::ostream& os, const CaptureStatistics& statistics) {
+	const FrameStatistics& total = statistics.total;
+	double numFrames = (double)std::max<size_t>(statistics.frames.size(), 1);
+
+	auto Line = [&](const char* name, uint64_t value, uint64_t redundant = 0, bool hasRedundant = false) {
+		os << "  " << std::left << std::setw(22) << name
+			<< std::right << std::setw(12) << value
+			<< std::setw(14) << std::fixed << std::setprecision(1) << value / numFrames;
+		if (hasRedundant) {
+			os << std::setw(12) << redundant << " (" << std::setprecision(1) << (value ? 100.0 * redundant / value : 0.0) << "%)";
+		}
+		os << std::endl;
+	};
+
+	os << "Frames: " << statistics.frames.size() << std::endl;
+	os << "  " << std::left << std::setw(22) << "" << std::right << std::setw(12) << "total" << std::setw(14) << "per frame" << std::setw(12) << "redundant" << std::endl;
+	Line("ExecuteCommandLists", total.executeCalls);
+	Line("Command lists", total.commandLists);
+	Line("Draws", total.draws);
+	Line("  indexed", total.indexedDraws);
+	Line("  instances", total.instances);
+	Line("Dispatches", total.dispatches);
+	Line("Copies", total.copies);
+	Line("Clears", total.clears);
+	Line("Barrier calls", total.barrierCalls);
+	Line("Barriers", total.barriers, total.redundantBarriers, true);
+	Line("Pipeline states", total.pipelineStateBinds, total.redundantPipelineStateBinds, true);
+	Line("Root signatures", total.rootSignatureBinds, total.redundantRootSignatureBinds, true);
+	Line("Descriptor heaps", total.descriptorHeapBinds, total.redundantDescriptorHeapBinds, true);
+	Line("Descriptor tables", total.descriptorTableBinds, total.redundantDescriptorTableBinds, true);
+	Line("Root views", total.rootViewBinds, total.redundantRootViewBinds, true);
+	Line("Root constants", total.rootConstantBinds);
+	Line("Descriptor copy calls", total.descriptorCopyCalls);
+	Line("Descriptors copied", total.descriptorsCopied);
+
+	os << "Draw size histogram (vertices or indices x instances):" << std::endl;
+	for (size_t i = 0; i < statistics.drawSizeHistogram.size(); ++i) {
+		if (statistics.drawSizeHistogram[i] == 0) {
+			continue;
+		}
+		os << "  >= " << std::left << std::setw(10) << (uint64_t(1) << i)
+			<< std::right << std::setw(12) << statistics.drawSizeHistogram[i] << std::endl;
+	}
+}
+
+
+} // namespace gxapi_capture
+} // namespace inl
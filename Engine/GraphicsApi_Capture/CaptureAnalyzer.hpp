@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <iosfwd>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+/// <summary> Counters collected by replaying a single captured frame. </summary>
+struct FrameStatistics {
+	// submission
+	uint64_t executeCalls = 0;
+	uint64_t commandLists = 0;
+	uint64_t bundles = 0;
+
+	// work
+	uint64_t draws = 0;
+	uint64_t indexedDraws = 0;
+	uint64_t instances = 0;
+	uint64_t dispatches = 0;
+	uint64_t copies = 0;
+	uint64_t clears = 0;
+
+	// synchronization
+	uint64_t barrierCalls = 0;
+	uint64_t barriers = 0;
+	uint64_t redundantBarriers = 0; ///< Transitions where the before and after states are the same.
+
+	// binding, redundant means the same object was already bound in the same command list
+	uint64_t pipelineStateBinds = 0;
+	uint64_t redundantPipelineStateBinds = 0;
+	uint64_t rootSignatureBinds = 0;
+	uint64_t redundantRootSignatureBinds = 0;
+	uint64_t descriptorHeapBinds = 0;
+	uint64_t redundantDescriptorHeapBinds = 0;
+	uint64_t descriptorTableBinds = 0;
+	uint64_t redundantDescriptorTableBinds = 0;
+	uint64_t rootViewBinds = 0;
+	uint64_t redundantRootViewBinds = 0;
+	uint64_t rootConstantBinds = 0;
+
+	// descriptors
+	uint64_t descriptorCopyCalls = 0;
+	uint64_t descriptorsCopied = 0;
+
+	FrameStatistics& operator+=(const FrameStatistics& rhs);
+};
+
+
+/// <summary> Results of replaying a whole capture. </summary>
+struct CaptureStatistics {
+	static constexpr size_t HistogramSize = 24;
+
+	std::vector<FrameStatistics> frames;
+	FrameStatistics total;
+	/// <summary>
+	/// Draw call histogram by size. Bucket i counts draws of [2^i, 2^(i+1)) vertices or indices
+	/// times instances, the last bucket also holds everything larger.
+	/// </summary>
+	std::array<uint64_t, HistogramSize> drawSizeHistogram = {};
+};
+
+
+/// <summary> Replays a capture recorded by the capturing graphics api on the CPU and collects statistics. </summary>
+/// <exception cref="gxapi::InvalidArgument"> If the data is not a valid capture. </exception>
+CaptureStatistics AnalyzeCapture(const void* data, size_t size);
+
+/// <summary> Prints a human readable summary, with per-frame averages and the draw histogram. </summary>
+void PrintCaptureReport(std::ostream& os, const CaptureStatistics& statistics);
+
+
+} // namespace gxapi_capture
+} // namespace inl
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <type_traits>
+#include <stdexcept>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+//------------------------------------------------------------------------------
+// Binary layout of a capture:
+//	header: CaptureMagic, CaptureVersion
+//	records: eCaptureCommand (1 byte) followed by the command's fixed payload.
+// Command lists are written into the stream when they are executed,
+// enclosed in COMMAND_LIST_BEGIN and COMMAND_LIST_END.
+// Objects (pipeline states, root signatures, heaps, resources) are referred to
+// by small integer ids assigned on creation, zero means null or unknown.
+//------------------------------------------------------------------------------
+
+constexpr uint32_t CaptureMagic = 0x50414349; // "ICAP"
+constexpr uint32_t CaptureVersion = 1;
+
+
+enum class eCaptureCommand : uint8_t {
+	FRAME_END,				// -
+	EXECUTE_COMMAND_LISTS,	// u32 queueId, u32 numCommandLists
+	COMMAND_LIST_BEGIN,		// u32 listId, u8 listType
+	COMMAND_LIST_END,		// -
+	SET_PIPELINE_STATE,		// u32 psoId
+	SET_ROOT_SIGNATURE,		// u8 isCompute, u32 rootSignatureId
+	SET_DESCRIPTOR_HEAPS,	// u32 count, count * u32 heapId
+	SET_DESCRIPTOR_TABLE,	// u8 isCompute, u32 parameterIndex, u64 gpuHandle
+	SET_ROOT_CONSTANTS,		// u8 isCompute, u32 parameterIndex, u32 numValues
+	SET_ROOT_VIEW,			// u8 isCompute, u32 parameterIndex, u64 gpuAddress
+	COPY_DESCRIPTORS,		// u32 numDescriptors
+	RESOURCE_BARRIER,		// u32 numBarriers, numBarriers * CaptureBarrier
+	DRAW,					// u32 numVertices, u32 numInstances
+	DRAW_INDEXED,			// u32 numIndices, u32 numInstances
+	DISPATCH,				// u32 x, u32 y, u32 z
+	EXECUTE_BUNDLE,			// u32 bundleId
+	COPY,					// -
+	CLEAR,					// -
+
+	COUNT,
+};
+
+
+#pragma pack(push, 1)
+struct CaptureBarrier {
+	uint8_t type; // gxapi::eResourceBarrierType
+	uint32_t resourceId;
+	uint32_t subresource;
+	uint32_t stateBefore;
+	uint32_t stateAfter;
+};
+#pragma pack(pop)
+
+
+
+/// <summary> Appends plain-old-data records to a byte buffer. </summary>
+class CaptureWriter {
+public:
+	void Command(eCaptureCommand command) {
+		Write(command);
+	}
+
+	template <class T>
+	void Write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only POD values can be captured.");
+		size_t offset = m_data.size();
+		m_data.resize(offset + sizeof(T));
+		memcpy(m_data.data() + offset, &value, sizeof(T));
+	}
+
+	void Append(const std::vector<uint8_t>& data) {
+		m_data.insert(m_data.end(), data.begin(), data.end());
+	}
+
+	void Clear() { m_data.clear(); }
+	bool IsEmpty() const { return m_data.empty(); }
+	const std::vector<uint8_t>& GetData() const { return m_data; }
+	std::vector<uint8_t>& GetData() { return m_data; }
+private:
+	std::vector<uint8_t> m_data;
+};
+
+
+
+/// <summary> Reads back records written by <see cref="CaptureWriter"/>. </summary>
+/// <exception cref="std::out_of_range"> On reading past the end of the stream. </exception>
+class CaptureReader {
+public:
+	CaptureReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0) {}
+
+	template <class T>
+	T Read() {
+		static_assert(std::is_trivially_copyable<T>::value, "Only POD values can be captured.");
+		if (m_offset + sizeof(T) > m_size) {
+			throw std::out_of_range("Capture stream is truncated.");
+		}
+		T value;
+		memcpy(&value, m_data + m_offset, sizeof(T));
+		m_offset += sizeof(T);
+		return value;
+	}
+
+	/// <summary> Reads the number of elements that follow, checked against the bytes left before anything is allocated for them. </summary>
+	uint32_t ReadCount(size_t elementSize) {
+		uint32_t count = Read<uint32_t>();
+		if (count > (m_size - m_offset) / elementSize) {
+			throw std::out_of_range("Capture stream is truncated.");
+		}
+		return count;
+	}
+
+	bool IsEnd() const { return m_offset >= m_size; }
+	size_t GetOffset() const { return m_offset; }
+private:
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_offset;
+};
+
+
+} // namespace gxapi_capture
+} // namespace inl
@@ -0,0 +1,425 @@
+#include "CommandList.hpp"
+#include "GraphicsApi.hpp"
+#include "Objects.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+//------------------------------------------------------------------------------
+// Basic command list
+//------------------------------------------------------------------------------
+
+BasicCommandList::BasicCommandList(GraphicsApi* api, gxapi::ICommandList* list)
+	: m_api(api), m_list(list)
+{
+	m_id = m_api->NewObjectId();
+}
+
+
+gxapi::eCommandListType BasicCommandList::GetType() const {
+	return m_list->GetType();
+}
+
+
+//------------------------------------------------------------------------------
+// Copy command list
+//------------------------------------------------------------------------------
+
+CopyCommandList::CopyCommandList(GraphicsApi* api, gxapi::ICopyCommandList* list, gxapi::IPipelineState* initialState)
+	: BasicCommandList(api, list), m_copyList(list)
+{
+	RecordPipelineState(initialState);
+}
+
+
+void CopyCommandList::Close() {
+	m_copyList->Close();
+}
+
+
+void CopyCommandList::Reset(gxapi::ICommandAllocator* allocator, gxapi::IPipelineState* newState) {
+	m_copyList->Reset(allocator, Unwrap(newState));
+	m_commands.Clear();
+	RecordPipelineState(newState);
+}
+
+
+void CopyCommandList::CopyBuffer(gxapi::IResource* dst, size_t dstOffset, gxapi::IResource* src, size_t srcOffset, size_t numBytes) {
+	m_copyList->CopyBuffer(Unwrap(dst), dstOffset, Unwrap(src), srcOffset, numBytes);
+	m_commands.Command(eCaptureCommand::COPY);
+}
+
+
+void CopyCommandList::CopyResource(gxapi::IResource* dst, gxapi::IResource* src) {
+	m_copyList->CopyResource(Unwrap(dst), Unwrap(src));
+	m_commands.Command(eCaptureCommand::COPY);
+}
+
+
+void CopyCommandList::CopyTexture(gxapi::IResource* dst,
+								  unsigned dstSubresourceIndex,
+								  int dstX, int dstY, int dstZ,
+								  gxapi::IResource* src,
+								  unsigned srcSubresourceIndex,
+								  gxapi::Cube srcRegion)
+{
+	m_copyList->CopyTexture(Unwrap(dst), dstSubresourceIndex, dstX, dstY, dstZ, Unwrap(src), srcSubresourceIndex, srcRegion);
+	m_commands.Command(eCaptureCommand::COPY);
+}
+
+
+void CopyCommandList::CopyTexture(gxapi::IResource* dst,
+								  gxapi::TextureCopyDesc dstDesc,
+								  int dstX, int dstY, int dstZ,
+								  gxapi::IResource* src,
+								  gxapi::TextureCopyDesc srcDesc,
+								  gxapi::Cube srcRegion)
+{
+	m_copyList->CopyTexture(Unwrap(dst), dstDesc, dstX, dstY, dstZ, Unwrap(src), srcDesc, srcRegion);
+	m_commands.Command(eCaptureCommand::COPY);
+}
+
+
+void CopyCommandList::CopyTexture(gxapi::IResource* dst,
+								  gxapi::TextureCopyDesc dstDesc,
+								  int dstX, int dstY, int dstZ,
+								  gxapi::IResource* src,
+								  gxapi::TextureCopyDesc srcDesc)
+{
+	m_copyList->CopyTexture(Unwrap(dst), dstDesc, dstX, dstY, dstZ, Unwrap(src), srcDesc);
+	m_commands.Command(eCaptureCommand::COPY);
+}
+
+
+void CopyCommandList::ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) {
+	m_unwrappedBarriers.assign(barriers, barriers + numBarriers);
+	for (auto& barrier : m_unwrappedBarriers) {
+		if (barrier.type == gxapi::eResourceBarrierType::TRANSITION) {
+			barrier.transition.resource = Unwrap(barrier.transition.resource);
+		}
+		else if (barrier.type == gxapi::eResourceBarrierType::UAV) {
+			barrier.uav.resource = Unwrap(barrier.uav.resource);
+		}
+	}
+	m_copyList->ResourceBarrier(numBarriers, m_unwrappedBarriers.data());
+
+	m_commands.Command(eCaptureCommand::RESOURCE_BARRIER);
+	m_commands.Write(uint32_t(numBarriers));
+	for (unsigned i = 0; i < numBarriers; ++i) {
+		const gxapi::ResourceBarrier& barrier = barriers[i];
+		CaptureBarrier record = {};
+		record.type = (uint8_t)barrier.type;
+		if (barrier.type == gxapi::eResourceBarrierType::TRANSITION) {
+			gxapi::eResourceState before = barrier.transition.beforeState;
+			gxapi::eResourceState after = barrier.transition.afterState;
+			record.resourceId = GetObjectId(barrier.transition.resource);
+			record.subresource = barrier.transition.subResource;
+			record.stateBefore = (uint32_t)(gxapi::eResourceState::EnumT)before;
+			record.stateAfter = (uint32_t)(gxapi::eResourceState::EnumT)after;
+		}
+		else if (barrier.type == gxapi::eResourceBarrierType::UAV) {
+			record.resourceId = GetObjectId(barrier.uav.resource);
+		}
+		m_commands.Write(record);
+	}
+}
+
+
+void CopyCommandList::EndQuery(gxapi::IQueryHeap* heap, unsigned index) {
+	m_copyList->EndQuery(heap, index);
+}
+
+
+void CopyCommandList::ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, uint64_t destinationOffset) {
+	m_copyList->ResolveQueryData(heap, firstIndex, numQueries, Unwrap(destination), destinationOffset);
+}
+
+
+void CopyCommandList::RecordPipelineState(gxapi::IPipelineState* pipelineState) {
+	if (pipelineState != nullptr) {
+		m_commands.Command(eCaptureCommand::SET_PIPELINE_STATE);
+		m_commands.Write(GetObjectId(pipelineState));
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Compute command list
+//------------------------------------------------------------------------------
+
+ComputeCommandList::ComputeCommandList(GraphicsApi* api, gxapi::IComputeCommandList* list, gxapi::IPipelineState* initialState)
+	: CopyCommandList(api, list, initialState), m_computeList(list)
+{}
+
+
+void ComputeCommandList::Dispatch(size_t dimx, size_t dimy, size_t dimz) {
+	m_computeList->Dispatch(dimx, dimy, dimz);
+
+	m_commands.Command(eCaptureCommand::DISPATCH);
+	m_commands.Write(uint32_t(dimx));
+	m_commands.Write(uint32_t(dimy));
+	m_commands.Write(uint32_t(dimz));
+}
+
+
+void ComputeCommandList::SetComputeRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) {
+	m_computeList->SetComputeRootConstant(parameterIndex, destOffset, value);
+	RecordRootConstants(true, parameterIndex, 1);
+}
+
+
+void ComputeCommandList::SetComputeRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) {
+	m_computeList->SetComputeRootConstants(parameterIndex, destOffset, numValues, value);
+	RecordRootConstants(true, parameterIndex, numValues);
+}
+
+
+void ComputeCommandList::SetComputeRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_computeList->SetComputeRootConstantBuffer(parameterIndex, gpuVirtualAddress);
+	RecordRootView(true, parameterIndex, gpuVirtualAddress);
+}
+
+
+void ComputeCommandList::SetComputeRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) {
+	m_computeList->SetComputeRootDescriptorTable(parameterIndex, baseHandle);
+	RecordDescriptorTable(true, parameterIndex, baseHandle);
+}
+
+
+void ComputeCommandList::SetComputeRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_computeList->SetComputeRootShaderResource(parameterIndex, gpuVirtualAddress);
+	RecordRootView(true, parameterIndex, gpuVirtualAddress);
+}
+
+
+void ComputeCommandList::SetComputeRootUnorderedResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_computeList->SetComputeRootUnorderedResource(parameterIndex, gpuVirtualAddress);
+	RecordRootView(true, parameterIndex, gpuVirtualAddress);
+}
+
+
+void ComputeCommandList::SetComputeRootSignature(gxapi::IRootSignature* rootSignature) {
+	m_computeList->SetComputeRootSignature(Unwrap(rootSignature));
+	RecordRootSignature(true, rootSignature);
+}
+
+
+void ComputeCommandList::SetPipelineState(gxapi::IPipelineState* pipelineState) {
+	m_computeList->SetPipelineState(Unwrap(pipelineState));
+	RecordPipelineState(pipelineState);
+}
+
+
+void ComputeCommandList::ResetState(gxapi::IPipelineState* initialPipelineState) {
+	m_computeList->ResetState(Unwrap(initialPipelineState));
+	RecordPipelineState(initialPipelineState);
+}
+
+
+void ComputeCommandList::SetDescriptorHeaps(gxapi::IDescriptorHeap*const * heaps, uint32_t count) {
+	m_unwrappedHeaps.resize(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		m_unwrappedHeaps[i] = Unwrap(heaps[i]);
+	}
+	m_computeList->SetDescriptorHeaps(m_unwrappedHeaps.data(), count);
+
+	m_commands.Command(eCaptureCommand::SET_DESCRIPTOR_HEAPS);
+	m_commands.Write(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		m_commands.Write(GetObjectId(heaps[i]));
+	}
+}
+
+
+void ComputeCommandList::RecordRootConstants(bool isCompute, unsigned parameterIndex, unsigned numValues) {
+	m_commands.Command(eCaptureCommand::SET_ROOT_CONSTANTS);
+	m_commands.Write(uint8_t(isCompute));
+	m_commands.Write(uint32_t(parameterIndex));
+	m_commands.Write(uint32_t(numValues));
+}
+
+
+void ComputeCommandList::RecordRootView(bool isCompute, unsigned parameterIndex, const void* gpuVirtualAddress) {
+	m_commands.Command(eCaptureCommand::SET_ROOT_VIEW);
+	m_commands.Write(uint8_t(isCompute));
+	m_commands.Write(uint32_t(parameterIndex));
+	m_commands.Write(uint64_t(reinterpret_cast<uintptr_t>(gpuVirtualAddress)));
+}
+
+
+void ComputeCommandList::RecordDescriptorTable(bool isCompute, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) {
+	m_commands.Command(eCaptureCommand::SET_DESCRIPTOR_TABLE);
+	m_commands.Write(uint8_t(isCompute));
+	m_commands.Write(uint32_t(parameterIndex));
+	m_commands.Write(uint64_t(reinterpret_cast<uintptr_t>(baseHandle.gpuAddress)));
+}
+
+
+void ComputeCommandList::RecordRootSignature(bool isCompute, gxapi::IRootSignature* rootSignature) {
+	m_commands.Command(eCaptureCommand::SET_ROOT_SIGNATURE);
+	m_commands.Write(uint8_t(isCompute));
+	m_commands.Write(GetObjectId(rootSignature));
+}
+
+
+//------------------------------------------------------------------------------
+// Graphics command list
+//------------------------------------------------------------------------------
+
+GraphicsCommandList::GraphicsCommandList(GraphicsApi* api, gxapi::IGraphicsCommandList* list, gxapi::IPipelineState* initialState)
+	: ComputeCommandList(api, list, initialState), m_graphicsList(list)
+{}
+
+
+void GraphicsCommandList::ClearDepthStencil(gxapi::DescriptorHandle dsv,
+											float depth,
+											uint8_t stencil,
+											size_t numRects,
+											gxapi::Rectangle* rects,
+											bool clearDepth,
+											bool clearStencil)
+{
+	m_graphicsList->ClearDepthStencil(dsv, depth, stencil, numRects, rects, clearDepth, clearStencil);
+	m_commands.Command(eCaptureCommand::CLEAR);
+}
+
+
+void GraphicsCommandList::ClearRenderTarget(gxapi::DescriptorHandle rtv,
+											gxapi::ColorRGBA color,
+											size_t numRects,
+											gxapi::Rectangle* rects)
+{
+	m_graphicsList->ClearRenderTarget(rtv, color, numRects, rects);
+	m_commands.Command(eCaptureCommand::CLEAR);
+}
+
+
+void GraphicsCommandList::DrawIndexedInstanced(unsigned numIndices,
+											   unsigned startIndex,
+											   int vertexOffset,
+											   unsigned numInstances,
+											   unsigned startInstance)
+{
+	m_graphicsList->DrawIndexedInstanced(numIndices, startIndex, vertexOffset, numInstances, startInstance);
+
+	m_commands.Command(eCaptureCommand::DRAW_INDEXED);
+	m_commands.Write(uint32_t(numIndices));
+	m_commands.Write(uint32_t(numInstances));
+}
+
+
+void GraphicsCommandList::DrawInstanced(unsigned numVertices,
+										unsigned startVertex,
+										unsigned numInstances,
+										unsigned startInstance)
+{
+	m_graphicsList->DrawInstanced(numVertices, startVertex, numInstances, startInstance);
+
+	m_commands.Command(eCaptureCommand::DRAW);
+	m_commands.Write(uint32_t(numVertices));
+	m_commands.Write(uint32_t(numInstances));
+}
+
+
+void GraphicsCommandList::ExecuteBundle(IGraphicsCommandList* bundle) {
+	auto* wrapper = dynamic_cast<GraphicsCommandList*>(bundle);
+	if (wrapper == nullptr) {
+		throw gxapi::InvalidArgument("Bundle was not created by the capturing graphics api.", "bundle");
+	}
+	m_graphicsList->ExecuteBundle(wrapper->m_graphicsList);
+
+	m_commands.Command(eCaptureCommand::EXECUTE_BUNDLE);
+	m_commands.Write(wrapper->GetId());
+}
+
+
+void GraphicsCommandList::SetIndexBuffer(void* gpuVirtualAddress, size_t sizeInBytes, gxapi::eFormat format) {
+	m_graphicsList->SetIndexBuffer(gpuVirtualAddress, sizeInBytes, format);
+}
+
+
+void GraphicsCommandList::SetPrimitiveTopology(gxapi::ePrimitiveTopology topology) {
+	m_graphicsList->SetPrimitiveTopology(topology);
+}
+
+
+void GraphicsCommandList::SetVertexBuffers(unsigned startSlot,
+										   unsigned count,
+										   void** gpuVirtualAddress,
+										   unsigned* sizeInBytes,
+										   unsigned* strideInBytes)
+{
+	m_graphicsList->SetVertexBuffers(startSlot, count, gpuVirtualAddress, sizeInBytes, strideInBytes);
+}
+
+
+void GraphicsCommandList::SetRenderTargets(unsigned numRenderTargets,
+										   gxapi::DescriptorHandle* renderTargets,
+										   gxapi::DescriptorHandle* depthStencil)
+{
+	m_graphicsList->SetRenderTargets(numRenderTargets, renderTargets, depthStencil);
+}
+
+
+void GraphicsCommandList::SetBlendFactor(float r, float g, float b, float a) {
+	m_graphicsList->SetBlendFactor(r, g, b, a);
+}
+
+
+void GraphicsCommandList::SetStencilRef(unsigned stencilRef) {
+	m_graphicsList->SetStencilRef(stencilRef);
+}
+
+
+void GraphicsCommandList::SetScissorRects(unsigned numRects, gxapi::Rectangle* rects) {
+	m_graphicsList->SetScissorRects(numRects, rects);
+}
+
+
+void GraphicsCommandList::SetViewports(unsigned numViewports, gxapi::Viewport* viewports) {
+	m_graphicsList->SetViewports(numViewports, viewports);
+}
+
+
+void GraphicsCommandList::SetGraphicsRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) {
+	m_graphicsList->SetGraphicsRootConstant(parameterIndex, destOffset, value);
+	RecordRootConstants(false, parameterIndex, 1);
+}
+
+
+void GraphicsCommandList::SetGraphicsRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) {
+	m_graphicsList->SetGraphicsRootConstants(parameterIndex, destOffset, numValues, value);
+	RecordRootConstants(false, parameterIndex, numValues);
+}
+
+
+void GraphicsCommandList::SetGraphicsRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_graphicsList->SetGraphicsRootConstantBuffer(parameterIndex, gpuVirtualAddress);
+	RecordRootView(false, parameterIndex, gpuVirtualAddress);
+}
+
+
+void GraphicsCommandList::SetGraphicsRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) {
+	m_graphicsList->SetGraphicsRootDescriptorTable(parameterIndex, baseHandle);
+	RecordDescriptorTable(false, parameterIndex, baseHandle);
+}
+
+
+void GraphicsCommandList::SetGraphicsRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	m_graphicsList->SetGraphicsRootShaderResource(parameterIndex, gpuVirtualAddress);
+	RecordRootView(false, parameterIndex, gpuVirtualAddress);
+}
+
+
+void GraphicsCommandList::SetGraphicsRootSignature(gxapi::IRootSignature* rootSignature) {
+	m_graphicsList->SetGraphicsRootSignature(Unwrap(rootSignature));
+	RecordRootSignature(false, rootSignature);
+}
+
+
+} // namespace gxapi_capture
+} // namespace inl
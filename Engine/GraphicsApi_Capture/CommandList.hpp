@@ -0,0 +1,206 @@
+#pragma once
+
+#include "../GraphicsApi_LL/ICommandList.hpp"
+#include "../GraphicsApi_LL/Common.hpp"
+#include "CaptureFormat.hpp"
+
+#include <memory>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4250)
+#endif
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+class GraphicsApi;
+
+
+/// <summary>
+/// Forwards every call to the wrapped command list and records the interesting ones.
+/// The recording is appended to the capture when the list is executed.
+/// </summary>
+class BasicCommandList : virtual public gxapi::ICommandList {
+public:
+	/// <param name="list"> The wrapped command list. Ownership is taken. </param>
+	BasicCommandList(GraphicsApi* api, gxapi::ICommandList* list);
+	virtual ~BasicCommandList() = default;
+
+	gxapi::eCommandListType GetType() const override;
+
+	gxapi::ICommandList* GetWrappedList() const { return m_list.get(); }
+	const CaptureWriter& GetCommands() const { return m_commands; }
+	uint32_t GetId() const { return m_id; }
+protected:
+	GraphicsApi* m_api;
+	std::unique_ptr<gxapi::ICommandList> m_list;
+	CaptureWriter m_commands;
+	uint32_t m_id;
+};
+
+
+
+class CopyCommandList : public BasicCommandList, virtual public gxapi::ICopyCommandList {
+public:
+	CopyCommandList(GraphicsApi* api, gxapi::ICopyCommandList* list, gxapi::IPipelineState* initialState);
+
+	// Command list state
+	void Close() override;
+	void Reset(gxapi::ICommandAllocator* allocator, gxapi::IPipelineState* newState = nullptr) override;
+
+	// Resource copy
+	void CopyBuffer(gxapi::IResource* dst,
+					size_t dstOffset,
+					gxapi::IResource* src,
+					size_t srcOffset,
+					size_t numBytes) override;
+
+	void CopyResource(gxapi::IResource* dst, gxapi::IResource* src) override;
+
+	void CopyTexture(gxapi::IResource* dst,
+					 unsigned dstSubresourceIndex,
+					 int dstX, int dstY, int dstZ,
+					 gxapi::IResource* src,
+					 unsigned srcSubresourceIndex,
+					 gxapi::Cube srcRegion) override;
+
+	void CopyTexture(gxapi::IResource* dst,
+					 gxapi::TextureCopyDesc dstDesc,
+					 int dstX, int dstY, int dstZ,
+					 gxapi::IResource* src,
+					 gxapi::TextureCopyDesc srcDesc,
+					 gxapi::Cube srcRegion) override;
+
+	void CopyTexture(gxapi::IResource* dst,
+					 gxapi::TextureCopyDesc dstDesc,
+					 int dstX, int dstY, int dstZ,
+					 gxapi::IResource* src,
+					 gxapi::TextureCopyDesc srcDesc) override;
+
+	// barriers
+	void ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) override;
+
+	// queries, not part of the captured workload
+	void EndQuery(gxapi::IQueryHeap* heap, unsigned index) override;
+	void ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, uint64_t destinationOffset) override;
+protected:
+	void RecordPipelineState(gxapi::IPipelineState* pipelineState);
+private:
+	gxapi::ICopyCommandList* m_copyList;
+	std::vector<gxapi::ResourceBarrier> m_unwrappedBarriers; // reused between calls
+};
+
+
+
+class ComputeCommandList : public CopyCommandList, virtual public gxapi::IComputeCommandList {
+public:
+	ComputeCommandList(GraphicsApi* api, gxapi::IComputeCommandList* list, gxapi::IPipelineState* initialState);
+
+	// draw
+	void Dispatch(size_t dimx, size_t dimy = 1, size_t dimz = 1) override;
+
+	// set compute root signature stuff
+	void SetComputeRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) override;
+	void SetComputeRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) override;
+	void SetComputeRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetComputeRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) override;
+	void SetComputeRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetComputeRootUnorderedResource(unsigned parameterIndex, void* gpuVirtualAddress) override;
+
+	void SetComputeRootSignature(gxapi::IRootSignature* rootSignature) override;
+
+	// set pipeline state
+	void SetPipelineState(gxapi::IPipelineState* pipelineState) override;
+	void ResetState(gxapi::IPipelineState* initialPipelineState) override;
+
+	// descriptor heaps
+	void SetDescriptorHeaps(gxapi::IDescriptorHeap*const * heaps, uint32_t count) override;
+protected:
+	void RecordRootConstants(bool isCompute, unsigned parameterIndex, unsigned numValues);
+	void RecordRootView(bool isCompute, unsigned parameterIndex, const void* gpuVirtualAddress);
+	void RecordDescriptorTable(bool isCompute, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
+	void RecordRootSignature(bool isCompute, gxapi::IRootSignature* rootSignature);
+private:
+	gxapi::IComputeCommandList* m_computeList;
+	std::vector<gxapi::IDescriptorHeap*> m_unwrappedHeaps; // reused between calls
+};
+
+
+
+class GraphicsCommandList : public ComputeCommandList, virtual public gxapi::IGraphicsCommandList {
+public:
+	GraphicsCommandList(GraphicsApi* api, gxapi::IGraphicsCommandList* list, gxapi::IPipelineState* initialState);
+
+	// Clear shit
+	void ClearDepthStencil(gxapi::DescriptorHandle dsv,
+						   float depth,
+						   uint8_t stencil,
+						   size_t numRects = 0,
+						   gxapi::Rectangle* rects = nullptr,
+						   bool clearDepth = true,
+						   bool clearStencil = false) override;
+
+	void ClearRenderTarget(gxapi::DescriptorHandle rtv,
+						   gxapi::ColorRGBA color,
+						   size_t numRects = 0,
+						   gxapi::Rectangle* rects = nullptr) override;
+
+	// Draw
+	void DrawIndexedInstanced(unsigned numIndices,
+							  unsigned startIndex = 0,
+							  int vertexOffset = 0,
+							  unsigned numInstances = 1,
+							  unsigned startInstance = 0) override;
+
+	void DrawInstanced(unsigned numVertices,
+					   unsigned startVertex = 0,
+					   unsigned numInstances = 1,
+					   unsigned startInstance = 0) override;
+
+	void ExecuteBundle(IGraphicsCommandList* bundle) override;
+
+	// input assembler
+	void SetIndexBuffer(void* gpuVirtualAddress, size_t sizeInBytes, gxapi::eFormat format) override;
+
+	void SetPrimitiveTopology(gxapi::ePrimitiveTopology topology) override;
+
+	void SetVertexBuffers(unsigned startSlot,
+						  unsigned count,
+						  void** gpuVirtualAddress,
+						  unsigned* sizeInBytes,
+						  unsigned* strideInBytes) override;
+
+	// output merger
+	void SetRenderTargets(unsigned numRenderTargets,
+						  gxapi::DescriptorHandle* renderTargets,
+						  gxapi::DescriptorHandle* depthStencil = nullptr) override;
+	void SetBlendFactor(float r, float g, float b, float a) override;
+	void SetStencilRef(unsigned stencilRef) override;
+
+	// rasterizer state
+	void SetScissorRects(unsigned numRects, gxapi::Rectangle* rects) override;
+	void SetViewports(unsigned numViewports, gxapi::Viewport* viewports) override;
+
+	// set graphics root signature stuff
+	void SetGraphicsRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) override;
+	void SetGraphicsRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) override;
+	void SetGraphicsRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) override;
+	void SetGraphicsRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) override;
+	void SetGraphicsRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) override;
+
+	void SetGraphicsRootSignature(gxapi::IRootSignature* rootSignature) override;
+private:
+	gxapi::IGraphicsCommandList* m_graphicsList;
+};
+
+
+#ifdef _MSC_VER
+#pragma warning(default: 4250)
+#endif
+
+
+} // namespace gxapi_capture
+} // namespace inl
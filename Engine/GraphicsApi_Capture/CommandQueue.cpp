@@ -0,0 +1,66 @@
+#include "CommandQueue.hpp"
+#include "CommandList.hpp"
+#include "GraphicsApi.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+CommandQueue::CommandQueue(GraphicsApi* api, gxapi::ICommandQueue* queue)
+	: m_api(api), m_queue(queue)
+{
+	m_id = m_api->NewObjectId();
+}
+
+
+void CommandQueue::ExecuteCommandLists(uint32_t numCommandLists, gxapi::ICommandList* const* commandLists) {
+	CaptureWriter submission;
+	submission.Command(eCaptureCommand::EXECUTE_COMMAND_LISTS);
+	submission.Write(m_id);
+	submission.Write(numCommandLists);
+
+	m_unwrappedLists.resize(numCommandLists);
+	for (uint32_t i = 0; i < numCommandLists; ++i) {
+		auto* list = dynamic_cast<BasicCommandList*>(commandLists[i]);
+		if (list == nullptr) {
+			throw gxapi::InvalidArgument("Command list was not created by the capturing graphics api.", "commandLists");
+		}
+		m_unwrappedLists[i] = list->GetWrappedList();
+
+		submission.Command(eCaptureCommand::COMMAND_LIST_BEGIN);
+		submission.Write(list->GetId());
+		submission.Write(uint8_t(list->GetType()));
+		submission.Append(list->GetCommands().GetData());
+		submission.Command(eCaptureCommand::COMMAND_LIST_END);
+	}
+
+	m_queue->ExecuteCommandLists(numCommandLists, m_unwrappedLists.data());
+	m_api->RecordSubmission(submission);
+}
+
+
+void CommandQueue::Signal(gxapi::IFence* fence, uint64_t value) {
+	m_queue->Signal(fence, value);
+}
+
+
+void CommandQueue::Wait(gxapi::IFence* fence, uint64_t value) {
+	m_queue->Wait(fence, value);
+}
+
+
+gxapi::CommandQueueDesc CommandQueue::GetDesc() const {
+	return m_queue->GetDesc();
+}
+
+
+uint64_t CommandQueue::GetTimestampFrequency() const {
+	return m_queue->GetTimestampFrequency();
+}
+
+
+} // namespace gxapi_capture
+} // namespace inl
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../GraphicsApi_LL/ICommandQueue.hpp"
+
+#include <memory>
+#include <vector>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+class GraphicsApi;
+
+
+/// <summary> Unwraps capturing command lists and writes their recordings to the capture on execution. </summary>
+class CommandQueue : public gxapi::ICommandQueue {
+public:
+	/// <param name="queue"> The wrapped queue. Ownership is taken. </param>
+	CommandQueue(GraphicsApi* api, gxapi::ICommandQueue* queue);
+	CommandQueue(const CommandQueue&) = delete;
+	CommandQueue& operator=(const CommandQueue&) = delete;
+
+	void ExecuteCommandLists(uint32_t numCommandLists, gxapi::ICommandList* const* commandLists) override;
+
+	void Signal(gxapi::IFence* fence, uint64_t value) override;
+	void Wait(gxapi::IFence* fence, uint64_t value) override;
+
+	gxapi::CommandQueueDesc GetDesc() const override;
+
+	uint64_t GetTimestampFrequency() const override;
+
+	GraphicsApi* GetApi() const { return m_api; }
+	gxapi::ICommandQueue* GetWrappedQueue() const { return m_queue.get(); }
+private:
+	GraphicsApi* m_api;
+	std::unique_ptr<gxapi::ICommandQueue> m_queue;
+	uint32_t m_id;
+	std::vector<gxapi::ICommandList*> m_unwrappedLists; // reused between submissions
+};
+
+
+} // namespace gxapi_capture
+} // namespace inl
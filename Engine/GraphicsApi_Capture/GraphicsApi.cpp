@@ -0,0 +1,395 @@
+#include "GraphicsApi.hpp"
+#include "CommandList.hpp"
+#include "CommandQueue.hpp"
+#include "Objects.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+#include <fstream>
+#include <numeric>
+#include <algorithm>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+GraphicsApi::GraphicsApi(gxapi::IGraphicsApi* api)
+	: m_api(api), m_nextObjectId(1)
+{
+	if (api == nullptr) {
+		throw gxapi::ArgumentNull("Cannot capture a null graphics api.");
+	}
+
+	m_stream.Write(CaptureMagic);
+	m_stream.Write(CaptureVersion);
+}
+
+
+GraphicsApi::~GraphicsApi() {
+	// the current frame is left unfinished in the file, the analyzer counts it as well
+	if (m_file.is_open()) {
+		FlushToFile();
+	}
+}
+
+
+gxapi::ICommandQueue* GraphicsApi::CreateCommandQueue(gxapi::CommandQueueDesc desc) {
+	return new CommandQueue(this, m_api->CreateCommandQueue(desc));
+}
+
+
+gxapi::ICommandAllocator* GraphicsApi::CreateCommandAllocator(gxapi::eCommandListType type) {
+	return m_api->CreateCommandAllocator(type);
+}
+
+
+gxapi::IGraphicsCommandList* GraphicsApi::CreateGraphicsCommandList(gxapi::CommandListDesc desc) {
+	gxapi::CommandListDesc unwrappedDesc(desc.allocator, Unwrap(desc.initialState));
+	return new GraphicsCommandList(this, m_api->CreateGraphicsCommandList(unwrappedDesc), desc.initialState);
+}
+
+
+gxapi::IComputeCommandList* GraphicsApi::CreateComputeCommandList(gxapi::CommandListDesc desc) {
+	gxapi::CommandListDesc unwrappedDesc(desc.allocator, Unwrap(desc.initialState));
+	return new ComputeCommandList(this, m_api->CreateComputeCommandList(unwrappedDesc), desc.initialState);
+}
+
+
+gxapi::ICopyCommandList* GraphicsApi::CreateCopyCommandList(gxapi::CommandListDesc desc) {
+	gxapi::CommandListDesc unwrappedDesc(desc.allocator, Unwrap(desc.initialState));
+	return new CopyCommandList(this, m_api->CreateCopyCommandList(unwrappedDesc), desc.initialState);
+}
+
+
+gxapi::IResource* GraphicsApi::CreateCommittedResource(gxapi::HeapProperties heapProperties,
+													   gxapi::eHeapFlags heapFlags,
+													   gxapi::ResourceDesc desc,
+													   gxapi::eResourceState initialState,
+													   gxapi::ClearValue* clearValue)
+{
+	return new Resource(this, m_api->CreateCommittedResource(heapProperties, heapFlags, desc, initialState, clearValue));
+}
+
+
+gxapi::IRootSignature* GraphicsApi::CreateRootSignature(gxapi::RootSignatureDesc desc) {
+	return new RootSignature(this, m_api->CreateRootSignature(desc));
+}
+
+
+gxapi::IPipelineState* GraphicsApi::CreateGraphicsPipelineState(const gxapi::GraphicsPipelineStateDesc& desc) {
+	gxapi::GraphicsPipelineStateDesc unwrappedDesc = desc;
+	unwrappedDesc.rootSignature = Unwrap(desc.rootSignature);
+	return new PipelineState(this, m_api->CreateGraphicsPipelineState(unwrappedDesc));
+}
+
+
+gxapi::IPipelineState* GraphicsApi::CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) {
+	gxapi::ComputePipelineStateDesc unwrappedDesc = desc;
+	unwrappedDesc.rootSignature = Unwrap(desc.rootSignature);
+	return new PipelineState(this, m_api->CreateComputePipelineState(unwrappedDesc));
+}
+
+
+gxapi::IDescriptorHeap* GraphicsApi::CreateDescriptorHeap(gxapi::DescriptorHeapDesc desc) {
+	return new DescriptorHeap(this, m_api->CreateDescriptorHeap(desc));
+}
+
+
+void GraphicsApi::CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc,
+										   gxapi::DescriptorHandle destination)
+{
+	m_api->CreateConstantBufferView(desc, destination);
+}
+
+
+void GraphicsApi::CreateDepthStencilView(gxapi::DepthStencilViewDesc desc,
+										 gxapi::DescriptorHandle destination)
+{
+	m_api->CreateDepthStencilView(desc, destination);
+}
+
+
+void GraphicsApi::CreateDepthStencilView(const gxapi::IResource* resource,
+										 gxapi::DescriptorHandle destination)
+{
+	m_api->CreateDepthStencilView(Unwrap(resource), destination);
+}
+
+
+void GraphicsApi::CreateDepthStencilView(const gxapi::IResource* resource,
+										 gxapi::DepthStencilViewDesc desc,
+										 gxapi::DescriptorHandle destination)
+{
+	m_api->CreateDepthStencilView(Unwrap(resource), desc, destination);
+}
+
+
+void GraphicsApi::CreateRenderTargetView(const gxapi::IResource* resource,
+										 gxapi::DescriptorHandle destination)
+{
+	m_api->CreateRenderTargetView(Unwrap(resource), destination);
+}
+
+
+void GraphicsApi::CreateRenderTargetView(const gxapi::IResource* resource,
+										 gxapi::RenderTargetViewDesc desc,
+										 gxapi::DescriptorHandle destination)
+{
+	m_api->CreateRenderTargetView(Unwrap(resource), desc, destination);
+}
+
+
+void GraphicsApi::CreateShaderResourceView(gxapi::ShaderResourceViewDesc desc,
+										   gxapi::DescriptorHandle destination)
+{
+	m_api->CreateShaderResourceView(desc, destination);
+}
+
+
+void GraphicsApi::CreateShaderResourceView(const gxapi::IResource* resource,
+										   gxapi::DescriptorHandle destination)
+{
+	m_api->CreateShaderResourceView(Unwrap(resource), destination);
+}
+
+
+void GraphicsApi::CreateShaderResourceView(const gxapi::IResource* resource,
+										   gxapi::ShaderResourceViewDesc desc,
+										   gxapi::DescriptorHandle destination)
+{
+	m_api->CreateShaderResourceView(Unwrap(resource), desc, destination);
+}
+
+
+void GraphicsApi::CreateUnorderedAccessView(gxapi::UnorderedAccessViewDesc descriptor,
+											gxapi::DescriptorHandle destination)
+{
+	m_api->CreateUnorderedAccessView(descriptor, destination);
+}
+
+
+void GraphicsApi::CreateUnorderedAccessView(const gxapi::IResource* resource,
+											gxapi::DescriptorHandle destination)
+{
+	m_api->CreateUnorderedAccessView(Unwrap(resource), destination);
+}
+
+
+void GraphicsApi::CreateUnorderedAccessView(const gxapi::IResource* resource,
+											gxapi::UnorderedAccessViewDesc descriptor,
+											gxapi::DescriptorHandle destination)
+{
+	m_api->CreateUnorderedAccessView(Unwrap(resource), descriptor, destination);
+}
+
+
+void GraphicsApi::CopyDescriptors(size_t numSrcDescRanges,
+								  gxapi::DescriptorHandle* srcRangeStarts,
+								  size_t numDstDescRanges,
+								  gxapi::DescriptorHandle* dstRangeStarts,
+								  uint32_t* rangeCounts,
+								  gxapi::eDescriptorHeapType descHeapsType)
+{
+	m_api->CopyDescriptors(numSrcDescRanges, srcRangeStarts, numDstDescRanges, dstRangeStarts, rangeCounts, descHeapsType);
+
+	// sources are single descriptors
+	RecordDescriptorCopy(numSrcDescRanges);
+}
+
+
+void GraphicsApi::CopyDescriptors(size_t numSrcDescRanges,
+								  gxapi::DescriptorHandle* srcRangeStarts,
+								  uint32_t* srcRangeLengths,
+								  size_t numDstDescRanges,
+								  gxapi::DescriptorHandle* dstRangeStarts,
+								  uint32_t* dstRangeLengths,
+								  gxapi::eDescriptorHeapType descHeapsType)
+{
+	m_api->CopyDescriptors(numSrcDescRanges, srcRangeStarts, srcRangeLengths, numDstDescRanges, dstRangeStarts, dstRangeLengths, descHeapsType);
+
+	uint64_t numDescriptors = srcRangeLengths ? std::accumulate(srcRangeLengths, srcRangeLengths + numSrcDescRanges, uint64_t(0)) : numSrcDescRanges;
+	RecordDescriptorCopy(numDescriptors);
+}
+
+
+void GraphicsApi::CopyDescriptors(gxapi::DescriptorHandle srcStart,
+								  gxapi::DescriptorHandle dstStart,
+								  size_t rangeCount,
+								  gxapi::eDescriptorHeapType descHeapsType)
+{
+	m_api->CopyDescriptors(srcStart, dstStart, rangeCount, descHeapsType);
+
+	RecordDescriptorCopy(rangeCount);
+}
+
+
+gxapi::IFence* GraphicsApi::CreateFence(uint64_t initialValue) {
+	return m_api->CreateFence(initialValue);
+}
+
+
+gxapi::IQueryHeap* GraphicsApi::CreateQueryHeap(gxapi::QueryHeapDesc desc) {
+	return m_api->CreateQueryHeap(desc);
+}
+
+
+void GraphicsApi::MakeResident(const std::vector<gxapi::IResource*>& objects) {
+	std::vector<gxapi::IResource*> unwrapped(objects.size());
+	std::transform(objects.begin(), objects.end(), unwrapped.begin(), [](gxapi::IResource* object) { return Unwrap(object); });
+	m_api->MakeResident(unwrapped);
+}
+
+
+void GraphicsApi::Evict(const std::vector<gxapi::IResource*>& objects) {
+	std::vector<gxapi::IResource*> unwrapped(objects.size());
+	std::transform(objects.begin(), objects.end(), unwrapped.begin(), [](gxapi::IResource* object) { return Unwrap(object); });
+	m_api->Evict(unwrapped);
+}
+
+
+void GraphicsApi::ReportLiveObjects() const {
+	m_api->ReportLiveObjects();
+}
+
+
+uint32_t GraphicsApi::NewObjectId() {
+	return m_nextObjectId++;
+}
+
+
+void GraphicsApi::RecordSubmission(const CaptureWriter& commands) {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	if (m_isFrameDropped) {
+		return;
+	}
+	m_stream.Append(commands.GetData());
+	EnforceMemoryLimit();
+}
+
+
+void GraphicsApi::EndFrame() {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	if (m_isFrameDropped) {
+		m_isFrameDropped = false;
+		++m_numDroppedFrames;
+		return;
+	}
+
+	m_stream.Command(eCaptureCommand::FRAME_END);
+	if (m_file.is_open()) {
+		FlushToFile();
+	}
+	else {
+		m_frameEnds.push_back(m_stream.GetData().size());
+		EnforceMemoryLimit();
+	}
+}
+
+
+void GraphicsApi::SetMemoryLimit(size_t bytes) {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	m_memoryLimit = bytes;
+	EnforceMemoryLimit();
+}
+
+
+void GraphicsApi::StreamToFile(const std::string& path) {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	if (m_file.is_open()) {
+		throw gxapi::InvalidCall("Capture is already streamed to a file.");
+	}
+
+	m_file.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open()) {
+		throw gxapi::InvalidArgument("Cannot open capture file for writing.", "path");
+	}
+	m_frameEnds.clear();
+	FlushToFile();
+}
+
+
+uint64_t GraphicsApi::GetNumDroppedFrames() const {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	return m_numDroppedFrames;
+}
+
+
+std::vector<uint8_t> GraphicsApi::GetCapture() const {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	if (m_file.is_open()) {
+		throw gxapi::InvalidCall("Capture is streamed to a file.");
+	}
+	return m_stream.GetData();
+}
+
+
+void GraphicsApi::SaveCapture(const std::string& path) const {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	if (m_file.is_open()) {
+		throw gxapi::InvalidCall("Capture is streamed to a file.");
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		throw gxapi::InvalidArgument("Cannot open capture file for writing.", "path");
+	}
+	const auto& data = m_stream.GetData();
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+
+void GraphicsApi::RecordDescriptorCopy(uint64_t numDescriptors) {
+	std::lock_guard<std::mutex> lkg(m_streamMutex);
+	if (m_isFrameDropped) {
+		return;
+	}
+	m_stream.Command(eCaptureCommand::COPY_DESCRIPTORS);
+	m_stream.Write(uint32_t(numDescriptors));
+	EnforceMemoryLimit();
+}
+
+
+void GraphicsApi::EnforceMemoryLimit() {
+	std::vector<uint8_t>& data = m_stream.GetData();
+	if (data.size() <= m_memoryLimit) {
+		return;
+	}
+
+	if (m_file.is_open()) {
+		FlushToFile();
+		return;
+	}
+
+	// drop the fewest oldest frames that bring the capture within the limit, the header stays
+	constexpr size_t headerSize = sizeof(CaptureMagic) + sizeof(CaptureVersion);
+	size_t numFrames = 0;
+	size_t droppedEnd = headerSize;
+	while (numFrames < m_frameEnds.size() && data.size() - (droppedEnd - headerSize) > m_memoryLimit) {
+		droppedEnd = m_frameEnds[numFrames++];
+	}
+	data.erase(data.begin() + headerSize, data.begin() + droppedEnd);
+	m_frameEnds.erase(m_frameEnds.begin(), m_frameEnds.begin() + numFrames);
+	for (size_t& frameEnd : m_frameEnds) {
+		frameEnd -= droppedEnd - headerSize;
+	}
+	m_numDroppedFrames += numFrames;
+
+	// all complete frames are gone and the current one alone is too large, it is dropped when it ends
+	if (data.size() > m_memoryLimit) {
+		data.resize(headerSize);
+		m_isFrameDropped = true;
+	}
+}
+
+
+void GraphicsApi::FlushToFile() {
+	const std::vector<uint8_t>& data = m_stream.GetData();
+	m_file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	m_file.flush();
+	m_stream.Clear();
+}
+
+
+} // namespace gxapi_capture
+} // namespace inl
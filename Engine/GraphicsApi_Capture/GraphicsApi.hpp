@@ -0,0 +1,180 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "CaptureFormat.hpp"
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <string>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+/// <summary>
+/// Wraps another graphics API and records the rendering-relevant calls into a
+/// binary stream, one frame at a time. Command lists, queues and the objects the
+/// capture refers to are wrapped, every other object is handed out from the
+/// wrapped API as is.
+/// </summary>
+/// <remarks>
+/// The capture is kept in memory up to a limit, past which the oldest frames are
+/// dropped, or it is streamed to a file frame by frame.
+/// </remarks>
+class GraphicsApi : public gxapi::IGraphicsApi {
+public:
+	/// <param name="api"> The API to forward calls to. Ownership is taken. </param>
+	GraphicsApi(gxapi::IGraphicsApi* api);
+	~GraphicsApi();
+
+	// Command submission
+	gxapi::ICommandQueue* CreateCommandQueue(gxapi::CommandQueueDesc desc) override;
+
+	gxapi::ICommandAllocator* CreateCommandAllocator(gxapi::eCommandListType type) override;
+
+	gxapi::IGraphicsCommandList* CreateGraphicsCommandList(gxapi::CommandListDesc desc) override;
+	gxapi::IComputeCommandList* CreateComputeCommandList(gxapi::CommandListDesc desc) override;
+	gxapi::ICopyCommandList* CreateCopyCommandList(gxapi::CommandListDesc desc) override;
+
+	// Resources
+	gxapi::IResource* CreateCommittedResource(gxapi::HeapProperties heapProperties,
+											  gxapi::eHeapFlags heapFlags,
+											  gxapi::ResourceDesc desc,
+											  gxapi::eResourceState initialState,
+											  gxapi::ClearValue* clearValue = nullptr) override;
+
+
+	// Pipeline and binding
+	gxapi::IRootSignature* CreateRootSignature(gxapi::RootSignatureDesc desc) override;
+
+	gxapi::IPipelineState* CreateGraphicsPipelineState(const gxapi::GraphicsPipelineStateDesc& desc) override;
+	gxapi::IPipelineState* CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) override;
+
+	gxapi::IDescriptorHeap* CreateDescriptorHeap(gxapi::DescriptorHeapDesc desc) override;
+
+
+	void CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+
+	void CreateDepthStencilView(gxapi::DepthStencilViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+	void CreateDepthStencilView(const gxapi::IResource* resource,
+								gxapi::DescriptorHandle destination) override;
+	void CreateDepthStencilView(const gxapi::IResource* resource,
+								gxapi::DepthStencilViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+
+	void CreateRenderTargetView(const gxapi::IResource* resource,
+								gxapi::DescriptorHandle destination) override;
+	void CreateRenderTargetView(const gxapi::IResource* resource,
+								gxapi::RenderTargetViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+
+	void CreateShaderResourceView(gxapi::ShaderResourceViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+	void CreateShaderResourceView(const gxapi::IResource* resource,
+								  gxapi::DescriptorHandle destination) override;
+	void CreateShaderResourceView(const gxapi::IResource* resource,
+								  gxapi::ShaderResourceViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+
+	void CreateUnorderedAccessView(gxapi::UnorderedAccessViewDesc descriptor,
+								   gxapi::DescriptorHandle destination) override;
+	void CreateUnorderedAccessView(const gxapi::IResource* resource,
+								   gxapi::DescriptorHandle destination) override;
+	void CreateUnorderedAccessView(const gxapi::IResource* resource,
+								   gxapi::UnorderedAccessViewDesc descriptor,
+								   gxapi::DescriptorHandle destination) override;
+
+	void CopyDescriptors(size_t numSrcDescRanges,
+						 gxapi::DescriptorHandle* srcRangeStarts,
+						 size_t numDstDescRanges,
+						 gxapi::DescriptorHandle* dstRangeStarts,
+						 uint32_t* rangeCounts,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+
+	void CopyDescriptors(size_t numSrcDescRanges,
+						 gxapi::DescriptorHandle* srcRangeStarts,
+						 uint32_t* srcRangeLengths,
+						 size_t numDstDescRanges,
+						 gxapi::DescriptorHandle* dstRangeStarts,
+						 uint32_t* dstRangeLengths,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+
+	void CopyDescriptors(gxapi::DescriptorHandle srcStart,
+						 gxapi::DescriptorHandle dstStart,
+						 size_t rangeCount,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+
+	// Misc
+	gxapi::IFence* CreateFence(uint64_t initialValue) override;
+	gxapi::IQueryHeap* CreateQueryHeap(gxapi::QueryHeapDesc desc) override;
+
+	void MakeResident(const std::vector<gxapi::IResource*>& objects) override;
+	void Evict(const std::vector<gxapi::IResource*>& objects) override;
+
+	// Debug
+	void ReportLiveObjects() const override;
+
+	// Capture specific
+	/// <summary> Returns an id for a new object. Ids are never reused, not even for the address of a released object. </summary>
+	uint32_t NewObjectId();
+
+	/// <summary> Appends the recorded contents of executed command lists to the capture. </summary>
+	void RecordSubmission(const CaptureWriter& commands);
+	/// <summary> Marks the end of a frame. Called on present, or manually when running without a swap chain. </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Sets how many bytes of the capture may be kept in memory. Past the limit, the oldest
+	/// frames are dropped as a whole, and so is the current frame if it alone is larger.
+	/// When streaming to a file, the recording is written out instead.
+	/// </summary>
+	void SetMemoryLimit(size_t bytes);
+	/// <summary>
+	/// Writes the capture to a file from now on, starting with what was recorded so far.
+	/// The recording is written at the end of each frame, or sooner if it reaches the memory limit.
+	/// </summary>
+	/// <exception cref="gxapi::InvalidArgument"> If the file cannot be opened. </exception>
+	/// <exception cref="gxapi::InvalidCall"> If already streaming. </exception>
+	void StreamToFile(const std::string& path);
+	/// <summary> The number of frames dropped to keep the capture within the memory limit. </summary>
+	uint64_t GetNumDroppedFrames() const;
+
+	/// <summary> Returns a copy of everything recorded and not dropped so far. </summary>
+	/// <exception cref="gxapi::InvalidCall"> If streaming to a file. </exception>
+	std::vector<uint8_t> GetCapture() const;
+	/// <summary> Writes the capture to a file. </summary>
+	/// <exception cref="gxapi::InvalidArgument"> If the file cannot be opened. </exception>
+	/// <exception cref="gxapi::InvalidCall"> If streaming to a file. </exception>
+	void SaveCapture(const std::string& path) const;
+
+	static constexpr size_t DefaultMemoryLimit = 256 * 1024 * 1024;
+
+	gxapi::IGraphicsApi* GetWrappedApi() const { return m_api.get(); }
+private:
+	void RecordDescriptorCopy(uint64_t numDescriptors);
+	/// <summary> Writes the recording to the file, or drops frames from it to fit in the memory limit. </summary>
+	void EnforceMemoryLimit();
+	void FlushToFile();
+private:
+	std::unique_ptr<gxapi::IGraphicsApi> m_api;
+	std::atomic<uint32_t> m_nextObjectId;
+
+	// Capture stream, guarded by the mutex
+	mutable std::mutex m_streamMutex;
+	CaptureWriter m_stream;
+	std::deque<size_t> m_frameEnds; // offsets of the completed frames kept in memory
+	size_t m_memoryLimit = DefaultMemoryLimit;
+	bool m_isFrameDropped = false; // the rest of the current frame is not recorded
+	uint64_t m_numDroppedFrames = 0;
+	std::ofstream m_file;
+};
+
+
+} // namespace gxapi_capture
+} // namespace inl
@@ -0,0 +1,65 @@
+#include "GxapiManager.hpp"
+#include "GraphicsApi.hpp"
+#include "CommandQueue.hpp"
+#include "SwapChain.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+GxapiManager::GxapiManager(gxapi::IGxapiManager* manager)
+	: m_manager(manager)
+{
+	if (manager == nullptr) {
+		throw gxapi::ArgumentNull("Cannot capture a null gxapi manager.");
+	}
+}
+
+
+std::vector<gxapi::AdapterInfo> GxapiManager::EnumerateAdapters() {
+	return m_manager->EnumerateAdapters();
+}
+
+
+gxapi::ISwapChain* GxapiManager::CreateSwapChain(gxapi::SwapChainDesc desc, gxapi::ICommandQueue* flushThisQueue) {
+	auto* queue = dynamic_cast<CommandQueue*>(flushThisQueue);
+	if (queue == nullptr) {
+		throw gxapi::InvalidArgument("Swap chain must be created for a capturing command queue.", "flushThisQueue");
+	}
+
+	gxapi::ISwapChain* swapChain = m_manager->CreateSwapChain(desc, queue->GetWrappedQueue());
+	return new SwapChain(queue->GetApi(), swapChain);
+}
+
+
+gxapi::IGraphicsApi* GxapiManager::CreateGraphicsApi(unsigned adapterId) {
+	return new GraphicsApi(m_manager->CreateGraphicsApi(adapterId));
+}
+
+
+gxapi::ShaderProgramBinary GxapiManager::CompileShader(const char* source,
+													   const char* mainFunction,
+													   gxapi::eShaderType type,
+													   gxapi::eShaderCompileFlags flags,
+													   gxapi::IShaderIncludeProvider* includeProvider,
+													   const char* macroDefinitions)
+{
+	return m_manager->CompileShader(source, mainFunction, type, flags, includeProvider, macroDefinitions);
+}
+
+
+gxapi::ShaderProgramBinary GxapiManager::CompileShaderFromFile(const std::string& fileName,
+															   const std::string& mainFunctionName,
+															   gxapi::eShaderType type,
+															   gxapi::eShaderCompileFlags flags,
+															   const std::vector<gxapi::ShaderMacroDefinition>& macros)
+{
+	return m_manager->CompileShaderFromFile(fileName, mainFunctionName, type, flags, macros);
+}
+
+
+} // namespace gxapi_capture
+} // namespace inl
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IGxapiManager.hpp"
+
+#include <memory>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+/// <summary>
+/// Wraps the manager of another backend so that the graphics apis and swap chains
+/// it creates record a capture. Shader compilation is forwarded unchanged.
+/// </summary>
+class GxapiManager : public gxapi::IGxapiManager {
+public:
+	/// <param name="manager"> The wrapped manager. Ownership is taken. </param>
+	GxapiManager(gxapi::IGxapiManager* manager);
+
+	std::vector<gxapi::AdapterInfo> EnumerateAdapters() override;
+
+	/// <param name="flushThisQueue"> Must be a queue created by a capturing graphics api. </param>
+	gxapi::ISwapChain* CreateSwapChain(gxapi::SwapChainDesc desc, gxapi::ICommandQueue* flushThisQueue) override;
+	gxapi::IGraphicsApi* CreateGraphicsApi(unsigned adapterId) override;
+
+
+	gxapi::ShaderProgramBinary CompileShader(const char* source,
+											 const char* mainFunction,
+											 gxapi::eShaderType type,
+											 gxapi::eShaderCompileFlags flags,
+											 gxapi::IShaderIncludeProvider* includeProvider = nullptr,
+											 const char* macroDefinitions = nullptr) override;
+
+	gxapi::ShaderProgramBinary CompileShaderFromFile(const std::string& fileName,
+													 const std::string& mainFunctionName,
+													 gxapi::eShaderType type,
+													 gxapi::eShaderCompileFlags flags,
+													 const std::vector<gxapi::ShaderMacroDefinition>& macros) override;
+private:
+	std::unique_ptr<gxapi::IGxapiManager> m_manager;
+};
+
+
+} // namespace gxapi_capture
+} // namespace inl
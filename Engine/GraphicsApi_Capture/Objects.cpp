@@ -0,0 +1,172 @@
+#include "Objects.hpp"
+#include "GraphicsApi.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+#include <utility>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+//------------------------------------------------------------------------------
+// Resource
+//------------------------------------------------------------------------------
+
+Resource::Resource(GraphicsApi* api, gxapi::IResource* resource)
+	: m_resource(resource), m_id(api->NewObjectId())
+{}
+
+
+gxapi::ResourceDesc Resource::GetDesc() const {
+	return m_resource->GetDesc();
+}
+
+
+void* Resource::Map(unsigned subresourceIndex, const gxapi::MemoryRange* readRange) {
+	return m_resource->Map(subresourceIndex, readRange);
+}
+
+
+void Resource::Unmap(unsigned subresourceIndex, const gxapi::MemoryRange* writtenRange) {
+	m_resource->Unmap(subresourceIndex, writtenRange);
+}
+
+
+void* Resource::GetGPUAddress() const {
+	return m_resource->GetGPUAddress();
+}
+
+
+unsigned Resource::GetNumMipLevels() {
+	return m_resource->GetNumMipLevels();
+}
+
+
+unsigned Resource::GetNumTexturePlanes() {
+	return m_resource->GetNumTexturePlanes();
+}
+
+
+unsigned Resource::GetNumArrayLevels() {
+	return m_resource->GetNumArrayLevels();
+}
+
+
+unsigned Resource::GetNumSubresources() {
+	return m_resource->GetNumSubresources();
+}
+
+
+unsigned Resource::GetSubresourceIndex(unsigned mipLevel, unsigned arrayIdx, unsigned planeIdx) {
+	return m_resource->GetSubresourceIndex(mipLevel, arrayIdx, planeIdx);
+}
+
+
+void Resource::SetName(const char* name) {
+	m_resource->SetName(name);
+}
+
+
+//------------------------------------------------------------------------------
+// Root signature, pipeline state
+//------------------------------------------------------------------------------
+
+RootSignature::RootSignature(GraphicsApi* api, gxapi::IRootSignature* rootSignature)
+	: m_rootSignature(rootSignature), m_id(api->NewObjectId())
+{}
+
+
+PipelineState::PipelineState(GraphicsApi* api, gxapi::IPipelineState* pipelineState)
+	: m_pipelineState(pipelineState), m_id(api->NewObjectId())
+{}
+
+
+//------------------------------------------------------------------------------
+// Descriptor heap
+//------------------------------------------------------------------------------
+
+DescriptorHeap::DescriptorHeap(GraphicsApi* api, gxapi::IDescriptorHeap* heap)
+	: m_heap(heap), m_id(api->NewObjectId())
+{}
+
+
+gxapi::DescriptorHandle DescriptorHeap::At(size_t index) const {
+	return m_heap->At(index);
+}
+
+
+gxapi::DescriptorHeapDesc DescriptorHeap::GetDesc() const {
+	return m_heap->GetDesc();
+}
+
+
+uint32_t DescriptorHeap::GetIncrementSize() const {
+	return m_heap->GetIncrementSize();
+}
+
+
+//------------------------------------------------------------------------------
+// Ids and unwrapping
+//------------------------------------------------------------------------------
+
+namespace {
+
+template <class WrapperT, class InterfaceT>
+uint32_t GetId(const InterfaceT* object) {
+	auto* wrapper = dynamic_cast<const WrapperT*>(object);
+	return wrapper != nullptr ? wrapper->GetId() : 0;
+}
+
+template <class WrapperT, class InterfaceT>
+auto UnwrapObject(const InterfaceT* object) -> decltype(std::declval<WrapperT>().GetWrapped()) {
+	if (object == nullptr) {
+		return nullptr;
+	}
+	auto* wrapper = dynamic_cast<const WrapperT*>(object);
+	if (wrapper == nullptr) {
+		throw gxapi::InvalidArgument("Object was not created by the capturing graphics api.");
+	}
+	return wrapper->GetWrapped();
+}
+
+} // namespace
+
+
+uint32_t GetObjectId(const gxapi::IResource* object) {
+	return GetId<Resource>(object);
+}
+
+uint32_t GetObjectId(const gxapi::IRootSignature* object) {
+	return GetId<RootSignature>(object);
+}
+
+uint32_t GetObjectId(const gxapi::IPipelineState* object) {
+	return GetId<PipelineState>(object);
+}
+
+uint32_t GetObjectId(const gxapi::IDescriptorHeap* object) {
+	return GetId<DescriptorHeap>(object);
+}
+
+
+gxapi::IResource* Unwrap(const gxapi::IResource* object) {
+	return UnwrapObject<Resource>(object);
+}
+
+gxapi::IRootSignature* Unwrap(const gxapi::IRootSignature* object) {
+	return UnwrapObject<RootSignature>(object);
+}
+
+gxapi::IPipelineState* Unwrap(const gxapi::IPipelineState* object) {
+	return UnwrapObject<PipelineState>(object);
+}
+
+gxapi::IDescriptorHeap* Unwrap(const gxapi::IDescriptorHeap* object) {
+	return UnwrapObject<DescriptorHeap>(object);
+}
+
+
+} // namespace gxapi_capture
+} // namespace inl
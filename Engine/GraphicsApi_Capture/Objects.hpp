@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IResource.hpp"
+#include "../GraphicsApi_LL/IRootSignature.hpp"
+#include "../GraphicsApi_LL/IPipelineState.hpp"
+#include "../GraphicsApi_LL/IDescriptorHeap.hpp"
+
+#include <cstdint>
+#include <memory>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+class GraphicsApi;
+
+
+//------------------------------------------------------------------------------
+// The objects the capture refers to are wrapped so that they carry their id.
+// An id lives exactly as long as its object: addresses of released objects may
+// be reused, but the new object gets a new wrapper with a new id.
+// The wrappers forward every call, and are unwrapped before they are passed on
+// to the wrapped api.
+//------------------------------------------------------------------------------
+
+
+class Resource : public gxapi::IResource {
+public:
+	/// <param name="resource"> The wrapped resource. Ownership is taken. </param>
+	Resource(GraphicsApi* api, gxapi::IResource* resource);
+
+	gxapi::ResourceDesc GetDesc() const override;
+	void* Map(unsigned subresourceIndex, const gxapi::MemoryRange* readRange = nullptr) override;
+	void Unmap(unsigned subresourceIndex, const gxapi::MemoryRange* writtenRange = nullptr) override;
+	void* GetGPUAddress() const override;
+
+	unsigned GetNumMipLevels() override;
+	unsigned GetNumTexturePlanes() override;
+	unsigned GetNumArrayLevels() override;
+	unsigned GetNumSubresources() override;
+	unsigned GetSubresourceIndex(unsigned mipLevel, unsigned arrayIdx, unsigned planeIdx) override;
+
+	void SetName(const char* name) override;
+
+	gxapi::IResource* GetWrapped() const { return m_resource.get(); }
+	uint32_t GetId() const { return m_id; }
+private:
+	std::unique_ptr<gxapi::IResource> m_resource;
+	uint32_t m_id;
+};
+
+
+
+class RootSignature : public gxapi::IRootSignature {
+public:
+	/// <param name="rootSignature"> The wrapped root signature. Ownership is taken. </param>
+	RootSignature(GraphicsApi* api, gxapi::IRootSignature* rootSignature);
+
+	gxapi::IRootSignature* GetWrapped() const { return m_rootSignature.get(); }
+	uint32_t GetId() const { return m_id; }
+private:
+	std::unique_ptr<gxapi::IRootSignature> m_rootSignature;
+	uint32_t m_id;
+};
+
+
+
+class PipelineState : public gxapi::IPipelineState {
+public:
+	/// <param name="pipelineState"> The wrapped pipeline state. Ownership is taken. </param>
+	PipelineState(GraphicsApi* api, gxapi::IPipelineState* pipelineState);
+
+	gxapi::IPipelineState* GetWrapped() const { return m_pipelineState.get(); }
+	uint32_t GetId() const { return m_id; }
+private:
+	std::unique_ptr<gxapi::IPipelineState> m_pipelineState;
+	uint32_t m_id;
+};
+
+
+
+class DescriptorHeap : public gxapi::IDescriptorHeap {
+public:
+	/// <param name="heap"> The wrapped heap. Ownership is taken. </param>
+	DescriptorHeap(GraphicsApi* api, gxapi::IDescriptorHeap* heap);
+
+	gxapi::DescriptorHandle At(size_t index) const override;
+	gxapi::DescriptorHeapDesc GetDesc() const override;
+	uint32_t GetIncrementSize() const override;
+
+	gxapi::IDescriptorHeap* GetWrapped() const { return m_heap.get(); }
+	uint32_t GetId() const { return m_id; }
+private:
+	std::unique_ptr<gxapi::IDescriptorHeap> m_heap;
+	uint32_t m_id;
+};
+
+
+
+/// <summary> Returns the object's id, 0 for null and for objects not created by a capturing api. </summary>
+uint32_t GetObjectId(const gxapi::IResource* object);
+uint32_t GetObjectId(const gxapi::IRootSignature* object);
+uint32_t GetObjectId(const gxapi::IPipelineState* object);
+uint32_t GetObjectId(const gxapi::IDescriptorHeap* object);
+
+/// <summary> Returns the object of the wrapped api, null for null. </summary>
+/// <exception cref="gxapi::InvalidArgument"> If the object was not created by a capturing api. </exception>
+gxapi::IResource* Unwrap(const gxapi::IResource* object);
+gxapi::IRootSignature* Unwrap(const gxapi::IRootSignature* object);
+gxapi::IPipelineState* Unwrap(const gxapi::IPipelineState* object);
+gxapi::IDescriptorHeap* Unwrap(const gxapi::IDescriptorHeap* object);
+
+
+} // namespace gxapi_capture
+} // namespace inl
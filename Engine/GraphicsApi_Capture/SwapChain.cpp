@@ -0,0 +1,52 @@
+#include "SwapChain.hpp"
+#include "GraphicsApi.hpp"
+#include "Objects.hpp"
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+SwapChain::SwapChain(GraphicsApi* api, gxapi::ISwapChain* swapChain)
+	: m_api(api), m_swapChain(swapChain)
+{}
+
+
+gxapi::IResource* SwapChain::GetBuffer(unsigned index) {
+	return new Resource(m_api, m_swapChain->GetBuffer(index));
+}
+
+
+gxapi::SwapChainDesc SwapChain::GetDesc() const {
+	return m_swapChain->GetDesc();
+}
+
+
+bool SwapChain::IsFullScreen() const {
+	return m_swapChain->IsFullScreen();
+}
+
+
+unsigned SwapChain::GetCurrentBufferIndex() const {
+	return m_swapChain->GetCurrentBufferIndex();
+}
+
+
+void SwapChain::SetFullScreen(bool isFullScreen) {
+	m_swapChain->SetFullScreen(isFullScreen);
+}
+
+
+void SwapChain::Resize(unsigned width, unsigned height, unsigned bufferCount, gxapi::eFormat format) {
+	m_swapChain->Resize(width, height, bufferCount, format);
+}
+
+
+void SwapChain::Present() {
+	m_swapChain->Present();
+	m_api->EndFrame();
+}
+
+
+} // namespace gxapi_capture
+} // namespace inl
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../GraphicsApi_LL/ISwapChain.hpp"
+
+#include <memory>
+
+
+namespace inl {
+namespace gxapi_capture {
+
+
+class GraphicsApi;
+
+
+/// <summary> Forwards to the wrapped swap chain, wraps its buffers and ends the captured frame on present. </summary>
+class SwapChain : public gxapi::ISwapChain {
+public:
+	/// <param name="swapChain"> The wrapped swap chain. Ownership is taken. </param>
+	SwapChain(GraphicsApi* api, gxapi::ISwapChain* swapChain);
+
+	/// <summary> Like the wrapped swap chain, returns a new object owned by the caller. </summary>
+	gxapi::IResource* GetBuffer(unsigned index) override;
+	gxapi::SwapChainDesc GetDesc() const override;
+	bool IsFullScreen() const override;
+	unsigned GetCurrentBufferIndex() const override;
+
+	void SetFullScreen(bool isFullScreen) override;
+	void Resize(unsigned width, unsigned height, unsigned bufferCount = 0, gxapi::eFormat format = gxapi::eFormat::UNKNOWN) override;
+
+	void Present() override;
+private:
+	GraphicsApi* m_api;
+	std::unique_ptr<gxapi::ISwapChain> m_swapChain;
+};
+
+
+} // namespace gxapi_capture
+} // namespace inl
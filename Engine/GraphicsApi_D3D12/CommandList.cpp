@@ -137,6 +137,16 @@ void CopyCommandList::ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarri
 }
 
 
+void CopyCommandList::EndQuery(gxapi::IQueryHeap* heap, unsigned index) {
+	m_native->EndQuery(native_cast(heap), native_cast(heap->GetDesc().type), index);
+}
+
+
+void CopyCommandList::ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, uint64_t destinationOffset) {
+	m_native->ResolveQueryData(native_cast(heap), native_cast(heap->GetDesc().type), firstIndex, numQueries, native_cast(destination), destinationOffset);
+}
+
+
 // helpers
 D3D12_TEXTURE_COPY_LOCATION CopyCommandList::CreateTextureCopyLocation(gxapi::IResource* resource, gxapi::TextureCopyDesc description) {
 
@@ -88,6 +88,10 @@ public:
 	// TODO: transition, aliasing and bullshit barriers, i would put them into separate functions
 	void ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) override;
 
+	// queries
+	void EndQuery(gxapi::IQueryHeap* heap, unsigned index) override;
+	void ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, uint64_t destinationOffset) override;
+
 protected:
 	D3D12_TEXTURE_COPY_LOCATION CreateTextureCopyLocation(gxapi::IResource* resource, gxapi::TextureCopyDesc descrition);
 	D3D12_TEXTURE_COPY_LOCATION CreateTextureCopyLocation(gxapi::IResource* texture, unsigned subresourceIndex);
@@ -55,5 +55,14 @@ gxapi::CommandQueueDesc CommandQueue::GetDesc() const {
 }
 
 
+uint64_t CommandQueue::GetTimestampFrequency() const {
+	UINT64 frequency;
+	if (FAILED(m_native->GetTimestampFrequency(&frequency))) {
+		return 0; // copy queues may not support timestamps
+	}
+	return frequency;
+}
+
+
 } // namespace gxapi_dx12
 } // namespace inl
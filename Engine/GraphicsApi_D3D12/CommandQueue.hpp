@@ -29,6 +29,8 @@ public:
 
 	gxapi::CommandQueueDesc GetDesc() const override;
 
+	uint64_t GetTimestampFrequency() const override;
+
 private:
 	ComPtr<ID3D12CommandQueue> m_native;
 };
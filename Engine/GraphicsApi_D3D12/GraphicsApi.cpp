@@ -4,6 +4,7 @@
 #include "CommandAllocator.hpp"
 #include "CommandList.hpp"
 #include "DescriptorHeap.hpp"
+#include "QueryHeap.hpp"
 #include "NativeCast.hpp"
 #include "ExceptionExpansions.hpp"
 
@@ -486,6 +487,18 @@ gxapi::IFence * GraphicsApi::CreateFence(uint64_t initialValue)
 }
 
 
+gxapi::IQueryHeap* GraphicsApi::CreateQueryHeap(gxapi::QueryHeapDesc desc) {
+	D3D12_QUERY_HEAP_DESC nativeDesc;
+	nativeDesc.Type = native_cast_heap(desc.type);
+	nativeDesc.Count = desc.numQueries;
+	nativeDesc.NodeMask = 0;
+
+	ComPtr<ID3D12QueryHeap> native;
+	ThrowIfFailed(m_device->CreateQueryHeap(&nativeDesc, IID_PPV_ARGS(&native)));
+	return new QueryHeap(native, desc);
+}
+
+
 void GraphicsApi::MakeResident(const std::vector<gxapi::IResource*>& objects) {
 	if (objects.size() == 0) {
 		return;
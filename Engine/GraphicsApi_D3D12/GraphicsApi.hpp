@@ -98,6 +98,7 @@ public:
 
 	// Misc
 	gxapi::IFence* CreateFence(uint64_t initialValue) override;
+	gxapi::IQueryHeap* CreateQueryHeap(gxapi::QueryHeapDesc desc) override;
 
 	void MakeResident(const std::vector<gxapi::IResource*>& objects) override;
 	void Evict(const std::vector<gxapi::IResource*>& objects) override;
@@ -332,6 +332,10 @@ gxapi::ShaderProgramBinary GxapiManager::CompileShader(
 	ComPtr<ID3DBlob> binaryCode;
 	ComPtr<ID3DBlob> errorMessage;
 	std::vector<D3D_SHADER_MACRO> d3dMacrosDefines;
+	for (const auto& macro : parsedMacroDefinitions) {
+		d3dMacrosDefines.push_back({ macro.name.c_str(), macro.definition.c_str() });
+	}
+	d3dMacrosDefines.push_back({ nullptr, nullptr });
 	D3dIncludeProvider d3dIncludeProvider(includeProvider);
 
 	HRESULT hr = D3DCompile(
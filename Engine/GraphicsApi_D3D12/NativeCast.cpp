@@ -119,6 +119,15 @@ ID3D12Fence* native_cast(gxapi::IFence * source) {
 	return static_cast<Fence*>(source)->GetNative();
 }
 
+
+ID3D12QueryHeap* native_cast(gxapi::IQueryHeap* source) {
+	if (source == nullptr) {
+		return nullptr;
+	}
+
+	return static_cast<QueryHeap*>(source)->GetNative();
+}
+
 ID3D12CommandQueue* native_cast(gxapi::ICommandQueue* source) {
 	if (source == nullptr) {
 		return nullptr;
@@ -215,6 +224,34 @@ D3D12_DESCRIPTOR_HEAP_TYPE native_cast(gxapi::eDescriptorHeapType source) {
 }
 
 
+D3D12_QUERY_TYPE native_cast(gxapi::eQueryHeapType source) {
+	using gxapi::eQueryHeapType;
+	switch (source) {
+	case eQueryHeapType::TIMESTAMP:
+		return D3D12_QUERY_TYPE_TIMESTAMP;
+	default:
+		assert(false);
+		break;
+	}
+
+	return D3D12_QUERY_TYPE{};
+}
+
+
+D3D12_QUERY_HEAP_TYPE native_cast_heap(gxapi::eQueryHeapType source) {
+	using gxapi::eQueryHeapType;
+	switch (source) {
+	case eQueryHeapType::TIMESTAMP:
+		return D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	default:
+		assert(false);
+		break;
+	}
+
+	return D3D12_QUERY_HEAP_TYPE{};
+}
+
+
 D3D12_ROOT_PARAMETER_TYPE native_cast(gxapi::RootParameterDesc::eType source) {
 	switch (source) {
 	case gxapi::RootParameterDesc::CONSTANT:
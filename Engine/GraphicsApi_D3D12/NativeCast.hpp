@@ -8,6 +8,7 @@
 #include "DescriptorHeap.hpp"
 #include "CommandList.hpp"
 #include "Fence.hpp"
+#include "QueryHeap.hpp"
 #include "../GraphicsApi_LL/Common.hpp"
 
 #define WIN32_LEAN_AND_MEAN
@@ -52,6 +53,8 @@ ID3D12DescriptorHeap* native_cast(gxapi::IDescriptorHeap* source);
 
 ID3D12Fence* native_cast(gxapi::IFence* source);
 
+ID3D12QueryHeap* native_cast(gxapi::IQueryHeap* source);
+
 ID3D12CommandQueue* native_cast(gxapi::ICommandQueue* source);
 
 //---------------
@@ -64,6 +67,10 @@ D3D12_COMMAND_LIST_TYPE native_cast(gxapi::eCommandListType source);
 
 D3D12_DESCRIPTOR_HEAP_TYPE native_cast(gxapi::eDescriptorHeapType source);
 
+D3D12_QUERY_TYPE native_cast(gxapi::eQueryHeapType source);
+
+D3D12_QUERY_HEAP_TYPE native_cast_heap(gxapi::eQueryHeapType source);
+
 D3D12_ROOT_PARAMETER_TYPE native_cast(gxapi::RootParameterDesc::eType source);
 
 D3D12_DESCRIPTOR_RANGE_TYPE native_cast(gxapi::DescriptorRange::eType source);
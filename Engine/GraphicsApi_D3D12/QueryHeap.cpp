@@ -0,0 +1,24 @@
+#include "QueryHeap.hpp"
+
+
+namespace inl {
+namespace gxapi_dx12 {
+
+
+QueryHeap::QueryHeap(ComPtr<ID3D12QueryHeap>& native, gxapi::QueryHeapDesc desc)
+	: m_native{ native }, m_desc(desc)
+{}
+
+
+gxapi::QueryHeapDesc QueryHeap::GetDesc() const {
+	return m_desc;
+}
+
+
+ID3D12QueryHeap* QueryHeap::GetNative() {
+	return m_native.Get();
+}
+
+
+} // namespace gxapi_dx12
+} // namespace inl
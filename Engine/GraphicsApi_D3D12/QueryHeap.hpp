@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IQueryHeap.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <wrl.h>
+#include <d3d12.h>
+#include "../GraphicsApi_LL/DisableWin32Macros.h"
+
+namespace inl {
+namespace gxapi_dx12 {
+
+using Microsoft::WRL::ComPtr;
+
+class QueryHeap : public gxapi::IQueryHeap {
+public:
+	QueryHeap(ComPtr<ID3D12QueryHeap>& native, gxapi::QueryHeapDesc desc);
+	QueryHeap(const QueryHeap&) = delete;
+	QueryHeap& operator=(const QueryHeap&) = delete;
+
+	gxapi::QueryHeapDesc GetDesc() const override;
+
+	ID3D12QueryHeap* GetNative();
+private:
+	ComPtr<ID3D12QueryHeap> m_native;
+	gxapi::QueryHeapDesc m_desc;
+};
+
+
+} // namespace gxapi_dx12
+} // namespace inl
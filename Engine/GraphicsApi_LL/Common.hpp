@@ -256,6 +256,11 @@ enum class eDescriptorHeapType {
 };
 
 
+enum class eQueryHeapType {
+	TIMESTAMP,
+};
+
+
 enum class eHeapType {
 	DEFAULT,
 	UPLOAD,
@@ -850,6 +855,15 @@ struct DescriptorHeapDesc {
 };
 
 
+struct QueryHeapDesc {
+	QueryHeapDesc() = default;
+	QueryHeapDesc(eQueryHeapType type, unsigned numQueries)
+		: type(type), numQueries(numQueries) {}
+	eQueryHeapType type;
+	unsigned numQueries;
+};
+
+
 struct ShaderByteCodeDesc {
 	ShaderByteCodeDesc() = default;
 	ShaderByteCodeDesc(const void* byteCode, size_t sizeOfByteCode)
@@ -1147,6 +1161,8 @@ struct DescriptorRange {
 	unsigned offsetFromTableStart;
 
 	static constexpr auto OFFSET_APPEND = std::numeric_limits<unsigned>::max();
+	/// <summary> As the number of descriptors, the range extends to the end of the descriptor heap. </summary>
+	static constexpr auto UNBOUNDED = std::numeric_limits<unsigned>::max();
 };
 
 struct RootDescriptorTable {
@@ -8,6 +8,7 @@ namespace inl {
 namespace gxapi {
 
 class IDescriptorHeap;
+class IQueryHeap;
 
 class ICommandList {
 public:
@@ -56,6 +57,12 @@ public:
 	// TODO: transition, aliasing and bullshit barriers, i would put them into separate functions
 	virtual void ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) = 0;
 
+	// queries
+	/// <summary> Writes the GPU timestamp into the query once all previous commands have finished. </summary>
+	virtual void EndQuery(IQueryHeap* heap, unsigned index) = 0;
+	/// <summary> Copies the 64 bit results of the given queries into a buffer. </summary>
+	virtual void ResolveQueryData(IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, IResource* destination, uint64_t destinationOffset) = 0;
+
 	template <class... Barriers>
 	std::enable_if_t<
 		exc::all<std::is_base_of<ResourceBarrierTag, std::remove_reference_t<Barriers>>...>::value,
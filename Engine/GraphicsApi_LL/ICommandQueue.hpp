@@ -24,6 +24,9 @@ public:
 	virtual void Wait(IFence* fence, uint64_t value) = 0;
 
 	virtual CommandQueueDesc GetDesc() const = 0;
+
+	/// <summary> Ticks per second of the timestamp queries executed on this queue, zero if timestamps are not supported. </summary>
+	virtual uint64_t GetTimestampFrequency() const = 0;
 };
 
 } // namespace gxapi
@@ -18,6 +18,7 @@ class IResource;
 class IRootSignature;
 class IPipelineState;
 class IDescriptorHeap;
+class IQueryHeap;
 
 
 // todo: descriptor view bullshit
@@ -103,6 +104,7 @@ public:
 
 	// Misc
 	virtual IFence* CreateFence(uint64_t initialValue) = 0;
+	virtual IQueryHeap* CreateQueryHeap(QueryHeapDesc desc) = 0;
 
 	virtual void MakeResident(const std::vector<gxapi::IResource*>& objects) = 0;
 	virtual void Evict(const std::vector<gxapi::IResource*>& objects) = 0;
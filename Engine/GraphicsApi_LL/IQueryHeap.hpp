@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Common.hpp"
+
+
+namespace inl {
+namespace gxapi {
+
+
+class IQueryHeap {
+public:
+	virtual ~IQueryHeap() = default;
+
+	virtual QueryHeapDesc GetDesc() const = 0;
+};
+
+
+} // namespace gxapi
+} // namespace inl
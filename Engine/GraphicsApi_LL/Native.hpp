@@ -18,6 +18,13 @@ using NativeWindowHandle = HWND;
 
 #else
 
-static_assert(false, "Graphics API Low-Level not supported on this platform.");
+// There is no native windowing support, only headless backends (e.g. GraphicsApi_Null) work.
+namespace inl {
+namespace gxapi {
+
+using NativeWindowHandle = void*;
+
+}
+}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../GraphicsApi_LL/ICommandAllocator.hpp"
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+class CommandAllocator : public gxapi::ICommandAllocator {
+public:
+	CommandAllocator(gxapi::eCommandListType type) : m_type(type) {}
+	CommandAllocator(const CommandAllocator&) = delete;
+	CommandAllocator& operator=(const CommandAllocator&) = delete;
+
+	void Reset() override {}
+	gxapi::eCommandListType GetType() const override { return m_type; }
+protected:
+	gxapi::eCommandListType m_type;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,341 @@
+#include "CommandList.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+#include <cassert>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+
+//------------------------------------------------------------------------------
+// Basic command list
+//------------------------------------------------------------------------------
+
+
+BasicCommandList::BasicCommandList(gxapi::eCommandListType type)
+	: m_type(type)
+{}
+
+
+gxapi::eCommandListType BasicCommandList::GetType() const {
+	return m_type;
+}
+
+
+
+//------------------------------------------------------------------------------
+// Copy command list
+//------------------------------------------------------------------------------
+
+
+CopyCommandList::CopyCommandList(gxapi::eCommandListType type)
+	: BasicCommandList(type)
+{}
+
+
+void CopyCommandList::Close() {
+	if (m_isClosed) {
+		throw gxapi::InvalidState("Command list is already closed.");
+	}
+	m_isClosed = true;
+}
+
+
+void CopyCommandList::Reset(gxapi::ICommandAllocator* allocator, gxapi::IPipelineState* newState) {
+	if (!m_isClosed) {
+		throw gxapi::InvalidState("Command list must be closed before reset.");
+	}
+	m_counters = CommandListCounters{};
+	m_isClosed = false;
+}
+
+
+void CopyCommandList::RecordCommand() {
+	assert(!m_isClosed);
+}
+
+
+void CopyCommandList::CopyBuffer(gxapi::IResource* dst, size_t dstOffset, gxapi::IResource* src, size_t srcOffset, size_t numBytes) {
+	RecordCommand();
+	++m_counters.copies;
+}
+
+
+void CopyCommandList::CopyResource(gxapi::IResource* dst, gxapi::IResource* src) {
+	RecordCommand();
+	++m_counters.copies;
+}
+
+
+void CopyCommandList::CopyTexture(gxapi::IResource* dst,
+								  unsigned dstSubresourceIndex,
+								  int dstX, int dstY, int dstZ,
+								  gxapi::IResource* src,
+								  unsigned srcSubresourceIndex,
+								  gxapi::Cube srcRegion)
+{
+	RecordCommand();
+	++m_counters.copies;
+}
+
+
+void CopyCommandList::CopyTexture(gxapi::IResource* dst,
+								  gxapi::TextureCopyDesc dstDesc,
+								  int dstX, int dstY, int dstZ,
+								  gxapi::IResource* src,
+								  gxapi::TextureCopyDesc srcDesc,
+								  gxapi::Cube srcRegion)
+{
+	RecordCommand();
+	++m_counters.copies;
+}
+
+
+void CopyCommandList::CopyTexture(gxapi::IResource* dst,
+								  gxapi::TextureCopyDesc dstDesc,
+								  int dstX, int dstY, int dstZ,
+								  gxapi::IResource* src,
+								  gxapi::TextureCopyDesc srcDesc)
+{
+	RecordCommand();
+	++m_counters.copies;
+}
+
+
+void CopyCommandList::ResourceBarrier(unsigned numBarriers, gxapi::ResourceBarrier* barriers) {
+	RecordCommand();
+	m_counters.barriers += numBarriers;
+}
+
+
+void CopyCommandList::EndQuery(gxapi::IQueryHeap* heap, unsigned index) {
+	RecordCommand();
+}
+
+
+void CopyCommandList::ResolveQueryData(gxapi::IQueryHeap* heap, unsigned firstIndex, unsigned numQueries, gxapi::IResource* destination, uint64_t destinationOffset) {
+	RecordCommand();
+}
+
+
+
+//------------------------------------------------------------------------------
+// Compute command list
+//------------------------------------------------------------------------------
+
+
+ComputeCommandList::ComputeCommandList(gxapi::eCommandListType type)
+	: CopyCommandList(type)
+{}
+
+
+void ComputeCommandList::Dispatch(size_t dimx, size_t dimy, size_t dimz) {
+	RecordCommand();
+	++m_counters.dispatches;
+}
+
+
+void ComputeCommandList::SetComputeRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void ComputeCommandList::SetComputeRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void ComputeCommandList::SetComputeRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void ComputeCommandList::SetComputeRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void ComputeCommandList::SetComputeRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void ComputeCommandList::SetComputeRootUnorderedResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+
+void ComputeCommandList::SetComputeRootSignature(gxapi::IRootSignature* rootSignature) {
+	RecordCommand();
+	++m_counters.rootSignatureBinds;
+}
+
+
+void ComputeCommandList::SetPipelineState(gxapi::IPipelineState* pipelineState) {
+	RecordCommand();
+	++m_counters.pipelineStateBinds;
+}
+
+void ComputeCommandList::ResetState(gxapi::IPipelineState* initialPipelineState) {
+	RecordCommand();
+	++m_counters.pipelineStateBinds;
+}
+
+
+void ComputeCommandList::SetDescriptorHeaps(gxapi::IDescriptorHeap*const * heaps, uint32_t count) {
+	RecordCommand();
+}
+
+
+
+//------------------------------------------------------------------------------
+// Graphics command list
+//------------------------------------------------------------------------------
+
+
+GraphicsCommandList::GraphicsCommandList()
+	: ComputeCommandList(gxapi::eCommandListType::GRAPHICS)
+{}
+
+
+void GraphicsCommandList::ClearDepthStencil(gxapi::DescriptorHandle dsv,
+											float depth,
+											uint8_t stencil,
+											size_t numRects,
+											gxapi::Rectangle* rects,
+											bool clearDepth,
+											bool clearStencil)
+{
+	RecordCommand();
+	++m_counters.clears;
+}
+
+
+void GraphicsCommandList::ClearRenderTarget(gxapi::DescriptorHandle rtv,
+											gxapi::ColorRGBA color,
+											size_t numRects,
+											gxapi::Rectangle* rects)
+{
+	RecordCommand();
+	++m_counters.clears;
+}
+
+
+void GraphicsCommandList::DrawIndexedInstanced(unsigned numIndices,
+											   unsigned startIndex,
+											   int vertexOffset,
+											   unsigned numInstances,
+											   unsigned startInstance)
+{
+	RecordCommand();
+	++m_counters.draws;
+}
+
+
+void GraphicsCommandList::DrawInstanced(unsigned numVertices,
+										unsigned startVertex,
+										unsigned numInstances,
+										unsigned startInstance)
+{
+	RecordCommand();
+	++m_counters.draws;
+}
+
+
+void GraphicsCommandList::ExecuteBundle(IGraphicsCommandList* bundle) {
+	RecordCommand();
+	auto* nullBundle = dynamic_cast<GraphicsCommandList*>(bundle);
+	assert(nullBundle != nullptr);
+
+	const CommandListCounters& c = nullBundle->GetCounters();
+	m_counters.draws += c.draws;
+	m_counters.dispatches += c.dispatches;
+	m_counters.pipelineStateBinds += c.pipelineStateBinds;
+	m_counters.rootSignatureBinds += c.rootSignatureBinds;
+	m_counters.rootArgumentBinds += c.rootArgumentBinds;
+}
+
+
+void GraphicsCommandList::SetIndexBuffer(void* gpuVirtualAddress, size_t sizeInBytes, gxapi::eFormat format) {
+	RecordCommand();
+}
+
+
+void GraphicsCommandList::SetPrimitiveTopology(gxapi::ePrimitiveTopology topology) {
+	RecordCommand();
+}
+
+
+void GraphicsCommandList::SetVertexBuffers(unsigned startSlot,
+										   unsigned count,
+										   void** gpuVirtualAddress,
+										   unsigned* sizeInBytes,
+										   unsigned* strideInBytes)
+{
+	RecordCommand();
+}
+
+
+void GraphicsCommandList::SetRenderTargets(unsigned numRenderTargets,
+										   gxapi::DescriptorHandle* renderTargets,
+										   gxapi::DescriptorHandle* depthStencil)
+{
+	RecordCommand();
+}
+
+void GraphicsCommandList::SetBlendFactor(float r, float g, float b, float a) {
+	RecordCommand();
+}
+
+void GraphicsCommandList::SetStencilRef(unsigned stencilRef) {
+	RecordCommand();
+}
+
+
+void GraphicsCommandList::SetScissorRects(unsigned numRects, gxapi::Rectangle* rects) {
+	RecordCommand();
+}
+
+void GraphicsCommandList::SetViewports(unsigned numViewports, gxapi::Viewport* viewports) {
+	RecordCommand();
+}
+
+
+void GraphicsCommandList::SetGraphicsRootConstant(unsigned parameterIndex, unsigned destOffset, uint32_t value) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void GraphicsCommandList::SetGraphicsRootConstants(unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void GraphicsCommandList::SetGraphicsRootConstantBuffer(unsigned parameterIndex, void* gpuVirtualAddress) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void GraphicsCommandList::SetGraphicsRootDescriptorTable(unsigned parameterIndex, gxapi::DescriptorHandle baseHandle) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+void GraphicsCommandList::SetGraphicsRootShaderResource(unsigned parameterIndex, void* gpuVirtualAddress) {
+	RecordCommand();
+	++m_counters.rootArgumentBinds;
+}
+
+
+void GraphicsCommandList::SetGraphicsRootSignature(gxapi::IRootSignature* rootSignature) {
+	RecordCommand();
+	++m_counters.rootSignatureBinds;
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,55 @@
+#include "CommandQueue.hpp"
+
+#include "CommandList.hpp"
+#include "Fence.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+CommandQueue::CommandQueue(gxapi::CommandQueueDesc desc, DeviceCounters* counters)
+	: m_desc(desc), m_counters(counters)
+{}
+
+
+void CommandQueue::ExecuteCommandLists(uint32_t numCommandLists, gxapi::ICommandList* const* commandLists) {
+	for (uint32_t i = 0; i < numCommandLists; ++i) {
+		auto* list = dynamic_cast<BasicCommandList*>(commandLists[i]);
+		if (list == nullptr) {
+			throw gxapi::InvalidArgument("Command list was not created by the null device.", "commandLists");
+		}
+		if (!list->IsClosed()) {
+			throw gxapi::InvalidState("Command lists must be closed before execution.");
+		}
+		m_counters->Add(list->GetCounters());
+	}
+}
+
+
+void CommandQueue::Signal(gxapi::IFence* fence, uint64_t value) {
+	// all previously submitted work is complete by now
+	fence->Signal(value);
+}
+
+
+void CommandQueue::Wait(gxapi::IFence* fence, uint64_t value) {
+	// GPU-side waits never block the host
+}
+
+
+gxapi::CommandQueueDesc CommandQueue::GetDesc() const {
+	return m_desc;
+}
+
+
+uint64_t CommandQueue::GetTimestampFrequency() const {
+	// there is no GPU to measure
+	return 0;
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
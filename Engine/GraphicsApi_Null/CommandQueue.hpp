@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../GraphicsApi_LL/ICommandQueue.hpp"
+#include "Statistics.hpp"
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+/// <summary> Executes command lists immediately, so every signal completes on the calling thread. </summary>
+class CommandQueue : public gxapi::ICommandQueue {
+public:
+	CommandQueue(gxapi::CommandQueueDesc desc, DeviceCounters* counters);
+	CommandQueue(const CommandQueue&) = delete;
+	CommandQueue& operator=(const CommandQueue&) = delete;
+
+	void ExecuteCommandLists(uint32_t numCommandLists, gxapi::ICommandList* const* commandLists) override;
+
+	void Signal(gxapi::IFence* fence, uint64_t value) override;
+	void Wait(gxapi::IFence* fence, uint64_t value) override;
+
+	gxapi::CommandQueueDesc GetDesc() const override;
+
+	uint64_t GetTimestampFrequency() const override;
+
+	DeviceCounters* GetCounters() const { return m_counters; }
+private:
+	gxapi::CommandQueueDesc m_desc;
+	DeviceCounters* m_counters;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
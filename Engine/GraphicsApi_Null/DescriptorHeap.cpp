@@ -0,0 +1,43 @@
+#include "DescriptorHeap.hpp"
+
+#include <cassert>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+DescriptorHeap::DescriptorHeap(gxapi::DescriptorHeapDesc desc, void* gpuBaseAddress)
+	: m_desc(desc),
+	m_descriptors(new Descriptor[desc.numDescriptors]),
+	m_gpuBaseAddress(desc.isShaderVisible ? gpuBaseAddress : nullptr)
+{
+	for (size_t i = 0; i < desc.numDescriptors; ++i) {
+		m_descriptors[i] = { eDescriptorKind::EMPTY, nullptr, nullptr };
+	}
+}
+
+
+gxapi::DescriptorHandle DescriptorHeap::At(size_t index) const {
+	assert(index < m_desc.numDescriptors);
+
+	gxapi::DescriptorHandle result;
+	result.cpuAddress = &m_descriptors[index];
+	result.gpuAddress = m_gpuBaseAddress ? static_cast<uint8_t*>(m_gpuBaseAddress) + index * GetIncrementSize() : nullptr;
+
+	return result;
+}
+
+
+gxapi::DescriptorHeapDesc DescriptorHeap::GetDesc() const {
+	return m_desc;
+}
+
+
+uint32_t DescriptorHeap::GetIncrementSize() const {
+	return sizeof(Descriptor);
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
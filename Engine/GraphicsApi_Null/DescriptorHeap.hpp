@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IDescriptorHeap.hpp"
+
+#include <memory>
+
+
+namespace inl {
+namespace gxapi {
+class IResource;
+}
+}
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+enum class eDescriptorKind : uint32_t {
+	EMPTY,
+	CBV,
+	SRV,
+	UAV,
+	RTV,
+	DSV,
+	SAMPLER,
+};
+
+
+/// <summary> What a null descriptor heap stores in place of a hardware descriptor. </summary>
+struct Descriptor {
+	eDescriptorKind kind;
+	const gxapi::IResource* resource;
+	const void* gpuAddress;
+};
+
+
+/// <summary> Array of CPU-side descriptors.
+///		CPU handles point directly to the elements, so copies are plain memcpys. </summary>
+class DescriptorHeap : public gxapi::IDescriptorHeap {
+public:
+	DescriptorHeap(gxapi::DescriptorHeapDesc desc, void* gpuBaseAddress);
+	DescriptorHeap(const DescriptorHeap&) = delete;
+	DescriptorHeap& operator=(const DescriptorHeap&) = delete;
+
+	gxapi::DescriptorHandle At(size_t index) const override;
+
+	gxapi::DescriptorHeapDesc GetDesc() const override;
+	uint32_t GetIncrementSize() const override;
+private:
+	gxapi::DescriptorHeapDesc m_desc;
+	std::unique_ptr<Descriptor[]> m_descriptors;
+	void* m_gpuBaseAddress;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,73 @@
+#include "Fence.hpp"
+
+#include <chrono>
+#include <thread>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+Fence::Fence(uint64_t initialValue)
+	: m_value(initialValue)
+{}
+
+
+uint64_t Fence::Fetch() const {
+	std::lock_guard<std::mutex> lkg(m_mtx);
+	return m_value;
+}
+
+
+void Fence::Signal(uint64_t value) {
+	{
+		std::lock_guard<std::mutex> lkg(m_mtx);
+		m_value = value;
+	}
+	m_cv.notify_all();
+}
+
+
+void Fence::Wait(uint64_t value, uint64_t timeoutMillis) const {
+	std::unique_lock<std::mutex> lk(m_mtx);
+	if (timeoutMillis == FOREVER) {
+		m_cv.wait(lk, [&] { return m_value >= value; });
+	}
+	else {
+		m_cv.wait_for(lk, std::chrono::milliseconds(timeoutMillis), [&] { return m_value >= value; });
+	}
+}
+
+
+void Fence::WaitAny(const IFence** fences, uint64_t* values, size_t count, uint64_t timeoutMillis) const {
+	// fences are signaled by the submitting thread, so polling cannot miss anything for long
+	auto start = std::chrono::steady_clock::now();
+	while (true) {
+		for (size_t i = 0; i < count; ++i) {
+			if (fences[i]->Fetch() >= values[i]) {
+				return;
+			}
+		}
+		if (timeoutMillis != FOREVER && std::chrono::steady_clock::now() - start > std::chrono::milliseconds(timeoutMillis)) {
+			return;
+		}
+		std::this_thread::yield();
+	}
+}
+
+
+void Fence::WaitAll(const IFence** fences, uint64_t* values, size_t count, uint64_t timeoutMillis) const {
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; ++i) {
+		uint64_t remaining = FOREVER;
+		if (timeoutMillis != FOREVER) {
+			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+			remaining = elapsed >= (long long)timeoutMillis ? 0 : timeoutMillis - elapsed;
+		}
+		fences[i]->Wait(values[i], remaining);
+	}
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IFence.hpp"
+
+#include <mutex>
+#include <condition_variable>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+/// <summary> CPU-only fence. Queues execute immediately, so values are signaled on submission. </summary>
+class Fence : public gxapi::IFence {
+public:
+	Fence(uint64_t initialValue);
+	Fence(const Fence&) = delete;
+	Fence& operator=(Fence&) = delete;
+
+	uint64_t Fetch() const override;
+	void Signal(uint64_t value) override;
+	void Wait(uint64_t value, uint64_t timeoutMillis = FOREVER) const override;
+	void WaitAny(const IFence** fences, uint64_t* values, size_t count, uint64_t timeoutMillis = FOREVER) const override;
+	void WaitAll(const IFence** fences, uint64_t* values, size_t count, uint64_t timeoutMillis = FOREVER) const override;
+private:
+	uint64_t m_value;
+	mutable std::mutex m_mtx;
+	mutable std::condition_variable m_cv;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
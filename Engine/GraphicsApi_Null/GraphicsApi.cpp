@@ -0,0 +1,316 @@
+#include "GraphicsApi.hpp"
+
+#include "CommandAllocator.hpp"
+#include "CommandList.hpp"
+#include "CommandQueue.hpp"
+#include "DescriptorHeap.hpp"
+#include "Fence.hpp"
+#include "PipelineState.hpp"
+#include "QueryHeap.hpp"
+#include "Resource.hpp"
+#include "RootSignature.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <string>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+// Fake GPU addresses start high enough to be distinguishable from small integers,
+// and ranges are aligned like D3D12 placement (64 KiB).
+static constexpr uint64_t GpuAddressBase = 0x10000000ull;
+static constexpr uint64_t GpuAddressAlignment = 64 * 1024;
+
+
+GraphicsApi::GraphicsApi()
+	: m_nextGpuAddress(GpuAddressBase)
+{}
+
+
+GraphicsApi::~GraphicsApi() {
+	// empty
+}
+
+
+gxapi::ICommandQueue* GraphicsApi::CreateCommandQueue(gxapi::CommandQueueDesc desc) {
+	return new CommandQueue(desc, &m_counters);
+}
+
+
+gxapi::ICommandAllocator* GraphicsApi::CreateCommandAllocator(gxapi::eCommandListType type) {
+	return new CommandAllocator(type);
+}
+
+
+gxapi::IGraphicsCommandList* GraphicsApi::CreateGraphicsCommandList(gxapi::CommandListDesc desc) {
+	return new GraphicsCommandList();
+}
+
+
+gxapi::IComputeCommandList* GraphicsApi::CreateComputeCommandList(gxapi::CommandListDesc desc) {
+	return new ComputeCommandList();
+}
+
+
+gxapi::ICopyCommandList* GraphicsApi::CreateCopyCommandList(gxapi::CommandListDesc desc) {
+	return new CopyCommandList();
+}
+
+
+gxapi::IResource* GraphicsApi::CreateCommittedResource(gxapi::HeapProperties heapProperties,
+													   gxapi::eHeapFlags heapFlags,
+													   gxapi::ResourceDesc desc,
+													   gxapi::eResourceState initialState,
+													   gxapi::ClearValue* clearValue)
+{
+	if (desc.type == gxapi::eResourceType::BUFFER && desc.bufferDesc.sizeInBytes == 0) {
+		throw gxapi::InvalidArgument("Buffers must have a non-zero size.", "desc");
+	}
+
+	uint64_t size = Resource::CalculateSize(desc);
+	void* gpuAddress = AllocateAddressRange(size);
+	return new Resource(desc, heapProperties.type, gpuAddress, &m_counters);
+}
+
+
+gxapi::IRootSignature* GraphicsApi::CreateRootSignature(gxapi::RootSignatureDesc desc) {
+	return new RootSignature(desc.rootParameters.size());
+}
+
+
+gxapi::IPipelineState* GraphicsApi::CreateGraphicsPipelineState(const gxapi::GraphicsPipelineStateDesc& desc) {
+	return new PipelineState(false);
+}
+
+
+gxapi::IPipelineState* GraphicsApi::CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) {
+	return new PipelineState(true);
+}
+
+
+gxapi::IDescriptorHeap* GraphicsApi::CreateDescriptorHeap(gxapi::DescriptorHeapDesc desc) {
+	void* gpuBase = AllocateAddressRange(desc.numDescriptors * sizeof(Descriptor));
+	return new DescriptorHeap(desc, gpuBase);
+}
+
+
+void GraphicsApi::CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc,
+										   gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::CBV, nullptr, desc.gpuVirtualAddress);
+}
+
+
+void GraphicsApi::CreateDepthStencilView(gxapi::DepthStencilViewDesc desc,
+										 gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::DSV, nullptr);
+}
+
+
+void GraphicsApi::CreateDepthStencilView(const gxapi::IResource* resource,
+										 gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::DSV, resource);
+}
+
+
+void GraphicsApi::CreateDepthStencilView(const gxapi::IResource* resource,
+										 gxapi::DepthStencilViewDesc desc,
+										 gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::DSV, resource);
+}
+
+
+void GraphicsApi::CreateRenderTargetView(const gxapi::IResource* resource,
+										 gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::RTV, resource);
+}
+
+
+void GraphicsApi::CreateRenderTargetView(const gxapi::IResource* resource,
+										 gxapi::RenderTargetViewDesc desc,
+										 gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::RTV, resource);
+}
+
+
+void GraphicsApi::CreateShaderResourceView(gxapi::ShaderResourceViewDesc desc,
+										   gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::SRV, nullptr);
+}
+
+
+void GraphicsApi::CreateShaderResourceView(const gxapi::IResource* resource,
+										   gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::SRV, resource);
+}
+
+
+void GraphicsApi::CreateShaderResourceView(const gxapi::IResource* resource,
+										   gxapi::ShaderResourceViewDesc desc,
+										   gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::SRV, resource);
+}
+
+
+void GraphicsApi::CreateUnorderedAccessView(gxapi::UnorderedAccessViewDesc descriptor,
+											gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::UAV, nullptr);
+}
+
+
+void GraphicsApi::CreateUnorderedAccessView(const gxapi::IResource* resource,
+											gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::UAV, resource);
+}
+
+
+void GraphicsApi::CreateUnorderedAccessView(const gxapi::IResource* resource,
+											gxapi::UnorderedAccessViewDesc descriptor,
+											gxapi::DescriptorHandle destination)
+{
+	WriteDescriptor(destination, eDescriptorKind::UAV, resource);
+}
+
+
+void GraphicsApi::CopyDescriptors(size_t numSrcDescRanges,
+								  gxapi::DescriptorHandle* srcRangeStarts,
+								  size_t numDstDescRanges,
+								  gxapi::DescriptorHandle* dstRangeStarts,
+								  uint32_t* rangeCounts,
+								  gxapi::eDescriptorHeapType descHeapsType)
+{
+	// same semantics as the D3D12 backend: sources are single descriptors, destinations are ranges
+	CopyDescriptors(numSrcDescRanges, srcRangeStarts, nullptr, numDstDescRanges, dstRangeStarts, rangeCounts, descHeapsType);
+}
+
+
+void GraphicsApi::CopyDescriptors(size_t numSrcDescRanges,
+								  gxapi::DescriptorHandle* srcRangeStarts,
+								  uint32_t* srcRangeLengths,
+								  size_t numDstDescRanges,
+								  gxapi::DescriptorHandle* dstRangeStarts,
+								  uint32_t* dstRangeLengths,
+								  gxapi::eDescriptorHeapType descHeapsType)
+{
+	// walk both lists of ranges in lockstep, descriptor by descriptor
+	size_t srcRange = 0, srcIndex = 0;
+	size_t dstRange = 0, dstIndex = 0;
+	uint64_t numCopied = 0;
+	while (srcRange < numSrcDescRanges && dstRange < numDstDescRanges) {
+		uint32_t srcLength = srcRangeLengths ? srcRangeLengths[srcRange] : 1;
+		uint32_t dstLength = dstRangeLengths ? dstRangeLengths[dstRange] : 1;
+		if (srcIndex >= srcLength) {
+			++srcRange;
+			srcIndex = 0;
+			continue;
+		}
+		if (dstIndex >= dstLength) {
+			++dstRange;
+			dstIndex = 0;
+			continue;
+		}
+
+		const Descriptor* src = static_cast<const Descriptor*>(srcRangeStarts[srcRange].cpuAddress) + srcIndex;
+		Descriptor* dst = static_cast<Descriptor*>(dstRangeStarts[dstRange].cpuAddress) + dstIndex;
+		*dst = *src;
+
+		++srcIndex;
+		++dstIndex;
+		++numCopied;
+	}
+
+	m_counters.descriptorsCopied += numCopied;
+}
+
+
+void GraphicsApi::CopyDescriptors(gxapi::DescriptorHandle srcStart,
+								  gxapi::DescriptorHandle dstStart,
+								  size_t rangeCount,
+								  gxapi::eDescriptorHeapType descHeapsType)
+{
+	const Descriptor* src = static_cast<const Descriptor*>(srcStart.cpuAddress);
+	Descriptor* dst = static_cast<Descriptor*>(dstStart.cpuAddress);
+	std::copy(src, src + rangeCount, dst);
+
+	m_counters.descriptorsCopied += rangeCount;
+}
+
+
+gxapi::IFence* GraphicsApi::CreateFence(uint64_t initialValue) {
+	return new Fence(initialValue);
+}
+
+
+gxapi::IQueryHeap* GraphicsApi::CreateQueryHeap(gxapi::QueryHeapDesc desc) {
+	return new QueryHeap(desc);
+}
+
+
+void GraphicsApi::MakeResident(const std::vector<gxapi::IResource*>& objects) {
+	m_counters.residencyChanges += objects.size();
+}
+
+
+void GraphicsApi::Evict(const std::vector<gxapi::IResource*>& objects) {
+	m_counters.residencyChanges += objects.size();
+}
+
+
+void GraphicsApi::ReportLiveObjects() const {
+	if (m_log == nullptr) {
+		return;
+	}
+	Statistics stats = GetStatistics();
+	m_log->Event(exc::Event("Null device live objects.",
+							exc::eEventType::INFO,
+							exc::EventParameterString("resources", std::to_string(stats.liveResources)),
+							exc::EventParameterString("bytes", std::to_string(stats.liveResourceBytes))));
+}
+
+
+void GraphicsApi::SetLog(exc::LogStream* log) {
+	m_log = log;
+}
+
+
+Statistics GraphicsApi::GetStatistics() const {
+	return m_counters.Snapshot();
+}
+
+
+void* GraphicsApi::AllocateAddressRange(uint64_t size) {
+	uint64_t alignedSize = (std::max<uint64_t>(size, 1) + GpuAddressAlignment - 1) / GpuAddressAlignment * GpuAddressAlignment;
+	uint64_t address = m_nextGpuAddress.fetch_add(alignedSize);
+	return reinterpret_cast<void*>(static_cast<uintptr_t>(address));
+}
+
+
+void GraphicsApi::WriteDescriptor(gxapi::DescriptorHandle destination, eDescriptorKind kind, const gxapi::IResource* resource, const void* gpuAddress) {
+	assert(destination.cpuAddress != nullptr);
+
+	Descriptor* target = static_cast<Descriptor*>(destination.cpuAddress);
+	target->kind = kind;
+	target->resource = resource;
+	target->gpuAddress = resource ? const_cast<gxapi::IResource*>(resource)->GetGPUAddress() : gpuAddress;
+
+	++m_counters.descriptorsCreated;
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
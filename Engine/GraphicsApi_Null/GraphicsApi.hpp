@@ -0,0 +1,134 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "Statistics.hpp"
+#include "DescriptorHeap.hpp"
+
+#include "../BaseLibrary/Logging/LogStream.hpp"
+
+#include <atomic>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+/// <summary>
+/// Graphics device that does not render anything. It keeps CPU-side bookkeeping
+/// of resources, descriptors, fences and submitted work so that the whole engine
+/// can be run headless, in tests and for profiling the CPU side of a frame.
+/// </summary>
+class GraphicsApi : public gxapi::IGraphicsApi {
+public:
+	GraphicsApi();
+	~GraphicsApi();
+
+	// Command submission
+	gxapi::ICommandQueue* CreateCommandQueue(gxapi::CommandQueueDesc desc) override;
+
+	gxapi::ICommandAllocator* CreateCommandAllocator(gxapi::eCommandListType type) override;
+
+	gxapi::IGraphicsCommandList* CreateGraphicsCommandList(gxapi::CommandListDesc desc) override;
+	gxapi::IComputeCommandList* CreateComputeCommandList(gxapi::CommandListDesc desc) override;
+	gxapi::ICopyCommandList* CreateCopyCommandList(gxapi::CommandListDesc desc) override;
+
+	// Resources
+	gxapi::IResource* CreateCommittedResource(gxapi::HeapProperties heapProperties,
+											  gxapi::eHeapFlags heapFlags,
+											  gxapi::ResourceDesc desc,
+											  gxapi::eResourceState initialState,
+											  gxapi::ClearValue* clearValue = nullptr) override;
+
+
+	// Pipeline and binding
+	gxapi::IRootSignature* CreateRootSignature(gxapi::RootSignatureDesc desc) override;
+
+	gxapi::IPipelineState* CreateGraphicsPipelineState(const gxapi::GraphicsPipelineStateDesc& desc) override;
+	gxapi::IPipelineState* CreateComputePipelineState(const gxapi::ComputePipelineStateDesc& desc) override;
+
+	gxapi::IDescriptorHeap* CreateDescriptorHeap(gxapi::DescriptorHeapDesc desc) override;
+
+
+	void CreateConstantBufferView(gxapi::ConstantBufferViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+
+	void CreateDepthStencilView(gxapi::DepthStencilViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+	void CreateDepthStencilView(const gxapi::IResource* resource,
+								gxapi::DescriptorHandle destination) override;
+	void CreateDepthStencilView(const gxapi::IResource* resource,
+								gxapi::DepthStencilViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+
+	void CreateRenderTargetView(const gxapi::IResource* resource,
+								gxapi::DescriptorHandle destination) override;
+	void CreateRenderTargetView(const gxapi::IResource* resource,
+								gxapi::RenderTargetViewDesc desc,
+								gxapi::DescriptorHandle destination) override;
+
+	void CreateShaderResourceView(gxapi::ShaderResourceViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+	void CreateShaderResourceView(const gxapi::IResource* resource,
+								  gxapi::DescriptorHandle destination) override;
+	void CreateShaderResourceView(const gxapi::IResource* resource,
+								  gxapi::ShaderResourceViewDesc desc,
+								  gxapi::DescriptorHandle destination) override;
+
+	void CreateUnorderedAccessView(gxapi::UnorderedAccessViewDesc descriptor,
+								   gxapi::DescriptorHandle destination) override;
+	void CreateUnorderedAccessView(const gxapi::IResource* resource,
+								   gxapi::DescriptorHandle destination) override;
+	void CreateUnorderedAccessView(const gxapi::IResource* resource,
+								   gxapi::UnorderedAccessViewDesc descriptor,
+								   gxapi::DescriptorHandle destination) override;
+
+	void CopyDescriptors(size_t numSrcDescRanges,
+						 gxapi::DescriptorHandle* srcRangeStarts,
+						 size_t numDstDescRanges,
+						 gxapi::DescriptorHandle* dstRangeStarts,
+						 uint32_t* rangeCounts,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+
+	void CopyDescriptors(size_t numSrcDescRanges,
+						 gxapi::DescriptorHandle* srcRangeStarts,
+						 uint32_t* srcRangeLengths,
+						 size_t numDstDescRanges,
+						 gxapi::DescriptorHandle* dstRangeStarts,
+						 uint32_t* dstRangeLengths,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+
+	void CopyDescriptors(gxapi::DescriptorHandle srcStart,
+						 gxapi::DescriptorHandle dstStart,
+						 size_t rangeCount,
+						 gxapi::eDescriptorHeapType descHeapsType) override;
+
+	// Misc
+	gxapi::IFence* CreateFence(uint64_t initialValue) override;
+	gxapi::IQueryHeap* CreateQueryHeap(gxapi::QueryHeapDesc desc) override;
+
+	void MakeResident(const std::vector<gxapi::IResource*>& objects) override;
+	void Evict(const std::vector<gxapi::IResource*>& objects) override;
+
+	// Debug
+	/// <summary> Logs the number and size of live resources to the log set by <see cref="SetLog"/>, if any. </summary>
+	void ReportLiveObjects() const override;
+
+	// Null device specific
+	/// <summary> Returns the totals of everything submitted and allocated so far. </summary>
+	Statistics GetStatistics() const;
+	DeviceCounters* GetCounters() { return &m_counters; }
+	/// <summary> Sets where debug reports go. Not owned, null disables them. </summary>
+	void SetLog(exc::LogStream* log);
+private:
+	/// <summary> Reserves a range of fake GPU virtual addresses. Never returns null. </summary>
+	void* AllocateAddressRange(uint64_t size);
+	void WriteDescriptor(gxapi::DescriptorHandle destination, eDescriptorKind kind, const gxapi::IResource* resource, const void* gpuAddress = nullptr);
+private:
+	DeviceCounters m_counters;
+	std::atomic<uint64_t> m_nextGpuAddress;
+	exc::LogStream* m_log = nullptr;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
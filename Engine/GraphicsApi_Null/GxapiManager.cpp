@@ -0,0 +1,95 @@
+#include "GxapiManager.hpp"
+#include "GraphicsApi.hpp"
+#include "CommandQueue.hpp"
+#include "SwapChain.hpp"
+
+#include "../GraphicsApi_LL/Exception.hpp"
+
+#include <functional>
+#include <cstring>
+
+using namespace inl::gxapi;
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+std::vector<AdapterInfo> GxapiManager::EnumerateAdapters() {
+	AdapterInfo info;
+	info.adapterId = 0;
+	info.name = "Null device";
+	info.vendorId = 0;
+	info.deviceId = 0;
+	info.dedicatedVideoMemory = 0;
+	info.dedicatedSystemMemory = 0;
+	info.sharedSystemMemory = 0;
+	info.isSoftwareAdapter = true;
+
+	return { info };
+}
+
+
+ISwapChain* GxapiManager::CreateSwapChain(SwapChainDesc desc, ICommandQueue* flushThisQueue) {
+	auto queue = dynamic_cast<CommandQueue*>(flushThisQueue);
+	if (queue == nullptr) {
+		throw InvalidArgument("Swap chain must be created for a null device command queue.", "flushThisQueue");
+	}
+
+	return new SwapChain(desc, queue->GetCounters());
+}
+
+
+IGraphicsApi* GxapiManager::CreateGraphicsApi(unsigned adapterId) {
+	if (adapterId != 0) {
+		throw OutOfRange("The null backend has a single adapter with id 0.");
+	}
+
+	return new GraphicsApi();
+}
+
+
+ShaderProgramBinary GxapiManager::CompileShader(const char* source,
+												const char* mainFunction,
+												eShaderType type,
+												eShaderCompileFlags flags,
+												IShaderIncludeProvider* includeProvider,
+												const char* macroDefinitions)
+{
+	std::string key = source;
+	key += mainFunction;
+	key += std::to_string((int)type);
+	if (macroDefinitions) {
+		key += macroDefinitions;
+	}
+	return MakePlaceholderBinary(key);
+}
+
+
+ShaderProgramBinary GxapiManager::CompileShaderFromFile(const std::string& fileName,
+														const std::string& mainFunctionName,
+														eShaderType type,
+														eShaderCompileFlags flags,
+														const std::vector<ShaderMacroDefinition>& macros)
+{
+	std::string key = fileName + mainFunctionName + std::to_string((int)type);
+	for (auto& macro : macros) {
+		key += macro.name + "=" + macro.value + ";";
+	}
+	return MakePlaceholderBinary(key);
+}
+
+
+ShaderProgramBinary GxapiManager::MakePlaceholderBinary(const std::string& key) {
+	// Never empty, and different sources give different binaries, so pipeline states stay distinguishable.
+	size_t hash = std::hash<std::string>()(key);
+
+	ShaderProgramBinary binary;
+	binary.data.resize(sizeof(hash));
+	memcpy(binary.data.data(), &hash, sizeof(hash));
+	return binary;
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
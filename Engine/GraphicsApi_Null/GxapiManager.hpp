@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IGxapiManager.hpp"
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+/// <summary>
+/// Entry point of the null backend. Reports a single software adapter,
+/// and "compiles" shaders to opaque placeholder binaries.
+/// </summary>
+class GxapiManager : public gxapi::IGxapiManager {
+public:
+	std::vector<gxapi::AdapterInfo> EnumerateAdapters() override;
+
+	gxapi::ISwapChain* CreateSwapChain(gxapi::SwapChainDesc desc, gxapi::ICommandQueue* flushThisQueue) override;
+	gxapi::IGraphicsApi* CreateGraphicsApi(unsigned adapterId) override;
+
+
+	gxapi::ShaderProgramBinary CompileShader(const char* source,
+											 const char* mainFunction,
+											 gxapi::eShaderType type,
+											 gxapi::eShaderCompileFlags flags,
+											 gxapi::IShaderIncludeProvider* includeProvider = nullptr,
+											 const char* macroDefinitions = nullptr) override;
+
+	gxapi::ShaderProgramBinary CompileShaderFromFile(const std::string& fileName,
+													 const std::string& mainFunctionName,
+													 gxapi::eShaderType type,
+													 gxapi::eShaderCompileFlags flags,
+													 const std::vector<gxapi::ShaderMacroDefinition>& macros) override;
+private:
+	static gxapi::ShaderProgramBinary MakePlaceholderBinary(const std::string& key);
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
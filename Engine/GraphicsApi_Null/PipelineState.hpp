@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IPipelineState.hpp"
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+class PipelineState : public gxapi::IPipelineState {
+public:
+	PipelineState(bool isCompute) : m_isCompute(isCompute) {}
+	bool IsCompute() const { return m_isCompute; }
+private:
+	bool m_isCompute;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IQueryHeap.hpp"
+#include "../GraphicsApi_LL/Common.hpp"
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+class QueryHeap : public gxapi::IQueryHeap {
+public:
+	QueryHeap(gxapi::QueryHeapDesc desc) : m_desc(desc) {}
+	gxapi::QueryHeapDesc GetDesc() const override { return m_desc; }
+private:
+	gxapi::QueryHeapDesc m_desc;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,146 @@
+#include "Resource.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+static unsigned GetFormatPlaneCount(gxapi::eFormat format) {
+	switch (format) {
+		case gxapi::eFormat::R24G8_TYPELESS:
+		case gxapi::eFormat::D24_UNORM_S8_UINT:
+		case gxapi::eFormat::R32G8X24_TYPELESS:
+		case gxapi::eFormat::D32_FLOAT_S8X24_UINT:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+
+Resource::Resource(const gxapi::ResourceDesc& desc, gxapi::eHeapType heapType, void* gpuAddress, DeviceCounters* counters)
+	: m_desc(desc),
+	m_heapType(heapType),
+	m_gpuAddress(gpuAddress),
+	m_counters(counters)
+{
+	if (desc.type == gxapi::eResourceType::BUFFER) {
+		m_numMipLevels = 1;
+		m_numTexturePlanes = 1;
+		m_numArrayLevels = 1;
+	}
+	else {
+		m_numMipLevels = std::max<unsigned>(1, desc.textureDesc.mipLevels);
+		m_numTexturePlanes = GetFormatPlaneCount(desc.textureDesc.format);
+		m_numArrayLevels = desc.textureDesc.dimension == gxapi::eTextueDimension::THREE ? 1 : std::max<unsigned>(1, desc.textureDesc.depthOrArraySize);
+	}
+
+	m_sizeInBytes = CalculateSize(desc, &m_subresourceOffsets);
+	++m_counters->liveResources;
+	m_counters->liveResourceBytes += m_sizeInBytes;
+}
+
+
+Resource::~Resource() {
+	--m_counters->liveResources;
+	m_counters->liveResourceBytes -= m_sizeInBytes;
+}
+
+
+gxapi::ResourceDesc Resource::GetDesc() const {
+	return m_desc;
+}
+
+
+void* Resource::Map(unsigned subresourceIndex, const gxapi::MemoryRange* readRange) {
+	assert(subresourceIndex < m_subresourceOffsets.size());
+
+	std::lock_guard<std::mutex> lkg(m_mapMutex);
+	if (!m_memory) {
+		m_memory = std::make_unique<uint8_t[]>(m_sizeInBytes);
+	}
+	return m_memory.get() + m_subresourceOffsets[subresourceIndex];
+}
+
+
+void Resource::Unmap(unsigned subresourceIndex, const gxapi::MemoryRange* writtenRange) {
+	// memory is kept around, mapping is persistent
+}
+
+
+void* Resource::GetGPUAddress() const {
+	return m_gpuAddress;
+}
+
+
+unsigned Resource::GetNumMipLevels() {
+	return m_numMipLevels;
+}
+unsigned Resource::GetNumTexturePlanes() {
+	return m_numTexturePlanes;
+}
+unsigned Resource::GetNumArrayLevels() {
+	return m_numArrayLevels;
+}
+
+unsigned Resource::GetNumSubresources() {
+	return m_numMipLevels * m_numTexturePlanes * m_numArrayLevels;
+}
+unsigned Resource::GetSubresourceIndex(unsigned mipIdx, unsigned arrayIdx, unsigned planeIdx) {
+	// same layout as D3D12CalcSubresource
+	unsigned index = mipIdx + arrayIdx * m_numMipLevels + planeIdx * m_numMipLevels * m_numArrayLevels;
+	assert(index < GetNumSubresources());
+	return index;
+}
+
+
+void Resource::SetName(const char* name) {
+	m_name = name;
+}
+
+
+uint64_t Resource::CalculateSize(const gxapi::ResourceDesc& desc, std::vector<uint64_t>* subresourceOffsets) {
+	if (desc.type == gxapi::eResourceType::BUFFER) {
+		if (subresourceOffsets) {
+			subresourceOffsets->assign(1, 0);
+		}
+		return desc.bufferDesc.sizeInBytes;
+	}
+
+	const gxapi::TextureDesc& tex = desc.textureDesc;
+	unsigned mipLevels = std::max<unsigned>(1, tex.mipLevels);
+	unsigned planes = GetFormatPlaneCount(tex.format);
+	bool is3D = tex.dimension == gxapi::eTextueDimension::THREE;
+	unsigned arraySize = is3D ? 1 : std::max<unsigned>(1, tex.depthOrArraySize);
+	uint64_t pixelSize = std::max<unsigned>(1, gxapi::GetFormatSizeInBytes(tex.format));
+	uint64_t samples = std::max<uint32_t>(1, tex.multisampleCount);
+
+	if (subresourceOffsets) {
+		subresourceOffsets->clear();
+		subresourceOffsets->reserve(mipLevels * arraySize * planes);
+	}
+
+	uint64_t offset = 0;
+	for (unsigned plane = 0; plane < planes; ++plane) {
+		for (unsigned arrayIdx = 0; arrayIdx < arraySize; ++arrayIdx) {
+			for (unsigned mip = 0; mip < mipLevels; ++mip) {
+				uint64_t width = std::max<uint64_t>(1, tex.width >> mip);
+				uint64_t height = std::max<uint64_t>(1, tex.height >> mip);
+				uint64_t depth = is3D ? std::max<uint64_t>(1, tex.depthOrArraySize >> mip) : 1;
+				if (subresourceOffsets) {
+					subresourceOffsets->push_back(offset);
+				}
+				offset += width * height * depth * pixelSize * samples;
+			}
+		}
+	}
+
+	return offset;
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
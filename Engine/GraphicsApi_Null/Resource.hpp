@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IResource.hpp"
+#include "Statistics.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+/// <summary> CPU-side stand-in for a committed resource. </summary>
+/// <remarks> Memory is only allocated when the resource is mapped,
+///		so large default-heap textures cost nothing but their bookkeeping. </remarks>
+class Resource : public gxapi::IResource {
+public:
+	Resource(const gxapi::ResourceDesc& desc, gxapi::eHeapType heapType, void* gpuAddress, DeviceCounters* counters);
+	~Resource();
+	Resource(const Resource&) = delete;
+	Resource& operator=(const Resource&) = delete;
+
+	gxapi::ResourceDesc GetDesc() const override;
+	void* Map(unsigned subresourceIndex, const gxapi::MemoryRange* readRange = nullptr) override;
+	void Unmap(unsigned subresourceIndex, const gxapi::MemoryRange* writtenRange = nullptr) override;
+	void* GetGPUAddress() const override;
+
+	unsigned GetNumMipLevels() override;
+	unsigned GetNumTexturePlanes() override;
+	unsigned GetNumArrayLevels() override;
+	unsigned GetNumSubresources() override;
+	unsigned GetSubresourceIndex(unsigned mipIdx, unsigned arrayIdx, unsigned planeIdx) override;
+
+	void SetName(const char* name) override;
+
+	const std::string& GetName() const { return m_name; }
+	gxapi::eHeapType GetHeapType() const { return m_heapType; }
+	uint64_t GetSizeInBytes() const { return m_sizeInBytes; }
+
+	/// <summary> Computes the memory footprint of a resource, including all subresources. </summary>
+	static uint64_t CalculateSize(const gxapi::ResourceDesc& desc, std::vector<uint64_t>* subresourceOffsets = nullptr);
+private:
+	gxapi::ResourceDesc m_desc;
+	gxapi::eHeapType m_heapType;
+	void* m_gpuAddress;
+	DeviceCounters* m_counters;
+	std::string m_name;
+
+	unsigned m_numMipLevels, m_numTexturePlanes, m_numArrayLevels;
+	uint64_t m_sizeInBytes;
+	std::vector<uint64_t> m_subresourceOffsets;
+
+	std::mutex m_mapMutex;
+	std::unique_ptr<uint8_t[]> m_memory;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
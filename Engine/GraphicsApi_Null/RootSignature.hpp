@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IRootSignature.hpp"
+#include "../GraphicsApi_LL/Common.hpp"
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+class RootSignature : public gxapi::IRootSignature {
+public:
+	RootSignature(size_t numParameters) : m_numParameters(numParameters) {}
+	size_t GetNumParameters() const { return m_numParameters; }
+private:
+	size_t m_numParameters;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+/// <summary> Snapshot of the work submitted to a null device. </summary>
+struct Statistics {
+	// submission
+	uint64_t commandListsExecuted = 0;
+	uint64_t draws = 0;
+	uint64_t dispatches = 0;
+	uint64_t copies = 0;
+	uint64_t barriers = 0;
+	uint64_t clears = 0;
+
+	// binding
+	uint64_t pipelineStateBinds = 0;
+	uint64_t rootSignatureBinds = 0;
+	uint64_t rootArgumentBinds = 0;
+	uint64_t descriptorsCreated = 0;
+	uint64_t descriptorsCopied = 0;
+
+	// memory
+	uint64_t liveResources = 0;
+	uint64_t liveResourceBytes = 0;
+	uint64_t residencyChanges = 0;
+};
+
+
+/// <summary> Counters recorded by a single command list, added to the device totals on execution. </summary>
+struct CommandListCounters {
+	uint32_t draws = 0;
+	uint32_t dispatches = 0;
+	uint32_t copies = 0;
+	uint32_t barriers = 0;
+	uint32_t clears = 0;
+	uint32_t pipelineStateBinds = 0;
+	uint32_t rootSignatureBinds = 0;
+	uint32_t rootArgumentBinds = 0;
+};
+
+
+/// <summary> Thread-safe counters owned by the device. </summary>
+struct DeviceCounters {
+	std::atomic<uint64_t> commandListsExecuted = 0;
+	std::atomic<uint64_t> draws = 0;
+	std::atomic<uint64_t> dispatches = 0;
+	std::atomic<uint64_t> copies = 0;
+	std::atomic<uint64_t> barriers = 0;
+	std::atomic<uint64_t> clears = 0;
+	std::atomic<uint64_t> pipelineStateBinds = 0;
+	std::atomic<uint64_t> rootSignatureBinds = 0;
+	std::atomic<uint64_t> rootArgumentBinds = 0;
+	std::atomic<uint64_t> descriptorsCreated = 0;
+	std::atomic<uint64_t> descriptorsCopied = 0;
+	std::atomic<uint64_t> liveResources = 0;
+	std::atomic<uint64_t> liveResourceBytes = 0;
+	std::atomic<uint64_t> residencyChanges = 0;
+
+	void Add(const CommandListCounters& list) {
+		++commandListsExecuted;
+		draws += list.draws;
+		dispatches += list.dispatches;
+		copies += list.copies;
+		barriers += list.barriers;
+		clears += list.clears;
+		pipelineStateBinds += list.pipelineStateBinds;
+		rootSignatureBinds += list.rootSignatureBinds;
+		rootArgumentBinds += list.rootArgumentBinds;
+	}
+
+	Statistics Snapshot() const {
+		Statistics s;
+		s.commandListsExecuted = commandListsExecuted;
+		s.draws = draws;
+		s.dispatches = dispatches;
+		s.copies = copies;
+		s.barriers = barriers;
+		s.clears = clears;
+		s.pipelineStateBinds = pipelineStateBinds;
+		s.rootSignatureBinds = rootSignatureBinds;
+		s.rootArgumentBinds = rootArgumentBinds;
+		s.descriptorsCreated = descriptorsCreated;
+		s.descriptorsCopied = descriptorsCopied;
+		s.liveResources = liveResources;
+		s.liveResourceBytes = liveResourceBytes;
+		s.residencyChanges = residencyChanges;
+		return s;
+	}
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,66 @@
+#include "SwapChain.hpp"
+
+#include <cassert>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+SwapChain::SwapChain(gxapi::SwapChainDesc desc, DeviceCounters* counters)
+	: m_desc(desc), m_counters(counters)
+{}
+
+
+gxapi::IResource* SwapChain::GetBuffer(unsigned index) {
+	assert(index < m_desc.numBuffers);
+
+	// like D3D12, every call gives a new object owned by the caller, the buffers have no contents anyway
+	gxapi::ResourceDesc desc = gxapi::ResourceDesc::Texture2D(m_desc.width, m_desc.height, m_desc.format, gxapi::eResourceFlags::ALLOW_RENDER_TARGET);
+	Resource* buffer = new Resource(desc, gxapi::eHeapType::DEFAULT, nullptr, m_counters);
+	buffer->SetName("Null swap chain buffer");
+	return buffer;
+}
+
+
+gxapi::SwapChainDesc SwapChain::GetDesc() const {
+	return m_desc;
+}
+
+
+bool SwapChain::IsFullScreen() const {
+	return m_desc.isFullScreen;
+}
+
+
+unsigned SwapChain::GetCurrentBufferIndex() const {
+	return m_currentBuffer;
+}
+
+
+void SwapChain::SetFullScreen(bool isFullScreen) {
+	m_desc.isFullScreen = isFullScreen;
+}
+
+
+void SwapChain::Resize(unsigned width, unsigned height, unsigned bufferCount, gxapi::eFormat format) {
+	m_desc.width = width;
+	m_desc.height = height;
+	if (bufferCount != 0) {
+		m_desc.numBuffers = bufferCount;
+	}
+	if (format != gxapi::eFormat::UNKNOWN) {
+		m_desc.format = format;
+	}
+	m_currentBuffer = 0;
+}
+
+
+void SwapChain::Present() {
+	m_currentBuffer = (m_currentBuffer + 1) % m_desc.numBuffers;
+	++m_presentCount;
+}
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../GraphicsApi_LL/ISwapChain.hpp"
+#include "../GraphicsApi_LL/Common.hpp"
+#include "Resource.hpp"
+
+#include <memory>
+#include <vector>
+
+
+namespace inl {
+namespace gxapi_null {
+
+
+/// <summary> Swap chain without a window. Present only flips the current buffer index. </summary>
+class SwapChain : public gxapi::ISwapChain {
+public:
+	SwapChain(gxapi::SwapChainDesc desc, DeviceCounters* counters);
+
+	/// <summary> Returns a new object owned by the caller. </summary>
+	gxapi::IResource* GetBuffer(unsigned index) override;
+	gxapi::SwapChainDesc GetDesc() const override;
+	bool IsFullScreen() const override;
+	unsigned GetCurrentBufferIndex() const override;
+
+	void SetFullScreen(bool isFullScreen) override;
+	void Resize(unsigned width, unsigned height, unsigned bufferCount = 0, gxapi::eFormat format = gxapi::eFormat::UNKNOWN) override;
+
+	void Present() override;
+
+	uint64_t GetPresentCount() const { return m_presentCount; }
+private:
+	gxapi::SwapChainDesc m_desc;
+	DeviceCounters* m_counters;
+	unsigned m_currentBuffer = 0;
+	uint64_t m_presentCount = 0;
+};
+
+
+} // namespace gxapi_null
+} // namespace inl
@@ -1 +1,37 @@
 #pragma once
+
+#include <mathfu/vector.h>
+
+
+namespace inl {
+namespace gxeng {
+
+
+class ITerrainTileSource;
+
+
+/// <summary>
+/// A height field ground surface, drawn as a quadtree of tiles whose detail follows the camera.
+/// Tiles are loaded on demand from a tile source, only the surroundings of the camera are kept in full detail.
+/// </summary>
+class ITerrainEntity {
+public:
+	virtual ~ITerrainEntity() = default;
+
+	/// <summary> Sets where the tiles are loaded from. Tiles of the previous source are dropped. </summary>
+	/// <remarks> The source is not owned, it must outlive the entity. </remarks>
+	virtual void SetTileSource(ITerrainTileSource* source) = 0;
+	virtual ITerrainTileSource* GetTileSource() const = 0;
+
+	/// <summary> Position of the terrain's corner with the smallest X and Y coordinates. </summary>
+	virtual void SetPosition(mathfu::Vector<float, 3> position) = 0;
+	virtual mathfu::Vector<float, 3> GetPosition() const = 0;
+
+	/// <summary> Tiles are refined until their height error projected to the screen is below this many pixels. </summary>
+	virtual void SetPixelErrorThreshold(float pixels) = 0;
+	virtual float GetPixelErrorThreshold() const = 0;
+};
+
+
+} // namespace gxeng
+} // namespace inl
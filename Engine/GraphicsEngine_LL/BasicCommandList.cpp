@@ -1,6 +1,5 @@
 #include "BasicCommandList.hpp"
 #include <iterator>
-#include "GraphicsApi_D3D12/CommandList.hpp"
 
 namespace inl {
 namespace gxeng {
@@ -85,13 +84,10 @@ BasicCommandList::Decomposition BasicCommandList::Decompose() {
 	decomposition.commandAllocator = std::move(m_commandAllocator);
 	decomposition.commandList = std::move(m_commandList);
 	decomposition.scratchSpaces = std::move(m_scratchSpaces);
-	decomposition.usedResources.reserve(m_resourceTransitions.size());
+	decomposition.usedResources.reserve(m_resourceTransitions.GetResourceCount());
 	decomposition.additionalResources = std::move(m_additionalResources);
 
-	// Copy the elements of state transition map to vector w/ transforming types.
-	for (const auto& v : m_resourceTransitions) {
-		decomposition.usedResources.push_back(ResourceUsage{ std::move(v.first.resource), v.first.subresource, v.second.firstState, v.second.lastState, v.second.multipleStates });
-	}
+	m_resourceTransitions.Decompose(decomposition.usedResources);
 
 	return decomposition;
 }
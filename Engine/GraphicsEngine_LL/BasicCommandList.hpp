@@ -4,62 +4,13 @@
 #include "../GraphicsApi_LL/Common.hpp"
 
 #include "MemoryObject.hpp"
+#include "ResourceStateTable.hpp"
 #include "CommandAllocatorPool.hpp"
 #include "ScratchSpacePool.hpp"
 #include "HostDescHeap.hpp"
 
 #include <vector>
 #include <memory>
-#include <unordered_map>
-
-
-
-namespace inl {
-namespace gxeng {
-
-struct SubresourceId {
-	SubresourceId() = default;
-	SubresourceId(const MemoryObject& resource, unsigned subresource) : resource(resource), subresource(subresource) {}
-
-	bool operator==(const SubresourceId& other) const {
-		return resource == other.resource && subresource == other.subresource;
-	}
-
-	MemoryObject resource;
-	unsigned subresource;
-};
-
-struct SubresourceUsageInfo {
-	gxapi::eResourceState firstState; /// <summary> Holds the target state of the first transition. </summary>
-	gxapi::eResourceState lastState; /// <summary> Holds the target state of the last transition. </summary>
-	bool multipleStates; /// <sumamry> True if resource was used in more than one state. </summary>
-};
-
-struct ResourceUsage {
-	MemoryObject resource;
-	unsigned subresource;
-	gxapi::eResourceState firstState;
-	gxapi::eResourceState lastState;
-	bool multipleStates;
-};
-
-
-} // namespace gxeng
-} // namespace inl
-
-
-namespace std {
-
-using namespace inl;
-
-template<>
-struct hash<gxeng::SubresourceId> {
-	std::size_t operator()(const gxeng::SubresourceId& instance) const {
-		return std::hash<const void*>{}(instance.resource._GetResourcePtr()) ^ std::hash<unsigned>{}(instance.subresource);
-	}
-};
-
-} // namespace std
 
 
 
@@ -99,7 +50,8 @@ protected:
 	StackDescHeap* GetCurrentScratchSpace();
 	virtual void NewScratchSpace(size_t sizeHint);
 protected:
-	std::unordered_map<SubresourceId, SubresourceUsageInfo> m_resourceTransitions;
+	ResourceStateTable m_resourceTransitions;
+	std::vector<gxapi::ResourceBarrier> m_barrierBuffer; // to avoid reallocating on every state change
 	std::vector<MemoryObject> m_additionalResources;
 	gxapi::IGraphicsApi* m_graphicsApi;
 private:
@@ -4,6 +4,7 @@
 
 #include "Binder.hpp"
 #include <algorithm>
+#include <stdexcept>
 
 
 namespace inl {
@@ -117,6 +118,10 @@ void Binder::CalculateLayout(const std::vector<BindParameterDesc>& parameters) {
 			regOfStreak = param.parameter.reg;
 			rootTable.ranges.back().numDescriptors++;
 		}
+		// bindless parameters have a table of their own that spans the bindless heap
+		if (table.size() == 1 && table[0].bindless) {
+			rootTable.ranges.back().numDescriptors = gxapi::DescriptorRange::UNBOUNDED;
+		}
 
 		++rootParamIndex;
 	}
@@ -139,8 +144,16 @@ void Binder::DistributeParameters(const std::vector<BindParameterDesc>& paramete
 {
 	// put SRV's and UAV's into descriptor table: they have so many limitation that inlining them is basically worthless
 	// put samplers into separate list
+	// bindless parameters get a table each, appended after the others
+	std::vector<BindParameterDesc> bindlessParams;
 	for (const auto& param : parameters) {
-		if (param.parameter.type == eBindParameterType::TEXTURE || param.parameter.type == eBindParameterType::UNORDERED) {
+		if (param.bindless) {
+			if (param.parameter.type != eBindParameterType::TEXTURE && param.parameter.type != eBindParameterType::UNORDERED) {
+				throw std::invalid_argument("Only texture and unordered parameters can be bindless.");
+			}
+			bindlessParams.push_back(param);
+		}
+		else if (param.parameter.type == eBindParameterType::TEXTURE || param.parameter.type == eBindParameterType::UNORDERED) {
 			if (tableParams.size() == 0) {
 				tableParams.resize(1);
 			}
@@ -165,6 +178,7 @@ void Binder::DistributeParameters(const std::vector<BindParameterDesc>& paramete
 		for (const auto& table : tableParams) {
 			size += 4;
 		}
+		size += 4 * (int)bindlessParams.size();
 		for (const auto& constant : constantParams) {
 			size += constant.constantSize > 0 ? ((constant.constantSize + 3) / 4 * 4) : 8;
 		}
@@ -216,6 +230,10 @@ void Binder::DistributeParameters(const std::vector<BindParameterDesc>& paramete
 			}
 		}
 	}
+
+	for (const auto& param : bindlessParams) {
+		tableParams.push_back({ param });
+	}
 }
 
 
@@ -65,6 +65,9 @@ struct BindParameterDesc {
 	float relativeAccessFrequency = 1; /// <summary> Not used currently. TODO: Read more about this aspect. </summary>
 	float relativeChangeFrequency = 1; /// <summary> How often will you change this binding relative to others. Absolute value does not matter. </summary>
 	gxapi::eShaderVisiblity shaderVisibility = gxapi::eShaderVisiblity::ALL;
+	/// <summary> Makes a texture or unordered parameter an unbounded array of the bindless heap's descriptors.
+	///		Bind it with the <see cref="BindlessHeap"/>, shaders index the array by bindless index. </summary>
+	bool bindless = false;
 };
 
 
@@ -2,6 +2,7 @@
 
 #include "RootTableManager.hpp"
 #include "ResourceView.hpp"
+#include "BindlessHeap.hpp"
 #include "MemoryManager.hpp"
 #include "VolatileViewHeap.hpp"
 
@@ -36,6 +37,10 @@ public:
 	void Bind(BindParameter parameter, const RWTextureView2D& rwResource);
 	void Bind(BindParameter parameter, const RWTextureView3D& rwResource);
 	void Bind(BindParameter parameter, const RWBufferView& rwResource);
+
+	/// <summary> Points a bindless parameter to the persistent descriptors of the heap. </summary>
+	/// <exception cref="std::invalid_argument"> If the scratch space is not part of the bindless heap. </exception>
+	void Bind(BindParameter parameter, const BindlessHeap& bindlessHeap);
 protected:
 	void SetRootConstants(gxapi::IGraphicsCommandList* list, unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value);
 	void SetRootConstants(gxapi::IComputeCommandList* list, unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value);
@@ -194,6 +199,30 @@ void BindingManager<Type>::Bind(BindParameter parameter, const RWBufferView& rwR
 }
 
 
+template <gxapi::eCommandListType Type>
+void BindingManager<Type>::Bind(BindParameter parameter, const BindlessHeap& bindlessHeap) {
+	assert(m_binder != nullptr);
+	assert(m_heap != nullptr);
+
+	// a command list can only have one shader visible heap, every heap of the bindless heap starts with the persistent descriptors
+	if (!bindlessHeap.OwnsHeap(m_heap->GetHeap())) {
+		throw std::invalid_argument("Scratch space does not belong to the bindless heap.");
+	}
+
+	int slot, tableIndex;
+	const gxapi::RootSignatureDesc& desc = m_binder->GetRootSignatureDesc();
+	m_binder->Translate(parameter, slot, tableIndex);
+	const auto& rootParam = desc.rootParameters[slot];
+
+	if (rootParam.type == gxapi::RootParameterDesc::DESCRIPTOR_TABLE) {
+		SetUnboundedTable(slot);
+	}
+	else {
+		throw std::invalid_argument("Parameter is not bindless.");
+	}
+}
+
+
 template <gxapi::eCommandListType Type>
 void BindingManager<Type>::SetRootConstants(gxapi::IGraphicsCommandList* list, unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value) {
 	list->SetGraphicsRootConstants(parameterIndex, destOffset, numValues, value);
@@ -0,0 +1,176 @@
+#include "BindlessHeap.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace inl {
+namespace gxeng {
+
+
+BindlessHeap::BindlessHeap(gxapi::IGraphicsApi* graphicsApi, uint32_t numPersistent, uint32_t numScratchSpaces, uint32_t scratchSpaceSize)
+	: m_graphicsApi(graphicsApi),
+	m_numPersistent(numPersistent),
+	m_scratchSpaceSize(scratchSpaceSize),
+	m_allocEngine(numPersistent)
+{
+	gxapi::DescriptorHeapDesc desc(gxapi::eDescriptorHeapType::CBV_SRV_UAV, numPersistent, false);
+	m_persistentHeap.reset(graphicsApi->CreateDescriptorHeap(desc));
+	AddHeap(std::max(numScratchSpaces, 1u));
+}
+
+
+uint32_t BindlessHeap::Register(gxapi::DescriptorHandle source) {
+	size_t index = Allocate();
+
+	// replaced heaps get the descriptor too, they may still be bound by command lists
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_graphicsApi->CopyDescriptors(source, m_persistentHeap->At(index), 1, gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+	for (auto& heap : m_heaps) {
+		m_graphicsApi->CopyDescriptors(source, heap.heap->At(index), 1, gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+	}
+	return (uint32_t)index;
+}
+
+
+size_t BindlessHeap::Allocate() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_allocEngine.Allocate();
+}
+
+
+void BindlessHeap::Deallocate(size_t index) {
+	assert(index < m_numPersistent);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_currFrameId <= m_lastFinishedFrameId) {
+		m_allocEngine.Deallocate(index);
+	}
+	else {
+		m_pendingFrees.push_back({ (uint32_t)index, m_currFrameId });
+	}
+}
+
+
+gxapi::DescriptorHandle BindlessHeap::At(size_t index) {
+	assert(index < m_numPersistent);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_heaps.back().heap->At(index);
+}
+
+
+gxapi::DescriptorHandle BindlessHeap::GetTableStart() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_heaps.back().heap->At(0);
+}
+
+
+gxapi::IDescriptorHeap* BindlessHeap::GetHeap() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_heaps.back().heap.get();
+}
+
+
+bool BindlessHeap::OwnsHeap(const gxapi::IDescriptorHeap* heap) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::any_of(m_heaps.begin(), m_heaps.end(), [heap](const ShaderVisibleHeap& owned) {
+		return owned.heap.get() == heap;
+	});
+}
+
+
+std::unique_ptr<StackDescHeap> BindlessHeap::CreateScratchSpace() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// command lists already recorded keep the old heap, new ones get a heap with room for twice as many scratch spaces
+	if (m_heaps.back().numScratchSpacesCreated == m_heaps.back().numScratchSpaces) {
+		AddHeap(2 * m_heaps.back().numScratchSpaces);
+	}
+
+	ShaderVisibleHeap& current = m_heaps.back();
+	uint32_t offset = m_numPersistent + current.numScratchSpacesCreated*m_scratchSpaceSize;
+	auto scratchSpace = std::make_unique<StackDescHeap>(current.heap.get(), offset, m_scratchSpaceSize);
+	++current.numScratchSpacesCreated;
+	++current.numScratchSpacesAlive;
+	return scratchSpace;
+}
+
+
+void BindlessHeap::ReleaseScratchSpace(std::unique_ptr<StackDescHeap> scratchSpace) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = std::find_if(m_heaps.begin(), m_heaps.end(), [&scratchSpace](const ShaderVisibleHeap& heap) {
+		return heap.heap.get() == scratchSpace->GetHeap();
+	});
+	assert(it != m_heaps.end());
+	scratchSpace.reset();
+
+	--it->numScratchSpacesAlive;
+	if (it->numScratchSpacesAlive == 0 && it != m_heaps.end() - 1) {
+		m_heaps.erase(it);
+	}
+}
+
+
+bool BindlessHeap::IsCurrent(const StackDescHeap& scratchSpace) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return scratchSpace.GetHeap() == m_heaps.back().heap.get();
+}
+
+
+uint32_t BindlessHeap::GetNumScratchSpaces() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_heaps.back().numScratchSpaces;
+}
+
+
+size_t BindlessHeap::GetNumHeaps() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_heaps.size();
+}
+
+
+size_t BindlessHeap::GetNumPendingFrees() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pendingFrees.size();
+}
+
+
+void BindlessHeap::BeginFrame(uint64_t frameId) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_currFrameId = frameId + 1;
+}
+
+
+void BindlessHeap::AddHeap(uint32_t numScratchSpaces) {
+	gxapi::DescriptorHeapDesc desc(gxapi::eDescriptorHeapType::CBV_SRV_UAV, m_numPersistent + numScratchSpaces*m_scratchSpaceSize, true);
+	std::unique_ptr<gxapi::IDescriptorHeap> heap(m_graphicsApi->CreateDescriptorHeap(desc));
+	m_graphicsApi->CopyDescriptors(m_persistentHeap->At(0), heap->At(0), m_numPersistent, gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+
+	// a replaced heap without scratch spaces can't be bound by any command list
+	if (!m_heaps.empty() && m_heaps.back().numScratchSpacesAlive == 0) {
+		m_heaps.pop_back();
+	}
+	m_heaps.push_back({ std::move(heap), numScratchSpaces, 0, 0 });
+}
+
+
+void BindlessHeap::OnFrameCompleteDevice(uint64_t frameId) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_lastFinishedFrameId = std::max(m_lastFinishedFrameId, frameId + 1);
+
+	auto firstKept = std::remove_if(m_pendingFrees.begin(), m_pendingFrees.end(), [this](const PendingFree& pending) {
+		if (pending.frameId <= m_lastFinishedFrameId) {
+			m_allocEngine.Deallocate(pending.index);
+			return true;
+		}
+		return false;
+	});
+	m_pendingFrees.erase(firstKept, m_pendingFrees.end());
+}
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "HostDescHeap.hpp"
+#include "StackDescHeap.hpp"
+#include "PipelineEventListener.hpp"
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "../GraphicsApi_LL/IDescriptorHeap.hpp"
+#include "../BaseLibrary/Memory/SlabAllocatorEngine.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary>
+/// One large shader visible CBV_SRV_UAV heap for bindless resource access.
+/// <para />
+/// The front of the heap holds persistent descriptors at stable indices, shaders index them
+/// through a single unbounded descriptor table. The rest of the heap is split into scratch spaces
+/// for the descriptor tables of command lists, so both can be used with the only shader visible heap
+/// a command list can have.
+/// <para />
+/// When all scratch spaces are in use, the shader visible heap is replaced by one with twice as many.
+/// The persistent descriptors are kept in a non shader visible heap as well, and copied to the new heap.
+/// <para />
+/// This class is thread safe.
+/// </summary>
+/// <remarks>
+/// Freed indices are only reused after the frames that might have used them completed on the GPU,
+/// so the heap has to receive the pipeline events.
+/// <para />
+/// A replaced heap gets the persistent descriptors registered later too, command lists recorded with
+/// its scratch spaces stay valid. It is destroyed with its last scratch space.
+/// </remarks>
+class BindlessHeap : public IHostDescHeap, public PipelineEventListener {
+public:
+	static constexpr uint32_t InvalidIndex = ~uint32_t(0);
+
+	BindlessHeap(gxapi::IGraphicsApi* graphicsApi, uint32_t numPersistent = 65536, uint32_t numScratchSpaces = 64, uint32_t scratchSpaceSize = 1000);
+	BindlessHeap(const BindlessHeap&) = delete;
+	BindlessHeap& operator=(const BindlessHeap&) = delete;
+
+	/// <summary> Copies a descriptor from a non shader visible heap to a new persistent slot. </summary>
+	/// <returns> The index of the descriptor, free it with <see cref="Deallocate"/>. </returns>
+	/// <exception cref="std::bad_alloc"> If all persistent slots are in use. </exception>
+	uint32_t Register(gxapi::DescriptorHandle source);
+
+	size_t Allocate() override;
+	void Deallocate(size_t index) override;
+	gxapi::DescriptorHandle At(size_t index) override;
+
+	/// <summary> The first persistent descriptor of the current heap, bindless descriptor tables start here. </summary>
+	gxapi::DescriptorHandle GetTableStart() const;
+	/// <summary> The current shader visible heap, new scratch spaces are carved from it. </summary>
+	gxapi::IDescriptorHeap* GetHeap() const;
+	/// <summary> True if the heap is the current or a replaced heap, either starts with the persistent descriptors. </summary>
+	bool OwnsHeap(const gxapi::IDescriptorHeap* heap) const;
+
+	/// <summary> Creates a scratch space in the scratch region of the current heap. </summary>
+	/// <remarks> The heap is replaced by a larger one if all its scratch spaces have been created. </remarks>
+	std::unique_ptr<StackDescHeap> CreateScratchSpace();
+	/// <summary> Destroys a scratch space the GPU no longer uses. A replaced heap is destroyed with its last scratch space. </summary>
+	void ReleaseScratchSpace(std::unique_ptr<StackDescHeap> scratchSpace);
+	/// <summary> False if the scratch space belongs to a replaced heap, it should be released instead of reused. </summary>
+	bool IsCurrent(const StackDescHeap& scratchSpace) const;
+
+	uint32_t GetNumPersistent() const { return m_numPersistent; }
+	/// <summary> Number of scratch spaces the current heap has room for. </summary>
+	uint32_t GetNumScratchSpaces() const;
+	/// <summary> Number of shader visible heaps, the current one and the replaced ones still in use. </summary>
+	size_t GetNumHeaps() const;
+	/// <summary> Number of freed indices that wait for the GPU to complete a frame. </summary>
+	size_t GetNumPendingFrees() const;
+
+	/// <summary> Indices freed from now on may be used by this frame. Called on the host before recording the frame. </summary>
+	void BeginFrame(uint64_t frameId);
+
+	void OnFrameBeginDevice(uint64_t frameId) override {}
+	void OnFrameBeginHost(uint64_t frameId) override {}
+	void OnFrameBeginAwait(uint64_t frameId) override {}
+	void OnFrameCompleteDevice(uint64_t frameId) override;
+	void OnFrameCompleteHost(uint64_t frameId) override {}
+private:
+	struct PendingFree {
+		uint32_t index;
+		uint64_t frameId; // the last frame that could use the index, offset by one
+	};
+
+	struct ShaderVisibleHeap {
+		std::unique_ptr<gxapi::IDescriptorHeap> heap;
+		uint32_t numScratchSpaces;
+		uint32_t numScratchSpacesCreated;
+		uint32_t numScratchSpacesAlive;
+	};
+private:
+	void AddHeap(uint32_t numScratchSpaces);
+private:
+	gxapi::IGraphicsApi* m_graphicsApi;
+	std::unique_ptr<gxapi::IDescriptorHeap> m_persistentHeap; // not shader visible, copied to new heaps
+	const uint32_t m_numPersistent;
+	const uint32_t m_scratchSpaceSize;
+
+	mutable std::mutex m_mutex;
+	std::vector<ShaderVisibleHeap> m_heaps; // the last one is the current heap
+	exc::SlabAllocatorEngine m_allocEngine;
+	std::vector<PendingFree> m_pendingFrees;
+
+	// frame IDs are offset by one, so that zero means no frame has begun or finished yet
+	uint64_t m_currFrameId = 0;
+	uint64_t m_lastFinishedFrameId = 0;
+};
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,187 @@
+#include "ClusteredLightCulling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+using Vec3 = mathfu::Vector<float, 3>;
+
+
+ClusterGrid::ClusterGrid(ClusterGridDesc desc, float projScaleX, float projScaleY, float nearPlane, float farPlane)
+	: m_desc(desc),
+	m_projScaleX(projScaleX),
+	m_projScaleY(projScaleY),
+	m_near(nearPlane),
+	m_far(farPlane)
+{
+	if (desc.tilesX == 0 || desc.tilesY == 0 || desc.depthSlices == 0) {
+		throw std::invalid_argument("Cluster grid must have at least one cluster along each axis.");
+	}
+	if (!(nearPlane > 0.0f) || !(farPlane > nearPlane)) {
+		throw std::invalid_argument("Cluster grid needs 0 < near < far.");
+	}
+	if (!(projScaleX > 0.0f) || !(projScaleY > 0.0f)) {
+		throw std::invalid_argument("Cluster grid needs a perspective projection.");
+	}
+
+	float logRange = std::log(farPlane / nearPlane);
+	m_sliceScale = desc.depthSlices / logRange;
+	m_sliceBias = -(float)desc.depthSlices * std::log(nearPlane) / logRange;
+}
+
+
+float ClusterGrid::GetSliceDepth(unsigned slice) const {
+	if (slice >= m_desc.depthSlices) {
+		return m_far;
+	}
+	return m_near * std::pow(m_far / m_near, (float)slice / (float)m_desc.depthSlices);
+}
+
+
+ClusterBounds ClusterGrid::GetClusterBounds(unsigned x, unsigned y, unsigned slice) const {
+	float ndcLeft = -1.0f + 2.0f * x / m_desc.tilesX;
+	float ndcRight = -1.0f + 2.0f * (x + 1) / m_desc.tilesX;
+	float ndcTop = 1.0f - 2.0f * y / m_desc.tilesY;
+	float ndcBottom = 1.0f - 2.0f * (y + 1) / m_desc.tilesY;
+	float nearDepth = GetSliceDepth(slice);
+	float farDepth = GetSliceDepth(slice + 1);
+
+	// the cluster is a frustum segment, its sides are widest at whichever end the NDC sign favors
+	ClusterBounds bounds;
+	bounds.minimum = {
+		std::min(ndcLeft * nearDepth, ndcLeft * farDepth) / m_projScaleX,
+		std::min(ndcBottom * nearDepth, ndcBottom * farDepth) / m_projScaleY,
+		-farDepth
+	};
+	bounds.maximum = {
+		std::max(ndcRight * nearDepth, ndcRight * farDepth) / m_projScaleX,
+		std::max(ndcTop * nearDepth, ndcTop * farDepth) / m_projScaleY,
+		-nearDepth
+	};
+	return bounds;
+}
+
+
+bool ClusterGrid::Intersects(const ClusterBounds& cluster, const ClusterLight& light) const {
+	// sphere vs box
+	Vec3 closest = Vec3::Max(cluster.minimum, Vec3::Min(light.viewPosition, cluster.maximum));
+	Vec3 toClosest = closest - light.viewPosition;
+	if (Vec3::DotProduct(toClosest, toClosest) > light.range * light.range) {
+		return false;
+	}
+	if (!light.IsSpot()) {
+		return true;
+	}
+
+	// cone vs the bounding sphere of the box
+	Vec3 center = (cluster.minimum + cluster.maximum) * 0.5f;
+	float radius = (cluster.maximum - cluster.minimum).Length() * 0.5f;
+	Vec3 toCenter = center - light.viewPosition;
+	float alongAxis = Vec3::DotProduct(toCenter, light.viewDirection);
+	float fromAxis = std::sqrt(std::max(0.0f, Vec3::DotProduct(toCenter, toCenter) - alongAxis * alongAxis));
+	float sinHalfAngle = std::sqrt(std::max(0.0f, 1.0f - light.cosHalfAngle * light.cosHalfAngle));
+	float distanceToCone = light.cosHalfAngle * fromAxis - sinHalfAngle * alongAxis;
+
+	return distanceToCone <= radius && alongAxis >= -radius;
+}
+
+
+bool ClusterGrid::GetLightSlices(const ClusterLight& light, unsigned& first, unsigned& last) const {
+	float minDepth = -light.viewPosition.z() - light.range;
+	float maxDepth = -light.viewPosition.z() + light.range;
+	if (maxDepth < m_near || minDepth > m_far) {
+		return false;
+	}
+	minDepth = std::max(minDepth, m_near);
+	maxDepth = std::min(maxDepth, m_far);
+
+	// one slice of margin on each side absorbs rounding, the exact test decides anyway
+	float firstSlice = std::floor(std::log(minDepth) * m_sliceScale + m_sliceBias) - 1.0f;
+	float lastSlice = std::floor(std::log(maxDepth) * m_sliceScale + m_sliceBias) + 1.0f;
+	first = (unsigned)std::max(firstSlice, 0.0f);
+	last = (unsigned)std::min(lastSlice, (float)m_desc.depthSlices - 1.0f);
+	return first <= last;
+}
+
+
+bool ClusterGrid::GetLightTiles(const ClusterLight& light, unsigned slice, unsigned first[2], unsigned last[2]) const {
+	// cluster boxes grow monotonically along both axes, so the overlapping ones form a contiguous range
+	const unsigned count[2] = { m_desc.tilesX, m_desc.tilesY };
+	for (int axis = 0; axis < 2; ++axis) {
+		float lo = light.viewPosition[axis] - light.range;
+		float hi = light.viewPosition[axis] + light.range;
+		first[axis] = count[axis];
+		last[axis] = 0;
+		for (unsigned tile = 0; tile < count[axis]; ++tile) {
+			ClusterBounds bounds = axis == 0 ? GetClusterBounds(tile, 0, slice) : GetClusterBounds(0, tile, slice);
+			if (bounds.maximum[axis] >= lo && bounds.minimum[axis] <= hi) {
+				first[axis] = std::min(first[axis], tile);
+				last[axis] = std::max(last[axis], tile);
+			}
+		}
+		if (first[axis] > last[axis]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void AssignLightsToClusters(const ClusterGrid& grid, const std::vector<ClusterLight>& lights, size_t maxIndices, ClusterLightList& result) {
+	const unsigned numClusters = grid.GetClusterCount();
+	result.counts.assign(numClusters, 0);
+	result.offsets.resize(numClusters);
+
+	auto ForEachCluster = [&grid](const ClusterLight& light, auto&& func) {
+		unsigned firstSlice, lastSlice;
+		if (!grid.GetLightSlices(light, firstSlice, lastSlice)) {
+			return;
+		}
+		for (unsigned slice = firstSlice; slice <= lastSlice; ++slice) {
+			unsigned first[2], last[2];
+			if (!grid.GetLightTiles(light, slice, first, last)) {
+				continue;
+			}
+			for (unsigned y = first[1]; y <= last[1]; ++y) {
+				for (unsigned x = first[0]; x <= last[0]; ++x) {
+					if (grid.Intersects(grid.GetClusterBounds(x, y, slice), light)) {
+						func(grid.GetClusterIndex(x, y, slice));
+					}
+				}
+			}
+		}
+	};
+
+	// count
+	for (const auto& light : lights) {
+		ForEachCluster(light, [&](unsigned cluster) { ++result.counts[cluster]; });
+	}
+
+	// prefix sum, clusters past the capacity are cut short
+	uint64_t runningOffset = 0;
+	for (unsigned cluster = 0; cluster < numClusters; ++cluster) {
+		uint32_t offset = (uint32_t)std::min<uint64_t>(runningOffset, maxIndices);
+		runningOffset += result.counts[cluster];
+		result.offsets[cluster] = offset;
+		result.counts[cluster] = std::min<uint32_t>(result.counts[cluster], (uint32_t)(maxIndices - offset));
+	}
+	result.lightIndices.resize((size_t)std::min<uint64_t>(runningOffset, maxIndices));
+
+	// fill, going through lights in order keeps every list sorted
+	std::vector<uint32_t> written(numClusters, 0);
+	for (uint32_t lightIndex = 0; lightIndex < (uint32_t)lights.size(); ++lightIndex) {
+		ForEachCluster(lights[lightIndex], [&](unsigned cluster) {
+			if (written[cluster] < result.counts[cluster]) {
+				result.lightIndices[result.offsets[cluster] + written[cluster]] = lightIndex;
+				++written[cluster];
+			}
+		});
+	}
+}
+
+
+} // namespace inl::gxeng
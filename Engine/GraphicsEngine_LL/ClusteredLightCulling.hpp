@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mathfu/vector.h>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Number of clusters the view frustum is divided into along each axis. </summary>
+struct ClusterGridDesc {
+	unsigned tilesX = 16;
+	unsigned tilesY = 9;
+	unsigned depthSlices = 24;
+};
+
+
+/// <summary> A point or spot light in right-handed view space, as seen by the cluster assignment. </summary>
+struct ClusterLight {
+	mathfu::Vector<float, 3> viewPosition;
+	float range;
+	/// <summary> Spot direction, unused for point lights. </summary>
+	mathfu::Vector<float, 3> viewDirection;
+	/// <summary> Cosine of the spot's half angle, or -1 for point lights. </summary>
+	float cosHalfAngle = -1.0f;
+
+	bool IsSpot() const { return cosHalfAngle > -1.0f; }
+};
+
+
+/// <summary> View space axis aligned box of a single cluster. </summary>
+struct ClusterBounds {
+	mathfu::Vector<float, 3> minimum;
+	mathfu::Vector<float, 3> maximum;
+};
+
+
+/// <summary>
+/// Froxel grid over a symmetric perspective frustum.
+/// Tiles split the screen uniformly, the first row being at the top of the screen.
+/// Depth slices are exponential, slice k starts at near * (far/near)^(k/slices).
+/// </summary>
+class ClusterGrid {
+public:
+	/// <param name="projScaleX"> Element [0][0] of the projection matrix. </param>
+	/// <param name="projScaleY"> Element [1][1] of the projection matrix. </param>
+	/// <exception cref="std::invalid_argument"> If the grid is empty or the depth range is invalid. </exception>
+	ClusterGrid(ClusterGridDesc desc, float projScaleX, float projScaleY, float nearPlane, float farPlane);
+
+	const ClusterGridDesc& GetDesc() const { return m_desc; }
+	unsigned GetClusterCount() const { return m_desc.tilesX * m_desc.tilesY * m_desc.depthSlices; }
+	unsigned GetClusterIndex(unsigned x, unsigned y, unsigned slice) const { return (slice * m_desc.tilesY + y) * m_desc.tilesX + x; }
+
+	float GetNearPlane() const { return m_near; }
+	float GetFarPlane() const { return m_far; }
+	float GetProjScaleX() const { return m_projScaleX; }
+	float GetProjScaleY() const { return m_projScaleY; }
+
+	/// <summary> The slice of view depth d is floor(log(d) * scale + bias). </summary>
+	float GetSliceScale() const { return m_sliceScale; }
+	float GetSliceBias() const { return m_sliceBias; }
+	/// <summary> Returns the depth where the given slice begins. Slice count returns the far plane. </summary>
+	float GetSliceDepth(unsigned slice) const;
+
+	ClusterBounds GetClusterBounds(unsigned x, unsigned y, unsigned slice) const;
+
+	/// <summary> Exact test used to decide if a light affects a cluster. </summary>
+	bool Intersects(const ClusterBounds& cluster, const ClusterLight& light) const;
+
+	/// <summary> Conservative range of slices that may be touched by the light, inclusive on both ends. </summary>
+	/// <returns> False if the light is entirely outside the depth range of the grid. </returns>
+	bool GetLightSlices(const ClusterLight& light, unsigned& first, unsigned& last) const;
+	/// <summary> Range of tiles in a slice whose boxes overlap the light's box, inclusive on both ends. </summary>
+	/// <returns> False if there are no such tiles. </returns>
+	bool GetLightTiles(const ClusterLight& light, unsigned slice, unsigned first[2], unsigned last[2]) const;
+private:
+	ClusterGridDesc m_desc;
+	float m_projScaleX, m_projScaleY;
+	float m_near, m_far;
+	float m_sliceScale, m_sliceBias;
+};
+
+
+/// <summary>
+/// Compact light lists for each cluster.
+/// The lights of cluster i are lightIndices[offsets[i] ... offsets[i] + counts[i]), in ascending order.
+/// </summary>
+struct ClusterLightList {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> counts;
+	std::vector<uint32_t> lightIndices;
+};
+
+
+/// <summary>
+/// Assigns the lights to the clusters they affect. This is the reference for the GPU implementation
+/// in LightCulling.hlsl: both count, prefix sum and fill the same way, so the lists only differ where
+/// floating point rounding decides a light that barely touches a cluster.
+/// </summary>
+/// <param name="maxIndices"> Capacity of the index list. Clusters that do not fit keep only their lowest-index lights. </param>
+void AssignLightsToClusters(const ClusterGrid& grid, const std::vector<ClusterLight>& lights, size_t maxIndices, ClusterLightList& result);
+
+
+} // namespace inl::gxeng
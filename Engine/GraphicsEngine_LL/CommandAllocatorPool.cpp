@@ -31,17 +31,35 @@ auto CommandAllocatorPool::RequestAllocator(gxapi::eCommandListType type) -> Cmd
 }
 
 
-void CommandAllocatorPool::RecycleAllocator(gxapi::ICommandAllocator* allocator) {
+void CommandAllocatorPool::RecycleAllocator(CmdAllocPtr allocator, SyncPoint completion) {
 	switch (allocator->GetType())
 	{
 		case gxapi::eCommandListType::COPY:
-			m_cpPool.RecycleAllocator(allocator);
+			m_cpPool.RecycleAllocator(std::move(allocator), std::move(completion));
+			break;
 		case gxapi::eCommandListType::COMPUTE:
-			m_cuPool.RecycleAllocator(allocator);
+			m_cuPool.RecycleAllocator(std::move(allocator), std::move(completion));
+			break;
 		case gxapi::eCommandListType::GRAPHICS:
-			m_gxPool.RecycleAllocator(allocator);
+			m_gxPool.RecycleAllocator(std::move(allocator), std::move(completion));
+			break;
 		default:
-			assert(false); // hlye vagy bazmeg
+			assert(false);
+	}
+}
+
+
+size_t CommandAllocatorPool::GetNumAllocators(gxapi::eCommandListType type) const {
+	switch (type)
+	{
+		case gxapi::eCommandListType::COPY:
+			return m_cpPool.GetNumAllocators();
+		case gxapi::eCommandListType::COMPUTE:
+			return m_cuPool.GetNumAllocators();
+		case gxapi::eCommandListType::GRAPHICS:
+			return m_gxPool.GetNumAllocators();
+		default:
+			return 0;
 	}
 }
 
@@ -1,13 +1,15 @@
 #pragma once
 
-#include "../BaseLibrary/Memory/SlabAllocatorEngine.hpp"
+#include "../BaseLibrary/Memory/MultiInstanceTLS.hpp"
 #include "../GraphicsApi_LL/ICommandAllocator.hpp"
 #include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "SyncPoint.hpp"
 
 #include <vector>
+#include <deque>
 #include <mutex>
+#include <atomic>
 #include <algorithm>
-#include <map>
 #include <cassert>
 
 #include <iostream> // only for debug
@@ -22,129 +24,202 @@ namespace impl {
 
 	class CommandAllocatorPoolBase {
 	public:
+		struct ThreadCache;
+
 		struct Deleter {
 		public:
-			Deleter() : m_container(nullptr) {}
+			Deleter() : m_container(nullptr), m_cache(nullptr) {}
 			Deleter(const Deleter&) = default;
 			Deleter(Deleter&&) = default;
 			Deleter& operator=(const Deleter&) = default;
 			Deleter& operator=(Deleter&&) = default;
-			explicit Deleter(CommandAllocatorPoolBase* container) : m_container(container) {}
+			Deleter(CommandAllocatorPoolBase* container, ThreadCache* cache) : m_container(container), m_cache(cache) {}
 			void operator()(gxapi::ICommandAllocator* object) const {
 				assert(m_container != nullptr);
-				m_container->RecycleAllocator(object);
+				m_container->RecycleAllocator(object, m_cache);
 			}
+			ThreadCache* GetCache() const { return m_cache; }
 		private:
 			CommandAllocatorPoolBase* m_container;
+			ThreadCache* m_cache;
 		};
 		using UniquePtr = std::unique_ptr<gxapi::ICommandAllocator, Deleter>;
+
+		/// <summary> Allocators of a thread. They always return to the thread that requested them. </summary>
+		struct ThreadCache {
+			struct Pending {
+				std::unique_ptr<gxapi::ICommandAllocator> allocator;
+				SyncPoint completion;
+			};
+			std::mutex mutex; // only contended when an allocator is returned from another thread
+			std::vector<std::unique_ptr<gxapi::ICommandAllocator>> free;
+			std::deque<Pending> pending; // in submission order
+			size_t minFree = 0; // fewest free allocators since the last trim
+			unsigned requestCount = 0; // since the last trim
+		};
 	public:
 		virtual ~CommandAllocatorPoolBase() {}
 		virtual UniquePtr RequestAllocator() = 0;
-		virtual void RecycleAllocator(gxapi::ICommandAllocator*) = 0;
+		/// <summary> Returns an allocator that was not submitted, it can be reused right away. </summary>
+		virtual void RecycleAllocator(gxapi::ICommandAllocator* allocator, ThreadCache* cache) = 0;
+		/// <summary> Returns an allocator that was submitted, it is reused when the GPU reaches the sync point. </summary>
+		virtual void RecycleAllocator(UniquePtr allocator, SyncPoint completion) = 0;
+	protected:
+		/// <summary> Resets the allocators of all completed submissions and moves them to the free list. </summary>
+		static void RecycleCompleted(ThreadCache& cache);
 	};
 
 
+	inline void CommandAllocatorPoolBase::RecycleCompleted(ThreadCache& cache) {
+		// the fence is fetched once for a run of allocators submitted on the same queue
+		const gxapi::IFence* fence = nullptr;
+		uint64_t completedValue = 0;
+		while (!cache.pending.empty()) {
+			ThreadCache::Pending& front = cache.pending.front();
+			const gxapi::IFence* frontFence = front.completion.m_fence.get();
+			if (frontFence != nullptr) {
+				if (frontFence != fence) {
+					fence = frontFence;
+					completedValue = fence->Fetch();
+				}
+				if (front.completion.m_value > completedValue) {
+					break;
+				}
+			}
+			front.allocator->Reset();
+			cache.free.push_back(std::move(front.allocator));
+			cache.pending.pop_front();
+		}
+	}
+
+
+	/// <summary>
+	/// Command allocators of one type.
+	/// Each thread has its own free list, so requests don't contend with other threads.
+	/// Submitted allocators are recycled in bulk when the GPU finished with them.
+	/// New allocators are created when a thread runs out, and the ones that stayed unused
+	/// for <see cref="TrimInterval"/> requests are released.
+	/// </summary>
 	template <gxapi::eCommandListType TYPE>
 	class CommandAllocatorPool : public CommandAllocatorPoolBase {
 	public:
+		static constexpr unsigned TrimInterval = 256;
 	public:
-		explicit CommandAllocatorPool(gxapi::IGraphicsApi* gxApi, size_t initialSize = 1);
+		explicit CommandAllocatorPool(gxapi::IGraphicsApi* gxApi);
 		CommandAllocatorPool(const CommandAllocatorPool&) = delete;
-		CommandAllocatorPool(CommandAllocatorPool&& rhs);
-
 		CommandAllocatorPool& operator=(const CommandAllocatorPool&) = delete;
-		CommandAllocatorPool& operator=(CommandAllocatorPool&& rhs);
 
 
 		UniquePtr RequestAllocator() override;
-		void RecycleAllocator(gxapi::ICommandAllocator* allocator) override;
-		void Reset(size_t initialSize = 1);
+		void RecycleAllocator(gxapi::ICommandAllocator* allocator, ThreadCache* cache) override;
+		void RecycleAllocator(UniquePtr allocator, SyncPoint completion) override;
+
+		/// <summary> Number of allocators that currently exist, free or in use. </summary>
+		size_t GetNumAllocators() const { return m_numAllocators; }
 
 		gxapi::IGraphicsApi* GetGraphicsApi() const { return m_gxApi; }
 
 		void SetLogStream(exc::LogStream* logStream) { m_logStream = logStream; }
 		exc::LogStream* GetLogStream() const { return m_logStream; }
 	private:
-		std::vector<std::unique_ptr<gxapi::ICommandAllocator>> m_pool;
-		exc::SlabAllocatorEngine m_allocator;
+		struct ThreadSlot {
+			uint64_t poolId = 0; // the thread local slot may be reused by a later pool
+			ThreadCache* cache = nullptr;
+		};
+
+		ThreadCache* GetThreadCache();
+		void Trim(ThreadCache& cache);
+	private:
 		gxapi::IGraphicsApi* m_gxApi;
-		std::map<gxapi::ICommandAllocator*, size_t> m_addressToIndex;
 		exc::LogStream* m_logStream = nullptr;
+		std::atomic_size_t m_numAllocators;
 
-		std::mutex m_mtx;
-	};
+		uint64_t m_poolId;
+		exc::mi_tls<ThreadSlot> m_threadSlot;
+		std::mutex m_cachesMutex;
+		std::vector<std::unique_ptr<ThreadCache>> m_caches;
 
+		static std::atomic<uint64_t> s_nextPoolId;
+	};
 
 
 	template <gxapi::eCommandListType TYPE>
-	CommandAllocatorPool<TYPE>::CommandAllocatorPool(gxapi::IGraphicsApi* gxApi, size_t initialSize)
-		: m_pool(initialSize), m_allocator(initialSize), m_gxApi(gxApi)
-	{}
+	std::atomic<uint64_t> CommandAllocatorPool<TYPE>::s_nextPoolId = 1;
 
 
 	template <gxapi::eCommandListType TYPE>
-	CommandAllocatorPool<TYPE>::CommandAllocatorPool(CommandAllocatorPool&& rhs)
-		: m_pool(std::move(rhs.m_pool)), m_allocator(std::move(rhs.m_allocator)), m_gxApi(rhs.m_gxApi)
+	CommandAllocatorPool<TYPE>::CommandAllocatorPool(gxapi::IGraphicsApi* gxApi)
+		: m_gxApi(gxApi), m_numAllocators(0), m_poolId(s_nextPoolId++), m_threadSlot(ThreadSlot{})
 	{}
 
 
 	template <gxapi::eCommandListType TYPE>
-	CommandAllocatorPool<TYPE>& CommandAllocatorPool<TYPE>::operator=(CommandAllocatorPool&& rhs) {
-		m_pool = std::move(rhs.m_pool);
-		m_allocator = std::move(rhs.m_allocator);
-		m_gxApi = rhs.m_gxApi;
+	auto CommandAllocatorPool<TYPE>::RequestAllocator() -> UniquePtr {
+		ThreadCache* cache = GetThreadCache();
+		std::unique_ptr<gxapi::ICommandAllocator> allocator;
+
+		{
+			std::lock_guard<std::mutex> lkg(cache->mutex);
+			RecycleCompleted(*cache);
+			if (!cache->free.empty()) {
+				allocator = std::move(cache->free.back());
+				cache->free.pop_back();
+			}
+			cache->minFree = std::min(cache->minFree, cache->free.size());
+			if (++cache->requestCount >= TrimInterval) {
+				Trim(*cache);
+			}
+		}
 
-		return *this;
+		if (!allocator) {
+			allocator.reset(m_gxApi->CreateCommandAllocator(TYPE));
+			++m_numAllocators;
+		}
+		return UniquePtr{ allocator.release(), Deleter{ this, cache } };
 	}
 
 
 	template <gxapi::eCommandListType TYPE>
-	auto CommandAllocatorPool<TYPE>::RequestAllocator() -> UniquePtr {
-		std::lock_guard<std::mutex> lkg(m_mtx);
+	void CommandAllocatorPool<TYPE>::RecycleAllocator(gxapi::ICommandAllocator* allocator, ThreadCache* cache) {
+		assert(cache != nullptr);
+		allocator->Reset();
 
-		size_t index;
-		try {
-			index = m_allocator.Allocate();
-		}
-		catch (std::bad_alloc&) {
-			size_t currentSize = m_pool.size();
-			size_t newSize = std::max(currentSize + 1, size_t(currentSize * 1.25));
-			m_pool.resize(newSize);
-			m_allocator.Resize(newSize);
+		std::lock_guard<std::mutex> lkg(cache->mutex);
+		cache->free.push_back(std::unique_ptr<gxapi::ICommandAllocator>(allocator));
+	}
 
-			index = m_allocator.Allocate();
-		}
 
-		if (m_pool[index] != nullptr) {
-			return UniquePtr{ m_pool[index].get(), Deleter{this} };
-		}
-		else {
-			std::unique_ptr<gxapi::ICommandAllocator> ptr(m_gxApi->CreateCommandAllocator(TYPE));
-			m_addressToIndex[ptr.get()] = index;
-			m_pool[index] = std::move(ptr);
-			return UniquePtr{ m_pool[index].get(), Deleter{this} };
-		}
+	template <gxapi::eCommandListType TYPE>
+	void CommandAllocatorPool<TYPE>::RecycleAllocator(UniquePtr allocator, SyncPoint completion) {
+		ThreadCache* cache = allocator.get_deleter().GetCache();
+		assert(cache != nullptr);
+
+		std::lock_guard<std::mutex> lkg(cache->mutex);
+		cache->pending.push_back({ std::unique_ptr<gxapi::ICommandAllocator>(allocator.release()), std::move(completion) });
 	}
 
 
 	template <gxapi::eCommandListType TYPE>
-	void CommandAllocatorPool<TYPE>::RecycleAllocator(gxapi::ICommandAllocator* allocator) {
-		std::lock_guard<std::mutex> lkg(m_mtx);
-
-		allocator->Reset();
-		assert(m_addressToIndex.count(allocator) > 0);
-		size_t index = m_addressToIndex[allocator];
-		m_allocator.Deallocate(index);
+	auto CommandAllocatorPool<TYPE>::GetThreadCache() -> ThreadCache* {
+		ThreadSlot& slot = m_threadSlot;
+		if (slot.poolId != m_poolId) {
+			std::lock_guard<std::mutex> lkg(m_cachesMutex);
+			m_caches.push_back(std::make_unique<ThreadCache>());
+			slot = ThreadSlot{ m_poolId, m_caches.back().get() };
+		}
+		return slot.cache;
 	}
 
 
 	template <gxapi::eCommandListType TYPE>
-	void CommandAllocatorPool<TYPE>::Reset(size_t initialSize) {
-		m_pool.clear();
-		m_allocator.Reset();
-		m_pool.resize(initialSize);
-		m_allocator.Resize(initialSize);
+	void CommandAllocatorPool<TYPE>::Trim(ThreadCache& cache) {
+		// the allocators that were never taken since the last trim are not needed at peak usage
+		size_t unused = std::min(cache.minFree, cache.free.size());
+		cache.free.erase(cache.free.end() - unused, cache.free.end());
+		m_numAllocators -= unused;
+
+		cache.minFree = cache.free.size();
+		cache.requestCount = 0;
 	}
 
 } // namespace impl
@@ -157,12 +232,16 @@ public:
 public:
 	explicit CommandAllocatorPool(gxapi::IGraphicsApi* gxApi);
 	CommandAllocatorPool(const CommandAllocatorPool&) = delete;
-	CommandAllocatorPool(CommandAllocatorPool&& rhs) = default;
 	CommandAllocatorPool& operator=(const CommandAllocatorPool&) = delete;
-	CommandAllocatorPool& operator=(CommandAllocatorPool&& rhs) = default;
 
+	/// <summary> Returns a free allocator of the calling thread, or creates one if there is none. </summary>
 	CmdAllocPtr RequestAllocator(gxapi::eCommandListType type);
-	void RecycleAllocator(gxapi::ICommandAllocator* allocator);
+	/// <summary> Returns an allocator once the command lists recorded with it are submitted.
+	///		It is reset and reused by the requesting thread when the GPU reaches the sync point. </summary>
+	void RecycleAllocator(CmdAllocPtr allocator, SyncPoint completion);
+
+	/// <summary> Number of allocators of a type that currently exist, free or in use. </summary>
+	size_t GetNumAllocators(gxapi::eCommandListType type) const;
 
 	gxapi::IGraphicsApi* GetGraphicsApi() const;
 
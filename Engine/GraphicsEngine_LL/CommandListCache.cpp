@@ -0,0 +1,98 @@
+#include "CommandListCache.hpp"
+
+#include <algorithm>
+
+
+namespace inl {
+namespace gxeng {
+
+
+CommandListCache::~CommandListCache() {
+	Clear();
+	for (auto& recording : m_retired) {
+		if (recording.completion) {
+			recording.completion.Wait();
+		}
+	}
+}
+
+
+CommandListCache::Recording* CommandListCache::Find(const GraphicsTask* task, const std::vector<uint64_t>& keys) {
+	ReleaseCompleted();
+
+	auto it = m_recordings.find(task);
+	if (it == m_recordings.end()) {
+		return nullptr;
+	}
+	if (it->second.keys != keys) {
+		Retire(std::move(it->second.recording));
+		m_recordings.erase(it);
+		return nullptr;
+	}
+	return &it->second.recording;
+}
+
+
+CommandListCache::Recording& CommandListCache::Store(const GraphicsTask* task, const std::vector<uint64_t>& keys, Recording recording) {
+	ReleaseCompleted();
+
+	Entry& entry = m_recordings[task];
+	if (entry.recording.commandAllocator || entry.recording.commandList) {
+		Retire(std::move(entry.recording));
+	}
+	entry.keys = keys;
+	entry.recording = std::move(recording);
+	return entry.recording;
+}
+
+
+void CommandListCache::Invalidate(const GraphicsTask* task) {
+	auto it = m_recordings.find(task);
+	if (it != m_recordings.end()) {
+		Retire(std::move(it->second.recording));
+		m_recordings.erase(it);
+	}
+}
+
+
+void CommandListCache::InvalidateDescriptorHeaps(const gxapi::IDescriptorHeap* currentHeap) {
+	for (auto it = m_recordings.begin(); it != m_recordings.end();) {
+		const auto& scratchSpaces = it->second.recording.scratchSpaces;
+		bool isOutdated = std::any_of(scratchSpaces.begin(), scratchSpaces.end(), [currentHeap](const ScratchSpacePtr& scratchSpace) {
+			return scratchSpace->GetHeap() != currentHeap;
+		});
+		if (isOutdated) {
+			Retire(std::move(it->second.recording));
+			it = m_recordings.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+
+void CommandListCache::Clear() {
+	for (auto& entry : m_recordings) {
+		Retire(std::move(entry.second.recording));
+	}
+	m_recordings.clear();
+}
+
+
+void CommandListCache::Retire(Recording recording) {
+	m_retired.push_back(std::move(recording));
+}
+
+
+void CommandListCache::ReleaseCompleted() {
+	// recordings may have been submitted to different queues, so they don't complete in order
+	auto firstKept = std::remove_if(m_retired.begin(), m_retired.end(), [](const Recording& recording) {
+		return !recording.completion.m_fence || recording.completion.m_fence->Fetch() >= recording.completion.m_value;
+	});
+	m_retired.erase(firstKept, m_retired.end());
+}
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CommandAllocatorPool.hpp"
+#include "ResourceStateTable.hpp"
+#include "ScratchSpacePool.hpp"
+#include "SyncPoint.hpp"
+#include "VolatileViewHeap.hpp"
+
+#include <GraphicsApi_LL/ICommandList.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+namespace gxeng {
+
+
+class GraphicsTask;
+
+
+/// <summary>
+/// Keeps the closed command lists of tasks whose recordings can be submitted again,
+/// together with everything the command lists reference.
+/// </summary>
+/// <remarks>
+/// A recording is stored under the keys the task reported. It is reused as long as the task reports the same keys.
+/// Recordings that are replaced or dropped are released only after their last submission completed on the GPU.
+/// </remarks>
+class CommandListCache {
+public:
+	struct Recording {
+		/// <summary> Closed, never reset while cached. Null if the task recorded nothing. </summary>
+		std::unique_ptr<gxapi::ICopyCommandList> commandList;
+		CmdAllocPtr commandAllocator;
+		std::vector<ScratchSpacePtr> scratchSpaces;
+		std::unique_ptr<VolatileViewHeap> volatileHeap;
+		/// <summary> Sorted by resource, gives the states the command list expects and leaves behind. </summary>
+		std::vector<ResourceUsage> usedResources;
+		/// <summary> Every resource that must be resident while the command list executes. </summary>
+		std::vector<MemoryObject> residentResources;
+		/// <summary> Reached when the last submission of the command list has completed. </summary>
+		SyncPoint completion;
+	};
+public:
+	CommandListCache() = default;
+	CommandListCache(const CommandListCache&) = delete;
+	CommandListCache& operator=(const CommandListCache&) = delete;
+	~CommandListCache();
+
+	/// <summary> Returns the recording of the task if it was stored under the same keys. </summary>
+	/// <returns> Null if there is no such recording. A recording under different keys is dropped. </returns>
+	Recording* Find(const GraphicsTask* task, const std::vector<uint64_t>& keys);
+
+	/// <summary> Stores the recording of the task, replacing the previous one. </summary>
+	Recording& Store(const GraphicsTask* task, const std::vector<uint64_t>& keys, Recording recording);
+
+	/// <summary> Drops the recording of the task, it will be recorded again the next time. </summary>
+	void Invalidate(const GraphicsTask* task);
+
+	/// <summary> Drops the recordings whose scratch spaces are not in the given heap, such as after the bindless heap was replaced. </summary>
+	void InvalidateDescriptorHeaps(const gxapi::IDescriptorHeap* currentHeap);
+
+	/// <summary> Drops all recordings, such as when the tasks they belong to are destroyed. </summary>
+	void Clear();
+
+	/// <summary> Number of recordings that can be reused. </summary>
+	size_t GetNumRecordings() const { return m_recordings.size(); }
+	/// <summary> Number of dropped recordings that the GPU may still be executing. </summary>
+	size_t GetNumRetired() const { return m_retired.size(); }
+private:
+	struct Entry {
+		std::vector<uint64_t> keys;
+		Recording recording;
+	};
+
+	void Retire(Recording recording);
+	void ReleaseCompleted();
+private:
+	std::unordered_map<const GraphicsTask*, Entry> m_recordings;
+	std::deque<Recording> m_retired;
+};
+
+
+} // namespace gxeng
+} // namespace inl
@@ -198,6 +198,11 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const RWBufferView
 	}
 }
 
+void ComputeCommandList::BindCompute(BindParameter parameter, const BindlessHeap& bindlessHeap) {
+	// the table points into the heap itself, nothing is allocated on the scratch space
+	m_computeBindingManager.Bind(parameter, bindlessHeap);
+}
+
 
 void ComputeCommandList::NewScratchSpace(size_t hint) {
 	BasicCommandList::NewScratchSpace(hint);
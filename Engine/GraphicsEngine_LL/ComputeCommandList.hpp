@@ -49,6 +49,7 @@ public:
 	void BindCompute(BindParameter parameter, const RWTextureView2D& rwResource);
 	void BindCompute(BindParameter parameter, const RWTextureView3D& rwResource);
 	void BindCompute(BindParameter parameter, const RWBufferView& rwResource);
+	void BindCompute(BindParameter parameter, const BindlessHeap& bindlessHeap);
 
 	// UAV barriers
 	void UAVBarrier(const MemoryObject& memoryObject);
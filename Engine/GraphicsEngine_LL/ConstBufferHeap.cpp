@@ -1,5 +1,6 @@
 #include "ConstBufferHeap.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 namespace inl {
@@ -114,6 +115,13 @@ PersistentConstBuffer ConstantBufferHeap::CreatePersistentBuffer(const void* dat
 }
 
 
+void ConstantBufferHeap::BeginFrame(uint64_t frameId) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_currFrameID = frameId + 1;
+}
+
+
 void ConstantBufferHeap::OnFrameBeginDevice(uint64_t frameId)
 {}
 
@@ -125,7 +133,7 @@ void ConstantBufferHeap::OnFrameBeginHost(uint64_t frameId)
 void ConstantBufferHeap::OnFrameCompleteDevice(uint64_t frameId) {
 	std::lock_guard<std::mutex> lock(m_mutex);
 
-	m_lastFinishedFrameID++;
+	m_lastFinishedFrameID = std::max(m_lastFinishedFrameID, frameId + 1);
 
 	bool foundVictim = true;
 	while (m_largePages.Count() > MAX_PERMANENT_LARGE_PAGE_COUNT && foundVictim) {
@@ -144,9 +152,8 @@ void ConstantBufferHeap::OnFrameCompleteDevice(uint64_t frameId) {
 }
 
 
-void ConstantBufferHeap::OnFrameCompleteHost(uint64_t frameId) {
-	m_currFrameID++;
-}
+void ConstantBufferHeap::OnFrameCompleteHost(uint64_t frameId)
+{}
 
 
 size_t ConstantBufferHeap::SnapUpward(size_t value, size_t gridSize) {
@@ -48,6 +48,12 @@ public:
 	VolatileConstBuffer CreateVolatileBuffer(const void* data, uint32_t dataSize);
 	PersistentConstBuffer CreatePersistentBuffer(const void* data, uint32_t dataSize);
 
+	/// <summary>
+	/// Volatile buffers created from now on belong to the given frame,
+	/// their pages are reused once the device has completed that frame.
+	/// </summary>
+	void BeginFrame(uint64_t frameId);
+
 	void OnFrameBeginDevice(uint64_t frameId) override;
 	void OnFrameBeginHost(uint64_t frameId) override;
 	void OnFrameBeginAwait(uint64_t frameId) override {};
@@ -61,6 +67,7 @@ protected:
 	exc::RingBuffer<ConstBufferPage> m_pages;
 	std::mutex m_mutex;
 
+	// frame IDs are offset by one, so that zero means no frame has finished yet
 	uint64_t m_currFrameID = 1;
 	uint64_t m_lastFinishedFrameID = 0;
 
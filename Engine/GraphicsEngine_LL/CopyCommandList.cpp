@@ -49,40 +49,10 @@ void CopyCommandList::SetResourceState(const MemoryObject& resource, gxapi::eRes
 		throw std::invalid_argument("You must not set resource state of upload staging buffers and VOLATILE constant buffers. They are GENERIC_READ.");
 	}
 
-	// Call recursively when ALL subresources are requested.
-	if (subresource == gxapi::ALL_SUBRESOURCES) {
-		for (unsigned s = 0; s < resource._GetResourcePtr()->GetNumSubresources(); ++s) {
-			SetResourceState(resource, state, s);
-		}
-	}
-	// Do a single subresource
-	else {
-		SubresourceId resId{ resource, subresource };
-		auto iter = m_resourceTransitions.find(resId);
-		bool firstTransition = iter == m_resourceTransitions.end();
-		if (firstTransition) {
-			SubresourceUsageInfo info;
-			info.lastState = state;
-			info.firstState = state;
-			info.multipleStates = false;
-			m_resourceTransitions.insert({ std::move(resId), info });
-		}
-		else {
-			const auto& prevState = iter->second.lastState;
-
-			if (prevState != state) {
-				m_commandList->ResourceBarrier(
-					gxapi::TransitionBarrier{
-					resource._GetResourcePtr(),
-					prevState,
-					state,
-					subresource
-				}
-				);
-				iter->second.lastState = state;
-				iter->second.multipleStates = true;
-			}
-		}
+	m_barrierBuffer.clear();
+	m_resourceTransitions.SetState(resource, state, subresource, m_barrierBuffer);
+	if (!m_barrierBuffer.empty()) {
+		m_commandList->ResourceBarrier((unsigned)m_barrierBuffer.size(), m_barrierBuffer.data());
 	}
 }
 
@@ -98,24 +68,22 @@ void CopyCommandList::ExpectResourceState(const MemoryObject& resource, const st
 	}
 
 
-	if (subresource == gxapi::ALL_SUBRESOURCES) {
-		for (int s = 0; s < resource._GetResourcePtr()->GetNumSubresources(); ++s) {
+	const SubresourceUsageInfo* usage = m_resourceTransitions.Find(resource, subresource);
+	if (usage == nullptr && subresource == gxapi::ALL_SUBRESOURCES) {
+		// subresources are tracked individually, all of them must be good
+		for (unsigned s = 0; s < resource.GetNumSubresources(); ++s) {
 			ExpectResourceState(resource, anyOfStates, s);
 		}
 	}
 	else {
-		SubresourceId resId{ resource, subresource };
-
-		auto iter = m_resourceTransitions.find(resId);
-
-		if (iter == m_resourceTransitions.end()) {
+		if (usage == nullptr) {
 			if (IsDebuggerPresent()) {
 				DebugBreak();
 			}
 			throw std::logic_error("You did not set resource state before using this resource!");
 		}
 		else {
-			gxapi::eResourceState currentState = iter->second.lastState;
+			gxapi::eResourceState currentState = usage->lastState;
 			bool ok = false;
 			for (auto it = anyOfStates.begin(); it != anyOfStates.end(); ++it) {
 				ok = ok || ((currentState & *it) == *it);
@@ -0,0 +1,141 @@
+#include "FoliageCulling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace inl::gxeng {
+
+
+using Vec3 = mathfu::Vector<float, 3>;
+using Vec4 = mathfu::Vector<float, 4>;
+
+
+static float SquaredDistanceToBox(const Vec3& point, const Vec3& minimum, const Vec3& maximum) {
+	Vec3 closest = Vec3::Max(minimum, Vec3::Min(point, maximum));
+	return (closest - point).LengthSquared();
+}
+
+
+static float SquaredDistanceToFarCorner(const Vec3& point, const Vec3& minimum, const Vec3& maximum) {
+	Vec3 farthest;
+	for (int i = 0; i < 3; ++i) {
+		farthest[i] = std::abs(point[i] - minimum[i]) > std::abs(point[i] - maximum[i]) ? minimum[i] : maximum[i];
+	}
+	return (farthest - point).LengthSquared();
+}
+
+
+static bool IntersectsFrustum(const FoliageFrustum& frustum, const Vec3& minimum, const Vec3& maximum) {
+	for (const Vec4& plane : frustum) {
+		// the corner farthest along the plane's normal decides
+		Vec3 corner(plane.x() >= 0.0f ? maximum.x() : minimum.x(),
+					plane.y() >= 0.0f ? maximum.y() : minimum.y(),
+					plane.z() >= 0.0f ? maximum.z() : minimum.z());
+		if (Vec3::DotProduct(plane.xyz(), corner) + plane.w() < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+FoliageFrustum ExtractFoliageFrustum(const mathfu::Matrix<float, 4, 4>& viewProjection) {
+	auto Row = [&viewProjection](int row) {
+		return Vec4(viewProjection(row, 0), viewProjection(row, 1), viewProjection(row, 2), viewProjection(row, 3));
+	};
+
+	FoliageFrustum frustum = {
+		Row(3) + Row(0),
+		Row(3) - Row(0),
+		Row(3) + Row(1),
+		Row(3) - Row(1),
+		Row(3) + Row(2),
+		Row(3) - Row(2),
+	};
+	for (Vec4& plane : frustum) {
+		plane /= plane.xyz().Length();
+	}
+	return frustum;
+}
+
+
+void GetFoliageChunkBounds(const FoliageChunk& chunk, const Vec3& meshMinimum, const Vec3& meshMaximum, Vec3& minimum, Vec3& maximum) {
+	// instances only rotate around Z, so a circle covers the mesh horizontally in any orientation
+	float horizontalRadius = 0.0f;
+	for (float x : { meshMinimum.x(), meshMaximum.x() }) {
+		for (float y : { meshMinimum.y(), meshMaximum.y() }) {
+			horizontalRadius = std::max(horizontalRadius, std::sqrt(x * x + y * y));
+		}
+	}
+	float below = std::min(meshMinimum.z(), 0.0f);
+	float above = std::max(meshMaximum.z(), 0.0f);
+
+	float extent = horizontalRadius * chunk.maxScale;
+	minimum = Vec3(chunk.minimum.x() - extent, chunk.minimum.y() - extent, chunk.minimum.z() + below * chunk.maxScale);
+	maximum = Vec3(chunk.maximum.x() + extent, chunk.maximum.y() + extent, chunk.maximum.z() + above * chunk.maxScale);
+}
+
+
+void CullFoliage(const FoliageEntity& entity,
+				 const Vec3& meshMinimum,
+				 const Vec3& meshMaximum,
+				 const FoliageFrustum& frustum,
+				 const Vec3& cameraPosition,
+				 FoliageDrawList& drawList)
+{
+	drawList.Clear();
+
+	const bool hasImpostor = entity.GetImpostor() != nullptr;
+	const float drawDistanceSq = entity.GetDrawDistance() * entity.GetDrawDistance();
+	const float impostorDistanceSq = entity.GetImpostorDistance() * entity.GetImpostorDistance();
+
+	for (const FoliageChunk& chunk : entity.GetChunks()) {
+		Vec3 minimum, maximum;
+		GetFoliageChunkBounds(chunk, meshMinimum, meshMaximum, minimum, maximum);
+		if (!IntersectsFrustum(frustum, minimum, maximum)) {
+			continue;
+		}
+
+		// levels of detail are chosen by the distance of the instances' origins
+		float nearestSq = SquaredDistanceToBox(cameraPosition, chunk.minimum, chunk.maximum);
+		float farthestSq = SquaredDistanceToFarCorner(cameraPosition, chunk.minimum, chunk.maximum);
+		if (nearestSq > drawDistanceSq || (!hasImpostor && nearestSq > impostorDistanceSq)) {
+			continue;
+		}
+		++drawList.numVisibleChunks;
+
+		if (farthestSq <= drawDistanceSq && farthestSq <= impostorDistanceSq) {
+			drawList.meshInstances.insert(drawList.meshInstances.end(), chunk.instances.begin(), chunk.instances.end());
+		}
+		else if (farthestSq <= drawDistanceSq && nearestSq > impostorDistanceSq) {
+			drawList.impostorInstances.insert(drawList.impostorInstances.end(), chunk.instances.begin(), chunk.instances.end());
+		}
+		else {
+			for (const FoliageInstance& instance : chunk.instances) {
+				float distanceSq = (Vec3(instance.position) - cameraPosition).LengthSquared();
+				if (distanceSq > drawDistanceSq) {
+					continue;
+				}
+				if (distanceSq <= impostorDistanceSq) {
+					drawList.meshInstances.push_back(instance);
+				}
+				else if (hasImpostor) {
+					drawList.impostorInstances.push_back(instance);
+				}
+			}
+		}
+	}
+}
+
+
+unsigned SelectImpostorView(const FoliageInstance& instance, const Vec3& toCamera, unsigned numViews) {
+	const float twoPi = 6.28318531f;
+	float angle = std::atan2(toCamera.y(), toCamera.x()) - instance.rotation;
+	angle -= twoPi * std::floor(angle / twoPi);
+	unsigned view = (unsigned)std::floor(angle / twoPi * numViews + 0.5f);
+	return view % numViews;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "FoliageEntity.hpp"
+
+#include <mathfu/vector.h>
+#include <mathfu/matrix.h>
+
+#include <array>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Visible instances of a foliage entity, split by level of detail, ready for upload as instance data. </summary>
+struct FoliageDrawList {
+	std::vector<FoliageInstance> meshInstances;
+	std::vector<FoliageInstance> impostorInstances;
+	unsigned numVisibleChunks = 0;
+
+	void Clear() {
+		meshInstances.clear();
+		impostorInstances.clear();
+		numVisibleChunks = 0;
+	}
+};
+
+
+/// <summary> Half spaces of a view frustum, a point p is inside if dot(plane.xyz, p) + plane.w >= 0 for all planes. </summary>
+using FoliageFrustum = std::array<mathfu::Vector<float, 4>, 6>;
+
+
+/// <summary> Extracts the frustum planes from a projection * view matrix. </summary>
+/// <remarks> The near plane is taken for a [-1, 1] depth range, which only loosens it for [0, 1] projections. </remarks>
+FoliageFrustum ExtractFoliageFrustum(const mathfu::Matrix<float, 4, 4>& viewProjection);
+
+
+/// <summary> World space bounds of the instances of a chunk, including the extent of the mesh in any rotation around the up axis. </summary>
+/// <param name="meshMinimum"> Local space bounds of the mesh, before rotation and scaling. </param>
+/// <param name="meshMaximum"> Local space bounds of the mesh, before rotation and scaling. </param>
+void GetFoliageChunkBounds(const FoliageChunk& chunk,
+						   const mathfu::Vector<float, 3>& meshMinimum,
+						   const mathfu::Vector<float, 3>& meshMaximum,
+						   mathfu::Vector<float, 3>& minimum,
+						   mathfu::Vector<float, 3>& maximum);
+
+
+/// <summary> Culls the entity's instances chunk by chunk and selects mesh or impostor for each visible one. </summary>
+/// <param name="meshMinimum"> Local space bounds of the mesh, before rotation and scaling. </param>
+/// <param name="meshMaximum"> Local space bounds of the mesh, before rotation and scaling. </param>
+/// <param name="drawList"> Cleared and filled with the visible instances. </param>
+/// <remarks>
+/// Chunks outside the frustum or the draw distance are skipped as a whole. Chunks entirely within or beyond
+/// the impostor distance are copied to one of the lists as a whole, only chunks that straddle a distance
+/// threshold are split per instance. Instances are not culled against the frustum individually.
+/// Without an impostor atlas, instances beyond the impostor distance are not drawn.
+/// </remarks>
+void CullFoliage(const FoliageEntity& entity,
+				 const mathfu::Vector<float, 3>& meshMinimum,
+				 const mathfu::Vector<float, 3>& meshMaximum,
+				 const FoliageFrustum& frustum,
+				 const mathfu::Vector<float, 3>& cameraPosition,
+				 FoliageDrawList& drawList);
+
+
+/// <summary> Selects the view of the impostor atlas that faces the camera best. The shaders do the same. </summary>
+/// <param name="toCamera"> Direction from the instance towards the camera. </param>
+unsigned SelectImpostorView(const FoliageInstance& instance, const mathfu::Vector<float, 3>& toCamera, unsigned numViews);
+
+
+} // namespace inl::gxeng
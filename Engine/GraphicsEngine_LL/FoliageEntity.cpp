@@ -0,0 +1,130 @@
+#include "FoliageEntity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+FoliageEntity::FoliageEntity(float chunkSize)
+	: m_chunkSize(chunkSize)
+{
+	if (!(chunkSize > 0.0f)) {
+		throw std::invalid_argument("Foliage chunk size must be positive.");
+	}
+}
+
+
+void FoliageEntity::SetMesh(Mesh* mesh) {
+	m_mesh = mesh;
+}
+Mesh* FoliageEntity::GetMesh() const {
+	return m_mesh;
+}
+
+void FoliageEntity::SetTexture(Image* texture) {
+	m_texture = texture;
+}
+Image* FoliageEntity::GetTexture() const {
+	return m_texture;
+}
+
+void FoliageEntity::SetAlphaCutoff(float cutoff) {
+	m_alphaCutoff = cutoff;
+}
+float FoliageEntity::GetAlphaCutoff() const {
+	return m_alphaCutoff;
+}
+
+
+void FoliageEntity::SetImpostor(Image* atlas, unsigned numViews) {
+	if (atlas != nullptr && numViews == 0) {
+		throw std::invalid_argument("Impostor atlas must have at least one view.");
+	}
+	m_impostor = atlas;
+	m_numImpostorViews = atlas != nullptr ? numViews : 0;
+}
+Image* FoliageEntity::GetImpostor() const {
+	return m_impostor;
+}
+unsigned FoliageEntity::GetNumImpostorViews() const {
+	return m_numImpostorViews;
+}
+
+
+void FoliageEntity::SetImpostorDistance(float distance) {
+	m_impostorDistance = distance;
+}
+float FoliageEntity::GetImpostorDistance() const {
+	return m_impostorDistance;
+}
+
+void FoliageEntity::SetDrawDistance(float distance) {
+	m_drawDistance = distance;
+}
+float FoliageEntity::GetDrawDistance() const {
+	return m_drawDistance;
+}
+
+
+void FoliageEntity::AddInstance(const FoliageInstance& instance) {
+	AddInstances(&instance, 1);
+}
+
+
+void FoliageEntity::AddInstances(const FoliageInstance* instances, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		const FoliageInstance& instance = instances[i];
+		mathfu::Vector<float, 3> position(instance.position);
+
+		int32_t cellX = (int32_t)std::floor(position.x() / m_chunkSize);
+		int32_t cellY = (int32_t)std::floor(position.y() / m_chunkSize);
+		uint64_t key = (uint64_t(uint32_t(cellX)) << 32) | uint32_t(cellY);
+
+		auto [it, isNew] = m_chunkIndices.insert({ key, m_chunks.size() });
+		if (isNew) {
+			FoliageChunk chunk;
+			chunk.minimum = position;
+			chunk.maximum = position;
+			m_chunks.push_back(std::move(chunk));
+		}
+
+		FoliageChunk& chunk = m_chunks[it->second];
+		chunk.minimum = mathfu::Vector<float, 3>::Min(chunk.minimum, position);
+		chunk.maximum = mathfu::Vector<float, 3>::Max(chunk.maximum, position);
+		chunk.maxScale = std::max(chunk.maxScale, instance.scale);
+		chunk.instances.push_back(instance);
+	}
+	m_numInstances += count;
+	++m_version;
+}
+
+
+void FoliageEntity::ClearInstances() {
+	m_chunks.clear();
+	m_chunkIndices.clear();
+	m_numInstances = 0;
+	++m_version;
+}
+
+
+size_t FoliageEntity::GetNumInstances() const {
+	return m_numInstances;
+}
+
+float FoliageEntity::GetChunkSize() const {
+	return m_chunkSize;
+}
+
+const std::vector<FoliageChunk>& FoliageEntity::GetChunks() const {
+	return m_chunks;
+}
+
+uint64_t FoliageEntity::GetVersion() const {
+	return m_version;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <mathfu/vector.h>
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+class Mesh;
+class Image;
+
+
+/// <summary>
+/// Placement of a single foliage instance.
+/// The layout is uploaded to the GPU as is, as per instance vertex data.
+/// </summary>
+struct FoliageInstance {
+	FoliageInstance() = default;
+	FoliageInstance(const mathfu::Vector<float, 3>& position, float rotation = 0.0f, float scale = 1.0f)
+		: position(position), rotation(rotation), scale(scale) {}
+
+	mathfu::VectorPacked<float, 3> position;
+	/// <summary> Radians around the up (Z) axis. </summary>
+	float rotation;
+	/// <summary> Uniform scale, must be positive. </summary>
+	float scale;
+};
+
+
+/// <summary> Instances that fall into the same square cell of the ground plane. </summary>
+struct FoliageChunk {
+	/// <summary> Bounds of the instances' positions, not including the extent of the mesh. </summary>
+	mathfu::Vector<float, 3> minimum;
+	mathfu::Vector<float, 3> maximum;
+	float maxScale = 0.0f;
+	std::vector<FoliageInstance> instances;
+};
+
+
+/// <summary>
+/// Many instances of the same mesh, such as trees of a forest or grass, drawn with instancing.
+/// <para />
+/// Instances are grouped into chunks on the XY plane so they can be culled together.
+/// Up close the mesh is drawn, beyond the impostor distance a camera facing billboard is drawn instead,
+/// textured from an atlas of the mesh baked from several directions around the up axis.
+/// </summary>
+class FoliageEntity {
+public:
+	/// <param name="chunkSize"> Edge length of the square cells instances are grouped by. </param>
+	/// <exception cref="std::invalid_argument"> If the chunk size is not positive. </exception>
+	FoliageEntity(float chunkSize = 32.0f);
+
+	void SetMesh(Mesh* mesh);
+	Mesh* GetMesh() const;
+	/// <summary> Albedo of the mesh, alpha below the cutoff is cut out. </summary>
+	void SetTexture(Image* texture);
+	Image* GetTexture() const;
+	/// <summary> Pixels of the texture and the atlas with lower alpha are discarded. Zero disables cutting out. </summary>
+	void SetAlphaCutoff(float cutoff);
+	float GetAlphaCutoff() const;
+
+	/// <summary> Sets the baked impostor atlas. </summary>
+	/// <param name="atlas"> Views of the mesh side by side in a single row, alpha below the cutoff is cut out.
+	///		View i looks at the mesh from the direction rotated by 2*pi*i/numViews around the up axis from +X. </param>
+	void SetImpostor(Image* atlas, unsigned numViews);
+	Image* GetImpostor() const;
+	unsigned GetNumImpostorViews() const;
+
+	/// <summary> Instances farther from the camera than this are drawn as impostors. Impostors are not drawn without an atlas. </summary>
+	void SetImpostorDistance(float distance);
+	float GetImpostorDistance() const;
+	/// <summary> Instances farther from the camera than this are not drawn. </summary>
+	void SetDrawDistance(float distance);
+	float GetDrawDistance() const;
+
+	void AddInstance(const FoliageInstance& instance);
+	void AddInstances(const FoliageInstance* instances, size_t count);
+	void ClearInstances();
+
+	size_t GetNumInstances() const;
+	float GetChunkSize() const;
+	const std::vector<FoliageChunk>& GetChunks() const;
+	/// <summary> Incremented each time instances are added or removed. </summary>
+	uint64_t GetVersion() const;
+
+private:
+	Mesh* m_mesh = nullptr;
+	Image* m_texture = nullptr;
+	float m_alphaCutoff = 0.5f;
+	Image* m_impostor = nullptr;
+	unsigned m_numImpostorViews = 0;
+	float m_impostorDistance = 100.0f;
+	float m_drawDistance = std::numeric_limits<float>::infinity();
+
+	float m_chunkSize;
+	std::vector<FoliageChunk> m_chunks;
+	std::unordered_map<uint64_t, size_t> m_chunkIndices; // cell coordinates -> index in m_chunks
+	size_t m_numInstances = 0;
+	uint64_t m_version = 0;
+};
+
+
+} // namespace inl::gxeng
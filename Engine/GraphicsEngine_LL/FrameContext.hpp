@@ -19,9 +19,11 @@ namespace gxeng {
 
 class CommandAllocatorPool;
 class ScratchSpacePool;
+class BindlessHeap;
 class Scene;
 class PerspectiveCamera;
 class RenderTargetView2D;
+class PipelineProfiler;
 
 struct FrameContext {
 	std::chrono::nanoseconds frameTime;
@@ -31,6 +33,7 @@ struct FrameContext {
 	gxapi::IGraphicsApi* gxApi = nullptr;
 	CommandAllocatorPool* commandAllocatorPool = nullptr;
 	ScratchSpacePool* scratchSpacePool = nullptr;
+	BindlessHeap* bindlessHeap = nullptr;
 	MemoryManager* memoryManager = nullptr;
 	CbvSrvUavHeap* textureSpace = nullptr;
 	RTVHeap* rtvHeap = nullptr;
@@ -44,6 +47,7 @@ struct FrameContext {
 	const std::vector<UploadManager::UploadDescription>* uploadRequests = nullptr;
 	
 	ResourceResidencyQueue* residencyQueue = nullptr;
+	PipelineProfiler* profiler = nullptr;
 
 	uint64_t frame;
 };
@@ -309,6 +309,11 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWBufferVi
 	}
 }
 
+void GraphicsCommandList::BindGraphics(BindParameter parameter, const BindlessHeap& bindlessHeap) {
+	// the table points into the heap itself, nothing is allocated on the scratch space
+	m_graphicsBindingManager.Bind(parameter, bindlessHeap);
+}
+
 
 } // namespace gxeng
 } // namespace inl
\ No newline at end of file
@@ -90,6 +90,7 @@ public:
 	void BindGraphics(BindParameter parameter, const RWTextureView2D& rwResource);
 	void BindGraphics(BindParameter parameter, const RWTextureView3D& rwResource);
 	void BindGraphics(BindParameter parameter, const RWBufferView& rwResource);
+	void BindGraphics(BindParameter parameter, const BindlessHeap& bindlessHeap);
 protected:
 	virtual Decomposition Decompose() override;
 	virtual void NewScratchSpace(size_t hint) override;
@@ -3,6 +3,9 @@
 
 #include "../BaseLibrary/Graph/Node.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <iostream> // only for debugging
 #include <regex> // as well...
 #include <lemon/bfs.h> // as well...
@@ -20,10 +23,10 @@
 //forward
 #include "Nodes/Node_ForwardRender.hpp"
 #include "Nodes/Node_DepthPrepass.hpp"
-#include "Nodes/Node_DepthReduction.hpp"
-#include "Nodes/Node_DepthReductionFinal.hpp"
 #include "Nodes/Node_CSM.hpp"
 #include "Nodes/Node_DrawSky.hpp"
+#include "Nodes/Node_DrawTerrain.hpp"
+#include "Nodes/Node_DrawFoliage.hpp"
 #include "Nodes/Node_DebugDraw.hpp"
 #include "Nodes/Node_LightCulling.hpp"
 
@@ -41,6 +44,8 @@
 #include "Image.hpp"
 #include "MeshEntity.hpp"
 #include "OverlayEntity.hpp"
+#include "FoliageEntity.hpp"
+#include "TerrainEntity.hpp"
 
 
 namespace inl {
@@ -54,7 +59,8 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	: m_gxapiManager(desc.gxapiManager),
 	m_graphicsApi(desc.graphicsApi),
 	m_commandAllocatorPool(desc.graphicsApi),
-	m_scratchSpacePool(desc.graphicsApi, gxapi::eDescriptorHeapType::CBV_SRV_UAV),
+	m_bindlessHeap(desc.bindlessDescriptors ? std::make_unique<BindlessHeap>(desc.graphicsApi) : nullptr),
+	m_scratchSpacePool(desc.graphicsApi, gxapi::eDescriptorHeapType::CBV_SRV_UAV, m_bindlessHeap.get()),
 	m_textureSpace(desc.graphicsApi),
 	m_masterCommandQueue(desc.graphicsApi->CreateCommandQueue(CommandQueueDesc{ eCommandListType::GRAPHICS }), desc.graphicsApi->CreateFence(0)),
 	m_residencyQueue(std::unique_ptr<gxapi::IFence>(desc.graphicsApi->CreateFence(0))),
@@ -63,21 +69,27 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	m_rtvHeap(desc.graphicsApi),
 	m_persResViewHeap(desc.graphicsApi),
 	m_logger(desc.logger),
-	m_shaderManager(desc.gxapiManager)
+	m_shaderManager(desc.gxapiManager),
+	m_framesInFlight(desc.framesInFlight)
 {
+	if (m_framesInFlight < 1 || m_framesInFlight > 3) {
+		throw std::invalid_argument("Frames in flight must be between 1 and 3.");
+	}
+
 	// Create swapchain
 	SwapChainDesc swapChainDesc;
 	swapChainDesc.format = eFormat::R8G8B8A8_UNORM;
 	swapChainDesc.width = desc.width;
 	swapChainDesc.height = desc.height;
-	swapChainDesc.numBuffers = 2;
+	// a back buffer is only reused after as many frames as there are slots, so waiting for the slot covers it
+	swapChainDesc.numBuffers = std::max(2, m_framesInFlight);
 	swapChainDesc.targetWindow = desc.targetWindow;
 	swapChainDesc.isFullScreen = desc.fullScreen;
 	swapChainDesc.multisampleCount = 1;
 	swapChainDesc.multiSampleQuality = 0;
 	m_swapChain.reset(m_gxapiManager->CreateSwapChain(swapChainDesc, m_masterCommandQueue.GetUnderlyingQueue()));
 
-	m_frameEndFenceValues.resize(m_swapChain->GetDesc().numBuffers, { nullptr, 0 });
+	m_frameSlotFences.resize(m_framesInFlight, { nullptr, 0 });
 
 	// Init backbuffer heap
 	m_backBufferHeap = std::make_unique<BackBufferManager>(m_graphicsApi, m_swapChain.get());
@@ -108,7 +120,23 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	m_absoluteTime = decltype(m_absoluteTime)(0);
 	m_commandAllocatorPool.SetLogStream(&m_logStreamPipeline);
 
+	if (desc.residencyBudget > 0) {
+		m_memoryManager.GetResidencyManager().SetBudget(desc.residencyBudget);
+	}
+	m_residencyQueue.SetMemoryManager(&m_memoryManager);
+
+	if (desc.profiledFrames > 0) {
+		// GPU timing stays off if the queue has no timestamps
+		m_profiler = std::make_unique<PipelineProfiler>(desc.profiledFrames);
+		m_profiler->EnableGpuTiming(m_graphicsApi, m_masterCommandQueue.GetUnderlyingQueue()->GetTimestampFrequency());
+	}
+
+	m_pipelineEventDispatcher.SetLog(&m_logStreamPipeline);
 	m_pipelineEventDispatcher += &m_memoryManager.GetUploadManager();
+	m_pipelineEventDispatcher += &m_memoryManager.GetConstBufferHeap();
+	if (m_bindlessHeap) {
+		m_pipelineEventDispatcher += m_bindlessHeap.get();
+	}
 	// DELETE THIS
 	m_pipelineEventPrinter.SetLog(&m_logStreamPipeline);
 	m_pipelineEventDispatcher += &m_pipelineEventPrinter;
@@ -122,6 +150,10 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 GraphicsEngine::~GraphicsEngine() {
 	SyncPoint lastSync = m_masterCommandQueue.Signal();
 	lastSync.Wait();
+
+	// the printer and the log are destroyed before the dispatcher, so nothing may be left for them
+	m_pipelineEventDispatcher.Flush();
+	m_pipelineEventDispatcher.SetLog(nullptr);
 }
 
 
@@ -129,11 +161,13 @@ void GraphicsEngine::Update(float elapsed) {
 	std::chrono::nanoseconds frameTime(long long(elapsed * 1e9));
 	m_absoluteTime += frameTime;
 
-	// Wait for previous frame on this BB to complete
-	int backBufferIndex = m_swapChain->GetCurrentBufferIndex();
-	if (m_frameEndFenceValues[backBufferIndex]) {
-		m_frameEndFenceValues[backBufferIndex].Wait();
+	// Wait only if the oldest frame in flight still occupies this slot
+	// Command allocators, scratch spaces and volatile heaps are released by the residency queue on their own fences
+	SyncPoint& frameSlot = m_frameSlotFences[m_frame % m_framesInFlight];
+	if (frameSlot) {
+		frameSlot.Wait();
 	}
+	int backBufferIndex = m_swapChain->GetCurrentBufferIndex();
 
 	// Set up context
 	FrameContext context;
@@ -145,6 +179,7 @@ void GraphicsEngine::Update(float elapsed) {
 	context.gxApi = m_graphicsApi;
 	context.commandAllocatorPool = &m_commandAllocatorPool;
 	context.scratchSpacePool = &m_scratchSpacePool;
+	context.bindlessHeap = m_bindlessHeap.get();
 	context.memoryManager = &m_memoryManager;
 	context.textureSpace = &m_textureSpace;
 	context.rtvHeap = &m_rtvHeap;
@@ -160,18 +195,33 @@ void GraphicsEngine::Update(float elapsed) {
 	context.uploadRequests = &uploadRequests;
 
 	context.residencyQueue = &m_residencyQueue;
+	context.profiler = m_profiler.get();
 
 	// Update special nodes for current frame
 	UpdateSpecialNodes();
 
 	// Execute the pipeline
-	m_pipelineEventDispatcher.DispatchFrameBegin(m_frame).wait();
+	// Listeners that the frame depends on are advanced directly, so the host events need not be awaited
+	m_pipelineEventDispatcher.DispatchFrameBegin(m_frame);
+	if (m_bindlessHeap) {
+		m_bindlessHeap->BeginFrame(m_frame);
+	}
+	if (m_profiler) {
+		m_profiler->BeginFrame(m_frame);
+	}
 	m_scheduler.Execute(context);
-	m_pipelineEventDispatcher.DispatchFrameEnd(m_frame).wait();
+	m_pipelineEventDispatcher.DispatchFrameEnd(m_frame);
+
+	// Uploads and constant buffers from here on go to the next frame,
+	// switched before this frame's completion can release the current upload queue
+	m_memoryManager.BeginFrame(m_frame + 1);
 
 	// Mark frame completion
 	SyncPoint frameEnd = m_masterCommandQueue.Signal();
-	m_frameEndFenceValues[backBufferIndex] = frameEnd;
+	frameSlot = frameEnd;
+	if (m_profiler) {
+		m_profiler->EndFrame(frameEnd);
+	}
 	m_pipelineEventDispatcher.DispatchDeviceFrameEnd(frameEnd, m_frame);
 
 	// Flush log
@@ -182,7 +232,7 @@ void GraphicsEngine::Update(float elapsed) {
 	++m_frame;
 
 	// Await next frame
-	m_pipelineEventDispatcher.DispachFrameBeginAwait(m_frame).wait(); // m_frame incremented on previous line
+	m_pipelineEventDispatcher.DispachFrameBeginAwait(m_frame); // m_frame incremented on previous line
 }
 
 
@@ -220,7 +270,7 @@ Mesh* GraphicsEngine::CreateMesh() {
 }
 
 Image* GraphicsEngine::CreateImage() {
-	return new Image(&m_memoryManager, &m_textureSpace);
+	return new Image(&m_memoryManager, &m_textureSpace, m_bindlessHeap.get());
 }
 
 Material* GraphicsEngine::CreateMaterial() {
@@ -326,6 +376,14 @@ OverlayEntity* GraphicsEngine::CreateOverlayEntity() {
 	return new OverlayEntity;
 }
 
+FoliageEntity* GraphicsEngine::CreateFoliageEntity() {
+	return new FoliageEntity;
+}
+
+TerrainEntity* GraphicsEngine::CreateTerrainEntity() {
+	return new TerrainEntity;
+}
+
 
 bool GraphicsEngine::SetEnvVariable(std::string name, exc::Any obj) {
 	auto res = m_envVariables.insert_or_assign(std::move(name), std::move(obj));
@@ -385,10 +443,10 @@ void GraphicsEngine::CreatePipeline() {
 	std::shared_ptr<nodes::CreateTexture> createCsmTextures(new nodes::CreateTexture());
 	std::shared_ptr<nodes::ForwardRender> forwardRender(new nodes::ForwardRender());
 	std::shared_ptr<nodes::DepthPrepass> depthPrePass(new nodes::DepthPrepass());
-	std::shared_ptr<nodes::DepthReduction> depthReduction(new nodes::DepthReduction());
-	std::shared_ptr<nodes::DepthReductionFinal> depthReductionFinal(new nodes::DepthReductionFinal());
 	std::shared_ptr<nodes::CSM> csm(new nodes::CSM());
 	std::shared_ptr<nodes::DrawSky> drawSky(new nodes::DrawSky());
+	std::shared_ptr<nodes::DrawTerrain> drawTerrain(new nodes::DrawTerrain());
+	std::shared_ptr<nodes::DrawFoliage> drawFoliage(new nodes::DrawFoliage());
 	std::shared_ptr<nodes::DebugDraw> debugDraw(new nodes::DebugDraw());
 	std::shared_ptr<nodes::LightCulling> lightCulling(new nodes::LightCulling());
 	TextureUsage usage;
@@ -408,12 +466,6 @@ void GraphicsEngine::CreatePipeline() {
 	depthPrePass->GetInput(1)->Link(getWorldScene->GetOutput(0));
 	depthPrePass->GetInput(2)->Link(getCamera->GetOutput(0));
 
-	depthReduction->GetInput<0>().Link(depthPrePass->GetOutput(0));
-
-	depthReductionFinal->GetInput<0>().Link(depthReduction->GetOutput(0));
-	depthReductionFinal->GetInput<1>().Link(getCamera->GetOutput(0));
-	depthReductionFinal->GetInput<2>().Link(getWorldScene->GetOutput(2));
-
 	constexpr unsigned cascadeSize = 1024;
 	constexpr unsigned numCascades = 4;
 
@@ -427,10 +479,13 @@ void GraphicsEngine::CreatePipeline() {
 
 	csm->GetInput<0>().Link(createCsmTextures->GetOutput(0));
 	csm->GetInput<1>().Link(getWorldScene->GetOutput(0));
-	csm->GetInput<2>().Link(depthReductionFinal->GetOutput(0));
+	csm->GetInput<2>().Link(getCamera->GetOutput(0));
+	csm->GetInput<3>().Link(getWorldScene->GetOutput(2));
+	csm->GetInput<4>().Link(getWorldScene->GetOutput(5));
 
-	lightCulling->GetInput<0>().Link(depthPrePass->GetOutput(0));
-	lightCulling->GetInput<1>().Link(getCamera->GetOutput(0));
+	lightCulling->GetInput<0>().Link(getCamera->GetOutput(0));
+	lightCulling->GetInput<1>().Link(getWorldScene->GetOutput(3));
+	lightCulling->GetInput<2>().Link(getWorldScene->GetOutput(4));
 
 	createHdrRenderTarget->GetInput<0>().Link(backBufferProperties->GetOutput(0));
 	createHdrRenderTarget->GetInput<1>().Link(backBufferProperties->GetOutput(1));
@@ -446,18 +501,32 @@ void GraphicsEngine::CreatePipeline() {
 	forwardRender->GetInput(3)->Link(getCamera->GetOutput(0));
 	forwardRender->GetInput(4)->Link(getWorldScene->GetOutput(2));
 	forwardRender->GetInput(5)->Link(csm->GetOutput(0));
-	forwardRender->GetInput(6)->Link(depthReductionFinal->GetOutput(1));
-	forwardRender->GetInput(7)->Link(depthReductionFinal->GetOutput(2));
-	forwardRender->GetInput(8)->Link(depthReductionFinal->GetOutput(0));
+	forwardRender->GetInput(6)->Link(csm->GetOutput(2));
+	forwardRender->GetInput(7)->Link(csm->GetOutput(3));
+	forwardRender->GetInput(8)->Link(csm->GetOutput(1));
 	forwardRender->GetInput(9)->Link(lightCulling->GetOutput(0));
+	forwardRender->GetInput(10)->Link(lightCulling->GetOutput(1));
+	forwardRender->GetInput(11)->Link(lightCulling->GetOutput(2));
 
 	drawSky->GetInput<0>().Link(forwardRender->GetOutput(0));
 	drawSky->GetInput<1>().Link(depthPrePass->GetOutput(0));
 	drawSky->GetInput<2>().Link(getCamera->GetOutput(0));
 	drawSky->GetInput<3>().Link(getWorldScene->GetOutput(2));
 
+	drawTerrain->GetInput<0>().Link(drawSky->GetOutput(0));
+	drawTerrain->GetInput<1>().Link(depthPrePass->GetOutput(0));
+	drawTerrain->GetInput<2>().Link(getCamera->GetOutput(0));
+	drawTerrain->GetInput<3>().Link(getWorldScene->GetOutput(6));
+	drawTerrain->GetInput<4>().Link(getWorldScene->GetOutput(2));
+
+	drawFoliage->GetInput<0>().Link(drawTerrain->GetOutput(0));
+	drawFoliage->GetInput<1>().Link(depthPrePass->GetOutput(0));
+	drawFoliage->GetInput<2>().Link(getCamera->GetOutput(0));
+	drawFoliage->GetInput<3>().Link(getWorldScene->GetOutput(5));
+	drawFoliage->GetInput<4>().Link(getWorldScene->GetOutput(2));
+
 	// last step in world render is debug draw
-	debugDraw->GetInput<0>().Link(drawSky->GetOutput(0));
+	debugDraw->GetInput<0>().Link(drawFoliage->GetOutput(0));
 	debugDraw->GetInput<1>().Link(getCamera->GetOutput(0));
 
 	// -----------------------------
@@ -522,10 +591,10 @@ void GraphicsEngine::CreatePipeline() {
 		createCsmTextures,
 		forwardRender,
 		depthPrePass,
-		depthReduction,
-		depthReductionFinal,
 		csm,
 		drawSky,
+		drawTerrain,
+		drawFoliage,
 		lightCulling,
 
 		getGuiScene,
@@ -551,7 +620,8 @@ void GraphicsEngine::CreatePipeline() {
 		}
 	}
 
-	m_pipeline.CreateFromNodesList(nodeList);
+	// everything ends up in the back buffer through the final blend
+	m_pipeline.CreateFromNodesList(nodeList, { alphaBlend });
 
 	DumpPipelineGraph(m_pipeline, "pipeline_graph.dot");
 
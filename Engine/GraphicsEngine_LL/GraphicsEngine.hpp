@@ -4,9 +4,11 @@
 #include "Scheduler.hpp"
 #include "CommandAllocatorPool.hpp"
 #include "ScratchSpacePool.hpp"
+#include "BindlessHeap.hpp"
 #include "ResourceResidencyQueue.hpp"
 #include "PipelineEventDispatcher.hpp"
 #include "PipelineEventListener.hpp"
+#include "PipelineProfiler.hpp"
 
 #include "CriticalBufferHeap.hpp"
 #include "BackBufferManager.hpp"
@@ -37,6 +39,8 @@ class MaterialShaderGraph;
 class Scene;
 class MeshEntity;
 class OverlayEntity;
+class FoliageEntity;
+class TerrainEntity;
 class PerspectiveCamera;
 class OrthographicCamera;
 
@@ -51,6 +55,14 @@ struct GraphicsEngineDesc {
 	int width;
 	int height;
 	exc::Logger* logger;
+	/// <summary> How many frames the CPU may record ahead of the GPU, between 1 and 3. </summary>
+	int framesInFlight = 2;
+	/// <summary> Bytes of video memory the engine's resources may keep resident, zero for no limit. </summary>
+	uint64_t residencyBudget = 0;
+	/// <summary> How many of the last frames the pipeline profiler keeps, zero disables profiling. </summary>
+	size_t profiledFrames = 0;
+	/// <summary> Keeps image views in one shader visible heap that shaders index directly, instead of binding them one by one. </summary>
+	bool bindlessDescriptors = false;
 };
 
 
@@ -107,6 +119,8 @@ public:
 	Scene* CreateScene(std::string name);
 	MeshEntity* CreateMeshEntity();
 	OverlayEntity* CreateOverlayEntity();
+	FoliageEntity* CreateFoliageEntity();
+	TerrainEntity* CreateTerrainEntity();
 	PerspectiveCamera* CreatePerspectiveCamera(std::string name);
 	OrthographicCamera* CreateOrthographicCamera(std::string name);
 
@@ -115,6 +129,10 @@ public:
 	bool SetEnvVariable(std::string name, exc::Any obj);
 	bool EnvVariableExists(const std::string& name);
 	const exc::Any& GetEnvVariable(const std::string& name);
+
+	// Diagnostics
+	/// <returns> Timings of the last frames, nullptr if profiling is disabled. </returns>
+	PipelineProfiler* GetProfiler() { return m_profiler.get(); }
 private:
 	void CreatePipeline();
 	static std::vector<GraphicsNode*> SelectSpecialNodes(Pipeline& pipeline);
@@ -131,6 +149,7 @@ private:
 	DSVHeap m_dsvHeap;
 	RTVHeap m_rtvHeap;
 	CbvSrvUavHeap m_persResViewHeap;
+	std::unique_ptr<BindlessHeap> m_bindlessHeap; // null if not enabled, scratch spaces are carved from it otherwise
 	std::unique_ptr<BackBufferManager> m_backBufferHeap;
 	std::vector<WindowResizeListener*> m_windowResizeListeners;
 
@@ -141,7 +160,7 @@ private:
 	Pipeline m_pipeline;
 	Scheduler m_scheduler;
 	ShaderManager m_shaderManager;
-	std::vector<SyncPoint> m_frameEndFenceValues;
+	std::vector<SyncPoint> m_frameSlotFences; // completion of the last frame recorded in each slot
 	std::vector<std::shared_ptr<GraphicsNode>> m_graphicsNodes;
 	std::vector<GraphicsNode*> m_specialNodes;
 
@@ -150,6 +169,7 @@ private:
 	ResourceResidencyQueue m_residencyQueue;
 	PipelineEventDispatcher m_pipelineEventDispatcher;
 	PipelineEventPrinter m_pipelineEventPrinter; // ONLY FOR TEST PURPOSES
+	std::unique_ptr<PipelineProfiler> m_profiler;
 
 	// Logging
 	exc::Logger* m_logger;
@@ -159,6 +179,7 @@ private:
 	// Misc
 	std::chrono::nanoseconds m_absoluteTime;
 	uint64_t m_frame = 0;
+	int m_framesInFlight;
 
 	// Env variables
 	std::unordered_map<std::string, exc::Any> m_envVariables;
@@ -4,6 +4,9 @@
 #include "../BaseLibrary/Graph/Node.hpp"
 #include "NodeContext.hpp"
 
+#include <cstdint>
+#include <vector>
+
 
 #ifdef _MSC_VER // disable lemon warnings 
 #pragma warning(push) 
@@ -54,6 +57,14 @@ class GraphicsTask {
 public:
 	virtual void Setup(SetupContext& context) = 0;
 	virtual void Execute(RenderContext& context) = 0;
+
+	/// <summary> Lets the scheduler submit the last recorded command list of the task again instead of calling Execute. </summary>
+	/// <param name="keys"> Everything the recording depends on, such as resource identities or versions of the inputs.
+	///		The recording is reused as long as the keys are the same. Called after Setup. </param>
+	/// <returns> False if the task must be recorded every frame. </returns>
+	/// <remarks> Reusable recordings must not use volatile constant buffers, those are only valid for a single frame.
+	///		Recordings that do are not reused. </remarks>
+	virtual bool GetRecordingKeys(std::vector<uint64_t>& keys) const { return false; }
 };
 
 
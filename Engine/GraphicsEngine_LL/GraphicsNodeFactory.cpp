@@ -8,12 +8,7 @@ exc::NodeBase* inl::gxeng::GraphicsNodeFactory::CreateNode(const std::string & n
 		return nullptr;
 	}
 
-	GraphicsNode* graphicsNode = dynamic_cast<GraphicsNode*>(node);
-	if (graphicsNode != nullptr) {
-		// do some special initialization for graphics nodes
-		// like set graphics engine or...
-		assert(false);
-	}
-
+	// graphics nodes are initialized by Pipeline::CreateFromDescription once they are linked,
+	// nodes created directly must be initialized by the caller before they are put in a pipeline
 	return node;
 }
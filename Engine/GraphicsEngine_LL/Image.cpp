@@ -4,12 +4,17 @@ namespace inl {
 namespace gxeng {
 
 
-Image::Image(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap) {
+std::atomic<uint64_t> Image::s_versionCounter{ 0 };
+
+
+Image::Image(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap, BindlessHeap* bindlessHeap) {
 	assert(memoryManager != nullptr);
 	m_memoryManager = memoryManager;
 	m_descriptorHeap = descriptorHeap;
+	m_bindlessHeap = bindlessHeap;
 
 	m_channelCount = 0;
+	m_version = 0;
 }
 
 
@@ -35,10 +40,14 @@ void Image::SetLayout(size_t width, size_t height, ePixelChannelType channelType
 		desc.numMipLevels = -1;
 		desc.planeIndex = 0;
 		m_resource.reset(new TextureView2D(texture, *m_descriptorHeap, texture.GetFormat(), desc));
+		if (m_bindlessHeap != nullptr) {
+			m_resource->RegisterBindless(*m_bindlessHeap);
+		}
 
 		m_channelCount = channelCount;
 		m_channelType = channelType;
 		m_pixelClass = pixelClass;
+		m_version = ++s_versionCounter;
 	}
 	catch (...) {
 		// might be able to do something useful
@@ -85,6 +94,7 @@ void Image::Update(size_t x, size_t y, size_t width, size_t height, const void*
 
 	// upload data to gpu
 	m_memoryManager->GetUploadManager().Upload(m_resource->GetResource(), (uint32_t)x, (uint32_t)y, pixels, width, (uint32_t)height, m_resource->GetFormat(), bytesPerRow);
+	m_version = ++s_versionCounter;
 }
 
 
@@ -118,8 +128,12 @@ ePixelClass Image::GetPixelClass() const {
 	return m_pixelClass;
 }
 
+uint64_t Image::GetVersion() const {
+	return m_version;
+}
+
 
-std::shared_ptr<const TextureView2D> Image::GetSrv() {
+std::shared_ptr<const TextureView2D> Image::GetSrv() const {
 	return m_resource;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include "MemoryObject.hpp"
 #include "Pixel.hpp"
@@ -14,7 +15,8 @@ namespace gxeng {
 
 class Image {
 public:
-	Image(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap);
+	/// <param name="bindlessHeap"> If not null, the image's view is registered for bindless access. </param>
+	Image(MemoryManager* memoryManager, CbvSrvUavHeap* descriptorHeap, BindlessHeap* bindlessHeap = nullptr);
 	~Image();
 
 	void SetLayout(size_t width, size_t height, ePixelChannelType channelType, int channelCount, ePixelClass pixelClass);
@@ -25,8 +27,12 @@ public:
 	ePixelChannelType GetChannelType() const;
 	int GetChannelCount() const;
 	ePixelClass GetPixelClass() const;
+	/// <summary> Changes each time the layout or the pixels change. </summary>
+	/// <remarks> Versions come from a process-wide counter, so an image allocated at the address of a freed one
+	///		never takes over its version. Zero until the layout is set. </remarks>
+	uint64_t GetVersion() const;
 
-	std::shared_ptr<const TextureView2D> GetSrv();
+	std::shared_ptr<const TextureView2D> GetSrv() const;
 protected:
 	static bool Image::ConvertFormat(ePixelChannelType channelType, int channelCount, ePixelClass pixelClass, gxapi::eFormat& fmt, int& resultingChannelCount);
 private:
@@ -34,8 +40,11 @@ private:
 	ePixelChannelType m_channelType;
 	int m_channelCount;
 	ePixelClass m_pixelClass;
+	uint64_t m_version;
+	static std::atomic<uint64_t> s_versionCounter;
 	MemoryManager* m_memoryManager;
 	CbvSrvUavHeap* m_descriptorHeap;
+	BindlessHeap* m_bindlessHeap;
 
 };
 
@@ -1,4 +1,7 @@
 #include "Material.hpp"
+#include "ShaderTokenizer.hpp"
+#include <iterator>
+#include <mutex>
 #include <stack>
 
 
@@ -51,12 +54,70 @@ std::string MaterialShaderEquation::GetShaderCode() const {
 	return m_source;
 }
 
+std::vector<MaterialShaderParameter> MaterialShaderEquation::GetShaderParameters() const {
+	return GetSignature().parameters;
+}
+
+eMaterialShaderParamType MaterialShaderEquation::GetShaderOutputType() const {
+	return GetSignature().returnType;
+}
+
+size_t MaterialShaderEquation::GetHash() const {
+	return m_hash;
+}
+
 void MaterialShaderEquation::SetSourceName(const std::string& name) {
-	m_source = LoadShaderSource(name);
+	SetSourceCode(LoadShaderSource(name));
 }
 
 void MaterialShaderEquation::SetSourceCode(const std::string& code) {
 	m_source = code;
+	m_hash = std::hash<std::string>()(m_source);
+	try {
+		m_signature = GetSignature(m_source, m_hash);
+	}
+	catch (std::invalid_argument&) {
+		m_signature.reset();
+	}
+}
+
+std::shared_ptr<const MaterialShaderEquation::Signature> MaterialShaderEquation::GetSignature(const std::string& source, size_t hash) {
+	// equations own the signatures, the cache only finds them while some equation still uses the source
+	struct CacheEntry {
+		std::string source;
+		std::weak_ptr<const Signature> signature;
+	};
+	static std::mutex mutex;
+	static std::unordered_map<size_t, CacheEntry> cache;
+
+	{
+		std::lock_guard<std::mutex> lkg(mutex);
+		auto it = cache.find(hash);
+		if (it != cache.end() && it->second.source == source) {
+			if (auto signature = it->second.signature.lock()) {
+				return signature;
+			}
+		}
+	}
+
+	// parse outside the lock, threads racing on the same new source both parse it, which is harmless
+	auto signature = std::make_shared<Signature>();
+	ExtractShaderParameters(source, "main", signature->returnType, signature->parameters);
+
+	std::lock_guard<std::mutex> lkg(mutex);
+	for (auto it = cache.begin(); it != cache.end();) {
+		it = it->second.signature.expired() ? cache.erase(it) : std::next(it);
+	}
+	cache.insert({ hash, CacheEntry{ source, signature } }); // on a hash collision, the first source keeps the entry
+	return signature;
+}
+
+const MaterialShaderEquation::Signature& MaterialShaderEquation::GetSignature() const {
+	if (!m_signature) {
+		GetSignature(m_source, m_hash); // the source did not parse when set, this throws the error
+		throw std::logic_error("Shader source did not parse when set, but does now.");
+	}
+	return *m_signature;
 }
 
 
@@ -74,18 +135,32 @@ std::string MaterialShaderGraph::GetShaderCode() const {
 	return m_source;
 }
 
+std::vector<MaterialShaderParameter> MaterialShaderGraph::GetShaderParameters() const {
+	return m_parameters;
+}
+
+eMaterialShaderParamType MaterialShaderGraph::GetShaderOutputType() const {
+	return m_returnType;
+}
+
+size_t MaterialShaderGraph::GetHash() const {
+	return m_hash;
+}
+
 
 void MaterialShaderGraph::AssembleShaderCode() {
 	std::vector<ShaderNode> shaderNodes(m_nodes.size());
 	std::vector<std::vector<MaterialShaderParameter>> shaderNodeParams(m_nodes.size());
 	std::vector<eMaterialShaderParamType> shaderNodeReturns(m_nodes.size());
-	std::vector<std::string> functions(m_nodes.size());
+	std::vector<size_t> shaderNodeHashes(m_nodes.size());
 
-	// collect individual shader codes and set number of input params for each node
+	// collect individual shader signatures and set number of input params for each node
+	// signatures are cached by the nodes, so this does not parse anything that did not change
 	for (size_t i = 0; i < m_nodes.size(); ++i) {
 		MaterialShader* shader = m_nodes[i].get();
-		functions[i] = shader->GetShaderCode();
-		ExtractShaderParameters(functions[i], "main", shaderNodeReturns[i], shaderNodeParams[i]);
+		shaderNodeHashes[i] = shader->GetHash();
+		shaderNodeReturns[i] = shader->GetShaderOutputType();
+		shaderNodeParams[i] = shader->GetShaderParameters();
 
 		for (auto p : shaderNodeParams[i]) {
 			if (p.type == eMaterialShaderParamType::UNKNOWN) {
@@ -139,6 +214,7 @@ void MaterialShaderGraph::AssembleShaderCode() {
 	std::vector<size_t> topologicalOrder;
 	std::vector<bool> visited(shaderNodes.size(), false);
 	std::vector<FreeParam> freeParams;
+	m_nodeCodes.resize(m_nodes.size());
 	auto VisitNode = [&](size_t node, auto& self) {
 		if (visited[node]) {
 			return;
@@ -160,10 +236,16 @@ void MaterialShaderGraph::AssembleShaderCode() {
 			}
 		}
 
-		std::stringstream ss;
-		ss << "main_" << topologicalOrder.size();
-		shaderNodes[node].SetFunctionName(ss.str());
-		functions[node] = std::regex_replace(functions[node], std::regex("main"), ss.str());
+		std::string functionName = "main_" + std::to_string(topologicalOrder.size());
+		shaderNodes[node].SetFunctionName(functionName);
+
+		// only re-emit the node's function if its code or its assigned name has changed
+		NodeCode& nodeCode = m_nodeCodes[node];
+		if (nodeCode.hash != shaderNodeHashes[node] || nodeCode.functionName != functionName || nodeCode.code.empty()) {
+			nodeCode.code = ShaderTokenizer(m_nodes[node]->GetShaderCode()).RenameIdentifier("main", functionName);
+			nodeCode.functionName = std::move(functionName);
+			nodeCode.hash = shaderNodeHashes[node];
+		}
 		topologicalOrder.push_back(node);
 		shaderNodes[node].SetFunctionReturn(GetParameterString(shaderNodeReturns[node]));
 	};
@@ -180,18 +262,20 @@ void MaterialShaderGraph::AssembleShaderCode() {
 	std::stringstream finalCode;
 	// sub-functions
 	for (auto node : topologicalOrder) {
-		finalCode << functions[node] << "\n";
+		finalCode << m_nodeCodes[node].code << "\n";
 	}
 	finalCode << "\n\n";
 	// signature
-	std::string returnType = GetParameterString(shaderNodeReturns[*--topologicalOrder.end()]);
-	finalCode << returnType << " main(";
+	m_returnType = shaderNodeReturns[*--topologicalOrder.end()];
+	m_parameters.clear();
+	finalCode << GetParameterString(m_returnType) << " main(";
 	bool firstParam = true;
 	for (auto& p : freeParams) {
 		if (!firstParam)
 			finalCode << ", ";
 		finalCode << GetParameterString(shaderNodeParams[p.node][p.input].type) << " ";
 		finalCode << p.name;
+		m_parameters.push_back({ p.name, shaderNodeParams[p.node][p.input].type });
 		firstParam = false;
 	}
 	finalCode << ") {\n";
@@ -207,6 +291,23 @@ void MaterialShaderGraph::AssembleShaderCode() {
 
 
 	m_source = finalCode.str();
+
+	// combined hash of the nodes and the links, the generated code is never re-hashed
+	auto HashCombine = [](size_t seed, size_t value) {
+		return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+	};
+	m_hash = 0;
+	for (auto hash : shaderNodeHashes) {
+		m_hash = HashCombine(m_hash, hash);
+	}
+	for (const auto& link : m_links) {
+		m_hash = HashCombine(m_hash, std::hash<int>()(link.sourceNode));
+		m_hash = HashCombine(m_hash, std::hash<int>()(link.sinkNode));
+		m_hash = HashCombine(m_hash, std::hash<int>()(link.sinkPort));
+	}
+	for (const auto& node : m_nodes) {
+		m_hash = HashCombine(m_hash, std::hash<std::string>()(node->GetName()));
+	}
 }
 
 void MaterialShaderGraph::SetGraph(std::vector<std::unique_ptr<MaterialShader>> nodes, std::vector<Link> links) {
@@ -223,118 +324,6 @@ void MaterialShaderGraph::SetGraph(std::vector<std::unique_ptr<MaterialShader>>
 //------------------------------------------------------------------------------
 
 
-std::string MaterialShader::RemoveComments(std::string code) {
-	std::stringstream ss(code);
-
-	// remove single line comments by trimming commented-out tails, line-by-line
-	std::string noSingleLine;
-	std::string singleLine;
-	while (std::getline(ss, singleLine)) {
-		size_t idx = singleLine.find_first_of("//");
-		if (idx != singleLine.npos) {
-			singleLine = singleLine.substr(0, idx - 1);
-		}
-		noSingleLine += singleLine;
-	}
-
-	// remove multiline comments by replacing regex template " /*anything*/ " to empty string
-	std::stringstream noComment;
-	std::regex multilinePattern(R"(/\*.*\*/)");
-	std::regex_replace(std::ostreambuf_iterator<char>(noComment), noSingleLine.begin(), noSingleLine.end(), multilinePattern, "");
-
-	std::string ret = noComment.str();
-	return ret;
-}
-
-
-std::string MaterialShader::FindFunctionSignature(std::string code, const std::string& functionName) {
-	// regex to match " functionName ( anything ) { " 
-	std::regex signaturePattern(functionName + R"(\s*\(.*\)\s*\{)");
-
-	// find matches
-	std::smatch matches;
-	if (!std::regex_search(code, matches, signaturePattern)) {
-		throw std::invalid_argument("No main function found in material shader.");
-	}
-
-	// march back towards return type over whitespaces
-	intptr_t matchIdx = matches[0].first - code.cbegin();
-	matchIdx -= 1;
-	while (matchIdx >= 0 && isspace(code[matchIdx])) {
-		--matchIdx;
-	}
-
-	// march back over return type's characters
-	intptr_t returnIdx = matchIdx;
-	while (returnIdx >= 0 && !isspace(code[returnIdx])) {
-		--returnIdx;
-	}
-	returnIdx = std::max(intptr_t(0), returnIdx);
-
-	// return type spans across range [returnIdx, matchIdx], it being empty range means failure
-	if (matchIdx == returnIdx) {
-		throw std::invalid_argument("Main function has no return type.");
-	}
-
-	// walk back from match's end until ')'
-	intptr_t matchEndIdx = matches[0].second - code.begin();
-	while (code[matchEndIdx] != ')') {
-		matchEndIdx--;
-	}
-	++matchEndIdx;
-
-	return code.substr(returnIdx, matchEndIdx - returnIdx);
-}
-
-
-void MaterialShader::SplitFunctionSignature(std::string signature, std::string& returnType, std::vector<std::pair<std::string, std::string>>& parameters) {
-	// extract part between the parentheses
-	size_t opening = signature.find_first_of('(');
-	size_t closing = signature.find_first_of(')');
-	std::stringstream paramString(signature.substr(opening + 1, closing - opening - 1));
-
-	// split the parameters string to individual parameters, and process them
-	std::string param;
-	while (getline(paramString, param, ',')) {
-		if (param.size() == 0) {
-			throw std::invalid_argument("Parameter of main has zero characters.");
-		}
-		// trim leading and trailing whitespaces
-		intptr_t firstChar = 0;
-		while (firstChar < (intptr_t)param.size() && isspace(param[firstChar])) {
-			++firstChar;
-		}
-		intptr_t lastChar = param.size() - 1;
-		while (lastChar >= firstChar && isspace(param[lastChar])) {
-			--lastChar;
-		}
-		if (firstChar >= lastChar) {
-			throw std::invalid_argument("Parameter of main has no type specifier or declaration name.");
-		}
-		param = param.substr(firstChar, lastChar-firstChar+1);
-
-		// split param to type and name
-		firstChar = 0;
-		while (!isspace(param[firstChar])) {
-			++firstChar;
-		}
-		lastChar = param.size() - 1;
-		while (!isspace(param[lastChar])) {
-			--lastChar;
-		}
-
-		parameters.push_back({ param.substr(0, firstChar), param.substr(lastChar + 1, param.npos) });
-	}
-
-	// get return type
-	intptr_t lastChar = 0;
-	while (!isspace(signature[lastChar])) {
-		++lastChar;
-	}
-	returnType = signature.substr(0, lastChar);
-}
-
-
 std::string MaterialShader::GetParameterString(eMaterialShaderParamType type) {
 	switch (type) {
 		case eMaterialShaderParamType::COLOR: return "float4";
@@ -365,18 +354,14 @@ eMaterialShaderParamType MaterialShader::GetParameterType(std::string typeString
 
 
 void MaterialShader::ExtractShaderParameters(std::string code, const std::string& functionName, eMaterialShaderParamType& returnType, std::vector<MaterialShaderParameter>& parameters) {
-	code = RemoveComments(code);
-	std::string signature = FindFunctionSignature(code, functionName);
-
-	std::string returnTypeStr;
-	std::vector<std::pair<std::string, std::string>> paramList;
-	SplitFunctionSignature(signature, returnTypeStr, paramList);
+	ShaderTokenizer tokenizer(std::move(code));
+	ShaderFunctionSignature signature = tokenizer.FindFunctionSignature(functionName);
 
-	returnType = GetParameterType(returnTypeStr);
+	returnType = GetParameterType(signature.returnType);
 
 	// collect results
 	std::vector<MaterialShaderParameter> params;
-	for (const auto& p : paramList) {
+	for (const auto& p : signature.parameters) {
 		MaterialShaderParameter param;
 		param.type = GetParameterType(p.first);
 		param.name = p.second;
@@ -5,10 +5,10 @@
 #include <BaseLibrary/Graph_All.hpp>
 #include <mathfu/mathfu_exc.hpp>
 
-#include <regex>
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <memory>
 #include <string>
 
 namespace inl::gxeng {
@@ -45,9 +45,6 @@ public:
 	void SetName(std::string name);
 	const std::string& GetName() const;
 protected:
-	static std::string RemoveComments(std::string code);
-	static std::string FindFunctionSignature(std::string code, const std::string& functionName);
-	static void SplitFunctionSignature(std::string signature, std::string& returnType, std::vector<std::pair<std::string, std::string>>& parameters);
 	static std::string GetParameterString(eMaterialShaderParamType type);
 	static eMaterialShaderParamType GetParameterType(std::string typeString);
 	static void ExtractShaderParameters(std::string code, const std::string& functionName, eMaterialShaderParamType& returnType, std::vector<MaterialShaderParameter>& parameters);
@@ -64,11 +61,28 @@ public:
 	MaterialShaderEquation(ShaderManager* shaderManager) : MaterialShader(shaderManager) {}
 
 	std::string GetShaderCode() const override;
+	std::vector<MaterialShaderParameter> GetShaderParameters() const override;
+	eMaterialShaderParamType GetShaderOutputType() const override;
+	size_t GetHash() const override;
 
 	void SetSourceName(const std::string& name);
 	void SetSourceCode(const std::string& code);
+private:
+	struct Signature {
+		eMaterialShaderParamType returnType;
+		std::vector<MaterialShaderParameter> parameters;
+	};
+
+	/// <summary> Returns the signature of the source's main, sources used by live equations are not parsed again. </summary>
+	/// <remarks> Thread-safe. Sources that fail to parse are not cached, and throw again on every call.
+	///		Entries of sources no equation uses any more are pruned when new sources are added. </remarks>
+	static std::shared_ptr<const Signature> GetSignature(const std::string& source, size_t hash);
+	const Signature& GetSignature() const;
 private:
 	std::string m_source;
+	size_t m_hash = 0;
+	// Null if the source did not parse, so that setting invalid code does not throw until queried.
+	std::shared_ptr<const Signature> m_signature;
 };
 
 
@@ -103,14 +117,29 @@ public:
 	MaterialShaderGraph(ShaderManager* shaderManager);
 
 	std::string GetShaderCode() const override;
+	std::vector<MaterialShaderParameter> GetShaderParameters() const override;
+	eMaterialShaderParamType GetShaderOutputType() const override;
+	size_t GetHash() const override;
 
 	void SetGraph(std::vector<std::unique_ptr<MaterialShader>> nodes, std::vector<Link> links);
 protected:
 	void AssembleShaderCode();
+private:
+	/// <summary> Renamed code of a node from the last assembly, reused if the node did not change. </summary>
+	struct NodeCode {
+		size_t hash = 0;
+		std::string functionName;
+		std::string code;
+	};
 private:
 	std::vector<std::unique_ptr<MaterialShader>> m_nodes;
 	std::vector<Link> m_links;
 	std::string m_source;
+
+	std::vector<NodeCode> m_nodeCodes;
+	std::vector<MaterialShaderParameter> m_parameters;
+	eMaterialShaderParamType m_returnType = eMaterialShaderParamType::UNKNOWN;
+	size_t m_hash = 0;
 };
 
 
@@ -18,7 +18,8 @@ MemoryManager::MemoryManager(gxapi::IGraphicsApi* graphicsApi) :
 	m_graphicsApi(graphicsApi),
 	m_criticalHeap(graphicsApi),
 	m_uploadHeap(graphicsApi),
-	m_constBufferHeap(graphicsApi)
+	m_constBufferHeap(graphicsApi),
+	m_residencyManager(std::make_shared<ResidencyManager>(graphicsApi))
 {}
 
 
@@ -35,11 +36,28 @@ void MemoryManager::UnlockResident(const std::vector<MemoryObject>& resources) {
 }
 
 
+void MemoryManager::BeginFrame(uint64_t frameId) {
+	m_uploadHeap.BeginFrame(frameId);
+	m_constBufferHeap.BeginFrame(frameId);
+	m_residencyManager->SetCurrentFrame(frameId);
+}
+
+
+ResidencyManager& MemoryManager::GetResidencyManager() {
+	return *m_residencyManager;
+}
+
+
 UploadManager& MemoryManager::GetUploadManager() {
 	return m_uploadHeap;
 }
 
 
+ConstantBufferHeap& MemoryManager::GetConstBufferHeap() {
+	return m_constBufferHeap;
+}
+
+
 VolatileConstBuffer MemoryManager::CreateVolatileConstBuffer(const void* data, uint32_t size) {
 	return m_constBufferHeap.CreateVolatileBuffer(data, size);
 }
@@ -145,15 +163,27 @@ MemoryObjDesc MemoryManager::AllocateResource(eResourceHeapType heap, const gxap
 		pClearValue = &rtvClearValue;
 	}
 
+	MemoryObjDesc result;
 	switch(heap) {
 	case eResourceHeapType::CRITICAL: 
-		return m_criticalHeap.Allocate(std::move(desc), pClearValue);
+		result = m_criticalHeap.Allocate(std::move(desc), pClearValue);
 		break;
 	default:
 		assert(false);
+		return MemoryObjDesc();
 	}
 
-	return MemoryObjDesc();
+	// track the resource for the residency budget as long as it lives
+	gxapi::IResource* resource = result.resource.get();
+	m_residencyManager->Add(resource, ResidencyManager::EstimateSize(desc));
+	MemoryObjDesc::Deleter deleter = result.resource.get_deleter();
+	result.resource.release();
+	result.resource = MemoryObjDesc::UniqPtr(resource, [residencyManager = m_residencyManager, deleter](gxapi::IResource* resource) {
+		residencyManager->Remove(resource);
+		deleter(resource);
+	});
+
+	return result;
 }
 
 
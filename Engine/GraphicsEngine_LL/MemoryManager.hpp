@@ -5,10 +5,11 @@
 #include "CriticalBufferHeap.hpp"
 #include "UploadManager.hpp"
 #include "ConstBufferHeap.hpp"
+#include "ResidencyManager.hpp"
 
 #include "../GraphicsApi_LL/Common.hpp"
-#include "../GraphicsApi_D3D12/DescriptorHeap.hpp"
-#include "../GraphicsApi_D3D12/GraphicsApi.hpp"
+#include "../GraphicsApi_LL/IDescriptorHeap.hpp"
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
 
 #include <iostream>
 #include <unordered_set>
@@ -26,7 +27,8 @@ public:
 	MemoryManager(gxapi::IGraphicsApi* graphicsApi);
 
 	/// <summary>
-	/// Makes given resources resident.
+	/// Makes given resources resident, and keeps them from being evicted until they are unlocked.
+	/// Least recently used unlocked resources are evicted to stay within the residency budget.
 	/// </summary>
 	/// <exception cref="inl::gxapi::OutOfMemory">
 	/// If there is not enough free memory in the resource's appropriate
@@ -37,13 +39,22 @@ public:
 	void LockResident(IterT begin, IterT end);
 
 	/// <summary>
-	/// WRITE A DESCRIPTION
+	/// Allows the resources to be evicted when room is needed, once they have been unlocked as many times as they were locked.
 	/// </summary>
 	void UnlockResident(const std::vector<MemoryObject>& resources);
 	template<typename IterT>
 	void UnlockResident(IterT begin, IterT end);
 
+	/// <summary>
+	/// Uploads and volatile constant buffers requested from now on belong to the given frame.
+	/// They are released when the device completes the frame, so both heaps must receive the device events.
+	/// Resources locked from now on count as used in this frame.
+	/// </summary>
+	void BeginFrame(uint64_t frameId);
+
+	ResidencyManager& GetResidencyManager();
 	UploadManager& GetUploadManager();
+	ConstantBufferHeap& GetConstBufferHeap();
 	VolatileConstBuffer CreateVolatileConstBuffer(const void* data, uint32_t size);
 	PersistentConstBuffer CreatePersistentConstBuffer(const void* data, uint32_t size);
 
@@ -62,8 +73,8 @@ protected:
 	UploadManager m_uploadHeap;
 	ConstantBufferHeap m_constBufferHeap;
 
-	std::mutex m_evictablesMtx;
-	std::unordered_set<MemoryObject> m_evictables;
+	// shared with the deleters of the allocated resources, which may outlive the memory manager
+	std::shared_ptr<ResidencyManager> m_residencyManager;
 
 protected:
 	MemoryObjDesc AllocateResource(eResourceHeapType heap, const gxapi::ResourceDesc& desc);
@@ -74,53 +85,15 @@ template<typename IterT>
 void MemoryManager::LockResident(IterT begin, IterT end) {
 	static_assert(std::is_same<typename IterT::value_type, MemoryObject>::value);
 
-	std::vector<gxapi::IResource*> lowLevelTargets;
-	std::vector<MemoryObject> highLevelTargets;
-
-	{
-		std::lock_guard<std::mutex> lock(m_evictablesMtx);
-
-		IterT currIter = begin;
-		while (currIter != end) {
-			auto& curr = *(currIter++);
-			auto currEvictableIter = m_evictables.find(curr);
-			bool evictable = currEvictableIter != m_evictables.end();
-			if (evictable) {
-				assert(curr._GetResident());
-				m_evictables.erase(currEvictableIter);
-			}
-			else {
-				if (curr._GetResident() == false) {
-					lowLevelTargets.push_back(curr._GetResourcePtr());
-					highLevelTargets.push_back(curr);
-				}
-			}
-		}
-
-		try {
-			m_graphicsApi->MakeResident(lowLevelTargets);
-		}
-		catch (gxapi::OutOfMemory&) {
-			std::vector<gxapi::IResource*> toEvict;
-			toEvict.reserve(m_evictables.size());
-			for (auto& curr : m_evictables) {
-				// NOTE I'm not sure why 'curr' is a const reference. I had to add a const cast.
-				toEvict.push_back(const_cast<gxapi::IResource*>(curr._GetResourcePtr()));
-			}
-			m_graphicsApi->Evict(toEvict);
-			m_evictables.clear();
-
-			m_graphicsApi->MakeResident(lowLevelTargets);
-		}
+	std::vector<gxapi::IResource*> targets;
+	for (IterT currIter = begin; currIter != end; ++currIter) {
+		targets.push_back(currIter->_GetResourcePtr());
 	}
 
-	assert(lowLevelTargets.size() == highLevelTargets.size());
-	for (size_t i = 0; i < highLevelTargets.size(); i++) {
-		auto currLowlevel = lowLevelTargets[i];
-		auto& currHighLevel = highLevelTargets[i];
-		assert(currHighLevel._GetResourcePtr() == currLowlevel);
+	m_residencyManager->Lock(targets);
 
-		currHighLevel._SetResident(true);
+	for (IterT currIter = begin; currIter != end; ++currIter) {
+		currIter->_SetResident(true);
 	}
 }
 
@@ -129,8 +102,12 @@ template<typename IterT>
 void MemoryManager::UnlockResident(IterT begin, IterT end) {
 	static_assert(std::is_same<typename IterT::value_type, MemoryObject>::value);
 
-	std::lock_guard<std::mutex> lock(m_evictablesMtx);
-	m_evictables.insert(begin, end);
+	std::vector<gxapi::IResource*> targets;
+	for (IterT currIter = begin; currIter != end; ++currIter) {
+		targets.push_back(currIter->_GetResourcePtr());
+	}
+
+	m_residencyManager->Unlock(targets);
 }
 
 } // namespace gxeng
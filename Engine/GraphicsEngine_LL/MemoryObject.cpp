@@ -2,8 +2,6 @@
 
 #include "../GraphicsApi_LL/ICommandList.hpp"
 #include "../GraphicsApi_LL/Exception.hpp"
-#include "../GraphicsApi_D3D12/Resource.hpp"
-#include "../GraphicsApi_D3D12/NativeCast.hpp"
 
 #include "MemoryManager.hpp"
 #include "CriticalBufferHeap.hpp"
@@ -51,7 +49,7 @@ bool MemoryObject::PtrEqual(const MemoryObject& lhs, const MemoryObject& rhs) {
 
 
 MemoryObject::MemoryObject(MemoryObjDesc&& desc) :
-	m_contents(new Contents{ std::move(desc.resource), desc.resident, desc.heap, {} })
+	m_contents(new Contents{ std::move(desc.resource), desc.resident, desc.heap, 0, eResourceState::COMMON, {} })
 {
 	//auto deleter = m_contents->resource.get_deleter();
 	//auto* ptr = m_contents->resource.release();
@@ -102,21 +100,33 @@ gxapi::IResource * MemoryObject::_GetResourcePtr() const noexcept {
 
 void MemoryObject::RecordState(unsigned subresource, gxapi::eResourceState newState) {
 	assert(m_contents);
-	assert(subresource < m_contents->subresourceStates.size());
-	m_contents->subresourceStates[subresource] = newState;
+	assert(subresource < m_contents->numSubresources);
+	auto& states = m_contents->subresourceStates;
+	if (states.empty()) {
+		if (newState == m_contents->uniformState) {
+			return;
+		}
+		if (m_contents->numSubresources == 1) {
+			m_contents->uniformState = newState;
+			return;
+		}
+		// subresources diverge, each needs its own state from now on
+		states.assign(m_contents->numSubresources, m_contents->uniformState);
+	}
+	states[subresource] = newState;
 }
 
 void MemoryObject::RecordState(gxapi::eResourceState newState) {
 	assert(m_contents);
-	for (auto& state : m_contents->subresourceStates) {
-		state = newState;
-	}
+	m_contents->uniformState = newState;
+	m_contents->subresourceStates.clear();
 }
 
 gxapi::eResourceState MemoryObject::ReadState(unsigned subresource) const {
 	assert(m_contents);
-	assert(subresource < m_contents->subresourceStates.size());
-	return m_contents->subresourceStates[subresource];
+	assert(subresource < m_contents->numSubresources);
+	const auto& states = m_contents->subresourceStates;
+	return states.empty() ? m_contents->uniformState : states[subresource];
 }
 
 void MemoryObject::InitResourceStates(gxapi::eResourceState initialState) {
@@ -149,7 +159,9 @@ void MemoryObject::InitResourceStates(gxapi::eResourceState initialState) {
 		}
 		default: assert(false);
 	}
-	m_contents->subresourceStates.resize(numSubresources, initialState);
+	m_contents->numSubresources = numSubresources;
+	m_contents->uniformState = initialState;
+	m_contents->subresourceStates.clear();
 }
 
 //==================================
@@ -83,8 +83,10 @@ public:
 	void RecordState(gxapi::eResourceState newState);
 	/// <summary> Returns the current tracked state. </summary>
 	gxapi::eResourceState ReadState(unsigned subresource) const;
+	/// <summary> True if all subresources are in the same state, which is then returned by ReadState for any of them. </summary>
+	bool HasUniformState() const { return m_contents->subresourceStates.empty(); }
 	/// <summary> Returns the number of subresources. </summary>
-	unsigned GetNumSubresources() const { return (unsigned)m_contents->subresourceStates.size(); }
+	unsigned GetNumSubresources() const { return m_contents->numSubresources; }
 
 	eResourceHeap GetHeap() const { assert(m_contents->heap != eResourceHeap::INVALID); return m_contents->heap; }
 
@@ -101,7 +103,9 @@ private:
 		std::unique_ptr<gxapi::IResource, Deleter> resource;
 		bool resident;
 		eResourceHeap heap;
-		std::vector<gxapi::eResourceState> subresourceStates;
+		unsigned numSubresources;
+		gxapi::eResourceState uniformState; // state of every subresource while they agree
+		std::vector<gxapi::eResourceState> subresourceStates; // only filled when subresources diverge
 	};
 
 private:
@@ -2,6 +2,8 @@
 #include "VertexElementCompressor.hpp"
 #include <BaseLibrary/ArrayView.hpp>
 
+#include <algorithm>
+
 using exc::ArrayView;
 
 
@@ -10,72 +12,110 @@ namespace gxeng {
 
 
 
+// Selects which elements of the vertex go into which stream.
+// Positions are in the first stream, everything else in the second, which is omitted if empty.
+static std::vector<std::vector<bool>> GetStreamElementMaps(const VertexBase& vertex) {
+	auto& elements = vertex.GetElements();
+	std::vector<bool> positionMap(elements.size(), false);
+	std::vector<bool> attributeMap(elements.size(), false);
+	bool hasAttributes = false;
+	for (size_t i = 0; i < elements.size(); ++i) {
+		bool isPosition = elements[i].semantic == eVertexElementSemantic::POSITION;
+		positionMap[i] = isPosition;
+		attributeMap[i] = !isPosition;
+		hasAttributes = hasAttributes || !isPosition;
+	}
+
+	std::vector<std::vector<bool>> elementMaps = { positionMap };
+	if (hasAttributes) {
+		elementMaps.push_back(attributeMap);
+	}
+	return elementMaps;
+}
+
+
 void Mesh::Set(const VertexBase* vertices, size_t numVertices, const unsigned* indices, size_t numIndices) {
 	// Create constants
-	auto& elements = vertices[0].GetElements();
-	std::vector<bool> elementMap(elements.size(), true);
-	uint32_t compressedStride = (uint32_t)VertexCompressor::Size(*vertices, elementMap);
+	std::vector<std::vector<bool>> elementMaps = GetStreamElementMaps(vertices[0]);
+	if (std::find(elementMaps[POSITION_STREAM].begin(), elementMaps[POSITION_STREAM].end(), true) == elementMaps[POSITION_STREAM].end()) {
+		throw std::invalid_argument("Vertices must have a position.");
+	}
 
 	// Create a view to iterate over vertices
 	ArrayView<const VertexBase> inputArrayView{ vertices, numVertices, vertices->StructureSize() };
 
-	// Create buffer for compressed vertices of stream
-	std::unique_ptr<uint8_t[]> compressedData = std::make_unique<uint8_t[]>(compressedStride * numVertices);
+	// Positions are quantized against the bounding box of the whole mesh
+	PositionQuantization quantization = VertexCompressor::CalculateQuantization(vertices, numVertices, vertices->StructureSize());
 
-	// Fill stream
-	ArrayView<VertexBase> outputArrayView{ reinterpret_cast<VertexBase*>(compressedData.get()), numVertices, compressedStride };
+	// Compress each stream separately
+	std::vector<std::unique_ptr<uint8_t[]>> compressedData;
+	std::vector<VertexStream> streams;
+	std::vector<std::vector<Element>> layout;
 	std::vector<VertexCompressor::Element> compressedElements;
-	for (size_t i = 0; i < numVertices; i++) {
-		compressedElements = VertexCompressor::Compress(inputArrayView[i], elementMap, &outputArrayView[i]);
-	}
+	for (const auto& elementMap : elementMaps) {
+		uint32_t compressedStride = (uint32_t)VertexCompressor::Size(*vertices, elementMap);
+		compressedData.push_back(std::make_unique<uint8_t[]>(compressedStride * numVertices));
 
-	// Set data
-	VertexStream stream;
-	stream.stride = compressedStride;
-	stream.count = numVertices;
-	stream.data = compressedData.get();
-	MeshBuffer::Set(&stream, &stream + 1, indices, indices + numIndices);
+		uint8_t* streamData = compressedData.back().get();
+		for (size_t i = 0; i < numVertices; i++) {
+			VertexCompressor::Compress(inputArrayView[i], elementMap, quantization, streamData + i * compressedStride, compressedElements);
+		}
 
-	// Set stream elements.
-	std::vector<std::vector<Element>> layout;
-	layout.clear();
-	std::vector<Element> streamElements;
-	for (const auto& e : compressedElements) {
-		streamElements.push_back({ e.semantic, e.index, e.offset });
+		VertexStream stream;
+		stream.stride = compressedStride;
+		stream.count = numVertices;
+		stream.data = streamData;
+		streams.push_back(stream);
+
+		std::vector<Element> streamElements;
+		for (const auto& e : compressedElements) {
+			streamElements.push_back({ e.semantic, e.index, e.offset, e.format });
+		}
+		layout.push_back(streamElements);
 	}
-	layout.push_back(streamElements);
+
+	// Set data, MeshBuffer picks 16 bit indices if the vertex count allows
+	MeshBuffer::Set(streams.begin(), streams.end(), indices, indices + numIndices);
 
 	// Calculate hashes
 	m_layout = Layout(layout);
+	m_positionQuantization = quantization;
 }
 
 
 void Mesh::Update(const VertexBase* vertices, size_t numVertices, size_t offsetInVertices) {
 	// Create constants
-	auto& elements = vertices[0].GetElements();
-	std::vector<bool> elementMap(elements.size(), true);
-	size_t compressedStride = VertexCompressor::Size(*vertices, elementMap);
+	std::vector<std::vector<bool>> elementMaps = GetStreamElementMaps(vertices[0]);
+	if (elementMaps.size() != GetNumStreams()) {
+		throw std::invalid_argument("Vertices must have the same elements as the ones given to Set.");
+	}
 
 	// Create a view to iterate over vertices
 	ArrayView<const VertexBase> inputArrayView{ vertices, numVertices, vertices->StructureSize() };
 
-	// Create a stream
-	std::unique_ptr<uint8_t[]> compressedData = std::make_unique<uint8_t[]>(compressedStride * numVertices);
+	std::vector<VertexCompressor::Element> compressedElements;
+	for (uint32_t streamIndex = 0; streamIndex < elementMaps.size(); ++streamIndex) {
+		size_t compressedStride = VertexCompressor::Size(*vertices, elementMaps[streamIndex]);
+		if (compressedStride != GetVertexBufferStride(streamIndex)) {
+			throw std::invalid_argument("Vertices must have the same elements as the ones given to Set.");
+		}
 
-	// Fill stream
-	ArrayView<VertexBase> outputArrayView{ reinterpret_cast<VertexBase*>(compressedData.get()), numVertices, compressedStride };
-	for (size_t i = 0; i < numVertices; i++) {
-		VertexCompressor::Compress(inputArrayView[i], elementMap, &outputArrayView[i]);
-	}
+		// Fill stream
+		std::unique_ptr<uint8_t[]> compressedData = std::make_unique<uint8_t[]>(compressedStride * numVertices);
+		for (size_t i = 0; i < numVertices; i++) {
+			VertexCompressor::Compress(inputArrayView[i], elementMaps[streamIndex], m_positionQuantization, compressedData.get() + i * compressedStride, compressedElements);
+		}
 
-	// Update data
-	MeshBuffer::Update(0, compressedData.get(), numVertices, offsetInVertices);
+		// Update data
+		MeshBuffer::Update(streamIndex, compressedData.get(), numVertices, offsetInVertices);
+	}
 }
 
 
 void Mesh::Clear() {
 	MeshBuffer::Clear();
 	m_layout.Clear();
+	m_positionQuantization = PositionQuantization();
 }
 
 
@@ -84,6 +124,17 @@ const Mesh::Layout& Mesh::GetLayout() const {
 }
 
 
+const PositionQuantization& Mesh::GetPositionQuantization() const {
+	return m_positionQuantization;
+}
+
+
+mathfu::Matrix4x4f Mesh::GetPositionDecodeMatrix() const {
+	return mathfu::Matrix4x4f::FromTranslationVector(m_positionQuantization.offset)
+		* mathfu::Matrix4x4f::FromScaleVector(m_positionQuantization.scale);
+}
+
+
 
 bool Mesh::Layout::EqualElements(const Layout& rhs) const {
 	if (m_elementHash != rhs.m_elementHash) {
@@ -101,7 +152,8 @@ bool Mesh::Layout::EqualElements(const Layout& rhs) const {
 	for (size_t i = 0; i < lhsElements.size(); ++i) {
 		if (lhsElements[i].semantic != rhsElements[i].semantic
 			|| lhsElements[i].index != rhsElements[i].index
-			|| lhsElements[i].offset != rhsElements[i].offset)
+			|| lhsElements[i].offset != rhsElements[i].offset
+			|| lhsElements[i].format != rhsElements[i].format)
 		{
 			return false;
 		}
@@ -124,7 +176,8 @@ bool Mesh::Layout::EqualLayout(const Layout& rhs) const {
 	for (size_t i = 0; i < lhsElements.size(); ++i) {
 		if (lhsElements[i].semantic != rhsElements[i].semantic
 			|| lhsElements[i].index != rhsElements[i].index
-			|| lhsElements[i].offset != rhsElements[i].offset)
+			|| lhsElements[i].offset != rhsElements[i].offset
+			|| lhsElements[i].format != rhsElements[i].format)
 		{
 			return false;
 		}
@@ -220,6 +273,7 @@ void Mesh::Layout::CalculateHashes(const std::vector<std::vector<Element>>& layo
 		layoutHash ^= inthash((size_t)e.semantic);
 		layoutHash ^= inthash((size_t)e.index);
 		layoutHash ^= inthash((size_t)e.offset);
+		layoutHash ^= inthash((size_t)e.format);
 	}
 
 	// now we order allElements to remove layout information, and keep only element information
@@ -229,6 +283,7 @@ void Mesh::Layout::CalculateHashes(const std::vector<std::vector<Element>>& layo
 		elementHash ^= inthash((size_t)e.semantic);
 		elementHash ^= inthash((size_t)e.index);
 		elementHash ^= inthash((size_t)e.offset);
+		elementHash ^= inthash((size_t)e.format);
 	}
 }
 
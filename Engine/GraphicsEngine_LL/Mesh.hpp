@@ -2,6 +2,10 @@
 
 #include "MeshBuffer.hpp"
 #include "Vertex.hpp"
+#include "VertexElementCompressor.hpp"
+
+#include <mathfu/matrix_4x4.h>
+#include <mathfu/mathfu_exc.hpp>
 
 #include <type_traits>
 
@@ -10,12 +14,23 @@ namespace inl {
 namespace gxeng {
 
 
+/// <summary>
+/// Indexed triangle mesh with compressed vertices.
+/// Positions are stored in their own stream so that depth-only passes don't fetch other attributes,
+/// all other attributes are interleaved in a second stream.
+/// </summary>
 class Mesh : protected MeshBuffer {
 public:
+	/// <summary> Index of the stream that holds only the positions. </summary>
+	static constexpr size_t POSITION_STREAM = 0;
+	/// <summary> Index of the stream that holds all other attributes. Missing if there are none. </summary>
+	static constexpr size_t ATTRIBUTE_STREAM = 1;
+
 	struct Element {
 		eVertexElementSemantic semantic;
 		int index;
 		int offset;
+		gxapi::eFormat format;
 	};
 	struct Layout {
 	public:
@@ -46,7 +61,11 @@ public:
 public:
 	Mesh(MemoryManager* memoryManager) : MeshBuffer(memoryManager) {}
 
+	/// <summary> Compresses and uploads the vertices. Positions are quantized against the bounds of <paramref name="vertices"/>. </summary>
+	/// <remarks> Indices are stored as 16 bit if the number of vertices allows. </remarks>
 	void Set(const VertexBase* vertices, size_t numVertices, const unsigned* indices, size_t numIndices);
+	/// <summary> Overwrites a range of vertices. </summary>
+	/// <remarks> The quantization of Set is kept, positions outside the original bounds are clamped. </remarks>
 	void Update(const VertexBase* vertices, size_t numVertices, size_t offsetInVertices);
 	void Clear();
 
@@ -57,8 +76,14 @@ public:
 	using MeshBuffer::IsIndexBuffer32Bit;
 
 	const Layout& GetLayout() const;
+
+	/// <summary> Parameters to decode quantized positions of the vertex buffer in shaders. </summary>
+	const PositionQuantization& GetPositionQuantization() const;
+	/// <summary> Maps quantized positions, as read by the input assembler, to object space. </summary>
+	mathfu::Matrix4x4f GetPositionDecodeMatrix() const;
 private:
 	Layout m_layout;
+	PositionQuantization m_positionQuantization;
 };
 
 
@@ -16,7 +16,7 @@ namespace gxeng {
 //------------------------------------------------------------------------------
 
 MeshBuffer::MeshBuffer(MemoryManager* memoryManager)
-	: m_memoryManager(memoryManager)
+	: m_isIndex32Bit(false), m_memoryManager(memoryManager)
 {
 	assert(m_memoryManager != nullptr);
 }
@@ -24,7 +24,7 @@ MeshBuffer::MeshBuffer(MemoryManager* memoryManager)
 
 
 void MeshBuffer::Update(uint32_t streamIndex, const void* vertexData, size_t vertexCount, size_t offsetInVertex) {
-	if (streamIndex > m_vertexBuffers.size()) {
+	if (streamIndex >= m_vertexBuffers.size()) {
 		throw std::out_of_range("Stream index is out of range.");
 	}
 	if (m_vertexStrides[streamIndex] * (vertexCount + offsetInVertex) > m_vertexBuffers[streamIndex].GetSize()) {
@@ -42,7 +42,9 @@ void MeshBuffer::Update(uint32_t streamIndex, const void* vertexData, size_t ver
 
 void MeshBuffer::Clear() {
 	m_vertexBuffers.clear();
+	m_vertexStrides.clear();
 	m_indexBuffer = IndexBuffer();
+	m_isIndex32Bit = false;
 }
 
 
@@ -9,7 +9,8 @@ MeshEntity::MeshEntity() :
 	m_material(nullptr),
 	m_position(0, 0, 0),
 	m_rotation(0, mathfu::Vector<float, 3>(1, 0, 0)),
-	m_scale(1, 1, 1)
+	m_scale(1, 1, 1),
+	m_static(false)
 {}
 
 
@@ -66,5 +67,15 @@ mathfu::Matrix<float, 4, 4> MeshEntity::GetTransform() const {
 }
 
 
+void MeshEntity::SetStatic(bool isStatic) {
+	m_static = isStatic;
+}
+
+
+bool MeshEntity::IsStatic() const {
+	return m_static;
+}
+
+
 }
 }
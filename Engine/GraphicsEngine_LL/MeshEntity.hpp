@@ -33,12 +33,20 @@ public:
 
 	mathfu::Matrix<float, 4, 4> GetTransform() const;
 
+	/// <summary>
+	/// Static entities are expected to stay put, their shadows are rendered once and cached.
+	/// Moving them is allowed but throws away the cached shadows of every static entity.
+	/// </summary>
+	void SetStatic(bool isStatic);
+	bool IsStatic() const;
+
 private:
 	Mesh* m_mesh;
 	Material* m_material;
 	mathfu::Vector<float, 3> m_position;
 	mathfu::Quaternion<float> m_rotation;
 	mathfu::Vector<float, 3> m_scale;
+	bool m_static;
 };
 
 
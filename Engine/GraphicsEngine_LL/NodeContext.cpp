@@ -39,11 +39,13 @@ SetupContext::SetupContext(MemoryManager* memoryManager,
 						   RTVHeap* rtvHeap,
 						   DSVHeap* dsvHeap,
 						   ShaderManager* shaderManager,
-						   gxapi::IGraphicsApi* graphicsApi)
+						   gxapi::IGraphicsApi* graphicsApi,
+						   BindlessHeap* bindlessHeap)
 	: m_memoryManager(memoryManager),
 	m_srvHeap(srvHeap),
 	m_rtvHeap(rtvHeap),
 	m_dsvHeap(dsvHeap),
+	m_bindlessHeap(bindlessHeap),
 	m_shaderManager(shaderManager),
 	m_graphicsApi(graphicsApi)
 {}
@@ -143,6 +145,16 @@ IndexBuffer SetupContext::CreateIndexBuffer(const void* data, size_t size, size_
 	return result;
 }
 
+
+void SetupContext::Upload(const LinearBuffer& target, size_t offset, const void* data, size_t size) const {
+	m_memoryManager->GetUploadManager().Upload(target, offset, data, size);
+}
+
+
+void SetupContext::Upload(const Texture2D& target, uint32_t offsetX, uint32_t offsetY, const void* data, uint64_t width, uint32_t height, gxapi::eFormat format, size_t bytesPerRow) const {
+	m_memoryManager->GetUploadManager().Upload(target, offsetX, offsetY, data, width, height, format, bytesPerRow);
+}
+
 ConstBufferView SetupContext::CreateCbv(VolatileConstBuffer& buffer, size_t offset, size_t size, VolatileViewHeap& viewHeap) const {
 	return ConstBufferView(
 		buffer,
@@ -186,10 +198,12 @@ RenderContext::RenderContext(MemoryManager* memoryManager,
 							 ShaderManager* shaderManager,
 							 gxapi::IGraphicsApi* graphicsApi,
 							 CommandAllocatorPool* commandAllocatorPool,
-							 ScratchSpacePool* scratchSpacePool)
+							 ScratchSpacePool* scratchSpacePool,
+							 BindlessHeap* bindlessHeap)
 	: m_memoryManager(memoryManager),
 	m_srvHeap(srvHeap),
 	m_volatileViewHeap(volatileViewHeap),
+	m_bindlessHeap(bindlessHeap),
 	m_shaderManager(shaderManager),
 	m_graphicsApi(graphicsApi),
 	m_commandAllocatorPool(commandAllocatorPool),
@@ -201,6 +215,7 @@ RenderContext::RenderContext(MemoryManager* memoryManager,
 
 VolatileConstBuffer RenderContext::CreateVolatileConstBuffer(const void* data, size_t size) const {
 	VolatileConstBuffer result = m_memoryManager->CreateVolatileConstBuffer(data, (uint32_t)size);
+	m_usedVolatileMemory = true;
 	return result;
 }
 
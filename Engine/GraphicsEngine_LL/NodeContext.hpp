@@ -25,9 +25,6 @@ class BasicCommandList;
 class ScratchSpacePool;
 class CommandAllocatorPool;
 
-// Debug draw
-class DebugObject;
-
 
 //------------------------------------------------------------------------------
 // Engine Context
@@ -71,7 +68,8 @@ public:
 				 RTVHeap* rtvHeap = nullptr,
 				 DSVHeap* dsvHeap = nullptr,
 				 ShaderManager* shaderManager = nullptr,
-				 gxapi::IGraphicsApi* graphicsApi = nullptr);
+				 gxapi::IGraphicsApi* graphicsApi = nullptr,
+				 BindlessHeap* bindlessHeap = nullptr);
 	SetupContext(SetupContext&&) = delete;
 	SetupContext& operator=(SetupContext&&) = delete;
 	SetupContext(const SetupContext&) = delete;
@@ -87,6 +85,10 @@ public:
 	VertexBuffer CreateVertexBuffer(const void* data, size_t size) const;
 	IndexBuffer CreateIndexBuffer(const void* data, size_t size, size_t indexCount) const;
 
+	// Update resources
+	void Upload(const LinearBuffer& target, size_t offset, const void* data, size_t size) const;
+	void Upload(const Texture2D& target, uint32_t offsetX, uint32_t offsetY, const void* data, uint64_t width, uint32_t height, gxapi::eFormat format, size_t bytesPerRow = 0) const;
+
 	// Create views
 	TextureView2D CreateSrv(Texture2D& texture, gxapi::eFormat format, gxapi::SrvTexture2DArray desc = {}) const;
 	RenderTargetView2D CreateRtv(Texture2D& renderTarget, gxapi::eFormat format, gxapi::RtvTexture2DArray desc) const;
@@ -103,6 +105,8 @@ public:
 
 	// Binding
 	Binder CreateBinder(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers = {}) const;
+	/// <summary> Null if the engine does not use bindless descriptors. </summary>
+	BindlessHeap* GetBindlessHeap() const { return m_bindlessHeap; }
 
 private:
 	// Memory management stuff
@@ -110,6 +114,7 @@ private:
 	CbvSrvUavHeap* m_srvHeap;
 	RTVHeap* m_rtvHeap;
 	DSVHeap* m_dsvHeap;
+	BindlessHeap* m_bindlessHeap;
 
 	// Shaders and PSOs
 	ShaderManager* m_shaderManager;
@@ -130,7 +135,8 @@ public:
 				  ShaderManager* shaderManager = nullptr,
 				  gxapi::IGraphicsApi* graphicsApi = nullptr,
 				  CommandAllocatorPool* commandAllocatorPool = nullptr,
-				  ScratchSpacePool* scratchSpacePool = nullptr);
+				  ScratchSpacePool* scratchSpacePool = nullptr,
+				  BindlessHeap* bindlessHeap = nullptr);
 	RenderContext(RenderContext&&) = delete;
 	RenderContext& operator=(RenderContext&&) = delete;
 	RenderContext(const RenderContext&) = delete;
@@ -149,6 +155,8 @@ public:
 
 	// Binding
 	Binder CreateBinder(const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers = {}) const;
+	/// <summary> Null if the engine does not use bindless descriptors. </summary>
+	BindlessHeap* GetBindlessHeap() const { return m_bindlessHeap; }
 
 	// Query command list
 	GraphicsCommandList& AsGraphics();
@@ -156,15 +164,15 @@ public:
 	CopyCommandList& AsCopy();
 	gxapi::eCommandListType GetType() const { return m_type; }
 	bool IsListInitialized() const { return (bool)m_commandList; }
-
-	// Debug draw
-	void AddDebugObject(std::vector<DebugObject*> objects);
+	/// <summary> True if the command list may refer to memory that is only valid for this frame. </summary>
+	bool UsedVolatileMemory() const { return m_usedVolatileMemory; }
 
 private:
 	// Memory management stuff
 	MemoryManager* m_memoryManager;
 	CbvSrvUavHeap* m_srvHeap;
 	VolatileViewHeap* m_volatileViewHeap;
+	BindlessHeap* m_bindlessHeap;
 
 	// Shaders and PSOs
 	ShaderManager* m_shaderManager;
@@ -175,6 +183,7 @@ private:
 	ScratchSpacePool* m_scratchSpacePool;
 	std::unique_ptr<BasicCommandList> m_commandList;
 	gxapi::eCommandListType m_type = static_cast<gxapi::eCommandListType>(0xDEADBEEF);
+	mutable bool m_usedVolatileMemory = false;
 };
 
 
@@ -0,0 +1,152 @@
+#include "DebugDrawManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace inl::gxeng {
+
+
+using Vec3 = mathfu::Vector<float, 3>;
+
+
+DebugDrawManager::LineWriter::LineWriter(ThreadBuffer& buffer, int life, Vec3 color)
+	: m_lock(buffer.mutex),
+	m_buffer(buffer),
+	m_life(life),
+	m_color(PackColor(color))
+{}
+
+
+void DebugDrawManager::LineWriter::operator()(const Vec3& start, const Vec3& end) {
+	m_buffer.vertices.push_back({ mathfu::VectorPacked<float, 3>(start), m_color });
+	m_buffer.vertices.push_back({ mathfu::VectorPacked<float, 3>(end), m_color });
+	m_buffer.lives.push_back(m_life);
+}
+
+
+uint32_t DebugDrawManager::PackColor(Vec3 color) {
+	auto Channel = [](float value) {
+		return (uint32_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+	};
+	return Channel(color.x()) | (Channel(color.y()) << 8) | (Channel(color.z()) << 16) | (255u << 24);
+}
+
+
+DebugDrawManager::ThreadBuffer& DebugDrawManager::GetThreadBuffer() {
+	ThreadBuffer*& buffer = m_threadBuffer;
+	if (!buffer) {
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		m_buffers.push_back(std::make_unique<ThreadBuffer>());
+		buffer = m_buffers.back().get();
+	}
+	return *buffer;
+}
+
+
+void DebugDrawManager::AddLine(Vec3 start, Vec3 end, int life, Vec3 color) {
+	LineWriter write(GetThreadBuffer(), life, color);
+	write(start, end);
+}
+
+
+void DebugDrawManager::AddCross(Vec3 pos, float size, int life, Vec3 color) {
+	LineWriter write(GetThreadBuffer(), life, color);
+	write(pos - Vec3(size, 0, 0), pos + Vec3(size, 0, 0));
+	write(pos - Vec3(0, size, 0), pos + Vec3(0, size, 0));
+	write(pos - Vec3(0, 0, size), pos + Vec3(0, 0, size));
+}
+
+
+void DebugDrawManager::AddBox(Vec3 min, Vec3 max, int life, Vec3 color) {
+	LineWriter write(GetThreadBuffer(), life, color);
+	auto Corner = [&min, &max](int index) {
+		return Vec3(index & 1 ? max.x() : min.x(), index & 2 ? max.y() : min.y(), index & 4 ? max.z() : min.z());
+	};
+	// every edge connects two corners that differ in one bit
+	for (int corner = 0; corner < 8; ++corner) {
+		for (int bit = 1; bit < 8; bit <<= 1) {
+			if (!(corner & bit)) {
+				write(Corner(corner), Corner(corner | bit));
+			}
+		}
+	}
+}
+
+
+void DebugDrawManager::AddSphere(Vec3 pos, float radius, int life, Vec3 color) {
+	constexpr int resolution = 32;
+	static const std::vector<Vec3> unitCircle = [] {
+		std::vector<Vec3> circle;
+		for (int i = 0; i <= resolution; ++i) {
+			float angle = 2.0f * 3.14159265f * i / resolution;
+			circle.push_back(Vec3(std::cos(angle), std::sin(angle), 0.0f));
+		}
+		return circle;
+	}();
+
+	LineWriter write(GetThreadBuffer(), life, color);
+	for (int i = 0; i < resolution; ++i) {
+		const Vec3& a = unitCircle[i];
+		const Vec3& b = unitCircle[i + 1];
+		write(pos + Vec3(a.x(), a.y(), 0) * radius, pos + Vec3(b.x(), b.y(), 0) * radius);
+		write(pos + Vec3(a.x(), 0, a.y()) * radius, pos + Vec3(b.x(), 0, b.y()) * radius);
+		write(pos + Vec3(0, a.x(), a.y()) * radius, pos + Vec3(0, b.x(), b.y()) * radius);
+	}
+}
+
+
+void DebugDrawManager::AddFrustum(Vec3 nearLowerLeft,
+								  Vec3 nearUpperLeft,
+								  Vec3 nearLowerRight,
+								  Vec3 farLowerLeft,
+								  Vec3 farUpperLeft,
+								  Vec3 farLowerRight,
+								  int life,
+								  Vec3 color)
+{
+	const Vec3 corners[8] = {
+		nearLowerLeft,
+		nearLowerRight,
+		nearLowerRight + (nearUpperLeft - nearLowerLeft),
+		nearUpperLeft,
+		farLowerLeft,
+		farLowerRight,
+		farLowerRight + (farUpperLeft - farLowerLeft),
+		farUpperLeft,
+	};
+
+	LineWriter write(GetThreadBuffer(), life, color);
+	for (int i = 0; i < 4; ++i) {
+		write(corners[i], corners[(i + 1) % 4]);
+		write(corners[4 + i], corners[4 + (i + 1) % 4]);
+		write(corners[i], corners[4 + i]);
+	}
+}
+
+
+void DebugDrawManager::MergeFrame(std::vector<DebugVertex>& vertices) {
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+	for (auto& buffer : m_buffers) {
+		std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+		vertices.insert(vertices.end(), buffer->vertices.begin(), buffer->vertices.end());
+
+		// age lines, compacting the survivors to the front
+		size_t numAlive = 0;
+		for (size_t line = 0; line < buffer->lives.size(); ++line) {
+			int life = buffer->lives[line] - 1;
+			if (life >= 0) {
+				buffer->lives[numAlive] = life;
+				buffer->vertices[2 * numAlive] = buffer->vertices[2 * line];
+				buffer->vertices[2 * numAlive + 1] = buffer->vertices[2 * line + 1];
+				++numAlive;
+			}
+		}
+		buffer->lives.resize(numAlive);
+		buffer->vertices.resize(2 * numAlive);
+	}
+}
+
+
+} // namespace inl::gxeng
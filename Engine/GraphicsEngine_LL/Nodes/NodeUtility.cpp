@@ -115,6 +115,11 @@ gxapi::eFormat FormatDepthToColor(gxapi::eFormat sourceFormat) {
 }
 
 
+void AddRecordingKey(std::vector<uint64_t>& keys, const MemoryObject& resource) {
+	keys.push_back(resource.HasObject() ? (uint64_t)reinterpret_cast<uintptr_t>(resource._GetResourcePtr()) : 0);
+}
+
+
 } // namespace inl::gxeng::nodes
 
 
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <GraphicsApi_LL/Common.hpp>
+#include "../MemoryObject.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
 
 
 namespace inl::gxeng::nodes {
@@ -22,6 +28,26 @@ gxapi::eFormat FormatAnyToDepthStencil(gxapi::eFormat sourceFormat);
 /// </summary>
 gxapi::eFormat FormatDepthToColor(gxapi::eFormat sourceFormat);
 
+/// <summary>
+/// Adds the identity of a resource to the recording keys of a task, see <see cref="GraphicsTask::GetRecordingKeys"/>.
+/// <para/>
+/// A cached recording keeps its resources alive, so no other resource can take the same identity while it's cached.
+/// </summary>
+void AddRecordingKey(std::vector<uint64_t>& keys, const MemoryObject& resource);
+
+/// <summary>
+/// Adds the bytes of a value to the recording keys of a task, see <see cref="GraphicsTask::GetRecordingKeys"/>.
+/// <para/>
+/// The value must have no padding, or recordings may not be found with equal values.
+/// </summary>
+template <class T>
+void AddRecordingKeyBytes(std::vector<uint64_t>& keys, const T& value) {
+	static_assert(std::is_trivially_copyable<T>::value, "Only the bytes of trivially copyable values can be keys.");
+	size_t first = keys.size();
+	keys.resize(first + (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+	std::memcpy(keys.data() + first, &value, sizeof(T));
+}
+
 } // namespace inl::gxeng::nodes
 
 
@@ -2,6 +2,8 @@
 
 #include "Node_Blend.hpp"
 
+#include "NodeUtility.hpp"
+
 #include "../GraphicsNode.hpp"
 
 #include "../ConstBufferHeap.hpp"
@@ -131,11 +133,23 @@ void Blend::Setup(SetupContext& context) {
 		psoDesc.renderTargetFormats[0] = m_renderTargetFormat;
 
 		m_PSO.reset(context.CreatePSO(psoDesc));
+		++m_psoVersion;
 	}
 	
 }
 
 
+bool Blend::GetRecordingKeys(std::vector<uint64_t>& keys) const {
+	// the same draw as long as the textures and the blend mode are the same
+	AddRecordingKey(keys, m_blendDest.GetResource());
+	AddRecordingKey(keys, m_blendSrc.GetResource());
+	AddRecordingKey(keys, m_fsq);
+	AddRecordingKey(keys, m_fsqIndices);
+	keys.push_back(m_psoVersion);
+	return true;
+}
+
+
 void Blend::Execute(RenderContext& context) {
 	gxeng::GraphicsCommandList& commandList = context.AsGraphics();
 
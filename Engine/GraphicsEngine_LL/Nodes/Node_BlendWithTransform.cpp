@@ -1,5 +1,7 @@
 #include "Node_BlendWithTransform.hpp"
 
+#include "NodeUtility.hpp"
+
 #include "../GraphicsNode.hpp"
 
 #include "../ConstBufferHeap.hpp"
@@ -139,11 +141,27 @@ void BlendWithTransform::Setup(SetupContext& context) {
 		psoDesc.renderTargetFormats[0] = m_renderTargetFormat;
 
 		m_PSO.reset(context.CreatePSO(psoDesc));
+		++m_psoVersion;
 	}
 
 }
 
 
+bool BlendWithTransform::GetRecordingKeys(std::vector<uint64_t>& keys) const {
+	// the transform is a root constant, recorded into the command list
+	mathfu::VectorPacked<float, 4> transformPacked[4];
+	m_transfrom.Pack(transformPacked);
+
+	AddRecordingKey(keys, m_blendDest.GetResource());
+	AddRecordingKey(keys, m_blendSrc.GetResource());
+	AddRecordingKey(keys, m_fsq);
+	AddRecordingKey(keys, m_fsqIndices);
+	AddRecordingKeyBytes(keys, transformPacked);
+	keys.push_back(m_psoVersion);
+	return true;
+}
+
+
 void BlendWithTransform::Execute(RenderContext& context) {
 	gxeng::GraphicsCommandList& commandList = context.AsGraphics();
 
@@ -31,6 +31,7 @@ public:
 	void Reset() override;
 	void Setup(SetupContext& context) override;
 	void Execute(RenderContext& context) override;
+	bool GetRecordingKeys(std::vector<uint64_t>& keys) const override;
 
 protected:
 	VertexBuffer m_fsq;
@@ -44,6 +45,7 @@ protected:
 	BindParameter m_tex0Param;
 	ShaderProgram m_shader;
 	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	uint64_t m_psoVersion = 0;
 	gxapi::eFormat m_renderTargetFormat = gxapi::eFormat::UNKNOWN;
 
 private: // excute context
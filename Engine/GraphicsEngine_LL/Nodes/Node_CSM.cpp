@@ -7,25 +7,40 @@
 #include "../Image.hpp"
 #include "../DirectionalLight.hpp"
 #include "../GraphicsCommandList.hpp"
+#include "../EntityCollection.hpp"
+#include "../FoliageCulling.hpp"
+#include "../VertexElementCompressor.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstddef>
 
 namespace inl::gxeng::nodes {
 
+// the matrix and split textures hold exactly this many cascades, see CSMSample.hlsl
+static constexpr unsigned NUM_CASCADES = 4;
+
 struct Uniforms
 {
-	mathfu::VectorPacked<float, 4> model[4];
-	uint32_t cascadeIDX;
+	mathfu::VectorPacked<float, 4> mvp[4];
+	mathfu::VectorPacked<float, 4> positionScale; // foliage only
+	mathfu::VectorPacked<float, 4> positionOffset;
+};
+
+struct MatricesUniforms
+{
+	mathfu::VectorPacked<float, 4> lightMVP[NUM_CASCADES][4];
+	mathfu::VectorPacked<float, 4> shadowMX[NUM_CASCADES][4];
+	mathfu::VectorPacked<float, 4> splits[NUM_CASCADES];
 };
 
 static bool CheckMeshFormat(const Mesh& mesh) {
-	for (size_t i = 0; i < mesh.GetNumStreams(); i++) {
-		auto& elements = mesh.GetLayout()[0];
-		if (elements.size() != 3) return false;
-		if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
-		if (elements[1].semantic != eVertexElementSemantic::NORMAL) return false;
-		if (elements[2].semantic != eVertexElementSemantic::TEX_COORD) return false;
-	}
+	// only the position stream is used
+	if (mesh.GetNumStreams() <= Mesh::POSITION_STREAM) return false;
+	auto& elements = mesh.GetLayout()[Mesh::POSITION_STREAM];
+	if (elements.size() != 1) return false;
+	if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
 
 	return true;
 }
@@ -33,6 +48,7 @@ static bool CheckMeshFormat(const Mesh& mesh) {
 
 static void ConvertToSubmittable(
 	Mesh* mesh,
+	size_t numStreams,
 	std::vector<const gxeng::VertexBuffer*>& vertexBuffers,
 	std::vector<unsigned>& sizes,
 	std::vector<unsigned>& strides
@@ -41,7 +57,8 @@ static void ConvertToSubmittable(
 	sizes.clear();
 	strides.clear();
 
-	for (int streamID = 0; streamID < mesh->GetNumStreams(); streamID++) {
+	assert(numStreams <= mesh->GetNumStreams());
+	for (int streamID = 0; streamID < numStreams; streamID++) {
 		vertexBuffers.push_back(&mesh->GetVertexBuffer(streamID));
 		sizes.push_back((unsigned)vertexBuffers.back()->GetSize());
 		strides.push_back((unsigned)mesh->GetVertexBufferStride(streamID));
@@ -52,6 +69,18 @@ static void ConvertToSubmittable(
 }
 
 
+// quantized positions fill the unit cube, the model matrix maps that to the world
+static void GetWorldBounds(const mathfu::Matrix4x4f& model, mathfu::Vector3f& minimum, mathfu::Vector3f& maximum) {
+	mathfu::Vector3f center = (model * mathfu::Vector4f(0.5f, 0.5f, 0.5f, 1.0f)).xyz();
+	mathfu::Vector3f extent;
+	for (int row = 0; row < 3; ++row) {
+		extent[row] = 0.5f * (std::abs(model(row, 0)) + std::abs(model(row, 1)) + std::abs(model(row, 2)));
+	}
+	minimum = center - extent;
+	maximum = center + extent;
+}
+
+
 
 CSM::CSM() {}
 
@@ -62,15 +91,31 @@ void CSM::Initialize(EngineContext & context) {
 
 void CSM::Reset() {
 	m_dsvs.clear();
-	m_lightMVPTexSrv = {};
+	m_entities = nullptr;
+	m_camera = nullptr;
+	m_suns = nullptr;
+	m_foliage = nullptr;
 	GetInput(0)->Clear();
 	GetInput(1)->Clear();
 	GetInput(2)->Clear();
+	GetInput(3)->Clear();
+	GetInput(4)->Clear();
 }
 
 
 void CSM::Setup(SetupContext & context) {
+	InitRenderTarget(context);
+
 	Texture2D& renderTarget = this->GetInput<0>().Get();
+	if (renderTarget.GetArrayCount() != NUM_CASCADES) {
+		throw std::invalid_argument("[CSM] Render target must have one array slice for each of the 4 cascades.");
+	}
+	if (renderTarget.GetWidth() != m_fitter.GetDesc().resolution) {
+		ShadowCascadeDesc desc = m_fitter.GetDesc();
+		desc.resolution = (unsigned)renderTarget.GetWidth();
+		m_fitter = ShadowCascadeFitter(desc);
+	}
+
 	const gxapi::eFormat currDepthStencil = FormatAnyToDepthStencil(renderTarget.GetFormat());
 	gxapi::DsvTexture2DArray dsvDesc;
 	dsvDesc.activeArraySize = 1;
@@ -81,22 +126,25 @@ void CSM::Setup(SetupContext & context) {
 		m_dsvs[i] = context.CreateDsv(renderTarget, currDepthStencil, dsvDesc);
 		m_dsvs[i].GetResource()._GetResourcePtr()->SetName((std::string("CSM cascade depth tex view #") + std::to_string(i)).c_str());
 	}
+	InitStaticCache(context, renderTarget, currDepthStencil);
+
+	// a new target has none of the cached depth
+	if (renderTarget._GetResourcePtr() != m_lastRenderTarget) {
+		m_lastRenderTarget = renderTarget._GetResourcePtr();
+		m_fitter.Invalidate();
+	}
 
 	m_entities = this->GetInput<1>().Get();
 	this->GetInput<1>().Clear();
 
-	Texture2D& lightMVPTex = this->GetInput<2>().Get();
-	gxapi::SrvTexture2DArray srvDesc;
-	srvDesc.activeArraySize = 1;
-	srvDesc.firstArrayElement = 0;
-	srvDesc.mipLevelClamping = 0;
-	srvDesc.mostDetailedMip = 0;
-	srvDesc.numMipLevels = 1;
-	srvDesc.planeIndex = 0;
-	m_lightMVPTexSrv = context.CreateSrv(lightMVPTex, lightMVPTex.GetFormat(), srvDesc);
-	m_lightMVPTexSrv.GetResource()._GetResourcePtr()->SetName("CSM light MVP tex SRV");
+	m_camera = this->GetInput<2>().Get();
+	m_suns = this->GetInput<3>().Get();
+	m_foliage = this->GetInput<4>().Get(); // null if not linked
 
 	this->GetOutput<0>().Set(renderTarget);
+	this->GetOutput<1>().Set(m_lightMVPUav.GetResource());
+	this->GetOutput<2>().Set(m_shadowMXUav.GetResource());
+	this->GetOutput<3>().Set(m_csmSplitsUav.GetResource());
 
 
 	if (!m_binder.has_value()) {
@@ -110,51 +158,69 @@ void CSM::Setup(SetupContext & context) {
 		uniformsBindParamDesc.relativeChangeFrequency = 0;
 		uniformsBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
 
-		BindParameterDesc lightMVPBindParamDesc;
-		m_lightMVPBindParam = BindParameter(eBindParameterType::TEXTURE, 0);
-		lightMVPBindParamDesc.parameter = m_lightMVPBindParam;
-		lightMVPBindParamDesc.constantSize = 0;
-		lightMVPBindParamDesc.relativeAccessFrequency = 0;
-		lightMVPBindParamDesc.relativeChangeFrequency = 0;
-		lightMVPBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
-
-		BindParameterDesc sampBindParamDesc;
-		sampBindParamDesc.parameter = BindParameter(eBindParameterType::SAMPLER, 0);
-		sampBindParamDesc.constantSize = 0;
-		sampBindParamDesc.relativeAccessFrequency = 0;
-		sampBindParamDesc.relativeChangeFrequency = 0;
-		sampBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
-
-		gxapi::StaticSamplerDesc samplerDesc;
-		samplerDesc.shaderRegister = 0;
-		samplerDesc.filter = gxapi::eTextureFilterMode::MIN_MAG_MIP_LINEAR;
-		samplerDesc.addressU = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.addressV = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.addressW = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.mipLevelBias = 0.f;
-		samplerDesc.registerSpace = 0;
-		samplerDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
-
-		m_binder = context.CreateBinder({ uniformsBindParamDesc, lightMVPBindParamDesc, sampBindParamDesc },{ samplerDesc });
+		m_binder = context.CreateBinder({ uniformsBindParamDesc });
+	}
+
+	if (!m_matricesBinder.has_value()) {
+		BindParameterDesc uniformsBindParamDesc;
+		m_matricesUniformsBindParam = BindParameter(eBindParameterType::CONSTANT, 0);
+		uniformsBindParamDesc.parameter = m_matricesUniformsBindParam;
+		uniformsBindParamDesc.constantSize = sizeof(MatricesUniforms);
+		uniformsBindParamDesc.relativeAccessFrequency = 0;
+		uniformsBindParamDesc.relativeChangeFrequency = 0;
+		uniformsBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		BindParameterDesc outputBindParamDesc0;
+		m_outputBindParam0 = BindParameter(eBindParameterType::UNORDERED, 0);
+		outputBindParamDesc0.parameter = m_outputBindParam0;
+		outputBindParamDesc0.constantSize = 0;
+		outputBindParamDesc0.relativeAccessFrequency = 0;
+		outputBindParamDesc0.relativeChangeFrequency = 0;
+		outputBindParamDesc0.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		BindParameterDesc outputBindParamDesc1;
+		m_outputBindParam1 = BindParameter(eBindParameterType::UNORDERED, 1);
+		outputBindParamDesc1.parameter = m_outputBindParam1;
+		outputBindParamDesc1.constantSize = 0;
+		outputBindParamDesc1.relativeAccessFrequency = 0;
+		outputBindParamDesc1.relativeChangeFrequency = 0;
+		outputBindParamDesc1.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		BindParameterDesc outputBindParamDesc2;
+		m_outputBindParam2 = BindParameter(eBindParameterType::UNORDERED, 2);
+		outputBindParamDesc2.parameter = m_outputBindParam2;
+		outputBindParamDesc2.constantSize = 0;
+		outputBindParamDesc2.relativeAccessFrequency = 0;
+		outputBindParamDesc2.relativeChangeFrequency = 0;
+		outputBindParamDesc2.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		m_matricesBinder = context.CreateBinder({ uniformsBindParamDesc, outputBindParamDesc0, outputBindParamDesc1, outputBindParamDesc2 });
+	}
+
+	if (!m_matricesCSO) {
+		ShaderParts shaderParts;
+		shaderParts.cs = true;
+
+		m_matricesShader = context.CreateShader("CSMMatrices", shaderParts, "");
+
+		gxapi::ComputePipelineStateDesc csoDesc;
+		csoDesc.rootSignature = m_matricesBinder->GetRootSignature();
+		csoDesc.cs = m_matricesShader.cs;
+
+		m_matricesCSO.reset(context.CreatePSO(csoDesc));
 	}
 
 	if (!m_PSO || currDepthStencil != m_depthStencilFormat) {
 		m_depthStencilFormat = currDepthStencil;
 
-		//TODO
-		constexpr unsigned cascadeSize = 1024;
-		constexpr unsigned numCascades = 4;
-
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
 
-		m_shader = context.CreateShader("CSM", shaderParts, "");
+		m_shader = context.CreateShader("CSM", shaderParts, "FOLIAGE=0");
 
 		std::vector<gxapi::InputElementDesc> inputElementDesc = {
-			gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-			gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-			gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
+			gxapi::InputElementDesc("POSITION", 0, VertexElementCompressor<eVertexElementSemantic::POSITION>::Format(), Mesh::POSITION_STREAM, 0),
 		};
 
 		gxapi::GraphicsPipelineStateDesc psoDesc;
@@ -163,6 +229,7 @@ void CSM::Setup(SetupContext & context) {
 		psoDesc.rootSignature = m_binder->GetRootSignature();
 		psoDesc.vs = m_shader.vs;
 		psoDesc.ps = m_shader.ps;
+		// depth clipping stays off, casters between the light and the cascade are flattened onto its near plane
 		psoDesc.rasterization = gxapi::RasterizerState(gxapi::eFillMode::SOLID, gxapi::eCullMode::DRAW_CCW);
 		psoDesc.primitiveTopologyType = gxapi::ePrimitiveTopologyType::TRIANGLE;
 
@@ -172,7 +239,27 @@ void CSM::Setup(SetupContext & context) {
 		psoDesc.numRenderTargets = 0;
 
 		m_PSO.reset(context.CreatePSO(psoDesc));
+
+		constexpr auto PerInstance = gxapi::eInputClassification::INSTANCE_DATA;
+		std::vector<gxapi::InputElementDesc> foliageInputElementDesc = {
+			gxapi::InputElementDesc("POSITION", 0, VertexElementCompressor<eVertexElementSemantic::POSITION>::Format(), 0, 0),
+			gxapi::InputElementDesc("INSTANCE_POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 1, 0, PerInstance, 1),
+			gxapi::InputElementDesc("INSTANCE_ROTATION_SCALE", 0, gxapi::eFormat::R32G32_FLOAT, 1, offsetof(FoliageInstance, rotation), PerInstance, 1),
+		};
+
+		m_foliageShader = context.CreateShader("CSM", shaderParts, "FOLIAGE=1");
+
+		psoDesc.inputLayout.elements = foliageInputElementDesc.data();
+		psoDesc.inputLayout.numElements = (unsigned)foliageInputElementDesc.size();
+		psoDesc.vs = m_foliageShader.vs;
+		psoDesc.ps = m_foliageShader.ps;
+		// leaves are two sided
+		psoDesc.rasterization = gxapi::RasterizerState(gxapi::eFillMode::SOLID, gxapi::eCullMode::DRAW_ALL);
+
+		m_foliagePSO.reset(context.CreatePSO(psoDesc));
 	}
+
+	m_foliageChanged = UpdateFoliageCasters(context);
 }
 
 
@@ -180,72 +267,410 @@ void CSM::Execute(RenderContext & context) {
 	GraphicsCommandList& commandList = context.AsGraphics();
 
 	assert(m_dsvs.size() > 0);
+	assert(m_suns->Size() > 0);
+
+	const PerspectiveCamera* perspectiveCamera = dynamic_cast<const PerspectiveCamera*>(m_camera);
+	if (perspectiveCamera == nullptr) {
+		throw std::invalid_argument("[CSM] Shadows only work with perspective camera.");
+	}
+	const DirectionalLight* sun = *m_suns->begin();
+
+	mathfu::Matrix4x4f view = perspectiveCamera->GetViewMatrixRH();
+	mathfu::Matrix4x4f projection = perspectiveCamera->GetProjectionMatrixRH();
+
+	ShadowCascadeView cascadeView;
+	cascadeView.position = perspectiveCamera->GetPosition();
+	cascadeView.lookDirection = perspectiveCamera->GetLookDirection().Normalized();
+	cascadeView.upVector = perspectiveCamera->GetUpVector().Normalized();
+	cascadeView.tanHalfFovX = 1.0f / projection(0, 0);
+	cascadeView.tanHalfFovY = 1.0f / projection(1, 1);
+	cascadeView.nearPlane = perspectiveCamera->GetNearPlane();
+	cascadeView.farPlane = perspectiveCamera->GetFarPlane();
+	m_fitter.Update(cascadeView, sun->GetDirection().Normalized());
+
+	// decide what to redraw
+	const bool staticCastersChanged = UpdateStaticCasters() || m_foliageChanged;
+	const unsigned numCascades = m_fitter.GetCascadeCount();
+	m_staticCacheValid.resize(numCascades, false);
+	m_framesSinceUpdate.resize(numCascades, 0);
+
+	std::array<bool, NUM_CASCADES> redrawStatic;
+	std::array<bool, NUM_CASCADES> redrawDynamic;
+	bool anyStatic = false;
+	bool anyDynamic = false;
+	for (unsigned cascadeIdx = 0; cascadeIdx < numCascades; ++cascadeIdx) {
+		const ShadowCascade& cascade = m_fitter.GetCascade(cascadeIdx);
+		redrawStatic[cascadeIdx] = cascade.refit || staticCastersChanged || !m_staticCacheValid[cascadeIdx];
+		redrawDynamic[cascadeIdx] = redrawStatic[cascadeIdx]
+			|| ++m_framesSinceUpdate[cascadeIdx] >= m_fitter.GetDesc().updateIntervals[cascadeIdx];
+		if (redrawDynamic[cascadeIdx]) {
+			m_framesSinceUpdate[cascadeIdx] = 0;
+		}
+		anyStatic = anyStatic || redrawStatic[cascadeIdx];
+		anyDynamic = anyDynamic || redrawDynamic[cascadeIdx];
+	}
+
+	// matrices for the forward pass, shadow matrices go from view space to shadow map
+	MatricesUniforms matricesCBData;
+	mathfu::Matrix4x4f  bias_matrix(	0.5f,	0,		0,		0,			// column #1
+										0,		-0.5f,	0,		0,			// column #2
+										0,		0,		1.0f,	0,			// column #3
+										0.5f,	0.5f,	0.0f,	1);	// column #4
+	mathfu::Matrix4x4f invView = view.Inverse();
+	for (unsigned cascadeIdx = 0; cascadeIdx < numCascades; ++cascadeIdx) {
+		const ShadowCascade& cascade = m_fitter.GetCascade(cascadeIdx);
+		mathfu::Matrix4x4f lightMVP = cascade.GetViewProjection();
+		lightMVP.Pack(matricesCBData.lightMVP[cascadeIdx]);
+		(bias_matrix * lightMVP * invView).Pack(matricesCBData.shadowMX[cascadeIdx]);
+		matricesCBData.splits[cascadeIdx] = mathfu::Vector4f(cascade.nearSplit, cascade.farSplit, 0.0f, 0.0f);
+	}
+
+	gxeng::VolatileConstBuffer cb = context.CreateVolatileConstBuffer(&matricesCBData, sizeof(MatricesUniforms));
+	cb._GetResourcePtr()->SetName("CSM matrices volatile CB");
+	gxeng::ConstBufferView cbv = context.CreateCbv(cb, 0, sizeof(MatricesUniforms));
+	cbv.GetResource()._GetResourcePtr()->SetName("CSM matrices CBV");
+
+	commandList.SetResourceState(m_lightMVPUav.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS);
+	commandList.SetResourceState(m_shadowMXUav.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS);
+	commandList.SetResourceState(m_csmSplitsUav.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS);
+
+	commandList.SetPipelineState(m_matricesCSO.get());
+	commandList.SetComputeBinder(&m_matricesBinder.value());
+	commandList.BindCompute(m_matricesUniformsBindParam, cbv);
+	commandList.BindCompute(m_outputBindParam0, m_lightMVPUav);
+	commandList.BindCompute(m_outputBindParam1, m_shadowMXUav);
+	commandList.BindCompute(m_outputBindParam2, m_csmSplitsUav);
+	commandList.Dispatch(1, 1, 1);
+	commandList.UAVBarrier(m_lightMVPUav.GetResource());
+	commandList.UAVBarrier(m_shadowMXUav.GetResource());
+	commandList.UAVBarrier(m_csmSplitsUav.GetResource());
+
+	if (!anyDynamic) {
+		return;
+	}
 
 	Texture2D cascadeTextures = m_dsvs[0].GetResource();
-	const uint16_t numCascades = m_dsvs.size();
 	const uint64_t cascadeWidth = cascadeTextures.GetWidth();
 	const uint64_t cascadeHeight = cascadeTextures.GetHeight();
 
 	gxapi::Rectangle rect{ 0, (int)cascadeTextures.GetHeight(), 0, (int)cascadeTextures.GetWidth() };
 	commandList.SetScissorRects(1, &rect);
 
-	commandList.SetPipelineState(m_PSO.get());
+	gxapi::Viewport viewport;
+	viewport.height = (float)cascadeHeight;
+	viewport.width = (float)cascadeWidth;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	viewport.topLeftY = 0;
+	viewport.topLeftX = 0;
+	commandList.SetViewports(1, &viewport);
+
 	commandList.SetGraphicsBinder(&m_binder.value());
 	commandList.SetPrimitiveTopology(gxapi::ePrimitiveTopology::TRIANGLELIST);
 
-	commandList.SetResourceState(m_lightMVPTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-	commandList.BindGraphics(m_lightMVPBindParam, m_lightMVPTexSrv);
+	// static casters into the cache
+	if (anyStatic) {
+		commandList.SetResourceState(m_staticCache, gxapi::eResourceState::DEPTH_WRITE, gxapi::ALL_SUBRESOURCES);
+		for (unsigned cascadeIdx = 0; cascadeIdx < numCascades; ++cascadeIdx) {
+			if (!redrawStatic[cascadeIdx]) {
+				continue;
+			}
+			commandList.SetRenderTargets(0, nullptr, &m_staticDsvs[cascadeIdx]);
+			commandList.ClearDepthStencil(m_staticDsvs[cascadeIdx], 1, 0, 0, nullptr, true, true);
+			DrawCasters(commandList, m_fitter.GetCascade(cascadeIdx), true);
+			DrawFoliageCasters(commandList, m_fitter.GetCascade(cascadeIdx));
+			m_staticCacheValid[cascadeIdx] = true;
+		}
+	}
+
+	// cached static depth is the starting point of the cascades that are redrawn
+	const bool hasStaticCasters = !m_staticCasters.empty() || !m_foliageBatches.empty();
+	if (hasStaticCasters) {
+		commandList.SetResourceState(m_staticCache, gxapi::eResourceState::COPY_SOURCE, gxapi::ALL_SUBRESOURCES);
+		commandList.SetResourceState(cascadeTextures, gxapi::eResourceState::COPY_DEST, gxapi::ALL_SUBRESOURCES);
+		for (unsigned cascadeIdx = 0; cascadeIdx < numCascades; ++cascadeIdx) {
+			if (redrawDynamic[cascadeIdx]) {
+				commandList.CopyTexture(cascadeTextures, m_staticCache, SubTexture2D(0, cascadeIdx), SubTexture2D(0, cascadeIdx));
+			}
+		}
+	}
+
+	// dynamic casters on top
+	commandList.SetResourceState(cascadeTextures, gxapi::eResourceState::DEPTH_WRITE, gxapi::ALL_SUBRESOURCES);
+	for (unsigned cascadeIdx = 0; cascadeIdx < numCascades; ++cascadeIdx) {
+		if (!redrawDynamic[cascadeIdx]) {
+			continue;
+		}
+		commandList.SetRenderTargets(0, nullptr, &m_dsvs[cascadeIdx]);
+		if (!hasStaticCasters) {
+			commandList.ClearDepthStencil(m_dsvs[cascadeIdx], 1, 0, 0, nullptr, true, true);
+		}
+		DrawCasters(commandList, m_fitter.GetCascade(cascadeIdx), false);
+	}
+}
+
 
+void CSM::DrawCasters(GraphicsCommandList& commandList, const ShadowCascade& cascade, bool staticCasters) {
 	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
 	std::vector<unsigned> sizes;
 	std::vector<unsigned> strides;
 
-	commandList.SetResourceState(cascadeTextures, gxapi::eResourceState::DEPTH_WRITE, gxapi::ALL_SUBRESOURCES);
-	for (int cascadeIdx = 0; cascadeIdx < numCascades; ++cascadeIdx) {
-		commandList.SetRenderTargets(0, nullptr, &m_dsvs[cascadeIdx]);
-		commandList.ClearDepthStencil(m_dsvs[cascadeIdx], 1, 0, 0, nullptr, true, true);
-
-		gxapi::Viewport viewport;
-		viewport.height = (float)cascadeHeight;
-		viewport.width = (float)cascadeWidth;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-		viewport.topLeftY = 0;
-		viewport.topLeftX = 0;
-		commandList.SetViewports(1, &viewport);
-
-		// Iterate over all entities
-		for (const MeshEntity* entity : *m_entities) {
-			// Get entity parameters
-			Mesh* mesh = entity->GetMesh();
-			auto position = entity->GetPosition();
-
-			// Draw mesh
-			if (!CheckMeshFormat(*mesh)) {
-				assert(false);
-				continue;
-			}
+	mathfu::Matrix4x4f viewProjection = cascade.GetViewProjection();
+
+	commandList.SetPipelineState(m_PSO.get());
+
+	for (const MeshEntity* entity : *m_entities) {
+		if (entity->IsStatic() != staticCasters) {
+			continue;
+		}
+
+		// Get entity parameters
+		Mesh* mesh = entity->GetMesh();
+
+		if (!CheckMeshFormat(*mesh)) {
+			assert(false);
+			continue;
+		}
+
+		// positions are quantized, the decoding is folded into the transform
+		mathfu::Matrix4x4f model = entity->GetTransform() * mesh->GetPositionDecodeMatrix();
+
+		mathfu::Vector3f minimum, maximum;
+		GetWorldBounds(model, minimum, maximum);
+		if (!cascade.IsCasterVisible(minimum, maximum)) {
+			continue;
+		}
+
+		// Draw mesh
+		ConvertToSubmittable(mesh, 1, vertexBuffers, sizes, strides);
+
+		Uniforms uniformsCBData;
+		(viewProjection * model).Pack(uniformsCBData.mvp);
+
+		commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(uniformsCBData));
+
+		for (auto& vb : vertexBuffers) {
+			commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+		}
+		commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
+
+		commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
+		commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
+		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+	}
+}
 
-			ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
 
-			mathfu::Matrix4x4f model = entity->GetTransform();
+void CSM::DrawFoliageCasters(GraphicsCommandList& commandList, const ShadowCascade& cascade) {
+	if (m_foliageBatches.empty()) {
+		return;
+	}
+
+	commandList.SetPipelineState(m_foliagePSO.get());
+	commandList.SetResourceState(m_foliageInstanceBuffer, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
 
-			Uniforms uniformsCBData;
-			model.Pack(uniformsCBData.model);
+	Uniforms uniformsCBData;
+	cascade.GetViewProjection().Pack(uniformsCBData.mvp);
 
-			uniformsCBData.cascadeIDX = cascadeIdx;
+	const Mesh* boundMesh = nullptr;
+	for (const FoliageBatch& batch : m_foliageBatches) {
+		if (!cascade.IsCasterVisible(batch.minimum, batch.maximum)) {
+			continue;
+		}
 
+		const Mesh* mesh = batch.mesh;
+		if (mesh != boundMesh) {
+			boundMesh = mesh;
+
+			const PositionQuantization& bounds = mesh->GetPositionQuantization();
+			uniformsCBData.positionScale = mathfu::Vector4f(bounds.scale, 0.0f);
+			uniformsCBData.positionOffset = mathfu::Vector4f(bounds.offset, 0.0f);
 			commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(uniformsCBData));
 
-			for (auto& vb : vertexBuffers) {
-				commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
-			}
+			const VertexBuffer* vertexBuffers[2] = { &mesh->GetVertexBuffer(Mesh::POSITION_STREAM), &m_foliageInstanceBuffer };
+			unsigned sizes[2] = { (unsigned)vertexBuffers[0]->GetSize(), (unsigned)(m_foliageInstanceCapacity * sizeof(FoliageInstance)) };
+			unsigned strides[2] = { (unsigned)mesh->GetVertexBufferStride(Mesh::POSITION_STREAM), sizeof(FoliageInstance) };
+			commandList.SetResourceState(*vertexBuffers[0], gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
 			commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
 
-			commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
+			commandList.SetVertexBuffers(0, 2, vertexBuffers, sizes, strides);
 			commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-			commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
 		}
+
+		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount(), 0, 0, batch.numInstances, batch.firstInstance);
+	}
+}
+
+
+bool CSM::UpdateStaticCasters() {
+	// comparing the whole list every frame is cheap, and catches static entities that were added, removed or moved
+	bool changed = false;
+	size_t count = 0;
+	for (const MeshEntity* entity : *m_entities) {
+		if (!entity->IsStatic()) {
+			continue;
+		}
+
+		StaticCaster current{ entity, entity->GetMesh(), entity->GetTransform() };
+		if (count == m_staticCasters.size()) {
+			m_staticCasters.push_back(current);
+			changed = true;
+		}
+		else {
+			StaticCaster& previous = m_staticCasters[count];
+			bool same = previous.entity == current.entity && previous.mesh == current.mesh;
+			for (int i = 0; i < 16 && same; ++i) {
+				same = previous.transform[i] == current.transform[i];
+			}
+			if (!same) {
+				previous = current;
+				changed = true;
+			}
+		}
+		++count;
+	}
+	if (count != m_staticCasters.size()) {
+		m_staticCasters.resize(count);
+		changed = true;
+	}
+	return changed;
+}
+
+
+bool CSM::UpdateFoliageCasters(SetupContext& context) {
+	// instances can only be added or removed through the entity, which bumps its version
+	bool changed = false;
+	size_t count = 0;
+	if (m_foliage != nullptr) {
+		for (const FoliageEntity* entity : *m_foliage) {
+			if (entity->GetMesh() == nullptr) {
+				continue;
+			}
+
+			FoliageCaster current{ entity, entity->GetMesh(), entity->GetVersion() };
+			if (count == m_foliageCasters.size()) {
+				m_foliageCasters.push_back(current);
+				changed = true;
+			}
+			else {
+				FoliageCaster& previous = m_foliageCasters[count];
+				if (previous.entity != current.entity || previous.mesh != current.mesh || previous.version != current.version) {
+					previous = current;
+					changed = true;
+				}
+			}
+			++count;
+		}
+	}
+	if (count != m_foliageCasters.size()) {
+		m_foliageCasters.resize(count);
+		changed = true;
+	}
+	if (!changed) {
+		return false;
+	}
+
+	// chunks are culled against the cascades one by one, their instances are laid out next to each other
+	m_foliageBatches.clear();
+	std::vector<FoliageInstance> instances;
+	for (const FoliageCaster& caster : m_foliageCasters) {
+		if (!CheckMeshFormat(*caster.mesh)) {
+			assert(false);
+			continue;
+		}
+
+		const PositionQuantization& bounds = caster.mesh->GetPositionQuantization();
+		for (const FoliageChunk& chunk : caster.entity->GetChunks()) {
+			if (chunk.instances.empty()) {
+				continue;
+			}
+
+			FoliageBatch batch;
+			batch.mesh = caster.mesh;
+			GetFoliageChunkBounds(chunk, bounds.offset, bounds.offset + bounds.scale, batch.minimum, batch.maximum);
+			batch.firstInstance = (unsigned)instances.size();
+			batch.numInstances = (unsigned)chunk.instances.size();
+			instances.insert(instances.end(), chunk.instances.begin(), chunk.instances.end());
+			m_foliageBatches.push_back(batch);
+		}
+	}
+
+	// the buffer only grows
+	if (instances.size() > m_foliageInstanceCapacity) {
+		size_t capacity = std::max<size_t>(m_foliageInstanceCapacity, 1024);
+		while (capacity < instances.size()) {
+			capacity *= 2;
+		}
+		size_t numInstances = instances.size();
+		instances.resize(capacity);
+		m_foliageInstanceBuffer = context.CreateVertexBuffer(instances.data(), capacity * sizeof(FoliageInstance));
+		m_foliageInstanceBuffer._GetResourcePtr()->SetName("CSM foliage instance buffer");
+		instances.resize(numInstances);
+		m_foliageInstanceCapacity = capacity;
+	}
+	else if (!instances.empty()) {
+		context.Upload(m_foliageInstanceBuffer, 0, instances.data(), instances.size() * sizeof(FoliageInstance));
+	}
+	return true;
+}
+
+
+void CSM::InitStaticCache(SetupContext& context, const Texture2D& renderTarget, gxapi::eFormat depthStencilFormat) {
+	if (m_staticCache.HasObject()
+		&& m_staticCache.GetWidth() == renderTarget.GetWidth()
+		&& m_staticCache.GetHeight() == renderTarget.GetHeight()
+		&& m_staticCache.GetFormat() == renderTarget.GetFormat()
+		&& m_staticCache.GetArrayCount() == renderTarget.GetArrayCount())
+	{
+		return;
+	}
+
+	m_staticCache = context.CreateDepthStencil2D(renderTarget.GetWidth(), renderTarget.GetHeight(), renderTarget.GetFormat(), false, renderTarget.GetArrayCount());
+	m_staticCache._GetResourcePtr()->SetName("CSM static caster cache");
+
+	gxapi::DsvTexture2DArray dsvDesc;
+	dsvDesc.activeArraySize = 1;
+	dsvDesc.firstMipLevel = 0;
+	m_staticDsvs.resize(renderTarget.GetArrayCount());
+	for (int i = 0; i < m_staticDsvs.size(); i++) {
+		dsvDesc.firstArrayElement = i;
+		m_staticDsvs[i] = context.CreateDsv(m_staticCache, depthStencilFormat, dsvDesc);
+	}
+	m_staticCacheValid.assign(renderTarget.GetArrayCount(), false);
+}
+
+
+void CSM::InitRenderTarget(SetupContext& context) {
+	if (!m_outputTexturesInited) {
+		m_outputTexturesInited = true;
+
+		using gxapi::eFormat;
+
+		auto formatLightMVP = eFormat::R32G32B32A32_FLOAT;
+		auto formatShadowMX = eFormat::R32G32B32A32_FLOAT;
+		auto formatCSMSplits = eFormat::R32G32_FLOAT;
+
+		gxapi::UavTexture2DArray uavDesc;
+		uavDesc.activeArraySize = 1;
+		uavDesc.firstArrayElement = 0;
+		uavDesc.mipLevel = 0;
+		uavDesc.planeIndex = 0;
+
+		//TODO 1D tex
+		Texture2D light_mvp_tex = context.CreateRWTexture2D(NUM_CASCADES * 4, 1, formatLightMVP, 1);
+		light_mvp_tex._GetResourcePtr()->SetName("CSM light MVP tex");
+		m_lightMVPUav = context.CreateUav(light_mvp_tex, formatLightMVP, uavDesc);
+		m_lightMVPUav.GetResource()._GetResourcePtr()->SetName("CSM light MVP UAV");
+
+		Texture2D shadow_mx_tex = context.CreateRWTexture2D(NUM_CASCADES * 4, 1, formatShadowMX, 1);
+		shadow_mx_tex._GetResourcePtr()->SetName("CSM shadow MX tex");
+		m_shadowMXUav = context.CreateUav(shadow_mx_tex, formatShadowMX, uavDesc);
+		m_shadowMXUav.GetResource()._GetResourcePtr()->SetName("CSM shadow MX UAV");
+
+		Texture2D csm_splits_tex = context.CreateRWTexture2D(NUM_CASCADES, 1, formatCSMSplits, 1);
+		csm_splits_tex._GetResourcePtr()->SetName("CSM splits tex");
+		m_csmSplitsUav = context.CreateUav(csm_splits_tex, formatCSMSplits, uavDesc);
+		m_csmSplitsUav.GetResource()._GetResourcePtr()->SetName("CSM splits UAV");
 	}
 }
 
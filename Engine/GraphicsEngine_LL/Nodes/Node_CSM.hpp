@@ -5,8 +5,10 @@
 #include "../Scene.hpp"
 #include "../PerspectiveCamera.hpp"
 #include "../Mesh.hpp"
+#include "../FoliageEntity.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "../ShadowCascades.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -15,14 +17,18 @@
 namespace inl::gxeng::nodes {
 
 /// <summary>
-/// Inputs: render target, scene objects, light cascade MVP transform matrices in a texture
-/// Output: render target
+/// Renders the cascaded shadow maps of the sun. Cascades are fitted on the CPU and casters are culled against each of them.
+/// Static casters are drawn into a cache that is only redrawn when its cascade is refitted or static entities change,
+/// dynamic casters are drawn over a copy of the cache, in far cascades only every few frames.
+/// Foliage is cast as static, with all its instances drawn as meshes regardless of the impostor distance.
+/// Inputs: depth target with one array slice per cascade, scene objects, camera, directional lights, foliage entities (optional)
+/// Outputs: depth target, light MVP matrices, shadow matrices (view space to shadow map), cascade splits
 /// </summary>
 class CSM :
 	virtual public GraphicsNode,
 	virtual public GraphicsTask,
-	virtual public exc::InputPortConfig<Texture2D, const EntityCollection<MeshEntity>*, Texture2D>,
-	virtual public exc::OutputPortConfig<Texture2D>
+	virtual public exc::InputPortConfig<Texture2D, const EntityCollection<MeshEntity>*, const BasicCamera*, const EntityCollection<DirectionalLight>*, const EntityCollection<FoliageEntity>*>,
+	virtual public exc::OutputPortConfig<Texture2D, Texture2D, Texture2D, Texture2D>
 {
 public:
 	CSM();
@@ -38,17 +44,77 @@ public:
 protected:
 	std::optional<Binder> m_binder;
 	BindParameter m_uniformsBindParam;
-	BindParameter m_lightMVPBindParam;
 	ShaderProgram m_shader;
 	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	ShaderProgram m_foliageShader;
+	std::unique_ptr<gxapi::IPipelineState> m_foliagePSO;
 	gxapi::eFormat m_depthStencilFormat;
 
+	std::optional<Binder> m_matricesBinder;
+	BindParameter m_matricesUniformsBindParam;
+	BindParameter m_outputBindParam0;
+	BindParameter m_outputBindParam1;
+	BindParameter m_outputBindParam2;
+	ShaderProgram m_matricesShader;
+	std::unique_ptr<gxapi::IPipelineState> m_matricesCSO;
+
+protected: // outputs
+	bool m_outputTexturesInited = false;
+	RWTextureView2D m_lightMVPUav;
+	RWTextureView2D m_shadowMXUav;
+	RWTextureView2D m_csmSplitsUav;
+
+protected: // caching across frames
+	struct StaticCaster {
+		const MeshEntity* entity;
+		const Mesh* mesh;
+		mathfu::Matrix4x4f transform;
+	};
+
+	ShadowCascadeFitter m_fitter;
+	Texture2D m_staticCache;
+	std::vector<DepthStencilView2D> m_staticDsvs;
+	std::vector<bool> m_staticCacheValid;
+	std::vector<unsigned> m_framesSinceUpdate;
+	std::vector<StaticCaster> m_staticCasters;
+	const gxapi::IResource* m_lastRenderTarget = nullptr;
+
+protected: // foliage, uploaded only when it changes
+	struct FoliageCaster {
+		const FoliageEntity* entity;
+		const Mesh* mesh;
+		uint64_t version;
+	};
+	/// <summary> Instances of a chunk in the instance buffer. </summary>
+	struct FoliageBatch {
+		const Mesh* mesh;
+		mathfu::Vector3f minimum;
+		mathfu::Vector3f maximum;
+		unsigned firstInstance;
+		unsigned numInstances;
+	};
+
+	std::vector<FoliageCaster> m_foliageCasters;
+	std::vector<FoliageBatch> m_foliageBatches;
+	VertexBuffer m_foliageInstanceBuffer;
+	size_t m_foliageInstanceCapacity = 0;
+	bool m_foliageChanged = false;
+
 private: // render context
 	std::vector<DepthStencilView2D> m_dsvs;
 	const EntityCollection<MeshEntity>* m_entities;
-	TextureView2D m_lightMVPTexSrv;
+	const BasicCamera* m_camera;
+	const EntityCollection<DirectionalLight>* m_suns;
+	const EntityCollection<FoliageEntity>* m_foliage;
+
+private:
+	void InitRenderTarget(SetupContext& context);
+	void InitStaticCache(SetupContext& context, const Texture2D& renderTarget, gxapi::eFormat depthStencilFormat);
+	bool UpdateStaticCasters();
+	bool UpdateFoliageCasters(SetupContext& context);
+	void DrawCasters(GraphicsCommandList& commandList, const ShadowCascade& cascade, bool staticCasters);
+	void DrawFoliageCasters(GraphicsCommandList& commandList, const ShadowCascade& cascade);
 };
 
 
 } // namespace inl::gxeng::nodes
-
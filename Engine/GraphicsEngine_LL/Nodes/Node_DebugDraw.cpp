@@ -8,52 +8,17 @@
 #include "../DirectionalLight.hpp"
 #include "../GraphicsCommandList.hpp"
 
-#include "DebugDrawManager.hpp"
-
-#include <array>
+#include <algorithm>
+#include <cstddef>
 
 namespace inl::gxeng::nodes {
 
 struct Uniforms
 {
 	mathfu::VectorPacked<float, 4> vp[4];
-	mathfu::VectorPacked<float, 4> color;
 };
 
 
-static bool CheckMeshFormat(const Mesh& mesh) {
-	for (size_t i = 0; i < mesh.GetNumStreams(); i++) {
-		auto& elements = mesh.GetLayout()[0];
-		if (elements.size() != 3) return false;
-		if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
-		if (elements[1].semantic != eVertexElementSemantic::NORMAL) return false;
-		if (elements[2].semantic != eVertexElementSemantic::TEX_COORD) return false;
-	}
-
-	return true;
-}
-
-
-static void ConvertToSubmittable(
-	Mesh* mesh,
-	std::vector<const gxeng::VertexBuffer*>& vertexBuffers,
-	std::vector<unsigned>& sizes,
-	std::vector<unsigned>& strides
-) {
-	vertexBuffers.clear();
-	sizes.clear();
-	strides.clear();
-
-	for (int streamID = 0; streamID < mesh->GetNumStreams(); streamID++) {
-		vertexBuffers.push_back(&mesh->GetVertexBuffer(streamID));
-		sizes.push_back((unsigned)vertexBuffers.back()->GetSize());
-		strides.push_back((unsigned)mesh->GetVertexBufferStride(streamID));
-	}
-
-	assert(vertexBuffers.size() == sizes.size());
-	assert(sizes.size() == strides.size());
-}
-
 DebugDraw::DebugDraw() {}
 
 void DebugDraw::Initialize(EngineContext & context) {
@@ -106,7 +71,7 @@ void DebugDraw::Setup(SetupContext& context) {
 		m_binder = context.CreateBinder({ uniformsBindParamDesc }, { samplerDesc });
 	}
 
-	if (!m_LinePSO || !m_TrianglePSO) {
+	if (!m_LinePSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -115,6 +80,7 @@ void DebugDraw::Setup(SetupContext& context) {
 
 		std::vector<gxapi::InputElementDesc> inputElementDesc = {
 			gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
+			gxapi::InputElementDesc("COLOR", 0, gxapi::eFormat::R8G8B8A8_UNORM, 0, offsetof(DebugVertex, color)),
 		};
 
 		gxapi::GraphicsPipelineStateDesc psoDesc;
@@ -132,41 +98,34 @@ void DebugDraw::Setup(SetupContext& context) {
 		psoDesc.renderTargetFormats[0] = renderTarget.GetFormat();
 
 		m_LinePSO.reset(context.CreatePSO(psoDesc));
-
-		psoDesc.primitiveTopologyType = gxapi::ePrimitiveTopologyType::TRIANGLE;
-		m_TrianglePSO.reset(context.CreatePSO(psoDesc));
 	}
 
-	m_objects.resize(DebugDrawManager::GetInstance().GetObjects().size());
-
-	for (int c = 0; c < DebugDrawManager::GetInstance().GetObjects().size(); ++c) {
-		const std::shared_ptr<DebugObject>& currObject = DebugDrawManager::GetInstance().GetObjects()[c];
-
-		//if there's no allocated vertex buffer and the object is alive, then allocate and fill vertex buffer
-		if (currObject && currObject->IsAlive()) {
-
-			// if the vertex buffer for the current object has not been created yet...
-			if (m_objects[c].first.lock() != currObject) {
-				m_objects[c].first = currObject;
-				std::vector<mathfu::Vector3f> vertices;
-				std::vector<uint32_t> indices;
-				currObject->GetMesh(vertices, indices);
-				m_objects[c].second.vertexBuffer = context.CreateVertexBuffer(vertices.data(), vertices.size() * sizeof(mathfu::Vector3f));
-				m_objects[c].second.indexBuffer = context.CreateIndexBuffer(indices.data(), indices.size() * sizeof(uint32_t), indices.size());
-				m_objects[c].second.size = (unsigned)(m_objects[c].second.vertexBuffer.GetSize());
-				m_objects[c].second.stride = currObject->GetStride();
-			}
-		}
-		else {
-			m_objects[c].first.reset();
-			m_objects[c].second.vertexBuffer = {};
-			m_objects[c].second.indexBuffer = {};
+	// lines of all threads go into one buffer, which only grows
+	m_vertices.clear();
+	DebugDrawManager::GetInstance().MergeFrame(m_vertices);
+
+	if (m_vertices.size() > m_vertexCapacity) {
+		size_t capacity = std::max<size_t>(m_vertexCapacity, 1024);
+		while (capacity < m_vertices.size()) {
+			capacity *= 2;
 		}
+		size_t numVertices = m_vertices.size();
+		m_vertices.resize(capacity);
+		m_vertexBuffer = context.CreateVertexBuffer(m_vertices.data(), capacity * sizeof(DebugVertex));
+		m_vertices.resize(numVertices);
+		m_vertexCapacity = capacity;
+	}
+	else if (!m_vertices.empty()) {
+		context.Upload(m_vertexBuffer, 0, m_vertices.data(), m_vertices.size() * sizeof(DebugVertex));
 	}
 }
 
 
 void DebugDraw::Execute(RenderContext& context) {
+	if (m_vertices.empty()) {
+		return;
+	}
+
 	GraphicsCommandList& commandList = context.AsGraphics();
 
 	gxapi::Rectangle rect{ 0, (int)m_target.GetResource().GetHeight(), 0, (int)m_target.GetResource().GetWidth() };
@@ -199,28 +158,14 @@ void DebugDraw::Execute(RenderContext& context) {
 
 	viewProjection.Pack(uniformsCBData.vp);
 
-	for (auto& currObject : m_objects) {
-		auto& vb = currObject.second.vertexBuffer;
-		auto& ib = currObject.second.indexBuffer;
-
-		if (currObject.first.expired() || !vb.HasObject() || !ib.HasObject()) {
-			continue;
-		}
-
-		commandList.SetResourceState(vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
-		commandList.SetResourceState(ib, gxapi::eResourceState::INDEX_BUFFER);
-
-		mathfu::Vector4f(currObject.first.lock()->GetColor(), 1.0f).Pack(&uniformsCBData.color);
-
-		commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(uniformsCBData));
-
-		VertexBuffer* vbPtr = &vb;
-		commandList.SetVertexBuffers(0, 1, &vbPtr, &currObject.second.size, &currObject.second.stride);
-		commandList.SetIndexBuffer(&currObject.second.indexBuffer, true);
-		commandList.DrawIndexedInstanced(currObject.second.indexBuffer.GetIndexCount());
-	}
+	commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(uniformsCBData));
 
-	DebugDrawManager::GetInstance().Update();
+	VertexBuffer* vbPtr = &m_vertexBuffer;
+	unsigned size = (unsigned)(m_vertices.size() * sizeof(DebugVertex));
+	unsigned stride = sizeof(DebugVertex);
+	commandList.SetResourceState(m_vertexBuffer, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+	commandList.SetVertexBuffers(0, 1, &vbPtr, &size, &stride);
+	commandList.DrawInstanced((unsigned)m_vertices.size());
 }
 
 
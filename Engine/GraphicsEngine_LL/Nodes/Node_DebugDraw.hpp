@@ -7,16 +7,19 @@
 #include "../Mesh.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "DebugDrawManager.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace inl::gxeng::nodes {
 
 /// <summary>
-/// Inputs: render target, scene objects, light cascade MVP transform matrices in a texture
+/// Draws the lines collected by the DebugDrawManager from a single vertex buffer in one call.
+/// Inputs: render target, camera
 /// Output: render target
 /// </summary>
 class DebugDraw :
@@ -41,24 +44,11 @@ protected:
 	BindParameter m_uniformsBindParam;
 	ShaderProgram m_shader;
 	std::unique_ptr<gxapi::IPipelineState> m_LinePSO;
-	std::unique_ptr<gxapi::IPipelineState> m_TrianglePSO;
 
 private:
-	void BuildVertexBuffers();
-
-private:
-	struct MeshData {
-		gxeng::VertexBuffer vertexBuffer;
-		gxeng::IndexBuffer indexBuffer;
-		unsigned size;
-		unsigned stride;
-	};
-
-	std::vector<std::pair<std::weak_ptr<DebugObject>, MeshData>> m_objects;
-	//std::vector<gxeng::VertexBuffer> m_vertexBuffers;
-	//std::vector<gxeng::IndexBuffer> m_indexBuffers;
-	//std::vector<unsigned> m_sizes;
-	//std::vector<unsigned> m_strides;
+	std::vector<DebugVertex> m_vertices;
+	VertexBuffer m_vertexBuffer;
+	size_t m_vertexCapacity = 0;
 
 private: // render context
 	RenderTargetView2D m_target;
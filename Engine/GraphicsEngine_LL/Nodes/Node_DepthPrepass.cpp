@@ -14,13 +14,11 @@ namespace inl::gxeng::nodes {
 
 
 static bool CheckMeshFormat(const Mesh& mesh) {
-	for (size_t i = 0; i < mesh.GetNumStreams(); i++) {
-		auto& elements = mesh.GetLayout()[0];
-		if (elements.size() != 3) return false;
-		if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
-		if (elements[1].semantic != eVertexElementSemantic::NORMAL) return false;
-		if (elements[2].semantic != eVertexElementSemantic::TEX_COORD) return false;
-	}
+	// only the position stream is used
+	if (mesh.GetNumStreams() <= Mesh::POSITION_STREAM) return false;
+	auto& elements = mesh.GetLayout()[Mesh::POSITION_STREAM];
+	if (elements.size() != 1) return false;
+	if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
 
 	return true;
 }
@@ -28,6 +26,7 @@ static bool CheckMeshFormat(const Mesh& mesh) {
 
 static void ConvertToSubmittable(
 	Mesh* mesh,
+	size_t numStreams,
 	std::vector<const gxeng::VertexBuffer*>& vertexBuffers,
 	std::vector<unsigned>& sizes,
 	std::vector<unsigned>& strides
@@ -36,7 +35,8 @@ static void ConvertToSubmittable(
 	sizes.clear();
 	strides.clear();
 
-	for (int streamID = 0; streamID < mesh->GetNumStreams(); streamID++) {
+	assert(numStreams <= mesh->GetNumStreams());
+	for (int streamID = 0; streamID < numStreams; streamID++) {
 		vertexBuffers.push_back(&mesh->GetVertexBuffer(streamID));
 		sizes.push_back((unsigned)vertexBuffers.back()->GetSize());
 		strides.push_back((unsigned)mesh->GetVertexBufferStride(streamID));
@@ -126,9 +126,7 @@ void DepthPrepass::Setup(SetupContext & context) {
 		m_depthStencilFormat = currDepthStencilFormat;
 
 		std::vector<gxapi::InputElementDesc> inputElementDesc = {
-			gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-			gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-			gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
+			gxapi::InputElementDesc("POSITION", 0, VertexElementCompressor<eVertexElementSemantic::POSITION>::Format(), Mesh::POSITION_STREAM, 0),
 		};
 
 		gxapi::GraphicsPipelineStateDesc psoDesc;
@@ -198,9 +196,10 @@ void DepthPrepass::Execute(RenderContext & context) {
 			continue;
 		}
 
-		ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
+		ConvertToSubmittable(mesh, 1, vertexBuffers, sizes, strides);
 
-		auto MVP = viewProjection * entity->GetTransform();
+		// positions are quantized, the decoding is folded into the transform
+		auto MVP = viewProjection * entity->GetTransform() * mesh->GetPositionDecodeMatrix();
 
 		std::array<mathfu::VectorPacked<float, 4>, 4> transformCBData;
 		MVP.Pack(transformCBData.data());
@@ -0,0 +1,338 @@
+#include "Node_DrawFoliage.hpp"
+
+#include "NodeUtility.hpp"
+
+#include "../Mesh.hpp"
+#include "../Image.hpp"
+#include "../VertexElementCompressor.hpp"
+#include "../GraphicsCommandList.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+
+namespace inl::gxeng::nodes {
+
+
+struct FoliageConstants {
+	mathfu::VectorPacked<float, 4> viewProjection[4];
+	mathfu::VectorPacked<float, 4> cameraPosition;
+	mathfu::VectorPacked<float, 4> sunDirection; // towards the sun
+	mathfu::VectorPacked<float, 4> sunColor;
+	mathfu::VectorPacked<float, 4> positionScale;
+	mathfu::VectorPacked<float, 4> positionOffset;
+	mathfu::VectorPacked<float, 4> impostor; // half width, bottom, top, number of views
+	mathfu::VectorPacked<float, 4> alphaCutoff;
+};
+
+
+static bool CheckMeshFormat(const Mesh& mesh) {
+	if (mesh.GetNumStreams() != 2) return false;
+
+	auto& positionElements = mesh.GetLayout()[Mesh::POSITION_STREAM];
+	if (positionElements.size() != 1) return false;
+	if (positionElements[0].semantic != eVertexElementSemantic::POSITION) return false;
+
+	auto& attributeElements = mesh.GetLayout()[Mesh::ATTRIBUTE_STREAM];
+	if (attributeElements.size() != 2) return false;
+	if (attributeElements[0].semantic != eVertexElementSemantic::NORMAL) return false;
+	if (attributeElements[1].semantic != eVertexElementSemantic::TEX_COORD) return false;
+
+	return true;
+}
+
+
+DrawFoliage::DrawFoliage() {}
+
+
+void DrawFoliage::Initialize(EngineContext& context) {
+	GraphicsNode::SetTaskSingle(this);
+}
+
+
+void DrawFoliage::Reset() {
+	m_rtv = RenderTargetView2D();
+	m_dsv = DepthStencilView2D();
+	m_camera = nullptr;
+	m_entities = nullptr;
+	m_suns = nullptr;
+
+	GetInput(0)->Clear();
+	GetInput(1)->Clear();
+	GetInput(2)->Clear();
+	GetInput(3)->Clear();
+	GetInput(4)->Clear();
+}
+
+
+void DrawFoliage::Setup(SetupContext& context) {
+	//================================================
+	// Set inputs, outputs
+
+	auto renderTarget = this->GetInput<0>().Get();
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+	m_rtv = context.CreateRtv(renderTarget, renderTarget.GetFormat(), rtvDesc);
+
+	auto depthStencil = this->GetInput<1>().Get();
+	const gxapi::eFormat currDepthStencilFormat = FormatAnyToDepthStencil(depthStencil.GetFormat());
+	gxapi::DsvTexture2DArray dsvDesc;
+	dsvDesc.activeArraySize = 1;
+	dsvDesc.firstArrayElement = 0;
+	dsvDesc.firstMipLevel = 0;
+	m_dsv = context.CreateDsv(depthStencil, currDepthStencilFormat, dsvDesc);
+
+	m_camera = this->GetInput<2>().Get();
+	m_entities = this->GetInput<3>().Get();
+	m_suns = this->GetInput<4>().Get();
+
+	this->GetOutput<0>().Set(renderTarget);
+
+	//================================================
+	// Create binder, shaders and pipeline states if needed
+
+	if (!m_binder.has_value()) {
+		BindParameterDesc constantsBindParamDesc;
+		m_constantsBindParam = BindParameter(eBindParameterType::CONSTANT, 0);
+		constantsBindParamDesc.parameter = m_constantsBindParam;
+		constantsBindParamDesc.constantSize = sizeof(FoliageConstants);
+		constantsBindParamDesc.relativeAccessFrequency = 0;
+		constantsBindParamDesc.relativeChangeFrequency = 0;
+		constantsBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		BindParameterDesc textureBindParamDesc;
+		m_textureBindParam = BindParameter(eBindParameterType::TEXTURE, 0);
+		textureBindParamDesc.parameter = m_textureBindParam;
+		textureBindParamDesc.constantSize = 0;
+		textureBindParamDesc.relativeAccessFrequency = 0;
+		textureBindParamDesc.relativeChangeFrequency = 0;
+		textureBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+
+		BindParameterDesc sampBindParamDesc;
+		sampBindParamDesc.parameter = BindParameter(eBindParameterType::SAMPLER, 0);
+		sampBindParamDesc.constantSize = 0;
+		sampBindParamDesc.relativeAccessFrequency = 0;
+		sampBindParamDesc.relativeChangeFrequency = 0;
+		sampBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+
+		gxapi::StaticSamplerDesc samplerDesc;
+		samplerDesc.shaderRegister = 0;
+		samplerDesc.filter = gxapi::eTextureFilterMode::MIN_MAG_MIP_LINEAR;
+		samplerDesc.addressU = gxapi::eTextureAddressMode::WRAP;
+		samplerDesc.addressV = gxapi::eTextureAddressMode::CLAMP;
+		samplerDesc.addressW = gxapi::eTextureAddressMode::WRAP;
+		samplerDesc.mipLevelBias = 0.f;
+		samplerDesc.registerSpace = 0;
+		samplerDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+
+		m_binder = context.CreateBinder({ constantsBindParamDesc, textureBindParamDesc, sampBindParamDesc }, { samplerDesc });
+	}
+
+	if (!m_meshShader.vs || !m_meshShader.ps) {
+		ShaderParts shaderParts;
+		shaderParts.vs = true;
+		shaderParts.ps = true;
+
+		m_meshShader = context.CreateShader("DrawFoliage", shaderParts, "IMPOSTOR=0");
+		m_impostorShader = context.CreateShader("DrawFoliage", shaderParts, "IMPOSTOR=1");
+	}
+
+	if (m_colorFormat != renderTarget.GetFormat() || m_depthStencilFormat != currDepthStencilFormat) {
+		m_colorFormat = renderTarget.GetFormat();
+		m_depthStencilFormat = currDepthStencilFormat;
+		CreatePipelineStates(context, m_colorFormat, m_depthStencilFormat);
+	}
+
+	//================================================
+	// Cull instances and upload the visible ones
+
+	m_batches.clear();
+	m_instances.clear();
+	if (m_entities == nullptr || m_camera == nullptr) {
+		return;
+	}
+
+	mathfu::Matrix4x4f viewProjection = m_camera->GetProjectionMatrixRH() * m_camera->GetViewMatrixRH();
+	FoliageFrustum frustum = ExtractFoliageFrustum(viewProjection);
+	mathfu::Vector3f cameraPosition = m_camera->GetPosition();
+
+	for (const FoliageEntity* entity : *m_entities) {
+		Mesh* mesh = entity->GetMesh();
+		if (mesh == nullptr || entity->GetTexture() == nullptr) {
+			continue;
+		}
+		if (!CheckMeshFormat(*mesh)) {
+			throw std::invalid_argument("Foliage mesh must have 3 attributes: position, normal, texcoord.");
+		}
+
+		const PositionQuantization& bounds = mesh->GetPositionQuantization();
+		CullFoliage(*entity, bounds.offset, bounds.offset + bounds.scale, frustum, cameraPosition, m_drawList);
+		if (m_drawList.meshInstances.empty() && m_drawList.impostorInstances.empty()) {
+			continue;
+		}
+
+		Batch batch;
+		batch.entity = entity;
+		batch.firstMeshInstance = (unsigned)m_instances.size();
+		batch.numMeshInstances = (unsigned)m_drawList.meshInstances.size();
+		m_instances.insert(m_instances.end(), m_drawList.meshInstances.begin(), m_drawList.meshInstances.end());
+		batch.firstImpostorInstance = (unsigned)m_instances.size();
+		batch.numImpostorInstances = (unsigned)m_drawList.impostorInstances.size();
+		m_instances.insert(m_instances.end(), m_drawList.impostorInstances.begin(), m_drawList.impostorInstances.end());
+		m_batches.push_back(batch);
+	}
+
+	// instances of all entities go into one buffer, which only grows
+	if (m_instances.size() > m_instanceCapacity) {
+		size_t capacity = std::max<size_t>(m_instanceCapacity, 4096);
+		while (capacity < m_instances.size()) {
+			capacity *= 2;
+		}
+		size_t numInstances = m_instances.size();
+		m_instances.resize(capacity);
+		m_instanceBuffer = context.CreateVertexBuffer(m_instances.data(), capacity * sizeof(FoliageInstance));
+		m_instanceBuffer._GetResourcePtr()->SetName("Draw foliage instance buffer");
+		m_instances.resize(numInstances);
+		m_instanceCapacity = capacity;
+	}
+	else if (!m_instances.empty()) {
+		context.Upload(m_instanceBuffer, 0, m_instances.data(), m_instances.size() * sizeof(FoliageInstance));
+	}
+}
+
+
+void DrawFoliage::Execute(RenderContext& context) {
+	if (m_batches.empty()) {
+		return;
+	}
+
+	GraphicsCommandList& commandList = context.AsGraphics();
+
+	auto* pRTV = &m_rtv;
+	commandList.SetResourceState(m_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.SetResourceState(m_dsv.GetResource(), gxapi::eResourceState::DEPTH_WRITE);
+	commandList.SetRenderTargets(1, &pRTV, &m_dsv);
+
+	gxapi::Rectangle rect{ 0, (int)m_rtv.GetResource().GetHeight(), 0, (int)m_rtv.GetResource().GetWidth() };
+	gxapi::Viewport viewport;
+	viewport.width = (float)rect.right;
+	viewport.height = (float)rect.bottom;
+	viewport.topLeftX = 0;
+	viewport.topLeftY = 0;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	commandList.SetScissorRects(1, &rect);
+	commandList.SetViewports(1, &viewport);
+
+	commandList.SetGraphicsBinder(&m_binder.value());
+	commandList.SetPrimitiveTopology(gxapi::ePrimitiveTopology::TRIANGLELIST);
+	commandList.SetResourceState(m_instanceBuffer, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+
+	FoliageConstants constants;
+	mathfu::Matrix4x4f viewProjection = m_camera->GetProjectionMatrixRH() * m_camera->GetViewMatrixRH();
+	viewProjection.Pack(constants.viewProjection);
+	constants.cameraPosition = mathfu::Vector4f(m_camera->GetPosition(), 1.0f);
+	constants.sunDirection = mathfu::Vector4f(0.0f, 0.0f, 1.0f, 0.0f);
+	constants.sunColor = mathfu::Vector4f(1.0f, 1.0f, 1.0f, 1.0f);
+	if (m_suns != nullptr && m_suns->Size() > 0) {
+		const DirectionalLight* sun = *m_suns->begin();
+		constants.sunDirection = mathfu::Vector4f(-sun->GetDirection(), 0.0f);
+		constants.sunColor = mathfu::Vector4f(sun->GetColor(), 1.0f);
+	}
+
+	const VertexBuffer* instanceBuffer = &m_instanceBuffer;
+	unsigned instanceBufferSize = (unsigned)(m_instanceCapacity * sizeof(FoliageInstance));
+	unsigned instanceStride = sizeof(FoliageInstance);
+
+	for (const Batch& batch : m_batches) {
+		const FoliageEntity& entity = *batch.entity;
+		Mesh* mesh = entity.GetMesh();
+
+		// billboards are sized after the mesh's bounds, the same way the culling sees them
+		const PositionQuantization& bounds = mesh->GetPositionQuantization();
+		mathfu::Vector3f meshMinimum = bounds.offset;
+		mathfu::Vector3f meshMaximum = bounds.offset + bounds.scale;
+		float halfWidth = std::max({ std::abs(meshMinimum.x()), std::abs(meshMaximum.x()), std::abs(meshMinimum.y()), std::abs(meshMaximum.y()) });
+		constants.positionScale = mathfu::Vector4f(bounds.scale, 0.0f);
+		constants.positionOffset = mathfu::Vector4f(bounds.offset, 0.0f);
+		constants.impostor = mathfu::Vector4f(halfWidth, meshMinimum.z(), meshMaximum.z(), (float)entity.GetNumImpostorViews());
+		constants.alphaCutoff = mathfu::Vector4f(entity.GetAlphaCutoff(), 0.0f, 0.0f, 0.0f);
+		commandList.BindGraphics(m_constantsBindParam, &constants, sizeof(constants));
+
+		if (batch.numMeshInstances > 0) {
+			const TextureView2D& texture = *entity.GetTexture()->GetSrv();
+			commandList.SetResourceState(texture.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+			commandList.BindGraphics(m_textureBindParam, texture);
+
+			const VertexBuffer* vertexBuffers[3] = { &mesh->GetVertexBuffer(Mesh::POSITION_STREAM), &mesh->GetVertexBuffer(Mesh::ATTRIBUTE_STREAM), instanceBuffer };
+			unsigned sizes[3] = { (unsigned)vertexBuffers[0]->GetSize(), (unsigned)vertexBuffers[1]->GetSize(), instanceBufferSize };
+			unsigned strides[3] = { (unsigned)mesh->GetVertexBufferStride(Mesh::POSITION_STREAM), (unsigned)mesh->GetVertexBufferStride(Mesh::ATTRIBUTE_STREAM), instanceStride };
+			commandList.SetResourceState(*vertexBuffers[0], gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+			commandList.SetResourceState(*vertexBuffers[1], gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+			commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
+
+			commandList.SetPipelineState(m_meshPSO.get());
+			commandList.SetVertexBuffers(0, 3, vertexBuffers, sizes, strides);
+			commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
+			commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount(), 0, 0, batch.numMeshInstances, batch.firstMeshInstance);
+		}
+
+		if (batch.numImpostorInstances > 0) {
+			const TextureView2D& atlas = *entity.GetImpostor()->GetSrv();
+			commandList.SetResourceState(atlas.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+			commandList.BindGraphics(m_textureBindParam, atlas);
+
+			// the quad's corners come from the vertex ID
+			commandList.SetPipelineState(m_impostorPSO.get());
+			commandList.SetVertexBuffers(0, 1, &instanceBuffer, &instanceBufferSize, &instanceStride);
+			commandList.DrawInstanced(6, 0, batch.numImpostorInstances, batch.firstImpostorInstance);
+		}
+	}
+}
+
+
+void DrawFoliage::CreatePipelineStates(SetupContext& context, gxapi::eFormat colorFormat, gxapi::eFormat depthStencilFormat) {
+	constexpr auto PerInstance = gxapi::eInputClassification::INSTANCE_DATA;
+	constexpr unsigned RotationOffset = offsetof(FoliageInstance, rotation);
+
+	std::vector<gxapi::InputElementDesc> meshInputElementDesc = {
+		gxapi::InputElementDesc("POSITION", 0, VertexElementCompressor<eVertexElementSemantic::POSITION>::Format(), Mesh::POSITION_STREAM, 0),
+		gxapi::InputElementDesc("NORMAL", 0, VertexElementCompressor<eVertexElementSemantic::NORMAL>::Format(), Mesh::ATTRIBUTE_STREAM, 0),
+		gxapi::InputElementDesc("TEX_COORD", 0, VertexElementCompressor<eVertexElementSemantic::TEX_COORD>::Format(), Mesh::ATTRIBUTE_STREAM, 4),
+		gxapi::InputElementDesc("INSTANCE_POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 2, 0, PerInstance, 1),
+		gxapi::InputElementDesc("INSTANCE_ROTATION_SCALE", 0, gxapi::eFormat::R32G32_FLOAT, 2, RotationOffset, PerInstance, 1),
+	};
+	std::vector<gxapi::InputElementDesc> impostorInputElementDesc = {
+		gxapi::InputElementDesc("INSTANCE_POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0, PerInstance, 1),
+		gxapi::InputElementDesc("INSTANCE_ROTATION_SCALE", 0, gxapi::eFormat::R32G32_FLOAT, 0, RotationOffset, PerInstance, 1),
+	};
+
+	gxapi::GraphicsPipelineStateDesc psoDesc;
+	psoDesc.inputLayout.elements = meshInputElementDesc.data();
+	psoDesc.inputLayout.numElements = (unsigned)meshInputElementDesc.size();
+	psoDesc.rootSignature = m_binder->GetRootSignature();
+	psoDesc.vs = m_meshShader.vs;
+	psoDesc.ps = m_meshShader.ps;
+	psoDesc.rasterization = gxapi::RasterizerState(gxapi::eFillMode::SOLID, gxapi::eCullMode::DRAW_ALL);
+	psoDesc.primitiveTopologyType = gxapi::ePrimitiveTopologyType::TRIANGLE;
+	psoDesc.depthStencilState = gxapi::DepthStencilState(true, true);
+	psoDesc.depthStencilFormat = depthStencilFormat;
+	psoDesc.numRenderTargets = 1;
+	psoDesc.renderTargetFormats[0] = colorFormat;
+
+	m_meshPSO.reset(context.CreatePSO(psoDesc));
+
+	psoDesc.inputLayout.elements = impostorInputElementDesc.data();
+	psoDesc.inputLayout.numElements = (unsigned)impostorInputElementDesc.size();
+	psoDesc.vs = m_impostorShader.vs;
+	psoDesc.ps = m_impostorShader.ps;
+
+	m_impostorPSO.reset(context.CreatePSO(psoDesc));
+}
+
+
+} // namespace inl::gxeng::nodes
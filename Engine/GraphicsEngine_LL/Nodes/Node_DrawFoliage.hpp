@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../GraphicsNode.hpp"
+
+#include "../Scene.hpp"
+#include "../BasicCamera.hpp"
+#include "../DirectionalLight.hpp"
+#include "../FoliageEntity.hpp"
+#include "../FoliageCulling.hpp"
+#include "../PipelineTypes.hpp"
+#include "GraphicsApi_LL/IPipelineState.hpp"
+#include "GraphicsApi_LL/IGxapiManager.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace inl::gxeng::nodes {
+
+/// <summary>
+/// Draws foliage entities with one instanced draw for the meshes and one for the impostors of each entity.
+/// Instances are culled by chunks on the CPU, visible ones of all entities go into a single instance buffer.
+/// Inputs: frame color, frame depth stencil, camera, foliage entities, sun
+/// Output: frame color
+/// </summary>
+/// <remarks>
+/// Entities without a mesh or a texture are skipped. The mesh must have position, normal and texture coordinate attributes.
+/// </remarks>
+class DrawFoliage :
+	virtual public GraphicsNode,
+	virtual public GraphicsTask,
+	virtual public exc::InputPortConfig<Texture2D, Texture2D, const BasicCamera*, const EntityCollection<FoliageEntity>*, const EntityCollection<DirectionalLight>*>,
+	virtual public exc::OutputPortConfig<Texture2D>
+{
+public:
+	DrawFoliage();
+
+	void Update() override {}
+	void Notify(exc::InputPortBase* sender) override {}
+
+	void Initialize(EngineContext& context) override;
+	void Reset() override;
+	void Setup(SetupContext& context) override;
+	void Execute(RenderContext& context) override;
+
+private:
+	/// <summary> Instances of an entity in the instance buffer. </summary>
+	struct Batch {
+		const FoliageEntity* entity;
+		unsigned firstMeshInstance;
+		unsigned numMeshInstances;
+		unsigned firstImpostorInstance;
+		unsigned numImpostorInstances;
+	};
+
+	void CreatePipelineStates(SetupContext& context, gxapi::eFormat colorFormat, gxapi::eFormat depthStencilFormat);
+
+protected:
+	std::optional<Binder> m_binder;
+	BindParameter m_constantsBindParam;
+	BindParameter m_textureBindParam;
+
+	ShaderProgram m_meshShader;
+	ShaderProgram m_impostorShader;
+	std::unique_ptr<gxapi::IPipelineState> m_meshPSO;
+	std::unique_ptr<gxapi::IPipelineState> m_impostorPSO;
+	gxapi::eFormat m_colorFormat = gxapi::eFormat::UNKNOWN;
+	gxapi::eFormat m_depthStencilFormat = gxapi::eFormat::UNKNOWN;
+
+private:
+	FoliageDrawList m_drawList;
+	std::vector<Batch> m_batches;
+	std::vector<FoliageInstance> m_instances;
+	VertexBuffer m_instanceBuffer;
+	size_t m_instanceCapacity = 0;
+
+private: // execution
+	RenderTargetView2D m_rtv;
+	DepthStencilView2D m_dsv;
+	const BasicCamera* m_camera;
+	const EntityCollection<FoliageEntity>* m_entities;
+	const EntityCollection<DirectionalLight>* m_suns;
+};
+
+
+} // namespace inl::gxeng::nodes
@@ -8,6 +8,9 @@
 #include <array>
 
 
+using Vec3 = mathfu::Vector<float, 3>;
+
+
 namespace inl::gxeng::nodes {
 
 
@@ -57,12 +60,14 @@ void DrawSky::Setup(SetupContext & context) {
 
 	this->GetOutput<0>().Set(renderTarget);
 
+	UpdateLookupTables(context);
+
 
 	if (!m_binder.has_value()) {
 		BindParameterDesc sunCbBindParamDesc;
 		m_sunCbBindParam = BindParameter(eBindParameterType::CONSTANT, 0);
 		sunCbBindParamDesc.parameter = m_sunCbBindParam;
-		sunCbBindParamDesc.constantSize = sizeof(float) * 4 * 2;
+		sunCbBindParamDesc.constantSize = sizeof(float) * 4 * 3;
 		sunCbBindParamDesc.relativeAccessFrequency = 0;
 		sunCbBindParamDesc.relativeChangeFrequency = 0;
 		sunCbBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
@@ -75,6 +80,22 @@ void DrawSky::Setup(SetupContext & context) {
 		camCbBindParamDesc.relativeChangeFrequency = 0;
 		camCbBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
 
+		BindParameterDesc skyViewBindParamDesc;
+		m_skyViewBindParam = BindParameter(eBindParameterType::TEXTURE, 0);
+		skyViewBindParamDesc.parameter = m_skyViewBindParam;
+		skyViewBindParamDesc.constantSize = 0;
+		skyViewBindParamDesc.relativeAccessFrequency = 0;
+		skyViewBindParamDesc.relativeChangeFrequency = 0;
+		skyViewBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+
+		BindParameterDesc transmittanceBindParamDesc;
+		m_transmittanceBindParam = BindParameter(eBindParameterType::TEXTURE, 1);
+		transmittanceBindParamDesc.parameter = m_transmittanceBindParam;
+		transmittanceBindParamDesc.constantSize = 0;
+		transmittanceBindParamDesc.relativeAccessFrequency = 0;
+		transmittanceBindParamDesc.relativeChangeFrequency = 0;
+		transmittanceBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+
 		BindParameterDesc sampBindParamDesc;
 		sampBindParamDesc.parameter = BindParameter(eBindParameterType::SAMPLER, 0);
 		sampBindParamDesc.constantSize = 0;
@@ -85,14 +106,14 @@ void DrawSky::Setup(SetupContext & context) {
 		gxapi::StaticSamplerDesc samplerDesc;
 		samplerDesc.shaderRegister = 0;
 		samplerDesc.filter = gxapi::eTextureFilterMode::MIN_MAG_LINEAR_MIP_POINT;
-		samplerDesc.addressU = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.addressV = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.addressW = gxapi::eTextureAddressMode::WRAP;
+		samplerDesc.addressU = gxapi::eTextureAddressMode::CLAMP;
+		samplerDesc.addressV = gxapi::eTextureAddressMode::CLAMP;
+		samplerDesc.addressW = gxapi::eTextureAddressMode::CLAMP;
 		samplerDesc.mipLevelBias = 0.f;
 		samplerDesc.registerSpace = 0;
 		samplerDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
 
-		m_binder = context.CreateBinder({ sunCbBindParamDesc, camCbBindParamDesc, sampBindParamDesc }, { samplerDesc });
+		m_binder = context.CreateBinder({ sunCbBindParamDesc, camCbBindParamDesc, skyViewBindParamDesc, transmittanceBindParamDesc, sampBindParamDesc }, { samplerDesc });
 	}
 
 	//================================================
@@ -156,11 +177,18 @@ void DrawSky::Setup(SetupContext & context) {
 		psoDesc.renderTargetFormats[0] = m_colorFormat;
 
 		m_PSO.reset(context.CreatePSO(psoDesc));
+		++m_psoVersion;
 	}
+
+	UpdateConstants();
 }
 
 
 void DrawSky::Execute(RenderContext & context) {
+	if (!m_lookupTables.HasTables()) {
+		return;
+	}
+
 	gxeng::GraphicsCommandList& commandList = context.AsGraphics();
 
 	auto* pRTV = &m_rtv;
@@ -188,48 +216,100 @@ void DrawSky::Execute(RenderContext & context) {
 	unsigned vbSize = (unsigned)m_fsq.GetSize();
 	unsigned vbStride = 3 * sizeof(float);
 
-	struct Sun {
-		mathfu::VectorPacked<float, 4> dir;
-		mathfu::VectorPacked<float, 4> color;
+	commandList.BindGraphics(m_sunCbBindParam, &m_sunConstants, sizeof(m_sunConstants));
+	commandList.BindGraphics(m_camCbBindParam, &m_camConstants, sizeof(m_camConstants));
+	commandList.SetResourceState(m_skyViewTex, gxapi::eResourceState::PIXEL_SHADER_RESOURCE);
+	commandList.SetResourceState(m_transmittanceTex, gxapi::eResourceState::PIXEL_SHADER_RESOURCE);
+	commandList.BindGraphics(m_skyViewBindParam, m_skyViewSrv);
+	commandList.BindGraphics(m_transmittanceBindParam, m_transmittanceSrv);
+	commandList.SetResourceState(*pVertexBuffer, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+	commandList.SetResourceState(m_fsqIndices, gxapi::eResourceState::INDEX_BUFFER);
+	commandList.SetVertexBuffers(0, 1, &pVertexBuffer, &vbSize, &vbStride);
+	commandList.SetIndexBuffer(&m_fsqIndices, false);
+	commandList.DrawIndexedInstanced((unsigned)m_fsqIndices.GetIndexCount());
+}
 
-	};
 
-	struct Cam {
-		mathfu::VectorPacked<float, 4> invViewProj[4];
-		mathfu::VectorPacked<float, 4> pos;
-	};
+bool DrawSky::GetRecordingKeys(std::vector<uint64_t>& keys) const {
+	// the constants are root constants recorded into the command list, a still camera draws the same sky
+	// the lookup tables are uploaded in place, so their contents don't matter, only whether there are any yet
+	AddRecordingKey(keys, m_rtv.GetResource());
+	AddRecordingKey(keys, m_dsv.GetResource());
+	AddRecordingKey(keys, m_skyViewTex);
+	AddRecordingKey(keys, m_transmittanceTex);
+	AddRecordingKey(keys, m_fsq);
+	AddRecordingKey(keys, m_fsqIndices);
+	AddRecordingKeyBytes(keys, m_sunConstants);
+	AddRecordingKeyBytes(keys, m_camConstants);
+	keys.push_back(m_psoVersion);
+	keys.push_back(m_lookupTables.HasTables());
+	return true;
+}
 
-	Sun sunCB;
-	Cam camCB;
 
+void DrawSky::UpdateConstants() {
 	// TODO render all the suns using additive blending
 	assert(m_suns != nullptr);
 	assert(m_suns->Size() > 0);
 	auto sun = *m_suns->begin();
 
-	mathfu::Matrix4x4f viewInvTr = m_camera->GetViewMatrixRH().Inverse().Transpose();
-	mathfu::Vector4f sunViewDir = viewInvTr * mathfu::Vector4f(sun->GetDirection(), 0.0f);
 	mathfu::Vector4f sunColor = mathfu::Vector4f(sun->GetColor(), 1.0f);
 	mathfu::Matrix4x4f invViewProj = (m_camera->GetProjectionMatrixRH() * m_camera->GetViewMatrixRH()).Inverse();
 
-	sunCB.dir = mathfu::Vector4f(sun->GetDirection(), 0.0);
-	sunCB.color = sunColor;
-	invViewProj.Pack(camCB.invViewProj);
+	m_sunConstants.dir = mathfu::Vector4f(sun->GetDirection(), 0.0);
+	m_sunConstants.color = sunColor;
+	m_sunConstants.atmosphere = mathfu::Vector4f(GetViewHeight(), m_atmosphere.atmosphereHeight, 0.0f, 0.0f);
+	invViewProj.Pack(m_camConstants.invViewProj);
 
 	const PerspectiveCamera* perpectiveCamera = dynamic_cast<const PerspectiveCamera*>(m_camera);
 	if (perpectiveCamera == nullptr) {
 		throw std::invalid_argument("Sky drawing only works with perspective camera");
 	}
 
-	camCB.pos = mathfu::Vector4f(perpectiveCamera->GetPosition(), 1);
+	m_camConstants.pos = mathfu::Vector4f(perpectiveCamera->GetPosition(), 1);
+}
 
-	commandList.BindGraphics(m_sunCbBindParam, &sunCB, sizeof(sunCB));
-	commandList.BindGraphics(m_camCbBindParam, &camCB, sizeof(camCB));
-	commandList.SetResourceState(*pVertexBuffer, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
-	commandList.SetResourceState(m_fsqIndices, gxapi::eResourceState::INDEX_BUFFER);
-	commandList.SetVertexBuffers(0, 1, &pVertexBuffer, &vbSize, &vbStride);
-	commandList.SetIndexBuffer(&m_fsqIndices, false);
-	commandList.DrawIndexedInstanced((unsigned)m_fsqIndices.GetIndexCount());
+
+void DrawSky::UpdateLookupTables(SetupContext& context) {
+	if (m_suns == nullptr || m_suns->Size() == 0) {
+		return;
+	}
+
+	const SkyLookupTablesDesc& desc = m_lookupTables.GetDesc();
+	if (!m_skyViewTex.HasObject()) {
+		gxapi::SrvTexture2DArray srvDesc;
+		srvDesc.activeArraySize = 1;
+		srvDesc.firstArrayElement = 0;
+		srvDesc.mipLevelClamping = 0;
+		srvDesc.mostDetailedMip = 0;
+		srvDesc.numMipLevels = 1;
+		srvDesc.planeIndex = 0;
+
+		m_skyViewTex = context.CreateShaderResource2D(desc.skyViewWidth, desc.skyViewHeight, LookupTableFormat);
+		m_skyViewTex._GetResourcePtr()->SetName("Draw sky view lookup table");
+		m_skyViewSrv = context.CreateSrv(m_skyViewTex, LookupTableFormat, srvDesc);
+		m_transmittanceTex = context.CreateShaderResource2D(desc.transmittanceWidth, desc.transmittanceHeight, LookupTableFormat);
+		m_transmittanceTex._GetResourcePtr()->SetName("Draw sky transmittance lookup table");
+		m_transmittanceSrv = context.CreateSrv(m_transmittanceTex, LookupTableFormat, srvDesc);
+	}
+
+	// the tables are regenerated on a background thread only when their inputs changed enough,
+	// finished ones are uploaded the frame they are handed over
+	Vec3 sunDirection = -(*m_suns->begin())->GetDirection();
+	eSkyLutChange change = m_lookupTables.Update(m_atmosphere, sunDirection.Normalized(), GetViewHeight());
+
+	if (change == eSkyLutChange::ALL) {
+		context.Upload(m_transmittanceTex, 0, 0, m_lookupTables.GetTransmittance().data(), desc.transmittanceWidth, desc.transmittanceHeight, LookupTableFormat);
+	}
+	if (change != eSkyLutChange::NONE) {
+		context.Upload(m_skyViewTex, 0, 0, m_lookupTables.GetSkyView().data(), desc.skyViewWidth, desc.skyViewHeight, LookupTableFormat);
+	}
 }
 
+
+float DrawSky::GetViewHeight() const {
+	return m_camera != nullptr ? m_camera->GetPosition().z() * 0.001f : 0.0f;
+}
+
+
 } // namespace inl::gxeng::nodes
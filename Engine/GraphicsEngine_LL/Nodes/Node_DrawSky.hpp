@@ -7,6 +7,7 @@
 #include "../ConstBufferHeap.hpp"
 #include "../DirectionalLight.hpp"
 #include "../PipelineTypes.hpp"
+#include "../SkyLookupTableBuilder.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -18,6 +19,13 @@ namespace inl::gxeng::nodes {
 /// Inputs: frame color, frame depth stencil, camera, sun
 /// Output: frame color
 /// </summary>
+/// <remarks>
+/// The sky is drawn from precomputed scattering lookup tables. They are only regenerated when the atmosphere,
+/// the sun's elevation or the camera's height changed enough, see <see cref="SkyLookupTables"/>.
+/// Regenerating happens in the background, the previous tables are drawn until the new ones are uploaded,
+/// and nothing is drawn until the first ones are.
+/// World units are meters, the ground is at Z = 0.
+/// </remarks>
 class DrawSky :
 	virtual public GraphicsNode,
 	virtual public GraphicsTask,
@@ -32,25 +40,59 @@ public:
 	void Reset() override;
 	void Setup(SetupContext& context) override;
 	void Execute(RenderContext& context) override;
+	bool GetRecordingKeys(std::vector<uint64_t>& keys) const override;
+
+	void SetAtmosphere(const AtmosphereParams& atmosphere) { m_atmosphere = atmosphere; }
+	const AtmosphereParams& GetAtmosphere() const { return m_atmosphere; }
 
 protected:
 	VertexBuffer m_fsq;
 	IndexBuffer m_fsqIndices;
 	bool fsqInited;
 
+private:
+	struct SunConstants {
+		mathfu::VectorPacked<float, 4> dir;
+		mathfu::VectorPacked<float, 4> color;
+		mathfu::VectorPacked<float, 4> atmosphere; // view height and atmosphere height in km
+	};
+
+	struct CamConstants {
+		mathfu::VectorPacked<float, 4> invViewProj[4];
+		mathfu::VectorPacked<float, 4> pos;
+	};
+
+	void UpdateLookupTables(SetupContext& context);
+	void UpdateConstants();
+	float GetViewHeight() const;
+
+	static constexpr gxapi::eFormat LookupTableFormat = gxapi::eFormat::R32G32B32A32_FLOAT;
+
 private: // execution
 	RenderTargetView2D m_rtv;
 	DepthStencilView2D m_dsv;
 	const BasicCamera* m_camera;
 	const EntityCollection<DirectionalLight>* m_suns;
+	SunConstants m_sunConstants;
+	CamConstants m_camConstants;
+
+	AtmosphereParams m_atmosphere;
+	SkyLookupTableBuilder m_lookupTables;
+	Texture2D m_skyViewTex;
+	Texture2D m_transmittanceTex;
+	TextureView2D m_skyViewSrv;
+	TextureView2D m_transmittanceSrv;
 
 protected:
 	std::optional<Binder> m_binder;
 	BindParameter m_sunCbBindParam;
 	BindParameter m_camCbBindParam;
+	BindParameter m_skyViewBindParam;
+	BindParameter m_transmittanceBindParam;
 
 	gxeng::ShaderProgram m_shader;
 	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	uint64_t m_psoVersion = 0;
 	gxapi::eFormat m_colorFormat = gxapi::eFormat::UNKNOWN;
 	gxapi::eFormat m_depthStencilFormat = gxapi::eFormat::UNKNOWN;
 };
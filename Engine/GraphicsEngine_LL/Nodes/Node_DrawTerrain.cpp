@@ -0,0 +1,260 @@
+#include "Node_DrawTerrain.hpp"
+
+#include "NodeUtility.hpp"
+
+#include "../GraphicsCommandList.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+
+namespace inl::gxeng::nodes {
+
+
+struct TerrainConstants {
+	mathfu::VectorPacked<float, 4> viewProjection[4];
+	mathfu::VectorPacked<float, 4> terrainPosition;
+	mathfu::VectorPacked<float, 4> sunDirection; // towards the sun
+	mathfu::VectorPacked<float, 4> sunColor;
+	mathfu::VectorPacked<float, 4> materialColors[TerrainEntity::MaxMaterials];
+};
+
+
+DrawTerrain::DrawTerrain() {}
+
+
+void DrawTerrain::Initialize(EngineContext& context) {
+	GraphicsNode::SetTaskSingle(this);
+}
+
+
+void DrawTerrain::Reset() {
+	m_rtv = RenderTargetView2D();
+	m_dsv = DepthStencilView2D();
+	m_camera = nullptr;
+	m_suns = nullptr;
+
+	GetInput(0)->Clear();
+	GetInput(1)->Clear();
+	GetInput(2)->Clear();
+	GetInput(3)->Clear();
+	GetInput(4)->Clear();
+}
+
+
+void DrawTerrain::Setup(SetupContext& context) {
+	//================================================
+	// Set inputs, outputs
+
+	auto renderTarget = this->GetInput<0>().Get();
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+	m_rtv = context.CreateRtv(renderTarget, renderTarget.GetFormat(), rtvDesc);
+
+	auto depthStencil = this->GetInput<1>().Get();
+	const gxapi::eFormat currDepthStencilFormat = FormatAnyToDepthStencil(depthStencil.GetFormat());
+	gxapi::DsvTexture2DArray dsvDesc;
+	dsvDesc.activeArraySize = 1;
+	dsvDesc.firstArrayElement = 0;
+	dsvDesc.firstMipLevel = 0;
+	m_dsv = context.CreateDsv(depthStencil, currDepthStencilFormat, dsvDesc);
+
+	m_camera = this->GetInput<2>().Get();
+	const EntityCollection<TerrainEntity>* entities = this->GetInput<3>().Get();
+	m_suns = this->GetInput<4>().Get();
+
+	this->GetOutput<0>().Set(renderTarget);
+
+	//================================================
+	// Create binder, shader and pipeline state if needed
+
+	if (!m_binder.has_value()) {
+		BindParameterDesc constantsBindParamDesc;
+		m_constantsBindParam = BindParameter(eBindParameterType::CONSTANT, 0);
+		constantsBindParamDesc.parameter = m_constantsBindParam;
+		constantsBindParamDesc.constantSize = sizeof(TerrainConstants);
+		constantsBindParamDesc.relativeAccessFrequency = 0;
+		constantsBindParamDesc.relativeChangeFrequency = 0;
+		constantsBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		m_binder = context.CreateBinder({ constantsBindParamDesc });
+	}
+
+	if (!m_shader.vs || !m_shader.ps) {
+		ShaderParts shaderParts;
+		shaderParts.vs = true;
+		shaderParts.ps = true;
+
+		m_shader = context.CreateShader("DrawTerrain", shaderParts, "");
+	}
+
+	if (m_colorFormat != renderTarget.GetFormat() || m_depthStencilFormat != currDepthStencilFormat) {
+		m_colorFormat = renderTarget.GetFormat();
+		m_depthStencilFormat = currDepthStencilFormat;
+		CreatePipelineState(context, m_colorFormat, m_depthStencilFormat);
+	}
+
+	//================================================
+	// Select and stream in tiles, upload the vertices of new ones
+
+	++m_frame;
+	m_draws.clear();
+	if (entities == nullptr || m_camera == nullptr) {
+		m_caches.clear();
+		return;
+	}
+
+	// a unit length at unit distance covers this many pixels, the same for every entity
+	mathfu::Matrix4x4f projection = m_camera->GetProjectionMatrixRH();
+	float projectionScale = 0.5f * renderTarget.GetHeight() * std::abs(projection(1, 1));
+
+	for (auto it = m_caches.begin(); it != m_caches.end();) {
+		it = entities->Contains(const_cast<TerrainEntity*>(it->first)) ? std::next(it) : m_caches.erase(it);
+	}
+
+	for (TerrainEntity* entity : *entities) {
+		TerrainTileStreamer* streamer = entity->GetStreamer();
+		if (streamer == nullptr) {
+			m_caches.erase(entity);
+			continue;
+		}
+
+		EntityCache& cache = m_caches[entity];
+		if (cache.version != entity->GetVersion()) {
+			cache.version = entity->GetVersion();
+			cache.tiles.clear();
+		}
+
+		TerrainLodParams params;
+		params.cameraPosition = m_camera->GetPosition() - entity->GetPosition();
+		params.projectionScale = projectionScale;
+		params.pixelErrorThreshold = entity->GetPixelErrorThreshold();
+		streamer->Update();
+		SelectTerrainPatches(*streamer, params, m_patches);
+
+		const TerrainDesc& desc = streamer->GetDesc();
+		const std::array<IndexBuffer, 16>& indexBuffers = GetIndexBuffers(context, desc.tileResolution);
+		for (const TerrainPatch& patch : m_patches) {
+			auto cached = cache.tiles.find(patch.key);
+			if (cached == cache.tiles.end()) {
+				BuildTerrainPatchVertices(desc, patch.key, *patch.tile, m_vertices);
+				CachedTile tile;
+				tile.vertexBuffer = context.CreateVertexBuffer(m_vertices.data(), m_vertices.size() * sizeof(TerrainVertex));
+				cached = cache.tiles.insert({ patch.key, std::move(tile) }).first;
+			}
+			cached->second.lastUsed = m_frame;
+			m_draws.push_back({ entity, cached->second.vertexBuffer, &indexBuffers[patch.coarserEdges] });
+		}
+
+		// the GPU keeps at most as many tiles as the streamer, but never ones drawn this frame
+		for (auto tile = cache.tiles.begin(); tile != cache.tiles.end() && cache.tiles.size() > streamer->GetCapacity();) {
+			tile = tile->second.lastUsed != m_frame ? cache.tiles.erase(tile) : std::next(tile);
+		}
+	}
+}
+
+
+void DrawTerrain::Execute(RenderContext& context) {
+	if (m_draws.empty()) {
+		return;
+	}
+
+	GraphicsCommandList& commandList = context.AsGraphics();
+
+	auto* pRTV = &m_rtv;
+	commandList.SetResourceState(m_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.SetResourceState(m_dsv.GetResource(), gxapi::eResourceState::DEPTH_WRITE);
+	commandList.SetRenderTargets(1, &pRTV, &m_dsv);
+
+	gxapi::Rectangle rect{ 0, (int)m_rtv.GetResource().GetHeight(), 0, (int)m_rtv.GetResource().GetWidth() };
+	gxapi::Viewport viewport;
+	viewport.width = (float)rect.right;
+	viewport.height = (float)rect.bottom;
+	viewport.topLeftX = 0;
+	viewport.topLeftY = 0;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	commandList.SetScissorRects(1, &rect);
+	commandList.SetViewports(1, &viewport);
+
+	commandList.SetGraphicsBinder(&m_binder.value());
+	commandList.SetPipelineState(m_PSO.get());
+	commandList.SetPrimitiveTopology(gxapi::ePrimitiveTopology::TRIANGLELIST);
+
+	TerrainConstants constants;
+	mathfu::Matrix4x4f viewProjection = m_camera->GetProjectionMatrixRH() * m_camera->GetViewMatrixRH();
+	viewProjection.Pack(constants.viewProjection);
+	constants.sunDirection = mathfu::Vector4f(0.0f, 0.0f, 1.0f, 0.0f);
+	constants.sunColor = mathfu::Vector4f(1.0f, 1.0f, 1.0f, 1.0f);
+	if (m_suns != nullptr && m_suns->Size() > 0) {
+		const DirectionalLight* sun = *m_suns->begin();
+		constants.sunDirection = mathfu::Vector4f(-sun->GetDirection().Normalized(), 0.0f);
+		constants.sunColor = mathfu::Vector4f(sun->GetColor(), 1.0f);
+	}
+
+	const TerrainEntity* boundEntity = nullptr;
+	for (const Draw& draw : m_draws) {
+		if (draw.entity != boundEntity) {
+			boundEntity = draw.entity;
+			constants.terrainPosition = mathfu::Vector4f(boundEntity->GetPosition(), 1.0f);
+			const auto& colors = boundEntity->GetMaterialColors();
+			for (unsigned i = 0; i < TerrainEntity::MaxMaterials; ++i) {
+				constants.materialColors[i] = mathfu::Vector4f(i < colors.size() ? colors[i] : colors.back(), 1.0f);
+			}
+			commandList.BindGraphics(m_constantsBindParam, &constants, sizeof(constants));
+		}
+
+		const VertexBuffer* vertexBuffer = &draw.vertexBuffer;
+		unsigned size = (unsigned)draw.vertexBuffer.GetSize();
+		unsigned stride = sizeof(TerrainVertex);
+		commandList.SetResourceState(draw.vertexBuffer, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+		commandList.SetResourceState(*draw.indexBuffer, gxapi::eResourceState::INDEX_BUFFER);
+		commandList.SetVertexBuffers(0, 1, &vertexBuffer, &size, &stride);
+		commandList.SetIndexBuffer(draw.indexBuffer, true);
+		commandList.DrawIndexedInstanced((unsigned)draw.indexBuffer->GetIndexCount());
+	}
+}
+
+
+void DrawTerrain::CreatePipelineState(SetupContext& context, gxapi::eFormat colorFormat, gxapi::eFormat depthStencilFormat) {
+	std::vector<gxapi::InputElementDesc> inputElementDesc = {
+		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, offsetof(TerrainVertex, position)),
+		gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, offsetof(TerrainVertex, normal)),
+		gxapi::InputElementDesc("MATERIAL", 0, gxapi::eFormat::R32_UINT, 0, offsetof(TerrainVertex, material)),
+	};
+
+	gxapi::GraphicsPipelineStateDesc psoDesc;
+	psoDesc.inputLayout.elements = inputElementDesc.data();
+	psoDesc.inputLayout.numElements = (unsigned)inputElementDesc.size();
+	psoDesc.rootSignature = m_binder->GetRootSignature();
+	psoDesc.vs = m_shader.vs;
+	psoDesc.ps = m_shader.ps;
+	psoDesc.rasterization = gxapi::RasterizerState(gxapi::eFillMode::SOLID, gxapi::eCullMode::DRAW_CCW);
+	psoDesc.primitiveTopologyType = gxapi::ePrimitiveTopologyType::TRIANGLE;
+	psoDesc.depthStencilState = gxapi::DepthStencilState(true, true);
+	psoDesc.depthStencilFormat = depthStencilFormat;
+	psoDesc.numRenderTargets = 1;
+	psoDesc.renderTargetFormats[0] = colorFormat;
+
+	m_PSO.reset(context.CreatePSO(psoDesc));
+}
+
+
+const std::array<IndexBuffer, 16>& DrawTerrain::GetIndexBuffers(SetupContext& context, unsigned tileResolution) {
+	auto it = m_indexBuffers.find(tileResolution);
+	if (it == m_indexBuffers.end()) {
+		std::array<IndexBuffer, 16> indexBuffers;
+		for (unsigned coarserEdges = 0; coarserEdges < 16; ++coarserEdges) {
+			std::vector<uint32_t> indices = BuildTerrainPatchIndices(tileResolution, coarserEdges);
+			indexBuffers[coarserEdges] = context.CreateIndexBuffer(indices.data(), indices.size() * sizeof(uint32_t), indices.size());
+		}
+		it = m_indexBuffers.insert({ tileResolution, std::move(indexBuffers) }).first;
+	}
+	return it->second;
+}
+
+
+} // namespace inl::gxeng::nodes
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../GraphicsNode.hpp"
+
+#include "../Scene.hpp"
+#include "../BasicCamera.hpp"
+#include "../DirectionalLight.hpp"
+#include "../TerrainEntity.hpp"
+#include "../TerrainLod.hpp"
+#include "../PipelineTypes.hpp"
+#include "GraphicsApi_LL/IPipelineState.hpp"
+#include "GraphicsApi_LL/IGxapiManager.hpp"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace inl::gxeng::nodes {
+
+/// <summary>
+/// Draws terrain entities. Selects the tiles for the camera, streams them in and keeps the vertices of recently drawn tiles on the GPU.
+/// Inputs: frame color, frame depth stencil, camera, terrain entities, sun
+/// Output: frame color
+/// </summary>
+/// <remarks>
+/// All tiles share one index buffer for each combination of stitched edges.
+/// </remarks>
+class DrawTerrain :
+	virtual public GraphicsNode,
+	virtual public GraphicsTask,
+	virtual public exc::InputPortConfig<Texture2D, Texture2D, const BasicCamera*, const EntityCollection<TerrainEntity>*, const EntityCollection<DirectionalLight>*>,
+	virtual public exc::OutputPortConfig<Texture2D>
+{
+public:
+	DrawTerrain();
+
+	void Update() override {}
+	void Notify(exc::InputPortBase* sender) override {}
+
+	void Initialize(EngineContext& context) override;
+	void Reset() override;
+	void Setup(SetupContext& context) override;
+	void Execute(RenderContext& context) override;
+
+private:
+	struct CachedTile {
+		VertexBuffer vertexBuffer;
+		uint64_t lastUsed;
+	};
+	/// <summary> Vertex buffers of the tiles of an entity, dropped when the entity's tile source changes. </summary>
+	struct EntityCache {
+		uint64_t version = 0;
+		std::unordered_map<TerrainTileKey, CachedTile> tiles;
+	};
+	struct Draw {
+		const TerrainEntity* entity;
+		VertexBuffer vertexBuffer;
+		const IndexBuffer* indexBuffer;
+	};
+
+	void CreatePipelineState(SetupContext& context, gxapi::eFormat colorFormat, gxapi::eFormat depthStencilFormat);
+	const std::array<IndexBuffer, 16>& GetIndexBuffers(SetupContext& context, unsigned tileResolution);
+
+protected:
+	std::optional<Binder> m_binder;
+	BindParameter m_constantsBindParam;
+
+	ShaderProgram m_shader;
+	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	gxapi::eFormat m_colorFormat = gxapi::eFormat::UNKNOWN;
+	gxapi::eFormat m_depthStencilFormat = gxapi::eFormat::UNKNOWN;
+
+private:
+	std::unordered_map<const TerrainEntity*, EntityCache> m_caches;
+	std::unordered_map<unsigned, std::array<IndexBuffer, 16>> m_indexBuffers; // by tile resolution
+	std::vector<TerrainPatch> m_patches;
+	std::vector<TerrainVertex> m_vertices;
+	std::vector<Draw> m_draws;
+	uint64_t m_frame = 0;
+
+private: // execution
+	RenderTargetView2D m_rtv;
+	DepthStencilView2D m_dsv;
+	const BasicCamera* m_camera;
+	const EntityCollection<DirectionalLight>* m_suns;
+};
+
+
+} // namespace inl::gxeng::nodes
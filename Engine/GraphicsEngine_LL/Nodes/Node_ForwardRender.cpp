@@ -9,58 +9,33 @@
 #include "../NodeContext.hpp"
 #include "../GraphicsCommandList.hpp"
 #include "../ResourceView.hpp"
+#include "../ShaderTokenizer.hpp"
+#include "../ClusteredLightCulling.hpp"
 
 #include <array>
 
 namespace inl::gxeng::nodes {
 
-struct light_data
+struct ClusterUniforms
 {
-	mathfu::VectorPacked<float, 4> diffuse_color;
-	mathfu::VectorPacked<float, 4> vs_position;
-	mathfu::VectorPacked<float, 4> attenuation_end;
+	float screen_width, screen_height;
+	uint32_t tiles_x, tiles_y;
+	uint32_t slices;
+	float slice_scale, slice_bias;
+	float dummy;
 };
 
-struct Uniforms
-{
-	light_data ld[10];
-	mathfu::VectorPacked<float, 4> screen_dimensions;
-	mathfu::VectorPacked<float, 4> vs_cam_pos;
-	int group_size_x, group_size_y;
-	mathfu::VectorPacked<float, 2> dummy;
-};
-
-static void setWorkgroupSize(unsigned w, unsigned h, unsigned groupSizeW, unsigned groupSizeH, unsigned& dispatchW, unsigned& dispatchH)
-{
-	//set up work group sizes
-	unsigned gw = 0, gh = 0, count = 1;
-
-	while (gw < w)
-	{
-		gw = groupSizeW * count;
-		count++;
-	}
-
-	count = 1;
-
-	while (gh < h)
-	{
-		gh = groupSizeH * count;
-		count++;
-	}
+static bool CheckMeshFormat(const Mesh& mesh) {
+	if (mesh.GetNumStreams() != 2) return false;
 
-	dispatchW = unsigned(float(gw) / groupSizeW);
-	dispatchH = unsigned(float(gh) / groupSizeH);
-}
+	auto& positionElements = mesh.GetLayout()[Mesh::POSITION_STREAM];
+	if (positionElements.size() != 1) return false;
+	if (positionElements[0].semantic != eVertexElementSemantic::POSITION) return false;
 
-static bool CheckMeshFormat(const Mesh& mesh) {
-	for (size_t i = 0; i < mesh.GetNumStreams(); i++) {
-		auto& elements = mesh.GetLayout()[0];
-		if (elements.size() != 3) return false;
-		if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
-		if (elements[1].semantic != eVertexElementSemantic::NORMAL) return false;
-		if (elements[2].semantic != eVertexElementSemantic::TEX_COORD) return false;
-	}
+	auto& attributeElements = mesh.GetLayout()[Mesh::ATTRIBUTE_STREAM];
+	if (attributeElements.size() != 2) return false;
+	if (attributeElements[0].semantic != eVertexElementSemantic::NORMAL) return false;
+	if (attributeElements[1].semantic != eVertexElementSemantic::TEX_COORD) return false;
 
 	return true;
 }
@@ -108,6 +83,9 @@ void ForwardRender::Reset() {
 	m_shadowMXTexView = TextureView2D();
 	m_csmSplitsTexView = TextureView2D();
 	m_lightMVPTexView = TextureView2D();
+	m_clusterDataView = TextureView2D();
+	m_clusterLightIndicesView = TextureView2D();
+	m_clusterLightDataView = TextureView2D();
 
 	GetInput<0>().Clear();
 	GetInput<1>().Clear();
@@ -175,10 +153,22 @@ void ForwardRender::Setup(SetupContext& context) {
 	m_lightMVPTexView = context.CreateSrv(lightMVPTex, lightMVPTex.GetFormat(), srvDesc);
 	m_lightMVPTexView.GetResource()._GetResourcePtr()->SetName("Forward render light MVP tex view");
 
-	auto lightCullData = this->GetInput<9>().Get();
+	auto clusterData = this->GetInput<9>().Get();
 	this->GetInput<9>().Clear();
-	m_lightCullDataView = context.CreateSrv(lightCullData, lightCullData.GetFormat(), srvDesc);
-	m_lightCullDataView.GetResource()._GetResourcePtr()->SetName("Forward render light cull data tex view");
+	srvDesc.activeArraySize = clusterData.GetArrayCount();
+	m_clusterDataView = context.CreateSrv(clusterData, clusterData.GetFormat(), srvDesc);
+	m_clusterDataView.GetResource()._GetResourcePtr()->SetName("Forward render cluster data tex view");
+	srvDesc.activeArraySize = 1;
+
+	auto clusterLightIndices = this->GetInput<10>().Get();
+	this->GetInput<10>().Clear();
+	m_clusterLightIndicesView = context.CreateSrv(clusterLightIndices, clusterLightIndices.GetFormat(), srvDesc);
+	m_clusterLightIndicesView.GetResource()._GetResourcePtr()->SetName("Forward render cluster light indices tex view");
+
+	auto clusterLightData = this->GetInput<11>().Get();
+	this->GetInput<11>().Clear();
+	m_clusterLightDataView = context.CreateSrv(clusterLightData, clusterLightData.GetFormat(), srvDesc);
+	m_clusterLightDataView.GetResource()._GetResourcePtr()->SetName("Forward render cluster light data tex view");
 
 
 	this->GetOutput<0>().Set(target);
@@ -288,11 +278,31 @@ void ForwardRender::Execute(RenderContext& context) {
 	mathfu::Matrix4x4f projection = m_camera->GetProjectionMatrixRH();
 	auto viewProjection = projection * view;
 
+	// must match the grid LightCulling assigned the lights to
+	ClusterGridDesc gridDesc;
+	gridDesc.tilesX = (unsigned)m_clusterDataView.GetResource().GetWidth() / 2;
+	gridDesc.tilesY = (unsigned)m_clusterDataView.GetResource().GetHeight();
+	gridDesc.depthSlices = m_clusterDataView.GetResource().GetArrayCount();
+	ClusterGrid grid(gridDesc, projection(0, 0), projection(1, 1), m_camera->GetNearPlane(), m_camera->GetFarPlane());
+
+	ClusterUniforms clusterUniforms;
+	clusterUniforms.screen_width = (float)m_rtv.GetResource().GetWidth();
+	clusterUniforms.screen_height = (float)m_rtv.GetResource().GetHeight();
+	clusterUniforms.tiles_x = gridDesc.tilesX;
+	clusterUniforms.tiles_y = gridDesc.tilesY;
+	clusterUniforms.slices = gridDesc.depthSlices;
+	clusterUniforms.slice_scale = grid.GetSliceScale();
+	clusterUniforms.slice_bias = grid.GetSliceBias();
 
 	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
 	std::vector<unsigned> sizes;
 	std::vector<unsigned> strides;
 
+	// With bindless descriptors material textures are passed as indices in the material constants,
+	// so the root tables stay the same for all entities of a scenario and are only set when the scenario changes.
+	BindlessHeap* bindlessHeap = context.GetBindlessHeap();
+	const ScenarioData* boundScenario = nullptr;
+
 	// Iterate over all entities
 	for (const MeshEntity* entity : *m_entities) {
 		// Get entity parameters
@@ -308,24 +318,40 @@ void ForwardRender::Execute(RenderContext& context) {
 		assert(materialShader != nullptr);
 
 		ScenarioData& scenario = GetScenario(
-			context, layout, *materialShader, m_rtv.GetDescription().format, m_dsv.GetDescription().format);
-
-		commandList.SetPipelineState(scenario.pso.get());
-		commandList.SetGraphicsBinder(&scenario.binder);
+			context, layout, *materialShader, m_rtv.GetDescription().format, m_dsv.GetDescription().format, bindlessHeap != nullptr);
+		bool rebind = bindlessHeap == nullptr || &scenario != boundScenario;
+		boundScenario = &scenario;
+
+		if (rebind) {
+			commandList.SetPipelineState(scenario.pso.get());
+			commandList.SetGraphicsBinder(&scenario.binder);
+			if (bindlessHeap != nullptr) {
+				commandList.BindGraphics(BindlessColorBindParam, *bindlessHeap);
+				commandList.BindGraphics(BindlessValueBindParam, *bindlessHeap);
+			}
+		}
 
 		commandList.SetResourceState(m_shadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 		commandList.SetResourceState(m_shadowMXTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 		commandList.SetResourceState(m_csmSplitsTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 		commandList.SetResourceState(m_lightMVPTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 500), m_shadowMapTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 501), m_shadowMXTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 502), m_csmSplitsTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 503), m_lightMVPTexView);
+		if (rebind) {
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 500), m_shadowMapTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 501), m_shadowMXTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 502), m_csmSplitsTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 503), m_lightMVPTexView);
+		}
 
-		commandList.SetResourceState(m_lightCullDataView.GetResource(), {gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE	});
+		commandList.SetResourceState(m_clusterDataView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+		commandList.SetResourceState(m_clusterLightIndicesView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+		commandList.SetResourceState(m_clusterLightDataView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 600), m_lightCullDataView);
+		if (rebind) {
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 600), m_clusterDataView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 601), m_clusterLightIndicesView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 602), m_clusterLightDataView);
+		}
 
 		// Set material parameters
 		std::vector<uint8_t> materialConstants(scenario.constantsSize);
@@ -335,9 +361,19 @@ void ForwardRender::Execute(RenderContext& context) {
 			case eMaterialShaderParamType::BITMAP_COLOR_2D:
 			case eMaterialShaderParamType::BITMAP_VALUE_2D:
 			{
-				BindParameter bindSlot(eBindParameterType::TEXTURE, scenario.offsets[paramIdx]);
-				commandList.SetResourceState(((Image*)param)->GetSrv()->GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-				commandList.BindGraphics(bindSlot, *((Image*)param)->GetSrv());
+				const TextureView2D& srv = *((Image*)param)->GetSrv();
+				commandList.SetResourceState(srv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+				if (bindlessHeap != nullptr) {
+					uint32_t bindlessIndex = srv.GetBindlessIndex();
+					if (bindlessIndex == BindlessHeap::InvalidIndex) {
+						throw std::logic_error("Image is not registered in the bindless heap.");
+					}
+					*reinterpret_cast<uint32_t*>(materialConstants.data() + scenario.offsets[paramIdx]) = bindlessIndex;
+				}
+				else {
+					BindParameter bindSlot(eBindParameterType::TEXTURE, scenario.offsets[paramIdx]);
+					commandList.BindGraphics(bindSlot, srv);
+				}
 				break;
 			}
 			case eMaterialShaderParamType::COLOR:
@@ -370,26 +406,15 @@ void ForwardRender::Execute(RenderContext& context) {
 		(view * entity->GetTransform()).Pack(vsConstants.mv);
 		view.Pack(vsConstants.v);
 		projection.Pack(vsConstants.p);
+		vsConstants.positionScale = mathfu::Vector4f(mesh->GetPositionQuantization().scale, 0.0f);
+		vsConstants.positionOffset = mathfu::Vector4f(mesh->GetPositionQuantization().offset, 0.0f);
 		lightConstants.direction = sun->GetDirection().Normalized();
 		lightConstants.color = sun->GetColor();
 
 		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 0), &vsConstants, sizeof(vsConstants));
 		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 100), &lightConstants, sizeof(lightConstants));
 
-		Uniforms uniformsCBData;
-		uniformsCBData.screen_dimensions = mathfu::Vector4f(m_rtv.GetResource().GetWidth(), m_rtv.GetResource().GetHeight(), 0, 0);
-		uniformsCBData.ld[0].vs_position = m_camera->GetViewMatrixRH() * mathfu::Vector4f(m_camera->GetPosition() + m_camera->GetLookDirection() * 5, 1.0f);
-		uniformsCBData.ld[0].attenuation_end = mathfu::Vector4f(5.0f, 0, 0, 0);
-		uniformsCBData.ld[0].diffuse_color = mathfu::Vector4f(1, 0, 0, 1);
-		uniformsCBData.vs_cam_pos = m_camera->GetViewMatrixRH() * mathfu::Vector4f(m_camera->GetPosition(), 1.0f);
-
-		uint32_t dispatchW, dispatchH;
-		setWorkgroupSize(m_rtv.GetResource().GetWidth(), m_rtv.GetResource().GetHeight(), 16, 16, dispatchW, dispatchH);
-
-		uniformsCBData.group_size_x = dispatchW;
-		uniformsCBData.group_size_y = dispatchH;
-
-		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 600), &uniformsCBData, sizeof(uniformsCBData));
+		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 600), &clusterUniforms, sizeof(clusterUniforms));
 
 		// Set primitives
 		vertexBuffers.clear(); sizes.clear(); strides.clear();
@@ -417,7 +442,8 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 	const Mesh::Layout& layout,
 	const MaterialShader& shader,
 	gxapi::eFormat renderTargetFormat,
-	gxapi::eFormat depthStencilFormat)
+	gxapi::eFormat depthStencilFormat,
+	bool bindless)
 {
 	std::string shaderCode = shader.GetShaderCode();
 
@@ -440,7 +466,7 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 
 		// Compile pixel shader if needed
 		if (psIt == m_materialShaders.end()) {
-			std::string psCode = GeneratePixelShader(shader);
+			std::string psCode = GeneratePixelShader(shader, bindless);
 			ShaderParts psParts;
 			psParts.ps = true;
 			auto res = m_materialShaders.insert({ shaderCode, context.CompileShader(psCode, psParts, "") });
@@ -453,7 +479,7 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 		size_t constantsSize;
 		Binder binder;
 
-		binder = GenerateBinder(context, shader.GetShaderParameters(), offsets, constantsSize);
+		binder = GenerateBinder(context, shader.GetShaderParameters(), bindless, offsets, constantsSize);
 		pso = CreatePso(context, binder, vsIt->second.vs, psIt->second.ps, renderTargetFormat, depthStencilFormat);
 
 		auto res = m_scenarios.insert({ key, ScenarioData() });
@@ -487,19 +513,22 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 
 std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 	// there's only a single vertex format supported for now
-	if (layout.GetStreamCount() <= 0) {
-		throw std::invalid_argument("Meshes must have a single interleaved buffer.");
+	if (layout.GetStreamCount() != 2) {
+		throw std::invalid_argument("Meshes must have a position and an attribute stream.");
 	}
 
-	auto& elements = layout[0];
-	if (elements.size() != 3
-		|| elements[0].semantic != eVertexElementSemantic::POSITION
-		|| elements[1].semantic != eVertexElementSemantic::NORMAL
-		|| elements[2].semantic != eVertexElementSemantic::TEX_COORD)
+	auto& positionElements = layout[Mesh::POSITION_STREAM];
+	auto& attributeElements = layout[Mesh::ATTRIBUTE_STREAM];
+	if (positionElements.size() != 1
+		|| positionElements[0].semantic != eVertexElementSemantic::POSITION
+		|| attributeElements.size() != 2
+		|| attributeElements[0].semantic != eVertexElementSemantic::NORMAL
+		|| attributeElements[1].semantic != eVertexElementSemantic::TEX_COORD)
 	{
 		throw std::invalid_argument("Mesh must have 3 attributes: position, normal, texcoord.");
 	}
 
+	// positions are quantized against the mesh's bounds, normals are octahedral encoded
 	std::string vertexShader =
 		"Texture2D<float4> lightMVPTex : register(t503);"
 		"struct VsConstants \n"
@@ -509,6 +538,8 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 		"	float4x4 M;\n"
 		"	float4x4 V;\n"
 		"	float4x4 P;\n"
+		"	float4 positionScale;\n"
+		"	float4 positionOffset;\n"
 		"};\n"
 		"ConstantBuffer<VsConstants> vsConstants : register(b0);\n"
 
@@ -520,11 +551,15 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 		"	float4 vsPosition : TEX_COORD1;\n"
 		"};\n"
 
-		"PS_Input VSMain(float4 position : POSITION, float4 normal : NORMAL, float4 texCoord : TEX_COORD)\n"
+		+ std::string(VertexElementCompressor<eVertexElementSemantic::NORMAL>::DecodeHlsl()) +
+
+		"PS_Input VSMain(float4 encodedPosition : POSITION, float2 encodedNormal : NORMAL, float2 texCoord : TEX_COORD)\n"
 		"{\n"
 		"	PS_Input result;\n"
 
-		"	float3 viewNormal = mul(vsConstants.MV, float4(normal.xyz, 0.0)).xyz;\n"
+		"	float4 position = float4(encodedPosition.xyz * vsConstants.positionScale.xyz + vsConstants.positionOffset.xyz, 1.0);\n"
+		"	float3 normal = DecodeOctahedralNormal(encodedNormal);\n"
+		"	float3 viewNormal = mul(vsConstants.MV, float4(normal, 0.0)).xyz;\n"
 
 		"float4x4 light_mvp;\n"
 		"float cascade = 0;\n"
@@ -546,7 +581,7 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 	return vertexShader;
 }
 
-std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
+std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader, bool bindless) {
 	// get material shading function's HLSL code
 	std::vector<MaterialShaderParameter> params;
 	std::string shadingFunction;
@@ -555,10 +590,7 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 	shadingFunction = shader.GetShaderCode();
 
 	// rename "main" to something else
-	std::stringstream renameMain;
-	std::regex renameRegex("main");
-	std::regex_replace(std::ostreambuf_iterator<char>(renameMain), shadingFunction.begin(), shadingFunction.end(), renameRegex, "mtl_shader");
-	shadingFunction = renameMain.str();
+	shadingFunction = ShaderTokenizer(std::move(shadingFunction)).RenameIdentifier("main", "mtl_shader");
 
 	// structures
 	std::string structures =
@@ -597,6 +629,11 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 		"};\n";
 	lightConstantBuffer << "ConstantBuffer<LightConstants> lightCb: register(b100); \n";
 
+	if (bindless) {
+		textures << "Texture2DArray<float4> g_bindlessColor[] : register(t" << BindlessColorBindParam.reg << ", space" << BindlessColorBindParam.space << "); \n";
+		textures << "Texture2DArray<float> g_bindlessValue[] : register(t" << BindlessValueBindParam.reg << ", space" << BindlessValueBindParam.space << "); \n";
+	}
+
 	mtlConstantBuffer << "struct MtlConstants { \n";
 	int numMtlConstants = 0;
 	for (size_t i = 0; i < params.size(); ++i) {
@@ -614,14 +651,18 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 				break;
 			}
 			case eMaterialShaderParamType::BITMAP_COLOR_2D:
-			{
-				textures << "Texture2DArray<float4> tex" << i << " : register(t" << i << "); \n";
-				textures << "SamplerState samp" << i << " : register(s" << i << "); \n";
-				break;
-			}
 			case eMaterialShaderParamType::BITMAP_VALUE_2D:
 			{
-				textures << "Texture2DArray<float> tex" << i << " : register(t" << i << "); \n";
+				if (bindless) {
+					mtlConstantBuffer << "    uint param" << i << "; \n";
+					++numMtlConstants;
+				}
+				else if (params[i].type == eMaterialShaderParamType::BITMAP_COLOR_2D) {
+					textures << "Texture2DArray<float4> tex" << i << " : register(t" << i << "); \n";
+				}
+				else {
+					textures << "Texture2DArray<float> tex" << i << " : register(t" << i << "); \n";
+				}
 				textures << "SamplerState samp" << i << " : register(s" << i << "); \n";
 				break;
 			}
@@ -660,14 +701,24 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 			case eMaterialShaderParamType::BITMAP_COLOR_2D:
 			{
 				PSMain << "    MapColor2D input" << i << "; \n";
-				PSMain << "    input" << i << ".tex = tex" << i << "; \n";
+				if (bindless) {
+					PSMain << "    input" << i << ".tex = g_bindlessColor[mtlCb.param" << i << "]; \n";
+				}
+				else {
+					PSMain << "    input" << i << ".tex = tex" << i << "; \n";
+				}
 				PSMain << "    input" << i << ".samp = samp" << i << "; \n\n";
 				break;
 			}
 			case eMaterialShaderParamType::BITMAP_VALUE_2D:
 			{
 				PSMain << "    MapValue2D input" << i << "; \n";
-				PSMain << "    input" << i << ".tex = tex" << i << "; \n";
+				if (bindless) {
+					PSMain << "    input" << i << ".tex = g_bindlessValue[mtlCb.param" << i << "]; \n";
+				}
+				else {
+					PSMain << "    input" << i << ".tex = tex" << i << "; \n";
+				}
 				PSMain << "    input" << i << ".samp = samp" << i << "; \n\n";
 				break;
 			}
@@ -686,7 +737,7 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 		std::string()
 		+ "#include \"CSMSample\"\n"
 		+ "#include \"PbrBrdf\"\n"
-		+ "#include \"TiledLighting\"\n"
+		+ "#include \"ClusteredLighting\"\n"
 		+ structures
 		+ "\n//-------------------------------------\n\n"
 		+ globals
@@ -701,7 +752,7 @@ std::string ForwardRender::GeneratePixelShader(const MaterialShader& shader) {
 		+ PSMain.str();
 }
 
-Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, std::vector<int>& offsets, size_t& materialCbSize) {
+Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, bool bindless, std::vector<int>& offsets, size_t& materialCbSize) {
 	int textureRegister = 0;
 	int cbSize = 0;
 	std::vector<BindParameterDesc> descs;
@@ -712,6 +763,17 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 		case eMaterialShaderParamType::BITMAP_COLOR_2D:
 		case eMaterialShaderParamType::BITMAP_VALUE_2D:
 		{
+			// the texture's bindless index goes into the material constants
+			if (bindless) {
+				cbSize = ((cbSize + 3) / 4) * 4; // correct alignement
+				offsets.push_back(cbSize);
+				cbSize += sizeof(uint32_t);
+
+				++textureRegister;
+
+				break;
+			}
+
 			BindParameterDesc desc;
 			desc.parameter = BindParameter(eBindParameterType::TEXTURE, textureRegister);
 			desc.constantSize = 0;
@@ -792,16 +854,22 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 	lightMVPBindParamDesc.relativeChangeFrequency = 0;
 	lightMVPBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
 
-	BindParameterDesc lightCullDataBindParamDesc;
-	lightCullDataBindParamDesc.parameter = BindParameter(eBindParameterType::TEXTURE, 600);
-	lightCullDataBindParamDesc.constantSize = 0;
-	lightCullDataBindParamDesc.relativeAccessFrequency = 0;
-	lightCullDataBindParamDesc.relativeChangeFrequency = 0;
-	lightCullDataBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+	BindParameterDesc clusterDataBindParamDesc;
+	clusterDataBindParamDesc.parameter = BindParameter(eBindParameterType::TEXTURE, 600);
+	clusterDataBindParamDesc.constantSize = 0;
+	clusterDataBindParamDesc.relativeAccessFrequency = 0;
+	clusterDataBindParamDesc.relativeChangeFrequency = 0;
+	clusterDataBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+
+	BindParameterDesc clusterLightIndicesBindParamDesc = clusterDataBindParamDesc;
+	clusterLightIndicesBindParamDesc.parameter = BindParameter(eBindParameterType::TEXTURE, 601);
+
+	BindParameterDesc clusterLightDataBindParamDesc = clusterDataBindParamDesc;
+	clusterLightDataBindParamDesc.parameter = BindParameter(eBindParameterType::TEXTURE, 602);
 
 	BindParameterDesc lightUniformsCbDesc;
 	lightUniformsCbDesc.parameter = BindParameter(eBindParameterType::CONSTANT, 600);
-	lightUniformsCbDesc.constantSize = sizeof(Uniforms);
+	lightUniformsCbDesc.constantSize = sizeof(ClusterUniforms);
 	lightUniformsCbDesc.relativeAccessFrequency = 0;
 	lightUniformsCbDesc.relativeChangeFrequency = 0;
 	lightUniformsCbDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
@@ -854,12 +922,27 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 	descs.push_back(csmSplitsBindParamDesc);
 	descs.push_back(lightMVPBindParamDesc);
 
-	descs.push_back(lightCullDataBindParamDesc);
+	descs.push_back(clusterDataBindParamDesc);
+	descs.push_back(clusterLightIndicesBindParamDesc);
+	descs.push_back(clusterLightDataBindParamDesc);
 
 	if (cbSize > 0) {
 		descs.push_back(mtlCbDesc);
 	}
 
+	if (bindless) {
+		BindParameterDesc bindlessDesc;
+		bindlessDesc.parameter = BindlessColorBindParam;
+		bindlessDesc.relativeAccessFrequency = 0;
+		bindlessDesc.relativeChangeFrequency = 0;
+		bindlessDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
+		bindlessDesc.bindless = true;
+		descs.push_back(bindlessDesc);
+
+		bindlessDesc.parameter = BindlessValueBindParam;
+		descs.push_back(bindlessDesc);
+	}
+
 	std::vector<gxapi::StaticSamplerDesc> samplerParams;
 	for (int i = 0; i < textureRegister; ++i) {
 		samplerDesc.parameter.reg = i;
@@ -886,9 +969,9 @@ std::unique_ptr<gxapi::IPipelineState> ForwardRender::CreatePso(
 	std::unique_ptr<gxapi::IPipelineState> result;
 
 	std::vector<gxapi::InputElementDesc> inputElementDesc = {
-		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-		gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-		gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
+		gxapi::InputElementDesc("POSITION", 0, VertexElementCompressor<eVertexElementSemantic::POSITION>::Format(), Mesh::POSITION_STREAM, 0),
+		gxapi::InputElementDesc("NORMAL", 0, VertexElementCompressor<eVertexElementSemantic::NORMAL>::Format(), Mesh::ATTRIBUTE_STREAM, 0),
+		gxapi::InputElementDesc("TEX_COORD", 0, VertexElementCompressor<eVertexElementSemantic::TEX_COORD>::Format(), Mesh::ATTRIBUTE_STREAM, 4),
 	};
 
 	gxapi::GraphicsPipelineStateDesc psoDesc;
@@ -15,7 +15,8 @@
 namespace inl::gxeng::nodes {
 
 /// <summary>
-/// Inputs: target, depth stencil, entities, camera, directional lights, shadow map, shadowMX, csmSplits, lightMVP
+/// Inputs: target, depth stencil, entities, camera, directional lights, shadow map, shadowMX, csmSplits, lightMVP,
+/// cluster data, cluster light indices, cluster light data
 /// </summary>
 class ForwardRender :
 	virtual public GraphicsNode,
@@ -31,6 +32,8 @@ class ForwardRender :
 		Texture2D,
 		Texture2D,
 		Texture2D,
+		Texture2D,
+		Texture2D,
 		Texture2D>,
 	virtual public exc::OutputPortConfig<Texture2D>
 {
@@ -53,6 +56,8 @@ private:
 		mathfu::VectorPacked<float, 4> m[4];
 		mathfu::VectorPacked<float, 4> v[4];
 		mathfu::VectorPacked<float, 4> p[4];
+		mathfu::VectorPacked<float, 4> positionScale;
+		mathfu::VectorPacked<float, 4> positionOffset;
 	};	
 	struct LightConstants {
 		alignas(16) mathfu::VectorPacked<float, 3> direction;
@@ -72,8 +77,8 @@ public:
 
 private:
 	static std::string GenerateVertexShader(const Mesh::Layout& layout);
-	static std::string GeneratePixelShader(const MaterialShader& shader);
-	Binder GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, std::vector<int>& offsets, size_t& materialCbSize);
+	static std::string GeneratePixelShader(const MaterialShader& shader, bool bindless);
+	Binder GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, bool bindless, std::vector<int>& offsets, size_t& materialCbSize);
 	std::unique_ptr<gxapi::IPipelineState> CreatePso(
 		RenderContext& context,
 		Binder& binder,
@@ -87,7 +92,8 @@ private:
 		const Mesh::Layout& layout,
 		const MaterialShader& shader,
 		gxapi::eFormat renderTargetFormat,
-		gxapi::eFormat depthStencilFormat);
+		gxapi::eFormat depthStencilFormat,
+		bool bindless);
 
 protected:
 	//std::optional<Binder> m_binder;
@@ -97,6 +103,9 @@ protected:
 	BindParameter m_shadowMapBindParam;
 	BindParameter m_shadowMXBindParam;
 	BindParameter m_csmSplitsBindParam;
+	// material textures are indexed from these arrays when the engine uses bindless descriptors
+	static constexpr BindParameter BindlessColorBindParam = BindParameter(eBindParameterType::TEXTURE, 0, 100);
+	static constexpr BindParameter BindlessValueBindParam = BindParameter(eBindParameterType::TEXTURE, 0, 101);
 
 private:
 	RenderTargetView2D m_rtv;
@@ -109,7 +118,9 @@ private:
 	TextureView2D m_shadowMXTexView;
 	TextureView2D m_csmSplitsTexView;
 	TextureView2D m_lightMVPTexView;
-	TextureView2D m_lightCullDataView;
+	TextureView2D m_clusterDataView;
+	TextureView2D m_clusterLightIndicesView;
+	TextureView2D m_clusterLightDataView;
 
 private:
 	struct ElementHash {
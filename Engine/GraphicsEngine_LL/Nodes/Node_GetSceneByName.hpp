@@ -4,6 +4,10 @@
 
 #include "../Scene.hpp"
 #include "../DirectionalLight.hpp"
+#include "../PointLight.hpp"
+#include "../SpotLight.hpp"
+#include "../FoliageEntity.hpp"
+#include "../TerrainEntity.hpp"
 
 namespace inl::gxeng::nodes {
 
@@ -11,7 +15,7 @@ namespace inl::gxeng::nodes {
 /// <summary>
 /// Get reference to a Scene identified by its name.
 /// Inputs: name of the scene.
-/// Outputs: list of mesh entities, overlay entities and directional lights.
+/// Outputs: list of mesh entities, overlay entities, directional lights, point lights, spot lights, foliage entities and terrain entities.
 /// </summary>
 /// <remarks>
 /// Throws an exception if the scene cannot be found, never returns nulls.
@@ -20,7 +24,14 @@ class GetSceneByName :
 	virtual public GraphicsNode,
 	virtual public GraphicsTask,
 	virtual public exc::InputPortConfig<std::string>,
-	virtual public exc::OutputPortConfig<const EntityCollection<MeshEntity>*, const EntityCollection<OverlayEntity>*, const EntityCollection<DirectionalLight>*>
+	virtual public exc::OutputPortConfig<
+		const EntityCollection<MeshEntity>*,
+		const EntityCollection<OverlayEntity>*,
+		const EntityCollection<DirectionalLight>*,
+		const EntityCollection<PointLight>*,
+		const EntityCollection<SpotLight>*,
+		const EntityCollection<FoliageEntity>*,
+		const EntityCollection<TerrainEntity>*>
 {
 public:
 	GetSceneByName() {}
@@ -55,6 +66,10 @@ public:
 		this->GetOutput<0>().Set(&match->GetMeshEntities());
 		this->GetOutput<1>().Set(&match->GetOverlayEntities());
 		this->GetOutput<2>().Set(&match->GetDirectionalLights());
+		this->GetOutput<3>().Set(&match->GetPointLights());
+		this->GetOutput<4>().Set(&match->GetSpotLights());
+		this->GetOutput<5>().Set(&match->GetFoliageEntities());
+		this->GetOutput<6>().Set(&match->GetTerrainEntities());
 	}
 
 	void Execute(RenderContext& context) {}
@@ -5,58 +5,38 @@
 #include "../MeshEntity.hpp"
 #include "../Mesh.hpp"
 #include "../Image.hpp"
-#include "../DirectionalLight.hpp"
 #include "../PerspectiveCamera.hpp"
 #include "../GraphicsCommandList.hpp"
 #include "../EntityCollection.hpp"
 
 #include <array>
+#include <cmath>
+#include <string>
 
 namespace inl::gxeng::nodes {
 
-struct light_data
+struct ClusterLightData
 {
-	mathfu::VectorPacked<float, 4> vs_position;
-	float attenuation_end;
-	mathfu::VectorPacked<float, 3> dummy;
+	mathfu::VectorPacked<float, 4> vs_position_range;
+	mathfu::VectorPacked<float, 4> vs_direction_cos_half_angle;
+	mathfu::VectorPacked<float, 4> color;
 };
 
 struct Uniforms
 {
-	light_data ld[10];
-	mathfu::VectorPacked<float, 4> p[4];
-	mathfu::VectorPacked<float, 4> far_plane0, far_plane1;
-	float cam_near, cam_far;
-	uint32_t num_lights, num_workgroups_x, num_workgroups_y;
+	uint32_t tiles_x, tiles_y, slices, num_lights;
+	float proj_scale_x, proj_scale_y, near_plane, far_plane;
+	uint32_t max_indices;
 	mathfu::VectorPacked<float, 3> dummy;
+	ClusterLightData lights[LightCulling::MAX_LIGHTS];
 };
 
-static void setWorkgroupSize(unsigned w, unsigned h, unsigned groupSizeW, unsigned groupSizeH, unsigned& dispatchW, unsigned& dispatchH)
-{
-	//set up work group sizes
-	unsigned gw = 0, gh = 0, count = 1;
-
-	while (gw < w)
-	{
-		gw = groupSizeW * count;
-		count++;
-	}
-
-	count = 1;
-
-	while (gh < h)
-	{
-		gh = groupSizeH * count;
-		count++;
-	}
-
-	dispatchW = unsigned(float(gw) / groupSizeW);
-	dispatchH = unsigned(float(gh) / groupSizeH);
-}
-
 
 LightCulling::LightCulling() {
-	this->GetInput<0>().Set({});
+	ClusterGridDesc defaultDesc;
+	this->GetInput<3>().Set(defaultDesc.tilesX);
+	this->GetInput<4>().Set(defaultDesc.tilesY);
+	this->GetInput<5>().Set(defaultDesc.depthSlices);
 }
 
 
@@ -65,135 +45,132 @@ void LightCulling::Initialize(EngineContext & context) {
 }
 
 void LightCulling::Reset() {
-	m_depthTexSrv = TextureView2D();
 	m_camera = nullptr;
-	//m_suns = nullptr;
+	m_pointLights = nullptr;
+	m_spotLights = nullptr;
 
 	GetInput<0>().Clear();
 	GetInput<1>().Clear();
-	//GetInput<2>().Clear();
+	GetInput<2>().Clear();
 }
 
 
 void LightCulling::Setup(SetupContext& context) {
-	Texture2D depthTex = this->GetInput<0>().Get();
-
-	if (depthTex.GetWidth() != m_width || depthTex.GetHeight() != m_height) {
-		m_width = depthTex.GetWidth();
-		m_height = depthTex.GetHeight();
-		InitRenderTarget(context);
+	m_camera = this->GetInput<0>().Get();
+	m_pointLights = this->GetInput<1>().Get();
+	m_spotLights = this->GetInput<2>().Get();
+
+	ClusterGridDesc gridDesc;
+	gridDesc.tilesX = this->GetInput<3>().Get();
+	gridDesc.tilesY = this->GetInput<4>().Get();
+	gridDesc.depthSlices = this->GetInput<5>().Get();
+	if (gridDesc.tilesX == 0 || gridDesc.tilesY == 0 || gridDesc.depthSlices == 0) {
+		throw std::invalid_argument("[LightCulling] Cluster grid must have at least one cluster along each axis.");
+	}
+	if (gridDesc.tilesX != m_gridDesc.tilesX || gridDesc.tilesY != m_gridDesc.tilesY || gridDesc.depthSlices != m_gridDesc.depthSlices) {
+		m_gridDesc = gridDesc;
+		InitRenderTargets(context);
 	}
-
-	gxapi::SrvTexture2DArray srvDesc;
-	srvDesc.activeArraySize = 1;
-	srvDesc.firstArrayElement = 0;
-	srvDesc.mipLevelClamping = 0;
-	srvDesc.mostDetailedMip = 0;
-	srvDesc.numMipLevels = 1;
-	srvDesc.planeIndex = 0;
-	m_depthTexSrv = context.CreateSrv(depthTex, FormatDepthToColor(depthTex.GetFormat()), srvDesc);
-	m_depthTexSrv.GetResource()._GetResourcePtr()->SetName("Light culling depth tex view");
-
-	m_camera = this->GetInput<1>().Get();
-	//m_suns = this->GetInput<2>().Get();
 
 	if (!m_binder.has_value()) {
 		BindParameterDesc uniformsBindParamDesc;
 		m_uniformsBindParam = BindParameter(eBindParameterType::CONSTANT, 0);
 		uniformsBindParamDesc.parameter = m_uniformsBindParam;
-		uniformsBindParamDesc.constantSize = sizeof(Uniforms); //TODO verify?
+		uniformsBindParamDesc.constantSize = sizeof(Uniforms);
 		uniformsBindParamDesc.relativeAccessFrequency = 0;
 		uniformsBindParamDesc.relativeChangeFrequency = 0;
 		uniformsBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
 
-		BindParameterDesc sampBindParamDesc;
-		sampBindParamDesc.parameter = BindParameter(eBindParameterType::SAMPLER, 0);
-		sampBindParamDesc.constantSize = 0;
-		sampBindParamDesc.relativeAccessFrequency = 0;
-		sampBindParamDesc.relativeChangeFrequency = 0;
-		sampBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
-
-		BindParameterDesc reductionBindParamDesc;
-		m_inputBindParam = BindParameter(eBindParameterType::TEXTURE, 0);
-		reductionBindParamDesc.parameter = m_inputBindParam;
-		reductionBindParamDesc.constantSize = 0;
-		reductionBindParamDesc.relativeAccessFrequency = 0;
-		reductionBindParamDesc.relativeChangeFrequency = 0;
-		reductionBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
-
-		BindParameterDesc outputBindParamDesc0;
-		m_outputBindParam = BindParameter(eBindParameterType::UNORDERED, 0);
-		outputBindParamDesc0.parameter = m_outputBindParam;
-		outputBindParamDesc0.constantSize = 0;
-		outputBindParamDesc0.relativeAccessFrequency = 0;
-		outputBindParamDesc0.relativeChangeFrequency = 0;
-		outputBindParamDesc0.shaderVisibility = gxapi::eShaderVisiblity::ALL;
-
-		gxapi::StaticSamplerDesc samplerDesc;
-		samplerDesc.shaderRegister = 0;
-		samplerDesc.filter = gxapi::eTextureFilterMode::MIN_MAG_MIP_LINEAR;
-		samplerDesc.addressU = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.addressV = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.addressW = gxapi::eTextureAddressMode::WRAP;
-		samplerDesc.mipLevelBias = 0.f;
-		samplerDesc.registerSpace = 0;
-		samplerDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
-
-		m_binder = context.CreateBinder({ uniformsBindParamDesc, sampBindParamDesc, reductionBindParamDesc, outputBindParamDesc0 },{ samplerDesc });
+		BindParameterDesc clusterDataBindParamDesc;
+		m_clusterDataBindParam = BindParameter(eBindParameterType::UNORDERED, 0);
+		clusterDataBindParamDesc.parameter = m_clusterDataBindParam;
+		clusterDataBindParamDesc.constantSize = 0;
+		clusterDataBindParamDesc.relativeAccessFrequency = 0;
+		clusterDataBindParamDesc.relativeChangeFrequency = 0;
+		clusterDataBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		BindParameterDesc lightIndicesBindParamDesc;
+		m_lightIndicesBindParam = BindParameter(eBindParameterType::UNORDERED, 1);
+		lightIndicesBindParamDesc.parameter = m_lightIndicesBindParam;
+		lightIndicesBindParamDesc.constantSize = 0;
+		lightIndicesBindParamDesc.relativeAccessFrequency = 0;
+		lightIndicesBindParamDesc.relativeChangeFrequency = 0;
+		lightIndicesBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		BindParameterDesc lightDataBindParamDesc;
+		m_lightDataBindParam = BindParameter(eBindParameterType::UNORDERED, 2);
+		lightDataBindParamDesc.parameter = m_lightDataBindParam;
+		lightDataBindParamDesc.constantSize = 0;
+		lightDataBindParamDesc.relativeAccessFrequency = 0;
+		lightDataBindParamDesc.relativeChangeFrequency = 0;
+		lightDataBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::ALL;
+
+		m_binder = context.CreateBinder({ uniformsBindParamDesc, clusterDataBindParamDesc, lightIndicesBindParamDesc, lightDataBindParamDesc });
 	}
 
-	if (!m_CSO) {
+	if (!m_CSOs[0]) {
 		ShaderParts shaderParts;
 		shaderParts.cs = true;
 
-		m_shader = context.CreateShader("LightCulling", shaderParts, "");
+		// the same source does counting, prefix sum and filling
+		for (int pass = 0; pass < 3; ++pass) {
+			m_shaders[pass] = context.CreateShader("LightCulling", shaderParts, "CLUSTER_PASS=" + std::to_string(pass));
 
-		gxapi::ComputePipelineStateDesc csoDesc;
-		csoDesc.rootSignature = m_binder->GetRootSignature();
-		csoDesc.cs = m_shader.cs;
+			gxapi::ComputePipelineStateDesc csoDesc;
+			csoDesc.rootSignature = m_binder->GetRootSignature();
+			csoDesc.cs = m_shaders[pass].cs;
 
-		m_CSO.reset(context.CreatePSO(csoDesc));
+			m_CSOs[pass].reset(context.CreatePSO(csoDesc));
+		}
 	}
 
-	this->GetOutput<0>().Set(m_lightCullDataUAV.GetResource());
+	this->GetOutput<0>().Set(m_clusterDataUAV.GetResource());
+	this->GetOutput<1>().Set(m_lightIndicesUAV.GetResource());
+	this->GetOutput<2>().Set(m_lightDataUAV.GetResource());
 }
 
 
 void LightCulling::Execute(RenderContext& context) {
 	ComputeCommandList& commandList = context.AsCompute();
 
-	Uniforms uniformsCBData;
-
-	uniformsCBData.cam_near = -m_camera->GetNearPlane();
-	uniformsCBData.cam_far = -m_camera->GetFarPlane();
-	uniformsCBData.num_lights = 1;
-	m_camera->GetProjectionMatrixRH().Pack(uniformsCBData.p);
+	const PerspectiveCamera* perspectiveCamera = dynamic_cast<const PerspectiveCamera*>(m_camera);
+	if (perspectiveCamera == nullptr) {
+		throw std::invalid_argument("[LightCulling] Clustered light culling only works with perspective camera.");
+	}
 
-	mathfu::Matrix4x4f invVP = (m_camera->GetProjectionMatrixRH() * m_camera->GetViewMatrixRH()).Inverse();
+	mathfu::Matrix4x4f view = perspectiveCamera->GetViewMatrixRH();
+	mathfu::Matrix4x4f projection = perspectiveCamera->GetProjectionMatrixRH();
+	ClusterGrid grid(m_gridDesc, projection(0, 0), projection(1, 1), perspectiveCamera->GetNearPlane(), perspectiveCamera->GetFarPlane());
 
-	mathfu::Vector4f ndcCorners[] = 
-	{
-		mathfu::Vector4f(-1, -1, -1, 1),
-		mathfu::Vector4f(1, 1, -1, 1),
+	Uniforms uniformsCBData;
+	uniformsCBData.tiles_x = m_gridDesc.tilesX;
+	uniformsCBData.tiles_y = m_gridDesc.tilesY;
+	uniformsCBData.slices = m_gridDesc.depthSlices;
+	uniformsCBData.proj_scale_x = grid.GetProjScaleX();
+	uniformsCBData.proj_scale_y = grid.GetProjScaleY();
+	uniformsCBData.near_plane = grid.GetNearPlane();
+	uniformsCBData.far_plane = grid.GetFarPlane();
+	uniformsCBData.max_indices = MAX_INDICES;
+
+	uint32_t numLights = 0;
+	auto AddLight = [&](const mathfu::Vector3f& position, const mathfu::Vector3f& direction, float range, float cosHalfAngle, const mathfu::Vector3f& color) {
+		if (numLights == MAX_LIGHTS) {
+			return;
+		}
+		mathfu::Vector4f vsPosition = view * mathfu::Vector4f(position, 1.0f);
+		mathfu::Vector4f vsDirection = view * mathfu::Vector4f(direction, 0.0f);
+		ClusterLightData& data = uniformsCBData.lights[numLights++];
+		data.vs_position_range = mathfu::Vector4f(vsPosition.xyz(), range);
+		data.vs_direction_cos_half_angle = mathfu::Vector4f(vsDirection.xyz(), cosHalfAngle);
+		data.color = mathfu::Vector4f(color, 1.0f);
 	};
-
-	//convert to world space frustum corners
-	ndcCorners[0] = invVP * ndcCorners[0];
-	ndcCorners[1] = invVP * ndcCorners[1];
-	ndcCorners[0] /= ndcCorners[0].w();
-	ndcCorners[1] /= ndcCorners[1].w();
-
-	uniformsCBData.far_plane0 = mathfu::Vector4f(ndcCorners[0].xyz(), ndcCorners[1].x());
-	uniformsCBData.far_plane1 = mathfu::Vector4f(ndcCorners[1].y(), ndcCorners[1].z(), 0, 0);
-
-	uniformsCBData.ld[0].vs_position = m_camera->GetViewMatrixRH() * mathfu::Vector4f(m_camera->GetPosition() + m_camera->GetLookDirection() * 5, 1.0f);
-	uniformsCBData.ld[0].attenuation_end = 5.0f;
-
-	uint32_t dispatchW, dispatchH;
-	setWorkgroupSize(m_width, m_height, 16, 16, dispatchW, dispatchH);
-
-	uniformsCBData.num_workgroups_x = dispatchW;
-	uniformsCBData.num_workgroups_y = dispatchH;
+	for (const PointLight* light : *m_pointLights) {
+		AddLight(light->GetPosition(), { 0, 0, -1 }, light->GetRange(), -1.0f, light->GetColor());
+	}
+	for (const SpotLight* light : *m_spotLights) {
+		AddLight(light->GetPosition(), light->GetDirection(), light->GetRange(), std::cos(light->GetHalfAngle()), light->GetColor());
+	}
+	uniformsCBData.num_lights = numLights;
 
 	//create single-frame only cb
 	gxeng::VolatileConstBuffer cb = context.CreateVolatileConstBuffer(&uniformsCBData, sizeof(Uniforms));
@@ -201,50 +178,59 @@ void LightCulling::Execute(RenderContext& context) {
 	gxeng::ConstBufferView cbv = context.CreateCbv(cb, 0, sizeof(Uniforms));
 	cbv.GetResource()._GetResourcePtr()->SetName("Light culling CBV");
 
-	commandList.SetResourceState(m_lightCullDataUAV.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS);
-	commandList.SetResourceState(m_depthTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+	commandList.SetResourceState(m_clusterDataUAV.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS);
+	commandList.SetResourceState(m_lightIndicesUAV.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS);
+	commandList.SetResourceState(m_lightDataUAV.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS);
 
-	commandList.SetPipelineState(m_CSO.get());
+	unsigned numClusterGroups = (grid.GetClusterCount() + CLUSTER_GROUP_SIZE - 1) / CLUSTER_GROUP_SIZE;
+
+	commandList.SetPipelineState(m_CSOs[0].get());
 	commandList.SetComputeBinder(&m_binder.value());
-	commandList.BindCompute(m_inputBindParam, m_depthTexSrv);
-	commandList.BindCompute(m_outputBindParam, m_lightCullDataUAV);
 	commandList.BindCompute(m_uniformsBindParam, cbv);
-	commandList.Dispatch(dispatchW, dispatchH, 1);
-	commandList.UAVBarrier(m_lightCullDataUAV.GetResource());
+	commandList.BindCompute(m_clusterDataBindParam, m_clusterDataUAV);
+	commandList.BindCompute(m_lightIndicesBindParam, m_lightIndicesUAV);
+	commandList.BindCompute(m_lightDataBindParam, m_lightDataUAV);
+	commandList.Dispatch(numClusterGroups, 1, 1);
+	commandList.UAVBarrier(m_clusterDataUAV.GetResource());
+
+	commandList.SetPipelineState(m_CSOs[1].get());
+	commandList.Dispatch(1, 1, 1);
+	commandList.UAVBarrier(m_clusterDataUAV.GetResource());
+	commandList.UAVBarrier(m_lightDataUAV.GetResource());
+
+	commandList.SetPipelineState(m_CSOs[2].get());
+	commandList.Dispatch(numClusterGroups, 1, 1);
+	commandList.UAVBarrier(m_lightIndicesUAV.GetResource());
 }
 
 
-void LightCulling::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
-
-		auto formatLightCullData = eFormat::R32_UINT;
-
-		gxapi::UavTexture2DArray uavDesc;
-		uavDesc.activeArraySize = 1;
-		uavDesc.firstArrayElement = 0;
-		uavDesc.mipLevel = 0;
-		uavDesc.planeIndex = 0;
-
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
-
-		uint32_t dispatchW, dispatchH;
-		setWorkgroupSize(m_width, m_height, 16, 16, dispatchW, dispatchH);
-
-		//TODO 1D tex
-		Texture2D lightCullDataTex = context.CreateRWTexture2D(dispatchW * dispatchH, 1024, formatLightCullData, 1);
-		lightCullDataTex._GetResourcePtr()->SetName("Light culling light cull data tex");
-		m_lightCullDataUAV = context.CreateUav(lightCullDataTex, formatLightCullData, uavDesc);
-		m_lightCullDataUAV.GetResource()._GetResourcePtr()->SetName("Light culling light cull data UAV");
-	}
+void LightCulling::InitRenderTargets(SetupContext& context) {
+	using gxapi::eFormat;
+
+	gxapi::UavTexture2DArray uavDesc;
+	uavDesc.activeArraySize = 1;
+	uavDesc.firstArrayElement = 0;
+	uavDesc.mipLevel = 0;
+	uavDesc.planeIndex = 0;
+
+	// offset and count of a cluster are side by side, depth slices are array slices
+	Texture2D clusterDataTex = context.CreateRWTexture2D(m_gridDesc.tilesX * 2, m_gridDesc.tilesY, eFormat::R32_UINT, false, (uint16_t)m_gridDesc.depthSlices);
+	clusterDataTex._GetResourcePtr()->SetName("Light culling cluster data tex");
+	uavDesc.activeArraySize = m_gridDesc.depthSlices;
+	m_clusterDataUAV = context.CreateUav(clusterDataTex, eFormat::R32_UINT, uavDesc);
+	m_clusterDataUAV.GetResource()._GetResourcePtr()->SetName("Light culling cluster data UAV");
+
+	// the index list would be a buffer, but nodes can only pass textures
+	Texture2D lightIndicesTex = context.CreateRWTexture2D(INDEX_LIST_WIDTH, MAX_INDICES / INDEX_LIST_WIDTH, eFormat::R32_UINT, false);
+	lightIndicesTex._GetResourcePtr()->SetName("Light culling light indices tex");
+	uavDesc.activeArraySize = 1;
+	m_lightIndicesUAV = context.CreateUav(lightIndicesTex, eFormat::R32_UINT, uavDesc);
+	m_lightIndicesUAV.GetResource()._GetResourcePtr()->SetName("Light culling light indices UAV");
+
+	Texture2D lightDataTex = context.CreateRWTexture2D(MAX_LIGHTS * 3, 1, eFormat::R32G32B32A32_FLOAT, false);
+	lightDataTex._GetResourcePtr()->SetName("Light culling light data tex");
+	m_lightDataUAV = context.CreateUav(lightDataTex, eFormat::R32G32B32A32_FLOAT, uavDesc);
+	m_lightDataUAV.GetResource()._GetResourcePtr()->SetName("Light culling light data UAV");
 }
 
 
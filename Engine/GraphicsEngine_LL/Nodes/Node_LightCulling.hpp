@@ -7,6 +7,9 @@
 #include "../Mesh.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "../PointLight.hpp"
+#include "../SpotLight.hpp"
+#include "../ClusteredLightCulling.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -15,12 +18,26 @@
 namespace inl::gxeng::nodes {
 
 
+/// <summary>
+/// Assigns the scene's point and spot lights to a froxel grid over the camera frustum.
+/// Inputs: camera, point lights, spot lights, number of tiles along x and y, number of depth slices.
+/// Outputs: per-cluster offset and count, compact light index list, light data in view space.
+/// </summary>
+/// <remarks>
+/// See ClusteredLightCulling.hpp for the layout of the grid and the CPU reference implementation.
+/// Lights past MAX_LIGHTS are ignored, clusters past MAX_INDICES get truncated lists.
+/// </remarks>
 class LightCulling :
 	virtual public GraphicsNode,
 	virtual public GraphicsTask,
-	virtual public exc::InputPortConfig<Texture2D, const BasicCamera*>,// const EntityCollection<PointLight>*>,
-	virtual public exc::OutputPortConfig<Texture2D>
+	virtual public exc::InputPortConfig<const BasicCamera*, const EntityCollection<PointLight>*, const EntityCollection<SpotLight>*, unsigned, unsigned, unsigned>,
+	virtual public exc::OutputPortConfig<Texture2D, Texture2D, Texture2D>
 {
+public:
+	static constexpr unsigned MAX_LIGHTS = 1024;
+	static constexpr unsigned INDEX_LIST_WIDTH = 4096;
+	static constexpr unsigned MAX_INDICES = INDEX_LIST_WIDTH * 64;
+	static constexpr unsigned CLUSTER_GROUP_SIZE = 64;
 public:
 	LightCulling();
 
@@ -34,25 +51,26 @@ public:
 
 protected:
 	std::optional<Binder> m_binder;
-	BindParameter m_inputBindParam;
-	BindParameter m_outputBindParam;
 	BindParameter m_uniformsBindParam;
-	ShaderProgram m_shader;
-	std::unique_ptr<gxapi::IPipelineState> m_CSO;
+	BindParameter m_clusterDataBindParam;
+	BindParameter m_lightIndicesBindParam;
+	BindParameter m_lightDataBindParam;
+	ShaderProgram m_shaders[3];
+	std::unique_ptr<gxapi::IPipelineState> m_CSOs[3];
 
 protected: // outputs
-	bool m_outputTexturesInited = false;
-	RWTextureView2D m_lightCullDataUAV;
+	ClusterGridDesc m_gridDesc = { 0, 0, 0 };
+	RWTextureView2D m_clusterDataUAV;
+	RWTextureView2D m_lightIndicesUAV;
+	RWTextureView2D m_lightDataUAV;
 
 protected: // render context
-	TextureView2D m_depthTexSrv;
 	const BasicCamera* m_camera;
-	//const EntityCollection<PointLight>* m_lights;
+	const EntityCollection<PointLight>* m_pointLights;
+	const EntityCollection<SpotLight>* m_spotLights;
 
 private:
-	uint64_t m_width = 0;
-	uint64_t m_height = 0;
-	void InitRenderTarget(SetupContext& context);
+	void InitRenderTargets(SetupContext& context);
 };
 
 
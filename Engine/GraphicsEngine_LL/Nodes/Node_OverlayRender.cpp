@@ -12,6 +12,7 @@
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 #include "Node_OverlayRender.hpp"
 
+#include <algorithm>
 #include <array>
 
 namespace inl::gxeng::nodes {
@@ -19,6 +20,7 @@ namespace inl::gxeng::nodes {
 
 static void ConvertToSubmittable(
 	Mesh* mesh,
+	size_t numStreams,
 	std::vector<const gxeng::VertexBuffer*>& vertexBuffers,
 	std::vector<unsigned>& sizes,
 	std::vector<unsigned>& strides
@@ -27,7 +29,8 @@ static void ConvertToSubmittable(
 	sizes.clear();
 	strides.clear();
 
-	for (int streamID = 0; streamID < mesh->GetNumStreams(); streamID++) {
+	assert(numStreams <= mesh->GetNumStreams());
+	for (int streamID = 0; streamID < numStreams; streamID++) {
 		vertexBuffers.push_back(&mesh->GetVertexBuffer(streamID));
 		sizes.push_back((unsigned)vertexBuffers.back()->GetSize());
 		strides.push_back((unsigned)mesh->GetVertexBufferStride(streamID));
@@ -77,8 +80,12 @@ void OverlayRender::Setup(SetupContext& context) {
 
 	InitColoredPso(context, target.GetFormat());
 	InitTexturedPso(context, target.GetFormat());
+	InitSpritePso(context, target.GetFormat());
 
 	m_renderTargetFormat = target.GetFormat();
+
+	InitAtlas(context);
+	BuildBatches(context);
 }
 
 
@@ -107,63 +114,172 @@ void OverlayRender::Execute(RenderContext& context) {
 	mathfu::Matrix4x4f projection = m_camera->GetProjectionMatrixRH();
 	auto viewProjection = projection * view;
 
-	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
-	std::vector<unsigned> sizes;
-	std::vector<unsigned> strides;
+	// textures placed into the atlas this frame
+	if (!m_atlasCopies.empty()) {
+		commandList.SetResourceState(m_atlas, gxapi::eResourceState::COPY_DEST);
+		for (const auto& copy : m_atlasCopies) {
+			const Texture2D& source = static_cast<const Image*>(copy.texture)->GetSrv()->GetResource();
+			commandList.SetResourceState(source, gxapi::eResourceState::COPY_SOURCE);
+			commandList.CopyTexture(m_atlas, source, SubTexture2D(0, copy.region.page, { (intptr_t)copy.region.x, (intptr_t)copy.region.y }));
+		}
+	}
+	commandList.SetResourceState(m_atlas, gxapi::eResourceState(gxapi::eResourceState::PIXEL_SHADER_RESOURCE) + gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE);
+
+	if (!m_spriteVertices.empty()) {
+		commandList.SetResourceState(m_spriteVertexBuffer, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+	}
+
+	// mesh entities go after the sprites of their layer
+	auto meshIt = m_meshEntities.begin();
+	for (const OverlayBatch& batch : m_batches) {
+		for (; meshIt != m_meshEntities.end() && (*meshIt)->GetLayer() < batch.layer; ++meshIt) {
+			DrawMeshEntity(commandList, *meshIt, viewProjection);
+		}
+		DrawBatch(commandList, batch, viewProjection);
+	}
+	for (; meshIt != m_meshEntities.end(); ++meshIt) {
+		DrawMeshEntity(commandList, *meshIt, viewProjection);
+	}
+}
+
+
+void OverlayRender::BuildBatches(SetupContext& context) {
+	m_sprites.clear();
+	m_meshEntities.clear();
 
-	// Iterate over all entities
 	for (const OverlayEntity* entity : *m_entities) {
 		if (entity->GetVisible() == false) {
 			continue;
 		}
 
-		Mesh* mesh = entity->GetMesh();
+		if (entity->GetMesh()) {
+			m_meshEntities.push_back(entity);
+			continue;
+		}
 
-		if (!CheckMeshFormat(mesh)) {
-			assert(false);
+		OverlaySprite sprite;
+		sprite.layer = entity->GetLayer();
+		sprite.transform = entity->GetTransform();
+		if (entity->GetSurfaceType() == OverlayEntity::COLORED) {
+			sprite.color = entity->GetColor();
 		}
+		else {
+			Image* texture = entity->GetTexture();
+			sprite.color = mathfu::Vector4f(1.0f);
+			sprite.texture = texture;
+			sprite.textureVersion = texture->GetVersion();
+			sprite.textureWidth = (uint32_t)texture->GetWidth();
+			sprite.textureHeight = (uint32_t)texture->GetHeight();
+			sprite.atlasCompatible = texture->GetSrv()->GetFormat() == AtlasFormat;
+		}
+		m_sprites.push_back(sprite);
+	}
 
-		auto world = entity->GetTransform();
-		auto MVP = viewProjection * world;
+	std::stable_sort(m_meshEntities.begin(), m_meshEntities.end(), [](const OverlayEntity* lhs, const OverlayEntity* rhs) {
+		return lhs->GetLayer() < rhs->GetLayer();
+	});
 
-		std::array<mathfu::VectorPacked<float, 4>, 4> transformCBData;
-		MVP.Pack(transformCBData.data());
+	m_batcher.Build(m_sprites, m_spriteVertices, m_batches, m_atlasCopies);
 
-		auto renderType = entity->GetSurfaceType();
-		if (renderType == OverlayEntity::COLORED) {
-			auto color = entity->GetColor();
-			if (color.w() == 0.f) {
-				continue;
-			}
+	// all batches share one vertex buffer, which only grows
+	if (m_spriteVertices.size() > m_spriteVertexCapacity) {
+		size_t capacity = std::max<size_t>(m_spriteVertexCapacity, 1024);
+		while (capacity < m_spriteVertices.size()) {
+			capacity *= 2;
+		}
+		size_t numVertices = m_spriteVertices.size();
+		m_spriteVertices.resize(capacity);
+		m_spriteVertexBuffer = context.CreateVertexBuffer(m_spriteVertices.data(), capacity * sizeof(OverlayVertex));
+		m_spriteVertices.resize(numVertices);
+		m_spriteVertexCapacity = capacity;
+	}
+	else if (!m_spriteVertices.empty()) {
+		context.Upload(m_spriteVertexBuffer, 0, m_spriteVertices.data(), m_spriteVertices.size() * sizeof(OverlayVertex));
+	}
+}
 
-			commandList.SetPipelineState(m_coloredPipeline.pso.get());
-			commandList.SetGraphicsBinder(&m_coloredPipeline.binder.value());
 
-			mathfu::VectorPacked<float, 4> colorCBData;
-			color.Pack(&colorCBData);
+void OverlayRender::DrawBatch(GraphicsCommandList& commandList, const OverlayBatch& batch, const mathfu::Matrix4x4f& viewProjection) {
+	std::array<mathfu::VectorPacked<float, 4>, 4> transformCBData;
+	viewProjection.Pack(transformCBData.data());
 
-			commandList.BindGraphics(m_coloredPipeline.transformParam, transformCBData.data(), sizeof(transformCBData));
-			commandList.BindGraphics(m_coloredPipeline.colorParam, colorCBData.data, sizeof(colorCBData));
-		}
-		else {
-			assert(renderType == OverlayEntity::TEXTURED);
-			commandList.SetPipelineState(m_texturedPipeline.pso.get());
-			commandList.SetGraphicsBinder(&m_texturedPipeline.binder.value());
-			commandList.SetResourceState(entity->GetTexture()->GetSrv()->GetResource(), 
-										 gxapi::eResourceState(gxapi::eResourceState::PIXEL_SHADER_RESOURCE) + gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE);
-			commandList.BindGraphics(m_texturedPipeline.textureParam, *entity->GetTexture()->GetSrv());
-			commandList.BindGraphics(m_texturedPipeline.transformParam, transformCBData.data(), sizeof(transformCBData));
-		}
+	commandList.SetPipelineState(m_spritePso.get());
+	commandList.SetGraphicsBinder(&m_texturedPipeline.binder.value());
+
+	if (batch.page >= 0) {
+		commandList.BindGraphics(m_texturedPipeline.textureParam, m_atlasPages[batch.page]);
+	}
+	else {
+		const TextureView2D& srv = *static_cast<const Image*>(batch.texture)->GetSrv();
+		commandList.SetResourceState(srv.GetResource(),
+									 gxapi::eResourceState(gxapi::eResourceState::PIXEL_SHADER_RESOURCE) + gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE);
+		commandList.BindGraphics(m_texturedPipeline.textureParam, srv);
+	}
+	commandList.BindGraphics(m_texturedPipeline.transformParam, transformCBData.data(), sizeof(transformCBData));
+
+	const VertexBuffer* vertexBuffer = &m_spriteVertexBuffer;
+	unsigned size = (unsigned)(m_spriteVertices.size() * sizeof(OverlayVertex));
+	unsigned stride = sizeof(OverlayVertex);
+	commandList.SetVertexBuffers(0, 1, &vertexBuffer, &size, &stride);
+	commandList.DrawInstanced(batch.numVertices, batch.firstVertex);
+}
+
+
+void OverlayRender::DrawMeshEntity(GraphicsCommandList& commandList, const OverlayEntity* entity, const mathfu::Matrix4x4f& viewProjection) {
+	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
+	std::vector<unsigned> sizes;
+	std::vector<unsigned> strides;
+
+	Mesh* mesh = entity->GetMesh();
+
+	if (!CheckMeshFormat(mesh)) {
+		assert(false);
+	}
 
-		ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
-		for (auto& vb : vertexBuffers) {
-			commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+	// positions are quantized, the decoding is folded into the transform
+	auto world = entity->GetTransform() * mesh->GetPositionDecodeMatrix();
+	auto MVP = viewProjection * world;
+
+	std::array<mathfu::VectorPacked<float, 4>, 4> transformCBData;
+	MVP.Pack(transformCBData.data());
+
+	auto renderType = entity->GetSurfaceType();
+	if (renderType == OverlayEntity::COLORED) {
+		auto color = entity->GetColor();
+		if (color.w() == 0.f) {
+			return;
 		}
-		commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
-		commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
-		commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+
+		commandList.SetPipelineState(m_coloredPipeline.pso.get());
+		commandList.SetGraphicsBinder(&m_coloredPipeline.binder.value());
+
+		mathfu::VectorPacked<float, 4> colorCBData;
+		color.Pack(&colorCBData);
+
+		commandList.BindGraphics(m_coloredPipeline.transformParam, transformCBData.data(), sizeof(transformCBData));
+		commandList.BindGraphics(m_coloredPipeline.colorParam, colorCBData.data, sizeof(colorCBData));
+	}
+	else {
+		assert(renderType == OverlayEntity::TEXTURED);
+		assert(mesh->GetNumStreams() > Mesh::ATTRIBUTE_STREAM);
+		commandList.SetPipelineState(m_texturedPipeline.pso.get());
+		commandList.SetGraphicsBinder(&m_texturedPipeline.binder.value());
+		commandList.SetResourceState(entity->GetTexture()->GetSrv()->GetResource(), 
+									 gxapi::eResourceState(gxapi::eResourceState::PIXEL_SHADER_RESOURCE) + gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE);
+		commandList.BindGraphics(m_texturedPipeline.textureParam, *entity->GetTexture()->GetSrv());
+		commandList.BindGraphics(m_texturedPipeline.transformParam, transformCBData.data(), sizeof(transformCBData));
 	}
+
+	// colored overlays need only the positions
+	size_t numStreams = renderType == OverlayEntity::COLORED ? 1 : mesh->GetNumStreams();
+	ConvertToSubmittable(mesh, numStreams, vertexBuffers, sizes, strides);
+	for (auto& vb : vertexBuffers) {
+		commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+	}
+	commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
+	commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
+	commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
+	commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
 }
 
 
@@ -274,7 +390,7 @@ void OverlayRender::InitColoredPso(SetupContext& context, gxapi::eFormat renderT
 	}
 	
 	std::vector<gxapi::InputElementDesc> inputElementDesc = {
-		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0)
+		gxapi::InputElementDesc("POSITION", 0, VertexElementCompressor<eVertexElementSemantic::POSITION>::Format(), Mesh::POSITION_STREAM, 0)
 	};
 
 	if (m_coloredPipeline.pso == nullptr || m_renderTargetFormat != renderTargetFormat) {
@@ -294,8 +410,8 @@ void OverlayRender::InitTexturedPso(SetupContext& context, gxapi::eFormat render
 	}
 
 	std::vector<gxapi::InputElementDesc> inputElementDesc = {
-		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-		gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 12),
+		gxapi::InputElementDesc("POSITION", 0, VertexElementCompressor<eVertexElementSemantic::POSITION>::Format(), Mesh::POSITION_STREAM, 0),
+		gxapi::InputElementDesc("TEX_COORD", 0, VertexElementCompressor<eVertexElementSemantic::TEX_COORD>::Format(), Mesh::ATTRIBUTE_STREAM, 0),
 	};
 
 	if (m_texturedPipeline.pso == nullptr || m_renderTargetFormat != renderTargetFormat) {
@@ -305,13 +421,67 @@ void OverlayRender::InitTexturedPso(SetupContext& context, gxapi::eFormat render
 }
 
 
+void OverlayRender::InitSpritePso(SetupContext& context, gxapi::eFormat renderTargetFormat) {
+	if (!m_spriteShader.vs || !m_spriteShader.ps) {
+		ShaderParts shaderParts;
+		shaderParts.vs = true;
+		shaderParts.ps = true;
+
+		m_spriteShader = context.CreateShader("OverlaySprite", shaderParts, "");
+	}
+
+	std::vector<gxapi::InputElementDesc> inputElementDesc = {
+		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32_FLOAT, 0, offsetof(OverlayVertex, position)),
+		gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, offsetof(OverlayVertex, texCoord)),
+		gxapi::InputElementDesc("COLOR", 0, gxapi::eFormat::R8G8B8A8_UNORM, 0, offsetof(OverlayVertex, color)),
+	};
+
+	if (m_spritePso == nullptr || m_renderTargetFormat != renderTargetFormat) {
+		gxapi::GraphicsPipelineStateDesc psoDesc = GetPsoDesc(inputElementDesc, m_spriteShader, m_texturedPipeline.binder.value(), renderTargetFormat);
+		m_spritePso.reset(context.CreatePSO(psoDesc));
+	}
+}
+
+
+void OverlayRender::InitAtlas(SetupContext& context) {
+	if (m_atlas.HasObject()) {
+		return;
+	}
+
+	m_atlas = context.CreateShaderResource2D(AtlasPageSize, AtlasPageSize, AtlasFormat, AtlasMaxPages);
+	m_atlas._GetResourcePtr()->SetName("Overlay render sprite atlas");
+
+	m_atlasPages.clear();
+	for (int page = 0; page < AtlasMaxPages; ++page) {
+		gxapi::SrvTexture2DArray srvDesc;
+		srvDesc.activeArraySize = 1;
+		srvDesc.firstArrayElement = page;
+		srvDesc.mipLevelClamping = 0;
+		srvDesc.mostDetailedMip = 0;
+		srvDesc.numMipLevels = 1;
+		srvDesc.planeIndex = 0;
+		m_atlasPages.push_back(context.CreateSrv(m_atlas, AtlasFormat, srvDesc));
+	}
+
+	// colored sprites sample this
+	AtlasRegion white = m_batcher.GetWhiteRegion();
+	std::vector<uint32_t> whitePixels(white.width * white.height, 0xFFFFFFFF);
+	context.Upload(m_atlas, white.x, white.y, whitePixels.data(), white.width, white.height, AtlasFormat);
+}
+
+
 bool OverlayRender::CheckMeshFormat(Mesh * mesh) {
-	for (size_t i = 0; i < mesh->GetNumStreams(); i++) {
-		auto& elements = mesh->GetLayout()[0];
-		if (elements.size() > 2) return false;
-		if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
-		if (elements[1].semantic != eVertexElementSemantic::TEX_COORD) return false;
-		if (elements[1].offset != 12) return false;
+	if (mesh->GetNumStreams() == 0 || mesh->GetNumStreams() > 2) return false;
+
+	auto& positionElements = mesh->GetLayout()[Mesh::POSITION_STREAM];
+	if (positionElements.size() != 1) return false;
+	if (positionElements[0].semantic != eVertexElementSemantic::POSITION) return false;
+
+	// texture coordinates are optional for colored overlays
+	if (mesh->GetNumStreams() > Mesh::ATTRIBUTE_STREAM) {
+		auto& attributeElements = mesh->GetLayout()[Mesh::ATTRIBUTE_STREAM];
+		if (attributeElements.size() != 1) return false;
+		if (attributeElements[0].semantic != eVertexElementSemantic::TEX_COORD) return false;
 	}
 
 	return true;
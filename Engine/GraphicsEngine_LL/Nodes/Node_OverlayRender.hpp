@@ -7,14 +7,18 @@
 #include "../Mesh.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "../OverlayBatcher.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
 #include <optional>
+#include <vector>
 
 namespace inl::gxeng::nodes {
 
 /// <summary>
+/// Sprites are sorted by layer and texture and drawn in batches, small textures are packed into an atlas for this.
+/// Entities with a mesh are drawn one by one, after the sprites of their layer.
 /// Inputs: framebuffer, overlay entites, overlay camera
 /// </summary>
 class OverlayRender :
@@ -55,6 +59,28 @@ protected:
 	ShaderProgram m_texturedShader;
 	TexturedPipelineObjects m_texturedPipeline;
 
+	// sprites use the bindings of the textured pipeline
+	ShaderProgram m_spriteShader;
+	std::unique_ptr<gxapi::IPipelineState> m_spritePso;
+
+protected: // sprite batching
+	static constexpr uint32_t AtlasPageSize = 1024;
+	static constexpr int AtlasMaxPages = 4;
+	static constexpr uint32_t AtlasMaxTextureSize = 256;
+	static constexpr gxapi::eFormat AtlasFormat = gxapi::eFormat::R8G8B8A8_UNORM;
+
+	OverlayBatcher m_batcher{ AtlasPageSize, AtlasMaxPages, AtlasMaxTextureSize };
+	Texture2D m_atlas;
+	std::vector<TextureView2D> m_atlasPages;
+	VertexBuffer m_spriteVertexBuffer;
+	size_t m_spriteVertexCapacity = 0;
+
+	std::vector<OverlaySprite> m_sprites;
+	std::vector<OverlayVertex> m_spriteVertices;
+	std::vector<OverlayBatch> m_batches;
+	std::vector<OverlayAtlasCopy> m_atlasCopies;
+	std::vector<const OverlayEntity*> m_meshEntities;
+
 protected:
 	void InitColoredBindings(SetupContext& context);
 	void InitTexturedBindings(SetupContext& context);
@@ -67,6 +93,12 @@ protected:
 
 	void InitColoredPso(SetupContext& context, gxapi::eFormat renderTargetFormat);
 	void InitTexturedPso(SetupContext& context, gxapi::eFormat renderTargetFormat);
+	void InitSpritePso(SetupContext& context, gxapi::eFormat renderTargetFormat);
+	void InitAtlas(SetupContext& context);
+
+	void BuildBatches(SetupContext& context);
+	void DrawBatch(GraphicsCommandList& commandList, const OverlayBatch& batch, const mathfu::Matrix4x4f& viewProjection);
+	void DrawMeshEntity(GraphicsCommandList& commandList, const OverlayEntity* entity, const mathfu::Matrix4x4f& viewProjection);
 
 	static bool CheckMeshFormat(Mesh* mesh);
 
@@ -1,15 +1,16 @@
 /*
 * Cascaded shadow mapping shader
-* Input: lightmvp texture
+* Input: model to cascade clip space transform
 * Output: shadow map for the specific cascade
+* Compiled twice: FOLIAGE=0 draws a single mesh, FOLIAGE=1 the instances of a foliage entity,
+* in which case the transform only goes from world space to cascade clip space.
 */
 
-Texture2D inputTex : register(t0); //lightMVP texture
-
 struct Uniforms
 {
-	float4x4 model;
-	uint cascadeIDX;
+	float4x4 mvp;
+	float4 positionScale; // foliage only, quantized mesh positions are decoded as pos*scale + offset
+	float4 positionOffset;
 };
 
 ConstantBuffer<Uniforms> uniforms : register(b0);
@@ -20,21 +21,44 @@ struct PS_Input
 };
 
 
+#if FOLIAGE == 0
+
 PS_Input VSMain(float4 position : POSITION)
 {
 	PS_Input result;
 
-	float4x4 light_mvp;
-	for (int d = 0; d < 4; ++d)
-	{
-		light_mvp[d] = inputTex.Load(int3(uniforms.cascadeIDX * 4 + d, 0, 0));
-	}
+	result.position = mul(uniforms.mvp, position);
+
+	return result;
+}
+
+#else
 
-	result.position = mul(mul(light_mvp, uniforms.model), position);
+// must match DrawFoliage.hlsl
+float3 RotateZ(float3 v, float angle)
+{
+	float s, c;
+	sincos(angle, s, c);
+	return float3(c * v.x - s * v.y, s * v.x + c * v.y, v.z);
+}
+
+
+PS_Input VSMain(float4 position : POSITION,
+				float3 instancePosition : INSTANCE_POSITION,
+				float2 instanceRotationScale : INSTANCE_ROTATION_SCALE)
+{
+	float3 localPosition = position.xyz * uniforms.positionScale.xyz + uniforms.positionOffset.xyz;
+	float3 worldPosition = RotateZ(localPosition, instanceRotationScale.x) * instanceRotationScale.y + instancePosition;
+
+	PS_Input result;
+
+	result.position = mul(uniforms.mvp, float4(worldPosition, 1.0f));
 
 	return result;
 }
 
+#endif
+
 
 void PSMain(PS_Input input)
 {
@@ -0,0 +1,39 @@
+/*
+ * Cascaded shadow map matrices shader
+ * Copies the cascades fitted on the CPU into the textures the forward pass samples.
+ * Output 0: Light MVP matrices for each cascade
+ * Output 1: Shadow matrices for each cascade
+ * Output 2: CSM splits for each cascade
+ */
+
+#define NUM_CASCADES 4
+
+RWTexture2D<float4> outputTex0 : register(u0);
+RWTexture2D<float4> outputTex1 : register(u1);
+RWTexture2D<float2> outputTex2 : register(u2);
+
+struct Uniforms
+{
+	float4x4 light_mvp[NUM_CASCADES];
+	float4x4 shadow_mx[NUM_CASCADES];
+	float4 splits[NUM_CASCADES];
+};
+
+ConstantBuffer<Uniforms> uniforms : register(b0);
+
+
+[numthreads(NUM_CASCADES * 4, 1, 1)]
+void CSMain(uint groupIndex : SV_GroupIndex)
+{
+	// one row of one matrix per thread
+	uint cascade = groupIndex / 4;
+	uint row = groupIndex % 4;
+
+	outputTex0[uint2(groupIndex, 0)] = uniforms.light_mvp[cascade][row];
+	outputTex1[uint2(groupIndex, 0)] = uniforms.shadow_mx[cascade][row];
+
+	if (groupIndex < NUM_CASCADES)
+	{
+		outputTex2[uint2(groupIndex, 0)] = uniforms.splits[groupIndex].xy;
+	}
+}
@@ -0,0 +1,111 @@
+/*
+ * Shading with the lights LightCulling assigned to the froxel under the pixel.
+ * Must match the grid layout in LightCulling.hlsl and ClusteredLightCulling.hpp.
+ */
+
+Texture2DArray<uint> clusterData : register(t600);
+Texture2D<uint> clusterLightIndices : register(t601);
+Texture2D<float4> clusterLightData : register(t602);
+
+#define CLUSTER_INDEX_LIST_WIDTH 4096
+
+struct ClusterUniforms
+{
+	float screen_width, screen_height;
+	uint tiles_x, tiles_y;
+	uint slices;
+	float slice_scale, slice_bias;
+	float dummy;
+};
+
+ConstantBuffer<ClusterUniforms> clusterUniforms : register(b600);
+
+float3 tonemap_func(float3 x, float a, float b, float c, float d, float e, float f)
+{
+	return ((x * (a * x + c * b) + d * e) / (x * (a * x + b) + d * f)) - e / f;
+}
+
+float3 tonemap(float3 col)
+{
+	//vec3 x = max( vec3(0), col - vec3(0.004));
+	//return ( x * (6.2 * x + 0.5) ) / ( x * ( 6.2 * x + 1.7 ) + 0.06 );
+
+	float a = 0.22; //Shoulder Strength
+	float b = 0.30; //Linear Strength
+	float c = 0.10; //Linear Angle
+	float d = 0.20; //Toe Strength
+	float e = 0.01; //Toe Numerator
+	float f = 0.30; //Toe Denominator
+	float linear_white = 11.2; //Linear White Point Value (11.2)
+							   //Note: E/F = Toe Angle
+
+	return tonemap_func(col, a, b, c, d, e, f) / tonemap_func(float3(linear_white, linear_white, linear_white), a, b, c, d, e, f);
+}
+
+//NOTE: actually, just use SRGB, it's got better quality!
+float3 linear_to_gamma(float3 col)
+{
+	return pow(col, float3(1 / 2.2, 1 / 2.2, 1 / 2.2));
+}
+
+float3 gamma_to_linear(float3 col)
+{
+	return pow(col, float3(2.2, 2.2, 2.2));
+}
+
+float3 get_clustered_lighting(float4 sv_position, //gl_FragCoord
+							  float4 albedo,
+							  float3 vs_normal,
+							  float4 vs_pos
+							)
+{
+	float2 screen_size = float2(clusterUniforms.screen_width, clusterUniforms.screen_height);
+	uint2 tile = min(uint2(sv_position.xy / screen_size * float2(clusterUniforms.tiles_x, clusterUniforms.tiles_y)),
+					 uint2(clusterUniforms.tiles_x - 1, clusterUniforms.tiles_y - 1));
+	float depth = max(-vs_pos.z, 1e-6);
+	uint slice = uint(clamp(floor(log(depth) * clusterUniforms.slice_scale + clusterUniforms.slice_bias), 0.0, float(clusterUniforms.slices - 1)));
+
+	uint offset = clusterData.Load(int4(tile.x * 2, tile.y, slice, 0));
+	uint count = clusterData.Load(int4(tile.x * 2 + 1, tile.y, slice, 0));
+
+	// the camera is at the origin of view space
+	float3 vs_view_dir = normalize(-vs_pos.xyz);
+
+	float3 color = float3(0, 0, 0);
+	for (uint c = 0; c < count; ++c)
+	{
+		uint list_index = offset + c;
+		uint index = clusterLightIndices.Load(int3(list_index % CLUSTER_INDEX_LIST_WIDTH, list_index / CLUSTER_INDEX_LIST_WIDTH, 0));
+		float4 position_range = clusterLightData.Load(int3(index * 3 + 0, 0, 0));
+		float4 direction_cos_half_angle = clusterLightData.Load(int3(index * 3 + 1, 0, 0));
+		float4 light_color = clusterLightData.Load(int3(index * 3 + 2, 0, 0));
+
+		float3 light_dir = position_range.xyz - vs_pos.xyz;
+		float distance = length(light_dir);
+		light_dir = light_dir / max(distance, 1e-6);
+
+		float attenuation = saturate(1.0 - distance / position_range.w);
+		attenuation *= attenuation;
+
+		float cos_half_angle = direction_cos_half_angle.w;
+		if (cos_half_angle > -1.0)
+		{
+			float cos_angle = dot(-light_dir, direction_cos_half_angle.xyz);
+			attenuation *= saturate((cos_angle - cos_half_angle) / max(1.0 - cos_half_angle, 1e-4));
+		}
+
+		if (attenuation > 0.0)
+		{
+			color += getCookTorranceBRDF(albedo.xyz,
+										 vs_normal,
+										 vs_view_dir,
+										 light_dir,
+										 light_color.xyz * attenuation, //TODO: shadow
+										 1.0, //TODO roughness
+										 0.0 //TODO metalness
+										);
+		}
+	}
+
+	return linear_to_gamma(tonemap(color));
+}
@@ -5,7 +5,6 @@
 struct Uniforms
 {
 	float4x4 vp;
-	float4 color;
 };
 
 ConstantBuffer<Uniforms> uniforms : register(b0);
@@ -13,14 +12,16 @@ ConstantBuffer<Uniforms> uniforms : register(b0);
 struct PS_Input
 {
 	float4 position : SV_POSITION;
+	float4 color : COLOR;
 };
 
 
-PS_Input VSMain(float4 position : POSITION)
+PS_Input VSMain(float4 position : POSITION, float4 color : COLOR)
 {
 	PS_Input result;
 
 	result.position = mul(uniforms.vp, position);
+	result.color = color;
 
 	return result;
 }
@@ -28,5 +29,5 @@ PS_Input VSMain(float4 position : POSITION)
 
 float4 PSMain(PS_Input input) : SV_TARGET
 {
-	return uniforms.color;
+	return input.color;
 }
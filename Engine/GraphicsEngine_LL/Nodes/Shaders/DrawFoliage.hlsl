@@ -0,0 +1,116 @@
+// Compiled twice: IMPOSTOR=0 draws the instanced mesh, IMPOSTOR=1 the camera facing billboards.
+
+struct Foliage
+{
+	float4x4 viewProj;
+	float4 cameraPosition;
+	float4 sunDirection; // towards the sun
+	float4 sunColor;
+	float4 positionScale; // quantized mesh positions are decoded as pos*scale + offset
+	float4 positionOffset;
+	float4 impostor; // x: half width, y: bottom, z: top, w: number of views
+	float4 alphaCutoff; // x only
+};
+
+ConstantBuffer<Foliage> foliage : register(b0);
+Texture2D<float4> albedoTex : register(t0);
+SamplerState theSampler : register(s0);
+
+static const float PI = 3.14159265f;
+static const float ambient = 0.25f;
+
+
+struct PS_Input
+{
+	float4 position : SV_POSITION;
+	float3 normal : NORMAL;
+	float2 texCoord : TEX_COORD;
+};
+
+
+float3 RotateZ(float3 v, float angle)
+{
+	float s, c;
+	sincos(angle, s, c);
+	return float3(c * v.x - s * v.y, s * v.x + c * v.y, v.z);
+}
+
+
+#if IMPOSTOR == 0
+
+// must match VertexElementCompressor<NORMAL>
+float3 DecodeOctahedralNormal(float2 e)
+{
+	float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += n.xy >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
+
+PS_Input VSMain(float4 position : POSITION,
+				float2 normal : NORMAL,
+				float2 texCoord : TEX_COORD,
+				float3 instancePosition : INSTANCE_POSITION,
+				float2 instanceRotationScale : INSTANCE_ROTATION_SCALE)
+{
+	float3 localPosition = position.xyz * foliage.positionScale.xyz + foliage.positionOffset.xyz;
+	float3 worldPosition = RotateZ(localPosition, instanceRotationScale.x) * instanceRotationScale.y + instancePosition;
+
+	PS_Input result;
+	result.position = mul(foliage.viewProj, float4(worldPosition, 1.0f));
+	result.normal = RotateZ(DecodeOctahedralNormal(normal), instanceRotationScale.x);
+	result.texCoord = texCoord;
+	return result;
+}
+
+#else
+
+PS_Input VSMain(uint vertexId : SV_VertexID,
+				float3 instancePosition : INSTANCE_POSITION,
+				float2 instanceRotationScale : INSTANCE_ROTATION_SCALE)
+{
+	static const float2 corners[6] = {
+		float2(-1, 0), float2(1, 0), float2(1, 1),
+		float2(-1, 0), float2(1, 1), float2(-1, 1),
+	};
+	float2 corner = corners[vertexId];
+
+	// cylindrical billboard: turns around the up axis only
+	float2 toCamera = foliage.cameraPosition.xy - instancePosition.xy;
+	toCamera = length(toCamera) > 1e-5f ? normalize(toCamera) : float2(1, 0);
+	float3 right = float3(-toCamera.y, toCamera.x, 0.0f);
+
+	float scale = instanceRotationScale.y;
+	float height = lerp(foliage.impostor.y, foliage.impostor.z, corner.y);
+	float3 worldPosition = instancePosition + right * (corner.x * foliage.impostor.x * scale) + float3(0, 0, height * scale);
+
+	// the view baked closest to the camera's direction in the instance's frame
+	float numViews = foliage.impostor.w;
+	float angle = atan2(toCamera.y, toCamera.x) - instanceRotationScale.x;
+	angle -= 2.0f * PI * floor(angle / (2.0f * PI));
+	float view = fmod(floor(angle / (2.0f * PI) * numViews + 0.5f), numViews);
+
+	PS_Input result;
+	result.position = mul(foliage.viewProj, float4(worldPosition, 1.0f));
+	result.normal = float3(toCamera, 0.0f);
+	result.texCoord = float2((view + corner.x * 0.5f + 0.5f) / numViews, 1.0f - corner.y);
+	return result;
+}
+
+#endif
+
+
+float4 PSMain(PS_Input input, bool isFrontFace : SV_IsFrontFace) : SV_TARGET
+{
+	float4 albedo = albedoTex.Sample(theSampler, input.texCoord);
+	clip(albedo.a - foliage.alphaCutoff.x);
+
+	float3 normal = normalize(input.normal);
+#if IMPOSTOR == 0
+	// leaves are two sided
+	normal *= isFrontFace ? 1.0f : -1.0f;
+#endif
+	float lambert = saturate(dot(normal, foliage.sunDirection.xyz));
+	return float4(albedo.rgb * foliage.sunColor.rgb * (lambert + ambient), 1.0f);
+}
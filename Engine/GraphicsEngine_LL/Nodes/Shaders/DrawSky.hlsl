@@ -3,6 +3,7 @@ struct Sun
 {
 	float4 dir; // world space
 	float4 color;
+	float4 atmosphere; // x: view height, y: atmosphere height, both in km
 };
 
 struct Cam
@@ -13,8 +14,23 @@ struct Cam
 
 ConstantBuffer<Sun> sun : register(b0);
 ConstantBuffer<Cam> cam : register(b1);
+Texture2D<float4> skyViewLut : register(t0);
+Texture2D<float4> transmittanceLut : register(t1);
 SamplerState theSampler : register(s0);
 
+static const float PI = 3.14159265f;
+// the lookup tables hold luminance per unit sun illuminance
+static const float skyExposure = 10.0f;
+
+
+// the tables store their edges at the first and last texel centers
+float2 LutUv(Texture2D<float4> lut, float2 uv)
+{
+	float2 size;
+	lut.GetDimensions(size.x, size.y);
+	return (uv * (size - 1) + 0.5f) / size;
+}
+
 
 struct PS_Input
 {
@@ -37,10 +53,20 @@ PS_Input VSMain(float3 position : POSITION)
 
 float4 PSMain(PS_Input input) : SV_TARGET
 {
-	//return float4(0.4, .75, 1.0, 1.0)*max(0.05, smoothstep(-0.15, 0.1, sun.dir.y));
-	float3 lookDir = normalize(input.worldPos - cam.position);
-	float horizon = pow(1.f - pow(dot(lookDir, float3(0, 0, 1)), 2), 10);
-	float corona = pow(0.5f + 0.5f*dot(-sun.dir, lookDir), 4);
-	float sundisk = saturate(600 * (dot(-sun.dir, lookDir) - 0.9993908270191));
-	return 0.8*((float4(0.6, 0.86, 1, 1.0)+sun.color)*0.5f*horizon + sun.color*(corona*0.6+sundisk) + float4(0.4, 0.78, 1, 1)*(1-horizon));
+	float3 lookDir = normalize(input.worldPos.xyz - cam.position.xyz);
+	float3 sunDir = -sun.dir.xyz;
+
+	// the sky is symmetric around the sun, so it is looked up by azimuth relative to the sun
+	float2 lookHorizontal = lookDir.xy / max(length(lookDir.xy), 1e-5f);
+	float2 sunHorizontal = sunDir.xy / max(length(sunDir.xy), 1e-5f);
+	float azimuth = acos(clamp(dot(lookHorizontal, sunHorizontal), -1.0f, 1.0f));
+	float elevation = asin(clamp(lookDir.z, -1.0f, 1.0f));
+	float2 skyViewUv = float2(azimuth / PI, 0.5f + 0.5f*sign(elevation)*sqrt(abs(elevation) / (0.5f*PI)));
+	float3 sky = skyViewLut.Sample(theSampler, LutUv(skyViewLut, skyViewUv)).rgb;
+
+	float2 transmittanceUv = float2(0.5f*sunDir.z + 0.5f, sqrt(saturate(sun.atmosphere.x / sun.atmosphere.y)));
+	float3 sunTransmittance = transmittanceLut.Sample(theSampler, LutUv(transmittanceLut, transmittanceUv)).rgb;
+	float sundisk = saturate(600 * (dot(sunDir, lookDir) - 0.9993908270191));
+
+	return float4(sun.color.rgb * (sky * skyExposure + sunTransmittance * sundisk), 1.0f);
 }
@@ -0,0 +1,38 @@
+struct Terrain
+{
+	float4x4 viewProj;
+	float4 terrainPosition; // world space position of the vertices' origin
+	float4 sunDirection; // towards the sun
+	float4 sunColor;
+	float4 materialColors[16];
+};
+
+ConstantBuffer<Terrain> terrain : register(b0);
+
+static const float ambient = 0.25f;
+
+
+struct PS_Input
+{
+	float4 position : SV_POSITION;
+	float3 normal : NORMAL;
+	nointerpolation uint material : MATERIAL;
+};
+
+
+PS_Input VSMain(float3 position : POSITION, float3 normal : NORMAL, uint material : MATERIAL)
+{
+	PS_Input result;
+	result.position = mul(terrain.viewProj, float4(position + terrain.terrainPosition.xyz, 1.0f));
+	result.normal = normal;
+	result.material = min(material, 15);
+	return result;
+}
+
+
+float4 PSMain(PS_Input input) : SV_TARGET
+{
+	float3 albedo = terrain.materialColors[input.material].rgb;
+	float lambert = saturate(dot(normalize(input.normal), terrain.sunDirection.xyz));
+	return float4(albedo * terrain.sunColor.rgb * (lambert + ambient), 1.0f);
+}
@@ -1,245 +1,205 @@
 /*
- * Light culing shader
- * Input: depth texture
- * Output 0: light indices + num of lights
+ * Clustered light culling shader
+ * Assigns point and spot lights to the froxels of the view frustum.
+ * Mirrors AssignLightsToClusters in ClusteredLightCulling.cpp, keep the two in sync.
+ * CLUSTER_PASS 0: count the lights of each cluster
+ * CLUSTER_PASS 1: prefix sum counts into offsets, copy light data
+ * CLUSTER_PASS 2: write light indices, in ascending order for each cluster
+ * Output 0: offset and count of each cluster, side by side along x, one array slice per depth slice
+ * Output 1: compact light index list, row major
+ * Output 2: light data, 3 texels per light
  */
 
-Texture2D inputTex : register(t0);
-RWTexture2D<uint> outputTex0 : register(u0);
+#define MAX_LIGHTS 1024
+#define INDEX_LIST_WIDTH 4096
+#define CLUSTER_GROUP_SIZE 64
+#define PREFIX_GROUP_SIZE 1024
 
-struct light_data
+struct ClusterLight
 {
-	float4 vs_position;
-	float attenuation_end;
-	float3 dummy;
+	float4 vs_position_range;
+	float4 vs_direction_cos_half_angle; // cos is -1 for point lights
+	float4 color;
 };
 
 struct Uniforms
 {
-	light_data ld[10];
-	float4x4 p;
-	float4 far_plane0, far_plane1;
-	float cam_near, cam_far; 
-	uint num_lights, num_workgroups_x, num_workgroups_y;
+	uint tiles_x, tiles_y, slices, num_lights;
+	float proj_scale_x, proj_scale_y, near_plane, far_plane;
+	uint max_indices;
 	float3 dummy;
+	ClusterLight lights[MAX_LIGHTS];
 };
 
 ConstantBuffer<Uniforms> uniforms : register(b0);
 
-#define FLT_MAX 3.402823466e+38
-
-#define LOCAL_SIZE_X 16
-#define LOCAL_SIZE_Y 16
-
-groupshared float localFar, localNear;
-groupshared int localNumLightsInput, localNumLightsOutput;
-groupshared float4 localLL, localUR;
-groupshared int localLights[1024];
-groupshared uint localMinDepth;
-groupshared uint localMaxDepth;
-groupshared uint localDepthMask;
-
-[numthreads(LOCAL_SIZE_X, LOCAL_SIZE_Y, 1)]
-void CSMain(
-	uint3 groupId : SV_GroupID, //WorkGroupId
-	uint3 groupThreadId : SV_GroupThreadID, //LocalInvocationId
-	uint3 dispatchThreadId : SV_DispatchThreadID, //GlobalInvocationId
-	uint groupIndex : SV_GroupIndex //LocalInvocationIndex
-)
-{
-	float proj_a, proj_b;
+RWTexture2DArray<uint> clusterData : register(u0);
+RWTexture2D<uint> lightIndices : register(u1);
+RWTexture2D<float4> lightData : register(u2);
 
-	uint3 inputTexSize;
-	inputTex.GetDimensions(0, inputTexSize.x, inputTexSize.y, inputTexSize.z);
 
-	float4 raw_depth = inputTex.Load(int3(dispatchThreadId.xy, 0));
+uint3 cluster_coords(uint cluster)
+{
+	return uint3(cluster % uniforms.tiles_x, (cluster / uniforms.tiles_x) % uniforms.tiles_y, cluster / (uniforms.tiles_x * uniforms.tiles_y));
+}
 
-	float max_depth = 0;
-	float min_depth = 1;
+float slice_depth(uint slice)
+{
+	return slice >= uniforms.slices ? uniforms.far_plane : uniforms.near_plane * pow(uniforms.far_plane / uniforms.near_plane, float(slice) / float(uniforms.slices));
+}
 
-	if (groupIndex == 0)
-	{
-		localLL = float4(uniforms.far_plane0.xyz, 1.0);
-		localUR = float4(uniforms.far_plane0.w, uniforms.far_plane1.xy, 1.0);
-		localFar = uniforms.cam_far; 
-		localNear = uniforms.cam_near; 
-		localNumLightsInput = uniforms.num_lights;
+void cluster_bounds(uint3 coords, out float3 minimum, out float3 maximum)
+{
+	float ndc_left = -1.0 + 2.0 * coords.x / uniforms.tiles_x;
+	float ndc_right = -1.0 + 2.0 * (coords.x + 1) / uniforms.tiles_x;
+	float ndc_top = 1.0 - 2.0 * coords.y / uniforms.tiles_y;
+	float ndc_bottom = 1.0 - 2.0 * (coords.y + 1) / uniforms.tiles_y;
+	float near_depth = slice_depth(coords.z);
+	float far_depth = slice_depth(coords.z + 1);
+
+	minimum = float3(min(ndc_left * near_depth, ndc_left * far_depth) / uniforms.proj_scale_x,
+					 min(ndc_bottom * near_depth, ndc_bottom * far_depth) / uniforms.proj_scale_y,
+					 -far_depth);
+	maximum = float3(max(ndc_right * near_depth, ndc_right * far_depth) / uniforms.proj_scale_x,
+					 max(ndc_top * near_depth, ndc_top * far_depth) / uniforms.proj_scale_y,
+					 -near_depth);
+}
 
-		localNumLightsOutput = 0;
+bool intersects(float3 minimum, float3 maximum, ClusterLight light)
+{
+	float3 position = light.vs_position_range.xyz;
+	float range = light.vs_position_range.w;
 
-		localMaxDepth = 0;
-		localMinDepth = 0x7f7fffff; // max float value
-		localDepthMask = 0;
+	// sphere vs box
+	float3 to_closest = max(minimum, min(position, maximum)) - position;
+	if (dot(to_closest, to_closest) > range * range)
+	{
+		return false;
 	}
 
-	GroupMemoryBarrierWithGroupSync(); //local memory barrier
-
-	float far = localFar;
-	float near = localNear;
-
-	//WARNING: need to linearize the depth in order to make it work...
-	proj_a = -(far + near) / (far - near);
-	proj_b = (-2 * far * near) / (far - near);
-	float linear_depth = -proj_b / (raw_depth.x * 2 - 1 + proj_a);
-	raw_depth.x = linear_depth / -far;
-
-	int num_of_lights = localNumLightsInput;
-	float3 ll, ur;
-	ll = localLL.xyz;
-	ur = localUR.xyz;
-
-	//check for skybox
-	bool early_rejection = (raw_depth.x > 0.999 || raw_depth.x < 0.001);
-
-	if (!early_rejection)
+	float cos_half_angle = light.vs_direction_cos_half_angle.w;
+	if (cos_half_angle <= -1.0)
 	{
-		float tmp_depth = raw_depth.x;
-
-		min_depth = min(min_depth, tmp_depth);
-		max_depth = max(max_depth, tmp_depth);
-
-		if (max_depth >= min_depth)
-		{
-			InterlockedMin(localMinDepth, asuint(min_depth));
-			InterlockedMax(localMaxDepth, asuint(max_depth));
-		}
+		return true;
 	}
 
-	GroupMemoryBarrierWithGroupSync(); //local memory barrier
+	// cone vs the bounding sphere of the box
+	float3 center = (minimum + maximum) * 0.5;
+	float radius = length(maximum - minimum) * 0.5;
+	float3 to_center = center - position;
+	float along_axis = dot(to_center, light.vs_direction_cos_half_angle.xyz);
+	float from_axis = sqrt(max(0.0, dot(to_center, to_center) - along_axis * along_axis));
+	float sin_half_angle = sqrt(max(0.0, 1.0 - cos_half_angle * cos_half_angle));
+	float distance_to_cone = cos_half_angle * from_axis - sin_half_angle * along_axis;
 
-	max_depth = asfloat(localMaxDepth);
-	min_depth = asfloat(localMinDepth);
-
-	float2 tile_scale = float2(inputTexSize.x, inputTexSize.y) * (1.0 / (LOCAL_SIZE_X + LOCAL_SIZE_Y));
-	float2 tile_bias = tile_scale - float2(groupId.x, groupId.y);
-
-	float proj_11 = uniforms.p[0].x;
-	float proj_22 = uniforms.p[1].y;
+	return distance_to_cone <= radius && along_axis >= -radius;
+}
 
-	float4 c1 = float4(proj_11 * tile_scale.x, 0.0, -tile_bias.x, 0.0);
-	float4 c2 = float4(0.0, proj_22 * tile_scale.y, -tile_bias.y, 0.0);
-	float4 c4 = float4(0.0, 0.0, -1.0, 0.0);
 
-	float4 frustum_planes[6];
+#if CLUSTER_PASS == 0
 
-	frustum_planes[0] = c4 - c1;
-	frustum_planes[1] = c4 + c1;
-	frustum_planes[2] = c4 - c2;
-	frustum_planes[3] = c4 + c2;
-	frustum_planes[4] = float4(0.0, 0.0, 1.0, -min_depth * far); 
-	frustum_planes[5] = float4(0.0, 0.0, 1.0, -max_depth * far); 
+[numthreads(CLUSTER_GROUP_SIZE, 1, 1)]
+void CSMain(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+	uint cluster = dispatchThreadId.x;
+	if (cluster >= uniforms.tiles_x * uniforms.tiles_y * uniforms.slices)
+	{
+		return;
+	}
 
-	frustum_planes[0].xyz = normalize(frustum_planes[0].xyz);
-	frustum_planes[1].xyz = normalize(frustum_planes[1].xyz);
-	frustum_planes[2].xyz = normalize(frustum_planes[2].xyz);
-	frustum_planes[3].xyz = normalize(frustum_planes[3].xyz);
+	uint3 coords = cluster_coords(cluster);
+	float3 minimum, maximum;
+	cluster_bounds(coords, minimum, maximum);
 
-	/*
-	* Calculate per tile depth mask for 2.5D light culling
-	*/
+	uint count = 0;
+	for (uint i = 0; i < uniforms.num_lights; ++i)
+	{
+		count += intersects(minimum, maximum, uniforms.lights[i]) ? 1 : 0;
+	}
 
-	/**/
-	float vs_min_depth = min_depth * -far;
-	float vs_max_depth = max_depth * -far;
-	float vs_depth = raw_depth.x * -far;
+	clusterData[uint3(coords.x * 2, coords.y, coords.z)] = 0;
+	clusterData[uint3(coords.x * 2 + 1, coords.y, coords.z)] = count;
+}
 
-	float range = abs(vs_max_depth - vs_min_depth + 0.00001) / 32.0; //depth range in each tile
+#elif CLUSTER_PASS == 1
 
-	vs_depth -= vs_min_depth; //so that min = 0
-	float depth_slot = floor(vs_depth / range);
+groupshared uint partialSums[PREFIX_GROUP_SIZE];
 
-	//determine the cell for each pixel in the tile
-	if (!early_rejection)
+[numthreads(PREFIX_GROUP_SIZE, 1, 1)]
+void CSMain(uint groupIndex : SV_GroupIndex)
+{
+	// every thread owns a contiguous run of clusters
+	uint num_clusters = uniforms.tiles_x * uniforms.tiles_y * uniforms.slices;
+	uint run_length = (num_clusters + PREFIX_GROUP_SIZE - 1) / PREFIX_GROUP_SIZE;
+	uint run_begin = min(groupIndex * run_length, num_clusters);
+	uint run_end = min(run_begin + run_length, num_clusters);
+
+	uint run_sum = 0;
+	for (uint cluster = run_begin; cluster < run_end; ++cluster)
 	{
-		//depth_mask = depth_mask | (1 << depth_slot)
-		InterlockedOr(localDepthMask, 1 << uint(depth_slot));
+		uint3 coords = cluster_coords(cluster);
+		run_sum += clusterData[uint3(coords.x * 2 + 1, coords.y, coords.z)];
 	}
+	partialSums[groupIndex] = run_sum;
+	GroupMemoryBarrierWithGroupSync();
 
-	GroupMemoryBarrierWithGroupSync(); //local memory barrier
-	/**/
-
-	for (uint c = groupIndex; c < num_of_lights; c += LOCAL_SIZE_X * LOCAL_SIZE_Y)
+	// inclusive scan of the runs
+	for (uint stride = 1; stride < PREFIX_GROUP_SIZE; stride *= 2)
 	{
-		bool in_frustum = true;
-		int index = int(c);
-
-		float att_end = uniforms.ld[index].attenuation_end;
-		float3 light_pos = uniforms.ld[index].vs_position.xyz;
-		float4 lp = float4(light_pos, 1.0);
-
-		/**/
-		//calculate per light bitmask
-		uint light_bitmask = 0;
-
-		float light_z_min = -(light_pos.z + att_end); //light z min [0 ... 1000]
-		float light_z_max = -(light_pos.z - att_end); //light z max [0 ... 1000]
-		light_z_min -= vs_min_depth; //so that min = 0
-		light_z_max -= vs_min_depth; //so that min = 0
-		float depth_slot_min = floor(light_z_min / range);
-		float depth_slot_max = floor(light_z_max / range);
-
-		if (!((depth_slot_max > 31.0 &&
-			depth_slot_min > 31.0) ||
-			(depth_slot_min < 0.0 &&
-				depth_slot_max < 0.0)))
-		{
-			if (depth_slot_max > 30.0)
-				light_bitmask = uint(~0);
-			else
-				light_bitmask = (1 << (uint(depth_slot_max)+1)) - 1;
-
-			if (depth_slot_min > 0.0)
-				light_bitmask -= (1 << uint(depth_slot_min)) - 1;
-		}
-
-		in_frustum = in_frustum && bool(localDepthMask & light_bitmask);
-		/**/
-
-		//manual unroll
-		{
-			float e = dot(frustum_planes[0], lp);
-			in_frustum = in_frustum && (e >= -att_end);
-		}
-		{
-			float e = dot(frustum_planes[1], lp);
-			in_frustum = in_frustum && (e >= -att_end);
-		}
-		{
-			float e = dot(frustum_planes[2], lp);
-			in_frustum = in_frustum && (e >= -att_end);
-		}
-		{
-			float e = dot(frustum_planes[3], lp);
-			in_frustum = in_frustum && (e >= -att_end);
-		}
-		{
-			float e = dot(frustum_planes[4], lp);
-			in_frustum = in_frustum && (e <= att_end);
-		}
-		{
-			float e = dot(frustum_planes[5], lp);
-			in_frustum = in_frustum && (e >= -att_end);
-		}
+		uint value = groupIndex >= stride ? partialSums[groupIndex - stride] : 0;
+		GroupMemoryBarrierWithGroupSync();
+		partialSums[groupIndex] += value;
+		GroupMemoryBarrierWithGroupSync();
+	}
 
-		if (in_frustum)
-		{
-			localLights[localNumLightsOutput] = int(index);
-			InterlockedAdd(localNumLightsOutput, 1);
-		}
+	// clusters past the capacity are cut short
+	uint running_offset = partialSums[groupIndex] - run_sum;
+	for (uint c = run_begin; c < run_end; ++c)
+	{
+		uint3 coords = cluster_coords(c);
+		uint count = clusterData[uint3(coords.x * 2 + 1, coords.y, coords.z)];
+		uint offset = min(running_offset, uniforms.max_indices);
+		clusterData[uint3(coords.x * 2, coords.y, coords.z)] = offset;
+		clusterData[uint3(coords.x * 2 + 1, coords.y, coords.z)] = min(count, uniforms.max_indices - offset);
+		running_offset += count;
 	}
 
-	localLights[localNumLightsOutput] = int(0);
-	localNumLightsOutput = 1;
+	for (uint i = groupIndex; i < uniforms.num_lights; i += PREFIX_GROUP_SIZE)
+	{
+		lightData[uint2(i * 3 + 0, 0)] = uniforms.lights[i].vs_position_range;
+		lightData[uint2(i * 3 + 1, 0)] = uniforms.lights[i].vs_direction_cos_half_angle;
+		lightData[uint2(i * 3 + 2, 0)] = uniforms.lights[i].color;
+	}
+}
 
-	GroupMemoryBarrierWithGroupSync(); //local memory barrier
+#elif CLUSTER_PASS == 2
 
-	if (groupIndex == 0)
+[numthreads(CLUSTER_GROUP_SIZE, 1, 1)]
+void CSMain(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+	uint cluster = dispatchThreadId.x;
+	if (cluster >= uniforms.tiles_x * uniforms.tiles_y * uniforms.slices)
 	{
-		outputTex0[int2(groupId.x * uniforms.num_workgroups_y + groupId.y, 0)] = uint(localNumLightsOutput);
+		return;
 	}
 
-	for (uint c = groupIndex; c < localNumLightsOutput; c += LOCAL_SIZE_X * LOCAL_SIZE_Y)
+	uint3 coords = cluster_coords(cluster);
+	uint offset = clusterData[uint3(coords.x * 2, coords.y, coords.z)];
+	uint count = clusterData[uint3(coords.x * 2 + 1, coords.y, coords.z)];
+
+	float3 minimum, maximum;
+	cluster_bounds(coords, minimum, maximum);
+
+	uint written = 0;
+	for (uint i = 0; i < uniforms.num_lights && written < count; ++i)
 	{
-		outputTex0[int2(groupId.x * uniforms.num_workgroups_y + groupId.y, c + 1)] = uint(localLights[c]);
+		if (intersects(minimum, maximum, uniforms.lights[i]))
+		{
+			uint index = offset + written;
+			lightIndices[uint2(index % INDEX_LIST_WIDTH, index / INDEX_LIST_WIDTH)] = i;
+			++written;
+		}
 	}
 }
+
+#endif
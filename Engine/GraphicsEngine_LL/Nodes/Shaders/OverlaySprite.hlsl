@@ -0,0 +1,36 @@
+
+struct Transform
+{
+	float4x4 VP;
+};
+
+ConstantBuffer<Transform> transform : register(b0);
+
+SamplerState theSampler : register(s0);
+Texture2D<float4> tex : register(t0);
+
+
+struct PS_Input
+{
+	float4 position : SV_POSITION;
+	float2 texCoord : TEX_COORD;
+	float4 color : COLOR;
+};
+
+
+PS_Input VSMain(float2 position : POSITION, float2 texCoord : TEX_COORD, float4 color : COLOR)
+{
+	PS_Input result;
+
+	float4 pos = {position.x, position.y, 0, 1};
+	result.position = mul(transform.VP, pos);
+	result.texCoord = texCoord;
+	result.color = color;
+
+	return result;
+}
+
+float4 PSMain(PS_Input input) : SV_TARGET
+{
+	return tex.Sample(theSampler, input.texCoord) * input.color;
+}
@@ -0,0 +1,252 @@
+#include "OverlayBatcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+//------------------------------------------------------------------------------
+// Atlas packer
+//------------------------------------------------------------------------------
+
+TextureAtlasPacker::TextureAtlasPacker(uint32_t pageSize, int maxPages)
+	: m_pageSize(pageSize),
+	m_maxPages(maxPages)
+{
+	if (pageSize == 0 || maxPages <= 0) {
+		throw std::invalid_argument("Atlas must have at least one page of non-zero size.");
+	}
+}
+
+
+std::optional<AtlasRegion> TextureAtlasPacker::Insert(uint32_t width, uint32_t height) {
+	if (width == 0 || height == 0 || width > m_pageSize || height > m_pageSize) {
+		return {};
+	}
+
+	for (int page = 0; page < (int)m_pages.size(); ++page) {
+		if (auto region = InsertIntoPage(page, width, height)) {
+			return region;
+		}
+	}
+
+	if ((int)m_pages.size() < m_maxPages) {
+		m_pages.emplace_back();
+		return InsertIntoPage((int)m_pages.size() - 1, width, height);
+	}
+
+	return {};
+}
+
+
+void TextureAtlasPacker::Clear() {
+	m_pages.clear();
+}
+
+
+std::optional<AtlasRegion> TextureAtlasPacker::InsertIntoPage(int pageIndex, uint32_t width, uint32_t height) {
+	Page& page = m_pages[pageIndex];
+
+	// lowest shelf that is tall enough, so that small rectangles don't waste tall shelves
+	Shelf* best = nullptr;
+	for (auto& shelf : page.shelves) {
+		if (shelf.height >= height && m_pageSize - shelf.width >= width) {
+			if (!best || shelf.height < best->height) {
+				best = &shelf;
+			}
+		}
+	}
+
+	if (!best) {
+		if (m_pageSize - page.height < height) {
+			return {};
+		}
+		page.shelves.push_back({ page.height, height, 0 });
+		page.height += height;
+		best = &page.shelves.back();
+	}
+
+	AtlasRegion region{ pageIndex, best->width, best->y, width, height };
+	best->width += width;
+	return region;
+}
+
+
+//------------------------------------------------------------------------------
+// Batcher
+//------------------------------------------------------------------------------
+
+OverlayBatcher::OverlayBatcher(uint32_t pageSize, int maxPages, uint32_t maxAtlasedSize)
+	: m_packer(pageSize, maxPages),
+	m_maxAtlasedSize(std::min(maxAtlasedSize, pageSize))
+{
+	ResetAtlas();
+}
+
+
+uint32_t OverlayBatcher::PackColor(mathfu::Vector<float, 4> color) {
+	auto Channel = [](float value) {
+		return (uint32_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+	};
+	return Channel(color.x()) | (Channel(color.y()) << 8) | (Channel(color.z()) << 16) | (Channel(color.w()) << 24);
+}
+
+
+void OverlayBatcher::ResetAtlas() {
+	m_packer.Clear();
+	m_entries.clear();
+	m_whiteRegion = m_packer.Insert(WhiteBlockSize, WhiteBlockSize).value();
+}
+
+
+bool OverlayBatcher::PlaceTextures(const std::vector<OverlaySprite>& sprites, std::vector<OverlayAtlasCopy>& copies) {
+	bool allPlaced = true;
+
+	for (const auto& sprite : sprites) {
+		if (!sprite.texture
+			|| !sprite.atlasCompatible
+			|| sprite.textureWidth > m_maxAtlasedSize
+			|| sprite.textureHeight > m_maxAtlasedSize)
+		{
+			continue;
+		}
+
+		auto it = m_entries.find(sprite.texture);
+		if (it != m_entries.end()) {
+			AtlasEntry& entry = it->second;
+			entry.lastUsed = m_frame;
+			if (entry.version == sprite.textureVersion) {
+				continue;
+			}
+			// contents changed, the old place is reused if the size is the same
+			if (entry.region.width == sprite.textureWidth && entry.region.height == sprite.textureHeight) {
+				entry.version = sprite.textureVersion;
+				copies.push_back({ sprite.texture, entry.region });
+				continue;
+			}
+			m_entries.erase(it);
+		}
+
+		auto region = m_packer.Insert(sprite.textureWidth, sprite.textureHeight);
+		if (!region) {
+			allPlaced = false;
+			continue;
+		}
+		m_entries.insert({ sprite.texture, AtlasEntry{ *region, sprite.textureVersion, m_frame } });
+		copies.push_back({ sprite.texture, *region });
+	}
+
+	return allPlaced;
+}
+
+
+void OverlayBatcher::EvictUnused() {
+	// the texture may have been freed, its address must not find the old contents
+	for (auto it = m_entries.begin(); it != m_entries.end();) {
+		it = it->second.lastUsed != m_frame ? m_entries.erase(it) : std::next(it);
+	}
+}
+
+
+void OverlayBatcher::Build(const std::vector<OverlaySprite>& sprites,
+						   std::vector<OverlayVertex>& vertices,
+						   std::vector<OverlayBatch>& batches,
+						   std::vector<OverlayAtlasCopy>& copies)
+{
+	vertices.clear();
+	batches.clear();
+	copies.clear();
+	++m_frame;
+
+	if (!PlaceTextures(sprites, copies)) {
+		// what does not fit even into an empty atlas is drawn from its own texture
+		ResetAtlas();
+		copies.clear();
+		PlaceTextures(sprites, copies);
+	}
+	EvictUnused();
+
+	// find the texture of each sprite and sort them
+	m_order.clear();
+	m_regions.resize(sprites.size());
+	for (uint32_t i = 0; i < (uint32_t)sprites.size(); ++i) {
+		const OverlaySprite& sprite = sprites[i];
+		if (sprite.color.w() <= 0.0f) {
+			continue;
+		}
+
+		const AtlasRegion* region = nullptr;
+		if (!sprite.texture) {
+			region = &m_whiteRegion;
+		}
+		else {
+			auto it = m_entries.find(sprite.texture);
+			if (it != m_entries.end()) {
+				region = &it->second.region;
+			}
+		}
+		m_regions[i] = region;
+
+		if (region) {
+			m_order.push_back({ sprite.layer, region->page, nullptr, i });
+		}
+		else {
+			m_order.push_back({ sprite.layer, -1, sprite.texture, i });
+		}
+	}
+
+	std::sort(m_order.begin(), m_order.end(), [](const SortKey& lhs, const SortKey& rhs) {
+		if (lhs.layer != rhs.layer) return lhs.layer < rhs.layer;
+		if (lhs.page != rhs.page) return lhs.page < rhs.page;
+		if (lhs.texture != rhs.texture) return std::less<const void*>()(lhs.texture, rhs.texture);
+		return lhs.sprite < rhs.sprite;
+	});
+
+	// expand quads, merging sprites with the same texture
+	static constexpr float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+	const float pageSize = (float)m_packer.GetPageSize();
+
+	vertices.reserve(6 * m_order.size());
+	for (const SortKey& key : m_order) {
+		const OverlaySprite& sprite = sprites[key.sprite];
+		const AtlasRegion* region = m_regions[key.sprite];
+		uint32_t color = PackColor(sprite.color);
+
+		for (auto& corner : corners) {
+			mathfu::Vector<float, 4> position = sprite.transform * mathfu::Vector<float, 4>(corner[0], corner[1], 0.0f, 1.0f);
+			// textures are stored top row first
+			float s = corner[0];
+			float t = 1.0f - corner[1];
+			if (region) {
+				// texel centers on the edges of the region, so filtering does not read the neighbours
+				s = (region->x + 0.5f + s * (region->width - 1)) / pageSize;
+				t = (region->y + 0.5f + t * (region->height - 1)) / pageSize;
+			}
+
+			OverlayVertex vertex;
+			vertex.position = mathfu::VectorPacked<float, 2>(position.xy());
+			vertex.texCoord = mathfu::VectorPacked<float, 2>(mathfu::Vector<float, 2>(s, t));
+			vertex.color = color;
+			vertices.push_back(vertex);
+		}
+
+		if (!batches.empty()
+			&& batches.back().layer == key.layer
+			&& batches.back().page == key.page
+			&& batches.back().texture == key.texture)
+		{
+			batches.back().numVertices += 6;
+		}
+		else {
+			batches.push_back({ key.layer, key.page, key.texture, (uint32_t)vertices.size() - 6, 6 });
+		}
+	}
+}
+
+
+} // namespace inl::gxeng
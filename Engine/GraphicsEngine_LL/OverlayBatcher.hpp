@@ -0,0 +1,165 @@
+#pragma once
+
+#include <mathfu/vector.h>
+#include <mathfu/matrix_4x4.h>
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Rectangle of texels on one page of an atlas. </summary>
+struct AtlasRegion {
+	int page;
+	uint32_t x, y;
+	uint32_t width, height;
+};
+
+
+/// <summary>
+/// Packs rectangles onto square pages using shelves: rectangles are placed left to right on horizontal shelves,
+/// a new shelf is opened below the last one when none of them has room.
+/// </summary>
+class TextureAtlasPacker {
+public:
+	/// <exception cref="std::invalid_argument"> If the page size or the page count is zero. </exception>
+	TextureAtlasPacker(uint32_t pageSize, int maxPages);
+
+	/// <returns> The placement of the rectangle, or nothing if it fits on none of the pages. </returns>
+	std::optional<AtlasRegion> Insert(uint32_t width, uint32_t height);
+	void Clear();
+
+	uint32_t GetPageSize() const { return m_pageSize; }
+	int GetMaxPages() const { return m_maxPages; }
+	/// <summary> Number of pages that have anything on them. </summary>
+	int GetPageCount() const { return (int)m_pages.size(); }
+private:
+	struct Shelf {
+		uint32_t y;
+		uint32_t height;
+		uint32_t width; // used so far
+	};
+	struct Page {
+		std::vector<Shelf> shelves;
+		uint32_t height = 0; // used so far
+	};
+
+	std::optional<AtlasRegion> InsertIntoPage(int page, uint32_t width, uint32_t height);
+
+	uint32_t m_pageSize;
+	int m_maxPages;
+	std::vector<Page> m_pages;
+};
+
+
+/// <summary> Vertex of the batched overlay quads. </summary>
+struct OverlayVertex {
+	mathfu::VectorPacked<float, 2> position;
+	mathfu::VectorPacked<float, 2> texCoord;
+	/// <summary> RGBA8, red in the lowest byte. </summary>
+	uint32_t color;
+};
+
+
+/// <summary> A quad to draw, it is the unit square transformed by the transform. </summary>
+struct OverlaySprite {
+	int layer = 0;
+	mathfu::Matrix<float, 4, 4> transform;
+	/// <summary> Multiplies the texture, or the color of the whole sprite when there is no texture. </summary>
+	mathfu::Vector<float, 4> color;
+
+	/// <summary> Identifies the texture, null for plain colored sprites. </summary>
+	const void* texture = nullptr;
+	/// <summary> Changes when the contents of the texture change, so that the atlas copy is refreshed.
+	///		Must not repeat for a different texture at the same address, see <see cref="Image::GetVersion"/>. </summary>
+	uint64_t textureVersion = 0;
+	uint32_t textureWidth = 0;
+	uint32_t textureHeight = 0;
+	/// <summary> The texture's format is the one of the atlas, so it can be copied there. </summary>
+	bool atlasCompatible = false;
+};
+
+
+/// <summary> Consecutive vertices drawn with the same texture. </summary>
+struct OverlayBatch {
+	int layer;
+	/// <summary> The atlas page sampled by the batch, -1 if the batch samples its own texture. </summary>
+	int page;
+	/// <summary> The texture sampled when page is -1. </summary>
+	const void* texture;
+	uint32_t firstVertex;
+	uint32_t numVertices;
+};
+
+
+/// <summary> A texture that has to be copied into the atlas before the batches are drawn. </summary>
+struct OverlayAtlasCopy {
+	const void* texture;
+	AtlasRegion region;
+};
+
+
+/// <summary>
+/// Sorts sprites by layer and texture and expands them into one vertex list, two triangles per sprite.
+/// Small textures are packed into the atlas, so all sprites of a layer sampling the same atlas page end up in one batch.
+/// Colored sprites sample a white block reserved at the corner of the first page, they are batched with that page.
+/// Within a layer, only the order of sprites in the same batch is kept.
+/// Textures not drawn in a frame are dropped from the atlas, their room is reclaimed the next time the atlas runs out of it:
+/// then it is cleared and only the textures of the current frame are placed again.
+/// </summary>
+class OverlayBatcher {
+public:
+	static constexpr uint32_t WhiteBlockSize = 4;
+
+public:
+	/// <param name="maxAtlasedSize"> Textures larger than this in either direction are never put into the atlas. </param>
+	OverlayBatcher(uint32_t pageSize = 1024, int maxPages = 4, uint32_t maxAtlasedSize = 256);
+
+	/// <summary> Builds the vertices and batches of the frame, the outputs are cleared first. </summary>
+	/// <param name="copies"> Textures that were (re)placed in the atlas, their contents must be copied there. </param>
+	void Build(const std::vector<OverlaySprite>& sprites,
+			   std::vector<OverlayVertex>& vertices,
+			   std::vector<OverlayBatch>& batches,
+			   std::vector<OverlayAtlasCopy>& copies);
+
+	const TextureAtlasPacker& GetPacker() const { return m_packer; }
+	/// <summary> Texels that must be white for colored sprites. </summary>
+	AtlasRegion GetWhiteRegion() const { return m_whiteRegion; }
+
+	static uint32_t PackColor(mathfu::Vector<float, 4> color);
+
+private:
+	struct AtlasEntry {
+		AtlasRegion region;
+		uint64_t version;
+		uint64_t lastUsed;
+	};
+
+	/// <returns> False if the atlas is full. </returns>
+	bool PlaceTextures(const std::vector<OverlaySprite>& sprites, std::vector<OverlayAtlasCopy>& copies);
+	void ResetAtlas();
+	void EvictUnused();
+
+	TextureAtlasPacker m_packer;
+	uint32_t m_maxAtlasedSize;
+	AtlasRegion m_whiteRegion;
+	std::unordered_map<const void*, AtlasEntry> m_entries;
+	uint64_t m_frame = 0;
+
+	// to avoid reallocating every frame
+	struct SortKey {
+		int layer;
+		int page;
+		const void* texture;
+		uint32_t sprite;
+	};
+	std::vector<SortKey> m_order;
+	std::vector<const AtlasRegion*> m_regions;
+};
+
+
+} // namespace inl::gxeng
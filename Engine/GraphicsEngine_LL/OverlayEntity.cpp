@@ -10,6 +10,7 @@ OverlayEntity::OverlayEntity() {
 	m_scale = mathfu::Vector2f(1, 1);
 	m_rotation = 0;
 	m_visible = true;
+	m_layer = 0;
 	m_mesh = nullptr;
 }
 
@@ -34,6 +35,16 @@ Mesh * OverlayEntity::GetMesh() const {
 }
 
 
+void OverlayEntity::SetLayer(int layer) {
+	m_layer = layer;
+}
+
+
+int OverlayEntity::GetLayer() const {
+	return m_layer;
+}
+
+
 OverlayEntity::SurfaceType OverlayEntity::GetSurfaceType() const {
 	if (std::holds_alternative<Image*>(m_color)) {
 		return TEXTURED;
@@ -26,9 +26,14 @@ public:
 	void SetVisible(bool visible);
 	bool GetVisible() const;
 
+	/// <summary> Without a mesh, the entity is a sprite covering the unit square, these are drawn in batches. </summary>
 	void SetMesh(Mesh* mesh);
 	Mesh* GetMesh() const;
 
+	/// <summary> Higher layers are drawn over lower ones. </summary>
+	void SetLayer(int layer);
+	int GetLayer() const;
+
 	SurfaceType GetSurfaceType() const;
 
 	void SetColor(mathfu::Vector4f color);
@@ -50,6 +55,7 @@ private:
 	Mesh* m_mesh;
 
 	bool m_visible;
+	int m_layer;
 	std::variant<Image*, mathfu::Vector4f> m_color;
 
 	mathfu::Vector<float, 2> m_position;
@@ -4,8 +4,9 @@
 #include "Pipeline.hpp"
 #include "GraphicsNodeFactory.hpp"
 #include "GraphicsNode.hpp"
+#include "PipelineDescription.hpp"
 
-#include <rapidjson/rapidjson.h>
+#include <algorithm>
 #include <cassert>
 
 
@@ -61,23 +62,45 @@ Pipeline::NodeIterator Pipeline::NodeIterator::operator++(int) const {
 
 
 Pipeline::Pipeline()
-	: m_nodeMap(m_dependencyGraph), m_taskFunctionMap(m_taskGraph), m_taskParentMap(m_taskGraph, lemon::INVALID)
+	: m_nodeMap(m_dependencyGraph),
+	m_sinkMap(m_dependencyGraph, false),
+	m_enabledMap(m_dependencyGraph, true),
+	m_taskFunctionMap(m_taskGraph),
+	m_taskParentMap(m_taskGraph, lemon::INVALID),
+	m_taskActiveMap(m_taskGraph, true)
 {}
 
 
 Pipeline::Pipeline(Pipeline&& rhs) : Pipeline() {
 	// copy graphs and maps
+	lemon::ListDigraph::NodeMap<lemon::ListDigraph::Node> depNodeRef(rhs.m_dependencyGraph);
 	lemon::DigraphCopy<decltype(rhs.m_dependencyGraph), decltype(this->m_dependencyGraph)>
 		depCopy(rhs.m_dependencyGraph, this->m_dependencyGraph);
 	depCopy.nodeMap(rhs.m_nodeMap, this->m_nodeMap);
+	depCopy.nodeMap(rhs.m_sinkMap, this->m_sinkMap);
+	depCopy.nodeMap(rhs.m_enabledMap, this->m_enabledMap);
+	depCopy.nodeRef(depNodeRef);
 	depCopy.run();
 
+	lemon::ListDigraph::NodeMap<lemon::ListDigraph::Node> taskNodeRef(rhs.m_taskGraph);
 	lemon::DigraphCopy<decltype(rhs.m_taskGraph), decltype(this->m_taskGraph)>
 		taskCopy(rhs.m_taskGraph, this->m_taskGraph);
 	taskCopy.nodeMap(rhs.m_taskFunctionMap, this->m_taskFunctionMap);
-	taskCopy.nodeMap(rhs.m_taskParentMap, this->m_taskParentMap);
+	taskCopy.nodeMap(rhs.m_taskActiveMap, this->m_taskActiveMap);
+	taskCopy.nodeRef(taskNodeRef);
 	taskCopy.run();
 
+	// parents must refer to the copied dependency graph
+	for (lemon::ListDigraph::NodeIt taskNode(rhs.m_taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		lemon::ListDigraph::Node parent = rhs.m_taskParentMap[taskNode];
+		m_taskParentMap[taskNodeRef[taskNode]] = parent != lemon::INVALID
+			? lemon::ListDigraph::NodeIt(m_dependencyGraph, depNodeRef[parent])
+			: lemon::ListDigraph::NodeIt(lemon::INVALID);
+	}
+
+	// the wrapped tasks are referred to by the copied task graph
+	m_taskWrappers = std::move(rhs.m_taskWrappers);
+
 	// clear rhs's stuff
 	rhs.m_dependencyGraph.clear();
 	rhs.m_taskGraph.clear();
@@ -101,21 +124,90 @@ Pipeline::~Pipeline() {
 
 
 void Pipeline::CreateFromDescription(const std::string& jsonDescription, GraphicsNodeFactory& factory) {
-	throw std::logic_error("not implemented yet");
+	CreateFromDescription(PipelineDescription::FromJson(jsonDescription, factory), factory);
+}
+
+
+void Pipeline::CreateFromDescription(const PipelineDescription& description, GraphicsNodeFactory& factory) {
+	std::vector<std::shared_ptr<exc::NodeBase>> nodes;
+	nodes.reserve(description.nodes.size());
+	for (const PipelineNodeDesc& nodeDesc : description.nodes) {
+		std::shared_ptr<exc::NodeBase> node(factory.CreateNode(nodeDesc.className));
+		if (!node) {
+			throw std::invalid_argument("Node '" + nodeDesc.name + "' is of class '" + nodeDesc.className + "', which is not registered.");
+		}
+		for (const PipelineInputValue& value : nodeDesc.inputValues) {
+			exc::InputPortBase* port = node->GetInput(value.port);
+			if (port == nullptr) {
+				throw std::invalid_argument("Node '" + nodeDesc.name + "' has no input port " + std::to_string(value.port) + ".");
+			}
+			try {
+				SetPipelineInputValue(*port, value);
+			}
+			catch (std::invalid_argument& ex) {
+				throw std::invalid_argument("Input port " + std::to_string(value.port) + " of node '" + nodeDesc.name + "': " + ex.what());
+			}
+		}
+		nodes.push_back(std::move(node));
+	}
+
+	for (const PipelineLinkDesc& link : description.links) {
+		exc::OutputPortBase* srcPort = nodes[link.srcNode]->GetOutput(link.srcPort);
+		exc::InputPortBase* dstPort = nodes[link.dstNode]->GetInput(link.dstPort);
+		const std::string& srcName = description.nodes[link.srcNode].name;
+		const std::string& dstName = description.nodes[link.dstNode].name;
+		if (srcPort == nullptr || dstPort == nullptr) {
+			throw std::invalid_argument("Link from node '" + srcName + "' to node '" + dstName + "' refers to a port that does not exist.");
+		}
+		if (!srcPort->Link(dstPort)) {
+			throw std::invalid_argument("Output port " + std::to_string(link.srcPort) + " of node '" + srcName + "' cannot be linked to input port "
+										+ std::to_string(link.dstPort) + " of node '" + dstName + "', the types are incompatible or the input is already linked.");
+		}
+	}
+
+	// graphics nodes set up their tasks when initialized, the task graph cannot be built before
+	EngineContext engineContext(1, 1);
+	for (auto& node : nodes) {
+		if (auto graphicsNode = dynamic_cast<GraphicsNode*>(node.get())) {
+			graphicsNode->Initialize(engineContext);
+		}
+	}
+
+	std::vector<std::shared_ptr<exc::NodeBase>> outputNodes;
+	for (uint32_t output : description.outputs) {
+		outputNodes.push_back(nodes[output]);
+	}
+
+	CreateFromNodesList(nodes, outputNodes);
 }
 
 
-void Pipeline::CreateFromNodesList(const std::vector<std::shared_ptr<exc::NodeBase>> nodes) {
+void Pipeline::CreateFromNodesList(const std::vector<std::shared_ptr<exc::NodeBase>> nodes, const std::vector<std::shared_ptr<exc::NodeBase>>& outputNodes) {
 	// assign pipeline nodes to graph nodes
 	for (auto pipelineNode : nodes) {
 		lemon::ListDigraph::Node graphNode = m_dependencyGraph.addNode();
 		m_nodeMap[graphNode] = pipelineNode;
+		m_enabledMap[graphNode] = true;
+		m_sinkMap[graphNode] = std::find(outputNodes.begin(), outputNodes.end(), pipelineNode) != outputNodes.end();
+	}
+	for (auto& outputNode : outputNodes) {
+		if (std::find(nodes.begin(), nodes.end(), outputNode) == nodes.end()) {
+			Clear();
+			throw std::invalid_argument("Output node is not part of the pipeline.");
+		}
 	}
 
 	// calculate graphs
 	try {
 		CalculateDependencyGraph();
+		if (outputNodes.empty()) {
+			for (lemon::ListDigraph::NodeIt graphNode(m_dependencyGraph); graphNode != lemon::INVALID; ++graphNode) {
+				m_sinkMap[graphNode] = lemon::countOutArcs(m_dependencyGraph, graphNode) == 0;
+			}
+		}
+		EliminateDeadNodes();
 		CalculateTaskGraph();
+		UpdateActiveTasks();
 	}
 	catch (...) {
 		Clear();
@@ -131,6 +223,24 @@ void Pipeline::CreateFromNodesList(const std::vector<std::shared_ptr<exc::NodeBa
 }
 
 
+void Pipeline::SetNodeEnabled(const exc::NodeBase* node, bool enabled) {
+	lemon::ListDigraph::Node graphNode = FindNode(node);
+	if (graphNode == lemon::INVALID) {
+		throw std::invalid_argument("Node is not part of the pipeline.");
+	}
+	if (m_enabledMap[graphNode] != enabled) {
+		m_enabledMap[graphNode] = enabled;
+		UpdateActiveTasks();
+	}
+}
+
+
+bool Pipeline::IsNodeEnabled(const exc::NodeBase* node) const {
+	lemon::ListDigraph::Node graphNode = FindNode(node);
+	return graphNode != lemon::INVALID && m_enabledMap[graphNode];
+}
+
+
 void Pipeline::Clear() {
 	for (lemon::ListDigraph::NodeIt graphNode(m_dependencyGraph); graphNode != lemon::INVALID; ++graphNode) {
 		m_nodeMap[graphNode] = nullptr; // not necessary, but better make sure
@@ -287,6 +397,65 @@ void Pipeline::CalculateTaskGraph() {
 
 
 
+void Pipeline::FindLiveNodes(const lemon::ListDigraph& graph,
+							 const lemon::ListDigraph::NodeMap<bool>& isSink,
+							 const lemon::ListDigraph::NodeMap<bool>& isEnabled,
+							 lemon::ListDigraph::NodeMap<bool>& isLive)
+{
+	// Walk backward from the sinks, stopping at disabled nodes.
+	std::vector<lemon::ListDigraph::Node> stack;
+	for (lemon::ListDigraph::NodeIt node(graph); node != lemon::INVALID; ++node) {
+		isLive[node] = isSink[node] && isEnabled[node];
+		if (isLive[node]) {
+			stack.push_back(node);
+		}
+	}
+
+	while (!stack.empty()) {
+		lemon::ListDigraph::Node node = stack.back();
+		stack.pop_back();
+		for (lemon::ListDigraph::InArcIt arc(graph, node); arc != lemon::INVALID; ++arc) {
+			lemon::ListDigraph::Node source = graph.source(arc);
+			if (!isLive[source] && isEnabled[source]) {
+				isLive[source] = true;
+				stack.push_back(source);
+			}
+		}
+	}
+}
+
+
+void Pipeline::EliminateDeadNodes() {
+	// Nodes that reach no output with every node enabled never do, they are removed for good.
+	lemon::ListDigraph::NodeMap<bool> allEnabled(m_dependencyGraph, true);
+	lemon::ListDigraph::NodeMap<bool> isLive(m_dependencyGraph);
+	FindLiveNodes(m_dependencyGraph, m_sinkMap, allEnabled, isLive);
+
+	std::vector<lemon::ListDigraph::Node> deadNodes;
+	for (lemon::ListDigraph::NodeIt graphNode(m_dependencyGraph); graphNode != lemon::INVALID; ++graphNode) {
+		if (!isLive[graphNode]) {
+			deadNodes.push_back(graphNode);
+		}
+	}
+	for (auto graphNode : deadNodes) {
+		m_nodeMap[graphNode] = nullptr;
+		m_dependencyGraph.erase(graphNode);
+	}
+}
+
+
+void Pipeline::UpdateActiveTasks() {
+	lemon::ListDigraph::NodeMap<bool> isLive(m_dependencyGraph);
+	FindLiveNodes(m_dependencyGraph, m_sinkMap, m_enabledMap, isLive);
+
+	for (lemon::ListDigraph::NodeIt taskNode(m_taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		lemon::ListDigraph::Node parent = m_taskParentMap[taskNode];
+		// helper sources and sinks have no work to skip
+		m_taskActiveMap[taskNode] = parent == lemon::INVALID || isLive[parent];
+	}
+}
+
+
 void Pipeline::CalculateDependencyGraph() {
 	// Erase all arcs from the graph
 	lemon::ListDigraph::ArcIt arcIt(m_dependencyGraph);
@@ -335,6 +504,16 @@ bool Pipeline::IsLinked(exc::NodeBase* srcNode, exc::NodeBase* dstNode) {
 }
 
 
+lemon::ListDigraph::Node Pipeline::FindNode(const exc::NodeBase* node) const {
+	for (lemon::ListDigraph::NodeIt graphNode(m_dependencyGraph); graphNode != lemon::INVALID; ++graphNode) {
+		if (m_nodeMap[graphNode].get() == node) {
+			return graphNode;
+		}
+	}
+	return lemon::INVALID;
+}
+
+
 const lemon::ListDigraph& Pipeline::GetDependencyGraph() const {
 	return m_dependencyGraph;
 }
@@ -353,6 +532,10 @@ const lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt>& Pipeline::GetTask
 	return m_taskParentMap;
 }
 
+const lemon::ListDigraph::NodeMap<bool>& Pipeline::GetTaskActiveMap() const {
+	return m_taskActiveMap;
+}
+
 
 
 } // namespace gxeng
@@ -25,6 +25,7 @@ namespace gxeng {
 
 
 class GraphicsNodeFactory;
+class PipelineDescription;
 
 
 class Pipeline {
@@ -80,10 +81,25 @@ public:
 	Pipeline& operator=(Pipeline&&);
 	~Pipeline();
 
+	/// <summary> Creates the nodes of a JSON pipeline description with the factory and builds the pipeline of them. </summary>
+	/// <exception cref="std::invalid_argument"> If the description is invalid, see <see cref="PipelineDescription::FromJson"/>. </exception>
 	void CreateFromDescription(const std::string& jsonDescription, GraphicsNodeFactory& factory);
-	void CreateFromNodesList(const std::vector<std::shared_ptr<exc::NodeBase>> nodes);
+	/// <summary> Creates the nodes of a parsed or binary pipeline description with the factory and builds the pipeline of them.
+	///		Graphics nodes are initialized after they were given their values and links. </summary>
+	/// <exception cref="std::invalid_argument"> If a class is not registered, a port does not exist, or a link or value does not fit the port's type. </exception>
+	void CreateFromDescription(const PipelineDescription& description, GraphicsNodeFactory& factory);
+	/// <summary> Builds the pipeline of the given nodes, leaving out those that contribute to no output node. </summary>
+	/// <param name="outputNodes"> Nodes whose work is used outside the pipeline, like presenting the back buffer.
+	///		If empty, every node without consumers is an output node. </param>
+	void CreateFromNodesList(const std::vector<std::shared_ptr<exc::NodeBase>> nodes, const std::vector<std::shared_ptr<exc::NodeBase>>& outputNodes = {});
 	void Clear();
 
+	/// <summary> Disabled nodes are not run, neither are the nodes that only contribute to disabled ones. </summary>
+	/// <remarks> Takes effect from the next frame without rebuilding the task graph.
+	///		Consumers of a disabled node keep seeing its outputs' last values. </remarks>
+	void SetNodeEnabled(const exc::NodeBase* node, bool enabled);
+	bool IsNodeEnabled(const exc::NodeBase* node) const;
+
 	NodeIterator begin();
 	NodeIterator end();
 	ConstNodeIterator begin() const;
@@ -96,6 +112,14 @@ public:
 	const lemon::ListDigraph& GetTaskGraph() const;
 	const lemon::ListDigraph::NodeMap<GraphicsTask*>& GetTaskFunctionMap() const;
 	const lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt>& GetTaskParentMap() const;
+	/// <summary> False for the tasks of nodes that are disabled or contribute to no enabled output. </summary>
+	const lemon::ListDigraph::NodeMap<bool>& GetTaskActiveMap() const;
+
+	/// <summary> Marks the nodes from which an enabled sink can be reached through enabled nodes only. </summary>
+	static void FindLiveNodes(const lemon::ListDigraph& graph,
+							  const lemon::ListDigraph::NodeMap<bool>& isSink,
+							  const lemon::ListDigraph::NodeMap<bool>& isEnabled,
+							  lemon::ListDigraph::NodeMap<bool>& isLive);
 
 	template <class T>
 	void AddNodeMetaData() = delete;
@@ -104,13 +128,19 @@ public:
 private:
 	void CalculateTaskGraph();
 	void CalculateDependencyGraph();
+	void EliminateDeadNodes();
+	void UpdateActiveTasks();
 	bool IsLinked(exc::NodeBase* srcNode, exc::NodeBase* dstNode);
+	lemon::ListDigraph::Node FindNode(const exc::NodeBase* node) const;
 
 	lemon::ListDigraph m_dependencyGraph;
 	lemon::ListDigraph::NodeMap<std::shared_ptr<exc::NodeBase>> m_nodeMap;
+	lemon::ListDigraph::NodeMap<bool> m_sinkMap;
+	lemon::ListDigraph::NodeMap<bool> m_enabledMap;
 	lemon::ListDigraph m_taskGraph;
 	lemon::ListDigraph::NodeMap<GraphicsTask*> m_taskFunctionMap;
 	lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt> m_taskParentMap;
+	lemon::ListDigraph::NodeMap<bool> m_taskActiveMap;
 
 	std::vector<std::unique_ptr<SimpleNodeTask>> m_taskWrappers;
 };
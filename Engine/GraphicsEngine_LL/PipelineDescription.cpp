@@ -0,0 +1,422 @@
+#include "PipelineDescription.hpp"
+
+#include "../BaseLibrary/Graph/NodeFactory.hpp"
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+
+namespace inl {
+namespace gxeng {
+
+
+//------------------------------------------------------------------------------
+// JSON
+//------------------------------------------------------------------------------
+
+
+namespace {
+
+uint32_t FindPort(const rapidjson::Value& port, const std::vector<std::string>& names, size_t numPorts, const std::string& nodeName, const char* what) {
+	if (port.IsUint()) {
+		if (port.GetUint() >= numPorts) {
+			throw std::invalid_argument("Node '" + nodeName + "' has no " + what + " port " + std::to_string(port.GetUint()) + ".");
+		}
+		return port.GetUint();
+	}
+	if (port.IsString()) {
+		for (size_t i = 0; i < names.size() && i < numPorts; ++i) {
+			if (names[i] == port.GetString()) {
+				return (uint32_t)i;
+			}
+		}
+		throw std::invalid_argument("Node '" + nodeName + "' has no " + what + " port named '" + port.GetString() + "'.");
+	}
+	throw std::invalid_argument(std::string("Ports of node '") + nodeName + "' must be given by name or index.");
+}
+
+
+uint32_t FindNode(const rapidjson::Value& name, const std::unordered_map<std::string, uint32_t>& nodeIndices, const char* what) {
+	if (!name.IsString()) {
+		throw std::invalid_argument(std::string("The ") + what + " must be a node name.");
+	}
+	auto it = nodeIndices.find(name.GetString());
+	if (it == nodeIndices.end()) {
+		throw std::invalid_argument(std::string("The ") + what + " '" + name.GetString() + "' is not a node of the pipeline.");
+	}
+	return it->second;
+}
+
+
+PipelineInputValue ParseInputValue(const rapidjson::Value& value, uint32_t port, const std::string& nodeName) {
+	PipelineInputValue result;
+	result.port = port;
+	if (value.IsBool()) {
+		result.type = PipelineInputValue::eType::BOOL;
+		result.integer = value.GetBool();
+	}
+	else if (value.IsInt64()) {
+		result.type = PipelineInputValue::eType::INTEGER;
+		result.integer = value.GetInt64();
+	}
+	else if (value.IsNumber()) {
+		result.type = PipelineInputValue::eType::REAL;
+		result.real = value.GetDouble();
+	}
+	else if (value.IsString()) {
+		result.type = PipelineInputValue::eType::STRING;
+		result.string.assign(value.GetString(), value.GetStringLength());
+	}
+	else {
+		throw std::invalid_argument("Input values of node '" + nodeName + "' must be booleans, numbers or strings.");
+	}
+	return result;
+}
+
+} // namespace
+
+
+PipelineDescription PipelineDescription::FromJson(const std::string& json, exc::NodeFactory& factory) {
+	rapidjson::Document document;
+	document.Parse(json.c_str());
+	if (document.HasParseError()) {
+		throw std::invalid_argument(std::string("Pipeline description is not valid JSON at offset ")
+									+ std::to_string(document.GetErrorOffset()) + ": " + rapidjson::GetParseError_En(document.GetParseError()));
+	}
+	if (!document.IsObject() || !document.HasMember("nodes") || !document["nodes"].IsArray()) {
+		throw std::invalid_argument("Pipeline description must be an object with an array of nodes.");
+	}
+
+	PipelineDescription description;
+	std::vector<const exc::NodeFactory::NodeInfo*> infos;
+	std::unordered_map<std::string, uint32_t> nodeIndices;
+
+	// nodes and their input values
+	const rapidjson::Value& nodes = document["nodes"];
+	for (auto node = nodes.Begin(); node != nodes.End(); ++node) {
+		if (!node->IsObject() || !node->HasMember("name") || !(*node)["name"].IsString() || !node->HasMember("class") || !(*node)["class"].IsString()) {
+			throw std::invalid_argument("Every node must have a name and a class.");
+		}
+		PipelineNodeDesc nodeDesc;
+		nodeDesc.name = (*node)["name"].GetString();
+		nodeDesc.className = (*node)["class"].GetString();
+
+		const exc::NodeFactory::NodeInfo* info = factory.GetNodeInfo(nodeDesc.className);
+		if (info == nullptr) {
+			throw std::invalid_argument("Node '" + nodeDesc.name + "' is of class '" + nodeDesc.className + "', which is not registered.");
+		}
+		if (!nodeIndices.insert({ nodeDesc.name, (uint32_t)description.nodes.size() }).second) {
+			throw std::invalid_argument("There are multiple nodes named '" + nodeDesc.name + "'.");
+		}
+
+		if (node->HasMember("inputs")) {
+			const rapidjson::Value& inputs = (*node)["inputs"];
+			if (!inputs.IsObject()) {
+				throw std::invalid_argument("Inputs of node '" + nodeDesc.name + "' must be an object of port names and values.");
+			}
+			for (auto input = inputs.MemberBegin(); input != inputs.MemberEnd(); ++input) {
+				// keys are strings, those made of digits are indices
+				const char* key = input->name.GetString();
+				bool isIndex = key[0] != '\0' && std::strspn(key, "0123456789") == input->name.GetStringLength();
+				rapidjson::Value port;
+				if (isIndex) {
+					port.SetUint((unsigned)std::strtoul(key, nullptr, 10));
+				}
+				else {
+					port.SetString(rapidjson::StringRef(key, input->name.GetStringLength()));
+				}
+				uint32_t portIndex = FindPort(port, info->inputNames, info->numInputPorts, nodeDesc.name, "input");
+				nodeDesc.inputValues.push_back(ParseInputValue(input->value, portIndex, nodeDesc.name));
+			}
+		}
+
+		description.nodes.push_back(std::move(nodeDesc));
+		infos.push_back(info);
+	}
+
+	// links
+	if (document.HasMember("links")) {
+		const rapidjson::Value& links = document["links"];
+		if (!links.IsArray()) {
+			throw std::invalid_argument("Links must be an array.");
+		}
+		std::vector<std::vector<bool>> isLinked(description.nodes.size());
+		for (size_t i = 0; i < description.nodes.size(); ++i) {
+			isLinked[i].resize(infos[i]->numInputPorts, false);
+			for (const auto& value : description.nodes[i].inputValues) {
+				isLinked[i][value.port] = true;
+			}
+		}
+
+		for (auto link = links.Begin(); link != links.End(); ++link) {
+			if (!link->IsObject() || !link->HasMember("src") || !link->HasMember("srcPort") || !link->HasMember("dst") || !link->HasMember("dstPort")) {
+				throw std::invalid_argument("Every link must have a src, srcPort, dst and dstPort.");
+			}
+			PipelineLinkDesc linkDesc;
+			linkDesc.srcNode = FindNode((*link)["src"], nodeIndices, "link source");
+			linkDesc.dstNode = FindNode((*link)["dst"], nodeIndices, "link destination");
+			const auto& srcInfo = *infos[linkDesc.srcNode];
+			const auto& dstInfo = *infos[linkDesc.dstNode];
+			const std::string& srcName = description.nodes[linkDesc.srcNode].name;
+			const std::string& dstName = description.nodes[linkDesc.dstNode].name;
+			linkDesc.srcPort = FindPort((*link)["srcPort"], srcInfo.outputNames, srcInfo.numOutputPorts, srcName, "output");
+			linkDesc.dstPort = FindPort((*link)["dstPort"], dstInfo.inputNames, dstInfo.numInputPorts, dstName, "input");
+
+			if (isLinked[linkDesc.dstNode][linkDesc.dstPort]) {
+				throw std::invalid_argument("Input port " + std::to_string(linkDesc.dstPort) + " of node '" + dstName + "' is given more than once.");
+			}
+			isLinked[linkDesc.dstNode][linkDesc.dstPort] = true;
+			description.links.push_back(linkDesc);
+		}
+	}
+
+	// outputs
+	if (document.HasMember("outputs")) {
+		const rapidjson::Value& outputs = document["outputs"];
+		if (!outputs.IsArray()) {
+			throw std::invalid_argument("Outputs must be an array of node names.");
+		}
+		for (auto output = outputs.Begin(); output != outputs.End(); ++output) {
+			description.outputs.push_back(FindNode(*output, nodeIndices, "output"));
+		}
+	}
+
+	return description;
+}
+
+
+//------------------------------------------------------------------------------
+// Binary
+//------------------------------------------------------------------------------
+
+
+namespace {
+
+constexpr char BinaryMagic[4] = { 'I', 'P', 'L', 'D' };
+constexpr uint32_t BinaryVersion = 1;
+
+
+class BinaryWriter {
+public:
+	template <class T>
+	void Write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written.");
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+	}
+	void WriteString(const std::string& str) {
+		Write((uint32_t)str.size());
+		m_data.insert(m_data.end(), str.begin(), str.end());
+	}
+	std::vector<uint8_t>& GetData() { return m_data; }
+private:
+	std::vector<uint8_t> m_data;
+};
+
+
+class BinaryReader {
+public:
+	BinaryReader(const void* data, size_t size) : m_data(static_cast<const uint8_t*>(data)), m_size(size) {}
+
+	template <class T>
+	T Read() {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read.");
+		T value;
+		std::memcpy(&value, Advance(sizeof(T)), sizeof(T));
+		return value;
+	}
+	std::string ReadString() {
+		uint32_t length = Read<uint32_t>();
+		const char* chars = reinterpret_cast<const char*>(Advance(length));
+		return std::string(chars, chars + length);
+	}
+	/// <summary> Reads a count of elements that are at least elementSize bytes each, so bogus counts fail before allocating. </summary>
+	uint32_t ReadCount(size_t elementSize) {
+		uint32_t count = Read<uint32_t>();
+		if (count > (m_size - m_offset) / elementSize) {
+			throw std::invalid_argument("Binary pipeline description is truncated.");
+		}
+		return count;
+	}
+	bool IsAtEnd() const { return m_offset == m_size; }
+private:
+	const uint8_t* Advance(size_t bytes) {
+		if (bytes > m_size - m_offset) {
+			throw std::invalid_argument("Binary pipeline description is truncated.");
+		}
+		const uint8_t* current = m_data + m_offset;
+		m_offset += bytes;
+		return current;
+	}
+
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_offset = 0;
+};
+
+} // namespace
+
+
+std::vector<uint8_t> PipelineDescription::ToBinary() const {
+	BinaryWriter writer;
+	writer.Write(BinaryMagic);
+	writer.Write(BinaryVersion);
+
+	writer.Write((uint32_t)nodes.size());
+	for (const auto& node : nodes) {
+		writer.WriteString(node.className);
+		writer.WriteString(node.name);
+		writer.Write((uint32_t)node.inputValues.size());
+		for (const auto& value : node.inputValues) {
+			writer.Write(value.port);
+			writer.Write(value.type);
+			switch (value.type) {
+				case PipelineInputValue::eType::BOOL:
+				case PipelineInputValue::eType::INTEGER: writer.Write(value.integer); break;
+				case PipelineInputValue::eType::REAL: writer.Write(value.real); break;
+				case PipelineInputValue::eType::STRING: writer.WriteString(value.string); break;
+			}
+		}
+	}
+
+	writer.Write((uint32_t)links.size());
+	for (const auto& link : links) {
+		writer.Write(link);
+	}
+
+	writer.Write((uint32_t)outputs.size());
+	for (uint32_t output : outputs) {
+		writer.Write(output);
+	}
+
+	return std::move(writer.GetData());
+}
+
+
+PipelineDescription PipelineDescription::FromBinary(const void* data, size_t size) {
+	if (size < sizeof(BinaryMagic) || std::memcmp(data, BinaryMagic, sizeof(BinaryMagic)) != 0) {
+		throw std::invalid_argument("Data is not a binary pipeline description.");
+	}
+	BinaryReader reader(data, size);
+	reader.Read<uint32_t>(); // magic
+	if (reader.Read<uint32_t>() != BinaryVersion) {
+		throw std::invalid_argument("Binary pipeline description has an unsupported version.");
+	}
+
+	PipelineDescription description;
+
+	description.nodes.resize(reader.ReadCount(3 * sizeof(uint32_t)));
+	for (auto& node : description.nodes) {
+		node.className = reader.ReadString();
+		node.name = reader.ReadString();
+		node.inputValues.resize(reader.ReadCount(sizeof(uint32_t) + sizeof(uint8_t)));
+		for (auto& value : node.inputValues) {
+			value.port = reader.Read<uint32_t>();
+			value.type = reader.Read<PipelineInputValue::eType>();
+			switch (value.type) {
+				case PipelineInputValue::eType::BOOL:
+				case PipelineInputValue::eType::INTEGER: value.integer = reader.Read<int64_t>(); break;
+				case PipelineInputValue::eType::REAL: value.real = reader.Read<double>(); break;
+				case PipelineInputValue::eType::STRING: value.string = reader.ReadString(); break;
+				default: throw std::invalid_argument("Binary pipeline description has an input value of unknown type.");
+			}
+		}
+	}
+
+	const uint32_t numNodes = (uint32_t)description.nodes.size();
+	description.links.resize(reader.ReadCount(sizeof(PipelineLinkDesc)));
+	for (auto& link : description.links) {
+		link = reader.Read<PipelineLinkDesc>();
+		if (link.srcNode >= numNodes || link.dstNode >= numNodes) {
+			throw std::invalid_argument("Binary pipeline description links nodes that do not exist.");
+		}
+	}
+
+	description.outputs.resize(reader.ReadCount(sizeof(uint32_t)));
+	for (auto& output : description.outputs) {
+		output = reader.Read<uint32_t>();
+		if (output >= numNodes) {
+			throw std::invalid_argument("Binary pipeline description has an output node that does not exist.");
+		}
+	}
+
+	if (!reader.IsAtEnd()) {
+		throw std::invalid_argument("Binary pipeline description has trailing data.");
+	}
+
+	return description;
+}
+
+
+//------------------------------------------------------------------------------
+// Input values
+//------------------------------------------------------------------------------
+
+
+namespace {
+
+template <class T>
+bool SetTyped(exc::InputPortBase& port, const T& value) {
+	if (auto* typed = dynamic_cast<exc::InputPort<T>*>(&port)) {
+		typed->Set(value);
+		return true;
+	}
+	return false;
+}
+
+
+template <class T>
+bool SetInteger(exc::InputPortBase& port, int64_t value) {
+	if (port.GetType() != typeid(T)) {
+		return false;
+	}
+	if (std::is_unsigned<T>::value ? value < 0 || uint64_t(value) > uint64_t(std::numeric_limits<T>::max())
+		: value < int64_t(std::numeric_limits<T>::lowest()) || value > int64_t(std::numeric_limits<T>::max())) {
+		throw std::invalid_argument("Input value " + std::to_string(value) + " does not fit the port's type.");
+	}
+	return SetTyped<T>(port, T(value));
+}
+
+} // namespace
+
+
+void SetPipelineInputValue(exc::InputPortBase& port, const PipelineInputValue& value) {
+	bool isSet = false;
+	switch (value.type) {
+		case PipelineInputValue::eType::BOOL:
+			isSet = SetTyped<bool>(port, value.integer != 0)
+				|| SetTyped<exc::Any>(port, exc::Any(value.integer != 0));
+			break;
+		case PipelineInputValue::eType::INTEGER:
+			isSet = SetInteger<int>(port, value.integer)
+				|| SetInteger<unsigned>(port, value.integer)
+				|| SetInteger<int64_t>(port, value.integer)
+				|| SetInteger<uint64_t>(port, value.integer)
+				|| SetTyped<float>(port, float(value.integer))
+				|| SetTyped<double>(port, double(value.integer))
+				|| SetTyped<exc::Any>(port, exc::Any(value.integer));
+			break;
+		case PipelineInputValue::eType::REAL:
+			isSet = SetTyped<float>(port, float(value.real))
+				|| SetTyped<double>(port, value.real)
+				|| SetTyped<exc::Any>(port, exc::Any(value.real));
+			break;
+		case PipelineInputValue::eType::STRING:
+			isSet = SetTyped<std::string>(port, value.string)
+				|| SetTyped<exc::Any>(port, exc::Any(value.string));
+			break;
+	}
+	if (!isSet) {
+		throw std::invalid_argument(std::string("Input value cannot be set on a port of type ") + port.GetType().name() + ".");
+	}
+}
+
+
+} // namespace gxeng
+} // namespace inl
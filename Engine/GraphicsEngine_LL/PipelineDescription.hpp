@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace exc {
+class NodeFactory;
+class InputPortBase;
+} // namespace exc
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary> A constant set on an input port of a node when the pipeline is created. </summary>
+struct PipelineInputValue {
+	enum class eType : uint8_t {
+		BOOL,
+		INTEGER,
+		REAL,
+		STRING,
+	};
+
+	uint32_t port = 0;
+	eType type = eType::INTEGER;
+	int64_t integer = 0; // BOOL and INTEGER
+	double real = 0.0;
+	std::string string;
+};
+
+
+struct PipelineNodeDesc {
+	/// <summary> The name the class is registered with in the node factory, including its group. </summary>
+	std::string className;
+	/// <summary> Unique within the pipeline, only used to refer to the node in the description and in errors. </summary>
+	std::string name;
+	std::vector<PipelineInputValue> inputValues;
+};
+
+
+struct PipelineLinkDesc {
+	uint32_t srcNode;
+	uint32_t srcPort;
+	uint32_t dstNode;
+	uint32_t dstPort;
+};
+
+
+/// <summary>
+/// The nodes of a pipeline, their links and the values of their unlinked inputs,
+/// with every node and port resolved to its index.
+/// </summary>
+/// <remarks>
+/// <para> The textual form is JSON:
+/// <code>
+/// {
+///		"nodes": [
+///			{ "name": "scene", "class": "Graphics/GetSceneByName", "inputs": { "name": "World" } },
+///			{ "name": "draw", "class": "Graphics/DrawSky" }
+///		],
+///		"links": [
+///			{ "src": "scene", "srcPort": 0, "dst": "draw", "dstPort": "scene" }
+///		],
+///		"outputs": [ "draw" ]
+/// }
+/// </code>
+/// Ports are given by name or index. Input values may be booleans, numbers or strings.
+/// Links and outputs are optional, without outputs every node without consumers is an output. </para>
+/// <para> The binary form stores the same with indices only, so it loads without looking anything up.
+/// It is meant to be written by <see cref="ToBinary"/> from a validated description. </para>
+/// </remarks>
+class PipelineDescription {
+public:
+	/// <summary> Parses and validates a JSON description against the classes registered in the factory. </summary>
+	/// <exception cref="std::invalid_argument"> If the JSON is malformed, or it refers to classes, nodes or ports that do not exist. </exception>
+	static PipelineDescription FromJson(const std::string& json, exc::NodeFactory& factory);
+
+	/// <exception cref="std::invalid_argument"> If the data is not a binary pipeline description or it is truncated. </exception>
+	static PipelineDescription FromBinary(const void* data, size_t size);
+	std::vector<uint8_t> ToBinary() const;
+
+	std::vector<PipelineNodeDesc> nodes;
+	std::vector<PipelineLinkDesc> links;
+	std::vector<uint32_t> outputs;
+};
+
+
+/// <summary> Sets the value on the port if its type can hold it. </summary>
+/// <exception cref="std::invalid_argument"> If the port's type cannot hold the value. </exception>
+void SetPipelineInputValue(exc::InputPortBase& port, const PipelineInputValue& value);
+
+
+} // namespace gxeng
+} // namespace inl
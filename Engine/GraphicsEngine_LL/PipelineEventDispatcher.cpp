@@ -1,6 +1,9 @@
 #include "PipelineEventDispatcher.hpp"
 #include <BaseLibrary/ThreadName.hpp>
 
+#include <algorithm>
+#include <exception>
+
 
 namespace inl {
 namespace gxeng {
@@ -8,195 +11,201 @@ namespace gxeng {
 
 
 PipelineEventDispatcher::PipelineEventDispatcher() {
-	state.reset(new State());
-	state->m_runDeviceThread = true;
-	state->m_runEventThread = true;
-	m_deviceSyncThread = std::thread(&PipelineEventDispatcher::DeviceSyncThread, state);
-	m_eventThread = std::thread(&PipelineEventDispatcher::DispatchThread, state);
-}
+	// listeners are few, a reserve keeps registration from reallocating in practice
+	m_syncListeners.reserve(16);
+	m_asyncListeners.reserve(16);
 
-PipelineEventDispatcher::PipelineEventDispatcher(PipelineEventDispatcher&& rhs) {
-	state = std::move(rhs.state);
-	m_eventThread = std::move(rhs.m_eventThread);
-	m_deviceSyncThread = std::move(rhs.m_deviceSyncThread);
+	m_eventThread = std::thread(&PipelineEventDispatcher::EventThread, this, HOST_QUEUE);
+	m_deviceSyncThread = std::thread(&PipelineEventDispatcher::EventThread, this, DEVICE_QUEUE);
 }
 
-PipelineEventDispatcher& PipelineEventDispatcher::operator=(PipelineEventDispatcher&& rhs) {
-	Shutdown();
-
-	state = std::move(rhs.state);
-	m_eventThread = std::move(rhs.m_eventThread);
-	m_deviceSyncThread = std::move(rhs.m_deviceSyncThread);
-
-	return *this;
-}
 
 PipelineEventDispatcher::~PipelineEventDispatcher() noexcept {
-	Shutdown();
+	for (auto& queue : m_queues) {
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.run = false;
+		queue.cv.notify_all();
+	}
+	m_eventThread.join();
+	m_deviceSyncThread.join();
 }
 
 
-void PipelineEventDispatcher::Shutdown() {
-	if (m_deviceSyncThread.joinable()) {
-		state->m_runDeviceThread = false;
-		state->m_deviceCv.notify_all();
-		m_deviceSyncThread.join();
-	}
-
-	if (m_eventThread.joinable()) {
-		state->m_runEventThread = false;
-		state->m_eventCv.notify_all();
-		m_eventThread.join();
-	}
+void PipelineEventDispatcher::SetLog(exc::LogStream* log) {
+	std::lock_guard<std::mutex> lkg(m_listenerMutex);
+	m_log = log;
 }
 
 
 
-std::future<void> PipelineEventDispatcher::DispatchFrameBegin(uint64_t frameId) {
-	EventAction eventAction;
-	eventAction.action = std::bind(&PipelineEventListener::OnFrameBeginHost, std::placeholders::_1, frameId);
-	auto ret = eventAction.signal.get_future();
-	PushEventAction(state.get(), std::move(eventAction));
-	return ret;
+PipelineEventDispatcher::Ticket PipelineEventDispatcher::DispatchFrameBegin(uint64_t frameId) {
+	return DispatchHost(eEventType::FRAME_BEGIN_HOST, frameId);
 }
 
-std::future<void> PipelineEventDispatcher::DispatchFrameEnd(uint64_t frameId) {
-	EventAction eventAction;
-	eventAction.action = std::bind(&PipelineEventListener::OnFrameCompleteHost, std::placeholders::_1, frameId);
-	auto ret = eventAction.signal.get_future();
-	PushEventAction(state.get(), std::move(eventAction));
-	return ret;
+PipelineEventDispatcher::Ticket PipelineEventDispatcher::DispatchFrameEnd(uint64_t frameId) {
+	return DispatchHost(eEventType::FRAME_COMPLETE_HOST, frameId);
 }
 
-std::future<void> PipelineEventDispatcher::DispachFrameBeginAwait(uint64_t frameId) {
-	EventAction eventAction;
-	eventAction.action = std::bind(&PipelineEventListener::OnFrameBeginAwait, std::placeholders::_1, frameId);
-	auto ret = eventAction.signal.get_future();
-	PushEventAction(state.get(), std::move(eventAction));
-	return ret;
+PipelineEventDispatcher::Ticket PipelineEventDispatcher::DispachFrameBeginAwait(uint64_t frameId) {
+	return DispatchHost(eEventType::FRAME_BEGIN_AWAIT, frameId);
 }
 
 
-std::future<void> PipelineEventDispatcher::DispatchDeviceFrameBegin(SyncPoint deviceEvent, uint64_t frameId) {
-	DeviceEventAction action;
-	action.action = std::bind(&PipelineEventListener::OnFrameBeginDevice, std::placeholders::_1, frameId);
-	action.premise = deviceEvent;
+PipelineEventDispatcher::Ticket PipelineEventDispatcher::DispatchDeviceFrameBegin(SyncPoint deviceEvent, uint64_t frameId) {
+	return Push(DEVICE_QUEUE, Event{ eEventType::FRAME_BEGIN_DEVICE, frameId, std::move(deviceEvent) });
+}
 
-	std::future<void> ret = action.signal.get_future();
+PipelineEventDispatcher::Ticket PipelineEventDispatcher::DispatchDeviceFrameEnd(SyncPoint deviceEvent, uint64_t frameId) {
+	return Push(DEVICE_QUEUE, Event{ eEventType::FRAME_COMPLETE_DEVICE, frameId, std::move(deviceEvent) });
+}
 
-	std::unique_lock<std::mutex>  lkg(state->m_deviceEventMutex);
-	state->m_deviceEventActions.push(std::move(action));
-	state->m_deviceCv.notify_all();
 
-	return ret;
+bool PipelineEventDispatcher::IsHandled(Ticket ticket) const {
+	return m_queues[ticket.queue].completed.load() >= ticket.sequence;
 }
 
-std::future<void> PipelineEventDispatcher::DispatchDeviceFrameEnd(SyncPoint deviceEvent, uint64_t frameId) {
-	DeviceEventAction action;
-	action.action = std::bind(&PipelineEventListener::OnFrameCompleteDevice, std::placeholders::_1, frameId);
-	action.premise = deviceEvent;
 
-	std::future<void> ret = action.signal.get_future();
+void PipelineEventDispatcher::WaitHandled(Ticket ticket) {
+	EventQueue& queue = m_queues[ticket.queue];
+	std::unique_lock<std::mutex> lock(queue.mutex);
+	queue.cv.wait(lock, [&] { return queue.completed.load() >= ticket.sequence || !queue.run; });
+}
 
-	std::unique_lock<std::mutex>  lkg(state->m_deviceEventMutex);
-	state->m_deviceEventActions.push(std::move(action));
-	state->m_deviceCv.notify_all();
 
-	return ret;
+void PipelineEventDispatcher::Flush() {
+	for (auto& queue : m_queues) {
+		std::unique_lock<std::mutex> lock(queue.mutex);
+		queue.cv.wait(lock, [&queue] { return queue.completed.load() >= queue.pushed || !queue.run; });
+	}
 }
 
 
 void PipelineEventDispatcher::operator+=(PipelineEventListener* listener) {
-	std::lock_guard<std::mutex> lkg(state->m_listenerMutex);
-	state->m_listeners.insert(listener);
+	std::lock_guard<std::mutex> lkg(m_listenerMutex);
+	if (std::find(m_syncListeners.begin(), m_syncListeners.end(), listener) == m_syncListeners.end()) {
+		m_syncListeners.push_back(listener);
+	}
 }
 
 
-void PipelineEventDispatcher::operator-=(PipelineEventListener* listener) {
-	std::lock_guard<std::mutex> lkg(state->m_listenerMutex);
-	state->m_listeners.erase(listener);
+void PipelineEventDispatcher::AddAsync(PipelineEventListener* listener) {
+	std::lock_guard<std::mutex> lkg(m_listenerMutex);
+	if (std::find(m_asyncListeners.begin(), m_asyncListeners.end(), listener) == m_asyncListeners.end()) {
+		m_asyncListeners.push_back(listener);
+	}
+	m_hasAsyncListeners = true;
 }
 
 
-void PipelineEventDispatcher::DispatchThread(std::shared_ptr<State> state) {
-	SetCurrentThreadName("Event Dispatcher Thread");
-
-	while (state->m_runEventThread) {
-		// 0. acquire unique lock
-		std::unique_lock<std::mutex> eventLock(state->m_eventMutex);
-
-		// 1. wait on any of: 
-		//	- first event (condvar)
-		//	- first device event (SyncPoint - cannot be changed)
-		//	- cancel event (condvar)
-		state->m_eventCv.wait(eventLock, [&state] { return !state->m_eventActions.empty() || !state->m_runEventThread; });
+void PipelineEventDispatcher::operator-=(PipelineEventListener* listener) {
+	std::lock_guard<std::mutex> lkg(m_listenerMutex);
+	m_syncListeners.erase(std::remove(m_syncListeners.begin(), m_syncListeners.end(), listener), m_syncListeners.end());
+	m_asyncListeners.erase(std::remove(m_asyncListeners.begin(), m_asyncListeners.end(), listener), m_asyncListeners.end());
+	m_hasAsyncListeners = !m_asyncListeners.empty();
+}
 
-		// 2. acquire lock
-		// wait re-acquires lock
 
-		// 3. exctract & remove all data from queue
-		std::vector<EventAction> events;
-		while (!state->m_eventActions.empty()) {
-			events.push_back(std::move(state->m_eventActions.front()));
-			state->m_eventActions.pop();
+PipelineEventDispatcher::Ticket PipelineEventDispatcher::DispatchHost(eEventType type, uint64_t frameId) {
+	{
+		std::lock_guard<std::mutex> lkg(m_listenerMutex);
+		for (auto listener : m_syncListeners) {
+			CallHandler(listener, type, frameId);
 		}
+	}
 
-		// 4. release lock
-		eventLock.unlock();
+	if (m_hasAsyncListeners) {
+		return Push(HOST_QUEUE, Event{ type, frameId, {} });
+	}
+	return Ticket{ HOST_QUEUE, 0 };
+}
 
-		// 5. lock collection of event listeners
-		std::lock_guard<std::mutex> listenerLock(state->m_listenerMutex);
 
-		// 6. call event handlers
-		for (auto& event : events) {
-			try {
-				for (auto listener : state->m_listeners) {
-					event.action(listener);
-				}
-				event.signal.set_value();
-			}
-			catch (...) {
-				assert(false); // should log instead
-				event.signal.set_exception(std::current_exception());
-			}
-		}
-	}
+PipelineEventDispatcher::Ticket PipelineEventDispatcher::Push(int queueIndex, Event event) {
+	EventQueue& queue = m_queues[queueIndex];
+	std::unique_lock<std::mutex> lock(queue.mutex);
+	queue.cv.wait(lock, [&queue] { return queue.pushed - queue.completed.load() < EventQueue::Capacity; });
 
-	// 7. ???
-	// 8. profit
+	queue.events[queue.pushed % EventQueue::Capacity] = std::move(event);
+	++queue.pushed;
+	queue.cv.notify_all();
+
+	return Ticket{ queueIndex, queue.pushed };
 }
 
-void PipelineEventDispatcher::DeviceSyncThread(std::shared_ptr<State> state) {
-	SetCurrentThreadName("Event Dispatcher: Device Sync Thread");
 
-	while (state->m_runDeviceThread) {
-		std::unique_lock<std::mutex> lk(state->m_deviceEventMutex);
-		state->m_deviceCv.wait(lk, [&state] { return !state->m_deviceEventActions.empty() || !state->m_runDeviceThread; });
+void PipelineEventDispatcher::EventThread(int queueIndex) {
+	SetCurrentThreadName(queueIndex == DEVICE_QUEUE ? "Event Dispatcher: Device Sync Thread" : "Event Dispatcher Thread");
 
-		std::vector<DeviceEventAction> events;
-		while (!state->m_deviceEventActions.empty()) {
-			events.push_back(std::move(state->m_deviceEventActions.front()));
-			state->m_deviceEventActions.pop();
+	EventQueue& queue = m_queues[queueIndex];
+	while (true) {
+		Event event;
+		{
+			std::unique_lock<std::mutex> lock(queue.mutex);
+			queue.cv.wait(lock, [&queue] { return queue.pushed > queue.completed.load() || !queue.run; });
+			if (!queue.run) {
+				break;
+			}
+			// the producer does not overwrite the slot until completed is incremented
+			event = std::move(queue.events[queue.completed.load() % EventQueue::Capacity]);
 		}
 
-		lk.unlock();
-
-		for (auto& event : events) {
+		if (queueIndex == DEVICE_QUEUE) {
 			event.premise.Wait();
-			PushEventAction(state.get(), EventAction{ std::move(event.action), std::move(event.signal) });
+		}
+
+		{
+			std::lock_guard<std::mutex> listenerLock(m_listenerMutex);
+			// device events reach every listener, host events only reach the asynchronous ones here
+			if (queueIndex == DEVICE_QUEUE) {
+				for (auto listener : m_syncListeners) {
+					CallHandler(listener, event.type, event.frameId);
+				}
+			}
+			for (auto listener : m_asyncListeners) {
+				CallHandler(listener, event.type, event.frameId);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			++queue.completed;
+			queue.cv.notify_all();
 		}
 	}
 }
 
 
+void PipelineEventDispatcher::CallHandler(PipelineEventListener* listener, eEventType type, uint64_t frameId) {
+	const char* eventName = "";
+	std::string what;
+	try {
+		switch (type) {
+			case eEventType::FRAME_BEGIN_HOST: eventName = "OnFrameBeginHost"; listener->OnFrameBeginHost(frameId); break;
+			case eEventType::FRAME_COMPLETE_HOST: eventName = "OnFrameCompleteHost"; listener->OnFrameCompleteHost(frameId); break;
+			case eEventType::FRAME_BEGIN_AWAIT: eventName = "OnFrameBeginAwait"; listener->OnFrameBeginAwait(frameId); break;
+			case eEventType::FRAME_BEGIN_DEVICE: eventName = "OnFrameBeginDevice"; listener->OnFrameBeginDevice(frameId); break;
+			case eEventType::FRAME_COMPLETE_DEVICE: eventName = "OnFrameCompleteDevice"; listener->OnFrameCompleteDevice(frameId); break;
+		}
+		return;
+	}
+	catch (std::exception& ex) {
+		what = ex.what();
+	}
+	catch (...) {
+		what = "unknown exception";
+	}
 
-void PipelineEventDispatcher::PushEventAction(State* state, EventAction eventAction) {
-	std::unique_lock<std::mutex>  lkg(state->m_eventMutex);
-	state->m_eventActions.push(std::move(eventAction));
-	state->m_eventCv.notify_all();
+	// handlers may run on the event threads, there is nobody to rethrow to
+	if (m_log) {
+		m_log->Event(exc::Event("Pipeline event handler failed.",
+								exc::eEventType::ERROR,
+								exc::EventParameterString("event", eventName),
+								exc::EventParameterInt("frameId", (int)frameId),
+								exc::EventParameterString("what", what)));
+	}
 }
 
 
 
 } // namespace gxeng
-} // namespace inl
\ No newline at end of file
+} // namespace inl
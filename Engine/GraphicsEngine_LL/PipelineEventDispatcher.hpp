@@ -3,70 +3,111 @@
 #include "SyncPoint.hpp"
 #include "PipelineEventListener.hpp"
 
-#include <future>
+#include <BaseLibrary/Logging/LogStream.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
-#include <set>
-#include <queue>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 
 namespace inl {
 namespace gxeng {
 
 
+/// <summary>
+/// Notifies listeners about the frames of the pipeline.
+/// Host events are handled on the dispatching thread, except for asynchronous listeners, which get them on the event thread.
+/// Device events are handled on the device sync thread once the device has reached the event.
+/// Handlers of the same dispatcher never run concurrently.
+/// Events are kept in fixed size queues, so dispatching does not allocate.
+/// Exceptions thrown by handlers are logged, the other handlers still get the event.
+/// </summary>
 class PipelineEventDispatcher {
-	struct EventAction {
-		std::function<void(PipelineEventListener*)> action;
-		std::promise<void> signal;
+public:
+	/// <summary> Identifies a dispatched event, to check whether all its handlers have run. </summary>
+	struct Ticket {
+		int queue;
+		uint64_t sequence;
 	};
-	struct DeviceEventAction : EventAction {
-		SyncPoint premise; // NOT prOmise
+
+private:
+	enum class eEventType {
+		FRAME_BEGIN_HOST,
+		FRAME_COMPLETE_HOST,
+		FRAME_BEGIN_AWAIT,
+		FRAME_BEGIN_DEVICE,
+		FRAME_COMPLETE_DEVICE,
 	};
-	enum eReasonForAwake {
-		CANCEL = 0,
-		QUIT = 1,
-		EVENT,
+	struct Event {
+		eEventType type;
+		uint64_t frameId;
+		SyncPoint premise; // NOT prOmise, only for device events
 	};
-	struct State {
-		std::queue<EventAction> m_eventActions;
-		std::mutex m_eventMutex;
-		std::condition_variable m_eventCv;
-		std::atomic_bool m_runEventThread;
-
-		std::queue<DeviceEventAction> m_deviceEventActions;
-		std::mutex m_deviceEventMutex;
-		std::condition_variable m_deviceCv;
-		std::atomic_bool m_runDeviceThread;
-
-		std::mutex m_listenerMutex;
-		std::set<PipelineEventListener*> m_listeners;
+
+	/// <summary> Events waiting for a worker thread, the producer blocks when the queue is full. </summary>
+	struct EventQueue {
+		static constexpr size_t Capacity = 64;
+
+		std::array<Event, Capacity> events;
+		uint64_t pushed = 0; // guarded by mutex
+		std::atomic<uint64_t> completed = 0;
+		std::mutex mutex;
+		std::condition_variable cv;
+		bool run = true;
 	};
+
+	enum : int { HOST_QUEUE = 0, DEVICE_QUEUE = 1 };
+
 public:
 	PipelineEventDispatcher();
 	PipelineEventDispatcher(const PipelineEventDispatcher&) = delete;
-	PipelineEventDispatcher(PipelineEventDispatcher&&);
 	PipelineEventDispatcher& operator=(const PipelineEventDispatcher&) = delete;
-	PipelineEventDispatcher& operator=(PipelineEventDispatcher&&);
+	/// <summary> Stops the threads. Events not handled yet are dropped, call <see cref="Flush"/> first to handle them. </summary>
 	~PipelineEventDispatcher() noexcept;
 
+	/// <summary> Sets where exceptions thrown by handlers are reported. Without a log, they are ignored. </summary>
+	void SetLog(exc::LogStream* log);
+
 
-	std::future<void> DispatchFrameBegin(uint64_t frameId);
-	std::future<void> DispatchFrameEnd(uint64_t frameId);
-	std::future<void> DispachFrameBeginAwait(uint64_t frameId);
-	std::future<void> DispatchDeviceFrameBegin(SyncPoint deviceEvent, uint64_t frameId);
-	std::future<void> DispatchDeviceFrameEnd(SyncPoint deviceEvent, uint64_t frameId);
+	Ticket DispatchFrameBegin(uint64_t frameId);
+	Ticket DispatchFrameEnd(uint64_t frameId);
+	Ticket DispachFrameBeginAwait(uint64_t frameId);
+	Ticket DispatchDeviceFrameBegin(SyncPoint deviceEvent, uint64_t frameId);
+	Ticket DispatchDeviceFrameEnd(SyncPoint deviceEvent, uint64_t frameId);
 
+	/// <summary> True if all handlers of the event have returned. </summary>
+	bool IsHandled(Ticket ticket) const;
+	/// <summary> Blocks until all handlers of the event have returned. </summary>
+	void WaitHandled(Ticket ticket);
+	/// <summary> Blocks until all events dispatched so far have been handled, device events included. </summary>
+	/// <remarks> Device events wait for the device to reach them, so the device must not be stalled. </remarks>
+	void Flush();
 
+	/// <summary> Adds a listener whose host events are handled on the dispatching thread. </summary>
 	void operator+=(PipelineEventListener* listener);
+	/// <summary> Adds a listener whose host events are handled on the event thread, for handlers that take long. </summary>
+	void AddAsync(PipelineEventListener* listener);
 	void operator-=(PipelineEventListener* listener);
 private:
-	static void DispatchThread(std::shared_ptr<State> state);
-	static void DeviceSyncThread(std::shared_ptr<State> state);
-	static void PushEventAction(State* state, EventAction eventAction);
-	void Shutdown();
+	Ticket DispatchHost(eEventType type, uint64_t frameId);
+	Ticket Push(int queueIndex, Event event);
+
+	void EventThread(int queueIndex);
+	/// <summary> Must be called with the listener mutex locked. </summary>
+	void CallHandler(PipelineEventListener* listener, eEventType type, uint64_t frameId);
 private:
-	std::shared_ptr<State> state;
+	std::array<EventQueue, 2> m_queues;
+
+	// handlers are called with this locked, that keeps them from running concurrently
+	std::mutex m_listenerMutex;
+	std::vector<PipelineEventListener*> m_syncListeners;
+	std::vector<PipelineEventListener*> m_asyncListeners;
+	std::atomic_bool m_hasAsyncListeners = false;
+	exc::LogStream* m_log = nullptr; // guarded by the listener mutex
 
 	std::thread m_eventThread;
 	std::thread m_deviceSyncThread;
@@ -0,0 +1,290 @@
+#include "PipelineProfiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+
+namespace inl {
+namespace gxeng {
+
+
+static const char* GetCategoryName(eProfileCategory category) {
+	switch (category) {
+		case eProfileCategory::SETUP: return "Setup";
+		case eProfileCategory::EXECUTE: return "Execute";
+		case eProfileCategory::BARRIERS: return "Barriers";
+		case eProfileCategory::SUBMIT: return "Submit";
+		case eProfileCategory::GPU: return "GPU";
+		default: return "Unknown";
+	}
+}
+
+
+static void WriteMicroseconds(std::ostream& os, int64_t nanoseconds) {
+	nanoseconds = std::max<int64_t>(0, nanoseconds);
+	int64_t fraction = nanoseconds % 1000;
+	os << nanoseconds / 1000 << '.' << (char)('0' + fraction / 100) << (char)('0' + fraction / 10 % 10) << (char)('0' + fraction % 10);
+}
+
+
+PipelineProfiler::PipelineProfiler(size_t numFrames)
+	: m_epoch(std::chrono::steady_clock::now())
+{
+	if (numFrames == 0) {
+		throw std::invalid_argument("Profiler must keep at least one frame.");
+	}
+	m_frames.resize(numFrames);
+}
+
+
+PipelineProfiler::~PipelineProfiler() {
+	// queries of frames still in flight resolve into the buffer
+	for (auto& slot : m_gpuSlots) {
+		if (slot.pending) {
+			slot.completion.Wait();
+		}
+	}
+	if (m_readbackBuffer) {
+		m_readbackBuffer->Unmap(0);
+	}
+}
+
+
+void PipelineProfiler::EnableGpuTiming(gxapi::IGraphicsApi* graphicsApi, uint64_t timestampFrequency, unsigned maxEventsPerFrame) {
+	if (timestampFrequency == 0 || m_timestampFrequency != 0) {
+		return;
+	}
+
+	m_queriesPerSlot = 2 * maxEventsPerFrame;
+	unsigned numQueries = NumGpuSlots * m_queriesPerSlot;
+	m_queryHeap.reset(graphicsApi->CreateQueryHeap(gxapi::QueryHeapDesc{ gxapi::eQueryHeapType::TIMESTAMP, numQueries }));
+	m_readbackBuffer.reset(graphicsApi->CreateCommittedResource(
+		gxapi::HeapProperties{ gxapi::eHeapType::READBACK },
+		gxapi::eHeapFlags::NONE,
+		gxapi::ResourceDesc::Buffer(numQueries * sizeof(uint64_t)),
+		gxapi::eResourceState::COPY_DEST));
+	m_readbackData = static_cast<const uint64_t*>(m_readbackBuffer->Map(0));
+	m_timestampFrequency = timestampFrequency;
+}
+
+
+uint32_t PipelineProfiler::RegisterName(const std::string& name) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	auto it = m_nameIds.find(name);
+	if (it != m_nameIds.end()) {
+		return it->second;
+	}
+	uint32_t id = (uint32_t)m_names.size();
+	m_names.push_back(name);
+	m_nameIds.insert({ name, id });
+	return id;
+}
+
+
+const std::string& PipelineProfiler::GetName(uint32_t name) const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	return m_names.at(name);
+}
+
+
+void PipelineProfiler::BeginFrame(uint64_t frame) {
+	{
+		std::lock_guard<std::mutex> lkg(m_mutex);
+		m_currentFrame.frame = frame;
+		m_currentFrame.thread = GetThreadId();
+		m_currentFrame.start = Now();
+		m_currentFrame.duration = 0;
+		m_currentFrame.events.clear();
+		m_currentFrame.gpuResolved = false;
+	}
+
+	if (IsGpuTimingEnabled()) {
+		// read back whatever the GPU has finished without waiting
+		for (unsigned i = 0; i < NumGpuSlots; ++i) {
+			GpuSlot& slot = m_gpuSlots[i];
+			if (slot.pending && slot.completion.m_fence->Fetch() >= slot.completion.m_value) {
+				CollectGpuEvents(slot, i);
+			}
+		}
+
+		// the slot of this frame must be free
+		m_currentGpuSlotIndex = (unsigned)(m_numFinishedFrames % NumGpuSlots);
+		m_currentGpuSlot = &m_gpuSlots[m_currentGpuSlotIndex];
+		if (m_currentGpuSlot->pending) {
+			m_currentGpuSlot->completion.Wait();
+			CollectGpuEvents(*m_currentGpuSlot, m_currentGpuSlotIndex);
+		}
+		m_currentGpuSlot->sequence = m_numFinishedFrames;
+		m_currentGpuSlot->events.clear();
+		m_currentGpuSlot->completion = {};
+	}
+}
+
+
+void PipelineProfiler::EndFrame(SyncPoint gpuCompletion) {
+	bool gpuPending = false;
+	if (m_currentGpuSlot) {
+		// without resolved queries the frame failed midway and has nothing to read back
+		gpuPending = m_currentGpuSlot->pending && gpuCompletion;
+		m_currentGpuSlot->pending = gpuPending;
+		m_currentGpuSlot->completion = std::move(gpuCompletion);
+		m_currentGpuSlot = nullptr;
+	}
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_currentFrame.duration = Now() - m_currentFrame.start;
+	m_currentFrame.gpuResolved = !gpuPending;
+	std::swap(m_frames[m_numFinishedFrames % m_frames.size()], m_currentFrame); // keeps the event buffers of old frames
+	++m_numFinishedFrames;
+}
+
+
+int64_t PipelineProfiler::Now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+
+void PipelineProfiler::AddCpuEvent(uint32_t name, eProfileCategory category, int64_t start, int64_t end) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_currentFrame.events.push_back(ProfileEvent{ name, category, GetThreadId(), start, end - start });
+}
+
+
+int PipelineProfiler::BeginGpuEvent(uint32_t name, gxapi::ICopyCommandList* commandList) {
+	if (m_currentGpuSlot == nullptr || 2 * (m_currentGpuSlot->events.size() + 1) > m_queriesPerSlot) {
+		return -1;
+	}
+
+	int handle = (int)m_currentGpuSlot->events.size();
+	m_currentGpuSlot->events.push_back(GpuEvent{ name, Now() });
+	commandList->EndQuery(m_queryHeap.get(), m_currentGpuSlotIndex * m_queriesPerSlot + 2 * handle);
+	return handle;
+}
+
+
+void PipelineProfiler::EndGpuEvent(int handle, gxapi::ICopyCommandList* commandList) {
+	if (m_currentGpuSlot == nullptr || handle < 0) {
+		return;
+	}
+	commandList->EndQuery(m_queryHeap.get(), m_currentGpuSlotIndex * m_queriesPerSlot + 2 * handle + 1);
+}
+
+
+void PipelineProfiler::ResolveGpuEvents(gxapi::ICopyCommandList* commandList) {
+	if (m_currentGpuSlot == nullptr || m_currentGpuSlot->events.empty()) {
+		return;
+	}
+	unsigned firstQuery = m_currentGpuSlotIndex * m_queriesPerSlot;
+	unsigned numQueries = 2 * (unsigned)m_currentGpuSlot->events.size();
+	commandList->ResolveQueryData(m_queryHeap.get(), firstQuery, numQueries, m_readbackBuffer.get(), firstQuery * sizeof(uint64_t));
+	m_currentGpuSlot->pending = true;
+}
+
+
+size_t PipelineProfiler::GetNumFrames() const {
+	return (size_t)std::min<uint64_t>(m_numFinishedFrames, m_frames.size());
+}
+
+
+const FrameProfile& PipelineProfiler::GetFrame(size_t age) const {
+	if (age >= GetNumFrames()) {
+		throw std::out_of_range("Frame is not kept by the profiler.");
+	}
+	return m_frames[(m_numFinishedFrames - 1 - age) % m_frames.size()];
+}
+
+
+void PipelineProfiler::WriteChromeTrace(std::ostream& os) const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	os << "{\"traceEvents\":[\n";
+	os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Pipeline\"}}";
+
+	// the GPU gets its own track, the CPU threads are numbered from one
+	os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+	for (const auto& thread : m_threadIds) {
+		os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second << ",\"args\":{\"name\":\"CPU " << thread.second << "\"}}";
+	}
+
+	size_t numFrames = GetNumFrames();
+	for (size_t age = numFrames; age-- > 0; ) {
+		const FrameProfile& frame = GetFrame(age);
+
+		os << ",\n{\"name\":\"Frame " << frame.frame << "\",\"cat\":\"Frame\",\"ph\":\"X\",\"ts\":";
+		WriteMicroseconds(os, frame.start);
+		os << ",\"dur\":";
+		WriteMicroseconds(os, frame.duration);
+		os << ",\"pid\":1,\"tid\":" << frame.thread << "}";
+
+		for (const ProfileEvent& event : frame.events) {
+			os << ",\n{\"name\":";
+			WriteJsonString(os, m_names[event.name]);
+			os << ",\"cat\":\"" << GetCategoryName(event.category) << "\",\"ph\":\"X\",\"ts\":";
+			WriteMicroseconds(os, event.start);
+			os << ",\"dur\":";
+			WriteMicroseconds(os, event.duration);
+			os << ",\"pid\":1,\"tid\":" << (event.category == eProfileCategory::GPU ? 0 : event.thread) << ",\"args\":{\"frame\":" << frame.frame << "}}";
+		}
+	}
+
+	os << "\n]}\n";
+}
+
+
+uint32_t PipelineProfiler::GetThreadId() {
+	// called with the mutex locked
+	auto it = m_threadIds.find(std::this_thread::get_id());
+	if (it != m_threadIds.end()) {
+		return it->second;
+	}
+	uint32_t id = (uint32_t)m_threadIds.size() + 1;
+	m_threadIds.insert({ std::this_thread::get_id(), id });
+	return id;
+}
+
+
+void PipelineProfiler::CollectGpuEvents(GpuSlot& slot, unsigned slotIndex) {
+	slot.pending = false;
+	if (slot.events.empty() || m_numFinishedFrames - slot.sequence > m_frames.size()) {
+		return; // the frame has already left the ring
+	}
+
+	FrameProfile& frame = m_frames[slot.sequence % m_frames.size()];
+	const uint64_t* timestamps = m_readbackData + slotIndex * m_queriesPerSlot;
+	uint64_t originTick = timestamps[0];
+	int64_t originTime = slot.events[0].recordTime;
+	double nanosecondsPerTick = 1e9 / (double)m_timestampFrequency;
+	auto ToTime = [&](uint64_t tick) {
+		return originTime + (int64_t)((double)(int64_t)(tick - originTick) * nanosecondsPerTick);
+	};
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	for (size_t i = 0; i < slot.events.size(); ++i) {
+		int64_t start = ToTime(timestamps[2 * i]);
+		int64_t end = ToTime(timestamps[2 * i + 1]);
+		frame.events.push_back(ProfileEvent{ slot.events[i].name, eProfileCategory::GPU, 0, start, end - start });
+	}
+	frame.gpuResolved = true;
+}
+
+
+void PipelineProfiler::WriteJsonString(std::ostream& os, const std::string& str) {
+	os << '"';
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			os << '\\' << c;
+		}
+		else if ((unsigned char)c < 0x20) {
+			os << ' ';
+		}
+		else {
+			os << c;
+		}
+	}
+	os << '"';
+}
+
+
+} // namespace gxeng
+} // namespace inl
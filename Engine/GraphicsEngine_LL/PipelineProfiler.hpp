@@ -0,0 +1,168 @@
+#pragma once
+
+#include "SyncPoint.hpp"
+
+#include <GraphicsApi_LL/IGraphicsApi.hpp>
+#include <GraphicsApi_LL/IQueryHeap.hpp>
+#include <GraphicsApi_LL/IResource.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+namespace gxeng {
+
+
+enum class eProfileCategory {
+	SETUP,
+	EXECUTE,
+	BARRIERS,
+	SUBMIT,
+	GPU,
+};
+
+
+/// <summary> A timed span of work. Times are nanoseconds since the profiler was created. </summary>
+struct ProfileEvent {
+	uint32_t name;
+	eProfileCategory category;
+	uint32_t thread; // numbered from one, zero for the GPU
+	int64_t start;
+	int64_t duration;
+};
+
+
+/// <summary> Every event recorded between BeginFrame and EndFrame. </summary>
+struct FrameProfile {
+	uint64_t frame = 0;
+	uint32_t thread = 0;
+	int64_t start = 0;
+	int64_t duration = 0;
+	std::vector<ProfileEvent> events;
+	/// <summary> True once the GPU events of the frame have been read back. </summary>
+	bool gpuResolved = false;
+};
+
+
+/// <summary>
+/// Records per-task CPU timings and GPU timestamps of the pipeline,
+/// and keeps them for the last few frames.
+/// </summary>
+/// <remarks>
+/// CPU events may be added from any thread. Frames are begun, ended and read on the thread that runs the engine.
+/// GPU timestamps are not calibrated against the CPU clock: the first timestamp of a frame
+/// is aligned to the time its command list was recorded.
+/// </remarks>
+class PipelineProfiler {
+public:
+	/// <param name="numFrames"> How many of the last frames are kept. </param>
+	explicit PipelineProfiler(size_t numFrames = 120);
+	PipelineProfiler(const PipelineProfiler&) = delete;
+	PipelineProfiler& operator=(const PipelineProfiler&) = delete;
+	~PipelineProfiler();
+
+	/// <summary> Places timestamp queries around command lists from now on. </summary>
+	/// <param name="timestampFrequency"> Ticks per second of the queue's timestamps. Zero leaves GPU timing off. </param>
+	/// <param name="maxEventsPerFrame"> GPU events beyond this many per frame are not timed. </param>
+	void EnableGpuTiming(gxapi::IGraphicsApi* graphicsApi, uint64_t timestampFrequency, unsigned maxEventsPerFrame = 256);
+	bool IsGpuTimingEnabled() const { return m_timestampFrequency != 0; }
+
+	/// <summary> Returns the id of the name, the same name always gets the same id. </summary>
+	uint32_t RegisterName(const std::string& name);
+	const std::string& GetName(uint32_t name) const;
+
+	void BeginFrame(uint64_t frame);
+	/// <param name="gpuCompletion"> Reached when the frame's command lists finished, the GPU events are read back after that. </param>
+	void EndFrame(SyncPoint gpuCompletion = {});
+
+	/// <summary> Nanoseconds since the profiler was created. </summary>
+	int64_t Now() const;
+	void AddCpuEvent(uint32_t name, eProfileCategory category, int64_t start, int64_t end);
+
+	/// <summary> Writes the starting timestamp of a GPU event into the command list. </summary>
+	/// <returns> The handle to end the event with, or -1 if the event is not timed. </returns>
+	int BeginGpuEvent(uint32_t name, gxapi::ICopyCommandList* commandList);
+	void EndGpuEvent(int handle, gxapi::ICopyCommandList* commandList);
+	/// <summary> Copies the timestamps of the current frame to the readback buffer, must be the last command of the frame. </summary>
+	void ResolveGpuEvents(gxapi::ICopyCommandList* commandList);
+
+	/// <summary> Number of finished frames kept. </summary>
+	size_t GetNumFrames() const;
+	/// <param name="age"> Zero is the most recent finished frame. </param>
+	const FrameProfile& GetFrame(size_t age) const;
+
+	/// <summary> Writes the kept frames in Chrome's trace event format, viewable in chrome://tracing. </summary>
+	void WriteChromeTrace(std::ostream& os) const;
+private:
+	struct GpuEvent {
+		uint32_t name;
+		int64_t recordTime;
+	};
+	struct GpuSlot {
+		uint64_t sequence = 0;
+		SyncPoint completion;
+		std::vector<GpuEvent> events; // event i uses queries 2i and 2i+1
+		bool pending = false;
+	};
+	static constexpr unsigned NumGpuSlots = 4; // more than the frames that can be in flight
+
+	uint32_t GetThreadId();
+	void CollectGpuEvents(GpuSlot& slot, unsigned slotIndex);
+	static void WriteJsonString(std::ostream& os, const std::string& str);
+private:
+	std::chrono::steady_clock::time_point m_epoch;
+
+	// frames
+	std::vector<FrameProfile> m_frames;
+	uint64_t m_numFinishedFrames = 0;
+	FrameProfile m_currentFrame;
+	mutable std::mutex m_mutex; // guards the current frame's events, the names and the thread ids
+
+	// names
+	std::vector<std::string> m_names;
+	std::unordered_map<std::string, uint32_t> m_nameIds;
+	std::unordered_map<std::thread::id, uint32_t> m_threadIds;
+
+	// GPU
+	uint64_t m_timestampFrequency = 0;
+	unsigned m_queriesPerSlot = 0;
+	std::unique_ptr<gxapi::IQueryHeap> m_queryHeap;
+	std::unique_ptr<gxapi::IResource> m_readbackBuffer;
+	const uint64_t* m_readbackData = nullptr;
+	GpuSlot m_gpuSlots[NumGpuSlots];
+	GpuSlot* m_currentGpuSlot = nullptr;
+	unsigned m_currentGpuSlotIndex = 0;
+};
+
+
+/// <summary> Adds a CPU event for its lifetime, does nothing without a profiler. </summary>
+class ProfileScope {
+public:
+	ProfileScope(PipelineProfiler* profiler, uint32_t name, eProfileCategory category)
+		: m_profiler(profiler), m_name(name), m_category(category), m_start(profiler ? profiler->Now() : 0)
+	{}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+	~ProfileScope() {
+		if (m_profiler) {
+			m_profiler->AddCpuEvent(m_name, m_category, m_start, m_profiler->Now());
+		}
+	}
+private:
+	PipelineProfiler* m_profiler;
+	uint32_t m_name;
+	eProfileCategory m_category;
+	int64_t m_start;
+};
+
+
+} // namespace gxeng
+} // namespace inl
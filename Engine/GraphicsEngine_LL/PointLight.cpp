@@ -0,0 +1,44 @@
+#include "PointLight.hpp"
+
+namespace inl::gxeng {
+
+
+PointLight::PointLight(mathfu::Vector3f position, mathfu::Vector3f color, float range
+):
+	m_position(position),
+	m_color(color),
+	m_range(range)
+{}
+
+
+void PointLight::SetPosition(const mathfu::Vector3f& position) {
+	m_position = position;
+}
+
+
+void PointLight::SetColor(const mathfu::Vector3f& color) {
+	m_color = color;
+}
+
+
+void PointLight::SetRange(float range) {
+	m_range = range;
+}
+
+
+mathfu::Vector3f PointLight::GetPosition() const {
+	return m_position;
+}
+
+
+mathfu::Vector3f PointLight::GetColor() const {
+	return m_color;
+}
+
+
+float PointLight::GetRange() const {
+	return m_range;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <mathfu/mathfu_exc.hpp>
+
+namespace inl::gxeng {
+
+class PointLight {
+public:
+	PointLight() = default;
+	PointLight(mathfu::Vector3f position, mathfu::Vector3f color, float range);
+
+	void SetPosition(const mathfu::Vector3f& position);
+	void SetColor(const mathfu::Vector3f& color);
+	void SetRange(float range);
+
+	mathfu::Vector3f GetPosition() const;
+	mathfu::Vector3f GetColor() const;
+	float GetRange() const;
+
+protected:
+	mathfu::Vector3f m_position = { 0, 0, 0 };
+	mathfu::Vector3f m_color = { 1, 1, 1 };
+	float m_range = 1.0f;
+};
+
+} // namespace inl::gxeng
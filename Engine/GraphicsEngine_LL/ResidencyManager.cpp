@@ -0,0 +1,241 @@
+#include "ResidencyManager.hpp"
+
+#include "../GraphicsApi_LL/Common.hpp"
+#include "../GraphicsApi_LL/Exception.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace inl {
+namespace gxeng {
+
+
+ResidencyManager::ResidencyManager(gxapi::IGraphicsApi* graphicsApi, uint64_t budget)
+	: m_graphicsApi(graphicsApi),
+	m_budget(budget)
+{}
+
+
+void ResidencyManager::SetBudget(uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_budget = bytes;
+	EvictToFit(0);
+}
+
+
+uint64_t ResidencyManager::GetBudget() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_budget;
+}
+
+
+uint64_t ResidencyManager::GetResidentSize() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_residentSize;
+}
+
+
+void ResidencyManager::SetCurrentFrame(uint64_t frame) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_currentFrame = frame;
+}
+
+
+void ResidencyManager::Add(gxapi::IResource* resource, uint64_t size) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto[it, inserted] = m_entries.insert({ resource, Entry{ size } });
+	assert(inserted);
+	Entry& entry = it->second;
+	entry.lastUsedFrame = m_currentFrame;
+	entry.lruPosition = m_lru.insert(m_lru.end(), resource);
+	m_residentSize += size;
+
+	// the new resource is the most recently used, it goes last
+	EvictToFit(0);
+}
+
+
+void ResidencyManager::Remove(gxapi::IResource* resource) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entries.find(resource);
+	if (it == m_entries.end()) {
+		return;
+	}
+	Entry& entry = it->second;
+	if (entry.resident) {
+		if (entry.lockCount == 0) {
+			m_lru.erase(entry.lruPosition);
+		}
+		m_residentSize -= entry.size;
+	}
+	m_entries.erase(it);
+}
+
+
+void ResidencyManager::Lock(const std::vector<gxapi::IResource*>& resources) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_toMakeResident.clear();
+	uint64_t requiredSize = 0;
+	for (gxapi::IResource* resource : resources) {
+		auto it = m_entries.find(resource);
+		if (it == m_entries.end()) {
+			continue;
+		}
+		Entry& entry = it->second;
+		if (entry.lockCount == 0 && entry.resident) {
+			m_lru.erase(entry.lruPosition);
+		}
+		++entry.lockCount;
+		entry.lastUsedFrame = m_currentFrame;
+		if (!entry.resident) {
+			// marked early so that duplicates in the list are made resident once
+			entry.resident = true;
+			m_toMakeResident.push_back(resource);
+			requiredSize += entry.size;
+		}
+	}
+
+	if (m_toMakeResident.empty()) {
+		return;
+	}
+
+	EvictToFit(requiredSize);
+	try {
+		try {
+			m_graphicsApi->MakeResident(m_toMakeResident);
+		}
+		catch (gxapi::OutOfMemory&) {
+			// the device is out of memory before our budget is
+			EvictAllUnlocked();
+			m_graphicsApi->MakeResident(m_toMakeResident);
+		}
+	}
+	catch (...) {
+		// a failed lock leaves the resources as they were, so that it can be retried
+		for (gxapi::IResource* resource : m_toMakeResident) {
+			m_entries[resource].resident = false;
+		}
+		for (gxapi::IResource* resource : resources) {
+			auto it = m_entries.find(resource);
+			if (it == m_entries.end()) {
+				continue;
+			}
+			Entry& entry = it->second;
+			if (--entry.lockCount == 0 && entry.resident) {
+				entry.lruPosition = m_lru.insert(m_lru.end(), resource);
+			}
+		}
+		throw;
+	}
+	m_residentSize += requiredSize;
+}
+
+
+void ResidencyManager::Unlock(const std::vector<gxapi::IResource*>& resources) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (gxapi::IResource* resource : resources) {
+		auto it = m_entries.find(resource);
+		if (it == m_entries.end()) {
+			continue;
+		}
+		Entry& entry = it->second;
+		assert(entry.lockCount > 0);
+		if (entry.lockCount > 0 && --entry.lockCount == 0 && entry.resident) {
+			entry.lruPosition = m_lru.insert(m_lru.end(), resource);
+		}
+	}
+}
+
+
+bool ResidencyManager::IsResident(gxapi::IResource* resource) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_entries.find(resource);
+	return it != m_entries.end() && it->second.resident;
+}
+
+
+bool ResidencyManager::IsLocked(gxapi::IResource* resource) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_entries.find(resource);
+	return it != m_entries.end() && it->second.lockCount > 0;
+}
+
+
+uint64_t ResidencyManager::GetLastUsedFrame(gxapi::IResource* resource) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_entries.find(resource);
+	return it != m_entries.end() ? it->second.lastUsedFrame : 0;
+}
+
+
+uint64_t ResidencyManager::EstimateSize(const gxapi::ResourceDesc& desc) {
+	if (desc.type == gxapi::eResourceType::BUFFER) {
+		return desc.bufferDesc.sizeInBytes;
+	}
+
+	const gxapi::TextureDesc& tex = desc.textureDesc;
+	bool is3D = tex.dimension == gxapi::eTextueDimension::THREE;
+	uint64_t arraySize = is3D ? 1 : std::max<uint64_t>(1, tex.depthOrArraySize);
+	uint64_t pixelSize = std::max<uint64_t>(1, gxapi::GetFormatSizeInBytes(tex.format));
+	uint64_t samples = std::max<uint64_t>(1, tex.multisampleCount);
+
+	// zero mip levels means the full chain
+	unsigned mipLevels = tex.mipLevels;
+	if (mipLevels == 0) {
+		uint64_t largest = std::max<uint64_t>({ tex.width, tex.height, is3D ? tex.depthOrArraySize : 1u });
+		while (largest >> mipLevels) {
+			++mipLevels;
+		}
+	}
+
+	uint64_t size = 0;
+	for (unsigned mip = 0; mip < mipLevels; ++mip) {
+		uint64_t width = std::max<uint64_t>(1, tex.width >> mip);
+		uint64_t height = std::max<uint64_t>(1, tex.height >> mip);
+		uint64_t depth = is3D ? std::max<uint64_t>(1, tex.depthOrArraySize >> mip) : 1;
+		size += width * height * depth;
+	}
+	return size * arraySize * pixelSize * samples;
+}
+
+
+void ResidencyManager::EvictToFit(uint64_t requiredSize) {
+	size_t count = 0;
+	uint64_t residentSize = m_residentSize;
+	for (auto it = m_lru.begin(); it != m_lru.end() && residentSize + requiredSize > m_budget; ++it, ++count) {
+		residentSize -= m_entries[*it].size;
+	}
+	EvictFront(count);
+}
+
+
+void ResidencyManager::EvictAllUnlocked() {
+	EvictFront(m_lru.size());
+}
+
+
+void ResidencyManager::EvictFront(size_t count) {
+	if (count == 0) {
+		return;
+	}
+
+	m_toEvict.clear();
+	for (size_t i = 0; i < count; ++i) {
+		gxapi::IResource* resource = m_lru.front();
+		m_lru.pop_front();
+		Entry& entry = m_entries[resource];
+		entry.resident = false;
+		m_residentSize -= entry.size;
+		m_toEvict.push_back(resource);
+	}
+	m_graphicsApi->Evict(m_toEvict);
+}
+
+
+} // namespace gxeng
+} // namespace inl
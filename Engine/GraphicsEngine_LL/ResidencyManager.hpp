@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "../GraphicsApi_LL/IResource.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary>
+/// Keeps the video memory of tracked resources within a budget.
+/// Resources are locked resident while command lists that use them are in flight.
+/// When locking needs room, the least recently used unlocked resources are evicted first.
+/// If the locked resources alone exceed the budget, the budget is overcommitted instead of failing.
+/// </summary>
+/// <remarks> Resources that are not tracked (upload and constant buffer heaps) are ignored. Thread safe. </remarks>
+class ResidencyManager {
+public:
+	static constexpr uint64_t Unlimited = std::numeric_limits<uint64_t>::max();
+
+public:
+	ResidencyManager(gxapi::IGraphicsApi* graphicsApi, uint64_t budget = Unlimited);
+
+	void SetBudget(uint64_t bytes);
+	uint64_t GetBudget() const;
+	/// <summary> Total size of the tracked resources that are currently resident. </summary>
+	uint64_t GetResidentSize() const;
+
+	/// <summary> Resources locked from now on count as used in this frame. </summary>
+	void SetCurrentFrame(uint64_t frame);
+
+	/// <summary> Starts tracking a resource, which is resident when it's created. </summary>
+	void Add(gxapi::IResource* resource, uint64_t size);
+	void Remove(gxapi::IResource* resource);
+
+	/// <summary>
+	/// Makes all the resources resident with a single call to the device, after evicting what is needed to stay within the budget.
+	/// The resources can't be evicted until they are unlocked as many times as they were locked.
+	/// </summary>
+	/// <exception cref="inl::gxapi::OutOfMemory"> If the device can't make them resident even after evicting everything else.
+	///		Nothing is locked in this case. </exception>
+	void Lock(const std::vector<gxapi::IResource*>& resources);
+	void Unlock(const std::vector<gxapi::IResource*>& resources);
+
+	bool IsResident(gxapi::IResource* resource) const;
+	bool IsLocked(gxapi::IResource* resource) const;
+	/// <returns> The frame in which the resource was last locked. </returns>
+	uint64_t GetLastUsedFrame(gxapi::IResource* resource) const;
+
+	/// <summary> Approximate memory requirement of a resource, for tracking resources by their description. </summary>
+	static uint64_t EstimateSize(const gxapi::ResourceDesc& desc);
+
+private:
+	struct Entry {
+		uint64_t size;
+		uint64_t lastUsedFrame = 0;
+		unsigned lockCount = 0;
+		bool resident = true;
+		std::list<gxapi::IResource*>::iterator lruPosition; // valid if resident and unlocked
+	};
+
+	/// <summary> Evicts unlocked resources, oldest first, until the required size fits into the budget. </summary>
+	void EvictToFit(uint64_t requiredSize);
+	void EvictAllUnlocked();
+	void EvictFront(size_t count);
+
+private:
+	gxapi::IGraphicsApi* m_graphicsApi;
+	uint64_t m_budget;
+	uint64_t m_residentSize = 0;
+	uint64_t m_currentFrame = 0;
+
+	std::unordered_map<gxapi::IResource*, Entry> m_entries;
+	std::list<gxapi::IResource*> m_lru; // resident and unlocked, least recently used first
+	mutable std::mutex m_mutex;
+
+	// to avoid reallocating on every lock
+	std::vector<gxapi::IResource*> m_toMakeResident;
+	std::vector<gxapi::IResource*> m_toEvict;
+};
+
+
+} // namespace gxeng
+} // namespace inl
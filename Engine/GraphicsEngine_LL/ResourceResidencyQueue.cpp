@@ -1,13 +1,19 @@
 #include "ResourceResidencyQueue.hpp"
 #include <BaseLibrary/ThreadName.hpp>
+#include <GraphicsApi_LL/Exception.hpp>
+
+#include <algorithm>
+#include <stdexcept>
 
 namespace inl {
 namespace gxeng {
 
 
 ResourceResidencyQueue::ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fence) 
-	: m_fence(std::move(fence)),
-	m_fenceValue(0)
+	: m_numUnlocks(0),
+	m_fence(std::move(fence)),
+	m_fenceValue(0),
+	m_memoryManager(nullptr)
 {
 	m_fence->Signal(0);
 	m_runThreads = true;
@@ -18,28 +24,44 @@ ResourceResidencyQueue::ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fe
 
 ResourceResidencyQueue::~ResourceResidencyQueue() {
 	m_runThreads = false;
+	{
+		// the flag is set while the waiting threads can't be between checking it and going to sleep
+		std::lock_guard<std::mutex> initLk(m_initMutex), retryLk(m_retryMutex), cleanLk(m_cleanMutex);
+	}
 	m_initCv.notify_all();
+	m_retryCv.notify_all();
 	m_cleanCv.notify_all();
 	m_initThread.join();
 	m_cleanThread.join();
 }
 
 
+void ResourceResidencyQueue::SetMemoryManager(MemoryManager* memoryManager) {
+	std::lock_guard<std::mutex> lkg(m_initMutex);
+	if (m_fenceValue != 0) {
+		throw std::logic_error("Memory manager must be set before command lists are enqueued.");
+	}
+	m_memoryManager = memoryManager;
+}
+
+
 void ResourceResidencyQueue::SetFailureHandler(std::function<void()> handler) {
-	m_failureHandler = handler;
+	std::lock_guard<std::mutex> lkg(m_failureHandlerMutex);
+	m_failureHandler = std::move(handler);
 }
 
 
-const std::function<void()>& ResourceResidencyQueue::GetFailureHandler() const {
+std::function<void()> ResourceResidencyQueue::GetFailureHandler() const {
+	std::lock_guard<std::mutex> lkg(m_failureHandlerMutex);
 	return m_failureHandler;
 }
 
 
 SyncPoint ResourceResidencyQueue::EnqueueInit(std::vector<MemoryObject> resources) {
+	std::lock_guard<std::mutex> lkg(m_initMutex);
 	++m_fenceValue;
 	SyncPoint syncPoint(m_fence, m_fenceValue);
 
-	std::lock_guard<std::mutex> lkg(m_initMutex);
 	m_initQueue.push(std::make_unique<Task>(std::move(resources), syncPoint));
 	m_initCv.notify_one();
 
@@ -51,6 +73,7 @@ void ResourceResidencyQueue::InitThreadFunc() {
 	SetCurrentThreadName("CommandList Init Thread");
 
 	std::vector<std::unique_ptr<Task>> workingSet;
+	std::vector<MemoryObject> batch;
 	while (m_runThreads) {
 		std::unique_lock<std::mutex> lk(m_initMutex);
 		m_initCv.wait(lk, [this] {return !m_runThreads || !m_initQueue.empty(); });
@@ -62,25 +85,90 @@ void ResourceResidencyQueue::InitThreadFunc() {
 		}
 		lk.unlock();
 
+		MemoryManager* memoryManager = m_memoryManager;
+		if (!memoryManager || workingSet.empty()) {
+			for (auto& task : workingSet) {
+				task->syncPoint.m_fence->Signal(task->syncPoint.m_value);
+			}
+			workingSet.clear();
+			continue;
+		}
+
+		// resources of all waiting command lists are made resident in one go
+		batch.clear();
 		for (auto& task : workingSet) {
-			for (const MemoryObject& res : task->resources) {
-				// TODO...
+			batch.insert(batch.end(), task->resources.begin(), task->resources.end());
+		}
+		try {
+			memoryManager->LockResident(batch);
+			for (auto& task : workingSet) {
+				task->syncPoint.m_fence->Signal(task->syncPoint.m_value);
 			}
-			task->syncPoint.m_fence->Signal(task->syncPoint.m_value);
+			workingSet.clear();
+			continue;
+		}
+		catch (gxapi::OutOfMemory&) {
+			// nothing got locked, lists are tried one by one below
 		}
 
+		// Lists are locked and signaled in order, as signaling a value of the fence signals all the previous ones too.
+		// A list that doesn't fit holds back the lists after it until finished lists free enough memory.
+		for (auto& task : workingSet) {
+			if (!LockWithRetry(*memoryManager, *task)) {
+				return;
+			}
+			task->syncPoint.m_fence->Signal(task->syncPoint.m_value);
+		}
 		workingSet.clear();
 	}
 }
 
 
+bool ResourceResidencyQueue::LockWithRetry(MemoryManager& memoryManager, const Task& task) {
+	bool failureReported = false;
+	while (true) {
+		uint64_t numUnlocks;
+		{
+			std::lock_guard<std::mutex> lkg(m_retryMutex);
+			numUnlocks = m_numUnlocks;
+		}
+		try {
+			memoryManager.LockResident(task.resources);
+			return true;
+		}
+		catch (gxapi::OutOfMemory&) {
+		}
+
+		std::unique_lock<std::mutex> lk(m_retryMutex);
+		bool isMemoryFreed = m_retryCv.wait_for(lk, RetryInterval, [&] { return !m_runThreads || m_numUnlocks != numUnlocks; });
+		lk.unlock();
+		if (!m_runThreads) {
+			return false;
+		}
+		if (!isMemoryFreed && !failureReported) {
+			CallFailureHandler();
+			failureReported = true;
+		}
+	}
+}
+
+
+void ResourceResidencyQueue::CallFailureHandler() {
+	// copied so that the handler can be replaced while it's running
+	std::function<void()> handler = GetFailureHandler();
+	if (handler) {
+		handler();
+	}
+}
+
+
 void ResourceResidencyQueue::CleanThreadFunc() {
 	SetCurrentThreadName("CommandList Clean Thread");
 
 	std::vector<std::unique_ptr<Task>> workingSet;
 	while (m_runThreads) {
 		std::unique_lock<std::mutex> lk(m_cleanMutex);
-		m_cleanCv.wait(lk, [this] {return !m_runThreads || !m_cleanQueue.empty(); });
+		m_cleanCv.wait(lk, [this, &workingSet] {return !m_runThreads || !m_cleanQueue.empty() || !workingSet.empty(); });
 
 		while (!m_cleanQueue.empty()) {
 			std::unique_ptr<Task> task = std::move(m_cleanQueue.front());
@@ -89,14 +177,39 @@ void ResourceResidencyQueue::CleanThreadFunc() {
 		}
 		lk.unlock();
 
+		// Only lists that are resident and finished are cleaned, held back lists are skipped instead of waited for:
+		// finished lists on other queues still have to free their memory for them.
+		MemoryManager* memoryManager = m_memoryManager;
+		uint64_t residentValue = m_fence->Fetch();
+		size_t numCleaned = 0;
 		for (auto& task : workingSet) {
-			task->syncPoint.m_fence->Wait(task->syncPoint.m_value);
-			for (const MemoryObject& res : task->resources) {
-				// TODO...
+			if (residentValue >= task->residentValue && task->syncPoint.m_fence->Fetch() >= task->syncPoint.m_value) {
+				if (memoryManager) {
+					memoryManager->UnlockResident(task->resources);
+				}
+				task.reset();
+				++numCleaned;
 			}
 		}
+		workingSet.erase(std::remove(workingSet.begin(), workingSet.end(), nullptr), workingSet.end());
 
-		workingSet.clear();
+		if (numCleaned > 0) {
+			{
+				std::lock_guard<std::mutex> lkg(m_retryMutex);
+				++m_numUnlocks;
+			}
+			m_retryCv.notify_all();
+		}
+		else if (!workingSet.empty()) {
+			// the timeout lets newly enqueued and held back lists be looked at
+			const Task& front = *workingSet.front();
+			if (residentValue < front.residentValue) {
+				m_fence->Wait(front.residentValue, RetryInterval.count());
+			}
+			else {
+				front.syncPoint.m_fence->Wait(front.syncPoint.m_value, RetryInterval.count());
+			}
+		}
 	}
 }
 
@@ -3,10 +3,14 @@
 #include <mutex>
 #include <queue>
 #include <functional>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
 
 #include "SyncPoint.hpp"
 #include "CriticalBufferHeap.hpp"
 #include "CommandAllocatorPool.hpp"
+#include "MemoryManager.hpp"
 #include <atomic>
 
 
@@ -14,6 +18,12 @@ namespace inl {
 namespace gxeng {
 
 /// <summary> Manages initializing and cleanup of command lists. </summary>
+/// <remarks>
+/// A command list's sync point is only signaled once its resources are locked resident. If they can't be locked,
+/// the list is held back and retried whenever a finished list frees memory, so the GPU never executes it with
+/// evicted resources. The clean thread unlocks the resources of a list only after they have been locked and the
+/// list has finished. Both are checked, as not every device holds back a list until its sync point is signaled.
+/// </remarks>
 class ResourceResidencyQueue {
 	struct Task {
 		Task() = default;
@@ -22,19 +32,30 @@ class ResourceResidencyQueue {
 		virtual ~Task() {};
 		std::vector<MemoryObject> resources;
 		SyncPoint syncPoint;
+		uint64_t residentValue = 0; // clean tasks wait for the lists enqueued for init before them
 	};
 public:
 	ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fence);
 	~ResourceResidencyQueue();
 
+	/// <summary> Resources of enqueued command lists are locked resident through the memory manager, unless it's null. </summary>
+	/// <exception cref="std::logic_error"> If command lists have already been enqueued, as their resources would
+	///		be unlocked by a different manager than the one that locked them. </exception>
+	void SetMemoryManager(MemoryManager* memoryManager);
 
-	/// <summary> The failure handler will be called if resources cannot be made resident, no matter how hard it tries. </summary>
+
+	/// <summary> The failure handler will be called if resources cannot be made resident, no matter how hard it tries.
+	///		The command list stays held back, and is retried until its resources fit or the queue is destroyed. </summary>
 	/// <remarks> Note that the handler may be called from any thread. Be safe kids, use protection. </summary>
 	void SetFailureHandler(std::function<void()> handler);
 
 	/// <summary> I have no idea what you can do with an std::function, but here you go! </summary>
-	/// <returns> The currently used failure handler. </returns>
-	const std::function<void()>& GetFailureHandler() const;
+	/// <returns> A copy of the currently used failure handler. </returns>
+	std::function<void()> GetFailureHandler() const;
+
+	/// <summary> A held back command list is retried at least this often, even if no other list frees memory.
+	///		The failure handler is called if no list has freed memory during the interval. </summary>
+	static constexpr std::chrono::milliseconds RetryInterval{ 100 };
 
 
 	/// <summary> Enqueue a list of resources which should be made usable by the GPU by the time the
@@ -50,13 +71,20 @@ public:
 	/// <param name="cleanObjects"> Object that should live until 'waitFor' is signaled. The destructor of given objects
 	///								will be called afterwards. </param>
 	/// <remarks> The cleanObjects list could be used to free up command lists and command allocators associated 
-	///			  with the resources. </remarks>
+	///			  with the resources. <para/>
+	///			  The resources are also only marked evictable after the lists enqueued for init before them are
+	///			  resident, so enqueue the clean of a list after its init. </remarks>
 	template <class... CleanObjectT>
 	void EnqueueClean(SyncPoint waitFor, std::vector<MemoryObject> resources, CleanObjectT&&... cleanObjects);
 
 private:
 	void InitThreadFunc();
 	void CleanThreadFunc();
+
+	/// <summary> Locks the resources of a single task, retrying after other lists free memory. </summary>
+	/// <returns> False if the threads are stopped before the resources could be locked. </returns>
+	bool LockWithRetry(MemoryManager& memoryManager, const Task& task);
+	void CallFailureHandler();
 	
 private:
 	// Init
@@ -75,12 +103,17 @@ private:
 	std::atomic_bool m_runThreads;
 
 	// Failure avoidance and handling
+	std::mutex m_retryMutex;
 	std::condition_variable m_retryCv;
+	uint64_t m_numUnlocks; // guarded by m_retryMutex
+	mutable std::mutex m_failureHandlerMutex;
 	std::function<void()> m_failureHandler;
 
 	// Event tracking
 	std::shared_ptr<gxapi::IFence> m_fence;
 	uint64_t m_fenceValue;
+
+	std::atomic<MemoryManager*> m_memoryManager;
 };
 
 
@@ -93,8 +126,14 @@ inline void ResourceResidencyQueue::EnqueueClean(SyncPoint waitFor, std::vector<
 		std::tuple<CleanObjectT...> data;
  	};
 
+	auto task = std::make_unique<SpecialTask>(std::move(resources), std::move(waitFor), std::forward<CleanObjectT>(cleanObjects)...);
+	{
+		std::lock_guard<std::mutex> lkg(m_initMutex);
+		task->residentValue = m_fenceValue;
+	}
+
 	std::lock_guard<std::mutex> lkg(m_cleanMutex);
-	m_cleanQueue.push(std::make_unique<SpecialTask>(std::move(resources), std::move(waitFor), std::forward<CleanObjectT>(cleanObjects)...));
+	m_cleanQueue.push(std::move(task));
 	m_cleanCv.notify_one();
 }
 
@@ -0,0 +1,166 @@
+#include "ResourceStateTable.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace inl {
+namespace gxeng {
+
+
+void ResourceStateTable::SetState(const MemoryObject& resource, gxapi::eResourceState state, unsigned subresource, std::vector<gxapi::ResourceBarrier>& barriers) {
+	gxapi::IResource* key = resource._GetResourcePtr();
+	uint32_t index = FindRecord(key);
+	if (index == Empty) {
+		index = InsertRecord(resource);
+	}
+	Record& record = m_records[index];
+
+	// a single subresource is the whole resource
+	if (record.numSubresources == 1) {
+		subresource = gxapi::ALL_SUBRESOURCES;
+	}
+
+	if (subresource == gxapi::ALL_SUBRESOURCES) {
+		if (record.firstSubresource == Empty) {
+			Transition(key, record.usage, state, gxapi::ALL_SUBRESOURCES, barriers);
+		}
+		else {
+			for (unsigned s = 0; s < record.numSubresources; ++s) {
+				Transition(key, m_subresources[record.firstSubresource + s], state, s, barriers);
+			}
+		}
+	}
+	else {
+		assert(subresource < record.numSubresources);
+		if (record.firstSubresource == Empty) {
+			Expand(record);
+		}
+		Transition(key, m_subresources[record.firstSubresource + subresource], state, subresource, barriers);
+	}
+}
+
+
+const SubresourceUsageInfo* ResourceStateTable::Find(const MemoryObject& resource, unsigned subresource) const {
+	uint32_t index = FindRecord(resource._GetResourcePtr());
+	if (index == Empty) {
+		return nullptr;
+	}
+	const Record& record = m_records[index];
+
+	const SubresourceUsageInfo* usage;
+	if (record.firstSubresource == Empty) {
+		usage = &record.usage;
+	}
+	else if (subresource == gxapi::ALL_SUBRESOURCES) {
+		return nullptr;
+	}
+	else {
+		assert(subresource < record.numSubresources);
+		usage = &m_subresources[record.firstSubresource + subresource];
+	}
+	return usage->used ? usage : nullptr;
+}
+
+
+void ResourceStateTable::Decompose(std::vector<ResourceUsage>& usages) {
+	for (Record& record : m_records) {
+		if (record.firstSubresource == Empty) {
+			const SubresourceUsageInfo& usage = record.usage;
+			usages.push_back(ResourceUsage{ std::move(record.resource), gxapi::ALL_SUBRESOURCES, usage.firstState, usage.lastState, usage.multipleStates });
+		}
+		else {
+			for (unsigned s = 0; s < record.numSubresources; ++s) {
+				const SubresourceUsageInfo& usage = m_subresources[record.firstSubresource + s];
+				if (usage.used) {
+					usages.push_back(ResourceUsage{ record.resource, s, usage.firstState, usage.lastState, usage.multipleStates });
+				}
+			}
+		}
+	}
+	Clear();
+}
+
+
+void ResourceStateTable::Clear() {
+	m_records.clear();
+	m_subresources.clear();
+	std::fill(m_table.begin(), m_table.end(), Empty);
+}
+
+
+uint32_t ResourceStateTable::FindRecord(gxapi::IResource* key) const {
+	if (m_table.empty()) {
+		return Empty;
+	}
+	size_t mask = m_table.size() - 1;
+	for (size_t slot = Hash(key) & mask; ; slot = (slot + 1) & mask) {
+		uint32_t index = m_table[slot];
+		if (index == Empty || m_records[index].resource._GetResourcePtr() == key) {
+			return index;
+		}
+	}
+}
+
+
+uint32_t ResourceStateTable::InsertRecord(const MemoryObject& resource) {
+	// keep the load factor below one half
+	if (2 * (m_records.size() + 1) > m_table.size()) {
+		Rehash(std::max<size_t>(64, 2 * m_table.size()));
+	}
+
+	uint32_t index = (uint32_t)m_records.size();
+	SubresourceUsageInfo unused{ gxapi::eResourceState::COMMON, gxapi::eResourceState::COMMON, false, false };
+	m_records.push_back(Record{ resource, unused, Empty, std::max(1u, resource.GetNumSubresources()) });
+
+	size_t mask = m_table.size() - 1;
+	size_t slot = Hash(resource._GetResourcePtr()) & mask;
+	while (m_table[slot] != Empty) {
+		slot = (slot + 1) & mask;
+	}
+	m_table[slot] = index;
+
+	return index;
+}
+
+
+void ResourceStateTable::Rehash(size_t capacity) {
+	m_table.assign(capacity, Empty);
+	size_t mask = capacity - 1;
+	for (uint32_t index = 0; index < (uint32_t)m_records.size(); ++index) {
+		size_t slot = Hash(m_records[index].resource._GetResourcePtr()) & mask;
+		while (m_table[slot] != Empty) {
+			slot = (slot + 1) & mask;
+		}
+		m_table[slot] = index;
+	}
+}
+
+
+void ResourceStateTable::Expand(Record& record) {
+	record.firstSubresource = (uint32_t)m_subresources.size();
+	m_subresources.resize(m_subresources.size() + record.numSubresources, record.usage);
+}
+
+
+void ResourceStateTable::Transition(gxapi::IResource* resource, SubresourceUsageInfo& usage, gxapi::eResourceState state, unsigned subresource, std::vector<gxapi::ResourceBarrier>& barriers) {
+	if (!usage.used) {
+		usage = SubresourceUsageInfo{ state, state, false, true };
+	}
+	else if (usage.lastState != state) {
+		barriers.push_back(gxapi::TransitionBarrier{ resource, usage.lastState, state, subresource });
+		usage.lastState = state;
+		usage.multipleStates = true;
+	}
+}
+
+
+size_t ResourceStateTable::Hash(gxapi::IResource* key) {
+	// objects are aligned, the low bits carry no information
+	uint64_t value = (uint64_t)(uintptr_t)key >> 4;
+	return (size_t)(value * 0x9E3779B97F4A7C15ull >> 16);
+}
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../GraphicsApi_LL/Common.hpp"
+
+#include "MemoryObject.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace inl {
+namespace gxeng {
+
+
+struct SubresourceUsageInfo {
+	gxapi::eResourceState firstState; /// <summary> Holds the target state of the first transition. </summary>
+	gxapi::eResourceState lastState; /// <summary> Holds the target state of the last transition. </summary>
+	bool multipleStates; /// <sumamry> True if resource was used in more than one state. </summary>
+	bool used; /// <summary> False for subresources the command list has not touched. </summary>
+};
+
+struct ResourceUsage {
+	MemoryObject resource;
+	unsigned subresource; /// <summary> ALL_SUBRESOURCES if the whole resource was used the same way. </summary>
+	gxapi::eResourceState firstState;
+	gxapi::eResourceState lastState;
+	bool multipleStates;
+};
+
+
+/// <summary>
+/// Tracks the states a command list puts its resources into.
+/// A resource used only as a whole has a single entry, it is expanded to per-subresource entries
+/// when a subresource is used on its own.
+/// Resources are looked up in an open addressing hash table, the entries are kept in flat arrays,
+/// so a cleared table is reused without allocations.
+/// </summary>
+class ResourceStateTable {
+public:
+	/// <summary>
+	/// Records the new state of the (sub)resource.
+	/// If the state changes within the command list, the required barriers are appended to <paramref name="barriers"/>.
+	/// The first state of each subresource is not transitioned to, that's done by the scheduler.
+	/// </summary>
+	void SetState(const MemoryObject& resource, gxapi::eResourceState state, unsigned subresource, std::vector<gxapi::ResourceBarrier>& barriers);
+
+	/// <returns> The usage of the subresource, or null if it's not used.
+	///		For ALL_SUBRESOURCES, null is also returned if the subresources are tracked individually. </returns>
+	const SubresourceUsageInfo* Find(const MemoryObject& resource, unsigned subresource) const;
+
+	/// <summary> Moves the usages into the list and clears the table. </summary>
+	void Decompose(std::vector<ResourceUsage>& usages);
+
+	void Clear();
+	/// <summary> Number of tracked resources. </summary>
+	size_t GetResourceCount() const { return m_records.size(); }
+
+private:
+	static constexpr uint32_t Empty = ~uint32_t(0);
+
+	struct Record {
+		MemoryObject resource;
+		SubresourceUsageInfo usage; // used while the resource is not expanded
+		uint32_t firstSubresource; // into m_subresources, Empty if not expanded
+		uint32_t numSubresources;
+	};
+
+	uint32_t FindRecord(gxapi::IResource* key) const;
+	uint32_t InsertRecord(const MemoryObject& resource);
+	void Rehash(size_t capacity);
+	void Expand(Record& record);
+	static void Transition(gxapi::IResource* resource, SubresourceUsageInfo& usage, gxapi::eResourceState state, unsigned subresource, std::vector<gxapi::ResourceBarrier>& barriers);
+	static size_t Hash(gxapi::IResource* key);
+
+private:
+	std::vector<Record> m_records;
+	std::vector<SubresourceUsageInfo> m_subresources;
+	std::vector<uint32_t> m_table; // indices into m_records, linear probing, power of two size
+};
+
+
+} // namespace gxeng
+} // namespace inl
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "HostDescHeap.hpp"
+#include "BindlessHeap.hpp"
 #include "MemoryObject.hpp"
 
 #include <GraphicsApi_LL/Common.hpp>
@@ -25,10 +26,15 @@ class ResourceViewBase {
 		IHostDescHeap* heap;
 		size_t place;
 		gxapi::DescriptorHandle handle;
+		IHostDescHeap* bindlessHeap = nullptr;
+		size_t bindlessPlace = -1;
 		SharedState() : resource{}, heap(nullptr), place(-1) {}
 		SharedState(ResourceT resource, IHostDescHeap* heap, size_t place) : resource(std::move(resource)), heap(heap), place(place) {}
 		SharedState(ResourceT resource, gxapi::DescriptorHandle handle) : resource(std::move(resource)), handle(handle), heap(nullptr), place(-1) {}
 		~SharedState() {
+			if (bindlessHeap != nullptr) {
+				bindlessHeap->Deallocate(bindlessPlace);
+			}
 			if (heap != nullptr) {
 				heap->Deallocate(place);
 			}
@@ -50,6 +56,21 @@ public:
 		return m_state->handle;
 	}
 
+	/// <summary> Copies the descriptor to the bindless heap, shaders can then reach the view by its bindless index.
+	///		The view is registered once, copies of the view share the index. </summary>
+	void RegisterBindless(BindlessHeap& heap) {
+		assert(operator bool());
+		if (m_state->bindlessHeap == nullptr) {
+			m_state->bindlessPlace = heap.Register(m_state->handle);
+			m_state->bindlessHeap = &heap;
+		}
+	}
+	/// <summary> Index of the view in the bindless heap, or <see cref="BindlessHeap::InvalidIndex"/> if not registered. </summary>
+	uint32_t GetBindlessIndex() const {
+		assert(operator bool());
+		return m_state->bindlessHeap != nullptr ? (uint32_t)m_state->bindlessPlace : BindlessHeap::InvalidIndex;
+	}
+
 	explicit operator bool() const {
 		return (bool)m_state;
 	}
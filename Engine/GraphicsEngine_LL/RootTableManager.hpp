@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <utility>
 #include <cassert>
 #include <type_traits>
@@ -56,13 +57,17 @@ private:
 	/// <summary> Marks all root tables committed. Call this after each drawcall. </summary>
 	void CommitRootTables();
 
-	/// <summary> Copies ALL scratch space tables to a fresh range. Used after a new scratch space is bound. </summary>
+	/// <summary> Copies ALL scratch space tables to a fresh range and sets all tables again. Used after a new scratch space is bound. </summary>
 	void RenewRootTables();
 
-	void SetRootDescriptorTable(gxapi::IGraphicsCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
-	void SetRootDescriptorTable(gxapi::IComputeCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
 	void SetRootSignature(gxapi::IGraphicsCommandList* list, gxapi::IRootSignature* sig);
 	void SetRootSignature(gxapi::IComputeCommandList* list, gxapi::IRootSignature* sig);
+protected:
+	/// <summary> Points an unbounded table to the start of the shader visible heap, it's set again when the heap changes. </summary>
+	void SetUnboundedTable(int rootSignatureSlot);
+
+	void SetRootDescriptorTable(gxapi::IGraphicsCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
+	void SetRootDescriptorTable(gxapi::IComputeCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
 protected:
 	gxapi::IGraphicsApi* m_graphicsApi;
 	CommandListT* m_commandList;
@@ -70,6 +75,7 @@ protected:
 	StackDescHeap* m_heap;
 private:
 	std::vector<DescriptorTableState> m_rootTableStates;
+	std::vector<int> m_unboundedTableSlots; // unbounded tables that have been set
 };
 
 
@@ -180,6 +186,7 @@ auto RootTableManager<Type>::FindRootTable(int rootSignatureSlot) -> DescriptorT
 template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::InitRootTables() {
 	m_rootTableStates.clear();
+	m_unboundedTableSlots.clear();
 	const gxapi::RootSignatureDesc& desc = m_binder->GetRootSignatureDesc();
 
 	for (size_t slot = 0; slot < desc.rootParameters.size(); slot++) {
@@ -197,6 +204,14 @@ void RootTableManager<Type>::InitRootTables() {
 				throw std::runtime_error("Dynamic Samplers are not supported yet.");
 			}
 
+			// unbounded tables point into the bindless heap, they are not managed on the scratch space
+			bool isUnbounded = std::any_of(ranges.begin(), ranges.end(), [](const gxapi::DescriptorRange& range) {
+				return range.numDescriptors == gxapi::DescriptorRange::UNBOUNDED;
+			});
+			if (isUnbounded) {
+				continue;
+			}
+
 			// check if ranges are contiguous and not unbounded
 			size_t descriptorCountTotal = 0;
 			size_t appendIndex = 0;
@@ -232,8 +247,21 @@ void RootTableManager<Type>::CommitRootTables() {
 
 template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::RenewRootTables() {
+	// tables of the previous heap are invalid once a new heap is set on the command list
 	for (auto& table : m_rootTableStates) {
 		DuplicateRootTable(table);
+		SetRootDescriptorTable(m_commandList, table.slot, table.reference.Get(0));
+	}
+	for (int slot : m_unboundedTableSlots) {
+		SetRootDescriptorTable(m_commandList, slot, m_heap->GetHeap()->At(0));
+	}
+}
+
+template <gxapi::eCommandListType Type>
+void RootTableManager<Type>::SetUnboundedTable(int rootSignatureSlot) {
+	SetRootDescriptorTable(m_commandList, rootSignatureSlot, m_heap->GetHeap()->At(0));
+	if (std::find(m_unboundedTableSlots.begin(), m_unboundedTableSlots.end(), rootSignatureSlot) == m_unboundedTableSlots.end()) {
+		m_unboundedTableSlots.push_back(rootSignatureSlot);
 	}
 }
 
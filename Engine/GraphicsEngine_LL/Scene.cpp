@@ -44,6 +44,34 @@ const EntityCollection<DirectionalLight>& Scene::GetDirectionalLights() const {
 	return m_directionalLights;
 }
 
+EntityCollection<PointLight>& Scene::GetPointLights() {
+	return m_pointLights;
+}
+const EntityCollection<PointLight>& Scene::GetPointLights() const {
+	return m_pointLights;
+}
+
+EntityCollection<SpotLight>& Scene::GetSpotLights() {
+	return m_spotLights;
+}
+const EntityCollection<SpotLight>& Scene::GetSpotLights() const {
+	return m_spotLights;
+}
+
+EntityCollection<FoliageEntity>& Scene::GetFoliageEntities() {
+	return m_foliageEntities;
+}
+const EntityCollection<FoliageEntity>& Scene::GetFoliageEntities() const {
+	return m_foliageEntities;
+}
+
+EntityCollection<TerrainEntity>& Scene::GetTerrainEntities() {
+	return m_terrainEntities;
+}
+const EntityCollection<TerrainEntity>& Scene::GetTerrainEntities() const {
+	return m_terrainEntities;
+}
+
 
 } // namespace gxeng
 } // namespace inl
@@ -13,6 +13,11 @@ class MeshEntity;
 class OverlayEntity;
 
 class DirectionalLight;
+class PointLight;
+class SpotLight;
+
+class FoliageEntity;
+class TerrainEntity;
 
 
 class Scene {
@@ -35,10 +40,26 @@ public:
 	EntityCollection<DirectionalLight>& GetDirectionalLights();
 	const EntityCollection<DirectionalLight>& GetDirectionalLights() const;
 
+	EntityCollection<PointLight>& GetPointLights();
+	const EntityCollection<PointLight>& GetPointLights() const;
+
+	EntityCollection<SpotLight>& GetSpotLights();
+	const EntityCollection<SpotLight>& GetSpotLights() const;
+
+	EntityCollection<FoliageEntity>& GetFoliageEntities();
+	const EntityCollection<FoliageEntity>& GetFoliageEntities() const;
+
+	EntityCollection<TerrainEntity>& GetTerrainEntities();
+	const EntityCollection<TerrainEntity>& GetTerrainEntities() const;
+
 private:
 	EntityCollection<MeshEntity> m_meshEntities;	
 	EntityCollection<OverlayEntity> m_overlayEntities;
 	EntityCollection<DirectionalLight> m_directionalLights;
+	EntityCollection<PointLight> m_pointLights;
+	EntityCollection<SpotLight> m_spotLights;
+	EntityCollection<FoliageEntity> m_foliageEntities;
+	EntityCollection<TerrainEntity> m_terrainEntities;
 
 	std::string m_name;
 };
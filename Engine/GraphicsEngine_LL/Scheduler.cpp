@@ -5,6 +5,7 @@
 #include "GraphicsCommandList.hpp"
 
 #include <cassert>
+#include <typeinfo>
 #include <iostream> // only for debugging
 
 namespace inl {
@@ -16,55 +17,111 @@ Scheduler::Scheduler()
 
 void Scheduler::SetPipeline(Pipeline&& pipeline) {
 	m_pipeline = std::move(pipeline);
+	m_taskNames.clear();
+	m_commandListCache.Clear();
 }
 
 const Pipeline& Scheduler::GetPipeline() const {
 	return m_pipeline;
 }
 
+Pipeline& Scheduler::GetPipeline() {
+	return m_pipeline;
+}
+
 Pipeline Scheduler::ReleasePipeline() {
+	m_taskNames.clear();
+	m_commandListCache.Clear();
 	return std::move(m_pipeline);
 }
 
 void Scheduler::Execute(FrameContext context) {
 	const auto& taskGraph = m_pipeline.GetTaskGraph();
 	const auto& taskFunctionMap = m_pipeline.GetTaskFunctionMap();
+	const auto& taskActiveMap = m_pipeline.GetTaskActiveMap();
 
-	auto tasks = MakeSchedule(taskGraph, taskFunctionMap);
+	auto tasks = MakeSchedule(taskGraph, taskFunctionMap, taskActiveMap);
+
+	// Recordings bound to a replaced bindless heap keep it alive, they are recorded again with the current one.
+	if (context.bindlessHeap != nullptr) {
+		const gxapi::IDescriptorHeap* bindlessHeap = context.bindlessHeap->GetHeap();
+		if (bindlessHeap != m_bindlessHeap) {
+			m_commandListCache.InvalidateDescriptorHeaps(bindlessHeap);
+			m_bindlessHeap = bindlessHeap;
+		}
+	}
 
 	// Inject copy task to the start.
 	UploadTask uploadTask(context.uploadRequests);
 	tasks.insert(tasks.begin(), &uploadTask);
 
+	// Without a profiler the scopes below measure nothing.
+	PipelineProfiler* profiler = context.profiler;
+	bool gpuTiming = profiler != nullptr && profiler->IsGpuTimingEnabled();
+	m_taskNameBuffer.assign(tasks.size(), 0);
+	if (profiler) {
+		GetTaskNames(tasks, *profiler, m_taskNameBuffer);
+	}
+
 	// Setup and execute the tasks.
 	try {
 		// PHASE I.: Setup() tasks in correct order
-		for (auto& task : tasks) {
+		for (size_t taskIdx = 0; taskIdx < tasks.size(); ++taskIdx) {
+			GraphicsTask* task = tasks[taskIdx];
 			if (task != nullptr) {
-				SetupContext setupContext(context.memoryManager, context.textureSpace, context.rtvHeap, context.dsvHeap, context.shaderManager, context.gxApi);
+				ProfileScope setupScope(profiler, m_taskNameBuffer[taskIdx], eProfileCategory::SETUP);
+				SetupContext setupContext(context.memoryManager, context.textureSpace, context.rtvHeap, context.dsvHeap, context.shaderManager, context.gxApi, context.bindlessHeap);
 				task->Setup(setupContext);
 			}
 		}
 
 		// PHASE II.: Execute() tasks in correct
-		for (auto& task : tasks) {
+		for (size_t taskIdx = 0; taskIdx < tasks.size(); ++taskIdx) {
+			GraphicsTask* task = tasks[taskIdx];
+			uint32_t taskName = m_taskNameBuffer[taskIdx];
 			VolatileViewHeap volatileHeap(context.gxApi);
-			RenderContext renderContext(context.memoryManager, context.textureSpace, &volatileHeap, context.shaderManager, context.gxApi, context.commandAllocatorPool, context.scratchSpacePool);
+			RenderContext renderContext(context.memoryManager, context.textureSpace, &volatileHeap, context.shaderManager, context.gxApi, context.commandAllocatorPool, context.scratchSpacePool, context.bindlessHeap);
+
+			if (task == nullptr) {
+				continue;
+			}
+
+			// Submit the recording of the last frame again if the task allows it.
+			m_recordingKeys.clear();
+			bool reusable = task->GetRecordingKeys(m_recordingKeys);
+			if (reusable) {
+				if (CommandListCache::Recording* recording = m_commandListCache.Find(task, m_recordingKeys)) {
+					int gpuEvent;
+					{
+						ProfileScope barrierScope(profiler, taskName, eProfileCategory::BARRIERS);
+						gpuEvent = EnqueueTransitions(recording->usedResources, taskName, context);
+					}
+					ProfileScope submitScope(profiler, taskName, eProfileCategory::SUBMIT);
+					EnqueueRecording(*recording, gpuEvent, context);
+					continue;
+				}
+			}
 
 			// Execute the task on the CPU.
-			if (task != nullptr) {
+			{
+				ProfileScope executeScope(profiler, taskName, eProfileCategory::EXECUTE);
 				task->Execute(renderContext);
+			}
 
-				// Enqueue all command lists on the GPU.
-				if (renderContext.IsListInitialized()) {
-					BasicCommandList* commandList;
-					switch (renderContext.GetType()) {
-						case gxapi::eCommandListType::GRAPHICS: commandList = &renderContext.AsGraphics(); break;
-						case gxapi::eCommandListType::COMPUTE: commandList = &renderContext.AsCompute(); break;
-						case gxapi::eCommandListType::COPY: commandList = &renderContext.AsCopy(); break;
-						default: assert(false);
-					}
-					BasicCommandList::Decomposition decomposition = commandList->Decompose();
+			// Enqueue all command lists on the GPU.
+			if (renderContext.IsListInitialized()) {
+				BasicCommandList* commandList;
+				switch (renderContext.GetType()) {
+					case gxapi::eCommandListType::GRAPHICS: commandList = &renderContext.AsGraphics(); break;
+					case gxapi::eCommandListType::COMPUTE: commandList = &renderContext.AsCompute(); break;
+					case gxapi::eCommandListType::COPY: commandList = &renderContext.AsCopy(); break;
+					default: assert(false);
+				}
+				BasicCommandList::Decomposition decomposition = commandList->Decompose();
+				int gpuEvent;
+
+				{
+					ProfileScope barrierScope(profiler, taskName, eProfileCategory::BARRIERS);
 
 					std::sort(decomposition.usedResources.begin(), decomposition.usedResources.end(), [](const ResourceUsage& lhs, const ResourceUsage& rhs) {
 						auto lhsPtr = lhs.resource._GetResourcePtr();
@@ -72,50 +129,53 @@ void Scheduler::Execute(FrameContext context) {
 						return lhsPtr < rhsPtr || (lhs.resource._GetResourcePtr() == rhs.resource._GetResourcePtr() && lhs.subresource < rhs.subresource);
 					});
 
-					// Inject a transition barrier command list.
-					auto barriers = InjectBarriers(decomposition.usedResources.begin(), decomposition.usedResources.end());
-					if (barriers.size() > 0) {
-						CmdAllocPtr injectAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
-						std::unique_ptr<gxapi::ICopyCommandList> injectList(context.gxApi->CreateGraphicsCommandList({ injectAlloc.get() }));
-
-						injectList->ResourceBarrier((unsigned)barriers.size(), barriers.data());
-						injectList->Close();
-
-						EnqueueCommandList(*context.commandQueue,
-										   std::move(injectList),
-										   std::move(injectAlloc),
-										   {},
-										   {},
-										   {},
-										   context);
-					}
+					gpuEvent = EnqueueTransitions(decomposition.usedResources, taskName, context);
+				}
 
-					// Update resource states.
-					UpdateResourceStates(decomposition.usedResources.begin(), decomposition.usedResources.end());
+				// Enqueue actual command list.
+				ProfileScope submitScope(profiler, taskName, eProfileCategory::SUBMIT);
 
-					// Enqueue actual command list.
-					std::vector<MemoryObject> usedResourceList;
-					usedResourceList.reserve(decomposition.usedResources.size());
-					for (auto& v : decomposition.usedResources) {
-						usedResourceList.push_back(std::move(v.resource));
+				std::vector<MemoryObject> usedResourceList;
+				usedResourceList.reserve(decomposition.usedResources.size() + decomposition.additionalResources.size());
+				for (auto& v : decomposition.usedResources) {
+					if (reusable) {
+						usedResourceList.push_back(v.resource); // the recording keeps its usages
 					}
-					for (auto& v : decomposition.additionalResources) {
-						usedResourceList.push_back(std::move(v));
+					else {
+						usedResourceList.push_back(std::move(v.resource));
 					}
+				}
+				for (auto& v : decomposition.additionalResources) {
+					usedResourceList.push_back(std::move(v));
+				}
 
+				// Volatile memory is reused by later frames, so such recordings can't be kept.
+				if (reusable && !renderContext.UsedVolatileMemory()) {
 					decomposition.commandList->Close();
 
-					EnqueueCommandList(*context.commandQueue,
-									   std::move(decomposition.commandList),
-									   std::move(decomposition.commandAllocator),
-									   std::move(decomposition.scratchSpaces),
-									   std::move(usedResourceList),
-									   std::unique_ptr<VolatileViewHeap>(new VolatileViewHeap(std::move(volatileHeap))),
-									   context);
-
-
+					CommandListCache::Recording recording;
+					recording.commandList = std::move(decomposition.commandList);
+					recording.commandAllocator = std::move(decomposition.commandAllocator);
+					recording.scratchSpaces = std::move(decomposition.scratchSpaces);
+					recording.volatileHeap.reset(new VolatileViewHeap(std::move(volatileHeap)));
+					recording.usedResources = std::move(decomposition.usedResources);
+					recording.residentResources = std::move(usedResourceList);
+					EnqueueRecording(m_commandListCache.Store(task, m_recordingKeys, std::move(recording)), gpuEvent, context);
+					continue;
+				}
 
+				if (gpuTiming) {
+					profiler->EndGpuEvent(gpuEvent, decomposition.commandList.get());
 				}
+				decomposition.commandList->Close();
+
+				EnqueueCommandList(*context.commandQueue,
+								   std::move(decomposition.commandList),
+								   std::move(decomposition.commandAllocator),
+								   std::move(decomposition.scratchSpaces),
+								   std::move(usedResourceList),
+								   std::unique_ptr<VolatileViewHeap>(new VolatileViewHeap(std::move(volatileHeap))),
+								   context);
 			}
 		}
 
@@ -127,6 +187,10 @@ void Scheduler::Execute(FrameContext context) {
 			context.backBuffer->GetResource()._GetResourcePtr(),
 			context.backBuffer->GetResource().ReadState(0),
 			gxapi::eResourceState::PRESENT });
+		if (gpuTiming) {
+			// Timestamps of the whole frame are copied out after its last command list.
+			profiler->ResolveGpuEvents(injectList.get());
+		}
 		injectList->Close();
 		context.backBuffer->GetResource().RecordState(gxapi::eResourceState::PRESENT);
 
@@ -157,6 +221,7 @@ void Scheduler::Execute(FrameContext context) {
 
 
 void Scheduler::ReleaseResources() {
+	m_commandListCache.Clear();
 	for (exc::NodeBase& node : m_pipeline) {
 		if (GraphicsNode* ptr = dynamic_cast<GraphicsNode*>(&node)) {
 			ptr->Reset();
@@ -165,17 +230,14 @@ void Scheduler::ReleaseResources() {
 }
 
 
-void Scheduler::MakeResident(std::vector<MemoryObject*> usedResources) {
-
+const CommandListCache& Scheduler::GetCommandListCache() const {
+	return m_commandListCache;
 }
 
 
-void Scheduler::Evict(std::vector<MemoryObject*> usedResources) {
-
-}
-
 std::vector<GraphicsTask*> Scheduler::MakeSchedule(const lemon::ListDigraph& taskGraph,
-													const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap
+													const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap,
+													const lemon::ListDigraph::NodeMap<bool>& taskActiveMap
 /*std::vector<CommandQueue*> queues*/)
 {
 	// Topologically sort the tasks.
@@ -193,11 +255,13 @@ std::vector<GraphicsTask*> Scheduler::MakeSchedule(const lemon::ListDigraph& tas
 		return taskOrderMap[n1] < taskOrderMap[n2];
 	});
 
-	// Make a list of them.
+	// Make a list of them, leaving out the tasks of disabled branches.
 	std::vector<GraphicsTask*> tasks;
 	for (auto node : taskNodes) {
-		auto& task = taskFunctionMap[node];
-		tasks.push_back(task);
+		if (taskActiveMap[node]) {
+			auto& task = taskFunctionMap[node];
+			tasks.push_back(task);
+		}
 	}
 
 	return tasks;
@@ -223,8 +287,113 @@ void Scheduler::EnqueueCommandList(CommandQueue& commandQueue,
 	context.commandQueue->ExecuteCommandLists(1, execLists);
 	SyncPoint completionPoint = context.commandQueue->Signal();
 
+	// The allocator is reused by the pool once the command list finished.
+	context.commandAllocatorPool->RecycleAllocator(std::move(commandAllocator), completionPoint);
+
 	// Enqueue CPU task to clean up resources after command list finished.
-	context.residencyQueue->EnqueueClean(completionPoint, std::move(usedResources), std::move(commandAllocator), std::move(scratchSpaces), std::move(volatileHeap));
+	context.residencyQueue->EnqueueClean(completionPoint, std::move(usedResources), std::move(scratchSpaces), std::move(volatileHeap));
+}
+
+
+int Scheduler::EnqueueTransitions(std::vector<ResourceUsage>& usedResources, uint32_t taskName, const FrameContext& context) {
+	PipelineProfiler* profiler = context.profiler;
+	bool gpuTiming = profiler != nullptr && profiler->IsGpuTimingEnabled();
+	int gpuEvent = -1;
+
+	// Inject a transition barrier command list.
+	// With GPU timing it is also needed for the starting timestamp, which goes after the barriers.
+	m_barriers.clear();
+	InjectBarriers(usedResources.begin(), usedResources.end(), m_barriers);
+	if (m_barriers.size() > 0 || gpuTiming) {
+		CmdAllocPtr injectAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
+		std::unique_ptr<gxapi::ICopyCommandList> injectList(context.gxApi->CreateGraphicsCommandList({ injectAlloc.get() }));
+
+		if (m_barriers.size() > 0) {
+			injectList->ResourceBarrier((unsigned)m_barriers.size(), m_barriers.data());
+		}
+		if (gpuTiming) {
+			gpuEvent = profiler->BeginGpuEvent(taskName, injectList.get());
+		}
+		injectList->Close();
+
+		EnqueueCommandList(*context.commandQueue,
+						   std::move(injectList),
+						   std::move(injectAlloc),
+						   {},
+						   {},
+						   {},
+						   context);
+	}
+
+	// Update resource states.
+	UpdateResourceStates(usedResources.begin(), usedResources.end());
+
+	return gpuEvent;
+}
+
+
+void Scheduler::EnqueueRecording(CommandListCache::Recording& recording, int gpuEvent, const FrameContext& context) {
+	// The recording keeps its resources, every submission locks them resident for itself.
+	SyncPoint residentPoint = context.residencyQueue->EnqueueInit(recording.residentResources);
+
+	gxapi::ICommandList* execLists[] = {
+		recording.commandList.get(),
+	};
+	context.commandQueue->Wait(residentPoint);
+	context.commandQueue->ExecuteCommandLists(1, execLists);
+	SyncPoint completionPoint = context.commandQueue->Signal();
+
+	// The cache releases the recording only after its last submission completed.
+	recording.completion = completionPoint;
+	context.residencyQueue->EnqueueClean(completionPoint, recording.residentResources);
+
+	// The recorded list can't hold the query of this frame, the GPU event is ended by a list of its own.
+	if (gpuEvent >= 0) {
+		CmdAllocPtr endAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
+		std::unique_ptr<gxapi::ICopyCommandList> endList(context.gxApi->CreateGraphicsCommandList({ endAlloc.get() }));
+		context.profiler->EndGpuEvent(gpuEvent, endList.get());
+		endList->Close();
+
+		EnqueueCommandList(*context.commandQueue,
+						   std::move(endList),
+						   std::move(endAlloc),
+						   {},
+						   {},
+						   {},
+						   context);
+	}
+}
+
+
+void Scheduler::GetTaskNames(const std::vector<GraphicsTask*>& tasks, PipelineProfiler& profiler, std::vector<uint32_t>& names) {
+	if (m_taskNames.empty()) {
+		const auto& taskGraph = m_pipeline.GetTaskGraph();
+		const auto& taskFunctionMap = m_pipeline.GetTaskFunctionMap();
+		const auto& taskParentMap = m_pipeline.GetTaskParentMap();
+		const auto& nodeMap = m_pipeline.GetNodeMap();
+
+		for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+			if (taskParentMap[taskNode] == lemon::INVALID) {
+				continue; // helper source or sink without a task
+			}
+			const exc::NodeBase& node = *nodeMap[taskParentMap[taskNode]];
+
+			// Strip the "class " prefix and namespaces of the node's type.
+			std::string name = typeid(node).name();
+			size_t templateStart = std::min(name.find('<'), name.size());
+			size_t nameStart = name.rfind("::", templateStart);
+			nameStart = nameStart != std::string::npos ? nameStart + 2 : name.rfind(' ', templateStart) + 1;
+			name.erase(0, nameStart);
+
+			m_taskNames[taskFunctionMap[taskNode]] = profiler.RegisterName(name);
+		}
+	}
+
+	for (size_t i = 0; i < tasks.size(); ++i) {
+		auto it = m_taskNames.find(tasks[i]);
+		// Only the injected upload task is not part of the pipeline.
+		names[i] = it != m_taskNames.end() ? it->second : profiler.RegisterName("Upload");
+	}
 }
 
 
@@ -314,7 +483,7 @@ void Scheduler::UploadTask::Execute(RenderContext& context) {
 
 		if (destType == UploadManager::DestType::BUFFER) {
 			auto& dstBuffer = static_cast<LinearBuffer&>(destination);
-			commandList.CopyBuffer(dstBuffer, request.dstOffsetX, source, 0, dstBuffer.GetSize());
+			commandList.CopyBuffer(dstBuffer, request.dstOffsetX, source, 0, source.GetSize());
 		}
 		else if (destType == UploadManager::DestType::TEXTURE_2D) {
 			auto& dstTexture = static_cast<Texture2D&>(destination);
@@ -5,12 +5,15 @@
 #include "FrameContext.hpp"
 #include "ScratchSpacePool.hpp"
 #include "MemoryObject.hpp"
+#include "PipelineProfiler.hpp"
+#include "CommandListCache.hpp"
 
 #include <BaseLibrary/optional.hpp>
 #include <GraphicsApi_LL/IFence.hpp>
 #include <GraphicsApi_LL/Common.hpp>
 #include <memory>
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace inl {
@@ -25,9 +28,12 @@ public:
 	// don't let anyone else 'own' the pipeline
 	void SetPipeline(Pipeline&& pipeline);
 	const Pipeline& GetPipeline() const;
+	Pipeline& GetPipeline(); // to toggle nodes
 	Pipeline ReleasePipeline();
 	void Execute(FrameContext context);
 	void ReleaseResources();
+	/// <summary> The recordings of the tasks of the current pipeline. </summary>
+	const CommandListCache& GetCommandListCache() const;
 protected:
 	struct UsedResource {
 		MemoryObject* resource;
@@ -37,12 +43,9 @@ protected:
 	};
 
 
-	static void MakeResident(std::vector<MemoryObject*> usedResources);
-	static void Evict(std::vector<MemoryObject*> usedResources);
-
-
 	static std::vector<GraphicsTask*> MakeSchedule(const lemon::ListDigraph& taskGraph,
-												   const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap
+												   const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap,
+												   const lemon::ListDigraph::NodeMap<bool>& taskActiveMap
 													/*std::vector<CommandQueue*> queues*/);
 
 	static void EnqueueCommandList(CommandQueue& commandQueue,
@@ -53,8 +56,9 @@ protected:
 								   std::unique_ptr<VolatileViewHeap> volatileHeap,
 								   const FrameContext& context);
 
+	/// <summary> Appends the barriers that bring the resources from their recorded states to the states the command list expects. </summary>
 	template <class UsedResourceIter>
-	static std::vector<gxapi::ResourceBarrier> InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource);
+	static void InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource, std::vector<gxapi::ResourceBarrier>& barriers);
 
 	template <class UsedResourceIter1, class UsedResourceIter2>
 	static bool CanExecuteParallel(UsedResourceIter1 first1, UsedResourceIter1 last1, UsedResourceIter2 first2, UsedResourceIter2 last2);
@@ -62,9 +66,26 @@ protected:
 	template <class UsedResourceIter>
 	static void UpdateResourceStates(UsedResourceIter firstResource, UsedResourceIter lastResource);
 
+	/// <summary> Enqueues the barriers the command list needs and the start of the task's GPU event, and records the new resource states. </summary>
+	/// <param name="usedResources"> Sorted by resource. </param>
+	/// <returns> The GPU event to end after the command list, or -1. </returns>
+	int EnqueueTransitions(std::vector<ResourceUsage>& usedResources, uint32_t taskName, const FrameContext& context);
+
+	/// <summary> Enqueues a cached recording, it stays in the cache for later frames. </summary>
+	static void EnqueueRecording(CommandListCache::Recording& recording, int gpuEvent, const FrameContext& context);
+
 	static void RenderFailureScreen(FrameContext context);
+
+	/// <summary> Looks up the profiler names of the tasks, named after the nodes they belong to. </summary>
+	void GetTaskNames(const std::vector<GraphicsTask*>& tasks, PipelineProfiler& profiler, std::vector<uint32_t>& names);
 private:
 	Pipeline m_pipeline;
+	std::vector<gxapi::ResourceBarrier> m_barriers; // reused by every command list to avoid allocations
+	std::unordered_map<const GraphicsTask*, uint32_t> m_taskNames; // filled on the first profiled frame
+	std::vector<uint32_t> m_taskNameBuffer;
+	CommandListCache m_commandListCache; // recordings of tasks that don't have to be executed every frame
+	std::vector<uint64_t> m_recordingKeys;
+	const gxapi::IDescriptorHeap* m_bindlessHeap = nullptr; // the bindless heap when the last frame began
 private:
 	class UploadTask : public GraphicsTask {
 	public:
@@ -79,9 +100,7 @@ private:
 
 
 template <class UsedResourceIter>
-std::vector<gxapi::ResourceBarrier> Scheduler::InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource) {
-	std::vector<gxapi::ResourceBarrier> barriers;
-
+void Scheduler::InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource, std::vector<gxapi::ResourceBarrier>& barriers) {
 	// Collect all necessary barriers.
 	for (UsedResourceIter it = firstResource; it != lastResource; ++it) {
 		MemoryObject& resource = it->resource;
@@ -94,6 +113,13 @@ std::vector<gxapi::ResourceBarrier> Scheduler::InjectBarriers(UsedResourceIter f
 				barriers.push_back(gxapi::TransitionBarrier{ resource._GetResourcePtr(), sourceState, targetState, subresource });
 			}
 		}
+		else if (resource.HasUniformState()) {
+			// A single barrier transitions all subresources when they are in the same state.
+			gxapi::eResourceState sourceState = resource.ReadState(0);
+			if (sourceState != targetState) {
+				barriers.push_back(gxapi::TransitionBarrier{ resource._GetResourcePtr(), sourceState, targetState, gxapi::ALL_SUBRESOURCES });
+			}
+		}
 		else {
 			for (unsigned subresourceIdx = 0; subresourceIdx < resource.GetNumSubresources(); ++subresourceIdx) {
 				gxapi::eResourceState sourceState = resource.ReadState(subresourceIdx);
@@ -103,8 +129,6 @@ std::vector<gxapi::ResourceBarrier> Scheduler::InjectBarriers(UsedResourceIter f
 			}
 		}
 	}
-
-	return barriers;
 }
 
 
@@ -142,9 +166,7 @@ template <class UsedResourceIter>
 void Scheduler::UpdateResourceStates(UsedResourceIter firstResource, UsedResourceIter lastResource) {
 	for (auto it = firstResource; it != lastResource; ++it) {
 		if (it->subresource == gxapi::ALL_SUBRESOURCES) {
-			for (unsigned s = 0; s < it->resource.GetNumSubresources(); ++s) {
-				it->resource.RecordState(s, it->lastState);
-			}
+			it->resource.RecordState(it->lastState);
 		}
 		else {
 			it->resource.RecordState(it->subresource, it->lastState);
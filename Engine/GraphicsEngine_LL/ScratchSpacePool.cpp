@@ -1,13 +1,16 @@
 #include "ScratchSpacePool.hpp"
+#include "BindlessHeap.hpp"
 #include <cassert>
 #include <algorithm>
 
 namespace inl {
 namespace gxeng {
 
-ScratchSpacePool::ScratchSpacePool(gxapi::IGraphicsApi* gxApi, gxapi::eDescriptorHeapType type) 
-	: m_gxApi(gxApi), m_type(type)
-{}
+ScratchSpacePool::ScratchSpacePool(gxapi::IGraphicsApi* gxApi, gxapi::eDescriptorHeapType type, BindlessHeap* bindlessHeap) 
+	: m_gxApi(gxApi), m_type(type), m_bindlessHeap(bindlessHeap)
+{
+	assert(bindlessHeap == nullptr || type == gxapi::eDescriptorHeapType::CBV_SRV_UAV);
+}
 
 
 auto ScratchSpacePool::RequestScratchSpace() -> UniquePtr {
@@ -26,11 +29,28 @@ auto ScratchSpacePool::RequestScratchSpace() -> UniquePtr {
 		index = m_allocator.Allocate();
 	}
 
+	// command lists bind the current bindless heap, scratch spaces of a replaced one are not reused
+	if (m_pool[index] != nullptr && m_bindlessHeap != nullptr && !m_bindlessHeap->IsCurrent(*m_pool[index])) {
+		ReleaseToBindlessHeap(index);
+	}
+
 	if (m_pool[index] != nullptr) {
 		return UniquePtr{ m_pool[index].get(), Deleter{this} };
 	}
 	else {
-		std::unique_ptr<StackDescHeap> ptr(new StackDescHeap{ m_gxApi, m_type, 1000 });
+		std::unique_ptr<StackDescHeap> ptr;
+		if (m_bindlessHeap != nullptr) {
+			try {
+				ptr = m_bindlessHeap->CreateScratchSpace();
+			}
+			catch (...) {
+				m_allocator.Deallocate(index);
+				throw;
+			}
+		}
+		else {
+			ptr.reset(new StackDescHeap{ m_gxApi, m_type, 1000 });
+		}
 		m_addressToIndex[ptr.get()] = index;
 		m_pool[index] = std::move(ptr);
 		return UniquePtr{ m_pool[index].get(), Deleter{this} };
@@ -45,6 +65,17 @@ void ScratchSpacePool::RecycleScratchSpace(StackDescHeap* scratchSpace) {
 	assert(m_addressToIndex.count(scratchSpace) > 0);
 	size_t index = m_addressToIndex[scratchSpace];
 	m_allocator.Deallocate(index);
+
+	// the GPU is done with it, so a replaced bindless heap can be freed as early as possible
+	if (m_bindlessHeap != nullptr && !m_bindlessHeap->IsCurrent(*scratchSpace)) {
+		ReleaseToBindlessHeap(index);
+	}
+}
+
+
+void ScratchSpacePool::ReleaseToBindlessHeap(size_t index) {
+	m_addressToIndex.erase(m_pool[index].get());
+	m_bindlessHeap->ReleaseScratchSpace(std::move(m_pool[index]));
 }
 
 
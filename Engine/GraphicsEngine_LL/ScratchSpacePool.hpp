@@ -12,6 +12,8 @@ namespace inl {
 namespace gxeng {
 
 
+class BindlessHeap;
+
 
 class ScratchSpacePool {
 public:
@@ -28,7 +30,9 @@ public:
 
 	using UniquePtr = std::unique_ptr<StackDescHeap, Deleter>;
 public:
-	ScratchSpacePool(gxapi::IGraphicsApi* gxApi, gxapi::eDescriptorHeapType type);
+	/// <param name="bindlessHeap"> If not null, CBV_SRV_UAV scratch spaces are carved from the bindless heap,
+	///		so command lists can use them together with bindless descriptors. </param>
+	ScratchSpacePool(gxapi::IGraphicsApi* gxApi, gxapi::eDescriptorHeapType type, BindlessHeap* bindlessHeap = nullptr);
 	ScratchSpacePool(const ScratchSpacePool&) = delete;
 	ScratchSpacePool(ScratchSpacePool&&) = default;
 	ScratchSpacePool& operator=(const ScratchSpacePool&) = delete;
@@ -36,11 +40,15 @@ public:
 
 	UniquePtr RequestScratchSpace();
 	void RecycleScratchSpace(StackDescHeap* scratchSpace);
+private:
+	/// <summary> Gives an unused scratch space of a replaced heap back to the bindless heap. </summary>
+	void ReleaseToBindlessHeap(size_t index);
 private:
 	std::vector<std::unique_ptr<StackDescHeap>> m_pool;
 	gxapi::eDescriptorHeapType m_type;
 	exc::SlabAllocatorEngine m_allocator;
 	gxapi::IGraphicsApi* m_gxApi;
+	BindlessHeap* m_bindlessHeap = nullptr;
 	std::map<StackDescHeap*, size_t> m_addressToIndex;
 
 	std::mutex m_mutex;
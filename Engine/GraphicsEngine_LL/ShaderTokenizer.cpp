@@ -0,0 +1,301 @@
+#include "ShaderTokenizer.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+static bool IsIdentifierStart(char c) {
+	return isalpha((unsigned char)c) || c == '_';
+}
+
+static bool IsIdentifierChar(char c) {
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+
+ShaderTokenizer::ShaderTokenizer(std::string code) {
+	SetCode(std::move(code));
+}
+
+
+void ShaderTokenizer::SetCode(std::string code) {
+	m_code = std::move(code);
+	Tokenize();
+}
+
+
+std::string ShaderTokenizer::GetText(const ShaderToken& token) const {
+	return m_code.substr(token.offset, token.length);
+}
+
+
+bool ShaderTokenizer::Equals(const ShaderToken& token, const char* text) const {
+	size_t length = strlen(text);
+	return token.length == length && m_code.compare(token.offset, length, text) == 0;
+}
+
+
+bool ShaderTokenizer::Equals(const ShaderToken& token, const std::string& text) const {
+	return token.length == text.size() && m_code.compare(token.offset, text.size(), text) == 0;
+}
+
+
+void ShaderTokenizer::Tokenize() {
+	m_tokens.clear();
+	m_comments.clear();
+
+	const size_t size = m_code.size();
+	size_t i = 0;
+	bool lineStart = true;
+	while (i < size) {
+		char c = m_code[i];
+
+		// whitespace
+		if (isspace((unsigned char)c)) {
+			lineStart = lineStart || c == '\n';
+			++i;
+			continue;
+		}
+
+		// comments
+		if (c == '/' && i + 1 < size && m_code[i + 1] == '/') {
+			size_t end = m_code.find('\n', i);
+			end = end == m_code.npos ? size : end;
+			m_comments.push_back({ i, end - i });
+			i = end;
+			continue;
+		}
+		if (c == '/' && i + 1 < size && m_code[i + 1] == '*') {
+			size_t end = m_code.find("*/", i + 2);
+			end = end == m_code.npos ? size : end + 2;
+			m_comments.push_back({ i, end - i });
+			i = end;
+			continue;
+		}
+
+		// preprocessor lines are skipped entirely, including line continuations
+		if (c == '#' && lineStart) {
+			while (i < size && m_code[i] != '\n') {
+				if (m_code[i] == '\\' && i + 1 < size && m_code[i + 1] == '\n') {
+					++i;
+				}
+				++i;
+			}
+			continue;
+		}
+		lineStart = false;
+
+		size_t begin = i;
+		eShaderTokenType type;
+		if (IsIdentifierStart(c)) {
+			while (i < size && IsIdentifierChar(m_code[i])) {
+				++i;
+			}
+			type = eShaderTokenType::IDENTIFIER;
+		}
+		else if (isdigit((unsigned char)c) || (c == '.' && i + 1 < size && isdigit((unsigned char)m_code[i + 1]))) {
+			// covers 1, 1.0, .5f, 1e-3, 0x1F
+			while (i < size) {
+				char n = m_code[i];
+				if (IsIdentifierChar(n) || n == '.') {
+					++i;
+				}
+				else if ((n == '-' || n == '+') && (m_code[i - 1] == 'e' || m_code[i - 1] == 'E')) {
+					++i;
+				}
+				else {
+					break;
+				}
+			}
+			type = eShaderTokenType::NUMBER;
+		}
+		else if (c == '"') {
+			++i;
+			while (i < size && m_code[i] != '"') {
+				i += m_code[i] == '\\' ? 2 : 1;
+			}
+			i = std::min(i + 1, size);
+			type = eShaderTokenType::STRING;
+		}
+		else {
+			++i;
+			type = eShaderTokenType::PUNCTUATOR;
+		}
+
+		m_tokens.push_back({ type, begin, i - begin });
+	}
+}
+
+
+size_t ShaderTokenizer::FindClosing(size_t openingIndex, char opening, char closing) const {
+	int depth = 0;
+	for (size_t i = openingIndex; i < m_tokens.size(); ++i) {
+		const ShaderToken& token = m_tokens[i];
+		if (token.type != eShaderTokenType::PUNCTUATOR) {
+			continue;
+		}
+		char c = m_code[token.offset];
+		if (c == opening) {
+			++depth;
+		}
+		else if (c == closing) {
+			--depth;
+			if (depth == 0) {
+				return i;
+			}
+		}
+	}
+	return m_tokens.size();
+}
+
+
+ShaderFunctionSignature ShaderTokenizer::FindFunctionSignature(const std::string& functionName) const {
+	auto IsPunctuator = [this](size_t index, char c) {
+		return index < m_tokens.size()
+			&& m_tokens[index].type == eShaderTokenType::PUNCTUATOR
+			&& m_code[m_tokens[index].offset] == c;
+	};
+
+	for (size_t i = 0; i < m_tokens.size(); ++i) {
+		if (m_tokens[i].type != eShaderTokenType::IDENTIFIER || !Equals(m_tokens[i], functionName) || !IsPunctuator(i + 1, '(')) {
+			continue;
+		}
+
+		// a definition has the form: returnType name ( params ) [: SEMANTIC] {
+		size_t closing = FindClosing(i + 1, '(', ')');
+		size_t bodyIndex = closing + 1;
+		if (IsPunctuator(bodyIndex, ':')) {
+			bodyIndex += 2;
+		}
+		if (!IsPunctuator(bodyIndex, '{')) {
+			continue; // just a call or a declaration
+		}
+
+		if (i == 0 || m_tokens[i - 1].type != eShaderTokenType::IDENTIFIER) {
+			throw std::invalid_argument("Function " + functionName + " has no return type.");
+		}
+
+		ShaderFunctionSignature signature;
+		signature.name = functionName;
+		signature.returnType = GetText(m_tokens[i - 1]);
+
+		// empty list or (void)
+		size_t firstParam = i + 2;
+		if (firstParam == closing || (firstParam + 1 == closing && Equals(m_tokens[firstParam], "void"))) {
+			return signature;
+		}
+
+		// split parameters at top-level commas
+		// angle brackets only nest as template arguments of the type, like Texture2D<float4>,
+		// in default values they are comparisons
+		size_t paramBegin = firstParam;
+		int depth = 0;
+		int templateDepth = 0;
+		bool isDefaultValue = false;
+		for (size_t t = firstParam; t <= closing; ++t) {
+			bool isSeparator = false;
+			if (m_tokens[t].type == eShaderTokenType::PUNCTUATOR) {
+				char c = m_code[m_tokens[t].offset];
+				depth += (c == '(' || c == '[' || c == '{') ? 1 : 0;
+				depth -= (c == ')' || c == ']' || c == '}') ? 1 : 0;
+				if (!isDefaultValue && c == '<' && m_tokens[t - 1].type == eShaderTokenType::IDENTIFIER) {
+					++templateDepth;
+				}
+				else if (templateDepth > 0 && c == '>') {
+					--templateDepth;
+				}
+				isDefaultValue = isDefaultValue || (c == '=' && depth == 0 && templateDepth == 0);
+				isSeparator = (c == ',' && depth == 0 && templateDepth == 0) || t == closing;
+			}
+			if (!isSeparator) {
+				continue;
+			}
+
+			size_t paramEnd = t;
+			if (paramBegin == paramEnd) {
+				throw std::invalid_argument("Parameter of " + functionName + " has zero characters.");
+			}
+
+			// cut off semantics and default values
+			for (size_t k = paramBegin; k < paramEnd; ++k) {
+				if (IsPunctuator(k, ':') || IsPunctuator(k, '=')) {
+					paramEnd = k;
+					break;
+				}
+			}
+			// skip modifiers
+			while (paramBegin < paramEnd
+				   && (Equals(m_tokens[paramBegin], "in") || Equals(m_tokens[paramBegin], "out") || Equals(m_tokens[paramBegin], "inout")
+					   || Equals(m_tokens[paramBegin], "uniform") || Equals(m_tokens[paramBegin], "const")))
+			{
+				++paramBegin;
+			}
+			// the name is the last identifier, except for array declarators
+			size_t nameIndex = paramEnd;
+			for (size_t k = paramBegin; k < paramEnd; ++k) {
+				if (IsPunctuator(k, '[')) {
+					break;
+				}
+				nameIndex = m_tokens[k].type == eShaderTokenType::IDENTIFIER ? k : nameIndex;
+			}
+			if (nameIndex == paramEnd || nameIndex == paramBegin) {
+				throw std::invalid_argument("Parameter of " + functionName + " has no type specifier or declaration name.");
+			}
+
+			const ShaderToken& typeFirst = m_tokens[paramBegin];
+			const ShaderToken& typeLast = m_tokens[nameIndex - 1];
+			signature.parameters.push_back({
+				m_code.substr(typeFirst.offset, typeLast.offset + typeLast.length - typeFirst.offset),
+				GetText(m_tokens[nameIndex]) });
+
+			paramBegin = t + 1;
+			isDefaultValue = false;
+		}
+
+		return signature;
+	}
+
+	throw std::invalid_argument("No function named " + functionName + " found in shader code.");
+}
+
+
+std::string ShaderTokenizer::RenameIdentifier(const std::string& from, const std::string& to) const {
+	std::string result;
+	result.reserve(m_code.size() + to.size() * 4);
+
+	size_t copied = 0;
+	for (const auto& token : m_tokens) {
+		if (token.type == eShaderTokenType::IDENTIFIER && Equals(token, from)) {
+			result.append(m_code, copied, token.offset - copied);
+			result.append(to);
+			copied = token.offset + token.length;
+		}
+	}
+	result.append(m_code, copied, m_code.npos);
+
+	return result;
+}
+
+
+std::string ShaderTokenizer::StripComments() const {
+	std::string result;
+	result.reserve(m_code.size());
+
+	size_t copied = 0;
+	for (const auto& comment : m_comments) {
+		result.append(m_code, copied, comment.first - copied);
+		result += ' ';
+		copied = comment.first + comment.second;
+	}
+	result.append(m_code, copied, m_code.npos);
+
+	return result;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace inl::gxeng {
+
+
+enum class eShaderTokenType {
+	IDENTIFIER,
+	NUMBER,
+	STRING,
+	PUNCTUATOR,
+};
+
+
+/// <summary> A single token of HLSL code, referencing a range of the source string. </summary>
+struct ShaderToken {
+	eShaderTokenType type;
+	size_t offset;
+	size_t length;
+};
+
+
+/// <summary> Return type, name and parameter list of a function found in HLSL code. </summary>
+struct ShaderFunctionSignature {
+	std::string returnType;
+	std::string name;
+	/// <summary> List of {type, name} pairs. Modifiers and semantics are dropped. </summary>
+	std::vector<std::pair<std::string, std::string>> parameters;
+};
+
+
+/// <summary>
+/// Hand-written tokenizer for the subset of HLSL used by material shaders.
+/// Understands identifiers, numbers, strings, punctuation, comments and preprocessor lines,
+/// which is just enough to find function signatures and rename identifiers without
+/// running regexes over the whole source.
+/// </summary>
+class ShaderTokenizer {
+public:
+	ShaderTokenizer() = default;
+	explicit ShaderTokenizer(std::string code);
+
+	/// <summary> Replaces the source code and tokenizes it. </summary>
+	void SetCode(std::string code);
+	const std::string& GetCode() const { return m_code; }
+	const std::vector<ShaderToken>& GetTokens() const { return m_tokens; }
+
+	/// <summary> Returns the text of a token as a new string. </summary>
+	std::string GetText(const ShaderToken& token) const;
+	/// <summary> Compares the text of a token to <paramref name="text"/> without allocating. </summary>
+	bool Equals(const ShaderToken& token, const char* text) const;
+	bool Equals(const ShaderToken& token, const std::string& text) const;
+
+	/// <summary> Finds the first function definition (signature followed by a body) with the given name. </summary>
+	/// <exception cref="std::invalid_argument"> If there is no such function or the signature is malformed. </exception>
+	ShaderFunctionSignature FindFunctionSignature(const std::string& functionName) const;
+
+	/// <summary> Returns the code with all occurences of identifier <paramref name="from"/> replaced. </summary>
+	/// <remarks> Only whole identifiers are replaced, comments and strings are left untouched. </remarks>
+	std::string RenameIdentifier(const std::string& from, const std::string& to) const;
+
+	/// <summary> Returns the code with comments replaced by a single space. </summary>
+	std::string StripComments() const;
+private:
+	void Tokenize();
+	/// <summary> Returns the index of the matching closing bracket, or tokens.size() if unbalanced. </summary>
+	size_t FindClosing(size_t openingIndex, char opening, char closing) const;
+private:
+	std::string m_code;
+	std::vector<ShaderToken> m_tokens;
+	std::vector<std::pair<size_t, size_t>> m_comments; // {offset, length} of each comment
+};
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,151 @@
+#include "ShadowCascades.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+using Vec3 = mathfu::Vector<float, 3>;
+using Mat44 = mathfu::Matrix<float, 4, 4>;
+
+
+Mat44 ShadowCascade::GetViewProjection() const {
+	// rows map onto the box: x and y to [-1, 1], depth along the light to [0, 1]
+	float xScale = 1.0f / halfExtent;
+	float yScale = 1.0f / halfExtent;
+	float zScale = 0.5f / radius;
+	Vec3 row0 = lightRight * xScale;
+	Vec3 row1 = lightUp * yScale;
+	Vec3 row2 = lightDirection * zScale;
+	float offset0 = -Vec3::DotProduct(lightRight, center) * xScale;
+	float offset1 = -Vec3::DotProduct(lightUp, center) * yScale;
+	float offset2 = -Vec3::DotProduct(lightDirection, center) * zScale + 0.5f;
+
+	return Mat44(row0.x(), row1.x(), row2.x(), 0.0f,	// column #1
+				 row0.y(), row1.y(), row2.y(), 0.0f,	// column #2
+				 row0.z(), row1.z(), row2.z(), 0.0f,	// column #3
+				 offset0, offset1, offset2, 1.0f);		// column #4
+}
+
+
+bool ShadowCascade::IsCasterVisible(const Vec3& minimum, const Vec3& maximum) const {
+	Vec3 boxCenter = (minimum + maximum) * 0.5f - center;
+	Vec3 boxExtent = (maximum - minimum) * 0.5f;
+
+	auto ProjectedExtent = [&boxExtent](const Vec3& axis) {
+		return std::abs(axis.x()) * boxExtent.x() + std::abs(axis.y()) * boxExtent.y() + std::abs(axis.z()) * boxExtent.z();
+	};
+
+	if (std::abs(Vec3::DotProduct(lightRight, boxCenter)) - ProjectedExtent(lightRight) > halfExtent) {
+		return false;
+	}
+	if (std::abs(Vec3::DotProduct(lightUp, boxCenter)) - ProjectedExtent(lightUp) > halfExtent) {
+		return false;
+	}
+	// only the far side culls, anything toward the light may still shadow the box
+	if (Vec3::DotProduct(lightDirection, boxCenter) - ProjectedExtent(lightDirection) > radius) {
+		return false;
+	}
+	return true;
+}
+
+
+ShadowCascadeFitter::ShadowCascadeFitter(ShadowCascadeDesc desc)
+	: m_desc(std::move(desc)),
+	m_valid(false)
+{
+	if (m_desc.refitMargins.empty() || m_desc.refitMargins.size() != m_desc.updateIntervals.size()) {
+		throw std::invalid_argument("Shadow cascades need the same number of refit margins and update intervals, at least one.");
+	}
+	if (m_desc.resolution <= 2 * m_desc.filterTexels + 2) {
+		throw std::invalid_argument("Shadow cascade resolution is too small for the filter border.");
+	}
+	for (size_t i = 0; i < m_desc.refitMargins.size(); ++i) {
+		if (!(m_desc.refitMargins[i] >= 0.0f) || m_desc.updateIntervals[i] == 0) {
+			throw std::invalid_argument("Shadow cascade refit margins must not be negative, update intervals must be positive.");
+		}
+	}
+
+	m_cascades.resize(m_desc.refitMargins.size());
+	m_fittedCenters.resize(m_desc.refitMargins.size());
+}
+
+
+float ShadowCascadeFitter::GetSplitDepth(unsigned index, float nearPlane, float farPlane) const {
+	if (m_desc.shadowDistance > nearPlane) {
+		farPlane = std::min(farPlane, m_desc.shadowDistance);
+	}
+	float t = (float)index / (float)GetCascadeCount();
+	float uniformSplit = nearPlane + (farPlane - nearPlane) * t;
+	float logSplit = nearPlane * std::pow(farPlane / nearPlane, t);
+	return uniformSplit + (logSplit - uniformSplit) * m_desc.splitLambda;
+}
+
+
+void ShadowCascadeFitter::Update(const ShadowCascadeView& view, const Vec3& lightDirection) {
+	if (!(view.nearPlane > 0.0f) || !(view.farPlane > view.nearPlane)) {
+		throw std::invalid_argument("Shadow cascades need 0 < near < far.");
+	}
+
+	// light space basis does not depend on the camera, so it only changes when the light turns
+	bool lightTurned = !m_valid || Vec3::DotProduct(lightDirection, m_cascades[0].lightDirection) < 1.0f - 1e-6f;
+	Vec3 worldUp = std::abs(lightDirection.z()) < 0.9f ? Vec3(0, 0, 1) : Vec3(1, 0, 0);
+	Vec3 lightRight = Vec3::CrossProduct(lightDirection, worldUp).Normalized();
+	Vec3 lightUp = Vec3::CrossProduct(lightRight, lightDirection);
+
+	const float cornerSlopeSq = view.tanHalfFovX * view.tanHalfFovX + view.tanHalfFovY * view.tanHalfFovY;
+	const float resolution = (float)m_desc.resolution;
+
+	for (unsigned i = 0; i < GetCascadeCount(); ++i) {
+		ShadowCascade& cascade = m_cascades[i];
+		float nearSplit = GetSplitDepth(i, view.nearPlane, view.farPlane);
+		float farSplit = GetSplitDepth(i + 1, view.nearPlane, view.farPlane);
+
+		// smallest sphere around the slice, its center is on the view axis equidistant from the near and far corners
+		float centerDepth = 0.5f * (farSplit + nearSplit) * (1.0f + cornerSlopeSq);
+		float sliceRadius;
+		if (centerDepth >= farSplit) {
+			centerDepth = farSplit;
+			sliceRadius = farSplit * std::sqrt(cornerSlopeSq);
+		}
+		else {
+			sliceRadius = std::sqrt((farSplit - centerDepth) * (farSplit - centerDepth) + farSplit * farSplit * cornerSlopeSq);
+		}
+		Vec3 sliceCenter = view.position + view.lookDirection * centerDepth;
+
+		cascade.nearSplit = nearSplit;
+		cascade.farSplit = farSplit;
+		cascade.refit = lightTurned || (sliceCenter - m_fittedCenters[i]).Length() + sliceRadius > cascade.radius;
+		if (!cascade.refit) {
+			continue;
+		}
+
+		cascade.radius = sliceRadius * (1.0f + m_desc.refitMargins[i]);
+		cascade.halfExtent = cascade.radius * resolution / (resolution - 2.0f * m_desc.filterTexels - 2.0f);
+		cascade.lightRight = lightRight;
+		cascade.lightUp = lightUp;
+		cascade.lightDirection = lightDirection;
+		m_fittedCenters[i] = sliceCenter;
+
+		// snapping to texels moves the box by less than a texel, the extra border texel covers that
+		float texelSize = 2.0f * cascade.halfExtent / resolution;
+		float x = Vec3::DotProduct(lightRight, sliceCenter);
+		float y = Vec3::DotProduct(lightUp, sliceCenter);
+		float snappedX = std::round(x / texelSize) * texelSize;
+		float snappedY = std::round(y / texelSize) * texelSize;
+		cascade.center = sliceCenter + lightRight * (snappedX - x) + lightUp * (snappedY - y);
+	}
+
+	m_valid = true;
+}
+
+
+void ShadowCascadeFitter::Invalidate() {
+	m_valid = false;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <mathfu/vector.h>
+#include <mathfu/matrix_4x4.h>
+
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Layout and caching policy of the shadow cascades. </summary>
+struct ShadowCascadeDesc {
+	/// <summary> Width and height of a cascade's shadow map in texels. </summary>
+	unsigned resolution = 1024;
+	/// <summary> Shadows end at this view depth, or at the camera's far plane if that is closer. </summary>
+	float shadowDistance = 250.0f;
+	/// <summary> Blends split positions between uniform (0) and logarithmic (1). </summary>
+	float splitLambda = 0.8f;
+	/// <summary> Texels left as a border on each side for filtering. </summary>
+	unsigned filterTexels = 3;
+	/// <summary>
+	/// How much larger each cascade is fitted than its slice of the view frustum. A cascade keeps its
+	/// matrix, and so its cached depth, until the slice leaves the enlarged sphere. One value per cascade.
+	/// </summary>
+	std::vector<float> refitMargins = { 0.0f, 0.1f, 0.2f, 0.25f };
+	/// <summary> Dynamic casters of a cascade are re-rendered every this many frames. One value per cascade. </summary>
+	std::vector<unsigned> updateIntervals = { 1, 1, 2, 4 };
+};
+
+
+/// <summary> Camera parameters the cascades are fitted to. Directions are in world space and normalized. </summary>
+struct ShadowCascadeView {
+	mathfu::Vector<float, 3> position;
+	mathfu::Vector<float, 3> lookDirection;
+	mathfu::Vector<float, 3> upVector;
+	float tanHalfFovX;
+	float tanHalfFovY;
+	float nearPlane;
+	float farPlane;
+};
+
+
+/// <summary>
+/// A single cascade: an orthographic box around a world space sphere, looking along the light.
+/// Depth goes from 0 at the side facing the light to 1 at the far side.
+/// </summary>
+struct ShadowCascade {
+	/// <summary> View depth range of the frustum slice covered by this cascade this frame. </summary>
+	float nearSplit, farSplit;
+	/// <summary> Texel-snapped center of the box. </summary>
+	mathfu::Vector<float, 3> center;
+	/// <summary> Radius of the sphere the cascade was fitted to. </summary>
+	float radius;
+	/// <summary> Half width and height of the box, radius plus filter border. </summary>
+	float halfExtent;
+	mathfu::Vector<float, 3> lightRight, lightUp, lightDirection;
+	/// <summary> True if the matrix changed this frame, and cached depth is no longer valid. </summary>
+	bool refit;
+
+	/// <summary> World to clip space transform of the cascade. </summary>
+	mathfu::Matrix<float, 4, 4> GetViewProjection() const;
+
+	/// <summary>
+	/// Conservative test whether an object with the given world space bounds may cast a shadow into the cascade.
+	/// Objects between the light and the box are kept, they are flattened onto the near plane when drawn.
+	/// </summary>
+	bool IsCasterVisible(const mathfu::Vector<float, 3>& minimum, const mathfu::Vector<float, 3>& maximum) const;
+};
+
+
+/// <summary>
+/// Fits stable shadow cascades to a camera.
+/// Each cascade is fitted to the bounding sphere of its slice, so turning the camera does not resize it,
+/// and its center is snapped to whole texels, so moving the camera does not make edges crawl.
+/// A cascade is only refitted when its slice leaves the fitted sphere or the light turns.
+/// </summary>
+class ShadowCascadeFitter {
+public:
+	/// <exception cref="std::invalid_argument"> If the description has no cascades or mismatched per-cascade settings. </exception>
+	ShadowCascadeFitter(ShadowCascadeDesc desc = {});
+
+	const ShadowCascadeDesc& GetDesc() const { return m_desc; }
+	unsigned GetCascadeCount() const { return (unsigned)m_cascades.size(); }
+	const ShadowCascade& GetCascade(unsigned index) const { return m_cascades[index]; }
+
+	/// <summary> Fits the cascades for a new frame. </summary>
+	/// <param name="lightDirection"> Normalized direction the light travels in. </param>
+	/// <exception cref="std::invalid_argument"> If the view's depth range is invalid. </exception>
+	void Update(const ShadowCascadeView& view, const mathfu::Vector<float, 3>& lightDirection);
+
+	/// <summary> Forces every cascade to be refitted by the next update. </summary>
+	void Invalidate();
+
+	/// <summary> Returns the view depth where the given cascade begins. Cascade count returns the end of the last one. </summary>
+	float GetSplitDepth(unsigned index, float nearPlane, float farPlane) const;
+private:
+	ShadowCascadeDesc m_desc;
+	std::vector<ShadowCascade> m_cascades;
+	std::vector<mathfu::Vector<float, 3>> m_fittedCenters;
+	bool m_valid;
+};
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,155 @@
+#include "SkyLookupTableBuilder.hpp"
+
+#include <BaseLibrary/ThreadName.hpp>
+
+#include <algorithm>
+
+
+namespace inl::gxeng {
+
+
+SkyLookupTableBuilder::SkyLookupTableBuilder(SkyLookupTablesDesc desc, bool asynchronous)
+	: m_desc(desc),
+	m_tables(desc)
+{
+	m_runThread = asynchronous;
+	if (asynchronous) {
+		m_buildThread = std::thread(&SkyLookupTableBuilder::BuildThreadFunc, this);
+	}
+}
+
+
+SkyLookupTableBuilder::~SkyLookupTableBuilder() {
+	if (m_buildThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lkg(m_mutex);
+			m_runThread = false;
+		}
+		m_requestCv.notify_all();
+		m_buildThread.join();
+	}
+}
+
+
+eSkyLutChange SkyLookupTableBuilder::Update(const AtmosphereParams& atmosphere, mathfu::Vector<float, 3> sunDirection, float viewHeight) {
+	Request request{ atmosphere, sunDirection, viewHeight };
+	bool isNewRequest = !m_hasRequested || !SameRequest(request, m_lastRequest);
+	m_lastRequest = request;
+	m_hasRequested = true;
+
+	BuiltTables built;
+	if (m_buildThread.joinable()) {
+		std::lock_guard<std::mutex> lkg(m_mutex);
+		std::swap(built, m_built);
+		if (m_buildError) {
+			std::exception_ptr error = m_buildError;
+			m_buildError = nullptr;
+			std::rethrow_exception(error);
+		}
+		// the build thread decides on the thresholds itself, it's only woken when the inputs changed at all
+		if (isNewRequest) {
+			m_request = request;
+			m_hasRequest = true;
+			m_requestCv.notify_one();
+		}
+	}
+	else {
+		Build(request, built);
+	}
+
+	if (built.change == eSkyLutChange::ALL) {
+		m_transmittance = std::move(built.transmittance);
+	}
+	if (built.change != eSkyLutChange::NONE) {
+		m_skyView = std::move(built.skyView);
+		++m_version;
+	}
+	return built.change;
+}
+
+
+void SkyLookupTableBuilder::Flush() {
+	if (!m_buildThread.joinable()) {
+		return; // synchronous builds happen in Update anyways
+	}
+	std::unique_lock<std::mutex> lk(m_mutex);
+	m_idleCv.wait(lk, [this] { return !m_hasRequest && !m_isBuilding; });
+}
+
+
+void SkyLookupTableBuilder::BuildThreadFunc() {
+	SetCurrentThreadName("Sky Lookup Table Thread");
+
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true) {
+		m_requestCv.wait(lk, [this] { return !m_runThread || m_hasRequest; });
+		if (!m_runThread) {
+			break;
+		}
+
+		Request request = m_request;
+		m_hasRequest = false;
+		m_isBuilding = true;
+		lk.unlock();
+
+		BuiltTables built;
+		std::exception_ptr error;
+		try {
+			Build(request, built);
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		lk.lock();
+		m_isBuilding = false;
+		// tables not yet handed over are replaced, but what changed in them still has to be uploaded
+		if (built.change == eSkyLutChange::ALL) {
+			m_built.transmittance = std::move(built.transmittance);
+			m_built.change = eSkyLutChange::ALL;
+		}
+		if (built.change != eSkyLutChange::NONE) {
+			m_built.skyView = std::move(built.skyView);
+			m_built.change = std::max(m_built.change, built.change);
+		}
+		if (error) {
+			m_buildError = error;
+		}
+		if (!m_hasRequest) {
+			m_idleCv.notify_all();
+		}
+	}
+}
+
+
+void SkyLookupTableBuilder::Build(const Request& request, BuiltTables& built) {
+	built.change = m_tables.Update(request.atmosphere, request.sunDirection, request.viewHeight);
+	if (built.change == eSkyLutChange::ALL) {
+		built.transmittance = m_tables.GetTransmittance();
+	}
+	if (built.change != eSkyLutChange::NONE) {
+		built.skyView = m_tables.GetSkyView();
+	}
+}
+
+
+bool SkyLookupTableBuilder::SameRequest(const Request& lhs, const Request& rhs) {
+	const AtmosphereParams& a = lhs.atmosphere;
+	const AtmosphereParams& b = rhs.atmosphere;
+	return a.planetRadius == b.planetRadius
+		&& a.atmosphereHeight == b.atmosphereHeight
+		&& a.rayleighScattering == b.rayleighScattering
+		&& a.rayleighScaleHeight == b.rayleighScaleHeight
+		&& a.mieScattering == b.mieScattering
+		&& a.mieAbsorption == b.mieAbsorption
+		&& a.mieScaleHeight == b.mieScaleHeight
+		&& a.mieAnisotropy == b.mieAnisotropy
+		&& a.turbidity == b.turbidity
+		&& a.ozoneAbsorption == b.ozoneAbsorption
+		&& a.groundAlbedo == b.groundAlbedo
+		&& lhs.sunDirection == rhs.sunDirection
+		&& lhs.viewHeight == rhs.viewHeight;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "SkyLookupTables.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary>
+/// Builds the sky lookup tables in the background and hands over the finished ones.
+/// </summary>
+/// <remarks>
+/// All methods must be called from the same thread, only the building happens on the builder's own thread.
+/// Requests made while a build is running are merged, only the latest inputs are built next.
+/// The tables handed over last stay valid until the next <see cref="Update"/> that reports a change.
+/// </remarks>
+class SkyLookupTableBuilder {
+public:
+	/// <param name="asynchronous"> Tables are built on a background thread if true, in <see cref="Update"/> if false. </param>
+	SkyLookupTableBuilder(SkyLookupTablesDesc desc = {}, bool asynchronous = true);
+	SkyLookupTableBuilder(const SkyLookupTableBuilder&) = delete;
+	SkyLookupTableBuilder& operator=(const SkyLookupTableBuilder&) = delete;
+	~SkyLookupTableBuilder();
+
+	/// <summary> Requests tables for the inputs and takes over the tables finished since the last call. </summary>
+	/// <param name="sunDirection"> Normalized direction pointing towards the sun. </param>
+	/// <param name="viewHeight"> Height of the viewer above the ground in kilometers. </param>
+	/// <returns> Which of the handed over tables changed. The first finished tables report all of them. </returns>
+	/// <exception cref="std::exception"> Rethrows the errors of building the tables. </exception>
+	eSkyLutChange Update(const AtmosphereParams& atmosphere, mathfu::Vector<float, 3> sunDirection, float viewHeight);
+
+	/// <summary> Blocks until the requested tables are built. They are only handed over in the next <see cref="Update"/>. </summary>
+	void Flush();
+
+	const SkyLookupTablesDesc& GetDesc() const { return m_desc; }
+	/// <summary> False until the first tables are handed over. </summary>
+	bool HasTables() const { return m_version != 0; }
+	/// <summary> Incremented each time handed over tables change. </summary>
+	uint64_t GetVersion() const { return m_version; }
+
+	const std::vector<float>& GetTransmittance() const { return m_transmittance; }
+	const std::vector<float>& GetSkyView() const { return m_skyView; }
+
+private:
+	struct Request {
+		AtmosphereParams atmosphere;
+		mathfu::Vector<float, 3> sunDirection;
+		float viewHeight;
+	};
+	struct BuiltTables {
+		eSkyLutChange change = eSkyLutChange::NONE;
+		std::vector<float> transmittance;
+		std::vector<float> skyView;
+	};
+
+	void BuildThreadFunc();
+	void Build(const Request& request, BuiltTables& built);
+	static bool SameRequest(const Request& lhs, const Request& rhs);
+
+private:
+	SkyLookupTablesDesc m_desc;
+
+	// Main thread only
+	uint64_t m_version = 0;
+	std::vector<float> m_transmittance;
+	std::vector<float> m_skyView;
+	Request m_lastRequest;
+	bool m_hasRequested = false;
+
+	// Build thread only, unless built synchronously
+	SkyLookupTables m_tables;
+
+	// Shared with the build thread
+	std::mutex m_mutex;
+	std::condition_variable m_requestCv;
+	std::condition_variable m_idleCv;
+	Request m_request;
+	bool m_hasRequest = false;
+	bool m_isBuilding = false;
+	BuiltTables m_built;
+	std::exception_ptr m_buildError;
+	std::atomic_bool m_runThread;
+	std::thread m_buildThread;
+};
+
+
+} // namespace inl::gxeng
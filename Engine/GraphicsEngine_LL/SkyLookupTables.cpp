@@ -0,0 +1,380 @@
+#include "SkyLookupTables.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+using Vec3 = mathfu::Vector<float, 3>;
+
+static constexpr float Pi = 3.14159265358979f;
+static constexpr int TransmittanceSteps = 40;
+static constexpr int MultiScatteringSteps = 20;
+static constexpr int MultiScatteringDirections = 8; // per axis of the sphere, squared in total
+static constexpr int SkyViewSteps = 32;
+
+
+namespace {
+
+/// <summary> Optical properties of the air at a height. </summary>
+struct Medium {
+	Vec3 rayleighScattering;
+	float mieScattering;
+	Vec3 extinction;
+
+	Vec3 Scattering() const { return rayleighScattering + Vec3(mieScattering); }
+};
+
+
+Medium SampleMedium(const AtmosphereParams& atmosphere, float height) {
+	height = std::max(height, 0.0f);
+	float rayleighDensity = std::exp(-height / atmosphere.rayleighScaleHeight);
+	float mieDensity = std::exp(-height / atmosphere.mieScaleHeight) * atmosphere.turbidity;
+	float ozoneDensity = std::max(0.0f, 1.0f - std::abs(height - 25.0f) / 15.0f);
+
+	Medium medium;
+	medium.rayleighScattering = atmosphere.rayleighScattering * rayleighDensity;
+	medium.mieScattering = atmosphere.mieScattering * mieDensity;
+	medium.extinction = medium.rayleighScattering
+		+ Vec3((atmosphere.mieScattering + atmosphere.mieAbsorption) * mieDensity)
+		+ atmosphere.ozoneAbsorption * ozoneDensity;
+	return medium;
+}
+
+
+Vec3 Exp(const Vec3& v) {
+	return { std::exp(v.x()), std::exp(v.y()), std::exp(v.z()) };
+}
+
+
+/// <summary> Integral of constant source over a segment of constant extinction, divided by the source.
+///		Integrating this way keeps the result stable for large steps in dense air. </summary>
+Vec3 SegmentIntegral(const Vec3& extinction, const Vec3& stepTransmittance, float step) {
+	Vec3 result;
+	for (int i = 0; i < 3; ++i) {
+		result[i] = extinction[i] > 1e-9f ? (1.0f - stepTransmittance[i]) / extinction[i] : step;
+	}
+	return result;
+}
+
+
+/// <summary> Distance along the ray to the sphere around the planet's center, or negative if there is no intersection ahead. </summary>
+/// <param name="radius"> Distance of the ray's origin from the planet's center. </param>
+/// <param name="farHit"> Take the far intersection instead of the near one. </param>
+float IntersectSphere(float radius, float cosZenith, float sphereRadius, bool farHit) {
+	float b = radius * cosZenith;
+	float discriminant = b * b - (radius * radius - sphereRadius * sphereRadius);
+	if (discriminant < 0.0f) {
+		return -1.0f;
+	}
+	float root = std::sqrt(discriminant);
+	return farHit ? -b + root : -b - root;
+}
+
+
+/// <summary> Finds how far a ray travels in the atmosphere. </summary>
+/// <returns> True if the ray ends on the ground. </returns>
+bool RayLength(const AtmosphereParams& atmosphere, float height, float cosZenith, float& length) {
+	float radius = atmosphere.planetRadius + height;
+	float groundDistance = IntersectSphere(radius, cosZenith, atmosphere.planetRadius, false);
+	if (groundDistance > 0.0f) {
+		length = groundDistance;
+		return true;
+	}
+	length = std::max(0.0f, IntersectSphere(radius, cosZenith, atmosphere.planetRadius + atmosphere.atmosphereHeight, true));
+	return false;
+}
+
+
+/// <summary> Splits [0, length] into steps that get longer quadratically, the air is densest near the origin for most rays. </summary>
+void StepBounds(int step, int numSteps, float length, float& begin, float& end) {
+	float t0 = float(step) / numSteps;
+	float t1 = float(step + 1) / numSteps;
+	begin = t0 * t0 * length;
+	end = t1 * t1 * length;
+}
+
+
+float CosZenith(const Vec3& position, const Vec3& direction) {
+	return Vec3::DotProduct(position, direction) / position.Length();
+}
+
+
+float Lerp(float a, float b, float t) {
+	return a + (b - a) * t;
+}
+
+} // namespace
+
+
+
+SkyLookupTables::SkyLookupTables(SkyLookupTablesDesc desc)
+	: m_desc(desc)
+{
+	if (desc.transmittanceWidth < 2 || desc.transmittanceHeight < 2 || desc.multiScatteringSize < 2 || desc.skyViewWidth < 2 || desc.skyViewHeight < 2) {
+		throw std::invalid_argument("Sky lookup tables must have at least two texels along each axis.");
+	}
+	m_transmittance.resize(4 * desc.transmittanceWidth * desc.transmittanceHeight);
+	m_multiScattering.resize(4 * desc.multiScatteringSize * desc.multiScatteringSize);
+	m_skyView.resize(4 * desc.skyViewWidth * desc.skyViewHeight);
+}
+
+
+eSkyLutChange SkyLookupTables::Update(const AtmosphereParams& atmosphere, Vec3 sunDirection, float viewHeight) {
+	float sunElevation = std::asin(std::clamp(sunDirection.z() / sunDirection.Length(), -1.0f, 1.0f));
+	viewHeight = std::clamp(viewHeight, 0.0f, atmosphere.atmosphereHeight * 0.999f);
+
+	eSkyLutChange change = eSkyLutChange::NONE;
+	if (!m_valid || !ParamsClose(atmosphere, m_atmosphere)) {
+		change = eSkyLutChange::ALL;
+	}
+	else if (std::abs(sunElevation - m_sunElevation) > m_desc.sunAngleThreshold
+			 || std::abs(viewHeight - m_viewHeight) > m_desc.viewHeightThreshold) {
+		change = eSkyLutChange::SKY_VIEW;
+	}
+
+	if (change == eSkyLutChange::ALL) {
+		m_atmosphere = atmosphere;
+		ComputeTransmittanceTable(atmosphere);
+		ComputeMultiScatteringTable(atmosphere);
+		m_valid = true;
+	}
+	if (change != eSkyLutChange::NONE) {
+		m_sunElevation = sunElevation;
+		m_viewHeight = viewHeight;
+		ComputeSkyViewTable(atmosphere, std::sin(sunElevation), viewHeight);
+		++m_version;
+	}
+
+	return change;
+}
+
+
+Vec3 SkyLookupTables::ComputeTransmittance(const AtmosphereParams& atmosphere, float height, float cosZenith) {
+	float length;
+	if (RayLength(atmosphere, height, cosZenith, length)) {
+		return Vec3(0.0f);
+	}
+
+	float radius = atmosphere.planetRadius + height;
+	Vec3 opticalDepth(0.0f);
+	for (int step = 0; step < TransmittanceSteps; ++step) {
+		float begin, end;
+		StepBounds(step, TransmittanceSteps, length, begin, end);
+		float t = 0.5f * (begin + end);
+		float sampleHeight = std::sqrt(radius * radius + 2.0f * radius * cosZenith * t + t * t) - atmosphere.planetRadius;
+		opticalDepth += SampleMedium(atmosphere, sampleHeight).extinction * (end - begin);
+	}
+	return Exp(-opticalDepth);
+}
+
+
+Vec3 SkyLookupTables::ComputeSkyLuminance(const AtmosphereParams& atmosphere, float height, Vec3 viewDirection, Vec3 sunDirection) const {
+	Vec3 origin(0.0f, 0.0f, atmosphere.planetRadius + height);
+	float length;
+	RayLength(atmosphere, height, viewDirection.z(), length);
+
+	float cosViewSun = Vec3::DotProduct(viewDirection, sunDirection);
+	float rayleighPhase = RayleighPhase(cosViewSun);
+	float miePhase = CornetteShanksPhase(cosViewSun, atmosphere.mieAnisotropy);
+
+	Vec3 luminance(0.0f);
+	Vec3 throughput(1.0f);
+	for (int step = 0; step < SkyViewSteps; ++step) {
+		float begin, end;
+		StepBounds(step, SkyViewSteps, length, begin, end);
+		Vec3 position = origin + viewDirection * (0.5f * (begin + end));
+		float sampleHeight = position.Length() - atmosphere.planetRadius;
+		float cosSunZenith = CosZenith(position, sunDirection);
+
+		Medium medium = SampleMedium(atmosphere, sampleHeight);
+		Vec3 sunTransmittance = SampleTransmittance(sampleHeight, cosSunZenith);
+		Vec3 multiScattering = SampleMultiScattering(sampleHeight, cosSunZenith);
+
+		Vec3 singleScattering = sunTransmittance * (medium.rayleighScattering * rayleighPhase + Vec3(medium.mieScattering * miePhase));
+		Vec3 source = singleScattering + medium.Scattering() * multiScattering;
+
+		Vec3 stepTransmittance = Exp(-medium.extinction * (end - begin));
+		luminance += throughput * source * SegmentIntegral(medium.extinction, stepTransmittance, end - begin);
+		throughput *= stepTransmittance;
+	}
+	return luminance;
+}
+
+
+Vec3 SkyLookupTables::SampleTransmittance(float height, float cosZenith) const {
+	float u = 0.5f * std::clamp(cosZenith, -1.0f, 1.0f) + 0.5f;
+	float v = std::sqrt(std::clamp(height / m_atmosphere.atmosphereHeight, 0.0f, 1.0f));
+	return SampleTable(m_transmittance, m_desc.transmittanceWidth, m_desc.transmittanceHeight, u, v);
+}
+
+
+Vec3 SkyLookupTables::SampleMultiScattering(float height, float cosSunZenith) const {
+	float u = 0.5f * std::clamp(cosSunZenith, -1.0f, 1.0f) + 0.5f;
+	float v = std::clamp(height / m_atmosphere.atmosphereHeight, 0.0f, 1.0f);
+	return SampleTable(m_multiScattering, m_desc.multiScatteringSize, m_desc.multiScatteringSize, u, v);
+}
+
+
+float SkyLookupTables::RayleighPhase(float cosTheta) {
+	return 3.0f / (16.0f * Pi) * (1.0f + cosTheta * cosTheta);
+}
+
+
+float SkyLookupTables::CornetteShanksPhase(float cosTheta, float g) {
+	float g2 = g * g;
+	float denominator = std::pow(std::max(1.0f + g2 - 2.0f * g * cosTheta, 1e-6f), 1.5f);
+	return 3.0f / (8.0f * Pi) * (1.0f - g2) * (1.0f + cosTheta * cosTheta) / ((2.0f + g2) * denominator);
+}
+
+
+void SkyLookupTables::ComputeTransmittanceTable(const AtmosphereParams& atmosphere) {
+	const unsigned width = m_desc.transmittanceWidth;
+	const unsigned height = m_desc.transmittanceHeight;
+	for (unsigned y = 0; y < height; ++y) {
+		float v = float(y) / (height - 1);
+		float sampleHeight = v * v * atmosphere.atmosphereHeight;
+		for (unsigned x = 0; x < width; ++x) {
+			float cosZenith = float(x) / (width - 1) * 2.0f - 1.0f;
+			Vec3 transmittance = ComputeTransmittance(atmosphere, sampleHeight, cosZenith);
+			float* texel = &m_transmittance[4 * (y * width + x)];
+			texel[0] = transmittance.x();
+			texel[1] = transmittance.y();
+			texel[2] = transmittance.z();
+			texel[3] = 1.0f;
+		}
+	}
+}
+
+
+void SkyLookupTables::ComputeMultiScatteringTable(const AtmosphereParams& atmosphere) {
+	const unsigned size = m_desc.multiScatteringSize;
+	const float isotropicPhase = 1.0f / (4.0f * Pi);
+
+	// directions uniformly distributed over the sphere
+	std::vector<Vec3> directions;
+	for (int i = 0; i < MultiScatteringDirections; ++i) {
+		float cosTheta = 1.0f - 2.0f * (i + 0.5f) / MultiScatteringDirections;
+		float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+		for (int j = 0; j < MultiScatteringDirections; ++j) {
+			float phi = 2.0f * Pi * (j + 0.5f) / MultiScatteringDirections;
+			directions.push_back({ sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta });
+		}
+	}
+
+	for (unsigned y = 0; y < size; ++y) {
+		float originHeight = float(y) / (size - 1) * atmosphere.atmosphereHeight;
+		Vec3 origin(0.0f, 0.0f, atmosphere.planetRadius + originHeight);
+		for (unsigned x = 0; x < size; ++x) {
+			float cosSunZenith = float(x) / (size - 1) * 2.0f - 1.0f;
+			Vec3 sunDirection(std::sqrt(std::max(0.0f, 1.0f - cosSunZenith * cosSunZenith)), 0.0f, cosSunZenith);
+
+			// second order luminance and the fraction of light scattered again, both averaged over the sphere
+			Vec3 secondOrder(0.0f);
+			Vec3 transferFactor(0.0f);
+			for (const Vec3& direction : directions) {
+				float length;
+				bool hitsGround = RayLength(atmosphere, originHeight, direction.z(), length);
+
+				Vec3 throughput(1.0f);
+				for (int step = 0; step < MultiScatteringSteps; ++step) {
+					float begin, end;
+					StepBounds(step, MultiScatteringSteps, length, begin, end);
+					Vec3 position = origin + direction * (0.5f * (begin + end));
+					float sampleHeight = position.Length() - atmosphere.planetRadius;
+
+					Medium medium = SampleMedium(atmosphere, sampleHeight);
+					Vec3 sunTransmittance = SampleTransmittance(sampleHeight, CosZenith(position, sunDirection));
+					Vec3 stepTransmittance = Exp(-medium.extinction * (end - begin));
+					Vec3 integral = SegmentIntegral(medium.extinction, stepTransmittance, end - begin);
+
+					secondOrder += throughput * sunTransmittance * medium.Scattering() * isotropicPhase * integral;
+					transferFactor += throughput * medium.Scattering() * integral;
+					throughput *= stepTransmittance;
+				}
+				if (hitsGround) {
+					Vec3 position = origin + direction * length;
+					float cosSunGround = CosZenith(position, sunDirection);
+					Vec3 sunTransmittance = SampleTransmittance(0.0f, cosSunGround);
+					secondOrder += throughput * sunTransmittance * atmosphere.groundAlbedo * (std::max(cosSunGround, 0.0f) / Pi);
+				}
+			}
+			secondOrder *= 1.0f / directions.size();
+			transferFactor *= 1.0f / directions.size();
+
+			// a geometric series sums up all orders of scattering
+			float* texel = &m_multiScattering[4 * (y * size + x)];
+			for (int i = 0; i < 3; ++i) {
+				texel[i] = secondOrder[i] / (1.0f - std::min(transferFactor[i], 0.999f));
+			}
+			texel[3] = 1.0f;
+		}
+	}
+}
+
+
+void SkyLookupTables::ComputeSkyViewTable(const AtmosphereParams& atmosphere, float cosSunZenith, float viewHeight) {
+	const unsigned width = m_desc.skyViewWidth;
+	const unsigned height = m_desc.skyViewHeight;
+	Vec3 sunDirection(std::sqrt(std::max(0.0f, 1.0f - cosSunZenith * cosSunZenith)), 0.0f, cosSunZenith);
+
+	for (unsigned y = 0; y < height; ++y) {
+		float v = float(y) / (height - 1) * 2.0f - 1.0f;
+		float elevation = (v < 0.0f ? -v * v : v * v) * 0.5f * Pi;
+		for (unsigned x = 0; x < width; ++x) {
+			float azimuth = float(x) / (width - 1) * Pi;
+			Vec3 viewDirection(std::cos(elevation) * std::cos(azimuth), std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+			Vec3 luminance = ComputeSkyLuminance(atmosphere, viewHeight, viewDirection, sunDirection);
+			float* texel = &m_skyView[4 * (y * width + x)];
+			texel[0] = luminance.x();
+			texel[1] = luminance.y();
+			texel[2] = luminance.z();
+			texel[3] = 1.0f;
+		}
+	}
+}
+
+
+Vec3 SkyLookupTables::SampleTable(const std::vector<float>& table, unsigned width, unsigned height, float u, float v) const {
+	float x = std::clamp(u, 0.0f, 1.0f) * (width - 1);
+	float y = std::clamp(v, 0.0f, 1.0f) * (height - 1);
+	unsigned x0 = std::min((unsigned)x, width - 2);
+	unsigned y0 = std::min((unsigned)y, height - 2);
+	float fx = x - x0;
+	float fy = y - y0;
+
+	Vec3 result;
+	for (int i = 0; i < 3; ++i) {
+		float top = Lerp(table[4 * (y0 * width + x0) + i], table[4 * (y0 * width + x0 + 1) + i], fx);
+		float bottom = Lerp(table[4 * ((y0 + 1) * width + x0) + i], table[4 * ((y0 + 1) * width + x0 + 1) + i], fx);
+		result[i] = Lerp(top, bottom, fy);
+	}
+	return result;
+}
+
+
+bool SkyLookupTables::ParamsClose(const AtmosphereParams& lhs, const AtmosphereParams& rhs) const {
+	auto Close = [this](float a, float b) {
+		return std::abs(a - b) <= m_desc.parameterThreshold * std::max(std::abs(a), std::abs(b));
+	};
+	auto CloseVec = [&Close](const Vec3& a, const Vec3& b) {
+		return Close(a.x(), b.x()) && Close(a.y(), b.y()) && Close(a.z(), b.z());
+	};
+	return Close(lhs.planetRadius, rhs.planetRadius)
+		&& Close(lhs.atmosphereHeight, rhs.atmosphereHeight)
+		&& CloseVec(lhs.rayleighScattering, rhs.rayleighScattering)
+		&& Close(lhs.rayleighScaleHeight, rhs.rayleighScaleHeight)
+		&& Close(lhs.mieScattering, rhs.mieScattering)
+		&& Close(lhs.mieAbsorption, rhs.mieAbsorption)
+		&& Close(lhs.mieScaleHeight, rhs.mieScaleHeight)
+		&& Close(lhs.mieAnisotropy, rhs.mieAnisotropy)
+		&& Close(lhs.turbidity, rhs.turbidity)
+		&& CloseVec(lhs.ozoneAbsorption, rhs.ozoneAbsorption)
+		&& CloseVec(lhs.groundAlbedo, rhs.groundAlbedo);
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <mathfu/vector.h>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace inl::gxeng {
+
+
+/// <summary>
+/// Physical description of the atmosphere. Distances are in kilometers, coefficients in 1/km.
+/// The defaults describe a clear day on Earth.
+/// </summary>
+struct AtmosphereParams {
+	float planetRadius = 6360.0f;
+	float atmosphereHeight = 100.0f;
+
+	mathfu::Vector<float, 3> rayleighScattering = { 5.802e-3f, 13.558e-3f, 33.1e-3f };
+	float rayleighScaleHeight = 8.0f;
+
+	float mieScattering = 3.996e-3f;
+	float mieAbsorption = 4.4e-3f;
+	float mieScaleHeight = 1.2f;
+	/// <summary> Asymmetry of the Mie phase function, g in [-1, 1]. </summary>
+	float mieAnisotropy = 0.8f;
+	/// <summary> Multiplies the density of aerosols, 1 is a clear sky. </summary>
+	float turbidity = 1.0f;
+
+	/// <summary> Ozone absorbs with a tent shaped density around 25 km. </summary>
+	mathfu::Vector<float, 3> ozoneAbsorption = { 0.650e-3f, 1.881e-3f, 0.085e-3f };
+
+	mathfu::Vector<float, 3> groundAlbedo = { 0.3f, 0.3f, 0.3f };
+};
+
+
+/// <summary> Texel counts of the lookup tables and how much the inputs may drift before they are recomputed. </summary>
+struct SkyLookupTablesDesc {
+	unsigned transmittanceWidth = 256;
+	unsigned transmittanceHeight = 64;
+	unsigned multiScatteringSize = 32;
+	unsigned skyViewWidth = 192;
+	unsigned skyViewHeight = 108;
+
+	/// <summary> Radians the sun's elevation may change without recomputing the sky view. </summary>
+	float sunAngleThreshold = 0.002f;
+	/// <summary> Kilometers the viewer may move up or down without recomputing the sky view. </summary>
+	float viewHeightThreshold = 0.05f;
+	/// <summary> Relative change of any atmosphere parameter that recomputes all tables. </summary>
+	float parameterThreshold = 1e-3f;
+};
+
+
+enum class eSkyLutChange {
+	NONE,
+	SKY_VIEW,
+	ALL,
+};
+
+
+/// <summary>
+/// Transmittance, multi-scattering and sky-view lookup tables of an atmosphere, after Hillaire's
+/// "A Scalable and Production Ready Sky and Atmosphere Rendering Technique" (2020).
+/// <para />
+/// The tables are generated on the CPU and only when their inputs changed beyond the thresholds
+/// of the description, otherwise the cached tables are kept. Each table is an array of RGBA float texels,
+/// row by row, and is meant to be uploaded to a texture.
+/// </summary>
+/// <remarks>
+/// <para> Transmittance: u is the cosine of the view zenith angle mapped from [-1, 1], v is the square root of the
+/// relative height in the atmosphere. Rays that hit the ground have zero transmittance. </para>
+/// <para> Multi-scattering: u is the cosine of the sun zenith angle mapped from [-1, 1], v is the relative height.
+/// RGB is the luminance scattered more than once towards the viewer, per unit sun illuminance and scattering coefficient. </para>
+/// <para> Sky-view: u is the azimuth relative to the sun over [0, pi], the sky is symmetric around the sun.
+/// v is the elevation above the local horizon, v = 0.5 + 0.5*sign(e)*sqrt(|e|/(pi/2)), which puts more texels near the horizon.
+/// RGB is the sky luminance per unit sun illuminance. </para>
+/// <para> Texel i of a row is at u = i / (width - 1), and likewise for rows. The up direction is +Z. </para>
+/// </remarks>
+class SkyLookupTables {
+public:
+	SkyLookupTables(SkyLookupTablesDesc desc = {});
+
+	/// <summary> Recomputes the tables that depend on inputs which changed beyond the thresholds. </summary>
+	/// <param name="sunDirection"> Normalized direction pointing towards the sun. </param>
+	/// <param name="viewHeight"> Height of the viewer above the ground in kilometers. </param>
+	/// <returns> Which tables have been recomputed. The first call computes all of them. </returns>
+	eSkyLutChange Update(const AtmosphereParams& atmosphere, mathfu::Vector<float, 3> sunDirection, float viewHeight);
+
+	const SkyLookupTablesDesc& GetDesc() const { return m_desc; }
+	/// <summary> Incremented each time any table changes. </summary>
+	uint64_t GetVersion() const { return m_version; }
+
+	const std::vector<float>& GetTransmittance() const { return m_transmittance; }
+	const std::vector<float>& GetMultiScattering() const { return m_multiScattering; }
+	const std::vector<float>& GetSkyView() const { return m_skyView; }
+
+public:
+	/// <summary> Transmittance from a point at the given height towards the top of the atmosphere, by ray marching. </summary>
+	/// <param name="cosZenith"> Cosine of the angle between the ray and the up vector. </param>
+	static mathfu::Vector<float, 3> ComputeTransmittance(const AtmosphereParams& atmosphere, float height, float cosZenith);
+	/// <summary> Sky luminance per unit sun illuminance seen from a height in a direction, by ray marching.
+	///		Single scattering is computed, higher orders come from the multi-scattering table.
+	///		Uses the current transmittance and multi-scattering tables. </summary>
+	/// <param name="viewDirection"> Normalized direction of the view ray. </param>
+	/// <param name="sunDirection"> Normalized direction pointing towards the sun. </param>
+	mathfu::Vector<float, 3> ComputeSkyLuminance(const AtmosphereParams& atmosphere, float height, mathfu::Vector<float, 3> viewDirection, mathfu::Vector<float, 3> sunDirection) const;
+
+	mathfu::Vector<float, 3> SampleTransmittance(float height, float cosZenith) const;
+	mathfu::Vector<float, 3> SampleMultiScattering(float height, float cosSunZenith) const;
+
+	static float RayleighPhase(float cosTheta);
+	static float CornetteShanksPhase(float cosTheta, float g);
+
+private:
+	void ComputeTransmittanceTable(const AtmosphereParams& atmosphere);
+	void ComputeMultiScatteringTable(const AtmosphereParams& atmosphere);
+	void ComputeSkyViewTable(const AtmosphereParams& atmosphere, float cosSunZenith, float viewHeight);
+	mathfu::Vector<float, 3> SampleTable(const std::vector<float>& table, unsigned width, unsigned height, float u, float v) const;
+
+	bool ParamsClose(const AtmosphereParams& lhs, const AtmosphereParams& rhs) const;
+
+private:
+	SkyLookupTablesDesc m_desc;
+	uint64_t m_version = 0;
+
+	bool m_valid = false;
+	AtmosphereParams m_atmosphere;
+	float m_sunElevation = 0.0f;
+	float m_viewHeight = 0.0f;
+
+	std::vector<float> m_transmittance;
+	std::vector<float> m_multiScattering;
+	std::vector<float> m_skyView;
+};
+
+
+} // namespace inl::gxeng
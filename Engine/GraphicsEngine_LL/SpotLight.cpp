@@ -0,0 +1,66 @@
+#include "SpotLight.hpp"
+
+namespace inl::gxeng {
+
+
+SpotLight::SpotLight(mathfu::Vector3f position, mathfu::Vector3f direction, mathfu::Vector3f color, float range, float halfAngle
+):
+	m_position(position),
+	m_direction(direction.Normalized()),
+	m_color(color),
+	m_range(range),
+	m_halfAngle(halfAngle)
+{}
+
+
+void SpotLight::SetPosition(const mathfu::Vector3f& position) {
+	m_position = position;
+}
+
+
+void SpotLight::SetDirection(const mathfu::Vector3f& dir) {
+	m_direction = dir.Normalized();
+}
+
+
+void SpotLight::SetColor(const mathfu::Vector3f& color) {
+	m_color = color;
+}
+
+
+void SpotLight::SetRange(float range) {
+	m_range = range;
+}
+
+
+void SpotLight::SetHalfAngle(float halfAngle) {
+	m_halfAngle = halfAngle;
+}
+
+
+mathfu::Vector3f SpotLight::GetPosition() const {
+	return m_position;
+}
+
+
+mathfu::Vector3f SpotLight::GetDirection() const {
+	return m_direction;
+}
+
+
+mathfu::Vector3f SpotLight::GetColor() const {
+	return m_color;
+}
+
+
+float SpotLight::GetRange() const {
+	return m_range;
+}
+
+
+float SpotLight::GetHalfAngle() const {
+	return m_halfAngle;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <mathfu/mathfu_exc.hpp>
+
+namespace inl::gxeng {
+
+class SpotLight {
+public:
+	SpotLight() = default;
+	/// <param name="halfAngle"> Angle between the axis and the edge of the cone in radians. </param>
+	SpotLight(mathfu::Vector3f position, mathfu::Vector3f direction, mathfu::Vector3f color, float range, float halfAngle);
+
+	void SetPosition(const mathfu::Vector3f& position);
+	void SetDirection(const mathfu::Vector3f& dir);
+	void SetColor(const mathfu::Vector3f& color);
+	void SetRange(float range);
+	void SetHalfAngle(float halfAngle);
+
+	mathfu::Vector3f GetPosition() const;
+	mathfu::Vector3f GetDirection() const;
+	mathfu::Vector3f GetColor() const;
+	float GetRange() const;
+	float GetHalfAngle() const;
+
+protected:
+	mathfu::Vector3f m_position = { 0, 0, 0 };
+	mathfu::Vector3f m_direction = { 0, 0, -1 };
+	mathfu::Vector3f m_color = { 1, 1, 1 };
+	float m_range = 1.0f;
+	float m_halfAngle = 0.5f;
+};
+
+} // namespace inl::gxeng
@@ -21,7 +21,7 @@ gxapi::DescriptorHandle DescriptorArrayRef::Get(uint32_t position) {
 		throw gxapi::OutOfRange("Requested scratch space descriptor is out of allocation range!");
 	}
 
-	return m_home->m_heap->At(m_pos + position);
+	return m_home->m_heap->At(m_home->m_offset + m_pos + position);
 }
 
 
@@ -46,12 +46,25 @@ DescriptorArrayRef::DescriptorArrayRef(StackDescHeap* home, uint32_t pos, uint32
 
 
 StackDescHeap::StackDescHeap(gxapi::IGraphicsApi* graphicsApi, gxapi::eDescriptorHeapType type, uint32_t size) :
+	m_offset(0),
 	m_size(size),
 	m_next(0)
 {
 	assert(type == gxapi::eDescriptorHeapType::CBV_SRV_UAV || type == gxapi::eDescriptorHeapType::SAMPLER);
 	gxapi::DescriptorHeapDesc desc(type, size, true);
-	m_heap.reset(graphicsApi->CreateDescriptorHeap(desc));
+	m_ownedHeap.reset(graphicsApi->CreateDescriptorHeap(desc));
+	m_heap = m_ownedHeap.get();
+}
+
+
+StackDescHeap::StackDescHeap(gxapi::IDescriptorHeap* sharedHeap, uint32_t offset, uint32_t size) :
+	m_heap(sharedHeap),
+	m_offset(offset),
+	m_size(size),
+	m_next(0)
+{
+	assert(sharedHeap != nullptr && sharedHeap->GetDesc().isShaderVisible);
+	assert(offset + size <= sharedHeap->GetDesc().numDescriptors);
 }
 
 
@@ -54,6 +54,8 @@ class StackDescHeap {
 	friend class DescriptorArrayRef;
 public:
 	StackDescHeap(gxapi::IGraphicsApi* graphicsApi, gxapi::eDescriptorHeapType type, uint32_t size);
+	/// <summary> Allocates from a range of a shader visible heap that is owned by someone else. </summary>
+	StackDescHeap(gxapi::IDescriptorHeap* sharedHeap, uint32_t offset, uint32_t size);
 
 	DescriptorArrayRef Allocate(uint32_t size);
 
@@ -62,9 +64,11 @@ public:
 	/// </summary>
 	void Reset();
 
-	gxapi::IDescriptorHeap* GetHeap() const { return m_heap.get(); }
+	gxapi::IDescriptorHeap* GetHeap() const { return m_heap; }
 protected:
-	std::unique_ptr<gxapi::IDescriptorHeap> m_heap;
+	std::unique_ptr<gxapi::IDescriptorHeap> m_ownedHeap;
+	gxapi::IDescriptorHeap* m_heap;
+	uint32_t m_offset;
 	uint32_t m_size;
 	uint32_t m_next;
 };
@@ -12,12 +12,18 @@ namespace gxeng {
 
 class CommandQueue;
 class ResourceResidencyQueue;
+class PipelineProfiler;
+class CommandListCache;
+namespace impl { class CommandAllocatorPoolBase; }
 
 
 
 class SyncPoint {
 	friend class inl::gxeng::CommandQueue;
 	friend class inl::gxeng::ResourceResidencyQueue;
+	friend class inl::gxeng::impl::CommandAllocatorPoolBase;
+	friend class inl::gxeng::PipelineProfiler;
+	friend class inl::gxeng::CommandListCache;
 public:
 	SyncPoint() : m_value(0) {}
 	SyncPoint(std::shared_ptr<gxapi::IFence> fence, uint64_t value)
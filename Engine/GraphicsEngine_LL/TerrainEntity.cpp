@@ -0,0 +1,72 @@
+#include "TerrainEntity.hpp"
+
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+TerrainEntity::TerrainEntity()
+	: m_position(0, 0, 0),
+	m_materialColors{ { 0.5f, 0.5f, 0.5f } }
+{}
+
+
+void TerrainEntity::SetTileSource(ITerrainTileSource* source) {
+	m_streamer.reset();
+	m_source = source;
+	if (m_source != nullptr) {
+		m_streamer = std::make_unique<TerrainTileStreamer>(m_source, m_tileCapacity);
+	}
+	++m_version;
+}
+ITerrainTileSource* TerrainEntity::GetTileSource() const {
+	return m_source;
+}
+
+
+void TerrainEntity::SetPosition(mathfu::Vector<float, 3> position) {
+	m_position = position;
+}
+mathfu::Vector<float, 3> TerrainEntity::GetPosition() const {
+	return m_position;
+}
+
+
+void TerrainEntity::SetPixelErrorThreshold(float pixels) {
+	m_pixelErrorThreshold = pixels;
+}
+float TerrainEntity::GetPixelErrorThreshold() const {
+	return m_pixelErrorThreshold;
+}
+
+
+void TerrainEntity::SetTileCapacity(size_t capacity) {
+	m_tileCapacity = capacity;
+}
+size_t TerrainEntity::GetTileCapacity() const {
+	return m_tileCapacity;
+}
+
+
+void TerrainEntity::SetMaterialColors(std::vector<mathfu::Vector<float, 3>> colors) {
+	if (colors.empty() || colors.size() > MaxMaterials) {
+		throw std::invalid_argument("Terrain needs between 1 and 16 material colors.");
+	}
+	m_materialColors = std::move(colors);
+}
+const std::vector<mathfu::Vector<float, 3>>& TerrainEntity::GetMaterialColors() const {
+	return m_materialColors;
+}
+
+
+TerrainTileStreamer* TerrainEntity::GetStreamer() const {
+	return m_streamer.get();
+}
+
+uint64_t TerrainEntity::GetVersion() const {
+	return m_version;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <GraphicsEngine/ITerrainEntity.hpp>
+
+#include "TerrainTile.hpp"
+#include "TerrainTileStreamer.hpp"
+
+#include <mathfu/vector.h>
+
+#include <memory>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary>
+/// Terrain drawn from a quadtree of height field tiles streamed from a tile source.
+/// <para />
+/// Tiles are refined by their screen space error, neighbouring tiles differ by at most one level
+/// and their edges are stitched, so the surface has no cracks.
+/// The material index of each sample selects a color from the entity's material colors.
+/// </summary>
+class TerrainEntity : public ITerrainEntity {
+public:
+	static constexpr unsigned MaxMaterials = 16;
+
+	TerrainEntity();
+
+	/// <exception cref="std::invalid_argument"> If the source's desc is invalid. </exception>
+	void SetTileSource(ITerrainTileSource* source) override;
+	ITerrainTileSource* GetTileSource() const override;
+
+	void SetPosition(mathfu::Vector<float, 3> position) override;
+	mathfu::Vector<float, 3> GetPosition() const override;
+
+	void SetPixelErrorThreshold(float pixels) override;
+	float GetPixelErrorThreshold() const override;
+
+	/// <summary> The most tiles kept in memory, takes effect with the next tile source. </summary>
+	void SetTileCapacity(size_t capacity);
+	size_t GetTileCapacity() const;
+
+	/// <exception cref="std::invalid_argument"> If there are no colors or more than <see cref="MaxMaterials"/>. </exception>
+	void SetMaterialColors(std::vector<mathfu::Vector<float, 3>> colors);
+	const std::vector<mathfu::Vector<float, 3>>& GetMaterialColors() const;
+
+	/// <summary> Streams the tiles of the current source, null if there is no source. </summary>
+	TerrainTileStreamer* GetStreamer() const;
+	/// <summary> Incremented each time the tile source changes. </summary>
+	uint64_t GetVersion() const;
+
+private:
+	ITerrainTileSource* m_source = nullptr;
+	std::unique_ptr<TerrainTileStreamer> m_streamer;
+	size_t m_tileCapacity = 512;
+	uint64_t m_version = 0;
+
+	mathfu::Vector<float, 3> m_position;
+	float m_pixelErrorThreshold = 2.0f;
+	std::vector<mathfu::Vector<float, 3>> m_materialColors;
+};
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,245 @@
+#include "TerrainLod.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+
+namespace inl::gxeng {
+
+
+using Vec3 = mathfu::Vector<float, 3>;
+using LeafMap = std::unordered_map<TerrainTileKey, const TerrainTile*>;
+
+
+//------------------------------------------------------------------------------
+// Level of detail selection
+//------------------------------------------------------------------------------
+
+float GetTerrainScreenError(const TerrainDesc& desc, const TerrainTileKey& key, const TerrainTile& tile, const TerrainLodParams& params) {
+	float tileSize = desc.GetTileSize(key.level);
+	Vec3 minimum(key.x * tileSize, key.y * tileSize, tile.minHeight);
+	Vec3 maximum(minimum.x() + tileSize, minimum.y() + tileSize, tile.maxHeight);
+	Vec3 closest = Vec3::Max(minimum, Vec3::Min(params.cameraPosition, maximum));
+	float distance = (closest - params.cameraPosition).Length();
+	if (distance <= 0.0f) {
+		return std::numeric_limits<float>::infinity();
+	}
+	return tile.geometricError * params.projectionScale / distance;
+}
+
+
+static void Refine(TerrainTileStreamer& streamer, const TerrainLodParams& params, const TerrainTileKey& key, const TerrainTile* tile, LeafMap& leaves) {
+	const TerrainDesc& desc = streamer.GetDesc();
+	if (key.level + 1 < desc.numLevels && GetTerrainScreenError(desc, key, *tile, params) > params.pixelErrorThreshold) {
+		const TerrainTile* children[4];
+		bool resident = true;
+		for (unsigned i = 0; i < 4; ++i) {
+			children[i] = streamer.Find(key.GetChild(i));
+			if (children[i] == nullptr) {
+				streamer.Request(key.GetChild(i));
+				resident = false;
+			}
+		}
+		if (resident) {
+			for (unsigned i = 0; i < 4; ++i) {
+				Refine(streamer, params, key.GetChild(i), children[i], leaves);
+			}
+			return;
+		}
+	}
+	leaves[key] = tile;
+}
+
+
+static bool GetNeighbour(const TerrainDesc& desc, const TerrainTileKey& key, unsigned side, TerrainTileKey& neighbour) {
+	const unsigned numTiles = desc.GetNumTiles(key.level);
+	neighbour = key;
+	switch (side) {
+		case 0: if (key.x == 0) return false; --neighbour.x; break;
+		case 1: if (key.x + 1 == numTiles) return false; ++neighbour.x; break;
+		case 2: if (key.y == 0) return false; --neighbour.y; break;
+		case 3: if (key.y + 1 == numTiles) return false; ++neighbour.y; break;
+	}
+	return true;
+}
+
+
+/// <summary> The leaf that covers the given tile, if it is at the same level or coarser. </summary>
+static LeafMap::iterator FindCoveringLeaf(LeafMap& leaves, const TerrainTileKey& key) {
+	for (unsigned level = key.level + 1; level-- > 0;) {
+		auto it = leaves.find(key.GetAncestor(level));
+		if (it != leaves.end()) {
+			return it;
+		}
+	}
+	return leaves.end();
+}
+
+
+static void EraseSubtree(LeafMap& leaves, const TerrainTileKey& key, unsigned numLevels) {
+	if (leaves.erase(key) > 0 || key.level + 1 >= numLevels) {
+		return;
+	}
+	for (unsigned i = 0; i < 4; ++i) {
+		EraseSubtree(leaves, key.GetChild(i), numLevels);
+	}
+}
+
+
+/// <summary> Splits or merges leaves until neighbours differ by at most one level. </summary>
+static void Balance(TerrainTileStreamer& streamer, LeafMap& leaves) {
+	const TerrainDesc& desc = streamer.GetDesc();
+	std::vector<TerrainTileKey> keys;
+
+	// splits and merges may in rare cases undo each other, the pass limit keeps that from going forever
+	bool changed = true;
+	for (unsigned pass = 0; changed && pass < 4 * desc.numLevels; ++pass) {
+		changed = false;
+		keys.clear();
+		for (const auto& leaf : leaves) {
+			keys.push_back(leaf.first);
+		}
+		std::sort(keys.begin(), keys.end(), [](const TerrainTileKey& lhs, const TerrainTileKey& rhs) { return lhs.level > rhs.level; });
+
+		for (const TerrainTileKey& key : keys) {
+			if (leaves.count(key) == 0) {
+				continue;
+			}
+			for (unsigned side = 0; side < 4; ++side) {
+				TerrainTileKey neighbourKey;
+				if (!GetNeighbour(desc, key, side, neighbourKey)) {
+					continue;
+				}
+				auto neighbour = FindCoveringLeaf(leaves, neighbourKey);
+				if (neighbour == leaves.end() || neighbour->first.level + 1 >= key.level) {
+					continue;
+				}
+
+				// prefer refining the coarse neighbour, fall back to coarsening this side until its children arrive
+				TerrainTileKey coarseKey = neighbour->first;
+				const TerrainTile* children[4];
+				bool resident = true;
+				for (unsigned i = 0; i < 4; ++i) {
+					children[i] = streamer.Find(coarseKey.GetChild(i));
+					if (children[i] == nullptr) {
+						streamer.Request(coarseKey.GetChild(i));
+						resident = false;
+					}
+				}
+				if (resident) {
+					leaves.erase(neighbour);
+					for (unsigned i = 0; i < 4; ++i) {
+						leaves[coarseKey.GetChild(i)] = children[i];
+					}
+				}
+				else {
+					TerrainTileKey parentKey = key.GetParent();
+					EraseSubtree(leaves, parentKey, desc.numLevels);
+					leaves[parentKey] = streamer.Find(parentKey);
+				}
+				changed = true;
+				break;
+			}
+		}
+	}
+}
+
+
+void SelectTerrainPatches(TerrainTileStreamer& streamer, const TerrainLodParams& params, std::vector<TerrainPatch>& patches) {
+	patches.clear();
+
+	const TerrainDesc& desc = streamer.GetDesc();
+	const TerrainTileKey rootKey{ 0, 0, 0 };
+	const TerrainTile* root = streamer.Find(rootKey);
+	if (root == nullptr) {
+		streamer.Request(rootKey);
+		return;
+	}
+
+	LeafMap leaves;
+	Refine(streamer, params, rootKey, root, leaves);
+	Balance(streamer, leaves);
+
+	static constexpr unsigned EdgeFlags[4] = {
+		(unsigned)eTerrainEdge::NEG_X,
+		(unsigned)eTerrainEdge::POS_X,
+		(unsigned)eTerrainEdge::NEG_Y,
+		(unsigned)eTerrainEdge::POS_Y,
+	};
+	for (const auto& leaf : leaves) {
+		TerrainPatch patch;
+		patch.key = leaf.first;
+		patch.tile = leaf.second;
+		patch.coarserEdges = 0;
+		for (unsigned side = 0; side < 4; ++side) {
+			TerrainTileKey neighbourKey;
+			if (GetNeighbour(desc, leaf.first, side, neighbourKey) && leaves.count(neighbourKey) == 0 && leaves.count(neighbourKey.GetParent()) > 0) {
+				patch.coarserEdges |= EdgeFlags[side];
+			}
+		}
+		patches.push_back(patch);
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Mesh generation
+//------------------------------------------------------------------------------
+
+std::vector<uint32_t> BuildTerrainPatchIndices(unsigned tileResolution, unsigned coarserEdges) {
+	const unsigned last = tileResolution - 1;
+	auto Index = [&](unsigned x, unsigned y) {
+		if ((coarserEdges & (unsigned)eTerrainEdge::NEG_X) && x == 0 && (y & 1)) --y;
+		if ((coarserEdges & (unsigned)eTerrainEdge::POS_X) && x == last && (y & 1)) --y;
+		if ((coarserEdges & (unsigned)eTerrainEdge::NEG_Y) && y == 0 && (x & 1)) --x;
+		if ((coarserEdges & (unsigned)eTerrainEdge::POS_Y) && y == last && (x & 1)) --x;
+		return y * tileResolution + x;
+	};
+
+	std::vector<uint32_t> indices;
+	indices.reserve(size_t(last) * last * 6);
+	auto AddTriangle = [&indices](uint32_t a, uint32_t b, uint32_t c) {
+		// collapsed vertices leave degenerate triangles behind
+		if (a != b && b != c && c != a) {
+			indices.insert(indices.end(), { a, b, c });
+		}
+	};
+	for (unsigned y = 0; y < last; ++y) {
+		for (unsigned x = 0; x < last; ++x) {
+			uint32_t v00 = Index(x, y), v10 = Index(x + 1, y), v01 = Index(x, y + 1), v11 = Index(x + 1, y + 1);
+			AddTriangle(v00, v10, v11);
+			AddTriangle(v00, v11, v01);
+		}
+	}
+	return indices;
+}
+
+
+void BuildTerrainPatchVertices(const TerrainDesc& desc, const TerrainTileKey& key, const TerrainTile& tile, std::vector<TerrainVertex>& vertices) {
+	const unsigned resolution = desc.tileResolution;
+	const float tileSize = desc.GetTileSize(key.level);
+	const float spacing = tileSize / (resolution - 1);
+	auto Height = [&](unsigned x, unsigned y) { return tile.heights[size_t(y) * resolution + x]; };
+
+	vertices.resize(size_t(resolution) * resolution);
+	for (unsigned y = 0; y < resolution; ++y) {
+		for (unsigned x = 0; x < resolution; ++x) {
+			// central differences inside, one sided on the edges
+			unsigned left = x > 0 ? x - 1 : x, right = x + 1 < resolution ? x + 1 : x;
+			unsigned bottom = y > 0 ? y - 1 : y, top = y + 1 < resolution ? y + 1 : y;
+			float dhdx = (Height(right, y) - Height(left, y)) / ((right - left) * spacing);
+			float dhdy = (Height(x, top) - Height(x, bottom)) / ((top - bottom) * spacing);
+
+			size_t index = size_t(y) * resolution + x;
+			TerrainVertex& vertex = vertices[index];
+			vertex.position = Vec3(key.x * tileSize + x * spacing, key.y * tileSize + y * spacing, tile.heights[index]);
+			vertex.normal = Vec3(-dhdx, -dhdy, 1.0f).Normalized();
+			vertex.material = tile.materials.empty() ? 0 : tile.materials[index];
+		}
+	}
+}
+
+
+} // namespace inl::gxeng
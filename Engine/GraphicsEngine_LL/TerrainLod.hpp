@@ -0,0 +1,77 @@
+#pragma once
+
+#include "TerrainTile.hpp"
+#include "TerrainTileStreamer.hpp"
+
+#include <mathfu/vector.h>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Edges of a tile, combined as bit flags. </summary>
+enum class eTerrainEdge : unsigned {
+	NEG_X = 1,
+	POS_X = 2,
+	NEG_Y = 4,
+	POS_Y = 8,
+};
+
+
+/// <summary> A tile selected for drawing. </summary>
+struct TerrainPatch {
+	TerrainTileKey key;
+	const TerrainTile* tile;
+	/// <summary> Edges where the neighbouring patch is one level coarser, see <see cref="eTerrainEdge"/>. </summary>
+	unsigned coarserEdges;
+};
+
+
+struct TerrainLodParams {
+	/// <summary> Relative to the terrain's position. </summary>
+	mathfu::Vector<float, 3> cameraPosition;
+	/// <summary> Pixels covered by a unit length at unit distance from the camera: viewportHeight / (2*tan(fovY/2)). </summary>
+	float projectionScale;
+	float pixelErrorThreshold = 2.0f;
+};
+
+
+/// <summary>
+/// Selects the tiles to draw so that their projected geometric error is below the threshold.
+/// Tiles are only refined if all four children are resident, missing ones are requested from the streamer.
+/// </summary>
+/// <remarks>
+/// Neighbouring patches differ by at most one level, so coarser edges can be stitched without cracks.
+/// Nothing is selected until the root tile is resident.
+/// </remarks>
+void SelectTerrainPatches(TerrainTileStreamer& streamer, const TerrainLodParams& params, std::vector<TerrainPatch>& patches);
+
+
+/// <summary> Projected error of drawing the tile instead of its children, in pixels. </summary>
+float GetTerrainScreenError(const TerrainDesc& desc, const TerrainTileKey& key, const TerrainTile& tile, const TerrainLodParams& params);
+
+
+/// <summary>
+/// Triangle list over the tileResolution^2 grid of a tile, counter clockwise looking down from +Z.
+/// Odd vertices of coarser edges are collapsed onto their even neighbours, so the edge matches the coarser neighbour.
+/// </summary>
+/// <param name="coarserEdges"> Combination of <see cref="eTerrainEdge"/> flags. </param>
+std::vector<uint32_t> BuildTerrainPatchIndices(unsigned tileResolution, unsigned coarserEdges);
+
+
+struct TerrainVertex {
+	/// <summary> Relative to the terrain's position. </summary>
+	mathfu::VectorPacked<float, 3> position;
+	mathfu::VectorPacked<float, 3> normal;
+	uint32_t material;
+};
+
+
+/// <summary> Vertices of a tile's grid, in the same order as the tile's samples. </summary>
+void BuildTerrainPatchVertices(const TerrainDesc& desc, const TerrainTileKey& key, const TerrainTile& tile, std::vector<TerrainVertex>& vertices);
+
+
+} // namespace inl::gxeng
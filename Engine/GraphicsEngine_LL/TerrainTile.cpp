@@ -0,0 +1,231 @@
+#include "TerrainTile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+
+namespace inl::gxeng {
+
+
+static constexpr uint32_t DescMagic = 0x43534454; // "TDSC"
+static constexpr uint32_t TileMagic = 0x4C495454; // "TTIL"
+
+
+void TerrainDesc::Validate() const {
+	if (numLevels == 0 || numLevels > 24) {
+		throw std::invalid_argument("Terrain must have between 1 and 24 levels.");
+	}
+	if (tileResolution < 3 || ((tileResolution - 1) & (tileResolution - 2)) != 0) {
+		throw std::invalid_argument("Terrain tile resolution must be 2^k+1.");
+	}
+	if (!(size > 0.0f)) {
+		throw std::invalid_argument("Terrain size must be positive.");
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// File source
+//------------------------------------------------------------------------------
+
+TerrainTileFileSource::TerrainTileFileSource(std::string directory)
+	: m_directory(std::move(directory))
+{
+	std::ifstream file(m_directory + "/terrain.desc", std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("Terrain desc file not found in " + m_directory + ".");
+	}
+
+	uint32_t magic = 0;
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&m_desc.numLevels), sizeof(m_desc.numLevels));
+	file.read(reinterpret_cast<char*>(&m_desc.tileResolution), sizeof(m_desc.tileResolution));
+	file.read(reinterpret_cast<char*>(&m_desc.size), sizeof(m_desc.size));
+	if (!file || magic != DescMagic) {
+		throw std::runtime_error("Terrain desc file in " + m_directory + " is malformed.");
+	}
+	try {
+		m_desc.Validate();
+	}
+	catch (std::invalid_argument& ex) {
+		throw std::runtime_error("Terrain desc file in " + m_directory + " is malformed: " + ex.what());
+	}
+}
+
+
+const TerrainDesc& TerrainTileFileSource::GetDesc() const {
+	return m_desc;
+}
+
+
+bool TerrainTileFileSource::LoadTile(const TerrainTileKey& key, TerrainTile& tile) {
+	std::ifstream file(GetTilePath(m_directory, key), std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	uint32_t magic = 0;
+	uint32_t resolution = 0;
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&resolution), sizeof(resolution));
+	if (!file || magic != TileMagic || resolution != m_desc.tileResolution) {
+		throw std::runtime_error("Terrain tile file " + GetTilePath(m_directory, key) + " is malformed.");
+	}
+
+	size_t numSamples = size_t(resolution) * resolution;
+	tile.heights.resize(numSamples);
+	tile.materials.resize(numSamples);
+	file.read(reinterpret_cast<char*>(&tile.minHeight), sizeof(tile.minHeight));
+	file.read(reinterpret_cast<char*>(&tile.maxHeight), sizeof(tile.maxHeight));
+	file.read(reinterpret_cast<char*>(&tile.geometricError), sizeof(tile.geometricError));
+	file.read(reinterpret_cast<char*>(tile.heights.data()), numSamples * sizeof(float));
+	file.read(reinterpret_cast<char*>(tile.materials.data()), numSamples * sizeof(uint8_t));
+	if (!file) {
+		throw std::runtime_error("Terrain tile file " + GetTilePath(m_directory, key) + " is truncated.");
+	}
+	return true;
+}
+
+
+void TerrainTileFileSource::WriteDesc(const std::string& directory, const TerrainDesc& desc) {
+	desc.Validate();
+
+	std::ofstream file(directory + "/terrain.desc", std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&DescMagic), sizeof(DescMagic));
+	file.write(reinterpret_cast<const char*>(&desc.numLevels), sizeof(desc.numLevels));
+	file.write(reinterpret_cast<const char*>(&desc.tileResolution), sizeof(desc.tileResolution));
+	file.write(reinterpret_cast<const char*>(&desc.size), sizeof(desc.size));
+	if (!file) {
+		throw std::runtime_error("Could not write terrain desc file to " + directory + ".");
+	}
+}
+
+
+void TerrainTileFileSource::WriteTile(const std::string& directory, const TerrainTileKey& key, const TerrainTile& tile) {
+	uint32_t resolution = (uint32_t)std::lround(std::sqrt((double)tile.heights.size()));
+	if (size_t(resolution) * resolution != tile.heights.size() || tile.materials.size() != tile.heights.size()) {
+		throw std::invalid_argument("Terrain tile heights and materials must be square grids of the same size.");
+	}
+
+	std::ofstream file(GetTilePath(directory, key), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&TileMagic), sizeof(TileMagic));
+	file.write(reinterpret_cast<const char*>(&resolution), sizeof(resolution));
+	file.write(reinterpret_cast<const char*>(&tile.minHeight), sizeof(tile.minHeight));
+	file.write(reinterpret_cast<const char*>(&tile.maxHeight), sizeof(tile.maxHeight));
+	file.write(reinterpret_cast<const char*>(&tile.geometricError), sizeof(tile.geometricError));
+	file.write(reinterpret_cast<const char*>(tile.heights.data()), tile.heights.size() * sizeof(float));
+	file.write(reinterpret_cast<const char*>(tile.materials.data()), tile.materials.size() * sizeof(uint8_t));
+	if (!file) {
+		throw std::runtime_error("Could not write terrain tile file " + GetTilePath(directory, key) + ".");
+	}
+}
+
+
+std::string TerrainTileFileSource::GetTilePath(const std::string& directory, const TerrainTileKey& key) {
+	return directory + "/" + std::to_string(key.level) + "_" + std::to_string(key.x) + "_" + std::to_string(key.y) + ".tile";
+}
+
+
+//------------------------------------------------------------------------------
+// Building tiles
+//------------------------------------------------------------------------------
+
+void BuildTerrainTiles(const TerrainDesc& desc,
+					   const float* heights,
+					   const uint8_t* materials,
+					   const std::function<void(const TerrainTileKey&, TerrainTile&&)>& sink)
+{
+	desc.Validate();
+
+	const size_t fieldResolution = desc.GetHeightFieldResolution();
+	const unsigned cells = desc.tileResolution - 1;
+	auto Height = [&](size_t x, size_t y) { return heights[y * fieldResolution + x]; };
+
+	// errors of each level, tile index is y * numTiles + x
+	std::vector<std::vector<float>> errors(desc.numLevels);
+	for (unsigned level = 0; level < desc.numLevels; ++level) {
+		const unsigned numTiles = desc.GetNumTiles(level);
+		const size_t stride = size_t(1) << (desc.numLevels - 1 - level);
+		errors[level].assign(size_t(numTiles) * numTiles, 0.0f);
+		if (stride == 1) {
+			continue;
+		}
+
+		// compare every sample of the field to the bilinear interpolation of this level's samples around it
+		for (size_t y = 0; y < fieldResolution; ++y) {
+			size_t y0 = std::min(y / stride * stride, fieldResolution - 1 - stride);
+			float fy = float(y - y0) / stride;
+			for (size_t x = 0; x < fieldResolution; ++x) {
+				size_t x0 = std::min(x / stride * stride, fieldResolution - 1 - stride);
+				float fx = float(x - x0) / stride;
+				float bottom = Height(x0, y0) * (1.0f - fx) + Height(x0 + stride, y0) * fx;
+				float top = Height(x0, y0 + stride) * (1.0f - fx) + Height(x0 + stride, y0 + stride) * fx;
+				float error = std::abs(bottom * (1.0f - fy) + top * fy - Height(x, y));
+
+				// samples on the edge between tiles count for both of them
+				size_t tileSpan = stride * cells;
+				size_t lastTileX = std::min<size_t>(x / tileSpan, numTiles - 1);
+				size_t lastTileY = std::min<size_t>(y / tileSpan, numTiles - 1);
+				size_t firstTileX = x % tileSpan == 0 && x > 0 ? x / tileSpan - 1 : lastTileX;
+				size_t firstTileY = y % tileSpan == 0 && y > 0 ? y / tileSpan - 1 : lastTileY;
+				for (size_t tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+					for (size_t tileX = firstTileX; tileX <= lastTileX; ++tileX) {
+						float& tileError = errors[level][tileY * numTiles + tileX];
+						tileError = std::max(tileError, error);
+					}
+				}
+			}
+		}
+	}
+
+	// a tile is never more accurate than its children, so refinement is never pointless
+	for (unsigned level = desc.numLevels - 1; level-- > 0;) {
+		const unsigned numTiles = desc.GetNumTiles(level);
+		for (unsigned y = 0; y < numTiles; ++y) {
+			for (unsigned x = 0; x < numTiles; ++x) {
+				for (unsigned child = 0; child < 4; ++child) {
+					TerrainTileKey childKey = TerrainTileKey{ level, x, y }.GetChild(child);
+					float childError = errors[level + 1][size_t(childKey.y) * (2 * numTiles) + childKey.x];
+					errors[level][size_t(y) * numTiles + x] = std::max(errors[level][size_t(y) * numTiles + x], childError);
+				}
+			}
+		}
+	}
+
+	for (unsigned level = desc.numLevels; level-- > 0;) {
+		const unsigned numTiles = desc.GetNumTiles(level);
+		const size_t stride = size_t(1) << (desc.numLevels - 1 - level);
+		for (unsigned tileY = 0; tileY < numTiles; ++tileY) {
+			for (unsigned tileX = 0; tileX < numTiles; ++tileX) {
+				TerrainTile tile;
+				tile.heights.resize(size_t(desc.tileResolution) * desc.tileResolution);
+				tile.materials.resize(tile.heights.size(), 0);
+				tile.minHeight = std::numeric_limits<float>::max();
+				tile.maxHeight = std::numeric_limits<float>::lowest();
+				tile.geometricError = errors[level][size_t(tileY) * numTiles + tileX];
+
+				for (unsigned y = 0; y < desc.tileResolution; ++y) {
+					size_t fieldY = (size_t(tileY) * cells + y) * stride;
+					for (unsigned x = 0; x < desc.tileResolution; ++x) {
+						size_t fieldX = (size_t(tileX) * cells + x) * stride;
+						size_t index = size_t(y) * desc.tileResolution + x;
+						tile.heights[index] = Height(fieldX, fieldY);
+						if (materials) {
+							tile.materials[index] = materials[fieldY * fieldResolution + fieldX];
+						}
+						tile.minHeight = std::min(tile.minHeight, tile.heights[index]);
+						tile.maxHeight = std::max(tile.maxHeight, tile.heights[index]);
+					}
+				}
+
+				sink({ level, tileX, tileY }, std::move(tile));
+			}
+		}
+	}
+}
+
+
+} // namespace inl::gxeng
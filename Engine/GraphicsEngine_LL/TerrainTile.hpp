@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary>
+/// Layout of a terrain's tile pyramid.
+/// Level 0 is a single tile covering the whole terrain, each next level splits the tiles of the previous into four.
+/// </summary>
+struct TerrainDesc {
+	unsigned numLevels = 1;
+	/// <summary> Vertices along the edge of a tile, must be 2^k+1. Neighbouring tiles share their edge vertices. </summary>
+	unsigned tileResolution = 65;
+	/// <summary> Edge length of the whole terrain in world units. </summary>
+	float size = 1024.0f;
+
+	/// <summary> Number of tiles along one axis on the given level. </summary>
+	unsigned GetNumTiles(unsigned level) const { return 1u << level; }
+	float GetTileSize(unsigned level) const { return size / GetNumTiles(level); }
+	/// <summary> Samples along the edge of the height field at the finest level. </summary>
+	unsigned GetHeightFieldResolution() const { return ((tileResolution - 1) << (numLevels - 1)) + 1; }
+
+	/// <exception cref="std::invalid_argument"> If any of the members is out of range. </exception>
+	void Validate() const;
+};
+
+
+struct TerrainTileKey {
+	unsigned level = 0;
+	unsigned x = 0;
+	unsigned y = 0;
+
+	bool operator==(const TerrainTileKey& rhs) const { return level == rhs.level && x == rhs.x && y == rhs.y; }
+	bool operator!=(const TerrainTileKey& rhs) const { return !(*this == rhs); }
+
+	TerrainTileKey GetParent() const { return { level - 1, x / 2, y / 2 }; }
+	/// <param name="index"> Bit 0 selects +X, bit 1 selects +Y. </param>
+	TerrainTileKey GetChild(unsigned index) const { return { level + 1, 2 * x + (index & 1), 2 * y + (index >> 1) }; }
+	/// <summary> The tile on the given level that covers this one. </summary>
+	TerrainTileKey GetAncestor(unsigned ancestorLevel) const { return { ancestorLevel, x >> (level - ancestorLevel), y >> (level - ancestorLevel) }; }
+};
+
+
+/// <summary> Height field and material layer indices of one tile, sampled on a tileResolution^2 grid. </summary>
+struct TerrainTile {
+	/// <summary> Row major, rows go along +X, consecutive rows along +Y. </summary>
+	std::vector<float> heights;
+	std::vector<uint8_t> materials;
+	float minHeight = 0.0f;
+	float maxHeight = 0.0f;
+	/// <summary> Largest height difference between this tile and the finest level over the tile's area. </summary>
+	/// <remarks> Never smaller than the error of the tile's children. </remarks>
+	float geometricError = 0.0f;
+};
+
+
+/// <summary> Provides the tiles of a terrain. </summary>
+class ITerrainTileSource {
+public:
+	virtual ~ITerrainTileSource() = default;
+
+	virtual const TerrainDesc& GetDesc() const = 0;
+
+	/// <returns> False if the tile does not exist. </returns>
+	/// <remarks> Called from a background thread, but never concurrently. </remarks>
+	virtual bool LoadTile(const TerrainTileKey& key, TerrainTile& tile) = 0;
+};
+
+
+/// <summary>
+/// Reads tiles from a directory, each tile in a file of its own.
+/// The directory holds terrain.desc and a level_x_y.tile file for each tile, written by the Write methods.
+/// </summary>
+class TerrainTileFileSource : public ITerrainTileSource {
+public:
+	/// <exception cref="std::runtime_error"> If the desc file is missing or malformed. </exception>
+	TerrainTileFileSource(std::string directory);
+
+	const TerrainDesc& GetDesc() const override;
+
+	/// <exception cref="std::runtime_error"> If the tile file is malformed. </exception>
+	bool LoadTile(const TerrainTileKey& key, TerrainTile& tile) override;
+
+	static void WriteDesc(const std::string& directory, const TerrainDesc& desc);
+	static void WriteTile(const std::string& directory, const TerrainTileKey& key, const TerrainTile& tile);
+private:
+	static std::string GetTilePath(const std::string& directory, const TerrainTileKey& key);
+
+	std::string m_directory;
+	TerrainDesc m_desc;
+};
+
+
+/// <summary>
+/// Cuts a height field into the tiles of every level of the pyramid.
+/// Coarser levels take every 2nd, 4th, ... sample, so edge vertices of neighbouring levels coincide.
+/// </summary>
+/// <param name="heights"> GetHeightFieldResolution()^2 samples, same layout as the tiles. </param>
+/// <param name="materials"> Same layout as the heights, may be null. </param>
+/// <param name="sink"> Receives the tiles from the finest level to the root. </param>
+void BuildTerrainTiles(const TerrainDesc& desc,
+					   const float* heights,
+					   const uint8_t* materials,
+					   const std::function<void(const TerrainTileKey&, TerrainTile&&)>& sink);
+
+
+} // namespace inl::gxeng
+
+
+namespace std {
+template <>
+struct hash<inl::gxeng::TerrainTileKey> {
+	size_t operator()(const inl::gxeng::TerrainTileKey& key) const {
+		return std::hash<uint64_t>()((uint64_t(key.level) << 56) ^ (uint64_t(key.y) << 28) ^ uint64_t(key.x));
+	}
+};
+}
@@ -0,0 +1,213 @@
+#include "TerrainTileStreamer.hpp"
+
+#include <BaseLibrary/ThreadName.hpp>
+
+#include <algorithm>
+
+
+namespace inl::gxeng {
+
+
+TerrainTileStreamer::TerrainTileStreamer(ITerrainTileSource* source, size_t capacity, bool asynchronous)
+	: m_source(source),
+	m_capacity(capacity)
+{
+	if (m_source == nullptr) {
+		throw std::invalid_argument("Terrain tile streamer needs a tile source.");
+	}
+	m_source->GetDesc().Validate();
+
+	m_runThread = asynchronous;
+	if (asynchronous) {
+		m_loadThread = std::thread(&TerrainTileStreamer::LoadThreadFunc, this);
+	}
+}
+
+
+TerrainTileStreamer::~TerrainTileStreamer() {
+	if (m_loadThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lkg(m_mutex);
+			m_runThread = false;
+		}
+		m_requestCv.notify_all();
+		m_loadThread.join();
+	}
+}
+
+
+void TerrainTileStreamer::Update() {
+	++m_frame;
+
+	std::vector<LoadedTile> loaded;
+	std::exception_ptr error;
+	if (m_loadThread.joinable()) {
+		std::lock_guard<std::mutex> lkg(m_mutex);
+		loaded.swap(m_loaded);
+		error = m_loadError;
+		m_loadError = nullptr;
+	}
+	else {
+		while (!m_requests.empty()) {
+			TerrainTileKey key;
+			PopRequest(key);
+			try {
+				loaded.push_back(Load(key));
+			}
+			catch (...) {
+				loaded.push_back({ key, nullptr });
+				error = std::current_exception();
+			}
+		}
+	}
+
+	// tiles that failed to load are not requested again, like missing ones
+	for (auto& result : loaded) {
+		m_pending.erase(result.key);
+		if (result.tile) {
+			m_resident[result.key] = { std::move(result.tile), m_frame };
+		}
+		else {
+			m_missing.insert(result.key);
+		}
+	}
+
+	Evict();
+
+	// the tiles loaded along with the failed one are resident by now
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+
+const TerrainTile* TerrainTileStreamer::Find(const TerrainTileKey& key) {
+	auto it = m_resident.find(key);
+	if (it == m_resident.end()) {
+		return nullptr;
+	}
+	it->second.lastUsed = m_frame;
+	return it->second.tile.get();
+}
+
+
+void TerrainTileStreamer::Request(const TerrainTileKey& key) {
+	if (m_resident.count(key) > 0 || m_missing.count(key) > 0 || !m_pending.insert(key).second) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_requests.push_back(key);
+	std::push_heap(m_requests.begin(), m_requests.end(), CoarserFirst{});
+	m_requestCv.notify_one();
+}
+
+
+void TerrainTileStreamer::Flush() {
+	if (!m_loadThread.joinable()) {
+		return; // synchronous loads happen in Update anyways
+	}
+	std::unique_lock<std::mutex> lk(m_mutex);
+	m_idleCv.wait(lk, [this] { return m_requests.empty() && m_numLoading == 0; });
+}
+
+
+const TerrainDesc& TerrainTileStreamer::GetDesc() const {
+	return m_source->GetDesc();
+}
+
+size_t TerrainTileStreamer::GetNumResident() const {
+	return m_resident.size();
+}
+
+size_t TerrainTileStreamer::GetNumPending() const {
+	return m_pending.size();
+}
+
+size_t TerrainTileStreamer::GetCapacity() const {
+	return m_capacity;
+}
+
+uint64_t TerrainTileStreamer::GetFrame() const {
+	return m_frame;
+}
+
+
+void TerrainTileStreamer::LoadThreadFunc() {
+	SetCurrentThreadName("Terrain Tile Streaming Thread");
+
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true) {
+		m_requestCv.wait(lk, [this] { return !m_runThread || !m_requests.empty(); });
+		if (!m_runThread) {
+			break;
+		}
+
+		TerrainTileKey key;
+		PopRequest(key);
+		++m_numLoading;
+		lk.unlock();
+
+		LoadedTile result;
+		std::exception_ptr error;
+		try {
+			result = Load(key);
+		}
+		catch (...) {
+			result.key = key;
+			error = std::current_exception();
+		}
+
+		lk.lock();
+		--m_numLoading;
+		m_loaded.push_back(std::move(result));
+		if (error) {
+			m_loadError = error;
+		}
+		if (m_requests.empty() && m_numLoading == 0) {
+			m_idleCv.notify_all();
+		}
+	}
+}
+
+
+TerrainTileStreamer::LoadedTile TerrainTileStreamer::Load(const TerrainTileKey& key) {
+	LoadedTile result;
+	result.key = key;
+	result.tile = std::make_unique<TerrainTile>();
+	if (!m_source->LoadTile(key, *result.tile)) {
+		result.tile.reset();
+	}
+	return result;
+}
+
+
+void TerrainTileStreamer::PopRequest(TerrainTileKey& key) {
+	std::pop_heap(m_requests.begin(), m_requests.end(), CoarserFirst{});
+	key = m_requests.back();
+	m_requests.pop_back();
+}
+
+
+void TerrainTileStreamer::Evict() {
+	if (m_resident.size() <= m_capacity) {
+		return;
+	}
+
+	// drop the tiles that were not used the longest, but none of the last frame, they are likely needed again
+	std::vector<std::pair<uint64_t, TerrainTileKey>> candidates;
+	for (const auto& entry : m_resident) {
+		if (entry.second.lastUsed + 1 < m_frame && entry.first.level > 0) {
+			candidates.push_back({ entry.second.lastUsed, entry.first });
+		}
+	}
+	size_t numEvicted = std::min(candidates.size(), m_resident.size() - m_capacity);
+	std::partial_sort(candidates.begin(), candidates.begin() + numEvicted, candidates.end(),
+					  [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+	for (size_t i = 0; i < numEvicted; ++i) {
+		m_resident.erase(candidates[i].second);
+	}
+}
+
+
+} // namespace inl::gxeng
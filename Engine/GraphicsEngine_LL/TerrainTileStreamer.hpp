@@ -0,0 +1,99 @@
+#pragma once
+
+#include "TerrainTile.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary>
+/// Keeps a limited number of terrain tiles in memory, loading requested ones in the background.
+/// </summary>
+/// <remarks>
+/// All methods must be called from the same thread, only the loading happens on the streamer's own thread.
+/// Coarser tiles are loaded first so the terrain refines gradually as tiles arrive.
+/// </remarks>
+class TerrainTileStreamer {
+public:
+	/// <param name="source"> Not owned, must outlive the streamer. </param>
+	/// <param name="capacity"> The most tiles kept in memory. Tiles used in the last frame are kept even above it. </param>
+	/// <param name="asynchronous"> Tiles are loaded on a background thread if true, in <see cref="Update"/> if false. </param>
+	TerrainTileStreamer(ITerrainTileSource* source, size_t capacity, bool asynchronous = true);
+	TerrainTileStreamer(const TerrainTileStreamer&) = delete;
+	TerrainTileStreamer& operator=(const TerrainTileStreamer&) = delete;
+	~TerrainTileStreamer();
+
+	/// <summary> Starts a new frame. Loaded tiles become resident, tiles above capacity that were not used the longest are dropped. </summary>
+	/// <exception cref="std::runtime_error"> Rethrows the errors of the tile source, after the other loaded tiles became resident.
+	///		Tiles that failed to load are treated as missing. </exception>
+	void Update();
+
+	/// <summary> Returns a resident tile and marks it used in the current frame. </summary>
+	/// <returns> Null if the tile is not resident. </returns>
+	const TerrainTile* Find(const TerrainTileKey& key);
+
+	/// <summary> Queues the tile for loading unless it is resident or already queued. </summary>
+	/// <remarks> Tiles the source does not have are remembered and not requested again. </remarks>
+	void Request(const TerrainTileKey& key);
+
+	/// <summary> Blocks until all queued tiles are loaded. Tiles only become resident in the next <see cref="Update"/>. </summary>
+	void Flush();
+
+	const TerrainDesc& GetDesc() const;
+	size_t GetNumResident() const;
+	size_t GetNumPending() const;
+	size_t GetCapacity() const;
+	uint64_t GetFrame() const;
+
+private:
+	struct ResidentTile {
+		std::unique_ptr<TerrainTile> tile;
+		uint64_t lastUsed;
+	};
+	struct LoadedTile {
+		TerrainTileKey key;
+		std::unique_ptr<TerrainTile> tile; // null if missing
+	};
+	struct CoarserFirst {
+		bool operator()(const TerrainTileKey& lhs, const TerrainTileKey& rhs) const { return lhs.level > rhs.level; }
+	};
+
+	void LoadThreadFunc();
+	LoadedTile Load(const TerrainTileKey& key);
+	void PopRequest(TerrainTileKey& key);
+	void Evict();
+
+private:
+	ITerrainTileSource* m_source;
+	size_t m_capacity;
+	uint64_t m_frame = 0;
+
+	// Main thread only
+	std::unordered_map<TerrainTileKey, ResidentTile> m_resident;
+	std::unordered_set<TerrainTileKey> m_pending;
+	std::unordered_set<TerrainTileKey> m_missing;
+
+	// Shared with the load thread
+	mutable std::mutex m_mutex;
+	std::condition_variable m_requestCv;
+	std::condition_variable m_idleCv;
+	std::vector<TerrainTileKey> m_requests; // heap, coarsest on top
+	std::vector<LoadedTile> m_loaded;
+	std::exception_ptr m_loadError;
+	size_t m_numLoading = 0;
+	std::atomic_bool m_runThread;
+	std::thread m_loadThread;
+};
+
+
+} // namespace inl::gxeng
@@ -16,10 +16,9 @@ UploadManager::UploadManager(gxapi::IGraphicsApi* graphicsApi) :
 	std::lock_guard<std::mutex> lock(m_mtx);
 
 	// Add a new queue before any frame starts to handle uploads at initialization.
-	//m_uploadQueues.push_back(std::vector<UploadDescription>());
-	//UploadFrame uploadFrame;
-	//uploadFrame.frameId = 0;
-	//m_uploadFrames.push_back(uploadFrame);
+	UploadFrame uploadFrame;
+	uploadFrame.frameId = 0;
+	m_uploadFrames.push_back(uploadFrame);
 }
 
 
@@ -155,13 +154,10 @@ void UploadManager::OnFrameBeginHost(uint64_t frameId) {
 void UploadManager::OnFrameCompleteDevice(uint64_t frameId) {
 	std::lock_guard<std::mutex> lock(m_mtx);
 
-	// loop may be removed
-	int framesPopped = 0;
-	while (!m_uploadFrames.empty() && m_uploadFrames.front().frameId <= frameId) {
+	// the frame being recorded is never popped, uploads can always be queued
+	while (m_uploadFrames.size() > 1 && m_uploadFrames.front().frameId <= frameId) {
 		m_uploadFrames.pop_front();
-		++framesPopped;
 	}
-	assert(framesPopped == 1);
 }
 
 
@@ -170,8 +166,13 @@ void UploadManager::OnFrameCompleteHost(uint64_t frameId) {
 
 
 void UploadManager::OnFrameBeginAwait(uint64_t frameId) {
+}
+
+
+void UploadManager::BeginFrame(uint64_t frameId) {
 	std::lock_guard<std::mutex> lock(m_mtx);
 
+	assert(m_uploadFrames.back().frameId < frameId);
 	UploadFrame uploadFrame;
 	uploadFrame.frameId = frameId;
 	m_uploadFrames.push_back(uploadFrame);
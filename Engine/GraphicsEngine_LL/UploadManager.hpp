@@ -61,6 +61,12 @@ public:
 	// The pixels from the source image must be in row-major order inside memory.
 	void Upload(const Texture2D& target, uint32_t offsetX, uint32_t offsetY, const void* data, uint64_t width, uint32_t height, gxapi::eFormat format, size_t bytesPerRow = 0);
 
+	/// <summary>
+	/// Uploads requested from now on belong to the given frame.
+	/// The previous frames' uploads are kept until the device completes them, so several frames may be pending.
+	/// </summary>
+	void BeginFrame(uint64_t frameId);
+
 	void OnFrameBeginDevice(uint64_t frameId) override;
 	void OnFrameBeginHost(uint64_t frameId) override;
 	void OnFrameBeginAwait(uint64_t frameId) override;
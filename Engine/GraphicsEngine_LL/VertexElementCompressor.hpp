@@ -1,12 +1,153 @@
 #pragma once
 
 #include "Vertex.hpp"
+#include "../GraphicsApi_LL/Common.hpp"
+
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
 
 
 namespace inl {
 namespace gxeng {
 
+
+/// <summary>
+/// Decoding parameters of quantized positions.
+/// The decoded position is <c>encoded * scale + offset</c>, where encoded is in [0,1].
+/// </summary>
+struct PositionQuantization {
+	PositionQuantization() : offset(0.0f, 0.0f, 0.0f), scale(1.0f, 1.0f, 1.0f) {}
+
+	/// <summary> Maps the axis aligned box [minimum, maximum] to [0,1]^3. Flat axes get a unit scale. </summary>
+	static PositionQuantization FromBounds(const mathfu::Vector<float, 3>& minimum, const mathfu::Vector<float, 3>& maximum) {
+		PositionQuantization ret;
+		for (int i = 0; i < 3; ++i) {
+			float extent = maximum[i] - minimum[i];
+			ret.offset[i] = minimum[i];
+			ret.scale[i] = extent > 0.0f ? extent : 1.0f;
+		}
+		return ret;
+	}
+
+	mathfu::Vector<float, 3> offset;
+	mathfu::Vector<float, 3> scale;
+};
+
+
+namespace impl {
+
+	inline uint16_t QuantizeUnorm16(float value) {
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		return (uint16_t)std::lround(value * 65535.0f);
+	}
+
+	inline float DequantizeUnorm16(uint16_t value) {
+		return value / 65535.0f;
+	}
+
+	inline int16_t QuantizeSnorm16(float value) {
+		value = std::min(std::max(value, -1.0f), 1.0f);
+		return (int16_t)std::lround(value * 32767.0f);
+	}
+
+	inline float DequantizeSnorm16(int16_t value) {
+		// -32768 and -32767 both map to -1, as in D3D
+		return std::max(value / 32767.0f, -1.0f);
+	}
+
+	inline uint8_t QuantizeUnorm8(float value) {
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		return (uint8_t)std::lround(value * 255.0f);
+	}
+
+	/// <summary> Converts to IEEE 754 binary16 with round to nearest even. Overflows become infinity. </summary>
+	inline uint16_t FloatToHalf(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign = (bits >> 16) & 0x8000u;
+		uint32_t exponent = (bits >> 23) & 0xFFu;
+		uint32_t mantissa = bits & 0x7FFFFFu;
+
+		if (exponent == 0xFFu) { // inf or nan
+			return uint16_t(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+		}
+
+		int halfExponent = (int)exponent - 127 + 15;
+		if (halfExponent >= 31) { // overflow
+			return uint16_t(sign | 0x7C00u);
+		}
+		if (halfExponent <= 0) { // denormal or zero
+			if (halfExponent < -10) {
+				return uint16_t(sign);
+			}
+			mantissa |= 0x800000u;
+			uint32_t shift = uint32_t(14 - halfExponent);
+			uint32_t halfMantissa = mantissa >> shift;
+			uint32_t remainder = mantissa & ((1u << shift) - 1);
+			uint32_t halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (halfMantissa & 1u))) {
+				++halfMantissa;
+			}
+			return uint16_t(sign | halfMantissa);
+		}
+
+		uint32_t half = sign | (uint32_t(halfExponent) << 10) | (mantissa >> 13);
+		uint32_t remainder = mantissa & 0x1FFFu;
+		if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+			++half; // a carry into the exponent is the correct result
+		}
+		return uint16_t(half);
+	}
+
+	inline float HalfToFloat(uint16_t value) {
+		uint32_t sign = uint32_t(value & 0x8000u) << 16;
+		uint32_t exponent = (value >> 10) & 0x1Fu;
+		uint32_t mantissa = value & 0x3FFu;
+
+		uint32_t bits;
+		if (exponent == 0x1Fu) {
+			bits = sign | 0x7F800000u | (mantissa << 13);
+		}
+		else if (exponent != 0) {
+			bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+		}
+		else if (mantissa != 0) { // denormal, normalize it
+			int e = -1;
+			do {
+				++e;
+				mantissa <<= 1;
+			} while ((mantissa & 0x400u) == 0);
+			bits = sign | (uint32_t(127 - 15 - e) << 23) | ((mantissa & 0x3FFu) << 13);
+		}
+		else {
+			bits = sign;
+		}
+
+		float ret;
+		memcpy(&ret, &bits, sizeof(ret));
+		return ret;
+	}
+
+	template <class T>
+	void Store(uint8_t* output, T value) {
+		memcpy(output, &value, sizeof(T));
+	}
+
+	template <class T>
+	T Load(const uint8_t* input) {
+		T value;
+		memcpy(&value, input, sizeof(T));
+		return value;
+	}
+
+} // namespace impl
+
+
 template <eVertexElementSemantic Semantic>
 class VertexElementCompressor {
 public:
@@ -14,92 +155,125 @@ public:
 };
 
 
+/// <summary> Positions are quantized to 16 bit unorm relative to the bounding box of the mesh. </summary>
+/// <remarks> The fourth component is always 1 so that the shader reads a homogeneous point. </remarks>
 template <>
 class VertexElementCompressor<eVertexElementSemantic::POSITION> {
 public:
-	static size_t Size() { return 3 * sizeof(float); }
-
-	static std::array<uint8_t, 3 * sizeof(float)> Compress(const mathfu::Vector<float, 3>& input) {
-		std::array<uint8_t, 3 * sizeof(float)> ret;
-		*reinterpret_cast<uint32_t*>(ret.data() + 0) = *reinterpret_cast<const uint32_t*>(&input.x());
-		*reinterpret_cast<uint32_t*>(ret.data() + 4) = *reinterpret_cast<const uint32_t*>(&input.y());
-		*reinterpret_cast<uint32_t*>(ret.data() + 8) = *reinterpret_cast<const uint32_t*>(&input.z());
+	static constexpr size_t Size() { return 4 * sizeof(uint16_t); }
+	static constexpr gxapi::eFormat Format() { return gxapi::eFormat::R16G16B16A16_UNORM; }
+
+	static std::array<uint8_t, 4 * sizeof(uint16_t)> Compress(const mathfu::Vector<float, 3>& input, const PositionQuantization& quantization) {
+		std::array<uint8_t, 4 * sizeof(uint16_t)> ret;
+		for (int i = 0; i < 3; ++i) {
+			float normalized = (input[i] - quantization.offset[i]) / quantization.scale[i];
+			impl::Store(ret.data() + 2 * i, impl::QuantizeUnorm16(normalized));
+		}
+		impl::Store(ret.data() + 6, uint16_t(65535));
 		return ret;
 	}
 
-	static mathfu::Vector<float, 3> Decompress(const void* input) {
+	static mathfu::Vector<float, 3> Decompress(const void* input, const PositionQuantization& quantization) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input);
 		mathfu::Vector<float, 3> ret;
-		ret.x() = *reinterpret_cast<const float*>(input) + 0;
-		ret.y() = *reinterpret_cast<const float*>(input) + 1;
-		ret.z() = *reinterpret_cast<const float*>(input) + 2;
+		for (int i = 0; i < 3; ++i) {
+			ret[i] = impl::DequantizeUnorm16(impl::Load<uint16_t>(bytes + 2 * i)) * quantization.scale[i] + quantization.offset[i];
+		}
 		return ret;
 	}
 };
 
 
+/// <summary> Normals are stored in octahedral encoding as two 16 bit snorm values. </summary>
+/// <remarks> The input needn't be normalized. A zero vector decodes as +Z. </remarks>
 template <>
 class VertexElementCompressor<eVertexElementSemantic::NORMAL> {
 public:
-	static size_t Size() { return 3 * sizeof(float); }
+	static constexpr size_t Size() { return 2 * sizeof(int16_t); }
+	static constexpr gxapi::eFormat Format() { return gxapi::eFormat::R16G16_SNORM; }
+
+	static std::array<uint8_t, 2 * sizeof(int16_t)> Compress(const mathfu::Vector<float, 3>& input) {
+		float l1 = std::abs(input.x()) + std::abs(input.y()) + std::abs(input.z());
+		float x = l1 > 0.0f ? input.x() / l1 : 0.0f;
+		float y = l1 > 0.0f ? input.y() / l1 : 0.0f;
+		float z = l1 > 0.0f ? input.z() / l1 : 1.0f;
+
+		// fold the lower hemisphere over the diagonals
+		if (z < 0.0f) {
+			float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
 
-	static std::array<uint8_t, 3 * sizeof(float)> Compress(const mathfu::Vector<float, 3>& input) {
-		std::array<uint8_t, 3 * sizeof(float)> ret;
-		*reinterpret_cast<uint32_t*>(ret.data() + 0) = *reinterpret_cast<const uint32_t*>(&input.x());
-		*reinterpret_cast<uint32_t*>(ret.data() + 4) = *reinterpret_cast<const uint32_t*>(&input.y());
-		*reinterpret_cast<uint32_t*>(ret.data() + 8) = *reinterpret_cast<const uint32_t*>(&input.z());
+		std::array<uint8_t, 2 * sizeof(int16_t)> ret;
+		impl::Store(ret.data() + 0, impl::QuantizeSnorm16(x));
+		impl::Store(ret.data() + 2, impl::QuantizeSnorm16(y));
 		return ret;
 	}
 
 	static mathfu::Vector<float, 3> Decompress(const void* input) {
-		mathfu::Vector<float, 3> ret;
-		ret.x() = *reinterpret_cast<const float*>(input) + 0;
-		ret.y() = *reinterpret_cast<const float*>(input) + 1;
-		ret.z() = *reinterpret_cast<const float*>(input) + 2;
-		return ret;
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input);
+		float x = impl::DequantizeSnorm16(impl::Load<int16_t>(bytes + 0));
+		float y = impl::DequantizeSnorm16(impl::Load<int16_t>(bytes + 2));
+		float z = 1.0f - std::abs(x) - std::abs(y);
+		float t = std::max(-z, 0.0f);
+		x += x >= 0.0f ? -t : t;
+		y += y >= 0.0f ? -t : t;
+		return mathfu::Vector<float, 3>(x, y, z).Normalized();
+	}
+
+	/// <summary> HLSL function that does the same as Decompress, named DecodeOctahedralNormal. </summary>
+	static const char* DecodeHlsl() {
+		return
+			"float3 DecodeOctahedralNormal(float2 e) {\n"
+			"	float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+			"	float t = saturate(-n.z);\n"
+			"	n.xy += n.xy >= 0.0 ? -t : t;\n"
+			"	return normalize(n);\n"
+			"}\n";
 	}
 };
 
 
+/// <summary> Texture coordinates are stored as half floats, so tiling coordinates outside [0,1] are preserved. </summary>
 template <>
 class VertexElementCompressor<eVertexElementSemantic::TEX_COORD> {
 public:
-	static size_t Size() { return 2 * sizeof(float); }
+	static constexpr size_t Size() { return 2 * sizeof(uint16_t); }
+	static constexpr gxapi::eFormat Format() { return gxapi::eFormat::R16G16_FLOAT; }
 
-	static std::array<uint8_t, 2 * sizeof(float)> Compress(const mathfu::Vector<float, 2>& input) {
-		std::array<uint8_t, 2 * sizeof(float)> ret;
-		*reinterpret_cast<uint32_t*>(ret.data() + 0) = *reinterpret_cast<const uint32_t*>(&input.x());
-		*reinterpret_cast<uint32_t*>(ret.data() + 4) = *reinterpret_cast<const uint32_t*>(&input.y());
+	static std::array<uint8_t, 2 * sizeof(uint16_t)> Compress(const mathfu::Vector<float, 2>& input) {
+		std::array<uint8_t, 2 * sizeof(uint16_t)> ret;
+		impl::Store(ret.data() + 0, impl::FloatToHalf(input.x()));
+		impl::Store(ret.data() + 2, impl::FloatToHalf(input.y()));
 		return ret;
 	}
 
 	static mathfu::Vector<float, 2> Decompress(const void* input) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input);
 		mathfu::Vector<float, 2> ret;
-		ret.x() = *reinterpret_cast<const float*>(input) + 0;
-		ret.y() = *reinterpret_cast<const float*>(input) + 1;
+		ret.x() = impl::HalfToFloat(impl::Load<uint16_t>(bytes + 0));
+		ret.y() = impl::HalfToFloat(impl::Load<uint16_t>(bytes + 2));
 		return ret;
 	}
 };
 
 
+/// <summary> Colors are clamped to [0,1] and stored as 8 bit unorm, with an alpha of 1. </summary>
 template <>
 class VertexElementCompressor<eVertexElementSemantic::COLOR> {
 public:
-	static size_t Size() { return 3 * sizeof(float); }
+	static constexpr size_t Size() { return 4 * sizeof(uint8_t); }
+	static constexpr gxapi::eFormat Format() { return gxapi::eFormat::R8G8B8A8_UNORM; }
 
-	static std::array<uint8_t, 3 * sizeof(float)> Compress(const mathfu::Vector<float, 3>& input) {
-		std::array<uint8_t, 3 * sizeof(float)> ret;
-		*reinterpret_cast<uint32_t*>(ret.data() + 0) = *reinterpret_cast<const uint32_t*>(&input.x());
-		*reinterpret_cast<uint32_t*>(ret.data() + 4) = *reinterpret_cast<const uint32_t*>(&input.y());
-		*reinterpret_cast<uint32_t*>(ret.data() + 8) = *reinterpret_cast<const uint32_t*>(&input.z());
-		return ret;
+	static std::array<uint8_t, 4 * sizeof(uint8_t)> Compress(const mathfu::Vector<float, 3>& input) {
+		return { impl::QuantizeUnorm8(input.x()), impl::QuantizeUnorm8(input.y()), impl::QuantizeUnorm8(input.z()), 255 };
 	}
 
 	static mathfu::Vector<float, 3> Decompress(const void* input) {
-		mathfu::Vector<float, 3> ret;
-		ret.x() = *reinterpret_cast<const float*>(input) + 0;
-		ret.y() = *reinterpret_cast<const float*>(input) + 1;
-		ret.z() = *reinterpret_cast<const float*>(input) + 2;
-		return ret;
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input);
+		return mathfu::Vector<float, 3>(bytes[0] / 255.0f, bytes[1] / 255.0f, bytes[2] / 255.0f);
 	}
 };
 
@@ -110,6 +284,7 @@ public:
 		eVertexElementSemantic semantic;
 		int index;
 		int offset;
+		gxapi::eFormat format;
 	};
 public:
 	static size_t Size(const VertexBase& input, const std::vector<bool>& elementMap) {
@@ -142,67 +317,63 @@ public:
 		return size;
 	}
 
-	static std::vector<Element> Compress(const VertexBase& input, const std::vector<bool>& elementMap, void* output) {
+	/// <summary> Compresses the selected elements of a single vertex into <paramref name="output"/>. </summary>
+	/// <param name="quantization"> Decoding parameters for positions, used by all position elements. </param>
+	/// <returns> The layout of the compressed vertex. </returns>
+	static std::vector<Element> Compress(const VertexBase& input, const std::vector<bool>& elementMap, const PositionQuantization& quantization, void* output) {
+		std::vector<Element> compressedElements;
+		Compress(input, elementMap, quantization, output, compressedElements);
+		return compressedElements;
+	}
+
+	/// <summary> Same as above, but reuses the storage of <paramref name="compressedElements"/>. </summary>
+	static void Compress(const VertexBase& input, const std::vector<bool>& elementMap, const PositionQuantization& quantization, void* output, std::vector<Element>& compressedElements) {
 		size_t offset = 0;
 		int index = 0;
 		uint8_t* outputPtr = reinterpret_cast<uint8_t*>(output);
-		std::vector<Element> compressedElements;
+		compressedElements.clear();
 
 		for (auto& element : input.GetElements()) {
 			if (elementMap.size() > index && (bool)elementMap[index]) {
-				compressedElements.push_back({ element.semantic, element.index, (int)offset });
-
 				switch (element.semantic) {
 					case eVertexElementSemantic::POSITION:
 					{
-						auto compressed = VertexElementCompressor<eVertexElementSemantic::POSITION>::Compress(
-							dynamic_cast<const VertexPart<eVertexElementSemantic::POSITION>&>(input).GetPosition(element.index));
-
-						for (auto v : compressed) {
-							*outputPtr = v;
-							++outputPtr;
-						}
-
-						offset += VertexElementCompressor<eVertexElementSemantic::POSITION>::Size();
+						using Compressor = VertexElementCompressor<eVertexElementSemantic::POSITION>;
+						auto compressed = Compressor::Compress(
+							dynamic_cast<const VertexPart<eVertexElementSemantic::POSITION>&>(input).GetPosition(element.index), quantization);
+						memcpy(outputPtr + offset, compressed.data(), compressed.size());
+						compressedElements.push_back({ element.semantic, element.index, (int)offset, Compressor::Format() });
+						offset += Compressor::Size();
 						break;
 					}
 					case eVertexElementSemantic::NORMAL:
 					{
-						auto compressed = VertexElementCompressor<eVertexElementSemantic::NORMAL>::Compress(
+						using Compressor = VertexElementCompressor<eVertexElementSemantic::NORMAL>;
+						auto compressed = Compressor::Compress(
 							dynamic_cast<const VertexPart<eVertexElementSemantic::NORMAL>&>(input).GetNormal(element.index));
-
-						for (auto v : compressed) {
-							*outputPtr = v;
-							++outputPtr;
-						}
-
-						offset += VertexElementCompressor<eVertexElementSemantic::NORMAL>::Size();
+						memcpy(outputPtr + offset, compressed.data(), compressed.size());
+						compressedElements.push_back({ element.semantic, element.index, (int)offset, Compressor::Format() });
+						offset += Compressor::Size();
 						break;
 					}
 					case eVertexElementSemantic::TEX_COORD:
 					{
-						auto compressed = VertexElementCompressor<eVertexElementSemantic::TEX_COORD>::Compress(
+						using Compressor = VertexElementCompressor<eVertexElementSemantic::TEX_COORD>;
+						auto compressed = Compressor::Compress(
 							dynamic_cast<const VertexPart<eVertexElementSemantic::TEX_COORD>&>(input).GetTexCoord(element.index));
-
-						for (auto v : compressed) {
-							*outputPtr = v;
-							++outputPtr;
-						}
-
-						offset += VertexElementCompressor<eVertexElementSemantic::NORMAL>::Size();
+						memcpy(outputPtr + offset, compressed.data(), compressed.size());
+						compressedElements.push_back({ element.semantic, element.index, (int)offset, Compressor::Format() });
+						offset += Compressor::Size();
 						break;
 					}
 					case eVertexElementSemantic::COLOR:
 					{
-						auto compressed = VertexElementCompressor<eVertexElementSemantic::COLOR>::Compress(
+						using Compressor = VertexElementCompressor<eVertexElementSemantic::COLOR>;
+						auto compressed = Compressor::Compress(
 							dynamic_cast<const VertexPart<eVertexElementSemantic::COLOR>&>(input).GetColor(element.index));
-
-						for (auto v : compressed) {
-							*outputPtr = v;
-							++outputPtr;
-						}
-
-						offset += VertexElementCompressor<eVertexElementSemantic::COLOR>::Size();
+						memcpy(outputPtr + offset, compressed.data(), compressed.size());
+						compressedElements.push_back({ element.semantic, element.index, (int)offset, Compressor::Format() });
+						offset += Compressor::Size();
 						break;
 					}
 					default:
@@ -213,12 +384,37 @@ public:
 
 			++index;
 		}
+	}
 
-		return compressedElements;
+	/// <summary> Returns the quantization for the bounding box of all position elements of the vertices. </summary>
+	/// <remarks> Returns an empty [0,0] box if there are no positions. </remarks>
+	static PositionQuantization CalculateQuantization(const VertexBase* vertices, size_t numVertices, size_t vertexStride) {
+		mathfu::Vector<float, 3> minimum(std::numeric_limits<float>::max());
+		mathfu::Vector<float, 3> maximum(std::numeric_limits<float>::lowest());
+		bool hasPosition = false;
+
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(vertices);
+		for (size_t i = 0; i < numVertices; ++i) {
+			const VertexBase& vertex = *reinterpret_cast<const VertexBase*>(bytes + i * vertexStride);
+			for (auto& element : vertex.GetElements()) {
+				if (element.semantic != eVertexElementSemantic::POSITION) {
+					continue;
+				}
+				const auto& position = dynamic_cast<const VertexPart<eVertexElementSemantic::POSITION>&>(vertex).GetPosition(element.index);
+				minimum = mathfu::Vector<float, 3>::Min(minimum, position);
+				maximum = mathfu::Vector<float, 3>::Max(maximum, position);
+				hasPosition = true;
+			}
+		}
+
+		if (!hasPosition) {
+			return PositionQuantization::FromBounds({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f });
+		}
+		return PositionQuantization::FromBounds(minimum, maximum);
 	}
 };
 
 
 
 } // namespace gxeng
-} // namespace inl
\ No newline at end of file
+} // namespace inl
@@ -8,6 +8,7 @@
 #include <GraphicsEngine_LL/MeshEntity.hpp>
 #include <GraphicsEngine_LL/Scene.hpp>
 #include <GraphicsEngine_LL/OverlayEntity.hpp>
+#include <GraphicsEngine_LL/FoliageEntity.hpp>
 #include <GraphicsEngine_LL/PerspectiveCamera.hpp>
 #include <GraphicsEngine_LL/OrthographicCamera.hpp>
 #include <GraphicsEngine_LL/DirectionalLight.hpp>
@@ -96,7 +97,6 @@ public:
 
 	std::unique_ptr<inl::gxeng::Image> m_checkerTexture;
 
-	std::unique_ptr<inl::gxeng::Material> m_treeMaterial;
 	std::unique_ptr<inl::gxeng::Material> m_quadcopterMaterial;
 	std::unique_ptr<inl::gxeng::Material> m_terrainMaterial;
 	std::unique_ptr<inl::gxeng::Material> m_axesMaterial;
@@ -107,6 +107,7 @@ public:
 	std::unique_ptr<inl::gxeng::MeshEntity> m_terrainEntity;
 	std::unique_ptr<inl::gxeng::MeshEntity> m_quadcopterEntity;
 	std::unique_ptr<inl::gxeng::MeshEntity> m_axesEntity;
+	std::unique_ptr<inl::gxeng::FoliageEntity> m_trees;
 
 	inl::gxeng::DirectionalLight m_sun;
 
@@ -117,7 +118,6 @@ public:
 	// Gui
 	std::unique_ptr<inl::gxeng::OrthographicCamera> m_guiCamera;
 	std::unique_ptr<inl::gxeng::Scene> m_guiScene;
-	std::unique_ptr<inl::gxeng::Mesh> m_overlayQuadMesh;
 	std::unique_ptr<inl::gxeng::Image> m_overlayTexture;
 	std::vector<std::unique_ptr<inl::gxeng::OverlayEntity>> m_overlayElements;
 
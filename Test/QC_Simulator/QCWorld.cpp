@@ -23,22 +23,6 @@ QCWorld::QCWorld(inl::gxeng::GraphicsEngine* graphicsEngine) {
 		graphicsEngine->GetScreenSize(width, height);
 		m_guiCamera->SetBounds(0, width, height, 0, -1, 1);
 
-		std::vector<inl::gxeng::Vertex<Position<0>, TexCoord<0>>> vertices(4);
-		vertices[0].position = mathfu::Vector3f(0, 0, 0);
-		vertices[1].position = mathfu::Vector3f(0, 1, 0);
-		vertices[2].position = mathfu::Vector3f(1, 1, 0);
-		vertices[3].position = mathfu::Vector3f(1, 0, 0);
-
-		vertices[0].texCoord = mathfu::Vector2f(0, 0);
-		vertices[1].texCoord = mathfu::Vector2f(0, 1);
-		vertices[2].texCoord = mathfu::Vector2f(1, 1);
-		vertices[3].texCoord = mathfu::Vector2f(1, 0);
-
-		std::vector<unsigned> indices = { 0, 1, 2, 0, 2, 3 };
-
-		m_overlayQuadMesh.reset(m_graphicsEngine->CreateMesh());
-		m_overlayQuadMesh->Set(vertices.data(), vertices.size(), indices.data(), indices.size());
-
 		using PixelT = Pixel<ePixelChannelType::INT8_NORM, 4, ePixelClass::LINEAR>;
 		inl::asset::Image img("assets\\overlay.png");
 		m_overlayTexture.reset(m_graphicsEngine->CreateImage());
@@ -48,7 +32,6 @@ QCWorld::QCWorld(inl::gxeng::GraphicsEngine* graphicsEngine) {
 		std::unique_ptr<inl::gxeng::OverlayEntity> element;
 
 		element.reset(m_graphicsEngine->CreateOverlayEntity());
-		element->SetMesh(m_overlayQuadMesh.get());
 		element->SetScale({ (float)img.GetWidth()*0.75f, (float)img.GetHeight()*0.75f });
 		element->SetTexture(m_overlayTexture.get());
 		m_overlayElements.push_back(std::move(element));
@@ -166,7 +149,6 @@ QCWorld::QCWorld(inl::gxeng::GraphicsEngine* graphicsEngine) {
 
 	// Create materials
 	{
-		m_treeMaterial.reset(m_graphicsEngine->CreateMaterial());
 		m_quadcopterMaterial.reset(m_graphicsEngine->CreateMaterial());
 		m_axesMaterial.reset(m_graphicsEngine->CreateMaterial());
 		m_terrainMaterial.reset(m_graphicsEngine->CreateMaterial());
@@ -182,12 +164,10 @@ QCWorld::QCWorld(inl::gxeng::GraphicsEngine* graphicsEngine) {
 		nodes.push_back(std::move(mapShader));
 		nodes.push_back(std::move(diffuseShader));
 		m_simpleShader->SetGraph(std::move(nodes), { {0, 1, 0} });
-		m_treeMaterial->SetShader(m_simpleShader.get());
 		m_quadcopterMaterial->SetShader(m_simpleShader.get());
 		m_axesMaterial->SetShader(m_simpleShader.get());
 		m_terrainMaterial->SetShader(m_simpleShader.get());
 
-		(*m_treeMaterial)[0] = m_treeTexture.get();
 		(*m_quadcopterMaterial)[0] = m_quadcopterTexture.get();
 		(*m_axesMaterial)[0] = m_axesTexture.get();
 		(*m_terrainMaterial)[0] = m_terrainTexture.get();
@@ -215,6 +195,7 @@ QCWorld::QCWorld(inl::gxeng::GraphicsEngine* graphicsEngine) {
 	m_terrainEntity->SetPosition({ 0,0,0 });
 	m_terrainEntity->SetRotation({ 1,0,0,0 });
 	m_terrainEntity->SetScale({ 1,1,1 });
+	m_terrainEntity->SetStatic(true);
 	m_worldScene->GetMeshEntities().Add(m_terrainEntity.get());
 
 	// Set up copter
@@ -236,6 +217,11 @@ QCWorld::QCWorld(inl::gxeng::GraphicsEngine* graphicsEngine) {
 	//m_worldScene->GetMeshEntities().Add(m_axesEntity.get());
 
 	// Set up trees
+	m_trees.reset(m_graphicsEngine->CreateFoliageEntity());
+	m_trees->SetMesh(m_treeMesh.get());
+	m_trees->SetTexture(m_treeTexture.get());
+	m_trees->SetAlphaCutoff(0.0f); // the texture has no alpha channel
+	m_worldScene->GetFoliageEntities().Add(m_trees.get());
 	AddTree({ 2, 2, 0 });
 	AddTree({ 11, 6, 0 });
 	AddTree({ 13, 8, 0 });
@@ -319,20 +305,11 @@ void QCWorld::RenderWorld(float elapsed) {
 
 
 void QCWorld::AddTree(mathfu::Vector3f position) {
-	std::unique_ptr<inl::gxeng::MeshEntity> tree;
-
 	static std::mt19937_64 rne;
 	static std::uniform_real_distribution<float> rng{ 0.8f, 1.2f };
 	float s = rng(rne);
 
-	tree.reset(m_graphicsEngine->CreateMeshEntity());
-	tree->SetMesh(m_treeMesh.get());
-	tree->SetMaterial(m_treeMaterial.get());
-	tree->SetPosition(position);
-	tree->SetRotation({ 1,0,0,0 });
-	tree->SetScale({ s,s,s });
-	m_worldScene->GetMeshEntities().Add(tree.get());
-	m_staticEntities.push_back(std::move(tree));
+	m_trees->AddInstance({ position, 0.0f, s });
 }
 
 
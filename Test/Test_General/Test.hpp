@@ -5,6 +5,7 @@
 #include <functional>
 #include <map>
 #include <cstring>
+#include <iostream>
 
 
 class TestFactory {
@@ -65,4 +66,20 @@ private:
 };
 
 template <class T>
-typename AutoRegisterTest<T>::Helper AutoRegisterTest<T>::helper;
\ No newline at end of file
+typename AutoRegisterTest<T>::Helper AutoRegisterTest<T>::helper;
+
+
+/// <summary> Counts the failed checks of a test and prints their messages. </summary>
+class TestCheck {
+public:
+	explicit TestCheck(int& errors) : errors(errors) {}
+
+	void operator()(bool condition, const char* message) const {
+		if (!condition) {
+			std::cout << message << std::endl;
+			++errors;
+		}
+	}
+private:
+	int& errors;
+};
@@ -146,5 +146,30 @@ int TestAllocator::Run() {
 	}
 
 
-	return 0;
+	// slots freed in full blocks can all be allocated again
+	cout << endl << "Reuse:" << endl;
+	constexpr size_t SlotsPerBlock = sizeof(size_t) * 8;
+	exc::SlabAllocatorEngine fullEngine(3 * SlotsPerBlock);
+	for (size_t i = 0; i < 2 * SlotsPerBlock; ++i) {
+		fullEngine.Allocate();
+	}
+	fullEngine.Deallocate(0);
+	fullEngine.Deallocate(SlotsPerBlock);
+	size_t numAllocated = 0;
+	try {
+		while (true) {
+			fullEngine.Allocate();
+			++numAllocated;
+		}
+	}
+	catch (std::bad_alloc&) {
+	}
+	if (numAllocated != SlotsPerBlock + 2) {
+		cout << "Free slots lost." << endl;
+		return 1;
+	}
+	cout << "OK." << endl;
+
+
+	return isOk ? 0 : 1;
 }
\ No newline at end of file
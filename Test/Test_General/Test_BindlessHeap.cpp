@@ -0,0 +1,158 @@
+#include "Test.hpp"
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsApi_Null/DescriptorHeap.hpp"
+#include "GraphicsEngine_LL/BindlessHeap.hpp"
+#include "GraphicsEngine_LL/ScratchSpacePool.hpp"
+#include "GraphicsEngine_LL/ResourceView.hpp"
+#include "GraphicsEngine_LL/Binder.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestBindlessHeap : public AutoRegisterTest<TestBindlessHeap> {
+public:
+	TestBindlessHeap() {}
+
+	static std::string Name() {
+		return "Bindless Heap";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestBindlessHeap::Run() {
+	using namespace inl::gxapi;
+	using namespace inl::gxeng;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	constexpr uint32_t NumPersistent = 256;
+	constexpr uint32_t NumScratchSpaces = 4;
+	constexpr uint32_t ScratchSpaceSize = 16;
+
+	inl::gxapi_null::GraphicsApi gxapi;
+	BindlessHeap bindlessHeap(&gxapi, NumPersistent, NumScratchSpaces, ScratchSpaceSize);
+	CbvSrvUavHeap stagingHeap(&gxapi);
+
+	auto CreateTexture = [&gxapi]() {
+		IResource* resource = gxapi.CreateCommittedResource(HeapProperties{ eHeapType::DEFAULT }, eHeapFlags::NONE, ResourceDesc::Texture2D(64, 64, eFormat::R8G8B8A8_UNORM), eResourceState::COMMON);
+		return Texture2D(MemoryObjDesc(resource, eResourceHeap::CRITICAL));
+	};
+	auto DescriptorAt = [&bindlessHeap](uint32_t index) {
+		return *static_cast<const inl::gxapi_null::Descriptor*>(bindlessHeap.At(index).cpuAddress);
+	};
+
+	// registered views get stable indices that address a copy of their descriptor
+	Texture2D texture1 = CreateTexture();
+	Texture2D texture2 = CreateTexture();
+	TextureView2D view1(texture1, stagingHeap, eFormat::R8G8B8A8_UNORM, SrvTexture2DArray{});
+	TextureView2D view2(texture2, stagingHeap, eFormat::R8G8B8A8_UNORM, SrvTexture2DArray{});
+	Check(view1.GetBindlessIndex() == BindlessHeap::InvalidIndex, "Unregistered view has a bindless index");
+	view1.RegisterBindless(bindlessHeap);
+	view2.RegisterBindless(bindlessHeap);
+	uint32_t index1 = view1.GetBindlessIndex();
+	uint32_t index2 = view2.GetBindlessIndex();
+	Check(index1 < NumPersistent && index2 < NumPersistent && index1 != index2, "Bad bindless indices");
+	Check(DescriptorAt(index1).kind == inl::gxapi_null::eDescriptorKind::SRV
+		  && DescriptorAt(index1).resource == texture1._GetResourcePtr()
+		  && DescriptorAt(index2).resource == texture2._GetResourcePtr(), "Descriptor not copied to the bindless heap");
+
+	TextureView2D view1Copy = view1;
+	view1Copy.RegisterBindless(bindlessHeap);
+	Check(view1Copy.GetBindlessIndex() == index1, "Registering a copy of a view changed the index");
+
+	// indices of views destroyed during a frame are reused once the frame completed
+	bindlessHeap.BeginFrame(0);
+	view2 = TextureView2D();
+	Check(bindlessHeap.GetNumPendingFrees() == 1, "Freed index not deferred");
+	uint32_t index3 = bindlessHeap.Register(stagingHeap.At(0));
+	Check(index3 != index2, "Index reused before the frame completed");
+	bindlessHeap.OnFrameCompleteDevice(0);
+	Check(bindlessHeap.GetNumPendingFrees() == 0, "Freed index not released after the frame completed");
+	uint32_t index4 = bindlessHeap.Register(stagingHeap.At(0));
+	Check(index4 == index2, "Released index not reused");
+	bindlessHeap.Deallocate(index4);
+	Check(bindlessHeap.GetNumPendingFrees() == 0, "Index freed after all frames completed is deferred");
+
+	// scratch spaces are carved from the same heap, behind the persistent descriptors
+	ScratchSpacePool scratchSpacePool(&gxapi, eDescriptorHeapType::CBV_SRV_UAV, &bindlessHeap);
+	{
+		ScratchSpacePtr scratch1 = scratchSpacePool.RequestScratchSpace();
+		ScratchSpacePtr scratch2 = scratchSpacePool.RequestScratchSpace();
+		Check(scratch1->GetHeap() == bindlessHeap.GetHeap() && scratch2->GetHeap() == bindlessHeap.GetHeap(), "Scratch space has its own heap");
+		DescriptorArrayRef range1 = scratch1->Allocate(ScratchSpaceSize);
+		DescriptorArrayRef range2 = scratch2->Allocate(ScratchSpaceSize);
+		auto first = static_cast<inl::gxapi_null::Descriptor*>(bindlessHeap.GetHeap()->At(0).cpuAddress);
+		size_t begin1 = static_cast<inl::gxapi_null::Descriptor*>(range1.Get(0).cpuAddress) - first;
+		size_t begin2 = static_cast<inl::gxapi_null::Descriptor*>(range2.Get(0).cpuAddress) - first;
+		Check(begin1 >= NumPersistent && begin2 >= NumPersistent, "Scratch space overlaps persistent descriptors");
+		Check(begin1 + ScratchSpaceSize <= begin2 || begin2 + ScratchSpaceSize <= begin1, "Scratch spaces overlap");
+	}
+	{
+		// running out of scratch spaces replaces the heap with a larger one that has the same persistent descriptors
+		std::vector<ScratchSpacePtr> scratchSpaces;
+		for (uint32_t i = 0; i < NumScratchSpaces; ++i) {
+			scratchSpaces.push_back(scratchSpacePool.RequestScratchSpace());
+		}
+		IDescriptorHeap* firstHeap = bindlessHeap.GetHeap();
+		Check(bindlessHeap.GetNumHeaps() == 1, "Heap replaced before it ran out");
+		scratchSpaces.push_back(scratchSpacePool.RequestScratchSpace());
+		Check(bindlessHeap.GetHeap() != firstHeap && scratchSpaces.back()->GetHeap() == bindlessHeap.GetHeap(), "Heap not replaced when it ran out");
+		Check(bindlessHeap.GetNumScratchSpaces() == 2 * NumScratchSpaces, "Replacing heap not larger");
+		Check(bindlessHeap.GetNumHeaps() == 2 && bindlessHeap.OwnsHeap(firstHeap), "Replaced heap destroyed while in use");
+		Check(DescriptorAt(index1).resource == texture1._GetResourcePtr(), "Persistent descriptors not copied to the new heap");
+
+		// descriptors registered later reach the replaced heap too, command lists may still use it
+		Texture2D texture5 = CreateTexture();
+		TextureView2D view5(texture5, stagingHeap, eFormat::R8G8B8A8_UNORM, SrvTexture2DArray{});
+		view5.RegisterBindless(bindlessHeap);
+		auto replacedDescriptor = static_cast<const inl::gxapi_null::Descriptor*>(firstHeap->At(view5.GetBindlessIndex()).cpuAddress);
+		Check(replacedDescriptor->resource == texture5._GetResourcePtr() && DescriptorAt(view5.GetBindlessIndex()).resource == texture5._GetResourcePtr(),
+			  "New descriptor not copied to every heap");
+	}
+	Check(bindlessHeap.GetNumHeaps() == 1, "Replaced heap not destroyed with its last scratch space");
+	{
+		ScratchSpacePtr scratch = scratchSpacePool.RequestScratchSpace();
+		Check(scratch->GetHeap() == bindlessHeap.GetHeap(), "Scratch space of a replaced heap reused");
+	}
+
+	// bindless parameters span the heap in a table of their own
+	{
+		BindParameterDesc textureDesc;
+		textureDesc.parameter = BindParameter(eBindParameterType::TEXTURE, 0);
+		BindParameterDesc bindlessDesc;
+		bindlessDesc.parameter = BindParameter(eBindParameterType::TEXTURE, 0, 100);
+		bindlessDesc.bindless = true;
+		Binder binder(&gxapi, { textureDesc, bindlessDesc });
+
+		int slot, tableIndex;
+		binder.Translate(bindlessDesc.parameter, slot, tableIndex);
+		const RootParameterDesc& param = binder.GetRootSignatureDesc().rootParameters[slot];
+		Check(param.type == RootParameterDesc::DESCRIPTOR_TABLE, "Bindless parameter not in a table");
+		if (param.type == RootParameterDesc::DESCRIPTOR_TABLE) {
+			const auto& ranges = param.As<RootParameterDesc::DESCRIPTOR_TABLE>().ranges;
+			Check(ranges.size() == 1 && ranges[0].numDescriptors == DescriptorRange::UNBOUNDED && ranges[0].registerSpace == 100, "Bindless range not unbounded");
+		}
+		int textureSlot;
+		binder.Translate(textureDesc.parameter, textureSlot, tableIndex);
+		Check(textureSlot != slot, "Bindless parameter shares a table");
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,179 @@
+#include "Test.hpp"
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include "GraphicsEngine_LL/ClusteredLightCulling.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestClusteredLightCulling : public AutoRegisterTest<TestClusteredLightCulling> {
+public:
+	TestClusteredLightCulling() {}
+
+	static std::string Name() {
+		return "Clustered Light Culling";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestClusteredLightCulling::Run() {
+	using namespace inl::gxeng;
+	using Vec3 = mathfu::Vector<float, 3>;
+
+	const float pi = 3.14159265f;
+	const float projScaleY = 1.0f / std::tan(pi / 6.0f);
+	const float projScaleX = projScaleY * 9.0f / 16.0f;
+	ClusterGrid grid(ClusterGridDesc{}, projScaleX, projScaleY, 0.1f, 200.0f);
+	const ClusterGridDesc& desc = grid.GetDesc();
+
+	// lights all over the place, some behind the camera or past the far plane
+	std::mt19937 rne(3141);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<ClusterLight> lights;
+	for (int i = 0; i < 600; ++i) {
+		ClusterLight light;
+		light.viewPosition = { unit(rne) * 60.0f, unit(rne) * 30.0f, -100.0f + unit(rne) * 110.0f };
+		light.range = 8.0f + unit(rne) * 7.5f;
+		if (i % 2 == 1) {
+			Vec3 direction(unit(rne), unit(rne), unit(rne));
+			light.viewDirection = direction.Length() > 1e-3f ? direction.Normalized() : Vec3(0, 0, -1);
+			light.cosHalfAngle = std::cos((42.5f + unit(rne) * 37.5f) * pi / 180.0f);
+		}
+		lights.push_back(light);
+	}
+
+	ClusterLightList list;
+	AssignLightsToClusters(grid, lights, 1u << 30, list);
+
+	// the accelerated assignment must match testing every light against every cluster
+	size_t mismatches = 0;
+	size_t totalAssigned = 0;
+	bool compact = list.offsets.size() == grid.GetClusterCount() && list.counts.size() == grid.GetClusterCount();
+	for (unsigned slice = 0; slice < desc.depthSlices && compact; ++slice) {
+		for (unsigned y = 0; y < desc.tilesY; ++y) {
+			for (unsigned x = 0; x < desc.tilesX; ++x) {
+				unsigned cluster = grid.GetClusterIndex(x, y, slice);
+				ClusterBounds bounds = grid.GetClusterBounds(x, y, slice);
+				std::vector<uint32_t> expected;
+				for (uint32_t i = 0; i < lights.size(); ++i) {
+					if (grid.Intersects(bounds, lights[i])) {
+						expected.push_back(i);
+					}
+				}
+				std::vector<uint32_t> actual(list.lightIndices.begin() + list.offsets[cluster], list.lightIndices.begin() + list.offsets[cluster] + list.counts[cluster]);
+				mismatches += actual != expected;
+				totalAssigned += actual.size();
+				compact = compact && list.offsets[cluster] == (cluster == 0 ? 0 : list.offsets[cluster - 1] + list.counts[cluster - 1]);
+			}
+		}
+	}
+	compact = compact && totalAssigned == list.lightIndices.size();
+
+	// hand-placed lights end up where they should
+	auto ClusterOf = [&](Vec3 p) {
+		float ndcX = projScaleX * p.x() / -p.z();
+		float ndcY = projScaleY * p.y() / -p.z();
+		unsigned x = (unsigned)std::floor((0.5f + 0.5f * ndcX) * desc.tilesX);
+		unsigned y = (unsigned)std::floor((0.5f - 0.5f * ndcY) * desc.tilesY);
+		unsigned slice = (unsigned)std::floor(std::log(-p.z()) * grid.GetSliceScale() + grid.GetSliceBias());
+		return grid.GetClusterIndex(x, y, slice);
+	};
+	auto Contains = [](const ClusterLightList& list, unsigned cluster, uint32_t light) {
+		for (uint32_t i = 0; i < list.counts[cluster]; ++i) {
+			if (list.lightIndices[list.offsets[cluster] + i] == light) {
+				return true;
+			}
+		}
+		return false;
+	};
+	std::vector<ClusterLight> placed(4);
+	placed[0].viewPosition = { 0.01f, 0.01f, -10.0f }; // small point light in the middle
+	placed[0].range = 1.0f;
+	placed[1].viewPosition = { 0.0f, 0.0f, 5.0f }; // behind the camera
+	placed[1].range = 1.0f;
+	placed[2].viewPosition = { 0.0f, 0.0f, -5.0f }; // spot looking away from the camera
+	placed[2].range = 4.0f;
+	placed[2].viewDirection = { 0.0f, 0.0f, -1.0f };
+	placed[2].cosHalfAngle = std::cos(20.0f * pi / 180.0f);
+	placed[3] = placed[2]; // spot looking at the camera
+	placed[3].viewDirection = { 0.0f, 0.0f, 1.0f };
+	ClusterLightList placedList;
+	AssignLightsToClusters(grid, placed, 1024, placedList);
+	size_t placedTotal = placedList.lightIndices.size();
+	bool placedOk = Contains(placedList, ClusterOf({ 0.01f, 0.01f, -10.0f }), 0)
+		&& !Contains(placedList, ClusterOf({ 0.01f, 0.01f, -20.0f }), 0)
+		&& Contains(placedList, ClusterOf({ 0.01f, 0.01f, -8.0f }), 2)
+		&& !Contains(placedList, ClusterOf({ 0.01f, 0.01f, -8.0f }), 3)
+		&& Contains(placedList, ClusterOf({ 0.01f, 0.01f, -2.0f }), 3)
+		&& !Contains(placedList, ClusterOf({ 0.01f, 0.01f, -2.0f }), 2);
+	for (uint32_t index : placedList.lightIndices) {
+		placedOk = placedOk && index != 1;
+	}
+
+	// a full index list truncates every cluster to a prefix of its complete list
+	size_t capacity = list.lightIndices.size() / 2;
+	ClusterLightList truncated;
+	AssignLightsToClusters(grid, lights, capacity, truncated);
+	bool truncatedOk = truncated.lightIndices.size() == capacity;
+	for (unsigned cluster = 0; cluster < grid.GetClusterCount() && truncatedOk; ++cluster) {
+		truncatedOk = truncated.offsets[cluster] + truncated.counts[cluster] <= capacity
+			&& truncated.counts[cluster] <= list.counts[cluster]
+			&& std::equal(truncated.lightIndices.begin() + truncated.offsets[cluster],
+						  truncated.lightIndices.begin() + truncated.offsets[cluster] + truncated.counts[cluster],
+						  list.lightIndices.begin() + list.offsets[cluster]);
+	}
+
+	bool throwsOk = true;
+	try {
+		ClusterGrid invalid(ClusterGridDesc{ 0, 9, 24 }, projScaleX, projScaleY, 0.1f, 200.0f);
+		throwsOk = false;
+	}
+	catch (std::invalid_argument&) {}
+	try {
+		ClusterGrid invalid(ClusterGridDesc{}, projScaleX, projScaleY, 10.0f, 1.0f);
+		throwsOk = false;
+	}
+	catch (std::invalid_argument&) {}
+
+	cout << "Assigned " << totalAssigned << " light indices to " << grid.GetClusterCount() << " clusters." << endl;
+	cout << "Clusters differing from brute force: " << mismatches << endl;
+	cout << "Hand-placed lights assigned " << placedTotal << " indices." << endl;
+
+	int failed = 0;
+	if (mismatches > 0) {
+		cout << "Cluster assignment differs from brute force." << endl;
+		++failed;
+	}
+	if (!compact) {
+		cout << "Light lists are not compact." << endl;
+		++failed;
+	}
+	if (!placedOk) {
+		cout << "Hand-placed lights are in the wrong clusters." << endl;
+		++failed;
+	}
+	if (!truncatedOk) {
+		cout << "Truncated lists are wrong." << endl;
+		++failed;
+	}
+	if (!throwsOk) {
+		cout << "Invalid grid was accepted." << endl;
+		++failed;
+	}
+
+	return failed;
+}
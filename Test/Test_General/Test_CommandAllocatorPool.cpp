@@ -0,0 +1,125 @@
+#include "Test.hpp"
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsEngine_LL/CommandAllocatorPool.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestCommandAllocatorPool : public AutoRegisterTest<TestCommandAllocatorPool> {
+public:
+	TestCommandAllocatorPool() {}
+
+	static std::string Name() {
+		return "Command Allocator Pool";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestCommandAllocatorPool::Run() {
+	using namespace inl::gxapi;
+	using namespace inl::gxeng;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	inl::gxapi_null::GraphicsApi gxapi;
+	std::shared_ptr<IFence> fence(gxapi.CreateFence(0));
+	CommandAllocatorPool pool(&gxapi);
+	auto NumAllocators = [&pool]() {
+		return pool.GetNumAllocators(eCommandListType::GRAPHICS);
+	};
+
+	// submitted allocators are not reused until the fence is reached
+	for (uint64_t value = 1; value <= 3; ++value) {
+		CmdAllocPtr allocator = pool.RequestAllocator(eCommandListType::GRAPHICS);
+		pool.RecycleAllocator(std::move(allocator), SyncPoint(fence, value));
+	}
+	Check(NumAllocators() == 3, "Submitted allocators reused");
+	CmdAllocPtr extra = pool.RequestAllocator(eCommandListType::GRAPHICS);
+	Check(NumAllocators() == 4, "Allocator reused before its fence was reached");
+	pool.RecycleAllocator(std::move(extra), SyncPoint(fence, 4));
+
+	// completed ones are recycled in bulk
+	fence->Signal(2);
+	CmdAllocPtr first = pool.RequestAllocator(eCommandListType::GRAPHICS);
+	CmdAllocPtr second = pool.RequestAllocator(eCommandListType::GRAPHICS);
+	Check(NumAllocators() == 4, "Completed allocators not recycled");
+	CmdAllocPtr third = pool.RequestAllocator(eCommandListType::GRAPHICS);
+	Check(NumAllocators() == 5, "Allocator reused past the completed fence value");
+
+	// allocators that were never submitted are reused right away
+	first.reset();
+	CmdAllocPtr again = pool.RequestAllocator(eCommandListType::GRAPHICS);
+	Check(NumAllocators() == 5, "Dropped allocator not reused");
+	again.reset();
+	second.reset();
+	third.reset();
+
+	// allocators go back to the thread that requested them, even if they are returned from another one
+	fence->Signal(4);
+	size_t countBefore = NumAllocators();
+	{
+		std::mutex mutex;
+		std::condition_variable cv;
+		CmdAllocPtr workerAllocator;
+		bool returned = false;
+		std::thread worker([&] {
+			CmdAllocPtr allocator = pool.RequestAllocator(eCommandListType::GRAPHICS);
+			std::unique_lock<std::mutex> lk(mutex);
+			workerAllocator = std::move(allocator);
+			cv.notify_all();
+			cv.wait(lk, [&] { return returned; });
+			workerAllocator = pool.RequestAllocator(eCommandListType::GRAPHICS);
+		});
+		{
+			std::unique_lock<std::mutex> lk(mutex);
+			cv.wait(lk, [&] { return (bool)workerAllocator; });
+			Check(NumAllocators() == countBefore + 1, "Thread did not get its own allocator");
+			pool.RecycleAllocator(std::move(workerAllocator), SyncPoint(fence, 4));
+			returned = true;
+			cv.notify_all();
+		}
+		worker.join();
+		Check(NumAllocators() == countBefore + 1, "Allocator not returned to the requesting thread");
+	}
+
+	// the pool shrinks to the peak usage
+	{
+		std::vector<CmdAllocPtr> burst;
+		for (int i = 0; i < 16; ++i) {
+			burst.push_back(pool.RequestAllocator(eCommandListType::GRAPHICS));
+		}
+	}
+	size_t peakCount = NumAllocators();
+	for (unsigned i = 0; i < 2 * impl::CommandAllocatorPool<eCommandListType::GRAPHICS>::TrimInterval; ++i) {
+		CmdAllocPtr a = pool.RequestAllocator(eCommandListType::GRAPHICS);
+		CmdAllocPtr b = pool.RequestAllocator(eCommandListType::GRAPHICS);
+	}
+	Check(peakCount >= 16 && NumAllocators() <= 2 + 1, "Unused allocators not released"); // +1 kept by the worker thread
+
+	// types are pooled separately
+	CmdAllocPtr copyAllocator = pool.RequestAllocator(eCommandListType::COPY);
+	Check(copyAllocator->GetType() == eCommandListType::COPY && pool.GetNumAllocators(eCommandListType::COPY) == 1, "Allocator of wrong type");
+	copyAllocator.reset();
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
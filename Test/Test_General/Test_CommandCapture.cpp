@@ -0,0 +1,184 @@
+#include "Test.hpp"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <cstdio>
+#include "GraphicsApi_Capture/GxapiManager.hpp"
+#include "GraphicsApi_Capture/GraphicsApi.hpp"
+#include "GraphicsApi_Capture/CaptureAnalyzer.hpp"
+#include "GraphicsApi_Capture/CaptureFormat.hpp"
+#include "GraphicsApi_Capture/Objects.hpp"
+#include "GraphicsApi_Null/GxapiManager.hpp"
+#include "GraphicsApi_LL/ICommandAllocator.hpp"
+#include "GraphicsApi_LL/ICommandList.hpp"
+#include "GraphicsApi_LL/ICommandQueue.hpp"
+#include "GraphicsApi_LL/IDescriptorHeap.hpp"
+#include "GraphicsApi_LL/IPipelineState.hpp"
+#include "GraphicsApi_LL/IResource.hpp"
+#include "GraphicsApi_LL/Exception.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestCommandCapture : public AutoRegisterTest<TestCommandCapture> {
+public:
+	TestCommandCapture() {}
+
+	static std::string Name() {
+		return "Command Capture";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestCommandCapture::Run() {
+	using namespace inl::gxapi;
+	using namespace inl::gxapi_capture;
+
+	std::unique_ptr<IGxapiManager> gxapiManager(new inl::gxapi_capture::GxapiManager(new inl::gxapi_null::GxapiManager()));
+	std::unique_ptr<IGraphicsApi> graphicsApi(gxapiManager->CreateGraphicsApi(0));
+	auto* captureApi = static_cast<inl::gxapi_capture::GraphicsApi*>(graphicsApi.get());
+
+	std::unique_ptr<ICommandQueue> queue(graphicsApi->CreateCommandQueue(CommandQueueDesc{ eCommandListType::GRAPHICS }));
+	std::unique_ptr<ICommandAllocator> allocator(graphicsApi->CreateCommandAllocator(eCommandListType::GRAPHICS));
+	std::unique_ptr<IGraphicsCommandList> list(graphicsApi->CreateGraphicsCommandList(CommandListDesc{ allocator.get() }));
+	GraphicsPipelineStateDesc psoDesc;
+	psoDesc.rootSignature = nullptr;
+	std::unique_ptr<IPipelineState> pso(graphicsApi->CreateGraphicsPipelineState(psoDesc));
+	std::unique_ptr<IResource> texture(graphicsApi->CreateCommittedResource(HeapProperties{}, eHeapFlags::NONE, ResourceDesc::Buffer(256), eResourceState::COMMON));
+	std::unique_ptr<IDescriptorHeap> heap(graphicsApi->CreateDescriptorHeap(DescriptorHeapDesc{ eDescriptorHeapType::CBV_SRV_UAV, 8, false }));
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// a frame with a few deliberate redundancies
+	auto RecordFrame = [&] {
+		graphicsApi->CopyDescriptors(heap->At(0), heap->At(4), 4, eDescriptorHeapType::CBV_SRV_UAV);
+
+		list->SetPipelineState(pso.get());
+		list->SetPipelineState(pso.get()); // redundant
+		list->ResourceBarrier(TransitionBarrier{ texture.get(), eResourceState::COMMON, eResourceState::COPY_DEST });
+		list->ResourceBarrier(TransitionBarrier{ texture.get(), eResourceState::COPY_DEST, eResourceState::COPY_DEST }); // redundant
+		list->SetGraphicsRootDescriptorTable(0, heap->At(0));
+		list->DrawIndexedInstanced(36);
+		list->SetGraphicsRootDescriptorTable(0, heap->At(0)); // redundant
+		list->DrawIndexedInstanced(3000, 0, 0, 10);
+		list->DrawInstanced(3);
+		list->Close();
+
+		ICommandList* lists[] = { list.get() };
+		queue->ExecuteCommandLists(1, lists);
+		captureApi->EndFrame();
+		list->Reset(allocator.get());
+	};
+
+	// two identical frames
+	RecordFrame();
+	RecordFrame();
+
+	std::vector<uint8_t> capture = captureApi->GetCapture();
+	CaptureStatistics stats = AnalyzeCapture(capture.data(), capture.size());
+	PrintCaptureReport(cout, stats);
+
+	const FrameStatistics& total = stats.total;
+	bool isCorrect = stats.frames.size() == 2
+		&& total.draws == 6 && total.indexedDraws == 4 && total.commandLists == 2
+		&& total.pipelineStateBinds == 4 && total.redundantPipelineStateBinds == 2
+		&& total.barriers == 4 && total.redundantBarriers == 2
+		&& total.descriptorTableBinds == 4 && total.redundantDescriptorTableBinds == 2
+		&& total.descriptorsCopied == 8
+		&& stats.drawSizeHistogram[1] == 2 // 3 vertices
+		&& stats.drawSizeHistogram[5] == 2 // 36 indices
+		&& stats.drawSizeHistogram[14] == 2; // 30000 indices
+	Check(isCorrect, "Replayed statistics do not match the recorded calls.");
+
+	// ids live as long as their objects, a new object at a reused address gets a new id
+	{
+		uint32_t textureId = GetObjectId(texture.get());
+		texture.reset();
+		texture.reset(graphicsApi->CreateCommittedResource(HeapProperties{}, eHeapFlags::NONE, ResourceDesc::Buffer(256), eResourceState::COMMON));
+		Check(textureId != 0 && GetObjectId(texture.get()) != 0 && GetObjectId(texture.get()) != textureId, "Id of a released object reused.");
+		Check(Unwrap(texture.get()) != nullptr && Unwrap(texture.get()) != texture.get(), "Resource not wrapped.");
+	}
+
+	// the capture kept in memory stays within the limit by dropping the oldest frames as a whole
+	{
+		const size_t headerSize = 8;
+		const size_t frameSize = (capture.size() - headerSize) / 2;
+		captureApi->SetMemoryLimit(headerSize + 3 * frameSize);
+		for (int frame = 0; frame < 10; ++frame) {
+			RecordFrame();
+		}
+		std::vector<uint8_t> limited = captureApi->GetCapture();
+		CaptureStatistics limitedStats = AnalyzeCapture(limited.data(), limited.size());
+		Check(limited.size() == headerSize + 3 * frameSize && limitedStats.frames.size() == 3 && limitedStats.total.draws == 9,
+			  "Frames not dropped as a whole to fit in the memory limit.");
+		Check(captureApi->GetNumDroppedFrames() == 9, "Dropped frames not counted.");
+
+		// a frame too large on its own is dropped as well
+		captureApi->SetMemoryLimit(frameSize / 2);
+		RecordFrame();
+		limited = captureApi->GetCapture();
+		limitedStats = AnalyzeCapture(limited.data(), limited.size());
+		Check(limitedStats.frames.empty() && captureApi->GetNumDroppedFrames() == 13, "Frame larger than the limit kept.");
+		captureApi->SetMemoryLimit(GraphicsApi::DefaultMemoryLimit);
+	}
+
+	// counts are checked against the bytes left, a hostile count is rejected instead of allocated
+	{
+		std::vector<uint8_t> hostile(capture.begin(), capture.begin() + 8); // header
+		hostile.push_back((uint8_t)eCaptureCommand::SET_DESCRIPTOR_HEAPS);
+		for (int i = 0; i < 4; ++i) {
+			hostile.push_back(0xFF);
+		}
+		hostile.push_back(0);
+		bool thrown = false;
+		try {
+			AnalyzeCapture(hostile.data(), hostile.size());
+		}
+		catch (InvalidArgument&) {
+			thrown = true;
+		}
+		Check(thrown, "Descriptor heap count larger than the capture accepted.");
+	}
+
+	// streamed to a file at the end of each frame
+	{
+		const char* path = "Test_CommandCapture.icap";
+		captureApi->StreamToFile(path);
+		for (int frame = 0; frame < 3; ++frame) {
+			RecordFrame();
+		}
+
+		bool thrown = false;
+		try {
+			captureApi->GetCapture();
+		}
+		catch (InvalidCall&) {
+			thrown = true;
+		}
+		Check(thrown, "Capture returned from memory while streaming.");
+
+		std::ifstream file(path, std::ios::binary);
+		std::vector<char> streamed{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		file.close();
+		std::remove(path);
+		CaptureStatistics streamedStats = AnalyzeCapture(streamed.data(), streamed.size());
+		Check(streamedStats.frames.size() == 3 && streamedStats.total.draws == 9, "Streamed capture incomplete.");
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,270 @@
+#include "Test.hpp"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsApi_LL/ICommandQueue.hpp"
+#include "GraphicsEngine_LL/BindlessHeap.hpp"
+#include "GraphicsEngine_LL/CommandListCache.hpp"
+#include "GraphicsEngine_LL/GraphicsCommandList.hpp"
+#include "GraphicsEngine_LL/GraphicsNode.hpp"
+#include "GraphicsEngine_LL/Scheduler.hpp"
+#include "BaseLibrary/Logging_All.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Node classes
+//------------------------------------------------------------------------------
+
+namespace {
+
+using namespace inl::gxeng;
+
+// Draws twice into a render target. The recording depends on the version set on its input.
+class KeyedDrawNode :
+	virtual public GraphicsNode,
+	virtual public GraphicsTask,
+	virtual public exc::InputPortConfig<uint64_t>,
+	virtual public exc::OutputPortConfig<uint64_t>
+{
+public:
+	KeyedDrawNode(const Texture2D& target, bool reusable = true, bool useVolatileMemory = false)
+		: m_target(target), m_reusable(reusable), m_useVolatileMemory(useVolatileMemory)
+	{
+		GetInput<0>().Set(0);
+		SetTaskSingle(this);
+	}
+
+	void Update() override {}
+	void Notify(exc::InputPortBase* sender) override {}
+	void Initialize(EngineContext& context) override { SetTaskSingle(this); }
+	void Reset() override {}
+
+	void Setup(SetupContext& context) override {
+		m_version = GetInput<0>().Get();
+		GetOutput<0>().Set(m_version);
+	}
+	void Execute(RenderContext& context) override {
+		++numExecuted;
+		GraphicsCommandList& commandList = context.AsGraphics();
+		commandList.SetResourceState(m_target, inl::gxapi::eResourceState::RENDER_TARGET);
+		if (m_useVolatileMemory) {
+			float constants[4] = { 0, 0, 0, 0 };
+			context.CreateVolatileConstBuffer(constants, sizeof(constants));
+		}
+		commandList.DrawInstanced(3);
+		commandList.DrawInstanced(3);
+	}
+	bool GetRecordingKeys(std::vector<uint64_t>& keys) const override {
+		keys.push_back(m_version);
+		keys.push_back(42);
+		return m_reusable;
+	}
+
+	int numExecuted = 0;
+
+private:
+	Texture2D m_target;
+	bool m_reusable;
+	bool m_useVolatileMemory;
+	uint64_t m_version = 0;
+};
+
+
+// Reads the render target, so the target must be transitioned back before reused recordings.
+class ReadNode :
+	virtual public GraphicsNode,
+	virtual public GraphicsTask,
+	virtual public exc::InputPortConfig<uint64_t>,
+	virtual public exc::OutputPortConfig<uint64_t>
+{
+public:
+	ReadNode(const Texture2D& source) : m_source(source) {
+		GetInput<0>().Set(0);
+		SetTaskSingle(this);
+	}
+
+	void Update() override {}
+	void Notify(exc::InputPortBase* sender) override {}
+	void Initialize(EngineContext& context) override { SetTaskSingle(this); }
+	void Reset() override {}
+
+	void Setup(SetupContext& context) override {}
+	void Execute(RenderContext& context) override {
+		GraphicsCommandList& commandList = context.AsGraphics();
+		commandList.SetResourceState(m_source, inl::gxapi::eResourceState::PIXEL_SHADER_RESOURCE);
+		commandList.DrawInstanced(3);
+	}
+
+private:
+	Texture2D m_source;
+};
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestCommandListCache : public AutoRegisterTest<TestCommandListCache> {
+public:
+	TestCommandListCache() {}
+
+	static std::string Name() {
+		return "Command List Cache";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestCommandListCache::Run() {
+	using namespace inl::gxapi;
+	using namespace inl::gxeng;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// what the engine gives the scheduler each frame
+	inl::gxapi_null::GraphicsApi gxapi;
+	std::stringstream logText;
+	exc::Logger logger;
+	logger.OpenStream(&logText);
+	exc::LogStream log = logger.CreateLogStream("Command List Cache");
+	CommandAllocatorPool commandAllocatorPool(&gxapi);
+	BindlessHeap bindlessHeap(&gxapi, 16, 32, 1000);
+	ScratchSpacePool scratchSpacePool(&gxapi, eDescriptorHeapType::CBV_SRV_UAV, &bindlessHeap);
+	MemoryManager memoryManager(&gxapi);
+	CbvSrvUavHeap textureSpace(&gxapi);
+	RTVHeap rtvHeap(&gxapi);
+	DSVHeap dsvHeap(&gxapi);
+	CommandQueue commandQueue(&gxapi, eCommandListType::GRAPHICS);
+	ResourceResidencyQueue residencyQueue{ std::unique_ptr<IFence>(gxapi.CreateFence(0)) };
+	residencyQueue.SetMemoryManager(&memoryManager);
+
+	Texture2D backBufferTexture = memoryManager.CreateTexture2D(eResourceHeapType::CRITICAL, 64, 64, eFormat::R8G8B8A8_UNORM, eResourceFlags::ALLOW_RENDER_TARGET);
+	RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+	RenderTargetView2D backBuffer(backBufferTexture, rtvHeap, eFormat::R8G8B8A8_UNORM, rtvDesc);
+	Texture2D target = memoryManager.CreateTexture2D(eResourceHeapType::CRITICAL, 64, 64, eFormat::R8G8B8A8_UNORM, eResourceFlags::ALLOW_RENDER_TARGET);
+	std::vector<UploadManager::UploadDescription> uploads;
+
+	uint64_t frame = 0;
+	auto RunFrame = [&](Scheduler& scheduler) {
+		FrameContext context;
+		context.log = &log;
+		context.frame = ++frame;
+		context.gxApi = &gxapi;
+		context.commandAllocatorPool = &commandAllocatorPool;
+		context.scratchSpacePool = &scratchSpacePool;
+		context.bindlessHeap = &bindlessHeap;
+		context.memoryManager = &memoryManager;
+		context.textureSpace = &textureSpace;
+		context.rtvHeap = &rtvHeap;
+		context.dsvHeap = &dsvHeap;
+		context.commandQueue = &commandQueue;
+		context.backBuffer = &backBuffer;
+		context.uploadRequests = &uploads;
+		context.residencyQueue = &residencyQueue;
+
+		memoryManager.BeginFrame(context.frame);
+		scheduler.Execute(context);
+		commandQueue.Signal().Wait();
+
+		// The residency queue recycles scratch spaces on its own thread, lists piling up would make the bindless heap grow.
+		// A marker enqueued after the frame is cleaned together with or after the lists of the frame.
+		auto marker = std::make_shared<int>(0);
+		std::weak_ptr<int> markerAlive = marker;
+		residencyQueue.EnqueueInit({});
+		residencyQueue.EnqueueClean(commandQueue.Signal(), {}, std::move(marker));
+		auto waitStart = std::chrono::steady_clock::now();
+		while (!markerAlive.expired() && std::chrono::steady_clock::now() - waitStart < std::chrono::seconds(5)) {
+			std::this_thread::yield();
+		}
+	};
+
+	auto sky = std::make_shared<KeyedDrawNode>(target);
+	auto post = std::make_shared<KeyedDrawNode>(target);
+	auto dynamic = std::make_shared<KeyedDrawNode>(target, false);
+	auto constants = std::make_shared<KeyedDrawNode>(target, true, true);
+	auto read = std::make_shared<ReadNode>(target);
+	post->GetInput<0>().Link(sky->GetOutput(0));
+	dynamic->GetInput<0>().Link(post->GetOutput(0));
+	constants->GetInput<0>().Link(dynamic->GetOutput(0));
+	read->GetInput<0>().Link(constants->GetOutput(0));
+
+	Scheduler scheduler;
+	{
+		Pipeline pipeline;
+		pipeline.CreateFromNodesList({ sky, post, dynamic, constants, read });
+		scheduler.SetPipeline(std::move(pipeline));
+	}
+	const CommandListCache& cache = scheduler.GetCommandListCache();
+
+	// unchanged keys reuse the recording, each submission draws again
+	auto statsBefore = gxapi.GetStatistics();
+	for (int i = 0; i < 3; ++i) {
+		RunFrame(scheduler);
+	}
+	auto stats = gxapi.GetStatistics();
+	Check(sky->numExecuted == 1 && post->numExecuted == 1, "Recording not reused");
+	Check(cache.GetNumRecordings() == 2, "Wrong recordings cached");
+	Check(stats.draws - statsBefore.draws == 3 * 9, "Reused recording not submitted");
+
+	// reused recordings get the barriers they recorded, the target is read at the end of each frame
+	Check(target.ReadState(0) == eResourceState::PIXEL_SHADER_RESOURCE, "Resource state not tracked through reused recordings");
+	Check(stats.barriers - statsBefore.barriers >= 3 * 2, "Reused recording submitted without its barriers");
+
+	// tasks that are not reusable, or used volatile memory, are recorded every time
+	Check(dynamic->numExecuted == 3, "Task recorded once despite not being reusable");
+	Check(constants->numExecuted == 3, "Recording with volatile memory reused");
+
+	// changed keys record again, the old recording lives until its last submission completes
+	sky->GetInput<0>().Set(1);
+	RunFrame(scheduler);
+	Check(sky->numExecuted == 2 && post->numExecuted == 2, "Changed keys did not record again");
+	Check(cache.GetNumRecordings() == 2, "Replaced recording kept");
+	RunFrame(scheduler);
+	Check(sky->numExecuted == 2 && post->numExecuted == 2, "Recording with new keys not reused");
+	Check(cache.GetNumRetired() == 0, "Completed recordings not released");
+
+	// releasing the resources drops the recordings
+	scheduler.ReleaseResources();
+	Check(cache.GetNumRecordings() == 0, "Recordings kept after releasing resources");
+	RunFrame(scheduler);
+	Check(sky->numExecuted == 3 && post->numExecuted == 3, "Tasks not recorded again after releasing resources");
+
+	// recordings bound to a replaced bindless heap are recorded again
+	{
+		std::vector<ScratchSpacePtr> scratchSpaces;
+		while (bindlessHeap.GetNumHeaps() == 1) {
+			scratchSpaces.push_back(scratchSpacePool.RequestScratchSpace());
+		}
+		RunFrame(scheduler);
+		Check(sky->numExecuted == 4 && post->numExecuted == 4, "Recording bound to a replaced heap reused");
+		RunFrame(scheduler);
+		Check(sky->numExecuted == 4 && post->numExecuted == 4, "Recording bound to the new heap not reused");
+	}
+	Check(bindlessHeap.GetNumHeaps() == 1, "Replaced heap kept alive by recordings");
+
+	logger.Flush();
+	Check(logText.str().find("Fatal pipeline error") == std::string::npos, "Pipeline failed");
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
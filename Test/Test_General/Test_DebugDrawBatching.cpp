@@ -0,0 +1,115 @@
+#include "Test.hpp"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include "GraphicsEngine_LL/Nodes/DebugDrawManager.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestDebugDrawBatching : public AutoRegisterTest<TestDebugDrawBatching> {
+public:
+	TestDebugDrawBatching() {}
+
+	static std::string Name() {
+		return "Debug Draw Batching";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestDebugDrawBatching::Run() {
+	using namespace inl::gxeng;
+	using Vec3 = mathfu::Vector<float, 3>;
+
+	DebugDrawManager& ddm = DebugDrawManager::GetInstance();
+	std::vector<DebugVertex> vertices;
+	int errors = 0;
+
+	auto Merge = [&]() {
+		vertices.clear();
+		ddm.MergeFrame(vertices);
+		return vertices.size();
+	};
+	while (Merge() > 0);
+
+	// shapes expand to lines
+	ddm.AddLine({ 0, 0, 0 }, { 1, 0, 0 }, 0);
+	ddm.AddCross({ 0, 0, 0 }, 1, 0);
+	ddm.AddBox({ -1, -1, -1 }, { 1, 1, 1 }, 0);
+	ddm.AddSphere({ 0, 0, 0 }, 1, 0);
+	ddm.AddFrustum({ -1, -1, 1 }, { -1, 1, 1 }, { 1, -1, 1 }, { -2, -2, 2 }, { -2, 2, 2 }, { 2, -2, 2 }, 0);
+	size_t expected = 2 * (1 + 3 + 12 + 3 * 32 + 12);
+	if (Merge() != expected) {
+		cout << "Shapes gave " << vertices.size() << " vertices instead of " << expected << endl;
+		++errors;
+	}
+
+	// lifetime
+	ddm.AddLine({ 0, 0, 0 }, { 1, 0, 0 }, 2);
+	ddm.AddLine({ 0, 0, 0 }, { 0, 1, 0 }, 0);
+	size_t lifetime[4] = { Merge(), Merge(), Merge(), Merge() };
+	if (lifetime[0] != 4 || lifetime[1] != 2 || lifetime[2] != 2 || lifetime[3] != 0) {
+		cout << "Lifetime gave " << lifetime[0] << ", " << lifetime[1] << ", " << lifetime[2] << ", " << lifetime[3] << " vertices" << endl;
+		++errors;
+	}
+
+	// color packing
+	ddm.AddLine({ 0, 0, 0 }, { 1, 0, 0 }, 0, { 1.0f, 0.0f, 2.0f });
+	Merge();
+	if (vertices.size() != 2 || vertices[0].color != 0xFFFF00FFu || vertices[1].color != 0xFFFF00FFu) {
+		cout << "Color packed incorrectly" << endl;
+		++errors;
+	}
+
+	// recording from many threads
+	constexpr int NumThreads = 4;
+	constexpr int LinesPerThread = 10'000;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NumThreads; ++t) {
+		threads.emplace_back([&ddm, t] {
+			for (int i = 0; i < LinesPerThread; ++i) {
+				ddm.AddLine({ (float)t, (float)i, 0 }, { (float)t, (float)i, 1 }, 0);
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	if (Merge() != 2 * NumThreads * LinesPerThread) {
+		cout << "Threads recorded " << vertices.size() / 2 << " lines instead of " << NumThreads * LinesPerThread << endl;
+		++errors;
+	}
+
+	// benchmark recording
+	constexpr int NumBoxes = 100'000;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < NumBoxes; ++i) {
+		Vec3 pos((float)i, 0, 0);
+		ddm.AddBox(pos, pos + Vec3(1, 1, 1), 0);
+	}
+	auto midTime = std::chrono::high_resolution_clock::now();
+	Merge();
+	auto endTime = std::chrono::high_resolution_clock::now();
+
+	auto recordNs = std::chrono::duration_cast<std::chrono::nanoseconds>(midTime - startTime).count();
+	auto mergeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - midTime).count();
+	cout << "Benchmark:" << endl;
+	cout << "Record " << NumBoxes << " boxes = " << recordNs / 1e6 << " ms (" << (double)recordNs / (12 * NumBoxes) << " ns/line)" << endl;
+	cout << "Merge = " << mergeNs / 1e6 << " ms" << endl;
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,180 @@
+#include "Test.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include "GraphicsEngine_LL/FoliageCulling.hpp"
+
+#include <mathfu/matrix_4x4.h>
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestFoliage : public AutoRegisterTest<TestFoliage> {
+public:
+	TestFoliage() {}
+
+	static std::string Name() {
+		return "Foliage";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestFoliage::Run() {
+	using namespace inl::gxeng;
+	using Vec3 = mathfu::Vector<float, 3>;
+	using Mat4 = mathfu::Matrix<float, 4, 4>;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	const float pi = 3.14159265f;
+	const Vec3 meshMinimum(-2.0f, -2.0f, 0.0f);
+	const Vec3 meshMaximum(2.0f, 2.0f, 10.0f);
+
+	// camera at the origin, looking along +X with Z up
+	Vec3 cameraPosition(0.0f, 0.0f, 2.0f);
+	Mat4 view = Mat4::LookAt(cameraPosition + Vec3(1.0f, 0.0f, 0.0f), cameraPosition, Vec3(0.0f, 0.0f, 1.0f), 1.0f);
+	Mat4 projection = Mat4::Perspective(pi / 3.0f, 16.0f / 9.0f, 0.1f, 2000.0f, 1.0f);
+	FoliageFrustum frustum = ExtractFoliageFrustum(projection * view);
+
+	// instances are grouped by cells of the ground plane
+	{
+		FoliageEntity entity(10.0f);
+		entity.AddInstance({ { 1.0f, 1.0f, 0.0f }, 0.0f, 1.0f });
+		entity.AddInstance({ { 9.0f, 2.0f, 0.0f }, 0.0f, 2.0f });
+		entity.AddInstance({ { 11.0f, 2.0f, 0.0f }, 0.0f, 1.0f });
+		entity.AddInstance({ { -1.0f, 2.0f, 0.0f }, 0.0f, 1.0f });
+		Check(entity.GetChunks().size() == 3 && entity.GetNumInstances() == 4, "Instances not grouped by cell");
+		const FoliageChunk& first = entity.GetChunks()[0];
+		Check(first.instances.size() == 2 && first.maxScale == 2.0f && first.minimum.x() == 1.0f && first.maximum.x() == 9.0f, "Bad chunk bounds");
+
+		// shadows cull whole chunks, their bounds must hold the meshes in any rotation
+		Vec3 minimum, maximum;
+		GetFoliageChunkBounds(first, meshMinimum, meshMaximum, minimum, maximum);
+		const float reach = 2.0f * std::sqrt(8.0f);
+		Check(std::abs(minimum.x() - (1.0f - reach)) < 1e-4f && std::abs(maximum.x() - (9.0f + reach)) < 1e-4f
+			  && minimum.z() == 0.0f && maximum.z() == 20.0f, "Bad chunk bounds with the mesh");
+		entity.ClearInstances();
+		Check(entity.GetChunks().empty() && entity.GetNumInstances() == 0, "Instances not cleared");
+
+		bool thrown = false;
+		try {
+			FoliageEntity invalid(0.0f);
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		Check(thrown, "Zero chunk size accepted");
+	}
+
+	// a row of trees along the view direction, one behind the camera
+	{
+		FoliageEntity entity(16.0f);
+		entity.SetImpostorDistance(100.0f);
+		for (float x = -50.0f; x <= 400.0f; x += 10.0f) {
+			entity.AddInstance({ { x, 0.0f, 0.0f }, 0.0f, 1.0f });
+		}
+
+		FoliageDrawList drawList;
+		CullFoliage(entity, meshMinimum, meshMaximum, frustum, cameraPosition, drawList);
+		Check(drawList.meshInstances.size() == 10 && drawList.impostorInstances.empty(), "Impostors drawn without an atlas");
+
+		Image* fakeAtlas = reinterpret_cast<Image*>(&entity); // never dereferenced by culling
+		entity.SetImpostor(fakeAtlas, 8);
+		CullFoliage(entity, meshMinimum, meshMaximum, frustum, cameraPosition, drawList);
+		bool split = true;
+		for (const auto& instance : drawList.meshInstances) {
+			split = split && instance.position.data[0] >= -5.0f && instance.position.data[0] <= 100.0f;
+		}
+		for (const auto& instance : drawList.impostorInstances) {
+			split = split && instance.position.data[0] > 99.0f;
+		}
+		Check(split, "Instances on the wrong side of the impostor distance");
+		Check(drawList.meshInstances.size() == 10 && drawList.impostorInstances.size() == 31, "Wrong number of visible instances");
+
+		// trees just behind the camera are kept while their crowns may reach into view
+		entity.ClearInstances();
+		entity.AddInstance({ { -1.0f, 0.0f, 0.0f }, 0.0f, 1.0f });
+		entity.AddInstance({ { -200.0f, 0.0f, 0.0f }, 0.0f, 1.0f });
+		entity.AddInstance({ { 50.0f, 300.0f, 0.0f }, 0.0f, 1.0f });
+		CullFoliage(entity, meshMinimum, meshMaximum, frustum, cameraPosition, drawList);
+		Check(drawList.numVisibleChunks == 1 && drawList.meshInstances.size() == 1, "Chunks outside the frustum not culled");
+
+		entity.SetDrawDistance(150.0f);
+		entity.AddInstance({ { 140.0f, 0.0f, 0.0f }, 0.0f, 1.0f });
+		entity.AddInstance({ { 160.0f, 0.0f, 0.0f }, 0.0f, 1.0f });
+		entity.AddInstance({ { 400.0f, 0.0f, 0.0f }, 0.0f, 1.0f });
+		CullFoliage(entity, meshMinimum, meshMaximum, frustum, cameraPosition, drawList);
+		Check(drawList.impostorInstances.size() == 1 && drawList.impostorInstances[0].position.data[0] == 140.0f, "Draw distance not respected");
+	}
+
+	// impostor views follow the camera around the instance
+	{
+		FoliageInstance instance = { { 0.0f, 0.0f, 0.0f }, 0.0f, 1.0f };
+		Check(SelectImpostorView(instance, Vec3(1.0f, 0.0f, 0.0f), 8) == 0, "Bad impostor view from +X");
+		Check(SelectImpostorView(instance, Vec3(0.0f, 1.0f, 0.0f), 8) == 2, "Bad impostor view from +Y");
+		Check(SelectImpostorView(instance, Vec3(1.0f, -0.01f, 0.0f), 8) == 0, "Bad impostor view just below +X");
+		instance.rotation = pi / 2.0f;
+		Check(SelectImpostorView(instance, Vec3(0.0f, 1.0f, 0.0f), 8) == 0, "Instance rotation ignored by impostor view");
+		Check(SelectImpostorView(instance, Vec3(-1.0f, 0.0f, 0.0f), 8) == 2, "Bad impostor view of rotated instance");
+	}
+
+	// benchmark: a forest of 100K trees
+	{
+		constexpr int NumInstances = 100000;
+		constexpr int NumFrames = 50;
+		FoliageEntity forest(32.0f);
+		forest.SetImpostor(reinterpret_cast<Image*>(&forest), 8);
+		forest.SetImpostorDistance(150.0f);
+		forest.SetDrawDistance(1500.0f);
+
+		std::mt19937 rne(2718);
+		std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 2.0f * pi);
+		std::uniform_real_distribution<float> scale(0.8f, 1.2f);
+		std::vector<FoliageInstance> instances(NumInstances);
+		for (auto& instance : instances) {
+			instance = { { coordinate(rne), coordinate(rne), 0.0f }, angle(rne), scale(rne) };
+		}
+		auto buildStart = std::chrono::high_resolution_clock::now();
+		forest.AddInstances(instances.data(), instances.size());
+		auto buildEnd = std::chrono::high_resolution_clock::now();
+
+		FoliageDrawList drawList;
+		size_t numDrawn = 0;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < NumFrames; ++frame) {
+			float heading = 2.0f * pi * frame / NumFrames;
+			Vec3 forward(std::cos(heading), std::sin(heading), 0.0f);
+			Mat4 frameView = Mat4::LookAt(cameraPosition + forward, cameraPosition, Vec3(0.0f, 0.0f, 1.0f), 1.0f);
+			CullFoliage(forest, meshMinimum, meshMaximum, ExtractFoliageFrustum(projection * frameView), cameraPosition, drawList);
+			numDrawn += drawList.meshInstances.size() + drawList.impostorInstances.size();
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+		Check(numDrawn > 0 && numDrawn < (size_t)NumInstances * NumFrames / 2, "Benchmark culled nothing or everything");
+
+		auto buildNs = std::chrono::duration_cast<std::chrono::nanoseconds>(buildEnd - buildStart).count();
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+		cout << "Benchmark:" << endl;
+		cout << NumInstances << " instances added = " << buildNs / 1e6 << " ms (" << forest.GetChunks().size() << " chunks)" << endl;
+		cout << NumFrames << " frames culled = " << ns / 1e6 << " ms (" << ns / 1e6 / NumFrames << " ms/frame, "
+			<< numDrawn / NumFrames << " instances drawn/frame, " << (double)ns / ((double)NumInstances * NumFrames) << " ns/instance)" << endl;
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
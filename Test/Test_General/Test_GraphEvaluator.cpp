@@ -0,0 +1,212 @@
+#include "Test.hpp"
+
+#include <BaseLibrary/Graph/GraphEvaluator.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+using std::cout;
+using std::endl;
+using namespace exc;
+
+
+//------------------------------------------------------------------------------
+// Node classes
+//------------------------------------------------------------------------------
+
+namespace {
+
+// updates eagerly when notified, like the nodes of the node library
+class CountingAddNode : public InputPortConfig<int, int>, public OutputPortConfig<int> {
+public:
+	CountingAddNode() {
+		GetInput<0>().AddObserver(this);
+		GetInput<1>().AddObserver(this);
+	}
+
+	void Update() override {
+		++numUpdates;
+		GetOutput<0>().Set(GetInput<0>().Get() + GetInput<1>().Get());
+	}
+	void Notify(InputPortBase*) override {
+		Update();
+	}
+
+	static size_t numUpdates;
+};
+
+size_t CountingAddNode::numUpdates = 0;
+
+
+std::vector<NodeBase*> Pointers(const std::vector<std::unique_ptr<CountingAddNode>>& nodes) {
+	std::vector<NodeBase*> pointers;
+	for (auto& node : nodes) {
+		pointers.push_back(node.get());
+	}
+	return pointers;
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestGraphEvaluator : public AutoRegisterTest<TestGraphEvaluator> {
+public:
+	TestGraphEvaluator() {}
+
+	static std::string Name() {
+		return "Graph Evaluator";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestGraphEvaluator::Run() {
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// a diamond followed by a chain, listed out of order:
+	// a -> b, a -> c, b + c -> d -> e -> f, and g on its own
+	std::vector<std::unique_ptr<CountingAddNode>> nodes;
+	for (int i = 0; i < 7; ++i) {
+		nodes.push_back(std::make_unique<CountingAddNode>());
+	}
+	CountingAddNode &f = *nodes[0], &e = *nodes[1], &d = *nodes[2], &c = *nodes[3], &b = *nodes[4], &a = *nodes[5], &g = *nodes[6];
+	b.GetInput<0>().Link(a.GetOutput(0));
+	c.GetInput<0>().Link(a.GetOutput(0));
+	d.GetInput<0>().Link(b.GetOutput(0));
+	d.GetInput<1>().Link(c.GetOutput(0));
+	e.GetInput<0>().Link(d.GetOutput(0));
+	f.GetInput<0>().Link(e.GetOutput(0));
+
+	{
+		GraphEvaluator evaluator(Pointers(nodes));
+
+		const auto& order = evaluator.GetOrder();
+		auto Rank = [&](NodeBase& node) { return std::find(order.begin(), order.end(), &node) - order.begin(); };
+		Check(Rank(a) < Rank(b) && Rank(a) < Rank(c) && Rank(b) < Rank(d) && Rank(c) < Rank(d) && Rank(d) < Rank(e) && Rank(e) < Rank(f),
+			  "Order is not topological");
+
+		// inputs set by hand no longer update the node right away
+		CountingAddNode::numUpdates = 0;
+		a.GetInput<0>().Set(1);
+		b.GetInput<1>().Set(10);
+		c.GetInput<1>().Set(100);
+		Check(CountingAddNode::numUpdates == 0, "Node updated when its input was set");
+
+		// the first evaluation visits every node once
+		size_t numUpdated = evaluator.Evaluate();
+		Check(numUpdated == 7 && CountingAddNode::numUpdates == 7, "First evaluation did not update each node once");
+		Check(f.GetInput<0>().Get() == 1 + 10 + 1 + 100, "Wrong value at the end of the chain");
+		Check(evaluator.Evaluate() == 0, "Clean graph evaluated again");
+
+		// a change visits only what is downstream of it
+		c.GetInput<1>().Set(200);
+		Check(evaluator.IsDirty(&c) && !evaluator.IsDirty(&b) && evaluator.GetNumDirty() == 1, "Wrong nodes dirty");
+		numUpdated = evaluator.Evaluate();
+		Check(numUpdated == 4, "Change did not update exactly c, d, e and f");
+		Check(f.GetInput<0>().Get() == 1 + 10 + 1 + 200, "Change did not reach the end of the chain");
+
+		// nodes can be marked by hand
+		evaluator.MarkDirty(&g);
+		Check(evaluator.Evaluate() == 1, "Marked node not updated alone");
+		bool thrown = false;
+		try {
+			CountingAddNode outsider;
+			evaluator.MarkDirty(&outsider);
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		Check(thrown, "Node outside the graph marked");
+	}
+
+	// once the evaluator is gone, nodes are notified again,
+	// eagerly pushing through both sides of the diamond updates d, e and f twice
+	CountingAddNode::numUpdates = 0;
+	a.GetInput<0>().Set(2);
+	Check(CountingAddNode::numUpdates == 9, "Notifications not given back to the nodes");
+
+	// cycles are rejected
+	{
+		bool thrown = false;
+		a.GetInput<1>().Link(f.GetOutput(0));
+		try {
+			GraphEvaluator evaluator(Pointers(nodes));
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		a.GetInput<1>().Unlink();
+		Check(thrown, "Cycle accepted");
+	}
+
+	// benchmark: many chains, a few of them change each frame
+	{
+		constexpr int NumChains = 1000;
+		constexpr int ChainLength = 10;
+		constexpr int NumChangesPerFrame = 5;
+		constexpr int NumFrames = 200;
+
+		std::vector<std::unique_ptr<CountingAddNode>> graph;
+		for (int chain = 0; chain < NumChains; ++chain) {
+			for (int i = 0; i < ChainLength; ++i) {
+				graph.push_back(std::make_unique<CountingAddNode>());
+				if (i > 0) {
+					graph.back()->GetInput<0>().Link(graph[graph.size() - 2]->GetOutput(0));
+				}
+			}
+		}
+
+		// eager: every head is set each frame and pushes through its chain
+		CountingAddNode::numUpdates = 0;
+		auto eagerStart = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < NumFrames; ++frame) {
+			for (int chain = 0; chain < NumChains; ++chain) {
+				graph[chain * ChainLength]->GetInput<1>().Set(chain == frame % NumChains ? frame : 0);
+			}
+		}
+		auto eagerEnd = std::chrono::high_resolution_clock::now();
+		size_t eagerUpdates = CountingAddNode::numUpdates;
+
+		GraphEvaluator evaluator(Pointers(graph));
+		auto compileEnd = std::chrono::high_resolution_clock::now();
+		evaluator.Evaluate();
+
+		CountingAddNode::numUpdates = 0;
+		auto incrementalStart = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < NumFrames; ++frame) {
+			for (int change = 0; change < NumChangesPerFrame; ++change) {
+				graph[((frame * NumChangesPerFrame + change) % NumChains) * ChainLength]->GetInput<1>().Set(frame);
+			}
+			evaluator.Evaluate();
+		}
+		auto incrementalEnd = std::chrono::high_resolution_clock::now();
+		size_t incrementalUpdates = CountingAddNode::numUpdates;
+		Check(incrementalUpdates == size_t(NumFrames * NumChangesPerFrame * ChainLength), "Incremental evaluation visited unchanged nodes");
+
+		auto eagerNs = std::chrono::duration_cast<std::chrono::nanoseconds>(eagerEnd - eagerStart).count();
+		auto compileNs = std::chrono::duration_cast<std::chrono::nanoseconds>(compileEnd - eagerEnd).count();
+		auto incrementalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(incrementalEnd - incrementalStart).count();
+		cout << "Benchmark:" << endl;
+		cout << NumChains * ChainLength << " nodes compiled = " << compileNs / 1e6 << " ms" << endl;
+		cout << "Eager, all inputs set = " << eagerNs / 1e3 / NumFrames << " us/frame (" << eagerUpdates / NumFrames << " updates/frame)" << endl;
+		cout << "Incremental, " << NumChangesPerFrame << " inputs changed = " << incrementalNs / 1e3 / NumFrames << " us/frame ("
+			<< incrementalUpdates / NumFrames << " updates/frame)" << endl;
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
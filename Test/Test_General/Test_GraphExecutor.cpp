@@ -0,0 +1,289 @@
+#include "Test.hpp"
+
+#include <BaseLibrary/Graph/GraphExecutor.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+using std::cout;
+using std::endl;
+using namespace exc;
+
+
+//------------------------------------------------------------------------------
+// Node classes
+//------------------------------------------------------------------------------
+
+namespace {
+
+// mixes its inputs with some busy work, and records how and where it ran
+class WorkNode : public InputPortConfig<uint64_t, uint64_t>, public OutputPortConfig<uint64_t> {
+public:
+	WorkNode(int work = 0) : work(work) {
+		GetInput<0>().AddObserver(this);
+		GetInput<1>().AddObserver(this);
+	}
+
+	void Update() override {
+		for (WorkNode* producer : producers) {
+			if (!producer->isDone) {
+				++numEarlyStarts;
+			}
+		}
+		uint64_t value = GetInput<0>().Get() * 31 + GetInput<1>().Get();
+		for (int i = 0; i < work; ++i) {
+			value = value * 6364136223846793005ull + 1442695040888963407ull;
+		}
+		thread = std::this_thread::get_id();
+		++numUpdates;
+		GetOutput<0>().Set(value);
+		isDone = true;
+	}
+	void Notify(InputPortBase*) override {
+		Update();
+	}
+
+	void LinkFrom(int input, WorkNode& producer) {
+		GetInput(input)->Link(producer.GetOutput(0));
+		producers.push_back(&producer);
+	}
+	uint64_t Result() const {
+		return GetInput<0>().Get() * 31 + GetInput<1>().Get();
+	}
+
+	int work;
+	std::vector<WorkNode*> producers;
+	std::atomic<bool> isDone{ false };
+	std::thread::id thread;
+	int numUpdates = 0;
+
+	static std::atomic<int> numEarlyStarts;
+};
+
+std::atomic<int> WorkNode::numEarlyStarts{ 0 };
+
+
+class ThrowingNode : public WorkNode {
+public:
+	void Update() override {
+		throw std::runtime_error("Node failed.");
+	}
+};
+
+
+// nodes in layers, each linked to random nodes of earlier layers
+std::vector<std::unique_ptr<WorkNode>> MakeRandomGraph(int numLayers, int layerWidth, int work, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::vector<std::unique_ptr<WorkNode>> nodes;
+	for (int layer = 0; layer < numLayers; ++layer) {
+		for (int i = 0; i < layerWidth; ++i) {
+			auto node = std::make_unique<WorkNode>(work);
+			node->GetInput<0>().Set(layer * layerWidth + i);
+			node->GetInput<1>().Set(1);
+			if (layer > 0) {
+				for (int input = 0; input < 2; ++input) {
+					if (rng() % 4 != 0) {
+						node->LinkFrom(input, *nodes[rng() % (layer * layerWidth)]);
+					}
+				}
+			}
+			nodes.push_back(std::move(node));
+		}
+	}
+	for (auto& node : nodes) {
+		node->numUpdates = 0;
+	}
+	return nodes;
+}
+
+
+template <class NodeT>
+std::vector<NodeBase*> Pointers(const std::vector<std::unique_ptr<NodeT>>& nodes) {
+	std::vector<NodeBase*> pointers;
+	for (auto& node : nodes) {
+		pointers.push_back(node.get());
+	}
+	return pointers;
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestGraphExecutor : public AutoRegisterTest<TestGraphExecutor> {
+public:
+	TestGraphExecutor() {}
+
+	static std::string Name() {
+		return "Graph Executor";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestGraphExecutor::Run() {
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// results match a sequential evaluation, and every node runs after its producers
+	{
+		auto expected = MakeRandomGraph(20, 25, 100, 7);
+		for (auto& node : expected) {
+			node->Update(); // created in a topological order, notifications are harmless
+		}
+
+		auto nodes = MakeRandomGraph(20, 25, 100, 7);
+		GraphExecutor executor(4);
+		executor.Compile(Pointers(nodes));
+		Check(executor.GetNumWorkers() == 4, "Wrong number of workers");
+
+		// inputs set by hand no longer update the node right away
+		nodes[0]->GetInput<1>().Set(1);
+		Check(nodes[0]->numUpdates == 0, "Node updated when its input was set");
+
+		bool allMatch = true;
+		WorkNode::numEarlyStarts = 0;
+		for (int run = 0; run < 10; ++run) {
+			for (auto& node : nodes) {
+				node->isDone = false;
+			}
+			executor.Execute();
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				allMatch = allMatch && nodes[i]->Result() == expected[i]->Result() && nodes[i]->numUpdates == run + 1;
+			}
+		}
+		Check(allMatch, "Results differ from sequential evaluation");
+		Check(WorkNode::numEarlyStarts == 0, "Node ran before its producers were done");
+	}
+
+	// pinned nodes run on the calling thread
+	{
+		auto nodes = MakeRandomGraph(10, 10, 100, 11);
+		GraphExecutor executor(3);
+		executor.Compile(Pointers(nodes));
+		for (size_t i = 0; i < nodes.size(); i += 7) {
+			executor.SetAffinity(nodes[i].get(), eNodeAffinity::CALLING_THREAD);
+		}
+		Check(executor.GetAffinity(nodes[7].get()) == eNodeAffinity::CALLING_THREAD
+				  && executor.GetAffinity(nodes[8].get()) == eNodeAffinity::ANY_THREAD,
+			  "Affinity not stored");
+		executor.Execute();
+		bool allPinned = true;
+		for (size_t i = 0; i < nodes.size(); i += 7) {
+			allPinned = allPinned && nodes[i]->thread == std::this_thread::get_id();
+		}
+		Check(allPinned, "Pinned node ran on a worker");
+
+		bool thrown = false;
+		try {
+			WorkNode outsider;
+			executor.SetAffinity(&outsider, eNodeAffinity::CALLING_THREAD);
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		Check(thrown, "Affinity set for node outside the graph");
+	}
+
+	// errors are rethrown, and only what depends on the failed node is skipped
+	{
+		ThrowingNode failing;
+		WorkNode before, after, independent;
+		failing.LinkFrom(0, before);
+		after.LinkFrom(0, failing);
+		std::vector<NodeBase*> nodes = { &after, &independent, &failing, &before };
+
+		GraphExecutor executor(2);
+		executor.Compile(nodes);
+		bool thrown = false;
+		try {
+			executor.Execute();
+		}
+		catch (std::runtime_error&) {
+			thrown = true;
+		}
+		Check(thrown, "Exception of node not rethrown");
+		Check(before.numUpdates == 1 && independent.numUpdates == 1 && after.numUpdates == 0, "Wrong nodes skipped after an error");
+
+		// the executor can be used again, nodes left out would still be notified
+		failing.GetInput<0>().Unlink();
+		executor.Compile({ &before, &independent });
+		executor.Execute();
+		Check(before.numUpdates == 2 && independent.numUpdates == 2, "Executor unusable after an error");
+	}
+
+	// notifications are given back, cycles are rejected
+	{
+		WorkNode a, b;
+		b.LinkFrom(0, a);
+		{
+			GraphExecutor executor(1);
+			executor.Compile({ &a, &b });
+		}
+		a.GetInput<1>().Set(5);
+		Check(a.numUpdates == 1 && b.numUpdates == 1, "Notifications not given back to the nodes");
+
+		a.LinkFrom(0, b);
+		bool thrown = false;
+		try {
+			GraphExecutor executor(1);
+			executor.Compile({ &a, &b });
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		a.GetInput<0>().Unlink();
+		Check(thrown, "Cycle accepted");
+	}
+
+	// benchmark: scaling on wide graphs
+	{
+		constexpr int NumRuns = 5;
+		constexpr int Work = 20000;
+		struct Shape {
+			const char* name;
+			int numLayers;
+			int layerWidth;
+		};
+		const Shape shapes[] = { { "1 x 1024 independent", 1, 1024 }, { "8 x 128 layered", 8, 128 } };
+
+		cout << "Benchmark (" << std::thread::hardware_concurrency() << " hardware threads):" << endl;
+		for (const Shape& shape : shapes) {
+			auto nodes = MakeRandomGraph(shape.numLayers, shape.layerWidth, Work, 3);
+			double singleUs = 0.0;
+			for (unsigned numThreads : { 1u, 2u, 4u, 8u }) {
+				GraphExecutor executor(numThreads - 1);
+				executor.Compile(Pointers(nodes));
+				executor.Execute(); // warm up the workers
+
+				auto start = std::chrono::high_resolution_clock::now();
+				for (int run = 0; run < NumRuns; ++run) {
+					executor.Execute();
+				}
+				auto end = std::chrono::high_resolution_clock::now();
+				double us = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e3 / NumRuns;
+				if (numThreads == 1) {
+					singleUs = us;
+				}
+				cout << shape.name << ", " << numThreads << " threads = " << us << " us/execution (speedup " << singleUs / us << "x)" << endl;
+			}
+		}
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
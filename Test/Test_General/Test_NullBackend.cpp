@@ -0,0 +1,172 @@
+#include "Test.hpp"
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "GraphicsApi_Null/GxapiManager.hpp"
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsApi_LL/ICommandAllocator.hpp"
+#include "GraphicsApi_LL/ICommandList.hpp"
+#include "GraphicsApi_LL/ICommandQueue.hpp"
+#include "GraphicsApi_LL/IDescriptorHeap.hpp"
+#include "GraphicsApi_LL/IFence.hpp"
+#include "GraphicsApi_LL/IResource.hpp"
+#include "GraphicsEngine_LL/GraphicsEngine.hpp"
+#include "GraphicsEngine_LL/Scene.hpp"
+#include "GraphicsEngine_LL/PerspectiveCamera.hpp"
+#include "GraphicsEngine_LL/OrthographicCamera.hpp"
+
+#include <sstream>
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestNullBackend : public AutoRegisterTest<TestNullBackend> {
+public:
+	TestNullBackend() {}
+
+	static std::string Name() {
+		return "Null Backend";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestNullBackend::Run() {
+	using namespace inl::gxapi;
+
+	constexpr unsigned numFrames = 100;
+	constexpr unsigned numEntities = 5000;
+
+	std::unique_ptr<IGxapiManager> gxapiManager(new inl::gxapi_null::GxapiManager());
+	std::unique_ptr<IGraphicsApi> graphicsApi(gxapiManager->CreateGraphicsApi(0));
+	auto* nullApi = static_cast<inl::gxapi_null::GraphicsApi*>(graphicsApi.get());
+
+	std::unique_ptr<ICommandQueue> queue(graphicsApi->CreateCommandQueue(CommandQueueDesc{ eCommandListType::GRAPHICS }));
+	std::unique_ptr<ICommandAllocator> allocator(graphicsApi->CreateCommandAllocator(eCommandListType::GRAPHICS));
+	std::unique_ptr<IGraphicsCommandList> list(graphicsApi->CreateGraphicsCommandList(CommandListDesc{ allocator.get() }));
+	std::unique_ptr<IFence> fence(graphicsApi->CreateFence(0));
+
+	// resources and descriptors behave like real ones
+	std::unique_ptr<IResource> buffer(graphicsApi->CreateCommittedResource(HeapProperties{ eHeapType::UPLOAD }, eHeapFlags::NONE, ResourceDesc::Buffer(1024), eResourceState::GENERIC_READ));
+	uint32_t* mapped = static_cast<uint32_t*>(buffer->Map(0));
+	mapped[0] = 42;
+	if (static_cast<uint32_t*>(buffer->Map(0))[0] != 42) {
+		cout << "Mapped memory is not persistent." << endl;
+		return 1;
+	}
+
+	std::unique_ptr<IDescriptorHeap> stagingHeap(graphicsApi->CreateDescriptorHeap(DescriptorHeapDesc{ eDescriptorHeapType::CBV_SRV_UAV, 16, false }));
+	std::unique_ptr<IDescriptorHeap> gpuHeap(graphicsApi->CreateDescriptorHeap(DescriptorHeapDesc{ eDescriptorHeapType::CBV_SRV_UAV, 16, true }));
+	for (size_t i = 0; i < 16; ++i) {
+		graphicsApi->CreateShaderResourceView(buffer.get(), stagingHeap->At(i));
+	}
+	graphicsApi->CopyDescriptors(stagingHeap->At(0), gpuHeap->At(0), 16, eDescriptorHeapType::CBV_SRV_UAV);
+
+	// record and submit a frame per iteration, like the engine would
+	list->Close();
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (unsigned frame = 1; frame <= numFrames; ++frame) {
+		allocator->Reset();
+		list->Reset(allocator.get());
+		for (unsigned entity = 0; entity < numEntities; ++entity) {
+			list->SetGraphicsRootDescriptorTable(0, gpuHeap->At(entity % 16));
+			list->DrawIndexedInstanced(36);
+		}
+		list->Close();
+
+		ICommandList* lists[] = { list.get() };
+		queue->ExecuteCommandLists(1, lists);
+		queue->Signal(fence.get(), frame);
+		fence->Wait(frame);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	auto stats = nullApi->GetStatistics();
+	cout << "CPU time per frame: " << std::chrono::duration<double, std::micro>(end - begin).count() / numFrames << " us" << endl;
+	cout << "Draws: " << stats.draws << ", descriptors created: " << stats.descriptorsCreated << ", copied: " << stats.descriptorsCopied << endl;
+
+	if (stats.draws != uint64_t(numFrames) * numEntities || stats.commandListsExecuted != numFrames) {
+		cout << "Submitted work was not counted correctly." << endl;
+		return 1;
+	}
+	if (stats.descriptorsCreated != 16 || stats.descriptorsCopied != 16 || stats.liveResources != 1) {
+		cout << "Descriptor or resource bookkeeping is wrong." << endl;
+		return 1;
+	}
+
+	// the whole engine runs headless on the null device
+	{
+		constexpr unsigned numEngineFrames = 10;
+		constexpr int width = 640, height = 360;
+
+		std::stringstream logText;
+		exc::Logger logger;
+		logger.OpenStream(&logText);
+
+		std::unique_ptr<IGraphicsApi> engineApi(gxapiManager->CreateGraphicsApi(0));
+		auto* nullEngineApi = static_cast<inl::gxapi_null::GraphicsApi*>(engineApi.get());
+
+		inl::gxeng::GraphicsEngineDesc desc;
+		desc.gxapiManager = gxapiManager.get();
+		desc.graphicsApi = engineApi.get();
+		desc.targetWindow = {};
+		desc.fullScreen = false;
+		desc.width = width;
+		desc.height = height;
+		desc.logger = &logger;
+
+		auto engineBegin = std::chrono::high_resolution_clock::now();
+		{
+			inl::gxeng::GraphicsEngine engine(desc);
+
+			// the scenes, cameras and variables the built-in pipeline looks up
+			std::unique_ptr<inl::gxeng::Scene> worldScene(engine.CreateScene("World"));
+			std::unique_ptr<inl::gxeng::Scene> guiScene(engine.CreateScene("Gui"));
+			std::unique_ptr<inl::gxeng::PerspectiveCamera> worldCamera(engine.CreatePerspectiveCamera("WorldCam"));
+			std::unique_ptr<inl::gxeng::OrthographicCamera> guiCamera(engine.CreateOrthographicCamera("GuiCamera"));
+			worldCamera->SetTargeted(true);
+			worldCamera->SetPosition({ 0, -5, 2 });
+			worldCamera->SetTarget({ 0, 0, 0 });
+			worldCamera->SetUpVector({ 0, 0, 1 });
+			worldCamera->SetNearPlane(0.1f);
+			worldCamera->SetFarPlane(1000.0f);
+			guiCamera->SetBounds(0, width, height, 0, -1, 1);
+			engine.SetEnvVariable("world_render_pos", exc::Any(mathfu::Vector2f(0.f, 0.f)));
+			engine.SetEnvVariable("world_render_rot", exc::Any(0.f));
+			engine.SetEnvVariable("world_render_size", exc::Any(mathfu::Vector2f(width, height)));
+
+			for (unsigned frame = 0; frame < numEngineFrames; ++frame) {
+				engine.Update(1.0f / 60.0f);
+			}
+		}
+		auto engineEnd = std::chrono::high_resolution_clock::now();
+		logger.Flush();
+
+		auto engineStats = nullEngineApi->GetStatistics();
+		cout << "Engine: " << std::chrono::duration<double, std::milli>(engineEnd - engineBegin).count() << " ms for " << numEngineFrames << " frames with setup, "
+			<< engineStats.commandListsExecuted << " command lists, " << engineStats.draws << " draws" << endl;
+
+		if (logText.str().find("Fatal pipeline error") != std::string::npos) {
+			cout << "Engine pipeline failed on the null device:" << endl << logText.str() << endl;
+			return 1;
+		}
+		if (engineStats.commandListsExecuted < numEngineFrames || engineStats.draws == 0 || engineStats.pipelineStateBinds == 0) {
+			cout << "Engine frames did not reach the device." << endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+#include "Test.hpp"
+#include <iostream>
+#include <random>
+#include <vector>
+#include "GraphicsEngine_LL/OverlayBatcher.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestOverlayBatching : public AutoRegisterTest<TestOverlayBatching> {
+public:
+	TestOverlayBatching() {}
+
+	static std::string Name() {
+		return "Overlay Batching";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestOverlayBatching::Run() {
+	using namespace inl::gxeng;
+	using Mat4 = mathfu::Matrix<float, 4, 4>;
+	using Vec3 = mathfu::Vector<float, 3>;
+
+	int errors = 0;
+
+	// packed rectangles stay on their page and never overlap
+	{
+		TextureAtlasPacker packer(256, 2);
+		std::mt19937 rne(31415);
+		std::uniform_int_distribution<uint32_t> size(1, 64);
+		std::vector<AtlasRegion> regions;
+		while (auto region = packer.Insert(size(rne), size(rne))) {
+			regions.push_back(*region);
+		}
+		for (size_t i = 0; i < regions.size(); ++i) {
+			const AtlasRegion& a = regions[i];
+			if (a.page < 0 || a.page >= 2 || a.x + a.width > 256 || a.y + a.height > 256) {
+				cout << "Region out of the atlas" << endl;
+				++errors;
+			}
+			for (size_t j = i + 1; j < regions.size(); ++j) {
+				const AtlasRegion& b = regions[j];
+				bool overlap = a.page == b.page
+					&& a.x < b.x + b.width && b.x < a.x + a.width
+					&& a.y < b.y + b.height && b.y < a.y + a.height;
+				if (overlap) {
+					cout << "Regions " << i << " and " << j << " overlap" << endl;
+					++errors;
+				}
+			}
+		}
+		cout << regions.size() << " rectangles packed on " << packer.GetPageCount() << " pages" << endl;
+		if (packer.GetPageCount() != 2) {
+			cout << "Second page was not used" << endl;
+			++errors;
+		}
+	}
+
+	// a few hundred icons of two layers, some colored, some with a huge texture
+	OverlayBatcher batcher(1024, 4, 256);
+	std::vector<OverlaySprite> sprites;
+	int icons[8];
+	int background;
+	for (int i = 0; i < 400; ++i) {
+		OverlaySprite sprite;
+		sprite.layer = i % 2;
+		sprite.transform = Mat4::FromTranslationVector(Vec3((float)i, 0, 0)) * Mat4::FromScaleVector(Vec3(32, 32, 1));
+		sprite.color = { 1, 1, 1, 1 };
+		if (i % 5 == 0) {
+			sprite.texture = nullptr;
+		}
+		else if (i % 5 == 1) {
+			sprite.texture = &background;
+			sprite.textureWidth = 2048;
+			sprite.textureHeight = 2048;
+			sprite.atlasCompatible = true;
+		}
+		else {
+			sprite.texture = &icons[i % 8];
+			sprite.textureWidth = 64;
+			sprite.textureHeight = 64;
+			sprite.atlasCompatible = true;
+		}
+		sprites.push_back(sprite);
+	}
+
+	std::vector<OverlayVertex> vertices;
+	std::vector<OverlayBatch> batches;
+	std::vector<OverlayAtlasCopy> copies;
+	batcher.Build(sprites, vertices, batches, copies);
+
+	// per layer: one batch for the atlas page (icons and colored), one for the big texture
+	if (batches.size() != 4) {
+		cout << "Got " << batches.size() << " batches instead of 4" << endl;
+		++errors;
+	}
+	if (vertices.size() != 6 * sprites.size()) {
+		cout << "Got " << vertices.size() << " vertices instead of " << 6 * sprites.size() << endl;
+		++errors;
+	}
+	if (copies.size() != 8) {
+		cout << "Got " << copies.size() << " atlas copies instead of 8" << endl;
+		++errors;
+	}
+	for (size_t i = 1; i < batches.size(); ++i) {
+		if (batches[i].layer < batches[i - 1].layer) {
+			cout << "Batches are not sorted by layer" << endl;
+			++errors;
+		}
+		if (batches[i].firstVertex != batches[i - 1].firstVertex + batches[i - 1].numVertices) {
+			cout << "Batches are not contiguous" << endl;
+			++errors;
+		}
+	}
+	for (auto& batch : batches) {
+		if ((batch.page < 0) != (batch.texture == &background)) {
+			cout << "Only the big texture should be drawn outside the atlas" << endl;
+			++errors;
+		}
+	}
+
+	// texture coordinates of atlased sprites stay inside their regions
+	for (auto& copy : copies) {
+		const AtlasRegion& region = copy.region;
+		float minU = region.x / 1024.0f, maxU = (region.x + region.width) / 1024.0f;
+		float minV = region.y / 1024.0f, maxV = (region.y + region.height) / 1024.0f;
+		for (size_t i = 0; i < sprites.size(); ++i) {
+			if (sprites[i].texture != copy.texture) {
+				continue;
+			}
+			// sprites keep their order within a batch, so sprite i is not necessarily at i, search by position
+			for (size_t v = 0; v < vertices.size(); v += 6) {
+				if (vertices[v].position.data[0] != (float)i) {
+					continue;
+				}
+				for (size_t c = v; c < v + 6; ++c) {
+					float u = vertices[c].texCoord.data[0], w = vertices[c].texCoord.data[1];
+					if (u < minU || u > maxU || w < minV || w > maxV) {
+						cout << "Sprite " << i << " samples outside its region" << endl;
+						++errors;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	// nothing to copy the next frame, unless a texture changes
+	batcher.Build(sprites, vertices, batches, copies);
+	if (!copies.empty()) {
+		cout << "Unchanged textures copied again" << endl;
+		++errors;
+	}
+	for (auto& sprite : sprites) {
+		if (sprite.texture == &icons[3]) {
+			sprite.textureVersion = 1;
+		}
+	}
+	batcher.Build(sprites, vertices, batches, copies);
+	if (copies.size() != 1 || copies[0].texture != &icons[3]) {
+		cout << "Changed texture was not copied again" << endl;
+		++errors;
+	}
+
+	// textures not drawn in a frame leave the atlas, a texture later at the same address is copied anew
+	std::vector<OverlaySprite> withoutIcon;
+	for (auto& sprite : sprites) {
+		if (sprite.texture != &icons[3]) {
+			withoutIcon.push_back(sprite);
+		}
+	}
+	batcher.Build(withoutIcon, vertices, batches, copies);
+	batcher.Build(sprites, vertices, batches, copies);
+	if (copies.size() != 1 || copies[0].texture != &icons[3]) {
+		cout << "Texture dropped for a frame was not copied again" << endl;
+		++errors;
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,346 @@
+#include "Test.hpp"
+
+#include <GraphicsEngine_LL/GraphicsNode.hpp>
+#include <GraphicsEngine_LL/GraphicsNodeFactory.hpp>
+#include <GraphicsEngine_LL/Pipeline.hpp>
+#include <GraphicsEngine_LL/PipelineDescription.hpp>
+#include <BaseLibrary/Graph/Node.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using std::cout;
+using std::endl;
+using namespace inl::gxeng;
+using namespace exc;
+
+
+//------------------------------------------------------------------------------
+// Node classes
+//------------------------------------------------------------------------------
+
+namespace {
+
+class SumNode : public InputPortConfig<int, int>, public OutputPortConfig<int> {
+public:
+	static std::string Info_GetName() { return "Sum"; }
+	static std::vector<std::string> Info_GetInputNames() { return{ "a", "b" }; }
+	static std::vector<std::string> Info_GetOutputNames() { return{ "sum" }; }
+
+	void Update() override {
+		GetOutput<0>().Set(GetInput<0>().Get() + GetInput<1>().Get());
+	}
+	void Notify(InputPortBase*) override {}
+};
+
+class ScaleNode : public InputPortConfig<float, double>, public OutputPortConfig<float> {
+public:
+	static std::string Info_GetName() { return "Scale"; }
+	static std::vector<std::string> Info_GetInputNames() { return{ "value", "factor" }; }
+	static std::vector<std::string> Info_GetOutputNames() { return{ "scaled" }; }
+
+	void Update() override {
+		GetOutput<0>().Set(float(GetInput<0>().Get() * GetInput<1>().Get()));
+	}
+	void Notify(InputPortBase*) override {}
+};
+
+class LabelNode : public InputPortConfig<std::string, bool, unsigned>, public OutputPortConfig<std::string> {
+public:
+	static std::string Info_GetName() { return "Label"; }
+	static std::vector<std::string> Info_GetInputNames() { return{ "text", "enabled", "count" }; }
+	static std::vector<std::string> Info_GetOutputNames() { return{ "label" }; }
+
+	void Update() override {
+		GetOutput<0>().Set(GetInput<1>().Get() ? GetInput<0>().Get() : std::string());
+	}
+	void Notify(InputPortBase*) override {}
+};
+
+// Sets up its task only when initialized, like the nodes of the engine.
+class PassNode :
+	virtual public GraphicsNode,
+	virtual public GraphicsTask,
+	virtual public InputPortConfig<int>,
+	virtual public OutputPortConfig<int>
+{
+public:
+	static std::string Info_GetName() { return "Pass"; }
+	static std::vector<std::string> Info_GetInputNames() { return{ "value" }; }
+	static std::vector<std::string> Info_GetOutputNames() { return{ "value" }; }
+
+	void Update() override {}
+	void Notify(InputPortBase*) override {}
+	void Initialize(EngineContext& context) override {
+		wasLinked = GetInput<0>().GetLink() != nullptr;
+		++numInitialized;
+		SetTaskSingle(this);
+	}
+	void Reset() override {}
+	void Setup(SetupContext& context) override { GetOutput<0>().Set(GetInput<0>().Get()); }
+	void Execute(RenderContext& context) override {}
+
+	int numInitialized = 0;
+	bool wasLinked = false;
+};
+
+
+template <class NodeT>
+NodeT* FindNodeOfClass(Pipeline& pipeline, int index = 0) {
+	for (NodeBase& node : pipeline) {
+		if (auto typed = dynamic_cast<NodeT*>(&node)) {
+			if (index-- == 0) {
+				return typed;
+			}
+		}
+	}
+	return nullptr;
+}
+
+
+std::string MakeChain(int length) {
+	std::stringstream json;
+	json << "{ \"nodes\": [";
+	for (int i = 0; i < length; ++i) {
+		json << (i ? "," : "") << "{ \"name\": \"n" << i << "\", \"class\": \"Test/Sum\", \"inputs\": { \"b\": " << i << (i ? "" : ", \"a\": 0") << " } }";
+	}
+	json << "], \"links\": [";
+	for (int i = 1; i < length; ++i) {
+		json << (i > 1 ? "," : "") << "{ \"src\": \"n" << i - 1 << "\", \"srcPort\": \"sum\", \"dst\": \"n" << i << "\", \"dstPort\": 0 }";
+	}
+	json << "], \"outputs\": [ \"n" << length - 1 << "\" ] }";
+	return json.str();
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPipelineDescription : public AutoRegisterTest<TestPipelineDescription> {
+public:
+	TestPipelineDescription() {}
+
+	static std::string Name() {
+		return "Pipeline Description";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestPipelineDescription::Run() {
+	int errors = 0;
+	TestCheck Check(errors);
+	auto Throws = [](auto&& function) {
+		try {
+			function();
+		}
+		catch (std::invalid_argument&) {
+			return true;
+		}
+		return false;
+	};
+
+	GraphicsNodeFactory factory;
+	factory.RegisterNodeClass<SumNode>("Test");
+	factory.RegisterNodeClass<ScaleNode>("Test");
+	factory.RegisterNodeClass<LabelNode>("Test");
+	factory.RegisterNodeClass<PassNode>("Test");
+
+	const std::string json = R"({
+		"nodes": [
+			{ "name": "first", "class": "Test/Sum", "inputs": { "a": 2, "1": -5 } },
+			{ "name": "second", "class": "Test/Sum", "inputs": { "b": 10 } },
+			{ "name": "scale", "class": "Test/Scale", "inputs": { "value": 3, "factor": 0.5 } },
+			{ "name": "label", "class": "Test/Label", "inputs": { "text": "sky", "enabled": true, "count": 7 } },
+			{ "name": "unused", "class": "Test/Sum" }
+		],
+		"links": [
+			{ "src": "first", "srcPort": "sum", "dst": "second", "dstPort": "a" }
+		],
+		"outputs": [ "second", "scale", "label" ]
+	})";
+
+	// parsing resolves names to indices
+	PipelineDescription description = PipelineDescription::FromJson(json, factory);
+	Check(description.nodes.size() == 5 && description.links.size() == 1 && description.outputs.size() == 3, "Wrong number of nodes, links or outputs");
+	Check(description.nodes[0].inputValues.size() == 2 && description.nodes[0].inputValues[1].port == 1
+		  && description.nodes[0].inputValues[1].integer == -5, "Input given by index not parsed");
+	Check(description.links[0].srcNode == 0 && description.links[0].srcPort == 0
+		  && description.links[0].dstNode == 1 && description.links[0].dstPort == 0, "Link not resolved");
+	Check(description.nodes[2].inputValues[1].type == PipelineInputValue::eType::REAL, "Real value parsed as another type");
+
+	// creating sets values and links, unused nodes are pruned
+	{
+		Pipeline pipeline;
+		pipeline.CreateFromDescription(json, factory);
+		int numNodes = 0;
+		for (auto it = pipeline.begin(); it != pipeline.end(); ++it) {
+			++numNodes;
+		}
+		Check(numNodes == 4, "Node that reaches no output was kept");
+
+		SumNode* first = FindNodeOfClass<SumNode>(pipeline, 0);
+		SumNode* second = FindNodeOfClass<SumNode>(pipeline, 1);
+		ScaleNode* scale = FindNodeOfClass<ScaleNode>(pipeline);
+		LabelNode* label = FindNodeOfClass<LabelNode>(pipeline);
+		Check(first && second && scale && label, "Nodes not created");
+		if (first && second && scale && label) {
+			if (first->GetInput<0>().IsSet() && first->GetInput<0>().Get() == 2) {
+				std::swap(first, second); // order of iteration is up to the graph
+			}
+			second->Update();
+			first->Update();
+			Check(first->GetInput<0>().IsSet() && first->GetInput<0>().Get() == -3 && first->GetInput<1>().Get() == 10, "Link does not carry values");
+			Check(scale->GetInput<0>().Get() == 3.0f && scale->GetInput<1>().Get() == 0.5, "Numbers not converted to the port types");
+			Check(label->GetInput<0>().Get() == "sky" && label->GetInput<1>().Get() && label->GetInput<2>().Get() == 7u, "String, bool or unsigned not set");
+		}
+	}
+
+	// graphics nodes are initialized once linked, their tasks make up the task graph
+	{
+		const char* passJson = R"({
+			"nodes": [
+				{ "name": "sum", "class": "Test/Sum", "inputs": { "a": 1, "b": 2 } },
+				{ "name": "pass", "class": "Test/Pass" },
+				{ "name": "present", "class": "Test/Pass" }
+			],
+			"links": [
+				{ "src": "sum", "srcPort": "sum", "dst": "pass", "dstPort": "value" },
+				{ "src": "pass", "srcPort": "value", "dst": "present", "dstPort": "value" }
+			],
+			"outputs": [ "present" ]
+		})";
+		Pipeline pipeline;
+		bool created = true;
+		try {
+			pipeline.CreateFromDescription(passJson, factory);
+		}
+		catch (std::exception& ex) {
+			cout << ex.what() << endl;
+			created = false;
+		}
+		Check(created, "Pipeline of graphics nodes not created");
+
+		PassNode* pass = FindNodeOfClass<PassNode>(pipeline, 0);
+		PassNode* present = FindNodeOfClass<PassNode>(pipeline, 1);
+		Check(pass && present && pass->numInitialized == 1 && present->numInitialized == 1, "Graphics nodes not initialized once");
+		Check(pass && present && pass->wasLinked && present->wasLinked, "Graphics nodes initialized before they were linked");
+
+		int numPassTasks = 0;
+		int numTasks = 0;
+		for (lemon::ListDigraph::NodeIt taskNode(pipeline.GetTaskGraph()); taskNode != lemon::INVALID; ++taskNode) {
+			GraphicsTask* task = pipeline.GetTaskFunctionMap()[taskNode];
+			numPassTasks += task != nullptr && (task == static_cast<GraphicsTask*>(pass) || task == static_cast<GraphicsTask*>(present));
+			++numTasks;
+		}
+		Check(numTasks == 3 && numPassTasks == 2, "Task graph does not hold the graphics nodes' tasks");
+	}
+
+	// invalid descriptions are rejected
+	{
+		const char* invalid[] = {
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" } )",
+			R"({ "links": [] })",
+			R"({ "nodes": [ { "name": "a" } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Missing" } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" }, { "name": "a", "class": "Test/Sum" } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum", "inputs": { "c": 1 } } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum", "inputs": { "2": 1 } } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum", "inputs": { "a": [ 1 ] } } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" } ], "links": [ { "src": "a", "srcPort": 0, "dst": "b", "dstPort": 0 } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" } ], "links": [ { "src": "a", "srcPort": 1, "dst": "a", "dstPort": 0 } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" }, { "name": "b", "class": "Test/Sum", "inputs": { "a": 1 } } ],
+				 "links": [ { "src": "a", "srcPort": 0, "dst": "b", "dstPort": "a" } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" } ], "links": [ { "src": "a", "dst": "a" } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" } ], "outputs": [ "b" ] })",
+		};
+		int numRejected = 0;
+		for (const char* text : invalid) {
+			numRejected += Throws([&] { PipelineDescription::FromJson(text, factory); });
+		}
+		Check(numRejected == sizeof(invalid) / sizeof(invalid[0]), "Invalid description accepted");
+
+		// these parse, but do not fit the ports' types
+		const char* mistyped[] = {
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum" }, { "name": "b", "class": "Test/Label" } ],
+				 "links": [ { "src": "a", "srcPort": 0, "dst": "b", "dstPort": "text" } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum", "inputs": { "a": "text" } } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Sum", "inputs": { "a": 1.5 } } ] })",
+			R"({ "nodes": [ { "name": "a", "class": "Test/Label", "inputs": { "count": -1 } } ] })",
+		};
+		int numMistypedRejected = 0;
+		for (const char* text : mistyped) {
+			Pipeline pipeline;
+			numMistypedRejected += Throws([&] { pipeline.CreateFromDescription(text, factory); });
+		}
+		Check(numMistypedRejected == sizeof(mistyped) / sizeof(mistyped[0]), "Value or link of the wrong type accepted");
+	}
+
+	// binary form
+	{
+		std::vector<uint8_t> binary = description.ToBinary();
+		PipelineDescription loaded = PipelineDescription::FromBinary(binary.data(), binary.size());
+		Check(loaded.ToBinary() == binary, "Binary round trip changed the description");
+		Check(loaded.nodes[3].inputValues[0].string == "sky" && loaded.nodes[2].inputValues[1].real == 0.5, "Binary round trip lost values");
+
+		Pipeline pipeline;
+		pipeline.CreateFromDescription(loaded, factory);
+		Check(FindNodeOfClass<LabelNode>(pipeline) != nullptr, "Pipeline not created from binary");
+
+		bool allTruncationsRejected = true;
+		for (size_t size = 0; size < binary.size(); ++size) {
+			allTruncationsRejected = allTruncationsRejected && Throws([&] { PipelineDescription::FromBinary(binary.data(), size); });
+		}
+		Check(allTruncationsRejected, "Truncated binary accepted");
+
+		std::vector<uint8_t> corrupt = binary;
+		corrupt[0] = 'X';
+		Check(Throws([&] { PipelineDescription::FromBinary(corrupt.data(), corrupt.size()); }), "Binary with wrong magic accepted");
+		corrupt = binary;
+		corrupt[corrupt.size() - 4] = 200; // last output's node index
+		Check(Throws([&] { PipelineDescription::FromBinary(corrupt.data(), corrupt.size()); }), "Binary with bad node index accepted");
+	}
+
+	// benchmark: loading a long chain of nodes
+	{
+		constexpr int NumNodes = 2000;
+		constexpr int NumRuns = 20;
+		std::string chain = MakeChain(NumNodes);
+		std::vector<uint8_t> binary = PipelineDescription::FromJson(chain, factory).ToBinary();
+
+		auto jsonStart = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < NumRuns; ++i) {
+			PipelineDescription::FromJson(chain, factory);
+		}
+		auto jsonEnd = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < NumRuns; ++i) {
+			PipelineDescription::FromBinary(binary.data(), binary.size());
+		}
+		auto binaryEnd = std::chrono::high_resolution_clock::now();
+		Pipeline pipeline;
+		pipeline.CreateFromDescription(PipelineDescription::FromBinary(binary.data(), binary.size()), factory);
+		auto createEnd = std::chrono::high_resolution_clock::now();
+
+		auto jsonNs = std::chrono::duration_cast<std::chrono::nanoseconds>(jsonEnd - jsonStart).count() / NumRuns;
+		auto binaryNs = std::chrono::duration_cast<std::chrono::nanoseconds>(binaryEnd - jsonEnd).count() / NumRuns;
+		auto createNs = std::chrono::duration_cast<std::chrono::nanoseconds>(createEnd - binaryEnd).count();
+		cout << "Benchmark:" << endl;
+		cout << NumNodes << " nodes from JSON (" << chain.size() << " bytes) = " << jsonNs / 1e6 << " ms" << endl;
+		cout << NumNodes << " nodes from binary (" << binary.size() << " bytes) = " << binaryNs / 1e6 << " ms" << endl;
+		cout << NumNodes << " nodes created and pipeline built = " << createNs / 1e6 << " ms" << endl;
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,223 @@
+#include "Test.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "GraphicsEngine_LL/PipelineEventDispatcher.hpp"
+#include "BaseLibrary/Logging/Logger.hpp"
+
+using namespace std::literals::chrono_literals;
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPipelineEventDispatcher : public AutoRegisterTest<TestPipelineEventDispatcher> {
+public:
+	TestPipelineEventDispatcher() {}
+
+	static std::string Name() {
+		return "Pipeline Event Dispatcher";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+
+namespace {
+
+// Fence that is signaled by the test instead of a device.
+class ManualFence : public inl::gxapi::IFence {
+public:
+	uint64_t Fetch() const override { return m_value; }
+	void Signal(uint64_t value) override { m_value = value; }
+	void Wait(uint64_t value, uint64_t timeoutMillis = FOREVER) const override {
+		while (m_value < value) {
+			std::this_thread::yield();
+		}
+	}
+	void WaitAny(const IFence**, uint64_t*, size_t, uint64_t) const override {}
+	void WaitAll(const IFence**, uint64_t*, size_t, uint64_t) const override {}
+private:
+	std::atomic<uint64_t> m_value = 0;
+};
+
+
+class CountingListener : public inl::gxeng::PipelineEventListener {
+public:
+	void OnFrameBeginDevice(uint64_t frameId) override { ++beginDevice; }
+	void OnFrameBeginHost(uint64_t frameId) override { ++beginHost; thread = std::this_thread::get_id(); }
+	void OnFrameBeginAwait(uint64_t frameId) override { ++beginAwait; }
+	void OnFrameCompleteDevice(uint64_t frameId) override { ++completeDevice; lastCompleted = frameId; }
+	void OnFrameCompleteHost(uint64_t frameId) override { ++completeHost; }
+
+	std::atomic<int> beginDevice = 0, beginHost = 0, beginAwait = 0, completeDevice = 0, completeHost = 0;
+	std::atomic<uint64_t> lastCompleted = 0;
+	std::thread::id thread;
+};
+
+
+class ThrowingListener : public CountingListener {
+public:
+	void OnFrameBeginHost(uint64_t frameId) override { throw std::runtime_error("Host handler failed."); }
+	void OnFrameCompleteDevice(uint64_t frameId) override { throw std::runtime_error("Device handler failed."); }
+};
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestPipelineEventDispatcher::Run() {
+	using namespace inl::gxeng;
+
+	int errors = 0;
+
+	// synchronous listeners are done when the dispatch returns, asynchronous ones on another thread
+	{
+		PipelineEventDispatcher dispatcher;
+		CountingListener sync, async;
+		dispatcher += &sync;
+		dispatcher.AddAsync(&async);
+
+		dispatcher.DispatchFrameBegin(0);
+		auto ticket = dispatcher.DispatchFrameEnd(0);
+		if (sync.beginHost != 1 || sync.completeHost != 1 || sync.thread != std::this_thread::get_id()) {
+			cout << "Synchronous listener not called inline" << endl;
+			++errors;
+		}
+		dispatcher.WaitHandled(ticket);
+		if (async.beginHost != 1 || async.completeHost != 1 || async.thread == std::this_thread::get_id()) {
+			cout << "Asynchronous listener not called on the event thread" << endl;
+			++errors;
+		}
+	}
+
+	// device events wait for the fence, then reach every listener
+	{
+		PipelineEventDispatcher dispatcher;
+		CountingListener sync, async;
+		dispatcher += &sync;
+		dispatcher.AddAsync(&async);
+
+		auto fence = std::make_shared<ManualFence>();
+		auto ticket = dispatcher.DispatchDeviceFrameEnd(SyncPoint(fence, 1), 7);
+		std::this_thread::sleep_for(10ms);
+		if (dispatcher.IsHandled(ticket) || sync.completeDevice != 0) {
+			cout << "Device event handled before the fence was reached" << endl;
+			++errors;
+		}
+		fence->Signal(1);
+		dispatcher.WaitHandled(ticket);
+		if (sync.lastCompleted != 7 || async.lastCompleted != 7) {
+			cout << "Device event did not reach every listener" << endl;
+			++errors;
+		}
+
+		// more events than the queue holds, the producer has to wait for the device
+		for (uint64_t frame = 8; frame < 200; ++frame) {
+			ticket = dispatcher.DispatchDeviceFrameEnd(SyncPoint(fence, frame), frame);
+			fence->Signal(frame);
+		}
+		dispatcher.WaitHandled(ticket);
+		if (sync.completeDevice != 193 || sync.lastCompleted != 199) {
+			cout << "Device events lost or reordered" << endl;
+			++errors;
+		}
+	}
+
+	// exceptions of handlers are logged, and do not keep the event from the other listeners
+	{
+		std::stringstream logText;
+		{
+			exc::Logger logger;
+			logger.OpenStream(&logText);
+			exc::LogStream log = logger.CreateLogStream("Pipeline");
+
+			PipelineEventDispatcher dispatcher;
+			dispatcher.SetLog(&log);
+			ThrowingListener throwing;
+			CountingListener sync;
+			dispatcher += &throwing;
+			dispatcher += &sync;
+
+			dispatcher.DispatchFrameBegin(3);
+			auto fence = std::make_shared<ManualFence>();
+			fence->Signal(1);
+			auto ticket = dispatcher.DispatchDeviceFrameEnd(SyncPoint(fence, 1), 3);
+			dispatcher.WaitHandled(ticket);
+			if (sync.beginHost != 1 || sync.completeDevice != 1) {
+				cout << "Listener missed an event after another listener threw" << endl;
+				++errors;
+			}
+			logger.Flush();
+		}
+		std::string text = logText.str();
+		if (text.find("Host handler failed.") == text.npos || text.find("Device handler failed.") == text.npos) {
+			cout << "Exception of handler not logged" << endl;
+			++errors;
+		}
+	}
+
+	// flushing handles the pending device events
+	{
+		PipelineEventDispatcher dispatcher;
+		CountingListener sync;
+		dispatcher += &sync;
+
+		auto fence = std::make_shared<ManualFence>();
+		for (uint64_t frame = 1; frame <= 10; ++frame) {
+			dispatcher.DispatchDeviceFrameEnd(SyncPoint(fence, frame), frame);
+		}
+		std::thread device([&fence] {
+			std::this_thread::sleep_for(10ms);
+			fence->Signal(10);
+		});
+		dispatcher.Flush();
+		device.join();
+		if (sync.completeDevice != 10) {
+			cout << "Pending device events not handled by flush" << endl;
+			++errors;
+		}
+	}
+
+	// benchmark the events of a frame
+	{
+		PipelineEventDispatcher dispatcher;
+		CountingListener listeners[4];
+		for (auto& listener : listeners) {
+			dispatcher += &listener;
+		}
+
+		constexpr int NumFrames = 100'000;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < NumFrames; ++frame) {
+			dispatcher.DispatchFrameBegin(frame);
+			dispatcher.DispatchFrameEnd(frame);
+			dispatcher.DispachFrameBeginAwait(frame + 1);
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+		cout << "Benchmark:" << endl;
+		cout << "Host events of " << NumFrames << " frames = " << ns / 1e6 << " ms (" << (double)ns / NumFrames << " ns/frame)" << endl;
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
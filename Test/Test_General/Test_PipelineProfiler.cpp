@@ -0,0 +1,134 @@
+#include "Test.hpp"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsApi_LL/ICommandAllocator.hpp"
+#include "GraphicsEngine_LL/PipelineProfiler.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPipelineProfiler : public AutoRegisterTest<TestPipelineProfiler> {
+public:
+	TestPipelineProfiler() {}
+
+	static std::string Name() {
+		return "Pipeline Profiler";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestPipelineProfiler::Run() {
+	using namespace inl::gxapi;
+	using namespace inl::gxeng;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// CPU events are collected per frame
+	PipelineProfiler profiler(4);
+	uint32_t shadows = profiler.RegisterName("Shadows");
+	uint32_t forward = profiler.RegisterName("ForwardRender");
+	Check(profiler.RegisterName("Shadows") == shadows && profiler.GetName(forward) == "ForwardRender", "Names not registered once");
+
+	profiler.BeginFrame(10);
+	{
+		ProfileScope scope(&profiler, shadows, eProfileCategory::SETUP);
+	}
+	{
+		ProfileScope scope(&profiler, forward, eProfileCategory::EXECUTE);
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	{
+		ProfileScope nothing(nullptr, forward, eProfileCategory::SUBMIT);
+	}
+	std::thread worker([&] {
+		profiler.AddCpuEvent(shadows, eProfileCategory::EXECUTE, profiler.Now(), profiler.Now());
+	});
+	worker.join();
+	profiler.EndFrame();
+
+	Check(profiler.GetNumFrames() == 1, "Frame not kept");
+	const FrameProfile& frame = profiler.GetFrame(0);
+	Check(frame.frame == 10 && frame.events.size() == 3 && frame.gpuResolved, "Frame events wrong");
+	Check(frame.events[1].name == forward && frame.events[1].category == eProfileCategory::EXECUTE && frame.events[1].duration >= 2000000, "Event not timed");
+	Check(frame.events[1].start >= frame.start && frame.events[1].start + frame.events[1].duration <= frame.start + frame.duration, "Event outside its frame");
+	Check(frame.events[0].thread == frame.thread && frame.events[2].thread != frame.thread, "Threads not told apart");
+
+	// only the last frames are kept
+	for (uint64_t i = 11; i < 16; ++i) {
+		profiler.BeginFrame(i);
+		profiler.AddCpuEvent(shadows, eProfileCategory::BARRIERS, profiler.Now(), profiler.Now());
+		profiler.EndFrame();
+	}
+	Check(profiler.GetNumFrames() == 4 && profiler.GetFrame(0).frame == 15 && profiler.GetFrame(3).frame == 12, "Ring of frames wrong");
+	Check(profiler.GetFrame(0).events.size() == 1, "Reused frame not cleared");
+
+	// trace event JSON
+	std::stringstream trace;
+	profiler.WriteChromeTrace(trace);
+	std::string json = trace.str();
+	Check(json.find("{\"traceEvents\":[") == 0 && json.rfind("]}") != std::string::npos, "Trace not a trace event object");
+	Check(json.find("\"name\":\"Frame 15\"") != std::string::npos && json.find("\"name\":\"Frame 11\"") == std::string::npos, "Trace frames wrong");
+	Check(json.find("\"name\":\"Shadows\",\"cat\":\"Barriers\",\"ph\":\"X\"") != std::string::npos, "Trace event missing");
+
+	// GPU timestamps are read back once the frame is complete
+	{
+		inl::gxapi_null::GraphicsApi gxapi;
+		std::shared_ptr<IFence> fence(gxapi.CreateFence(0));
+		std::unique_ptr<ICommandAllocator> allocator(gxapi.CreateCommandAllocator(eCommandListType::GRAPHICS));
+		std::unique_ptr<IGraphicsCommandList> list(gxapi.CreateGraphicsCommandList(CommandListDesc{ allocator.get() }));
+
+		PipelineProfiler gpuProfiler(8);
+		gpuProfiler.EnableGpuTiming(&gxapi, 1000000000, 2);
+		Check(gpuProfiler.IsGpuTimingEnabled(), "GPU timing not enabled");
+		uint32_t name = gpuProfiler.RegisterName("Node");
+
+		gpuProfiler.BeginFrame(0);
+		int first = gpuProfiler.BeginGpuEvent(name, list.get());
+		int second = gpuProfiler.BeginGpuEvent(name, list.get());
+		int third = gpuProfiler.BeginGpuEvent(name, list.get());
+		Check(first == 0 && second == 1 && third == -1, "GPU event limit not respected");
+		gpuProfiler.EndGpuEvent(first, list.get());
+		gpuProfiler.EndGpuEvent(second, list.get());
+		gpuProfiler.EndGpuEvent(third, list.get());
+		gpuProfiler.ResolveGpuEvents(list.get());
+		gpuProfiler.EndFrame(SyncPoint(fence, 1));
+		Check(!gpuProfiler.GetFrame(0).gpuResolved, "GPU events resolved before completion");
+
+		gpuProfiler.BeginFrame(1);
+		gpuProfiler.EndFrame();
+		Check(!gpuProfiler.GetFrame(1).gpuResolved, "GPU events read back too early");
+
+		fence->Signal(1);
+		gpuProfiler.BeginFrame(2);
+		gpuProfiler.EndFrame();
+		const FrameProfile& gpuFrame = gpuProfiler.GetFrame(2);
+		Check(gpuFrame.gpuResolved && gpuFrame.events.size() == 2 && gpuFrame.events[0].category == eProfileCategory::GPU && gpuFrame.events[0].thread == 0, "GPU events not read back");
+
+		// without timestamps only the CPU is timed
+		PipelineProfiler headless;
+		headless.EnableGpuTiming(&gxapi, 0);
+		headless.BeginFrame(0);
+		Check(!headless.IsGpuTimingEnabled() && headless.BeginGpuEvent(0, list.get()) == -1, "GPU timed without timestamps");
+		headless.EndFrame();
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,133 @@
+#include "Test.hpp"
+
+#include <GraphicsEngine_LL/Pipeline.hpp>
+#include <BaseLibrary/Graph/Node.hpp>
+
+#include <iostream>
+#include <memory>
+
+using std::cout;
+using std::endl;
+using namespace inl::gxeng;
+using namespace exc;
+
+
+//------------------------------------------------------------------------------
+// Node classes
+//------------------------------------------------------------------------------
+
+namespace {
+
+class PruningNode : public InputPortConfig<int, int>, public OutputPortConfig<int> {
+public:
+	void Update() override {
+		GetOutput<0>().Set(GetInput<0>().Get() + GetInput<1>().Get());
+	}
+	void Notify(InputPortBase*) override {}
+};
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPipelinePruning : public AutoRegisterTest<TestPipelinePruning> {
+public:
+	TestPipelinePruning() {}
+
+	static std::string Name() {
+		return "Pipeline Pruning";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestPipelinePruning::Run() {
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// liveness on a bare graph: a -> b -> d (sink), a -> c -> e, f -> b
+	{
+		lemon::ListDigraph graph;
+		auto a = graph.addNode(), b = graph.addNode(), c = graph.addNode(), d = graph.addNode(), e = graph.addNode(), f = graph.addNode();
+		graph.addArc(a, b);
+		graph.addArc(b, d);
+		graph.addArc(a, c);
+		graph.addArc(c, e);
+		graph.addArc(f, b);
+		lemon::ListDigraph::NodeMap<bool> isSink(graph, false), isEnabled(graph, true), isLive(graph);
+		isSink[d] = true;
+
+		Pipeline::FindLiveNodes(graph, isSink, isEnabled, isLive);
+		Check(isLive[a] && isLive[b] && isLive[d] && isLive[f] && !isLive[c] && !isLive[e], "Dead branch not found");
+
+		isEnabled[b] = false;
+		Pipeline::FindLiveNodes(graph, isSink, isEnabled, isLive);
+		Check(isLive[d] && !isLive[b] && !isLive[a] && !isLive[f], "Disabled node's producers still live");
+
+		isEnabled[b] = true;
+		isEnabled[d] = false;
+		Pipeline::FindLiveNodes(graph, isSink, isEnabled, isLive);
+		Check(!isLive[a] && !isLive[b] && !isLive[d], "Disabled sink still live");
+	}
+
+	// pipeline: source -> ssao -> lighting (output), ssaoNoise -> ssao, source -> debug
+	auto source = std::make_shared<PruningNode>();
+	auto ssaoNoise = std::make_shared<PruningNode>();
+	auto ssao = std::make_shared<PruningNode>();
+	auto lighting = std::make_shared<PruningNode>();
+	auto debug = std::make_shared<PruningNode>();
+	ssao->GetInput<0>().Link(source->GetOutput(0));
+	ssao->GetInput<1>().Link(ssaoNoise->GetOutput(0));
+	lighting->GetInput<0>().Link(source->GetOutput(0));
+	lighting->GetInput<1>().Link(ssao->GetOutput(0));
+	debug->GetInput<0>().Link(source->GetOutput(0));
+
+	Pipeline pipeline;
+	pipeline.CreateFromNodesList({ source, ssaoNoise, ssao, lighting, debug }, { lighting });
+
+	auto IsActive = [](const Pipeline& pipeline, const NodeBase* node) {
+		const auto& taskGraph = pipeline.GetTaskGraph();
+		for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+			lemon::ListDigraph::Node parent = pipeline.GetTaskParentMap()[taskNode];
+			if (parent != lemon::INVALID && pipeline.GetNodeMap()[parent].get() == node) {
+				return pipeline.GetTaskActiveMap()[taskNode];
+			}
+		}
+		return false;
+	};
+
+	Check(lemon::countNodes(pipeline.GetDependencyGraph()) == 4 && lemon::countNodes(pipeline.GetTaskGraph()) == 4, "Dead node not eliminated");
+	Check(!pipeline.IsNodeEnabled(debug.get()), "Eliminated node still in the pipeline");
+	Check(IsActive(pipeline, source.get()) && IsActive(pipeline, ssao.get()) && IsActive(pipeline, lighting.get()), "Live tasks inactive");
+
+	// disabling a branch keeps the graph, skips the branch and what only feeds it
+	pipeline.SetNodeEnabled(ssao.get(), false);
+	Check(!IsActive(pipeline, ssao.get()) && !IsActive(pipeline, ssaoNoise.get()), "Disabled branch still active");
+	Check(IsActive(pipeline, source.get()) && IsActive(pipeline, lighting.get()), "Shared producer disabled with the branch");
+	Check(lemon::countNodes(pipeline.GetTaskGraph()) == 4, "Task graph rebuilt");
+
+	// state survives moving the pipeline
+	Pipeline moved(std::move(pipeline));
+	Check(!IsActive(moved, ssao.get()) && IsActive(moved, lighting.get()) && !moved.IsNodeEnabled(ssao.get()), "Moved pipeline lost its state");
+	moved.SetNodeEnabled(ssao.get(), true);
+	Check(IsActive(moved, ssao.get()) && IsActive(moved, ssaoNoise.get()), "Reenabled branch inactive");
+
+	// without output nodes every node without consumers is one
+	{
+		Pipeline all;
+		all.CreateFromNodesList({ source, ssaoNoise, ssao, lighting, debug });
+		Check(lemon::countNodes(all.GetDependencyGraph()) == 5 && IsActive(all, debug.get()), "Default outputs wrong");
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
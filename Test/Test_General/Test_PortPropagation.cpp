@@ -0,0 +1,218 @@
+#include "Test.hpp"
+
+#include <BaseLibrary/Graph/Port.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using namespace exc;
+
+
+//------------------------------------------------------------------------------
+// Port types
+//------------------------------------------------------------------------------
+
+namespace {
+
+struct TestScale {
+	float scale;
+};
+
+struct TestMatrix {
+	float elements[16];
+};
+
+TestMatrix MatrixFromScale(TestScale scale) {
+	TestMatrix matrix = {};
+	for (int i = 0; i < 4; ++i) {
+		matrix.elements[i * 5] = i < 3 ? scale.scale : 1.0f;
+	}
+	return matrix;
+}
+
+TestMatrix MatrixFromFloat(float value) {
+	TestMatrix matrix;
+	for (float& element : matrix.elements) {
+		element = value;
+	}
+	return matrix;
+}
+
+} // namespace
+
+
+namespace exc {
+
+template <>
+class PortConverter<TestMatrix> : public PortConverterCollection<TestMatrix> {
+public:
+	PortConverter() : PortConverterCollection(&MatrixFromScale, &MatrixFromFloat) {}
+};
+
+} // namespace exc
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestPortPropagation : public AutoRegisterTest<TestPortPropagation> {
+public:
+	TestPortPropagation() {}
+
+	static std::string Name() {
+		return "Port Propagation";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestPortPropagation::Run() {
+	using Payload = std::vector<float>;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// moving into a single consumer does not copy
+	{
+		OutputPort<Payload> output;
+		InputPort<Payload> input;
+		output.Link(&input);
+
+		Payload payload(1000, 1.0f);
+		const float* storage = payload.data();
+		output.Set(std::move(payload));
+		Check(input.IsSet() && input.Get().data() == storage, "Moved payload was copied");
+
+		Payload taken = input.Take();
+		Check(taken.data() == storage && !input.IsSet(), "Taking the payload copied it or left the port set");
+	}
+
+	// with more consumers, one gets the moved payload and the others a copy
+	{
+		OutputPort<Payload> output;
+		InputPort<Payload> inputs[3];
+		for (auto& input : inputs) {
+			output.Link(&input);
+		}
+
+		Payload payload(1000, 2.0f);
+		const float* storage = payload.data();
+		output.Set(std::move(payload));
+		int numMoved = 0;
+		bool allEqual = true;
+		for (auto& input : inputs) {
+			numMoved += input.Get().data() == storage;
+			allEqual = allEqual && input.Get().size() == 1000 && input.Get()[999] == 2.0f;
+		}
+		Check(numMoved == 1 && allEqual, "Payload not moved to exactly one consumer and copied to the rest");
+	}
+
+	// shared payloads are shared by every consumer
+	{
+		using SharedPayload = std::shared_ptr<const Payload>;
+		OutputPort<SharedPayload> output;
+		InputPort<SharedPayload> inputs[3];
+		for (auto& input : inputs) {
+			output.Link(&input);
+		}
+
+		SharedPayload payload = std::make_shared<Payload>(1000, 3.0f);
+		output.Set(payload);
+		bool allShared = true;
+		for (auto& input : inputs) {
+			allShared = allShared && input.Get() == payload;
+		}
+		Check(allShared && payload.use_count() == 4, "Shared payload not shared");
+	}
+
+	// converters are found when linking
+	{
+		OutputPort<TestScale> output;
+		InputPort<TestMatrix> input;
+		Check(output.Link(&input), "Link through converter refused");
+		output.Set(TestScale{ 2.0f });
+		Check(input.IsSet() && input.Get().elements[0] == 2.0f && input.Get().elements[10] == 2.0f && input.Get().elements[15] == 1.0f,
+			  "Linked conversion wrong");
+
+		// other types still convert when set by hand
+		static_cast<InputPortBase&>(input).SetConvert(0.5f);
+		Check(input.Get().elements[3] == 0.5f, "Conversion of a type other than the linked one wrong");
+
+		OutputPort<int> unconvertible;
+		InputPort<TestMatrix> other;
+		Check(!unconvertible.Link(&other), "Link without converter accepted");
+	}
+
+	// benchmark: before and after
+	{
+		constexpr size_t PayloadSize = 1 << 20;
+		constexpr int NumPayloadRuns = 200;
+		constexpr int NumConversions = 1000000;
+
+		OutputPort<Payload> output;
+		InputPort<Payload> input;
+		output.Link(&input);
+		Payload payload(PayloadSize, 1.0f);
+
+		// copy on every propagation
+		auto copyStart = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < NumPayloadRuns; ++i) {
+			payload[0] = float(i);
+			output.Set(static_cast<const Payload&>(payload));
+		}
+		auto copyEnd = std::chrono::high_resolution_clock::now();
+
+		// move through, and take it back
+		for (int i = 0; i < NumPayloadRuns; ++i) {
+			payload[0] = float(i);
+			output.Set(std::move(payload));
+			payload = input.Take();
+		}
+		auto moveEnd = std::chrono::high_resolution_clock::now();
+		Check(payload.size() == PayloadSize && payload[0] == float(NumPayloadRuns - 1), "Payload lost while moving");
+
+		// conversion looked up for every set
+		OutputPort<TestScale> scaleOutput;
+		InputPort<TestMatrix> lookupInput, linkedInput;
+		scaleOutput.Link(&linkedInput);
+		float sum = 0.0f;
+		auto lookupStart = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < NumConversions; ++i) {
+			static_cast<InputPortBase&>(lookupInput).SetConvert(TestScale{ float(i & 7) });
+			sum += lookupInput.Get().elements[0];
+		}
+		auto lookupEnd = std::chrono::high_resolution_clock::now();
+
+		// conversion resolved when linked
+		for (int i = 0; i < NumConversions; ++i) {
+			scaleOutput.Set(TestScale{ float(i & 7) });
+			sum -= linkedInput.Get().elements[0];
+		}
+		auto linkedEnd = std::chrono::high_resolution_clock::now();
+		Check(sum == 0.0f, "Linked and looked up conversions differ");
+
+		auto copyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(copyEnd - copyStart).count();
+		auto moveNs = std::chrono::duration_cast<std::chrono::nanoseconds>(moveEnd - copyEnd).count();
+		auto lookupNs = std::chrono::duration_cast<std::chrono::nanoseconds>(lookupEnd - lookupStart).count();
+		auto linkedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(linkedEnd - lookupEnd).count();
+		cout << "Benchmark:" << endl;
+		cout << PayloadSize * sizeof(float) / 1024 << " kiB payload copied = " << copyNs / 1e3 / NumPayloadRuns << " us/set" << endl;
+		cout << PayloadSize * sizeof(float) / 1024 << " kiB payload moved = " << moveNs / 1e3 / NumPayloadRuns << " us/set" << endl;
+		cout << "Conversion looked up = " << double(lookupNs) / NumConversions << " ns/set" << endl;
+		cout << "Conversion resolved at link = " << double(linkedNs) / NumConversions << " ns/set" << endl;
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
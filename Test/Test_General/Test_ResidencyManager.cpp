@@ -0,0 +1,172 @@
+#include "Test.hpp"
+#include <iostream>
+#include <memory>
+#include <set>
+#include <vector>
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsApi_LL/Exception.hpp"
+#include "GraphicsApi_LL/IResource.hpp"
+#include "GraphicsEngine_LL/ResidencyManager.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestResidencyManager : public AutoRegisterTest<TestResidencyManager> {
+public:
+	TestResidencyManager() {}
+
+	static std::string Name() {
+		return "Residency Manager";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+
+namespace {
+
+// Null device that remembers what is resident and runs out of memory above a capacity.
+class FakeDevice : public inl::gxapi_null::GraphicsApi {
+public:
+	void MakeResident(const std::vector<inl::gxapi::IResource*>& objects) override {
+		++makeResidentCalls;
+		uint64_t size = residentSize;
+		for (auto object : objects) {
+			size += inl::gxeng::ResidencyManager::EstimateSize(object->GetDesc());
+		}
+		if (size > capacity) {
+			throw inl::gxapi::OutOfMemory("Fake device is full.");
+		}
+		resident.insert(objects.begin(), objects.end());
+		residentSize = size;
+	}
+	void Evict(const std::vector<inl::gxapi::IResource*>& objects) override {
+		++evictCalls;
+		for (auto object : objects) {
+			resident.erase(object);
+			residentSize -= inl::gxeng::ResidencyManager::EstimateSize(object->GetDesc());
+		}
+	}
+
+	std::set<inl::gxapi::IResource*> resident;
+	uint64_t residentSize = 0;
+	uint64_t capacity = std::numeric_limits<uint64_t>::max();
+	int makeResidentCalls = 0;
+	int evictCalls = 0;
+};
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestResidencyManager::Run() {
+	using namespace inl::gxapi;
+	using inl::gxeng::ResidencyManager;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	FakeDevice device;
+	ResidencyManager manager(&device, 1000);
+
+	std::vector<std::unique_ptr<IResource>> buffers;
+	for (int i = 0; i < 4; ++i) {
+		buffers.emplace_back(device.CreateCommittedResource(HeapProperties{ eHeapType::DEFAULT }, eHeapFlags::NONE, ResourceDesc::Buffer(300), eResourceState::COMMON));
+		device.resident.insert(buffers.back().get());
+		device.residentSize += 300;
+		manager.Add(buffers.back().get(), 300);
+	}
+	IResource* b0 = buffers[0].get();
+	IResource* b1 = buffers[1].get();
+	IResource* b2 = buffers[2].get();
+	IResource* b3 = buffers[3].get();
+
+	// creating the fourth one went over the budget, the oldest was evicted
+	Check(!manager.IsResident(b0) && manager.GetResidentSize() == 900, "Budget not enforced on creation");
+	Check(device.resident.count(b0) == 0, "Device did not evict the oldest resource");
+
+	// locking makes resident, evicting the least recently used
+	manager.SetCurrentFrame(5);
+	device.makeResidentCalls = device.evictCalls = 0;
+	manager.Lock({ b0 });
+	Check(manager.IsResident(b0) && manager.IsLocked(b0) && manager.GetLastUsedFrame(b0) == 5, "Locked resource not resident");
+	Check(!manager.IsResident(b1) && manager.GetResidentSize() == 900, "Least recently used not evicted");
+	Check(device.makeResidentCalls == 1 && device.evictCalls == 1, "Residency changes not batched");
+
+	// locked resources are never evicted, the budget is overcommitted instead
+	manager.Lock({ b2, b3 });
+	manager.Lock({ b1 });
+	Check(manager.IsResident(b0) && manager.IsResident(b1) && manager.IsResident(b2) && manager.IsResident(b3), "Locked resource evicted");
+	Check(manager.GetResidentSize() == 1200, "Overcommitted size wrong");
+
+	// unlocked resources become evictable in the order they were released
+	manager.Unlock({ b0, b2, b3 });
+	manager.SetBudget(600);
+	Check(!manager.IsResident(b0) && !manager.IsResident(b2) && manager.IsResident(b3) && manager.IsResident(b1), "Eviction not in LRU order");
+	Check(manager.GetResidentSize() == 600, "Resident size wrong after eviction");
+
+	// nested locks
+	manager.Lock({ b3 });
+	manager.Lock({ b3 });
+	manager.Unlock({ b3 });
+	Check(manager.IsLocked(b3), "Lock count not kept");
+	manager.Unlock({ b3, b1 });
+
+	// many resources are made resident in one call, duplicates once
+	manager.SetBudget(ResidencyManager::Unlimited);
+	device.makeResidentCalls = device.evictCalls = 0;
+	manager.Lock({ b0, b2, b0 });
+	Check(device.makeResidentCalls == 1 && device.evictCalls == 0 && manager.GetResidentSize() == 1200, "Batch made resident incorrectly");
+	manager.Unlock({ b0, b2, b0 });
+
+	// the device running out of memory before the budget does
+	manager.SetBudget(600); // evicts b3 and b1, released earlier than b0 and b2
+	manager.SetBudget(ResidencyManager::Unlimited);
+	manager.Lock({ b3 });
+	device.capacity = 600;
+	device.makeResidentCalls = 0;
+	manager.Lock({ b1 });
+	Check(device.makeResidentCalls == 2 && manager.IsResident(b1) && manager.IsResident(b3), "Device out of memory not handled");
+	Check(!manager.IsResident(b0) && !manager.IsResident(b2), "Unlocked resources not evicted when the device is full");
+	bool threw = false;
+	try {
+		manager.Lock({ b0 });
+	}
+	catch (OutOfMemory&) {
+		threw = true;
+	}
+	Check(threw && !manager.IsResident(b0), "Impossible residency did not fail");
+	Check(!manager.IsLocked(b0), "Failed lock left the resource locked");
+
+	// a failed lock can be retried once memory is released
+	manager.Unlock({ b3 });
+	manager.Lock({ b0 });
+	Check(manager.IsResident(b0) && manager.IsLocked(b0) && !manager.IsResident(b3), "Retried lock failed");
+	manager.Unlock({ b1, b0 });
+
+	// removed resources are forgotten
+	size_t residentBefore = manager.GetResidentSize();
+	manager.Remove(b1);
+	Check(!manager.IsResident(b1) && manager.GetResidentSize() == residentBefore - 300, "Removed resource still counted");
+
+	// size estimation
+	Check(ResidencyManager::EstimateSize(ResourceDesc::Buffer(1234)) == 1234, "Buffer size estimated incorrectly");
+	Check(ResidencyManager::EstimateSize(ResourceDesc::Texture2D(4, 4, eFormat::R8G8B8A8_UNORM, eResourceFlags::NONE, 0)) == (16 + 4 + 1) * 4, "Texture size estimated incorrectly");
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,151 @@
+#include "Test.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <vector>
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsApi_LL/Exception.hpp"
+#include "GraphicsApi_LL/IFence.hpp"
+#include "GraphicsEngine_LL/MemoryManager.hpp"
+#include "GraphicsEngine_LL/ResourceResidencyQueue.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestResourceResidencyQueue : public AutoRegisterTest<TestResourceResidencyQueue> {
+public:
+	TestResourceResidencyQueue() {}
+
+	static std::string Name() {
+		return "Resource Residency Queue";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+
+namespace {
+
+// Null device that runs out of memory when more than a capacity is made resident.
+class FakeDevice : public inl::gxapi_null::GraphicsApi {
+public:
+	void MakeResident(const std::vector<inl::gxapi::IResource*>& objects) override {
+		uint64_t size = residentSize;
+		for (auto object : objects) {
+			size += inl::gxeng::ResidencyManager::EstimateSize(object->GetDesc());
+		}
+		if (size > capacity) {
+			throw inl::gxapi::OutOfMemory("Fake device is full.");
+		}
+		residentSize = size;
+	}
+	void Evict(const std::vector<inl::gxapi::IResource*>& objects) override {
+		for (auto object : objects) {
+			residentSize -= inl::gxeng::ResidencyManager::EstimateSize(object->GetDesc());
+		}
+	}
+
+	std::atomic<uint64_t> residentSize{ 0 };
+	std::atomic<uint64_t> capacity{ std::numeric_limits<uint64_t>::max() };
+};
+
+bool IsSignaled(const inl::gxapi::IFence& fence, uint64_t value, std::chrono::milliseconds timeout) {
+	fence.Wait(value, timeout.count());
+	return fence.Fetch() >= value;
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestResourceResidencyQueue::Run() {
+	using namespace inl::gxapi;
+	using namespace inl::gxeng;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	constexpr uint64_t BufferSize = 1024;
+	constexpr std::chrono::milliseconds Timeout{ 5000 };
+
+	FakeDevice device;
+	MemoryManager memoryManager(&device);
+	ResidencyManager& residencyManager = memoryManager.GetResidencyManager();
+	VertexBuffer first = memoryManager.CreateVertexBuffer(eResourceHeapType::CRITICAL, BufferSize);
+	VertexBuffer second = memoryManager.CreateVertexBuffer(eResourceHeapType::CRITICAL, BufferSize);
+	VertexBuffer third = memoryManager.CreateVertexBuffer(eResourceHeapType::CRITICAL, BufferSize);
+
+	// everything evicted, only one buffer fits
+	residencyManager.SetBudget(0);
+	residencyManager.SetBudget(ResidencyManager::Unlimited);
+	device.residentSize = 0;
+	device.capacity = BufferSize;
+
+	// the queue signals its fence with the number of the list
+	IFence* residentFence = device.CreateFence(0);
+	std::shared_ptr<IFence> completionFence(device.CreateFence(0));
+	std::atomic<int> numFailures{ 0 };
+	{
+		ResourceResidencyQueue queue{ std::unique_ptr<IFence>(residentFence) };
+		queue.SetMemoryManager(&memoryManager);
+		queue.SetFailureHandler([&numFailures] { ++numFailures; });
+
+		// a list that fits is signaled
+		queue.EnqueueInit({ first });
+		queue.EnqueueClean(SyncPoint(completionFence, 1), { first });
+		Check(IsSignaled(*residentFence, 1, Timeout), "Resident list not signaled");
+		Check(residencyManager.IsLocked(first._GetResourcePtr()), "Resources of the list not locked");
+
+		// a list that doesn't fit is held back while the first one runs
+		queue.EnqueueInit({ second });
+		queue.EnqueueClean(SyncPoint(completionFence, 2), { second });
+		Check(!IsSignaled(*residentFence, 2, ResourceResidencyQueue::RetryInterval * 3), "List signaled with evicted resources");
+		Check(numFailures > 0, "Failure handler not called");
+		Check(!residencyManager.IsLocked(second._GetResourcePtr()), "Resources of a failed list locked");
+
+		// the handler can be replaced while the queue is retrying
+		queue.SetFailureHandler([&numFailures] { numFailures += 100; });
+		Check(bool(queue.GetFailureHandler()), "Failure handler not stored");
+
+		// finishing the first list frees its memory for the second one
+		completionFence->Signal(1);
+		Check(IsSignaled(*residentFence, 2, Timeout), "Held back list not retried after memory was freed");
+		Check(!residencyManager.IsLocked(first._GetResourcePtr()) && residencyManager.IsLocked(second._GetResourcePtr()),
+			  "Locks wrong after the first list finished");
+
+		// a list held back when the queue is destroyed is neither signaled nor unlocked
+		queue.EnqueueInit({ third });
+		queue.EnqueueClean(SyncPoint(completionFence, 3), { third });
+		Check(!IsSignaled(*residentFence, 3, ResourceResidencyQueue::RetryInterval * 2), "List signaled with evicted resources");
+
+		bool thrown = false;
+		try {
+			queue.SetMemoryManager(nullptr);
+		}
+		catch (std::logic_error&) {
+			thrown = true;
+		}
+		Check(thrown, "Memory manager changed after lists were enqueued");
+	}
+	Check(residencyManager.IsLocked(second._GetResourcePtr()), "Unfinished list unlocked");
+	Check(!residencyManager.IsLocked(third._GetResourcePtr()), "Resources locked for a list that never fit");
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
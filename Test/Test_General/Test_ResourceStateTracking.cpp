@@ -0,0 +1,134 @@
+#include "Test.hpp"
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "GraphicsApi_Null/GraphicsApi.hpp"
+#include "GraphicsEngine_LL/MemoryObject.hpp"
+#include "GraphicsEngine_LL/ResourceStateTable.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestResourceStateTracking : public AutoRegisterTest<TestResourceStateTracking> {
+public:
+	TestResourceStateTracking() {}
+
+	static std::string Name() {
+		return "Resource State Tracking";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestResourceStateTracking::Run() {
+	using namespace inl::gxapi;
+	using namespace inl::gxeng;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	inl::gxapi_null::GraphicsApi gxapi;
+	auto CreateTexture = [&gxapi](unsigned mipLevels) {
+		IResource* resource = gxapi.CreateCommittedResource(HeapProperties{ eHeapType::DEFAULT }, eHeapFlags::NONE, ResourceDesc::Texture2D(64, 64, eFormat::R8G8B8A8_UNORM, eResourceFlags::NONE, mipLevels), eResourceState::COMMON);
+		return MemoryObject(MemoryObjDesc(resource, eResourceHeap::CRITICAL));
+	};
+	auto CreateBuffer = [&gxapi]() {
+		IResource* resource = gxapi.CreateCommittedResource(HeapProperties{ eHeapType::DEFAULT }, eHeapFlags::NONE, ResourceDesc::Buffer(256), eResourceState::COMMON);
+		return MemoryObject(MemoryObjDesc(resource, eResourceHeap::CRITICAL));
+	};
+
+	// memory objects keep a single state until subresources diverge
+	MemoryObject texture = CreateTexture(4);
+	Check(texture.GetNumSubresources() == 4 && texture.HasUniformState(), "New texture not uniform");
+	texture.RecordState(eResourceState::PIXEL_SHADER_RESOURCE);
+	texture.RecordState(2, eResourceState::PIXEL_SHADER_RESOURCE);
+	Check(texture.HasUniformState(), "Recording the same state expanded the states");
+	texture.RecordState(2, eResourceState::RENDER_TARGET);
+	Check(!texture.HasUniformState() && texture.ReadState(2) == eResourceState::RENDER_TARGET && texture.ReadState(3) == eResourceState::PIXEL_SHADER_RESOURCE, "Diverging subresource not tracked");
+	texture.RecordState(eResourceState::COPY_DEST);
+	Check(texture.HasUniformState() && texture.ReadState(1) == eResourceState::COPY_DEST, "Whole resource state not uniform");
+
+	// whole resource use is a single entry with whole resource barriers
+	ResourceStateTable table;
+	std::vector<ResourceBarrier> barriers;
+	std::vector<ResourceUsage> usages;
+	table.SetState(texture, eResourceState::RENDER_TARGET, ALL_SUBRESOURCES, barriers);
+	table.SetState(texture, eResourceState::PIXEL_SHADER_RESOURCE, ALL_SUBRESOURCES, barriers);
+	Check(barriers.size() == 1 && barriers[0].transition.subResource == ALL_SUBRESOURCES, "Whole resource transition not a single barrier");
+	Check(table.Find(texture, 3) && table.Find(texture, 3)->lastState == eResourceState::PIXEL_SHADER_RESOURCE, "Subresource state not found");
+	table.Decompose(usages);
+	Check(usages.size() == 1 && usages[0].subresource == ALL_SUBRESOURCES && usages[0].firstState == eResourceState::RENDER_TARGET && usages[0].multipleStates, "Whole resource usage wrong");
+	Check(table.GetResourceCount() == 0 && !table.Find(texture, 0), "Table not cleared by decomposition");
+
+	// using a subresource on its own expands the entry
+	barriers.clear();
+	usages.clear();
+	table.SetState(texture, eResourceState::PIXEL_SHADER_RESOURCE, ALL_SUBRESOURCES, barriers);
+	table.SetState(texture, eResourceState::RENDER_TARGET, 1, barriers);
+	Check(barriers.size() == 1 && barriers[0].transition.subResource == 1, "Subresource barrier wrong");
+	Check(!table.Find(texture, ALL_SUBRESOURCES) && table.Find(texture, 0)->lastState == eResourceState::PIXEL_SHADER_RESOURCE, "Expanded entry lookup wrong");
+	table.Decompose(usages);
+	Check(usages.size() == 4 && usages[1].subresource == 1 && usages[1].multipleStates && !usages[2].multipleStates, "Expanded usage wrong");
+
+	// only the touched subresources are reported
+	usages.clear();
+	table.SetState(texture, eResourceState::COPY_SOURCE, 2, barriers);
+	table.Decompose(usages);
+	Check(usages.size() == 1 && usages[0].subresource == 2, "Untouched subresources reported");
+
+	// single subresource resources are always tracked whole
+	usages.clear();
+	MemoryObject buffer = CreateBuffer();
+	table.SetState(buffer, eResourceState::COPY_DEST, 0, barriers);
+	table.Decompose(usages);
+	Check(usages.size() == 1 && usages[0].subresource == ALL_SUBRESOURCES, "Buffer not tracked whole");
+
+	// benchmark: thousands of resources, each transitioned a few times per command list
+	{
+		constexpr int NumResources = 2048;
+		constexpr int NumLists = 50;
+		std::vector<MemoryObject> resources;
+		for (int i = 0; i < NumResources; ++i) {
+			resources.push_back(i % 4 == 0 ? CreateTexture(8) : CreateBuffer());
+		}
+		const eResourceState states[] = { eResourceState::RENDER_TARGET, eResourceState::PIXEL_SHADER_RESOURCE, eResourceState::COPY_SOURCE };
+
+		size_t numTransitions = 0;
+		size_t numBarriers = 0;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (int list = 0; list < NumLists; ++list) {
+			barriers.clear();
+			usages.clear();
+			for (auto state : states) {
+				for (int i = 0; i < NumResources; ++i) {
+					table.SetState(resources[i], state, i % 16 == 0 ? 3 : ALL_SUBRESOURCES, barriers);
+					++numTransitions;
+				}
+			}
+			numBarriers += barriers.size();
+			table.Decompose(usages);
+		}
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		Check(usages.size() == NumResources, "Benchmark usage count wrong");
+		Check(numBarriers == NumLists * 2 * NumResources, "Benchmark barrier count wrong");
+
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+		cout << "Benchmark:" << endl;
+		cout << numTransitions << " transitions = " << ns / 1e6 << " ms (" << (double)ns / numTransitions << " ns/transition)" << endl;
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
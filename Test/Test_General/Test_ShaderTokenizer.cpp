@@ -0,0 +1,207 @@
+#include "Test.hpp"
+
+#include <GraphicsEngine_LL/Material.hpp>
+#include <GraphicsEngine_LL/ShaderTokenizer.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using std::cout;
+using std::endl;
+using namespace inl::gxeng;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestShaderTokenizer : public AutoRegisterTest<TestShaderTokenizer> {
+public:
+	TestShaderTokenizer() {}
+
+	static std::string Name() {
+		return "Shader Tokenizer";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+namespace {
+
+std::unique_ptr<MaterialShader> MakeEquation(const std::string& code, const std::string& name) {
+	auto equation = std::make_unique<MaterialShaderEquation>(nullptr);
+	equation->SetSourceCode(code);
+	equation->SetName(name);
+	return equation;
+}
+
+const char* const MapShader =
+	"float4 main(MapColor2D map) {\n"
+	"    return map.tex.Sample(map.samp, g_tex0);\n"
+	"}";
+const char* const DarkenShader =
+	"float4 main(float4 color) {\n"
+	"    return color * 0.4f;\n"
+	"}";
+const char* const LightenShader =
+	"float4 main(float4 color) {\n"
+	"    return 1 - (1 - color) * 0.4f;\n"
+	"}";
+const char* const MixShader =
+	"float4 main(float4 a, float4 b, float weight) {\n"
+	"    return lerp(a, b, weight);\n"
+	"}";
+
+std::vector<std::unique_ptr<MaterialShader>> MakeNodes(const char* secondShader) {
+	std::vector<std::unique_ptr<MaterialShader>> nodes;
+	nodes.push_back(MakeEquation(MapShader, "map"));
+	nodes.push_back(MakeEquation(DarkenShader, "dark"));
+	nodes.push_back(MakeEquation(secondShader, "second"));
+	nodes.push_back(MakeEquation(MixShader, "mix"));
+	return nodes;
+}
+
+std::vector<MaterialShaderGraph::Link> MakeLinks() {
+	return { { 0, 1, 0 }, { 0, 2, 0 }, { 1, 3, 0 }, { 2, 3, 1 } };
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestShaderTokenizer::Run() {
+	int errors = 0;
+	TestCheck Check(errors);
+
+	// tokenizing
+	{
+		ShaderTokenizer tokenizer(
+			"#define SCALE 2 \\\n"
+			"    * 3\n"
+			"float4 main(float x) { // main is here\n"
+			"    /* main */ return mainColor * main(1e-3 + .5f + 0x1F) + \"main\";\n"
+			"}\n");
+		const auto& tokens = tokenizer.GetTokens();
+		Check(tokens.size() == 22, "Wrong number of tokens");
+		Check(tokenizer.Equals(tokens[0], "float4") && tokens[0].type == eShaderTokenType::IDENTIFIER, "Preprocessor line not skipped");
+		int numNumbers = 0;
+		int numStrings = 0;
+		for (const auto& token : tokens) {
+			numNumbers += token.type == eShaderTokenType::NUMBER;
+			numStrings += token.type == eShaderTokenType::STRING;
+		}
+		Check(numNumbers == 3 && numStrings == 1, "Numbers or strings split wrong");
+
+		std::string renamed = tokenizer.RenameIdentifier("main", "main_0");
+		Check(renamed.find("float4 main_0(") != renamed.npos && renamed.find("main_0(1e-3") != renamed.npos, "Identifier not renamed");
+		Check(renamed.find("mainColor") != renamed.npos && renamed.find("// main is here") != renamed.npos
+				  && renamed.find("/* main */") != renamed.npos && renamed.find("\"main\"") != renamed.npos,
+			  "Partial identifier, comment or string renamed");
+		Check(tokenizer.StripComments().find("main is here") == std::string::npos, "Comment not stripped");
+	}
+
+	// signature parsing
+	{
+		ShaderTokenizer tokenizer(
+			"float helper(float x);\n"
+			"float4 main(in float4 color : COLOR0, const Texture2D<float4> tex, vector<float, 3> dir,\n"
+			"            float bias = 1 < 2 ? 0.5 : 1, bool flag = (3 > 1), out float weights[4]) : SV_Target {\n"
+			"    return color;\n"
+			"}\n"
+			"float helper(float x) { return x; }\n"
+			"void empty(void) {}\n");
+		ShaderFunctionSignature signature = tokenizer.FindFunctionSignature("main");
+		const std::vector<std::pair<std::string, std::string>> expected = {
+			{ "float4", "color" },
+			{ "Texture2D<float4>", "tex" },
+			{ "vector<float, 3>", "dir" },
+			{ "float", "bias" },
+			{ "bool", "flag" },
+			{ "float", "weights" },
+		};
+		Check(signature.returnType == "float4" && signature.parameters == expected, "Signature parsed wrong");
+		Check(tokenizer.FindFunctionSignature("helper").parameters.size() == 1, "Declaration taken for a definition");
+		Check(tokenizer.FindFunctionSignature("empty").parameters.empty(), "Void parameter list not empty");
+
+		bool thrown = false;
+		try {
+			tokenizer.FindFunctionSignature("missing");
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		Check(thrown, "Missing function found");
+	}
+
+	// equations parse on set, share signatures by source, and defer errors until queried
+	{
+		MaterialShaderEquation first(nullptr), second(nullptr), invalid(nullptr);
+		first.SetSourceCode(MixShader);
+		second.SetSourceCode(MixShader);
+		auto parameters = first.GetShaderParameters();
+		Check(parameters.size() == 3 && parameters[2].name == "weight" && parameters[2].type == eMaterialShaderParamType::VALUE,
+			  "Equation parameters wrong");
+		Check(first.GetHash() == second.GetHash() && second.GetShaderOutputType() == eMaterialShaderParamType::COLOR, "Same source differs");
+
+		invalid.SetSourceCode("float4 notMain() { return 0; }");
+		bool thrown = false;
+		try {
+			invalid.GetShaderParameters();
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		Check(thrown, "Invalid source not reported");
+
+		// queried from many threads at once
+		std::atomic<int> numWrong{ 0 };
+		std::vector<std::thread> threads;
+		for (int i = 0; i < 4; ++i) {
+			threads.emplace_back([&] {
+				for (int j = 0; j < 1000; ++j) {
+					MaterialShaderEquation equation(nullptr);
+					equation.SetSourceCode(j % 2 ? MixShader : DarkenShader);
+					numWrong += equation.GetShaderParameters().size() != (j % 2 ? 3u : 1u);
+					numWrong += first.GetShaderParameters().size() != 3;
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		Check(numWrong == 0, "Concurrent queries gave wrong signatures");
+	}
+
+	// re-assembly after a single node changes gives the same code as assembling from scratch
+	{
+		MaterialShaderGraph graph(nullptr);
+		graph.SetGraph(MakeNodes(DarkenShader), MakeLinks());
+		std::string originalCode = graph.GetShaderCode();
+		size_t originalHash = graph.GetHash();
+		Check(originalCode.find("float4 main(MapColor2D map__map, float mix__weight)") != originalCode.npos, "Assembled signature wrong");
+
+		graph.SetGraph(MakeNodes(DarkenShader), MakeLinks());
+		Check(graph.GetShaderCode() == originalCode && graph.GetHash() == originalHash, "Unchanged graph assembled differently");
+
+		graph.SetGraph(MakeNodes(LightenShader), MakeLinks());
+		MaterialShaderGraph fresh(nullptr);
+		fresh.SetGraph(MakeNodes(LightenShader), MakeLinks());
+		Check(graph.GetShaderCode() == fresh.GetShaderCode() && graph.GetHash() == fresh.GetHash(), "Re-assembly differs from a fresh assembly");
+		Check(graph.GetShaderCode() != originalCode && graph.GetHash() != originalHash, "Changed node not re-emitted");
+		Check(graph.GetShaderCode().find("1 - (1 - color)") != std::string::npos, "Changed node's code missing");
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,176 @@
+#include "Test.hpp"
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include "GraphicsEngine_LL/ShadowCascades.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestShadowCascades : public AutoRegisterTest<TestShadowCascades> {
+public:
+	TestShadowCascades() {}
+
+	static std::string Name() {
+		return "Shadow Cascades";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestShadowCascades::Run() {
+	using namespace inl::gxeng;
+	using Vec3 = mathfu::Vector<float, 3>;
+	using Vec4 = mathfu::Vector<float, 4>;
+
+	const float pi = 3.14159265f;
+	std::mt19937 rne(2718);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	auto RandomDirection = [&]() {
+		Vec3 v;
+		do {
+			v = Vec3(unit(rne), unit(rne), unit(rne));
+		} while (v.Length() < 0.1f);
+		return v.Normalized();
+	};
+	auto MakeView = [&](Vec3 position, Vec3 look) {
+		ShadowCascadeView view;
+		view.position = position;
+		view.lookDirection = look;
+		Vec3 side = Vec3::CrossProduct(look, std::abs(look.z()) < 0.9f ? Vec3(0, 0, 1) : Vec3(1, 0, 0)).Normalized();
+		view.upVector = Vec3::CrossProduct(side, look);
+		view.tanHalfFovY = std::tan(pi / 6.0f);
+		view.tanHalfFovX = view.tanHalfFovY * 16.0f / 9.0f;
+		view.nearPlane = 0.1f;
+		view.farPlane = 400.0f;
+		return view;
+	};
+
+	// every corner of every slice must land inside its cascade, for any camera and light
+	ShadowCascadeFitter fitter;
+	size_t cornersOutside = 0;
+	bool splitsOk = true;
+	for (int frame = 0; frame < 500; ++frame) {
+		ShadowCascadeView view = MakeView(Vec3(unit(rne), unit(rne), unit(rne)) * 50.0f, RandomDirection());
+		fitter.Update(view, frame % 10 == 0 ? RandomDirection() : fitter.GetCascade(0).lightDirection);
+		Vec3 side = Vec3::CrossProduct(view.lookDirection, view.upVector);
+		for (unsigned c = 0; c < fitter.GetCascadeCount(); ++c) {
+			const ShadowCascade& cascade = fitter.GetCascade(c);
+			splitsOk = splitsOk && cascade.nearSplit < cascade.farSplit
+				&& (c == 0 ? cascade.nearSplit == view.nearPlane : cascade.nearSplit == fitter.GetCascade(c - 1).farSplit);
+			auto viewProjection = cascade.GetViewProjection();
+			for (int corner = 0; corner < 8; ++corner) {
+				float depth = corner < 4 ? cascade.nearSplit : cascade.farSplit;
+				float x = (corner & 1 ? 1.0f : -1.0f) * view.tanHalfFovX * depth;
+				float y = (corner & 2 ? 1.0f : -1.0f) * view.tanHalfFovY * depth;
+				Vec3 world = view.position + view.lookDirection * depth + side * x + view.upVector * y;
+				Vec4 clip = viewProjection * Vec4(world, 1.0f);
+				bool inside = std::abs(clip.x()) <= 1.0f && std::abs(clip.y()) <= 1.0f && clip.z() >= 0.0f && clip.z() <= 1.0f;
+				cornersOutside += !inside;
+			}
+		}
+	}
+	splitsOk = splitsOk && std::abs(fitter.GetCascade(fitter.GetCascadeCount() - 1).farSplit - fitter.GetDesc().shadowDistance) < 1e-3f;
+
+	// small moves keep the margined cascades, large moves and a turning light refit them
+	Vec3 light = Vec3(0.3f, 0.2f, -1.0f).Normalized();
+	Vec3 look = Vec3(1.0f, 0.0f, 0.0f);
+	fitter.Update(MakeView(Vec3(0, 0, 0), look), light);
+	auto farMatrix = fitter.GetCascade(3).GetViewProjection();
+	ShadowCascade farBefore = fitter.GetCascade(3);
+	fitter.Update(MakeView(Vec3(0.5f, 0.5f, 0), look), light);
+	auto farMatrixAfter = fitter.GetCascade(3).GetViewProjection();
+	bool cachingOk = fitter.GetCascade(0).refit && !fitter.GetCascade(3).refit;
+	for (int i = 0; i < 16; ++i) {
+		cachingOk = cachingOk && farMatrixAfter[i] == farMatrix[i];
+	}
+	fitter.Update(MakeView(Vec3(150.0f, 0, 0), look), light);
+	cachingOk = cachingOk && fitter.GetCascade(3).refit;
+	ShadowCascade farAfter = fitter.GetCascade(3);
+	fitter.Update(MakeView(Vec3(150.0f, 0, 0), look), Vec3(0.31f, 0.2f, -1.0f).Normalized());
+	for (unsigned c = 0; c < fitter.GetCascadeCount(); ++c) {
+		cachingOk = cachingOk && fitter.GetCascade(c).refit;
+	}
+
+	// refitted centers stay on the texel grid
+	float texelSize = 2.0f * farAfter.halfExtent / fitter.GetDesc().resolution;
+	float stepX = Vec3::DotProduct(farAfter.lightRight, farAfter.center - farBefore.center) / texelSize;
+	float stepY = Vec3::DotProduct(farAfter.lightUp, farAfter.center - farBefore.center) / texelSize;
+	bool snappingOk = std::abs(farAfter.halfExtent - farBefore.halfExtent) < 1e-3f
+		&& std::abs(stepX - std::round(stepX)) < 0.02f
+		&& std::abs(stepY - std::round(stepY)) < 0.02f;
+
+	// casters: inside, toward the light, past the far side, off to the side
+	const ShadowCascade& cascade = fitter.GetCascade(1);
+	Vec3 half(1.0f, 1.0f, 1.0f);
+	Vec3 inside = cascade.center;
+	Vec3 towardLight = cascade.center - cascade.lightDirection * (cascade.radius * 10.0f);
+	Vec3 beyond = cascade.center + cascade.lightDirection * (cascade.radius + 2.0f);
+	Vec3 aside = cascade.center + cascade.lightRight * (cascade.halfExtent + 2.0f);
+	Vec3 touching = cascade.center + cascade.lightUp * (cascade.halfExtent + 0.5f);
+	bool cullingOk = cascade.IsCasterVisible(inside - half, inside + half)
+		&& cascade.IsCasterVisible(towardLight - half, towardLight + half)
+		&& !cascade.IsCasterVisible(beyond - half, beyond + half)
+		&& !cascade.IsCasterVisible(aside - half, aside + half)
+		&& cascade.IsCasterVisible(touching - half, touching + half);
+
+	bool throwsOk = true;
+	try {
+		ShadowCascadeDesc desc;
+		desc.updateIntervals = { 1, 2 };
+		ShadowCascadeFitter invalid(desc);
+		throwsOk = false;
+	}
+	catch (std::invalid_argument&) {}
+	try {
+		ShadowCascadeView view = MakeView(Vec3(0, 0, 0), look);
+		view.nearPlane = 0.0f;
+		fitter.Update(view, light);
+		throwsOk = false;
+	}
+	catch (std::invalid_argument&) {}
+
+	cout << "Slice corners outside their cascade: " << cornersOutside << endl;
+	cout << "Refitted far cascade moved " << stepX << ", " << stepY << " texels." << endl;
+
+	int failed = 0;
+	if (cornersOutside > 0) {
+		cout << "Cascades do not cover their slices." << endl;
+		++failed;
+	}
+	if (!splitsOk) {
+		cout << "Splits are not contiguous." << endl;
+		++failed;
+	}
+	if (!cachingOk) {
+		cout << "Cascades are refitted at the wrong time." << endl;
+		++failed;
+	}
+	if (!snappingOk) {
+		cout << "Cascades are not snapped to texels." << endl;
+		++failed;
+	}
+	if (!cullingOk) {
+		cout << "Caster culling is wrong." << endl;
+		++failed;
+	}
+	if (!throwsOk) {
+		cout << "Invalid input was accepted." << endl;
+		++failed;
+	}
+
+	return failed;
+}
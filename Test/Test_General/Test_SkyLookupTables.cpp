@@ -0,0 +1,157 @@
+#include "Test.hpp"
+#include <cmath>
+#include <iostream>
+#include "GraphicsEngine_LL/SkyLookupTableBuilder.hpp"
+#include "GraphicsEngine_LL/SkyLookupTables.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestSkyLookupTables : public AutoRegisterTest<TestSkyLookupTables> {
+public:
+	TestSkyLookupTables() {}
+
+	static std::string Name() {
+		return "Sky Lookup Tables";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestSkyLookupTables::Run() {
+	using namespace inl::gxeng;
+	using Vec3 = mathfu::Vector<float, 3>;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	AtmosphereParams atmosphere;
+	SkyLookupTablesDesc desc;
+	desc.skyViewWidth = 64;
+	desc.skyViewHeight = 48;
+
+	// straight up, the optical depth of exponential layers and the ozone tent has a closed form
+	{
+		float height = 0.5f;
+		float top = atmosphere.atmosphereHeight;
+		auto Layer = [&](float scaleHeight) {
+			return scaleHeight * (std::exp(-height / scaleHeight) - std::exp(-top / scaleHeight));
+		};
+		Vec3 opticalDepth = atmosphere.rayleighScattering * Layer(atmosphere.rayleighScaleHeight)
+			+ Vec3((atmosphere.mieScattering + atmosphere.mieAbsorption) * atmosphere.turbidity * Layer(atmosphere.mieScaleHeight))
+			+ atmosphere.ozoneAbsorption * 15.0f;
+		Vec3 computed = SkyLookupTables::ComputeTransmittance(atmosphere, height, 1.0f);
+		bool close = true;
+		for (int i = 0; i < 3; ++i) {
+			close = close && std::abs(computed[i] - std::exp(-opticalDepth[i])) < 0.01f * std::exp(-opticalDepth[i]);
+		}
+		Check(close, "Vertical transmittance does not match the analytic optical depth");
+	}
+	Check(SkyLookupTables::ComputeTransmittance(atmosphere, 1.0f, -0.5f).Length() == 0.0f, "Ray into the ground is not opaque");
+	Check(SkyLookupTables::ComputeTransmittance(atmosphere, atmosphere.atmosphereHeight, 1.0f).x() > 0.9999f, "Top of the atmosphere is not transparent");
+	Vec3 horizon = SkyLookupTables::ComputeTransmittance(atmosphere, 0.0f, 0.01f);
+	Check(horizon.z() < horizon.x(), "Blue is not extincted more than red near the horizon");
+
+	float g = atmosphere.mieAnisotropy;
+	Check(SkyLookupTables::CornetteShanksPhase(1.0f, g) > SkyLookupTables::CornetteShanksPhase(-1.0f, g), "Mie phase does not favor forward scattering");
+	Check(std::abs(SkyLookupTables::RayleighPhase(1.0f) - SkyLookupTables::RayleighPhase(-1.0f)) < 1e-6f, "Rayleigh phase is not symmetric");
+
+	// the first update builds all tables
+	SkyLookupTables tables(desc);
+	Vec3 sunDirection = Vec3(0.6f, 0.2f, 0.3f).Normalized();
+	Check(tables.Update(atmosphere, sunDirection, 0.2f) == eSkyLutChange::ALL, "First update did not compute all tables");
+	Check(tables.GetVersion() == 1, "Version not incremented");
+
+	{
+		bool valid = true;
+		for (float value : tables.GetMultiScattering()) {
+			valid = valid && value >= 0.0f && std::isfinite(value);
+		}
+		for (float value : tables.GetSkyView()) {
+			valid = valid && value >= 0.0f && std::isfinite(value);
+		}
+		Check(valid, "Negative or invalid texels");
+
+		Vec3 tableVertical = tables.SampleTransmittance(0.5f, 1.0f);
+		Vec3 computedVertical = SkyLookupTables::ComputeTransmittance(atmosphere, 0.5f, 1.0f);
+		Check((tableVertical - computedVertical).Length() < 0.01f, "Transmittance table does not match the reference");
+
+		// the clear sky is blue overhead and brighter around the sun
+		Vec3 zenith = tables.ComputeSkyLuminance(atmosphere, 0.2f, Vec3(0, 0, 1), sunDirection);
+		Check(zenith.z() > zenith.x(), "Zenith is not blue");
+		Vec3 towardsSun = tables.ComputeSkyLuminance(atmosphere, 0.2f, Vec3(sunDirection.x(), sunDirection.y(), sunDirection.z() + 0.05f).Normalized(), sunDirection);
+		Vec3 awayFromSun = tables.ComputeSkyLuminance(atmosphere, 0.2f, Vec3(-sunDirection.x(), -sunDirection.y(), sunDirection.z() + 0.05f).Normalized(), sunDirection);
+		Check(towardsSun.Length() > awayFromSun.Length(), "Sky is not brighter towards the sun");
+
+		// the sky view table matches the reference at a texel center: the first column faces the sun
+		const auto& skyView = tables.GetSkyView();
+		unsigned row = desc.skyViewHeight - 1; // zenith
+		Vec3 texel(skyView[4 * row * desc.skyViewWidth + 0], skyView[4 * row * desc.skyViewWidth + 1], skyView[4 * row * desc.skyViewWidth + 2]);
+		Check((texel - zenith).Length() < 0.01f * zenith.Length(), "Sky view table does not match the reference");
+	}
+
+	// cached tables are kept until the inputs drift beyond the thresholds
+	Check(tables.Update(atmosphere, sunDirection, 0.2f) == eSkyLutChange::NONE, "Unchanged inputs recomputed the tables");
+	Vec3 rotatedSun(-sunDirection.y(), sunDirection.x(), sunDirection.z());
+	Check(tables.Update(atmosphere, rotatedSun, 0.2f) == eSkyLutChange::NONE, "Sun azimuth recomputed the tables");
+	Check(tables.Update(atmosphere, sunDirection, 0.22f) == eSkyLutChange::NONE, "Small height change recomputed the tables");
+	AtmosphereParams slightlyHazy = atmosphere;
+	slightlyHazy.turbidity *= 1.0001f;
+	Check(tables.Update(slightlyHazy, sunDirection, 0.2f) == eSkyLutChange::NONE, "Small turbidity change recomputed the tables");
+	Check(tables.GetVersion() == 1, "Version changed without recomputing");
+
+	float elevation = std::asin(sunDirection.z());
+	Vec3 raisedSun(std::cos(elevation + 0.01f), 0.0f, std::sin(elevation + 0.01f));
+	Check(tables.Update(atmosphere, raisedSun, 0.2f) == eSkyLutChange::SKY_VIEW, "Sun elevation change did not recompute the sky view");
+	Check(tables.Update(atmosphere, raisedSun, 1.0f) == eSkyLutChange::SKY_VIEW, "Height change did not recompute the sky view");
+
+	AtmosphereParams hazy = atmosphere;
+	hazy.turbidity = 3.0f;
+	Vec3 clearHorizon = tables.ComputeSkyLuminance(atmosphere, 1.0f, Vec3(1, 0, 0.02f).Normalized(), raisedSun);
+	Check(tables.Update(hazy, raisedSun, 1.0f) == eSkyLutChange::ALL, "Turbidity change did not recompute all tables");
+	Vec3 hazyHorizon = tables.ComputeSkyLuminance(hazy, 1.0f, Vec3(1, 0, 0.02f).Normalized(), raisedSun);
+	Check(hazyHorizon.x() / hazyHorizon.z() > clearHorizon.x() / clearHorizon.z(), "Haze does not whiten the sky");
+	Check(tables.GetVersion() == 4, "Version not incremented on recompute");
+
+	// the builder hands over tables built in the background, they match the ones built in place
+	{
+		SkyLookupTableBuilder builder(desc);
+		Check(builder.Update(atmosphere, sunDirection, 0.2f) == eSkyLutChange::NONE && !builder.HasTables(), "Builder waited for the tables");
+		builder.Flush();
+		Check(builder.Update(atmosphere, sunDirection, 0.2f) == eSkyLutChange::ALL && builder.GetVersion() == 1, "Built tables not handed over");
+
+		SkyLookupTables reference(desc);
+		reference.Update(atmosphere, sunDirection, 0.2f);
+		Check(builder.GetTransmittance() == reference.GetTransmittance() && builder.GetSkyView() == reference.GetSkyView(),
+			  "Tables built in the background differ from the reference");
+
+		builder.Flush();
+		Check(builder.Update(atmosphere, sunDirection, 0.2f) == eSkyLutChange::NONE && builder.GetVersion() == 1, "Unchanged inputs handed over new tables");
+
+		// requests made while building are merged, the latest one is built
+		builder.Update(atmosphere, raisedSun, 1.0f);
+		builder.Update(hazy, raisedSun, 1.0f);
+		builder.Flush();
+		Check(builder.Update(hazy, raisedSun, 1.0f) == eSkyLutChange::ALL, "Merged requests did not report all tables");
+		reference.Update(hazy, raisedSun, 1.0f);
+		Check(builder.GetTransmittance() == reference.GetTransmittance() && builder.GetSkyView() == reference.GetSkyView(),
+			  "Latest request not built");
+
+		SkyLookupTableBuilder synchronousBuilder(desc, false);
+		Check(synchronousBuilder.Update(atmosphere, sunDirection, 0.2f) == eSkyLutChange::ALL, "Synchronous builder did not build in place");
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
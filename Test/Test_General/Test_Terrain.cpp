@@ -0,0 +1,347 @@
+#include "Test.hpp"
+#include <cmath>
+#include <experimental/filesystem>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include "GraphicsEngine_LL/TerrainLod.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestTerrain : public AutoRegisterTest<TestTerrain> {
+public:
+	TestTerrain() {}
+
+	static std::string Name() {
+		return "Terrain";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+
+using namespace inl::gxeng;
+
+namespace {
+
+class MemoryTileSource : public ITerrainTileSource {
+public:
+	MemoryTileSource(const TerrainDesc& desc, const std::vector<float>& heights, const std::vector<uint8_t>& materials) : m_desc(desc) {
+		BuildTerrainTiles(desc, heights.data(), materials.data(), [this](const TerrainTileKey& key, TerrainTile&& tile) {
+			m_tiles[key] = std::move(tile);
+		});
+	}
+
+	const TerrainDesc& GetDesc() const override { return m_desc; }
+	bool LoadTile(const TerrainTileKey& key, TerrainTile& tile) override {
+		++numLoads;
+		if (failingKey && key == *failingKey) {
+			throw std::runtime_error("Tile could not be read.");
+		}
+		auto it = m_tiles.find(key);
+		if (it == m_tiles.end()) {
+			return false;
+		}
+		tile = it->second;
+		return true;
+	}
+
+	const std::unordered_map<TerrainTileKey, TerrainTile>& GetTiles() const { return m_tiles; }
+	void RemoveTile(const TerrainTileKey& key) { m_tiles.erase(key); }
+
+	size_t numLoads = 0;
+	std::optional<TerrainTileKey> failingKey;
+private:
+	TerrainDesc m_desc;
+	std::unordered_map<TerrainTileKey, TerrainTile> m_tiles;
+};
+
+
+// rolling hills with a ridge, materials by height
+void MakeHeightField(const TerrainDesc& desc, std::vector<float>& heights, std::vector<uint8_t>& materials) {
+	const unsigned resolution = desc.GetHeightFieldResolution();
+	const float spacing = desc.size / (resolution - 1);
+	heights.resize(size_t(resolution) * resolution);
+	materials.resize(heights.size());
+	for (unsigned y = 0; y < resolution; ++y) {
+		for (unsigned x = 0; x < resolution; ++x) {
+			float fx = x * spacing, fy = y * spacing;
+			float height = 40.0f * std::sin(fx * 0.011f) * std::cos(fy * 0.007f) + 8.0f * std::sin(fx * 0.09f + fy * 0.13f) + 60.0f * std::exp(-std::pow((fx - fy) * 0.01f, 2.0f));
+			heights[size_t(y) * resolution + x] = height;
+			materials[size_t(y) * resolution + x] = height > 40.0f ? 2 : height > 0.0f ? 1 : 0;
+		}
+	}
+}
+
+
+// streams tiles in until the selection no longer changes
+void SelectSettled(TerrainTileStreamer& streamer, const TerrainLodParams& params, std::vector<TerrainPatch>& patches) {
+	for (int frame = 0; frame < 64; ++frame) {
+		streamer.Update();
+		SelectTerrainPatches(streamer, params, patches);
+		if (streamer.GetNumPending() == 0 && frame > 0) {
+			break;
+		}
+	}
+}
+
+
+float TriangleArea(const std::vector<uint32_t>& indices, size_t first, unsigned resolution) {
+	auto X = [&](size_t i) { return float(indices[i] % resolution); };
+	auto Y = [&](size_t i) { return float(indices[i] / resolution); };
+	return 0.5f * ((X(first + 1) - X(first)) * (Y(first + 2) - Y(first)) - (X(first + 2) - X(first)) * (Y(first + 1) - Y(first)));
+}
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestTerrain::Run() {
+	using Vec3 = mathfu::Vector<float, 3>;
+
+	int errors = 0;
+	TestCheck Check(errors);
+
+	TerrainDesc desc;
+	desc.numLevels = 5;
+	desc.tileResolution = 33;
+	desc.size = 2048.0f;
+	std::vector<float> heights;
+	std::vector<uint8_t> materials;
+	MakeHeightField(desc, heights, materials);
+
+	// descs are validated
+	{
+		TerrainDesc invalid = desc;
+		invalid.tileResolution = 32;
+		bool thrown = false;
+		try {
+			invalid.Validate();
+		}
+		catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		Check(thrown, "Tile resolution of 32 accepted");
+		Check(desc.GetHeightFieldResolution() == 513, "Bad height field resolution");
+	}
+
+	// the pyramid: shared edges, errors never decrease towards the root
+	MemoryTileSource source(desc, heights, materials);
+	{
+		const auto& tiles = source.GetTiles();
+		Check(tiles.size() == 1 + 4 + 16 + 64 + 256, "Wrong number of tiles");
+
+		const TerrainTile& left = tiles.at({ 2, 1, 1 });
+		const TerrainTile& right = tiles.at({ 2, 2, 1 });
+		bool shared = true;
+		for (unsigned y = 0; y < desc.tileResolution; ++y) {
+			shared = shared && left.heights[y * desc.tileResolution + desc.tileResolution - 1] == right.heights[y * desc.tileResolution];
+		}
+		Check(shared, "Neighbouring tiles do not share their edge");
+
+		bool monotonic = true;
+		bool finestExact = true;
+		for (const auto& tile : tiles) {
+			if (tile.first.level > 0) {
+				monotonic = monotonic && tiles.at(tile.first.GetParent()).geometricError >= tile.second.geometricError;
+			}
+			if (tile.first.level == desc.numLevels - 1) {
+				finestExact = finestExact && tile.second.geometricError == 0.0f;
+			}
+		}
+		Check(monotonic, "Parent tile more accurate than its child");
+		Check(finestExact, "Finest tiles have an error");
+		Check(tiles.at({ 0, 0, 0 }).geometricError > 1.0f, "Root tile has no error");
+		Check(tiles.at({ 3, 5, 2 }).materials[0] == materials[(size_t(2 * 32 * 2) * 513) + 5 * 32 * 2], "Materials not sampled with the heights");
+	}
+
+	// tiles survive a round trip through files
+	{
+		namespace fs = std::experimental::filesystem;
+		fs::path directory = fs::temp_directory_path() / "inl_terrain_test";
+		fs::create_directories(directory);
+
+		TerrainTileFileSource::WriteDesc(directory.string(), desc);
+		TerrainTileFileSource::WriteTile(directory.string(), { 1, 0, 1 }, source.GetTiles().at({ 1, 0, 1 }));
+		TerrainTileFileSource fileSource(directory.string());
+		TerrainTile loaded;
+		bool found = fileSource.LoadTile({ 1, 0, 1 }, loaded);
+		const TerrainTile& original = source.GetTiles().at({ 1, 0, 1 });
+		Check(found && loaded.heights == original.heights && loaded.materials == original.materials && loaded.geometricError == original.geometricError,
+			  "Tile changed through a file");
+		Check(fileSource.GetDesc().numLevels == desc.numLevels && fileSource.GetDesc().size == desc.size, "Desc changed through a file");
+		Check(!fileSource.LoadTile({ 1, 1, 1 }, loaded), "Missing tile file loaded");
+
+		fs::remove_all(directory);
+	}
+
+	// streaming: requests, missing tiles, eviction of the least recently used
+	{
+		MemoryTileSource sparse(desc, heights, materials);
+		sparse.RemoveTile({ 1, 1, 1 });
+		TerrainTileStreamer streamer(&sparse, 4, false);
+		streamer.Request({ 0, 0, 0 });
+		streamer.Request({ 0, 0, 0 });
+		Check(streamer.GetNumPending() == 1 && streamer.Find({ 0, 0, 0 }) == nullptr, "Tile resident before update");
+		streamer.Update();
+		Check(streamer.Find({ 0, 0, 0 }) != nullptr && streamer.GetNumPending() == 0, "Requested tile not resident after update");
+
+		for (unsigned i = 0; i < 4; ++i) {
+			streamer.Request(TerrainTileKey{ 0, 0, 0 }.GetChild(i));
+		}
+		streamer.Update();
+		streamer.Request({ 1, 1, 1 });
+		streamer.Update();
+		Check(streamer.GetNumResident() == 4 && sparse.numLoads == 5, "Missing tile requested again or others not loaded");
+
+		for (int frame = 0; frame < 3; ++frame) {
+			streamer.Find({ 1, 0, 0 });
+			streamer.Update();
+		}
+		streamer.Request({ 2, 0, 0 });
+		streamer.Request({ 2, 1, 0 });
+		streamer.Update();
+		Check(streamer.GetNumResident() == 4 && streamer.Find({ 0, 0, 0 }) && streamer.Find({ 1, 0, 0 }) && streamer.Find({ 2, 1, 0 }),
+			  "Root or recently used tile evicted");
+
+		// a failed load is reported once the others are resident, and is not requested again
+		for (bool asynchronous : { false, true }) {
+			MemoryTileSource failing(desc, heights, materials);
+			failing.failingKey = TerrainTileKey{ 1, 0, 1 };
+			TerrainTileStreamer failingStreamer(&failing, 16, asynchronous);
+			for (unsigned i = 0; i < 4; ++i) {
+				failingStreamer.Request(TerrainTileKey{ 0, 0, 0 }.GetChild(i));
+			}
+			failingStreamer.Flush();
+			bool thrown = false;
+			try {
+				failingStreamer.Update();
+			}
+			catch (std::runtime_error&) {
+				thrown = true;
+			}
+			Check(thrown, "Error of the tile source not reported");
+			Check(failingStreamer.GetNumResident() == 3 && failingStreamer.GetNumPending() == 0, "Tiles loaded with a failed one lost");
+			failingStreamer.Request({ 1, 0, 1 });
+			Check(failingStreamer.GetNumPending() == 0 && failing.numLoads == 4, "Failed tile requested again");
+		}
+
+		TerrainTileStreamer asyncStreamer(&source, 64, true);
+		for (unsigned i = 0; i < 16; ++i) {
+			asyncStreamer.Request({ 2, i % 4, i / 4 });
+		}
+		asyncStreamer.Flush();
+		asyncStreamer.Update();
+		Check(asyncStreamer.GetNumResident() == 16 && asyncStreamer.GetNumPending() == 0, "Asynchronous loads not finished by flush");
+	}
+
+	// level of detail: full coverage, balanced neighbours, refined near the camera
+	{
+		TerrainTileStreamer streamer(&source, 512, false);
+		TerrainLodParams params;
+		params.cameraPosition = Vec3(300.0f, 300.0f, 120.0f);
+		params.projectionScale = 1080.0f / (2.0f * std::tan(0.5f));
+		params.pixelErrorThreshold = 2.0f;
+		std::vector<TerrainPatch> patches;
+		SelectSettled(streamer, params, patches);
+
+		float area = 0.0f;
+		std::map<std::tuple<unsigned, unsigned, unsigned>, const TerrainPatch*> byKey;
+		unsigned finestLevelAtCamera = 0;
+		unsigned coarsestLevel = desc.numLevels;
+		for (const auto& patch : patches) {
+			float tileSize = desc.GetTileSize(patch.key.level);
+			area += tileSize * tileSize;
+			byKey[{ patch.key.level, patch.key.x, patch.key.y }] = &patch;
+			if (patch.key.x * tileSize <= 300.0f && 300.0f < (patch.key.x + 1) * tileSize && patch.key.y * tileSize <= 300.0f && 300.0f < (patch.key.y + 1) * tileSize) {
+				finestLevelAtCamera = patch.key.level;
+			}
+			coarsestLevel = std::min(coarsestLevel, patch.key.level);
+		}
+		Check(std::abs(area - desc.size * desc.size) < 1.0f, "Patches do not cover the terrain exactly once");
+		Check(finestLevelAtCamera == desc.numLevels - 1, "Terrain under the camera not at the finest level");
+		Check(coarsestLevel < desc.numLevels - 1, "Distant terrain not coarsened");
+
+		// neighbours differ by at most one level and coarser edges are flagged
+		bool balanced = true;
+		bool flagged = true;
+		for (const auto& patch : patches) {
+			const TerrainTileKey& key = patch.key;
+			if (key.x + 1 < desc.GetNumTiles(key.level)) {
+				TerrainTileKey right{ key.level, key.x + 1, key.y };
+				bool same = byKey.count({ right.level, right.x, right.y }) > 0;
+				bool coarser = key.level > 0 && byKey.count({ key.level - 1, right.x / 2, right.y / 2 }) > 0;
+				bool muchCoarser = key.level > 1 && byKey.count({ key.level - 2, right.x / 4, right.y / 4 }) > 0;
+				balanced = balanced && !muchCoarser;
+				flagged = flagged && coarser == ((patch.coarserEdges & (unsigned)eTerrainEdge::POS_X) != 0) && !(same && coarser);
+			}
+			if (GetTerrainScreenError(desc, key, *patch.tile, params) > params.pixelErrorThreshold) {
+				balanced = balanced && key.level == desc.numLevels - 1;
+			}
+		}
+		Check(balanced, "Neighbouring patches more than one level apart or error above threshold");
+		Check(flagged, "Coarser edges not flagged");
+
+		// moving away coarsens the terrain
+		size_t numNear = patches.size();
+		params.cameraPosition = Vec3(1024.0f, 1024.0f, 3000.0f);
+		SelectSettled(streamer, params, patches);
+		Check(!patches.empty() && patches.size() < numNear, "Terrain not coarsened from far away");
+	}
+
+	// stitched index buffers: no flipped triangles, full coverage, no odd vertex on coarser edges
+	{
+		const unsigned resolution = desc.tileResolution;
+		const unsigned last = resolution - 1;
+		bool valid = true;
+		for (unsigned coarserEdges = 0; coarserEdges < 16; ++coarserEdges) {
+			std::vector<uint32_t> indices = BuildTerrainPatchIndices(resolution, coarserEdges);
+			float area = 0.0f;
+			for (size_t i = 0; i < indices.size(); i += 3) {
+				float triangleArea = TriangleArea(indices, i, resolution);
+				valid = valid && triangleArea > 0.0f;
+				area += triangleArea;
+			}
+			valid = valid && area == float(last * last);
+			for (uint32_t index : indices) {
+				unsigned x = index % resolution, y = index / resolution;
+				valid = valid && !((coarserEdges & (unsigned)eTerrainEdge::NEG_X) && x == 0 && (y & 1));
+				valid = valid && !((coarserEdges & (unsigned)eTerrainEdge::POS_X) && x == last && (y & 1));
+				valid = valid && !((coarserEdges & (unsigned)eTerrainEdge::NEG_Y) && y == 0 && (x & 1));
+				valid = valid && !((coarserEdges & (unsigned)eTerrainEdge::POS_Y) && y == last && (x & 1));
+			}
+		}
+		Check(valid, "Bad stitched index buffer");
+
+		// even vertices of a fine edge coincide with the coarse neighbour's vertices
+		std::vector<TerrainVertex> fine, coarse;
+		BuildTerrainPatchVertices(desc, { 3, 4, 2 }, source.GetTiles().at({ 3, 4, 2 }), fine);
+		BuildTerrainPatchVertices(desc, { 2, 1, 1 }, source.GetTiles().at({ 2, 1, 1 }), coarse);
+		bool seamless = true;
+		for (unsigned y = 0; y < resolution; y += 2) {
+			Vec3 finePosition(fine[y * resolution].position);
+			Vec3 coarsePosition(coarse[(y / 2) * resolution + last].position);
+			seamless = seamless && (finePosition - coarsePosition).Length() < 1e-3f;
+		}
+		Check(seamless, "Fine and coarse edge vertices do not meet");
+	}
+
+	cout << errors << " errors" << endl;
+	return errors;
+}
@@ -0,0 +1,169 @@
+#include "Test.hpp"
+#include <iostream>
+#include <random>
+#include <cmath>
+#include "GraphicsEngine_LL/Vertex.hpp"
+#include "GraphicsEngine_LL/VertexElementCompressor.hpp"
+
+using std::cout;
+using std::endl;
+
+
+//------------------------------------------------------------------------------
+// Test class
+//------------------------------------------------------------------------------
+
+
+class TestVertexCompression : public AutoRegisterTest<TestVertexCompression> {
+public:
+	TestVertexCompression() {}
+
+	static std::string Name() {
+		return "Vertex Compression";
+	}
+	int Run() override;
+};
+
+
+//------------------------------------------------------------------------------
+// Test definition
+//------------------------------------------------------------------------------
+
+
+int TestVertexCompression::Run() {
+	using namespace inl::gxeng;
+	using Vec3 = mathfu::Vector<float, 3>;
+	using Vec2 = mathfu::Vector<float, 2>;
+
+	std::mt19937 rne(715);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> uv(-4.0f, 4.0f);
+	const int numSamples = 100000;
+
+	// acos is too imprecise near 1 for this
+	auto Angle = [](const Vec3& a, const Vec3& b) {
+		return std::atan2(Vec3::CrossProduct(a, b).Length(), Vec3::DotProduct(a, b));
+	};
+
+	// positions: error is at most half a quantization step of the bounds
+	Vec3 minimum(-12.0f, 0.0f, -0.5f), maximum(30.0f, 2.0f, 0.5f);
+	PositionQuantization quantization = PositionQuantization::FromBounds(minimum, maximum);
+	float maxPositionError = 0.0f;
+	for (int i = 0; i < numSamples; ++i) {
+		Vec3 t(unit(rne) * 0.5f + 0.5f, unit(rne) * 0.5f + 0.5f, unit(rne) * 0.5f + 0.5f);
+		Vec3 position = minimum + (maximum - minimum) * t;
+		auto encoded = VertexElementCompressor<eVertexElementSemantic::POSITION>::Compress(position, quantization);
+		Vec3 decoded = VertexElementCompressor<eVertexElementSemantic::POSITION>::Decompress(encoded.data(), quantization);
+		for (int c = 0; c < 3; ++c) {
+			maxPositionError = std::max(maxPositionError, std::abs(decoded[c] - position[c]) / quantization.scale[c]);
+		}
+	}
+
+	// normals: octahedral 2x16 bit is good to a small fraction of a degree
+	float maxNormalError = 0.0f;
+	for (int i = 0; i < numSamples; ++i) {
+		Vec3 normal(unit(rne), unit(rne), unit(rne));
+		if (normal.Length() < 1e-3f) {
+			continue;
+		}
+		normal.Normalize();
+		auto encoded = VertexElementCompressor<eVertexElementSemantic::NORMAL>::Compress(normal);
+		Vec3 decoded = VertexElementCompressor<eVertexElementSemantic::NORMAL>::Decompress(encoded.data());
+		maxNormalError = std::max(maxNormalError, Angle(normal, decoded));
+	}
+	// axes and the folded edges of the octahedron are the tricky cases
+	for (Vec3 normal : { Vec3(0, 0, 1), Vec3(0, 0, -1), Vec3(1, 0, 0), Vec3(-1, 0, 0), Vec3(0, -1, 0), Vec3(0.6f, -0.8f, 0) }) {
+		auto encoded = VertexElementCompressor<eVertexElementSemantic::NORMAL>::Compress(normal);
+		Vec3 decoded = VertexElementCompressor<eVertexElementSemantic::NORMAL>::Decompress(encoded.data());
+		maxNormalError = std::max(maxNormalError, Angle(normal, decoded));
+	}
+
+	// texture coordinates: half floats have 11 significant bits
+	float maxTexCoordError = 0.0f;
+	for (int i = 0; i < numSamples; ++i) {
+		Vec2 texCoord(uv(rne), uv(rne));
+		auto encoded = VertexElementCompressor<eVertexElementSemantic::TEX_COORD>::Compress(texCoord);
+		Vec2 decoded = VertexElementCompressor<eVertexElementSemantic::TEX_COORD>::Decompress(encoded.data());
+		for (int c = 0; c < 2; ++c) {
+			float relative = std::abs(decoded[c] - texCoord[c]) / std::max(std::abs(texCoord[c]), 6.1e-5f);
+			maxTexCoordError = std::max(maxTexCoordError, relative);
+		}
+	}
+	bool halfSpecialsOk = impl::HalfToFloat(impl::FloatToHalf(1.0f)) == 1.0f
+		&& impl::HalfToFloat(impl::FloatToHalf(-2.5f)) == -2.5f
+		&& impl::HalfToFloat(impl::FloatToHalf(65504.0f)) == 65504.0f
+		&& std::isinf(impl::HalfToFloat(impl::FloatToHalf(1e6f)))
+		&& impl::HalfToFloat(impl::FloatToHalf(5.96046448e-8f)) == 5.96046448e-8f; // smallest denormal
+
+	// colors: half a step of 8 bits
+	float maxColorError = 0.0f;
+	for (int i = 0; i < numSamples; ++i) {
+		Vec3 color(unit(rne) * 0.5f + 0.5f, unit(rne) * 0.5f + 0.5f, unit(rne) * 0.5f + 0.5f);
+		auto encoded = VertexElementCompressor<eVertexElementSemantic::COLOR>::Compress(color);
+		Vec3 decoded = VertexElementCompressor<eVertexElementSemantic::COLOR>::Decompress(encoded.data());
+		for (int c = 0; c < 3; ++c) {
+			maxColorError = std::max(maxColorError, std::abs(decoded[c] - color[c]));
+		}
+	}
+
+	// whole vertices
+	using MyVertex = Vertex<Position<0>, Normal<0>, TexCoord<0>>;
+	std::vector<MyVertex> vertices(3);
+	vertices[0].position = { -1, -1, 0 };
+	vertices[1].position = { 1, -1, 0 };
+	vertices[2].position = { 0, 3, 2 };
+	for (auto& v : vertices) {
+		v.normal = { 0, 0, -1 };
+		v.texCoord = { 0.25f, 0.75f };
+	}
+	PositionQuantization meshQuantization = VertexCompressor::CalculateQuantization(vertices.data(), vertices.size(), sizeof(MyVertex));
+	std::vector<bool> elementMap(vertices[0].GetElements().size(), true);
+	size_t stride = VertexCompressor::Size(vertices[0], elementMap);
+	std::vector<uint8_t> compressed(stride * vertices.size());
+	std::vector<VertexCompressor::Element> elements;
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		VertexCompressor::Compress(vertices[i], elementMap, meshQuantization, compressed.data() + i * stride, elements);
+	}
+	bool vertexOk = stride == 16
+		&& elements.size() == 3
+		&& elements[0].offset == 0 && elements[1].offset == 8 && elements[2].offset == 12
+		&& elements[2].format == inl::gxapi::eFormat::R16G16_FLOAT;
+	for (size_t i = 0; i < vertices.size() && vertexOk; ++i) {
+		const uint8_t* vertex = compressed.data() + i * stride;
+		Vec3 position = VertexElementCompressor<eVertexElementSemantic::POSITION>::Decompress(vertex + elements[0].offset, meshQuantization);
+		Vec3 normal = VertexElementCompressor<eVertexElementSemantic::NORMAL>::Decompress(vertex + elements[1].offset);
+		Vec2 texCoord = VertexElementCompressor<eVertexElementSemantic::TEX_COORD>::Decompress(vertex + elements[2].offset);
+		vertexOk = (position - vertices[i].position).Length() < 1e-3f
+			&& (normal - vertices[i].normal).Length() < 1e-4f
+			&& texCoord.x() == 0.25f && texCoord.y() == 0.75f;
+	}
+
+	cout << "Max position error: " << maxPositionError << " of bounds" << endl;
+	cout << "Max normal error: " << maxNormalError * 180.0f / 3.14159265f << " degrees" << endl;
+	cout << "Max texcoord relative error: " << maxTexCoordError << endl;
+	cout << "Max color error: " << maxColorError << endl;
+
+	int failed = 0;
+	if (maxPositionError > 0.5f / 65535.0f + 1e-6f) {
+		cout << "Position quantization is too lossy." << endl;
+		++failed;
+	}
+	if (maxNormalError > 0.01f * 3.14159265f / 180.0f) {
+		cout << "Normal encoding is too lossy." << endl;
+		++failed;
+	}
+	if (maxTexCoordError > 1.0f / 2048.0f || !halfSpecialsOk) {
+		cout << "Half float conversion is wrong." << endl;
+		++failed;
+	}
+	if (maxColorError > 0.5f / 255.0f + 1e-6f) {
+		cout << "Color quantization is too lossy." << endl;
+		++failed;
+	}
+	if (!vertexOk) {
+		cout << "Vertex compressor produced a wrong layout or data." << endl;
+		++failed;
+	}
+
+	return failed;
+}
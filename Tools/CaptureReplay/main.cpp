@@ -0,0 +1,43 @@
+#include "GraphicsApi_Capture/CaptureAnalyzer.hpp"
+#include "GraphicsApi_LL/Exception.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace inl::gxapi_capture;
+
+
+// Prints replay statistics for each capture given on the command line.
+// Pass a capture from before and one from after a change to compare them.
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cout << "Usage: CaptureReplay <capture file> [<capture file> ...]" << std::endl;
+		return 1;
+	}
+
+	int result = 0;
+	for (int i = 1; i < argc; ++i) {
+		std::ifstream file(argv[i], std::ios::binary);
+		if (!file.is_open()) {
+			std::cout << "Cannot open " << argv[i] << std::endl;
+			result = 1;
+			continue;
+		}
+		std::vector<char> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+		std::cout << "=== " << argv[i] << " ===" << std::endl;
+		try {
+			CaptureStatistics statistics = AnalyzeCapture(data.data(), data.size());
+			PrintCaptureReport(std::cout, statistics);
+		}
+		catch (inl::gxapi::Exception& ex) {
+			std::cout << "Invalid capture: " << ex.what() << std::endl;
+			result = 1;
+		}
+		std::cout << std::endl;
+	}
+
+	return result;
+}